@@ -23,7 +23,7 @@
  \file indigo_agent_alignment.c
  */
 
-#define DRIVER_VERSION 0x0001
+#define DRIVER_VERSION 0x0002
 #define DRIVER_NAME	"indigo_agent_alignment"
 
 #include <stdlib.h>
@@ -97,18 +97,19 @@ static indigo_result agent_change_property(indigo_device *device, indigo_client
 	indigo_property **alignment_properties = DEVICE_PRIVATE_DATA->alignment_point_properties;
 	indigo_device *mount = DEVICE_PRIVATE_DATA->mount;
 	if (mount && alignment_properties) {
-		indigo_alignment_point *alignment_points = ((indigo_mount_context *)(mount->device_context))->alignment_points;
 		for (int i = 0; i < alignment_point_count; i++) {
 			indigo_property *alignment_property = alignment_properties[i];
 			if (indigo_property_match(alignment_property, property)) {
 				indigo_property_copy_values(alignment_property, property, false);
-				alignment_points->ra = AGENT_ALIGNMENT_POINT_RA_ITEM(alignment_property)->number.value;
-				alignment_points->dec = AGENT_ALIGNMENT_POINT_DEC_ITEM(alignment_property)->number.value;
-				alignment_points->raw_ra = AGENT_ALIGNMENT_POINT_RAW_RA_ITEM(alignment_property)->number.value;
-				alignment_points->raw_dec = AGENT_ALIGNMENT_POINT_RAW_DEC_ITEM(alignment_property)->number.value;
-				alignment_points->lst = AGENT_ALIGNMENT_POINT_LST_ITEM(alignment_property)->number.value;
-				alignment_points->side_of_pier = AGENT_ALIGNMENT_POINT_SOP_ITEM(alignment_property)->number.value;
-				indigo_mount_update_alignment_points(DEVICE_PRIVATE_DATA->mount);
+				indigo_alignment_point alignment_point = { 0 };
+				alignment_point.ra = AGENT_ALIGNMENT_POINT_RA_ITEM(alignment_property)->number.value;
+				alignment_point.dec = AGENT_ALIGNMENT_POINT_DEC_ITEM(alignment_property)->number.value;
+				alignment_point.raw_ra = AGENT_ALIGNMENT_POINT_RAW_RA_ITEM(alignment_property)->number.value;
+				alignment_point.raw_dec = AGENT_ALIGNMENT_POINT_RAW_DEC_ITEM(alignment_property)->number.value;
+				alignment_point.lst = AGENT_ALIGNMENT_POINT_LST_ITEM(alignment_property)->number.value;
+				alignment_point.side_of_pier = AGENT_ALIGNMENT_POINT_SOP_ITEM(alignment_property)->number.value;
+				if (indigo_mount_set_alignment_point(mount, i, &alignment_point))
+					indigo_mount_update_alignment_points(mount);
 				indigo_update_property(device, alignment_property, NULL);
 			}
 		}
@@ -156,18 +157,19 @@ static void process_connection_change(indigo_client *client, indigo_device *devi
 			indigo_property **alignment_properties = malloc(alignment_point_count * sizeof(indigo_property *));
 			if (alignment_properties) {
 				CLIENT_PRIVATE_DATA->mount = device;
-				indigo_alignment_point *points = MOUNT_CONTEXT->alignment_points;
 				for (int j = 0; j < alignment_point_count; j++) {
 					char name[INDIGO_NAME_SIZE], label[INDIGO_NAME_SIZE];
+					indigo_alignment_point point = { 0 };
+					indigo_mount_get_alignment_point(device, j, &point);
 					sprintf(name, AGENT_ALIGNMENT_POINT_PROPERY_NAME, j);
 					sprintf(label, "Alignment point #%d", j);
 					indigo_property *alignment_property = indigo_init_number_property(NULL, agent_device->name, name, "Alignment points", label, INDIGO_OK_STATE, INDIGO_RW_PERM, 6);
-					indigo_init_number_item(AGENT_ALIGNMENT_POINT_RA_ITEM(alignment_property), AGENT_ALIGNMENT_POINT_RA_ITEM_NAME, "Right ascension (0 to 24 hrs)", 0, 24, 0, points[j].ra);
-					indigo_init_number_item(AGENT_ALIGNMENT_POINT_DEC_ITEM(alignment_property), AGENT_ALIGNMENT_POINT_DEC_ITEM_NAME, "Declination (-90 to 90°))", -90, 90, 0, points[j].dec);
-					indigo_init_number_item(AGENT_ALIGNMENT_POINT_RAW_RA_ITEM(alignment_property), AGENT_ALIGNMENT_POINT_RAW_RA_ITEM_NAME, "Raw right ascension (0 to 24 hrs)", 0, 24, 0, points[j].raw_ra);
-					indigo_init_number_item(AGENT_ALIGNMENT_POINT_RAW_DEC_ITEM(alignment_property), AGENT_ALIGNMENT_POINT_RAW_DEC_ITEM_NAME, "Raw declination (-90 to 90°))", -90, 90, 0, points[j].raw_dec);
-					indigo_init_number_item(AGENT_ALIGNMENT_POINT_LST_ITEM(alignment_property), AGENT_ALIGNMENT_POINT_LST_ITEM_NAME, "LST Time", 0, 24, 0, points[j].lst);
-					indigo_init_number_item(AGENT_ALIGNMENT_POINT_SOP_ITEM(alignment_property), AGENT_ALIGNMENT_POINT_SOP_ITEM_NAME, "Side of pier", 0, 1, 0, points[j].side_of_pier);
+					indigo_init_number_item(AGENT_ALIGNMENT_POINT_RA_ITEM(alignment_property), AGENT_ALIGNMENT_POINT_RA_ITEM_NAME, "Right ascension (0 to 24 hrs)", 0, 24, 0, point.ra);
+					indigo_init_number_item(AGENT_ALIGNMENT_POINT_DEC_ITEM(alignment_property), AGENT_ALIGNMENT_POINT_DEC_ITEM_NAME, "Declination (-90 to 90°))", -90, 90, 0, point.dec);
+					indigo_init_number_item(AGENT_ALIGNMENT_POINT_RAW_RA_ITEM(alignment_property), AGENT_ALIGNMENT_POINT_RAW_RA_ITEM_NAME, "Raw right ascension (0 to 24 hrs)", 0, 24, 0, point.raw_ra);
+					indigo_init_number_item(AGENT_ALIGNMENT_POINT_RAW_DEC_ITEM(alignment_property), AGENT_ALIGNMENT_POINT_RAW_DEC_ITEM_NAME, "Raw declination (-90 to 90°))", -90, 90, 0, point.raw_dec);
+					indigo_init_number_item(AGENT_ALIGNMENT_POINT_LST_ITEM(alignment_property), AGENT_ALIGNMENT_POINT_LST_ITEM_NAME, "LST Time", 0, 24, 0, point.lst);
+					indigo_init_number_item(AGENT_ALIGNMENT_POINT_SOP_ITEM(alignment_property), AGENT_ALIGNMENT_POINT_SOP_ITEM_NAME, "Side of pier", 0, 1, 0, point.side_of_pier);
 					alignment_properties[j] = alignment_property;
 					indigo_define_property(agent_device, alignment_property, NULL);
 				}
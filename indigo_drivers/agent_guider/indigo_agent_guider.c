@@ -148,13 +148,10 @@ static void save_config(indigo_device *device) {
 	indigo_save_property(device, NULL, AGENT_GUIDER_SETTINGS_PROPERTY);
 	indigo_save_property(device, NULL, AGENT_GUIDER_DETECTION_MODE_PROPERTY);
 	indigo_save_property(device, NULL, AGENT_GUIDER_DEC_MODE_PROPERTY);
-	if (DEVICE_CONTEXT->property_save_file_handle) {
+	if (indigo_commit_saved_properties(device, NULL) == INDIGO_OK)
 		CONFIG_PROPERTY->state = INDIGO_OK_STATE;
-		close(DEVICE_CONTEXT->property_save_file_handle);
-		DEVICE_CONTEXT->property_save_file_handle = 0;
-	} else {
+	else
 		CONFIG_PROPERTY->state = INDIGO_ALERT_STATE;
-	}
 	CONFIG_SAVE_ITEM->sw.value = false;
 	indigo_update_property(device, CONFIG_PROPERTY, NULL);
 	pthread_mutex_unlock(&DEVICE_PRIVATE_DATA->mutex);
@@ -23,7 +23,7 @@
  \file indigo_agent_mount.c
  */
 
-#define DRIVER_VERSION 0x0006
+#define DRIVER_VERSION 0x0009
 #define DRIVER_NAME	"indigo_agent_mount"
 
 #include <stdlib.h>
@@ -42,6 +42,9 @@
 #include <indigo/indigo_filter.h>
 #include <indigo/indigo_io.h>
 #include <indigo/indigo_mount_driver.h>
+#include <indigo/indigo_novas.h>
+#include <indigo/indigo_platesolver.h>
+#include <indigo/indigo_sgp4.h>
 
 #include "indigo_agent_mount.h"
 
@@ -70,12 +73,109 @@
 #define AGENT_HA_TRACKING_LIMIT_ITEM									(AGENT_LIMITS_PROPERTY->items+0)
 #define AGENT_LOCAL_TIME_LIMIT_ITEM										(AGENT_LIMITS_PROPERTY->items+1)
 
+#define AGENT_PLATESOLVER_SOLVE_PROPERTY							(DEVICE_PRIVATE_DATA->agent_platesolver_solve_property)
+#define AGENT_PLATESOLVER_SOLVE_DISABLED_ITEM					(AGENT_PLATESOLVER_SOLVE_PROPERTY->items+0)
+#define AGENT_PLATESOLVER_SOLVE_SOLVE_ITEM						(AGENT_PLATESOLVER_SOLVE_PROPERTY->items+1)
+#define AGENT_PLATESOLVER_SOLVE_SYNC_ITEM							(AGENT_PLATESOLVER_SOLVE_PROPERTY->items+2)
+
+#define AGENT_PLATESOLVER_HINTS_PROPERTY							(DEVICE_PRIVATE_DATA->agent_platesolver_hints_property)
+#define AGENT_PLATESOLVER_HINTS_RADIUS_ITEM						(AGENT_PLATESOLVER_HINTS_PROPERTY->items+0)
+#define AGENT_PLATESOLVER_HINTS_SCALE_ITEM						(AGENT_PLATESOLVER_HINTS_PROPERTY->items+1)
+
+#define AGENT_PLATESOLVER_WCS_PROPERTY								(DEVICE_PRIVATE_DATA->agent_platesolver_wcs_property)
+#define AGENT_PLATESOLVER_WCS_RA_ITEM									(AGENT_PLATESOLVER_WCS_PROPERTY->items+0)
+#define AGENT_PLATESOLVER_WCS_DEC_ITEM								(AGENT_PLATESOLVER_WCS_PROPERTY->items+1)
+#define AGENT_PLATESOLVER_WCS_ANGLE_ITEM							(AGENT_PLATESOLVER_WCS_PROPERTY->items+2)
+#define AGENT_PLATESOLVER_WCS_SCALE_ITEM							(AGENT_PLATESOLVER_WCS_PROPERTY->items+3)
+#define AGENT_PLATESOLVER_WCS_WIDTH_ITEM							(AGENT_PLATESOLVER_WCS_PROPERTY->items+4)
+#define AGENT_PLATESOLVER_WCS_HEIGHT_ITEM							(AGENT_PLATESOLVER_WCS_PROPERTY->items+5)
+#define AGENT_PLATESOLVER_WCS_STARS_ITEM							(AGENT_PLATESOLVER_WCS_PROPERTY->items+6)
+
+#define AGENT_PLATESOLVER_CATALOGUE_PROPERTY					(DEVICE_PRIVATE_DATA->agent_platesolver_catalogue_property)
+#define AGENT_PLATESOLVER_CATALOGUE_FILE_ITEM					(AGENT_PLATESOLVER_CATALOGUE_PROPERTY->items+0)
+
+#define AGENT_CENTERING_TARGET_PROPERTY								(DEVICE_PRIVATE_DATA->agent_centering_target_property)
+#define AGENT_CENTERING_TARGET_RA_ITEM								(AGENT_CENTERING_TARGET_PROPERTY->items+0)
+#define AGENT_CENTERING_TARGET_DEC_ITEM								(AGENT_CENTERING_TARGET_PROPERTY->items+1)
+
+#define AGENT_CENTERING_SETTINGS_PROPERTY							(DEVICE_PRIVATE_DATA->agent_centering_settings_property)
+#define AGENT_CENTERING_SETTINGS_EXPOSURE_ITEM				(AGENT_CENTERING_SETTINGS_PROPERTY->items+0)
+#define AGENT_CENTERING_SETTINGS_TOLERANCE_ITEM				(AGENT_CENTERING_SETTINGS_PROPERTY->items+1)
+#define AGENT_CENTERING_SETTINGS_ITERATIONS_ITEM			(AGENT_CENTERING_SETTINGS_PROPERTY->items+2)
+
+#define AGENT_CENTERING_STATS_PROPERTY								(DEVICE_PRIVATE_DATA->agent_centering_stats_property)
+#define AGENT_CENTERING_STATS_ITERATION_ITEM					(AGENT_CENTERING_STATS_PROPERTY->items+0)
+#define AGENT_CENTERING_STATS_RA_ERROR_ITEM						(AGENT_CENTERING_STATS_PROPERTY->items+1)
+#define AGENT_CENTERING_STATS_DEC_ERROR_ITEM					(AGENT_CENTERING_STATS_PROPERTY->items+2)
+#define AGENT_CENTERING_STATS_DISTANCE_ITEM						(AGENT_CENTERING_STATS_PROPERTY->items+3)
+#define AGENT_CENTERING_STATS_STARS_ITEM							(AGENT_CENTERING_STATS_PROPERTY->items+4)
+
+#define AGENT_START_PROCESS_PROPERTY									(DEVICE_PRIVATE_DATA->agent_start_process_property)
+#define AGENT_MOUNT_START_CENTERING_ITEM							(AGENT_START_PROCESS_PROPERTY->items+0)
+
+#define AGENT_ABORT_PROCESS_PROPERTY									(DEVICE_PRIVATE_DATA->agent_abort_process_property)
+#define AGENT_ABORT_PROCESS_ITEM											(AGENT_ABORT_PROCESS_PROPERTY->items+0)
+
+#define AGENT_SATELLITES_CATALOGUE_PROPERTY						(DEVICE_PRIVATE_DATA->agent_satellites_catalogue_property)
+#define AGENT_SATELLITES_CATALOGUE_FILE_ITEM					(AGENT_SATELLITES_CATALOGUE_PROPERTY->items+0)
+
+#define AGENT_SATELLITES_PREDICTION_PROPERTY					(DEVICE_PRIVATE_DATA->agent_satellites_prediction_property)
+#define AGENT_SATELLITES_PREDICTION_WINDOW_ITEM				(AGENT_SATELLITES_PREDICTION_PROPERTY->items+0)
+#define AGENT_SATELLITES_PREDICTION_MIN_ALTITUDE_ITEM	(AGENT_SATELLITES_PREDICTION_PROPERTY->items+1)
+
+#define AGENT_SATELLITES_PASSES_PROPERTY							(DEVICE_PRIVATE_DATA->agent_satellites_passes_property)
+
+#define AGENT_SATELLITES_POSITION_PROPERTY						(DEVICE_PRIVATE_DATA->agent_satellites_position_property)
+#define AGENT_SATELLITES_POSITION_RA_ITEM							(AGENT_SATELLITES_POSITION_PROPERTY->items+0)
+#define AGENT_SATELLITES_POSITION_DEC_ITEM						(AGENT_SATELLITES_POSITION_PROPERTY->items+1)
+#define AGENT_SATELLITES_POSITION_ALT_ITEM						(AGENT_SATELLITES_POSITION_PROPERTY->items+2)
+#define AGENT_SATELLITES_POSITION_AZ_ITEM							(AGENT_SATELLITES_POSITION_PROPERTY->items+3)
+#define AGENT_SATELLITES_POSITION_RANGE_ITEM					(AGENT_SATELLITES_POSITION_PROPERTY->items+4)
+
+#define PLATESOLVER_GROUP															"Plate solver"
+#define PLATESOLVER_MAX_STARS													100
+
+#define CENTERING_GROUP																"Centering"
+#define CENTERING_BUSY_TIMEOUT												5
+#define CENTERING_SLEW_TIMEOUT												300
+#define CENTERING_POSITION_TOLERANCE										0.01
+#define CENTERING_SOLVE_TIMEOUT												60
+
+#define SATELLITES_GROUP															"Satellites"
+#define SATELLITES_MAX_PASSES													32
+#define SATELLITES_LEAD																30
+
 typedef struct {
 	indigo_property *agent_geographic_property;
 	indigo_property *agent_site_data_source_property;
 	indigo_property *agent_lx200_server_property;
 	indigo_property *agent_lx200_configuration_property;
 	indigo_property *agent_limits_property;
+	indigo_property *agent_platesolver_solve_property;
+	indigo_property *agent_platesolver_hints_property;
+	indigo_property *agent_platesolver_wcs_property;
+	indigo_property *agent_platesolver_catalogue_property;
+	indigo_property *agent_centering_target_property;
+	indigo_property *agent_centering_settings_property;
+	indigo_property *agent_centering_stats_property;
+	indigo_property *agent_start_process_property;
+	indigo_property *agent_abort_process_property;
+	indigo_property_state mount_eq_state;
+	int solve_count;
+	bool centering;
+	indigo_property *agent_satellites_catalogue_property;
+	indigo_property *agent_satellites_prediction_property;
+	indigo_property *agent_satellites_passes_property;
+	indigo_property *agent_satellites_position_property;
+	indigo_tle *satellites;
+	char (*satellite_tle)[INDIGO_VALUE_SIZE];
+	int satellite_count;
+	indigo_sgp4_pass passes[SATELLITES_MAX_PASSES];
+	int pass_count;
+	int tracked_pass;
+	bool tle_sent;
+	indigo_timer *satellites_timer;
+	indigo_novas_context satellites_context;
 	double mount_latitude, mount_longitude, mount_elevation;
 	double dome_latitude, dome_longitude, dome_elevation;
 	double gps_latitude, gps_longitude, gps_elevation;
@@ -98,13 +198,16 @@ static void save_config(indigo_device *device) {
 	indigo_save_property(device, NULL, AGENT_LIMITS_PROPERTY);
 	AGENT_HA_TRACKING_LIMIT_ITEM->number.value = tmp_ha_tracking_limit;
 	 AGENT_LOCAL_TIME_LIMIT_ITEM->number.value = tmp_local_time_limit;
-	if (DEVICE_CONTEXT->property_save_file_handle) {
+	indigo_save_property(device, NULL, AGENT_PLATESOLVER_SOLVE_PROPERTY);
+	indigo_save_property(device, NULL, AGENT_PLATESOLVER_HINTS_PROPERTY);
+	indigo_save_property(device, NULL, AGENT_PLATESOLVER_CATALOGUE_PROPERTY);
+	indigo_save_property(device, NULL, AGENT_CENTERING_SETTINGS_PROPERTY);
+	indigo_save_property(device, NULL, AGENT_SATELLITES_CATALOGUE_PROPERTY);
+	indigo_save_property(device, NULL, AGENT_SATELLITES_PREDICTION_PROPERTY);
+	if (indigo_commit_saved_properties(device, NULL) == INDIGO_OK)
 		CONFIG_PROPERTY->state = INDIGO_OK_STATE;
-		close(DEVICE_CONTEXT->property_save_file_handle);
-		DEVICE_CONTEXT->property_save_file_handle = 0;
-	} else {
+	else
 		CONFIG_PROPERTY->state = INDIGO_ALERT_STATE;
-	}
 	CONFIG_SAVE_ITEM->sw.value = false;
 	indigo_update_property(device, CONFIG_PROPERTY, NULL);
 	pthread_mutex_unlock(&DEVICE_PRIVATE_DATA->mutex);
@@ -213,6 +316,357 @@ static void set_site_coordinates(indigo_device *device) {
 	set_site_coordinates3(device);
 }
 
+static void set_mount_coordinates(indigo_device *device, const char *on_coordinates_set, double ra, double dec) {
+	char *mount_name = FILTER_DEVICE_CONTEXT->device_name[INDIGO_FILTER_MOUNT_INDEX];
+	if (*mount_name == 0)
+		return;
+	indigo_property *property = indigo_init_switch_property(NULL, mount_name, MOUNT_ON_COORDINATES_SET_PROPERTY_NAME, NULL, NULL, INDIGO_OK_STATE, INDIGO_RW_PERM, INDIGO_ONE_OF_MANY_RULE, 1);
+	indigo_init_switch_item(property->items, on_coordinates_set, NULL, true);
+	property->access_token = indigo_get_device_or_master_token(property->device);
+	indigo_change_property(FILTER_DEVICE_CONTEXT->client, property);
+	indigo_release_property(property);
+	property = indigo_init_number_property(NULL, mount_name, MOUNT_EQUATORIAL_COORDINATES_PROPERTY_NAME, NULL, NULL, INDIGO_OK_STATE, INDIGO_RW_PERM, 2);
+	indigo_init_number_item(property->items + 0, MOUNT_EQUATORIAL_COORDINATES_RA_ITEM_NAME, NULL, 0, 0, 0, ra);
+	indigo_init_number_item(property->items + 1, MOUNT_EQUATORIAL_COORDINATES_DEC_ITEM_NAME, NULL, 0, 0, 0, dec);
+	property->access_token = indigo_get_device_or_master_token(property->device);
+	indigo_change_property(FILTER_DEVICE_CONTEXT->client, property);
+	indigo_release_property(property);
+}
+
+static void sync_mount(indigo_device *device, double ra, double dec) {
+	set_mount_coordinates(device, MOUNT_ON_COORDINATES_SET_SYNC_ITEM_NAME, ra, dec);
+}
+
+static void slew_mount(indigo_device *device, double ra, double dec) {
+	set_mount_coordinates(device, MOUNT_ON_COORDINATES_SET_TRACK_ITEM_NAME, ra, dec);
+}
+
+static void platesolver_process(indigo_device *device) {
+	indigo_property *image_property = indigo_filter_cached_property(device, INDIGO_FILTER_CCD_INDEX, CCD_IMAGE_PROPERTY_NAME);
+	indigo_raw_header *header = NULL;
+	void *data = NULL;
+	if (image_property && image_property->state == INDIGO_OK_STATE) {
+		if (strchr(image_property->device, '@'))
+			indigo_populate_http_blob_item(image_property->items);
+		header = (indigo_raw_header *)(image_property->items->blob.value);
+		if (header && (header->signature == INDIGO_RAW_MONO8 || header->signature == INDIGO_RAW_MONO16 || header->signature == INDIGO_RAW_RGB24 || header->signature == INDIGO_RAW_RGB48)) {
+			// image can be replaced by next exposure while solving
+			data = malloc(image_property->items->blob.size);
+			memcpy(data, header, image_property->items->blob.size);
+			header = (indigo_raw_header *)data;
+		} else {
+			header = NULL;
+		}
+	}
+	if (header == NULL) {
+		AGENT_PLATESOLVER_WCS_PROPERTY->state = INDIGO_ALERT_STATE;
+		indigo_update_property(device, AGENT_PLATESOLVER_WCS_PROPERTY, "RAW image is required for plate solving");
+		DEVICE_PRIVATE_DATA->solve_count++;
+		return;
+	}
+	int star_count = 0;
+	indigo_star_detection *stars = malloc(PLATESOLVER_MAX_STARS * sizeof(indigo_star_detection));
+	indigo_find_stars(header->signature, data + sizeof(indigo_raw_header), header->width, header->height, PLATESOLVER_MAX_STARS, stars, &star_count);
+	indigo_platesolver_hint hint = { 0 };
+	if (AGENT_PLATESOLVER_HINTS_RADIUS_ITEM->number.value > 0 && *FILTER_DEVICE_CONTEXT->device_name[INDIGO_FILTER_MOUNT_INDEX]) {
+		// difference between JNow and J2000 is well below any sensible search radius
+		hint.ra = DEVICE_PRIVATE_DATA->mount_ra;
+		hint.dec = DEVICE_PRIVATE_DATA->mount_dec;
+		hint.radius = AGENT_PLATESOLVER_HINTS_RADIUS_ITEM->number.value;
+	}
+	if (AGENT_PLATESOLVER_HINTS_SCALE_ITEM->number.value > 0) {
+		hint.min_scale = AGENT_PLATESOLVER_HINTS_SCALE_ITEM->number.value * 0.8;
+		hint.max_scale = AGENT_PLATESOLVER_HINTS_SCALE_ITEM->number.value * 1.2;
+	}
+	indigo_platesolver_wcs wcs;
+	if (star_count >= 5 && indigo_platesolver_solve(stars, star_count, header->width, header->height, &hint, &wcs)) {
+		AGENT_PLATESOLVER_WCS_RA_ITEM->number.value = wcs.ra;
+		AGENT_PLATESOLVER_WCS_DEC_ITEM->number.value = wcs.dec;
+		AGENT_PLATESOLVER_WCS_ANGLE_ITEM->number.value = wcs.angle;
+		AGENT_PLATESOLVER_WCS_SCALE_ITEM->number.value = wcs.scale;
+		AGENT_PLATESOLVER_WCS_WIDTH_ITEM->number.value = wcs.scale * header->width / 3600;
+		AGENT_PLATESOLVER_WCS_HEIGHT_ITEM->number.value = wcs.scale * header->height / 3600;
+		AGENT_PLATESOLVER_WCS_STARS_ITEM->number.value = wcs.matched;
+		AGENT_PLATESOLVER_WCS_PROPERTY->state = INDIGO_OK_STATE;
+		indigo_update_property(device, AGENT_PLATESOLVER_WCS_PROPERTY, NULL);
+		if (AGENT_PLATESOLVER_SOLVE_SYNC_ITEM->sw.value && !DEVICE_PRIVATE_DATA->centering) {
+			double ra = wcs.ra, dec = wcs.dec;
+			indigo_app_star(0, 0, 0, 0, &ra, &dec);
+			sync_mount(device, ra, dec);
+		}
+	} else {
+		AGENT_PLATESOLVER_WCS_STARS_ITEM->number.value = 0;
+		AGENT_PLATESOLVER_WCS_PROPERTY->state = INDIGO_ALERT_STATE;
+		indigo_update_property(device, AGENT_PLATESOLVER_WCS_PROPERTY, "Failed to solve image (%d stars detected)", star_count);
+	}
+	free(stars);
+	free(data);
+	DEVICE_PRIVATE_DATA->solve_count++;
+}
+
+static void platesolver_load_catalogue(indigo_device *device) {
+	int count = indigo_platesolver_load_catalogue(AGENT_PLATESOLVER_CATALOGUE_FILE_ITEM->text.value);
+	if (count < 0) {
+		AGENT_PLATESOLVER_CATALOGUE_PROPERTY->state = INDIGO_ALERT_STATE;
+		indigo_update_property(device, AGENT_PLATESOLVER_CATALOGUE_PROPERTY, "Failed to load %s", AGENT_PLATESOLVER_CATALOGUE_FILE_ITEM->text.value);
+	} else {
+		indigo_platesolver_build_index();
+		AGENT_PLATESOLVER_CATALOGUE_PROPERTY->state = INDIGO_OK_STATE;
+		indigo_update_property(device, AGENT_PLATESOLVER_CATALOGUE_PROPERTY, "%d stars loaded, %d stars in catalogue", count, indigo_platesolver_catalogue_size());
+	}
+}
+
+static bool centering_aborted(indigo_device *device) {
+	return AGENT_ABORT_PROCESS_PROPERTY->state == INDIGO_BUSY_STATE;
+}
+
+static bool centering_mount_at(indigo_device *device, double ra, double dec) {
+	double ra_error = fabs(DEVICE_PRIVATE_DATA->mount_ra - ra);
+	if (ra_error > 12)
+		ra_error = 24 - ra_error;
+	return ra_error * 15 * cos(dec * M_PI / 180) + fabs(DEVICE_PRIVATE_DATA->mount_dec - dec) < CENTERING_POSITION_TOLERANCE;
+}
+
+static bool centering_wait_for_mount(indigo_device *device, double ra, double dec, double timeout) {
+	// mount keeps reporting coordinates with OK state, so the command is complete only after BUSY state is left or when
+	// requested coordinates are reported (sync or short slew may be done before BUSY state is seen), ALERT means rejection
+	bool moving = false;
+	for (double elapsed = 0; elapsed < timeout; elapsed += 0.2) {
+		if (centering_aborted(device))
+			return false;
+		indigo_property_state state = DEVICE_PRIVATE_DATA->mount_eq_state;
+		if (state == INDIGO_ALERT_STATE)
+			return false;
+		if (state == INDIGO_BUSY_STATE)
+			moving = true;
+		else if (state == INDIGO_OK_STATE && (moving || centering_mount_at(device, ra, dec)))
+			return true;
+		else if (!moving && elapsed >= CENTERING_BUSY_TIMEOUT)
+			return false;
+		indigo_usleep(200000);
+	}
+	return false;
+}
+
+static bool centering_slew(indigo_device *device, double ra, double dec) {
+	indigo_app_star(0, 0, 0, 0, &ra, &dec);
+	DEVICE_PRIVATE_DATA->mount_eq_state = INDIGO_IDLE_STATE;
+	slew_mount(device, ra, dec);
+	return centering_wait_for_mount(device, ra, dec, CENTERING_SLEW_TIMEOUT);
+}
+
+static bool centering_sync(indigo_device *device, double ra, double dec) {
+	indigo_app_star(0, 0, 0, 0, &ra, &dec);
+	DEVICE_PRIVATE_DATA->mount_eq_state = INDIGO_IDLE_STATE;
+	sync_mount(device, ra, dec);
+	return centering_wait_for_mount(device, ra, dec, CENTERING_BUSY_TIMEOUT);
+}
+
+static bool centering_solve(indigo_device *device) {
+	double exposure = AGENT_CENTERING_SETTINGS_EXPOSURE_ITEM->number.value;
+	int solve_count = DEVICE_PRIVATE_DATA->solve_count;
+	indigo_change_number_property_1(FILTER_DEVICE_CONTEXT->client, FILTER_DEVICE_CONTEXT->device_name[INDIGO_FILTER_CCD_INDEX], CCD_EXPOSURE_PROPERTY_NAME, CCD_EXPOSURE_ITEM_NAME, exposure);
+	// image is solved by platesolver_process() as soon as the filter caches it
+	for (double elapsed = 0; DEVICE_PRIVATE_DATA->solve_count == solve_count && elapsed < exposure + CENTERING_SOLVE_TIMEOUT; elapsed += 0.2) {
+		if (centering_aborted(device))
+			return false;
+		indigo_usleep(200000);
+	}
+	return DEVICE_PRIVATE_DATA->solve_count != solve_count && AGENT_PLATESOLVER_WCS_PROPERTY->state == INDIGO_OK_STATE;
+}
+
+static void centering_process(indigo_device *device) {
+	double target_ra = AGENT_CENTERING_TARGET_RA_ITEM->number.value;
+	double target_dec = AGENT_CENTERING_TARGET_DEC_ITEM->number.value;
+	double tolerance = AGENT_CENTERING_SETTINGS_TOLERANCE_ITEM->number.value;
+	int iterations = (int)AGENT_CENTERING_SETTINGS_ITERATIONS_ITEM->number.value;
+	char *message = "Failed to center within tolerance";
+	DEVICE_PRIVATE_DATA->centering = true;
+	AGENT_CENTERING_STATS_ITERATION_ITEM->number.value = 0;
+	AGENT_CENTERING_STATS_PROPERTY->state = INDIGO_BUSY_STATE;
+	indigo_update_property(device, AGENT_CENTERING_STATS_PROPERTY, NULL);
+	AGENT_START_PROCESS_PROPERTY->state = INDIGO_ALERT_STATE;
+	for (int iteration = 1; iteration <= iterations; iteration++) {
+		if (!centering_slew(device, target_ra, target_dec)) {
+			message = "Slew failed";
+			break;
+		}
+		if (!centering_solve(device)) {
+			message = "Plate solving failed";
+			break;
+		}
+		double solved_ra = AGENT_PLATESOLVER_WCS_RA_ITEM->number.value;
+		double solved_dec = AGENT_PLATESOLVER_WCS_DEC_ITEM->number.value;
+		double ra_error = solved_ra - target_ra;
+		if (ra_error > 12)
+			ra_error -= 24;
+		else if (ra_error < -12)
+			ra_error += 24;
+		AGENT_CENTERING_STATS_ITERATION_ITEM->number.value = iteration;
+		AGENT_CENTERING_STATS_RA_ERROR_ITEM->number.value = ra_error * 15 * 3600 * cos(target_dec * M_PI / 180);
+		AGENT_CENTERING_STATS_DEC_ERROR_ITEM->number.value = (solved_dec - target_dec) * 3600;
+		AGENT_CENTERING_STATS_DISTANCE_ITEM->number.value = sqrt(AGENT_CENTERING_STATS_RA_ERROR_ITEM->number.value * AGENT_CENTERING_STATS_RA_ERROR_ITEM->number.value + AGENT_CENTERING_STATS_DEC_ERROR_ITEM->number.value * AGENT_CENTERING_STATS_DEC_ERROR_ITEM->number.value);
+		AGENT_CENTERING_STATS_STARS_ITEM->number.value = AGENT_PLATESOLVER_WCS_STARS_ITEM->number.value;
+		indigo_update_property(device, AGENT_CENTERING_STATS_PROPERTY, NULL);
+		if (AGENT_CENTERING_STATS_DISTANCE_ITEM->number.value <= tolerance) {
+			AGENT_START_PROCESS_PROPERTY->state = INDIGO_OK_STATE;
+			message = "Target centered";
+			break;
+		}
+		// sync to solved position, the next slew then corrects the residual error
+		if (!centering_sync(device, solved_ra, solved_dec)) {
+			message = "Sync failed";
+			break;
+		}
+	}
+	if (centering_aborted(device)) {
+		message = "Centering aborted";
+		if (*FILTER_DEVICE_CONTEXT->device_name[INDIGO_FILTER_CCD_INDEX])
+			indigo_change_switch_property_1(FILTER_DEVICE_CONTEXT->client, FILTER_DEVICE_CONTEXT->device_name[INDIGO_FILTER_CCD_INDEX], CCD_ABORT_EXPOSURE_PROPERTY_NAME, CCD_ABORT_EXPOSURE_ITEM_NAME, true);
+		if (*FILTER_DEVICE_CONTEXT->device_name[INDIGO_FILTER_MOUNT_INDEX])
+			indigo_change_switch_property_1(FILTER_DEVICE_CONTEXT->client, FILTER_DEVICE_CONTEXT->device_name[INDIGO_FILTER_MOUNT_INDEX], MOUNT_ABORT_MOTION_PROPERTY_NAME, MOUNT_ABORT_MOTION_ITEM_NAME, true);
+		AGENT_ABORT_PROCESS_PROPERTY->state = INDIGO_OK_STATE;
+		indigo_update_property(device, AGENT_ABORT_PROCESS_PROPERTY, NULL);
+	}
+	DEVICE_PRIVATE_DATA->centering = false;
+	AGENT_CENTERING_STATS_PROPERTY->state = AGENT_START_PROCESS_PROPERTY->state;
+	indigo_update_property(device, AGENT_CENTERING_STATS_PROPERTY, NULL);
+	AGENT_MOUNT_START_CENTERING_ITEM->sw.value = false;
+	indigo_update_property(device, AGENT_START_PROCESS_PROPERTY, message);
+}
+
+static void satellites_mount_tle(indigo_device *device, const char *tle) {
+	char *mount_name = FILTER_DEVICE_CONTEXT->device_name[INDIGO_FILTER_MOUNT_INDEX];
+	if (*mount_name == 0)
+		return;
+	indigo_property *property = indigo_init_text_property(NULL, mount_name, MOUNT_TRACKING_EPHEMERIS_PROPERTY_NAME, NULL, NULL, INDIGO_OK_STATE, INDIGO_RW_PERM, 3);
+	indigo_init_text_item(property->items + 0, MOUNT_TRACKING_EPHEMERIS_ELEMENTS_ITEM_NAME, NULL, "");
+	indigo_init_text_item(property->items + 1, MOUNT_TRACKING_EPHEMERIS_TABLE_ITEM_NAME, NULL, "");
+	indigo_init_text_item(property->items + 2, MOUNT_TRACKING_EPHEMERIS_TLE_ITEM_NAME, NULL, tle);
+	property->access_token = indigo_get_device_or_master_token(property->device);
+	indigo_change_property(FILTER_DEVICE_CONTEXT->client, property);
+	indigo_release_property(property);
+}
+
+static void satellites_stop(indigo_device *device) {
+	// called with mutex locked
+	if (DEVICE_PRIVATE_DATA->tle_sent)
+		satellites_mount_tle(device, "");
+	DEVICE_PRIVATE_DATA->tracked_pass = -1;
+	DEVICE_PRIVATE_DATA->tle_sent = false;
+	for (int i = 0; i < AGENT_SATELLITES_PASSES_PROPERTY->count; i++)
+		AGENT_SATELLITES_PASSES_PROPERTY->items[i].sw.value = false;
+}
+
+static void satellites_predict(indigo_device *device) {
+	pthread_mutex_lock(&DEVICE_PRIVATE_DATA->mutex);
+	satellites_stop(device);
+	struct timespec utc;
+	indigo_get_utc(&utc);
+	double start = utc.tv_sec, end = start + AGENT_SATELLITES_PREDICTION_WINDOW_ITEM->number.value * 3600;
+	int count = DEVICE_PRIVATE_DATA->pass_count = indigo_sgp4_passes(DEVICE_PRIVATE_DATA->satellite_count, DEVICE_PRIVATE_DATA->satellites, start, end, AGENT_GEOGRAPHIC_COORDINATES_LATITUDE_ITEM->number.value, AGENT_GEOGRAPHIC_COORDINATES_LONGITUDE_ITEM->number.value, AGENT_GEOGRAPHIC_COORDINATES_ELEVATION_ITEM->number.value, AGENT_SATELLITES_PREDICTION_MIN_ALTITUDE_ITEM->number.value, DEVICE_PRIVATE_DATA->passes, SATELLITES_MAX_PASSES);
+	indigo_delete_property(device, AGENT_SATELLITES_PASSES_PROPERTY, NULL);
+	AGENT_SATELLITES_PASSES_PROPERTY = indigo_resize_property(AGENT_SATELLITES_PASSES_PROPERTY, count);
+	for (int i = 0; i < count; i++) {
+		indigo_sgp4_pass *pass = DEVICE_PRIVATE_DATA->passes + i;
+		char name[INDIGO_NAME_SIZE], label[INDIGO_NAME_SIZE];
+		struct tm rise, set;
+		time_t t = (time_t)pass->rise;
+		gmtime_r(&t, &rise);
+		t = (time_t)pass->set;
+		gmtime_r(&t, &set);
+		snprintf(name, sizeof(name), "PASS_%d", i);
+		snprintf(label, sizeof(label), "%s %02d:%02d:%02d - %02d:%02d:%02d UTC, max %.0f°", DEVICE_PRIVATE_DATA->satellites[pass->satellite].name, rise.tm_hour, rise.tm_min, rise.tm_sec, set.tm_hour, set.tm_min, set.tm_sec, pass->max_altitude);
+		indigo_init_switch_item(AGENT_SATELLITES_PASSES_PROPERTY->items + i, name, label, false);
+	}
+	AGENT_SATELLITES_PASSES_PROPERTY->state = INDIGO_OK_STATE;
+	indigo_define_property(device, AGENT_SATELLITES_PASSES_PROPERTY, "%d passes predicted", count);
+	pthread_mutex_unlock(&DEVICE_PRIVATE_DATA->mutex);
+}
+
+static void satellites_load_catalogue(indigo_device *device) {
+	FILE *file = fopen(AGENT_SATELLITES_CATALOGUE_FILE_ITEM->text.value, "r");
+	if (file == NULL) {
+		AGENT_SATELLITES_CATALOGUE_PROPERTY->state = INDIGO_ALERT_STATE;
+		indigo_update_property(device, AGENT_SATELLITES_CATALOGUE_PROPERTY, "Failed to open %s", AGENT_SATELLITES_CATALOGUE_FILE_ITEM->text.value);
+		return;
+	}
+	char line[128], name[128] = "", line1[128] = "";
+	int count = 0, size = 0;
+	indigo_tle *satellites = NULL;
+	char (*tle)[INDIGO_VALUE_SIZE] = NULL;
+	// element sets are "1 ..." and "2 ..." line pairs, optionally preceded by name line
+	while (fgets(line, sizeof(line), file)) {
+		line[strcspn(line, "\r\n")] = 0;
+		if (*line == 0)
+			continue;
+		if (line[0] == '1' && line[1] == ' ') {
+			strcpy(line1, line);
+		} else if (line[0] == '2' && line[1] == ' ' && *line1) {
+			if (count == size) {
+				size = size ? 2 * size : 256;
+				satellites = realloc(satellites, size * sizeof(indigo_tle));
+				tle = realloc(tle, size * INDIGO_VALUE_SIZE);
+			}
+			snprintf(tle[count], INDIGO_VALUE_SIZE, "%s%s%s\n%s", name, *name ? "\n" : "", line1, line);
+			if (indigo_tle_parse(tle[count], satellites + count))
+				count++;
+			*name = *line1 = 0;
+		} else {
+			strcpy(name, line);
+			*line1 = 0;
+		}
+	}
+	fclose(file);
+	pthread_mutex_lock(&DEVICE_PRIVATE_DATA->mutex);
+	free(DEVICE_PRIVATE_DATA->satellites);
+	free(DEVICE_PRIVATE_DATA->satellite_tle);
+	DEVICE_PRIVATE_DATA->satellites = satellites;
+	DEVICE_PRIVATE_DATA->satellite_tle = tle;
+	DEVICE_PRIVATE_DATA->satellite_count = count;
+	pthread_mutex_unlock(&DEVICE_PRIVATE_DATA->mutex);
+	AGENT_SATELLITES_CATALOGUE_PROPERTY->state = count > 0 ? INDIGO_OK_STATE : INDIGO_ALERT_STATE;
+	indigo_update_property(device, AGENT_SATELLITES_CATALOGUE_PROPERTY, "%d satellites loaded", count);
+	satellites_predict(device);
+}
+
+static void satellites_timer_callback(indigo_device *device) {
+	pthread_mutex_lock(&DEVICE_PRIVATE_DATA->mutex);
+	int index = DEVICE_PRIVATE_DATA->tracked_pass;
+	if (index < 0) {
+		pthread_mutex_unlock(&DEVICE_PRIVATE_DATA->mutex);
+		return;
+	}
+	indigo_sgp4_pass *pass = DEVICE_PRIVATE_DATA->passes + index;
+	indigo_tle *satellite = DEVICE_PRIVATE_DATA->satellites + pass->satellite;
+	struct timespec utc;
+	indigo_get_utc(&utc);
+	double now = utc.tv_sec + utc.tv_nsec / 1e9;
+	double latitude = AGENT_GEOGRAPHIC_COORDINATES_LATITUDE_ITEM->number.value, longitude = AGENT_GEOGRAPHIC_COORDINATES_LONGITUDE_ITEM->number.value, elevation = AGENT_GEOGRAPHIC_COORDINATES_ELEVATION_ITEM->number.value;
+	if (now > pass->set) {
+		satellites_stop(device);
+		AGENT_SATELLITES_PASSES_PROPERTY->state = INDIGO_OK_STATE;
+		indigo_update_property(device, AGENT_SATELLITES_PASSES_PROPERTY, "%s has set", satellite->name);
+		AGENT_SATELLITES_POSITION_PROPERTY->state = INDIGO_IDLE_STATE;
+		indigo_update_property(device, AGENT_SATELLITES_POSITION_PROPERTY, NULL);
+		pthread_mutex_unlock(&DEVICE_PRIVATE_DATA->mutex);
+		return;
+	}
+	if (indigo_novas_topo_satellite(&DEVICE_PRIVATE_DATA->satellites_context, now, latitude, longitude, elevation, 1, satellite, false, &AGENT_SATELLITES_POSITION_RA_ITEM->number.value, &AGENT_SATELLITES_POSITION_DEC_ITEM->number.value, NULL) && indigo_sgp4_observe(1, satellite, now, latitude, longitude, elevation, NULL, NULL, &AGENT_SATELLITES_POSITION_ALT_ITEM->number.value, &AGENT_SATELLITES_POSITION_AZ_ITEM->number.value, &AGENT_SATELLITES_POSITION_RANGE_ITEM->number.value))
+		AGENT_SATELLITES_POSITION_PROPERTY->state = INDIGO_OK_STATE;
+	else
+		AGENT_SATELLITES_POSITION_PROPERTY->state = INDIGO_ALERT_STATE;
+	indigo_update_property(device, AGENT_SATELLITES_POSITION_PROPERTY, NULL);
+	// mount gets TLE shortly before rise, so it doesn't try to slew below horizon
+	if (!DEVICE_PRIVATE_DATA->tle_sent && now >= pass->rise - SATELLITES_LEAD) {
+		satellites_mount_tle(device, DEVICE_PRIVATE_DATA->satellite_tle[pass->satellite]);
+		DEVICE_PRIVATE_DATA->tle_sent = true;
+		indigo_update_property(device, AGENT_SATELLITES_PASSES_PROPERTY, "Tracking %s", satellite->name);
+	}
+	indigo_reschedule_timer(device, 1, &DEVICE_PRIVATE_DATA->satellites_timer);
+	pthread_mutex_unlock(&DEVICE_PRIVATE_DATA->mutex);
+}
+
 // -------------------------------------------------------------------------------- INDIGO agent device implementation
 
 static indigo_result agent_enumerate_properties(indigo_device *device, indigo_client *client, indigo_property *property);
@@ -223,6 +677,7 @@ static indigo_result agent_device_attach(indigo_device *device) {
 	if (indigo_filter_device_attach(device, DRIVER_NAME, DRIVER_VERSION, INDIGO_INTERFACE_CCD) == INDIGO_OK) {
 		// -------------------------------------------------------------------------------- Device properties
 		FILTER_MOUNT_LIST_PROPERTY->hidden = false;
+		FILTER_CCD_LIST_PROPERTY->hidden = false;
 		FILTER_DOME_LIST_PROPERTY->hidden = false;
 		FILTER_GPS_LIST_PROPERTY->hidden = false;
 		FILTER_JOYSTICK_LIST_PROPERTY->hidden = false;
@@ -260,10 +715,100 @@ static indigo_result agent_device_attach(indigo_device *device) {
 			return INDIGO_FAILED;
 		indigo_init_sexagesimal_number_item(AGENT_HA_TRACKING_LIMIT_ITEM, AGENT_HA_TRACKING_LIMIT_ITEM_NAME, "HA tracking limit (0 to 24)", 0, 24, 0, 24);
 		indigo_init_sexagesimal_number_item(AGENT_LOCAL_TIME_LIMIT_ITEM, AGENT_LOCAL_TIME_LIMIT_ITEM_NAME, "Time limit (0 to 24)", 0, 24, 0, 12);
+		// -------------------------------------------------------------------------------- AGENT_PLATESOLVER_SOLVE
+		AGENT_PLATESOLVER_SOLVE_PROPERTY = indigo_init_switch_property(NULL, device->name, AGENT_PLATESOLVER_SOLVE_PROPERTY_NAME, PLATESOLVER_GROUP, "Solve images", INDIGO_OK_STATE, INDIGO_RW_PERM, INDIGO_ONE_OF_MANY_RULE, 3);
+		if (AGENT_PLATESOLVER_SOLVE_PROPERTY == NULL)
+			return INDIGO_FAILED;
+		indigo_init_switch_item(AGENT_PLATESOLVER_SOLVE_DISABLED_ITEM, AGENT_PLATESOLVER_SOLVE_DISABLED_ITEM_NAME, "Disabled", true);
+		indigo_init_switch_item(AGENT_PLATESOLVER_SOLVE_SOLVE_ITEM, AGENT_PLATESOLVER_SOLVE_SOLVE_ITEM_NAME, "Solve only", false);
+		indigo_init_switch_item(AGENT_PLATESOLVER_SOLVE_SYNC_ITEM, AGENT_PLATESOLVER_SOLVE_SYNC_ITEM_NAME, "Solve and sync mount", false);
+		// -------------------------------------------------------------------------------- AGENT_PLATESOLVER_HINTS
+		AGENT_PLATESOLVER_HINTS_PROPERTY = indigo_init_number_property(NULL, device->name, AGENT_PLATESOLVER_HINTS_PROPERTY_NAME, PLATESOLVER_GROUP, "Hints", INDIGO_OK_STATE, INDIGO_RW_PERM, 2);
+		if (AGENT_PLATESOLVER_HINTS_PROPERTY == NULL)
+			return INDIGO_FAILED;
+		indigo_init_number_item(AGENT_PLATESOLVER_HINTS_RADIUS_ITEM, AGENT_PLATESOLVER_HINTS_RADIUS_ITEM_NAME, "Search radius around mount position (°, 0 = blind)", 0, 180, 1, 10);
+		indigo_init_number_item(AGENT_PLATESOLVER_HINTS_SCALE_ITEM, AGENT_PLATESOLVER_HINTS_SCALE_ITEM_NAME, "Pixel scale (\"/px, 0 = unknown)", 0, 3600, 0.1, 0);
+		// -------------------------------------------------------------------------------- AGENT_PLATESOLVER_WCS
+		AGENT_PLATESOLVER_WCS_PROPERTY = indigo_init_number_property(NULL, device->name, AGENT_PLATESOLVER_WCS_PROPERTY_NAME, PLATESOLVER_GROUP, "Solution (J2000)", INDIGO_IDLE_STATE, INDIGO_RO_PERM, 7);
+		if (AGENT_PLATESOLVER_WCS_PROPERTY == NULL)
+			return INDIGO_FAILED;
+		indigo_init_sexagesimal_number_item(AGENT_PLATESOLVER_WCS_RA_ITEM, AGENT_PLATESOLVER_WCS_RA_ITEM_NAME, "Right ascension (0 to 24 hrs)", 0, 24, 0, 0);
+		indigo_init_sexagesimal_number_item(AGENT_PLATESOLVER_WCS_DEC_ITEM, AGENT_PLATESOLVER_WCS_DEC_ITEM_NAME, "Declination (-90 to 90°)", -90, 90, 0, 0);
+		indigo_init_number_item(AGENT_PLATESOLVER_WCS_ANGLE_ITEM, AGENT_PLATESOLVER_WCS_ANGLE_ITEM_NAME, "Position angle (°, E of N)", -180, 180, 0, 0);
+		indigo_init_number_item(AGENT_PLATESOLVER_WCS_SCALE_ITEM, AGENT_PLATESOLVER_WCS_SCALE_ITEM_NAME, "Pixel scale (\"/px)", 0, 3600, 0, 0);
+		indigo_init_number_item(AGENT_PLATESOLVER_WCS_WIDTH_ITEM, AGENT_PLATESOLVER_WCS_WIDTH_ITEM_NAME, "Field width (°)", 0, 360, 0, 0);
+		indigo_init_number_item(AGENT_PLATESOLVER_WCS_HEIGHT_ITEM, AGENT_PLATESOLVER_WCS_HEIGHT_ITEM_NAME, "Field height (°)", 0, 360, 0, 0);
+		indigo_init_number_item(AGENT_PLATESOLVER_WCS_STARS_ITEM, AGENT_PLATESOLVER_WCS_STARS_ITEM_NAME, "Matched stars", 0, 1000, 0, 0);
+		// -------------------------------------------------------------------------------- AGENT_PLATESOLVER_CATALOGUE
+		AGENT_PLATESOLVER_CATALOGUE_PROPERTY = indigo_init_text_property(NULL, device->name, AGENT_PLATESOLVER_CATALOGUE_PROPERTY_NAME, PLATESOLVER_GROUP, "Additional catalogue", INDIGO_OK_STATE, INDIGO_RW_PERM, 1);
+		if (AGENT_PLATESOLVER_CATALOGUE_PROPERTY == NULL)
+			return INDIGO_FAILED;
+		indigo_init_text_item(AGENT_PLATESOLVER_CATALOGUE_FILE_ITEM, AGENT_PLATESOLVER_CATALOGUE_FILE_ITEM_NAME, "File (RA Dec Mag per line)", "");
+		// -------------------------------------------------------------------------------- AGENT_CENTERING_TARGET
+		AGENT_CENTERING_TARGET_PROPERTY = indigo_init_number_property(NULL, device->name, AGENT_CENTERING_TARGET_PROPERTY_NAME, CENTERING_GROUP, "Target (J2000)", INDIGO_OK_STATE, INDIGO_RW_PERM, 2);
+		if (AGENT_CENTERING_TARGET_PROPERTY == NULL)
+			return INDIGO_FAILED;
+		indigo_init_sexagesimal_number_item(AGENT_CENTERING_TARGET_RA_ITEM, AGENT_CENTERING_TARGET_RA_ITEM_NAME, "Right ascension (0 to 24 hrs)", 0, 24, 0, 0);
+		indigo_init_sexagesimal_number_item(AGENT_CENTERING_TARGET_DEC_ITEM, AGENT_CENTERING_TARGET_DEC_ITEM_NAME, "Declination (-90 to 90°)", -90, 90, 0, 0);
+		// -------------------------------------------------------------------------------- AGENT_CENTERING_SETTINGS
+		AGENT_CENTERING_SETTINGS_PROPERTY = indigo_init_number_property(NULL, device->name, AGENT_CENTERING_SETTINGS_PROPERTY_NAME, CENTERING_GROUP, "Settings", INDIGO_OK_STATE, INDIGO_RW_PERM, 3);
+		if (AGENT_CENTERING_SETTINGS_PROPERTY == NULL)
+			return INDIGO_FAILED;
+		indigo_init_number_item(AGENT_CENTERING_SETTINGS_EXPOSURE_ITEM, AGENT_CENTERING_SETTINGS_EXPOSURE_ITEM_NAME, "Exposure time (s)", 0, 120, 1, 5);
+		indigo_init_number_item(AGENT_CENTERING_SETTINGS_TOLERANCE_ITEM, AGENT_CENTERING_SETTINGS_TOLERANCE_ITEM_NAME, "Tolerance (\")", 1, 3600, 1, 30);
+		indigo_init_number_item(AGENT_CENTERING_SETTINGS_ITERATIONS_ITEM, AGENT_CENTERING_SETTINGS_ITERATIONS_ITEM_NAME, "Maximal number of iterations", 1, 20, 1, 5);
+		// -------------------------------------------------------------------------------- AGENT_CENTERING_STATS
+		AGENT_CENTERING_STATS_PROPERTY = indigo_init_number_property(NULL, device->name, AGENT_CENTERING_STATS_PROPERTY_NAME, CENTERING_GROUP, "Stats", INDIGO_IDLE_STATE, INDIGO_RO_PERM, 5);
+		if (AGENT_CENTERING_STATS_PROPERTY == NULL)
+			return INDIGO_FAILED;
+		indigo_init_number_item(AGENT_CENTERING_STATS_ITERATION_ITEM, AGENT_CENTERING_STATS_ITERATION_ITEM_NAME, "Iteration", 0, 20, 0, 0);
+		indigo_init_number_item(AGENT_CENTERING_STATS_RA_ERROR_ITEM, AGENT_CENTERING_STATS_RA_ERROR_ITEM_NAME, "RA error (\")", -648000, 648000, 0, 0);
+		indigo_init_number_item(AGENT_CENTERING_STATS_DEC_ERROR_ITEM, AGENT_CENTERING_STATS_DEC_ERROR_ITEM_NAME, "Dec error (\")", -648000, 648000, 0, 0);
+		indigo_init_number_item(AGENT_CENTERING_STATS_DISTANCE_ITEM, AGENT_CENTERING_STATS_DISTANCE_ITEM_NAME, "Distance (\")", 0, 648000, 0, 0);
+		indigo_init_number_item(AGENT_CENTERING_STATS_STARS_ITEM, AGENT_CENTERING_STATS_STARS_ITEM_NAME, "Matched stars", 0, 1000, 0, 0);
+		// -------------------------------------------------------------------------------- Process properties
+		AGENT_START_PROCESS_PROPERTY = indigo_init_switch_property(NULL, device->name, AGENT_START_PROCESS_PROPERTY_NAME, CENTERING_GROUP, "Start process", INDIGO_IDLE_STATE, INDIGO_RW_PERM, INDIGO_AT_MOST_ONE_RULE, 1);
+		if (AGENT_START_PROCESS_PROPERTY == NULL)
+			return INDIGO_FAILED;
+		indigo_init_switch_item(AGENT_MOUNT_START_CENTERING_ITEM, AGENT_MOUNT_START_CENTERING_ITEM_NAME, "Center target", false);
+		AGENT_ABORT_PROCESS_PROPERTY = indigo_init_switch_property(NULL, device->name, AGENT_ABORT_PROCESS_PROPERTY_NAME, CENTERING_GROUP, "Abort process", INDIGO_OK_STATE, INDIGO_RW_PERM, INDIGO_AT_MOST_ONE_RULE, 1);
+		if (AGENT_ABORT_PROCESS_PROPERTY == NULL)
+			return INDIGO_FAILED;
+		indigo_init_switch_item(AGENT_ABORT_PROCESS_ITEM, AGENT_ABORT_PROCESS_ITEM_NAME, "Abort", false);
+		// -------------------------------------------------------------------------------- AGENT_SATELLITES_CATALOGUE
+		AGENT_SATELLITES_CATALOGUE_PROPERTY = indigo_init_text_property(NULL, device->name, AGENT_SATELLITES_CATALOGUE_PROPERTY_NAME, SATELLITES_GROUP, "Catalogue", INDIGO_OK_STATE, INDIGO_RW_PERM, 1);
+		if (AGENT_SATELLITES_CATALOGUE_PROPERTY == NULL)
+			return INDIGO_FAILED;
+		indigo_init_text_item(AGENT_SATELLITES_CATALOGUE_FILE_ITEM, AGENT_SATELLITES_CATALOGUE_FILE_ITEM_NAME, "File (two-line elements)", "");
+		// -------------------------------------------------------------------------------- AGENT_SATELLITES_PREDICTION
+		AGENT_SATELLITES_PREDICTION_PROPERTY = indigo_init_number_property(NULL, device->name, AGENT_SATELLITES_PREDICTION_PROPERTY_NAME, SATELLITES_GROUP, "Pass prediction", INDIGO_OK_STATE, INDIGO_RW_PERM, 2);
+		if (AGENT_SATELLITES_PREDICTION_PROPERTY == NULL)
+			return INDIGO_FAILED;
+		indigo_init_number_item(AGENT_SATELLITES_PREDICTION_WINDOW_ITEM, AGENT_SATELLITES_PREDICTION_WINDOW_ITEM_NAME, "Window (hours)", 1, 168, 1, 24);
+		indigo_init_number_item(AGENT_SATELLITES_PREDICTION_MIN_ALTITUDE_ITEM, AGENT_SATELLITES_PREDICTION_MIN_ALTITUDE_ITEM_NAME, "Minimal altitude (°)", 0, 90, 1, 10);
+		// -------------------------------------------------------------------------------- AGENT_SATELLITES_PASSES
+		AGENT_SATELLITES_PASSES_PROPERTY = indigo_init_switch_property(NULL, device->name, AGENT_SATELLITES_PASSES_PROPERTY_NAME, SATELLITES_GROUP, "Track pass", INDIGO_OK_STATE, INDIGO_RW_PERM, INDIGO_AT_MOST_ONE_RULE, 0);
+		if (AGENT_SATELLITES_PASSES_PROPERTY == NULL)
+			return INDIGO_FAILED;
+		// -------------------------------------------------------------------------------- AGENT_SATELLITES_POSITION
+		AGENT_SATELLITES_POSITION_PROPERTY = indigo_init_number_property(NULL, device->name, AGENT_SATELLITES_POSITION_PROPERTY_NAME, SATELLITES_GROUP, "Position (J2000)", INDIGO_IDLE_STATE, INDIGO_RO_PERM, 5);
+		if (AGENT_SATELLITES_POSITION_PROPERTY == NULL)
+			return INDIGO_FAILED;
+		indigo_init_sexagesimal_number_item(AGENT_SATELLITES_POSITION_RA_ITEM, AGENT_SATELLITES_POSITION_RA_ITEM_NAME, "Right ascension (0 to 24 hrs)", 0, 24, 0, 0);
+		indigo_init_sexagesimal_number_item(AGENT_SATELLITES_POSITION_DEC_ITEM, AGENT_SATELLITES_POSITION_DEC_ITEM_NAME, "Declination (-90 to 90°)", -90, 90, 0, 0);
+		indigo_init_number_item(AGENT_SATELLITES_POSITION_ALT_ITEM, AGENT_SATELLITES_POSITION_ALT_ITEM_NAME, "Altitude (°)", -90, 90, 0, 0);
+		indigo_init_number_item(AGENT_SATELLITES_POSITION_AZ_ITEM, AGENT_SATELLITES_POSITION_AZ_ITEM_NAME, "Azimuth (°)", 0, 360, 0, 0);
+		indigo_init_number_item(AGENT_SATELLITES_POSITION_RANGE_ITEM, AGENT_SATELLITES_POSITION_RANGE_ITEM_NAME, "Range (km)", 0, 1000000, 0, 0);
+		DEVICE_PRIVATE_DATA->tracked_pass = -1;
+		indigo_novas_context_init(&DEVICE_PRIVATE_DATA->satellites_context, 0);
 		// --------------------------------------------------------------------------------
 		CONNECTION_PROPERTY->hidden = true;
 		pthread_mutex_init(&DEVICE_PRIVATE_DATA->mutex, NULL);
 		indigo_load_properties(device, false);
+		if (*AGENT_PLATESOLVER_CATALOGUE_FILE_ITEM->text.value)
+			indigo_set_timer(device, 0, platesolver_load_catalogue, NULL);
+		if (*AGENT_SATELLITES_CATALOGUE_FILE_ITEM->text.value)
+			indigo_set_timer(device, 0, satellites_load_catalogue, NULL);
 		INDIGO_DEVICE_ATTACH_LOG(DRIVER_NAME, device->name);
 		return agent_enumerate_properties(device, NULL, NULL);
 	}
@@ -283,6 +828,32 @@ static indigo_result agent_enumerate_properties(indigo_device *device, indigo_cl
 		indigo_define_property(device, AGENT_LX200_CONFIGURATION_PROPERTY, NULL);
 	if (indigo_property_match(AGENT_LIMITS_PROPERTY, property))
 		indigo_define_property(device, AGENT_LIMITS_PROPERTY, NULL);
+	if (indigo_property_match(AGENT_PLATESOLVER_SOLVE_PROPERTY, property))
+		indigo_define_property(device, AGENT_PLATESOLVER_SOLVE_PROPERTY, NULL);
+	if (indigo_property_match(AGENT_PLATESOLVER_HINTS_PROPERTY, property))
+		indigo_define_property(device, AGENT_PLATESOLVER_HINTS_PROPERTY, NULL);
+	if (indigo_property_match(AGENT_PLATESOLVER_WCS_PROPERTY, property))
+		indigo_define_property(device, AGENT_PLATESOLVER_WCS_PROPERTY, NULL);
+	if (indigo_property_match(AGENT_PLATESOLVER_CATALOGUE_PROPERTY, property))
+		indigo_define_property(device, AGENT_PLATESOLVER_CATALOGUE_PROPERTY, NULL);
+	if (indigo_property_match(AGENT_CENTERING_TARGET_PROPERTY, property))
+		indigo_define_property(device, AGENT_CENTERING_TARGET_PROPERTY, NULL);
+	if (indigo_property_match(AGENT_CENTERING_SETTINGS_PROPERTY, property))
+		indigo_define_property(device, AGENT_CENTERING_SETTINGS_PROPERTY, NULL);
+	if (indigo_property_match(AGENT_CENTERING_STATS_PROPERTY, property))
+		indigo_define_property(device, AGENT_CENTERING_STATS_PROPERTY, NULL);
+	if (indigo_property_match(AGENT_START_PROCESS_PROPERTY, property))
+		indigo_define_property(device, AGENT_START_PROCESS_PROPERTY, NULL);
+	if (indigo_property_match(AGENT_ABORT_PROCESS_PROPERTY, property))
+		indigo_define_property(device, AGENT_ABORT_PROCESS_PROPERTY, NULL);
+	if (indigo_property_match(AGENT_SATELLITES_CATALOGUE_PROPERTY, property))
+		indigo_define_property(device, AGENT_SATELLITES_CATALOGUE_PROPERTY, NULL);
+	if (indigo_property_match(AGENT_SATELLITES_PREDICTION_PROPERTY, property))
+		indigo_define_property(device, AGENT_SATELLITES_PREDICTION_PROPERTY, NULL);
+	if (indigo_property_match(AGENT_SATELLITES_PASSES_PROPERTY, property))
+		indigo_define_property(device, AGENT_SATELLITES_PASSES_PROPERTY, NULL);
+	if (indigo_property_match(AGENT_SATELLITES_POSITION_PROPERTY, property))
+		indigo_define_property(device, AGENT_SATELLITES_POSITION_PROPERTY, NULL);
 	return indigo_filter_enumerate_properties(device, client, property);
 }
 
@@ -642,6 +1213,8 @@ static indigo_result agent_change_property(indigo_device *device, indigo_client
 		AGENT_GEOGRAPHIC_COORDINATES_PROPERTY->state = INDIGO_OK_STATE;
 		save_config(device);
 		indigo_update_property(device, AGENT_GEOGRAPHIC_COORDINATES_PROPERTY, NULL);
+		if (DEVICE_PRIVATE_DATA->satellite_count > 0)
+			indigo_set_timer(device, 0, satellites_predict, NULL);
 		return INDIGO_OK;
 	} else if (indigo_property_match(AGENT_LX200_SERVER_PROPERTY, property)) {
 			// -------------------------------------------------------------------------------- LX200_SERVER
@@ -668,6 +1241,103 @@ static indigo_result agent_change_property(indigo_device *device, indigo_client
 		save_config(device);
 		indigo_update_property(device, AGENT_LIMITS_PROPERTY, NULL);
 		return INDIGO_OK;
+	} else if (indigo_property_match(AGENT_PLATESOLVER_SOLVE_PROPERTY, property)) {
+		// -------------------------------------------------------------------------------- AGENT_PLATESOLVER_SOLVE
+		indigo_property_copy_values(AGENT_PLATESOLVER_SOLVE_PROPERTY, property, false);
+		AGENT_PLATESOLVER_SOLVE_PROPERTY->state = INDIGO_OK_STATE;
+		save_config(device);
+		indigo_update_property(device, AGENT_PLATESOLVER_SOLVE_PROPERTY, NULL);
+		return INDIGO_OK;
+	} else if (indigo_property_match(AGENT_PLATESOLVER_HINTS_PROPERTY, property)) {
+		// -------------------------------------------------------------------------------- AGENT_PLATESOLVER_HINTS
+		indigo_property_copy_values(AGENT_PLATESOLVER_HINTS_PROPERTY, property, false);
+		AGENT_PLATESOLVER_HINTS_PROPERTY->state = INDIGO_OK_STATE;
+		save_config(device);
+		indigo_update_property(device, AGENT_PLATESOLVER_HINTS_PROPERTY, NULL);
+		return INDIGO_OK;
+	} else if (indigo_property_match(AGENT_PLATESOLVER_CATALOGUE_PROPERTY, property)) {
+		// -------------------------------------------------------------------------------- AGENT_PLATESOLVER_CATALOGUE
+		indigo_property_copy_values(AGENT_PLATESOLVER_CATALOGUE_PROPERTY, property, false);
+		AGENT_PLATESOLVER_CATALOGUE_PROPERTY->state = INDIGO_BUSY_STATE;
+		indigo_update_property(device, AGENT_PLATESOLVER_CATALOGUE_PROPERTY, NULL);
+		save_config(device);
+		indigo_set_timer(device, 0, platesolver_load_catalogue, NULL);
+		return INDIGO_OK;
+	} else if (indigo_property_match(AGENT_CENTERING_TARGET_PROPERTY, property)) {
+		// -------------------------------------------------------------------------------- AGENT_CENTERING_TARGET
+		indigo_property_copy_values(AGENT_CENTERING_TARGET_PROPERTY, property, false);
+		AGENT_CENTERING_TARGET_PROPERTY->state = INDIGO_OK_STATE;
+		indigo_update_property(device, AGENT_CENTERING_TARGET_PROPERTY, NULL);
+		return INDIGO_OK;
+	} else if (indigo_property_match(AGENT_CENTERING_SETTINGS_PROPERTY, property)) {
+		// -------------------------------------------------------------------------------- AGENT_CENTERING_SETTINGS
+		indigo_property_copy_values(AGENT_CENTERING_SETTINGS_PROPERTY, property, false);
+		AGENT_CENTERING_SETTINGS_PROPERTY->state = INDIGO_OK_STATE;
+		save_config(device);
+		indigo_update_property(device, AGENT_CENTERING_SETTINGS_PROPERTY, NULL);
+		return INDIGO_OK;
+	} else if (indigo_property_match(AGENT_START_PROCESS_PROPERTY, property)) {
+		// -------------------------------------------------------------------------------- AGENT_START_PROCESS
+		if (AGENT_START_PROCESS_PROPERTY->state != INDIGO_BUSY_STATE) {
+			indigo_property_copy_values(AGENT_START_PROCESS_PROPERTY, property, false);
+			if (AGENT_MOUNT_START_CENTERING_ITEM->sw.value) {
+				if (*FILTER_DEVICE_CONTEXT->device_name[INDIGO_FILTER_MOUNT_INDEX] == 0 || *FILTER_DEVICE_CONTEXT->device_name[INDIGO_FILTER_CCD_INDEX] == 0) {
+					AGENT_MOUNT_START_CENTERING_ITEM->sw.value = false;
+					AGENT_START_PROCESS_PROPERTY->state = INDIGO_ALERT_STATE;
+					indigo_update_property(device, AGENT_START_PROCESS_PROPERTY, "Mount and camera must be selected for centering");
+					return INDIGO_OK;
+				}
+				AGENT_START_PROCESS_PROPERTY->state = INDIGO_BUSY_STATE;
+				indigo_set_timer(device, 0, centering_process, NULL);
+			}
+		}
+		indigo_update_property(device, AGENT_START_PROCESS_PROPERTY, NULL);
+		return INDIGO_OK;
+	} else if (indigo_property_match(AGENT_ABORT_PROCESS_PROPERTY, property)) {
+		// -------------------------------------------------------------------------------- AGENT_ABORT_PROCESS
+		if (AGENT_START_PROCESS_PROPERTY->state == INDIGO_BUSY_STATE) {
+			indigo_property_copy_values(AGENT_ABORT_PROCESS_PROPERTY, property, false);
+			AGENT_ABORT_PROCESS_PROPERTY->state = INDIGO_BUSY_STATE;
+		}
+		AGENT_ABORT_PROCESS_ITEM->sw.value = false;
+		indigo_update_property(device, AGENT_ABORT_PROCESS_PROPERTY, NULL);
+		return INDIGO_OK;
+	} else if (indigo_property_match(AGENT_SATELLITES_CATALOGUE_PROPERTY, property)) {
+		// -------------------------------------------------------------------------------- AGENT_SATELLITES_CATALOGUE
+		indigo_property_copy_values(AGENT_SATELLITES_CATALOGUE_PROPERTY, property, false);
+		AGENT_SATELLITES_CATALOGUE_PROPERTY->state = INDIGO_BUSY_STATE;
+		indigo_update_property(device, AGENT_SATELLITES_CATALOGUE_PROPERTY, NULL);
+		save_config(device);
+		indigo_set_timer(device, 0, satellites_load_catalogue, NULL);
+		return INDIGO_OK;
+	} else if (indigo_property_match(AGENT_SATELLITES_PREDICTION_PROPERTY, property)) {
+		// -------------------------------------------------------------------------------- AGENT_SATELLITES_PREDICTION
+		indigo_property_copy_values(AGENT_SATELLITES_PREDICTION_PROPERTY, property, false);
+		AGENT_SATELLITES_PREDICTION_PROPERTY->state = INDIGO_OK_STATE;
+		save_config(device);
+		indigo_update_property(device, AGENT_SATELLITES_PREDICTION_PROPERTY, NULL);
+		indigo_set_timer(device, 0, satellites_predict, NULL);
+		return INDIGO_OK;
+	} else if (indigo_property_match(AGENT_SATELLITES_PASSES_PROPERTY, property)) {
+		// -------------------------------------------------------------------------------- AGENT_SATELLITES_PASSES
+		pthread_mutex_lock(&DEVICE_PRIVATE_DATA->mutex);
+		indigo_property_copy_values(AGENT_SATELLITES_PASSES_PROPERTY, property, false);
+		int selected = -1;
+		for (int i = 0; i < AGENT_SATELLITES_PASSES_PROPERTY->count && i < DEVICE_PRIVATE_DATA->pass_count; i++)
+			if (AGENT_SATELLITES_PASSES_PROPERTY->items[i].sw.value)
+				selected = i;
+		if (selected != DEVICE_PRIVATE_DATA->tracked_pass) {
+			satellites_stop(device);
+			if (selected >= 0) {
+				AGENT_SATELLITES_PASSES_PROPERTY->items[selected].sw.value = true;
+				DEVICE_PRIVATE_DATA->tracked_pass = selected;
+				indigo_set_timer(device, 0, satellites_timer_callback, &DEVICE_PRIVATE_DATA->satellites_timer);
+			}
+		}
+		AGENT_SATELLITES_PASSES_PROPERTY->state = selected >= 0 ? INDIGO_BUSY_STATE : INDIGO_OK_STATE;
+		indigo_update_property(device, AGENT_SATELLITES_PASSES_PROPERTY, NULL);
+		pthread_mutex_unlock(&DEVICE_PRIVATE_DATA->mutex);
+		return INDIGO_OK;
 	}
 	return indigo_filter_change_property(device, client, property);
 }
@@ -679,6 +1349,22 @@ static indigo_result agent_device_detach(indigo_device *device) {
 	indigo_release_property(AGENT_LX200_SERVER_PROPERTY);
 	indigo_release_property(AGENT_LX200_CONFIGURATION_PROPERTY);
 	indigo_release_property(AGENT_LIMITS_PROPERTY);
+	indigo_release_property(AGENT_PLATESOLVER_SOLVE_PROPERTY);
+	indigo_release_property(AGENT_PLATESOLVER_HINTS_PROPERTY);
+	indigo_release_property(AGENT_PLATESOLVER_WCS_PROPERTY);
+	indigo_release_property(AGENT_PLATESOLVER_CATALOGUE_PROPERTY);
+	indigo_release_property(AGENT_CENTERING_TARGET_PROPERTY);
+	indigo_release_property(AGENT_CENTERING_SETTINGS_PROPERTY);
+	indigo_release_property(AGENT_CENTERING_STATS_PROPERTY);
+	indigo_release_property(AGENT_START_PROCESS_PROPERTY);
+	indigo_release_property(AGENT_ABORT_PROCESS_PROPERTY);
+	indigo_cancel_timer_sync(device, &DEVICE_PRIVATE_DATA->satellites_timer);
+	indigo_release_property(AGENT_SATELLITES_CATALOGUE_PROPERTY);
+	indigo_release_property(AGENT_SATELLITES_PREDICTION_PROPERTY);
+	indigo_release_property(AGENT_SATELLITES_PASSES_PROPERTY);
+	indigo_release_property(AGENT_SATELLITES_POSITION_PROPERTY);
+	free(DEVICE_PRIVATE_DATA->satellites);
+	free(DEVICE_PRIVATE_DATA->satellite_tle);
 	pthread_mutex_destroy(&DEVICE_PRIVATE_DATA->mutex);
 	return indigo_filter_device_detach(device);
 }
@@ -701,6 +1387,7 @@ static void process_snooping(indigo_client *client, indigo_device *device, indig
 			if (CLIENT_PRIVATE_DATA->agent_site_data_source_property->items[1].sw.value)
 			set_site_coordinates(FILTER_CLIENT_CONTEXT->device);
 		} else if (!strcmp(property->name, MOUNT_EQUATORIAL_COORDINATES_PROPERTY_NAME)) {
+			CLIENT_PRIVATE_DATA->mount_eq_state = property->state;
 			for (int i = 0; i < property->count; i++) {
 				if (!strcmp(property->items[i].name, MOUNT_EQUATORIAL_COORDINATES_RA_ITEM_NAME))
 					CLIENT_PRIVATE_DATA->mount_ra = property->items[i].number.value;
@@ -897,7 +1584,17 @@ static indigo_result agent_update_property(indigo_client *client, indigo_device
 	} else {
 		process_snooping(client, device, property);
 	}
-	return indigo_filter_update_property(client, device, property, message);
+	indigo_result result = indigo_filter_update_property(client, device, property, message);
+	if (*FILTER_CLIENT_CONTEXT->device_name[INDIGO_FILTER_CCD_INDEX] && !strcmp(property->device, FILTER_CLIENT_CONTEXT->device_name[INDIGO_FILTER_CCD_INDEX]) && !strcmp(property->name, CCD_IMAGE_PROPERTY_NAME) && property->state == INDIGO_OK_STATE) {
+		// solve after filter cached the new image
+		device = FILTER_CLIENT_CONTEXT->device;
+		if ((!AGENT_PLATESOLVER_SOLVE_DISABLED_ITEM->sw.value || DEVICE_PRIVATE_DATA->centering) && AGENT_PLATESOLVER_WCS_PROPERTY->state != INDIGO_BUSY_STATE) {
+			AGENT_PLATESOLVER_WCS_PROPERTY->state = INDIGO_BUSY_STATE;
+			indigo_update_property(device, AGENT_PLATESOLVER_WCS_PROPERTY, NULL);
+			indigo_set_timer(device, 0, platesolver_process, NULL);
+		}
+	}
+	return result;
 }
 
 // -------------------------------------------------------------------------------- Initialization
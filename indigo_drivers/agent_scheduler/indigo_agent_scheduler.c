@@ -0,0 +1,927 @@
+// Copyright (c) 2020 CloudMakers, s. r. o.
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// version history
+// 2.0 by Peter Polakovic <peter.polakovic@cloudmakers.eu>
+
+/** INDIGO Scheduler agent
+ \file indigo_agent_scheduler.c
+ */
+
+#define DRIVER_VERSION 0x0001
+#define DRIVER_NAME	"indigo_agent_scheduler"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include <assert.h>
+#include <pthread.h>
+
+#include <indigo/indigo_driver_xml.h>
+#include <indigo/indigo_filter.h>
+#include <indigo/indigo_mount_driver.h>
+#include <indigo/indigo_novas.h>
+#include <indigo/indigo_ephemeris.h>
+
+#include "indigo_agent_scheduler.h"
+
+#define DEVICE_PRIVATE_DATA										((agent_private_data *)device->private_data)
+#define CLIENT_PRIVATE_DATA										((agent_private_data *)FILTER_CLIENT_CONTEXT->device->private_data)
+
+#define AGENT_SCHEDULER_TARGETS_PROPERTY			(DEVICE_PRIVATE_DATA->agent_targets_property)
+
+#define AGENT_SCHEDULER_WINDOWS_PROPERTY			(DEVICE_PRIVATE_DATA->agent_windows_property)
+
+#define AGENT_SCHEDULER_SETTINGS_PROPERTY			(DEVICE_PRIVATE_DATA->agent_settings_property)
+#define AGENT_SCHEDULER_SETTINGS_MIN_ALTITUDE_ITEM	(AGENT_SCHEDULER_SETTINGS_PROPERTY->items+0)
+#define AGENT_SCHEDULER_SETTINGS_MOON_DISTANCE_ITEM	(AGENT_SCHEDULER_SETTINGS_PROPERTY->items+1)
+#define AGENT_SCHEDULER_SETTINGS_SUN_ALTITUDE_ITEM	(AGENT_SCHEDULER_SETTINGS_PROPERTY->items+2)
+#define AGENT_SCHEDULER_SETTINGS_RETRIES_ITEM	(AGENT_SCHEDULER_SETTINGS_PROPERTY->items+3)
+#define AGENT_SCHEDULER_SETTINGS_SPEED_ITEM		(AGENT_SCHEDULER_SETTINGS_PROPERTY->items+4)
+
+#define AGENT_SCHEDULER_CLOCK_PROPERTY				(DEVICE_PRIVATE_DATA->agent_clock_property)
+#define AGENT_SCHEDULER_CLOCK_REAL_ITEM				(AGENT_SCHEDULER_CLOCK_PROPERTY->items+0)
+#define AGENT_SCHEDULER_CLOCK_SIMULATED_ITEM	(AGENT_SCHEDULER_CLOCK_PROPERTY->items+1)
+
+#define AGENT_SCHEDULER_SIMULATION_PROPERTY		(DEVICE_PRIVATE_DATA->agent_simulation_property)
+#define AGENT_SCHEDULER_SIMULATION_START_ITEM	(AGENT_SCHEDULER_SIMULATION_PROPERTY->items+0)
+
+#define AGENT_SCHEDULER_STATUS_PROPERTY				(DEVICE_PRIVATE_DATA->agent_status_property)
+#define AGENT_SCHEDULER_STATUS_CLOCK_ITEM			(AGENT_SCHEDULER_STATUS_PROPERTY->items+0)
+#define AGENT_SCHEDULER_STATUS_TARGET_ITEM		(AGENT_SCHEDULER_STATUS_PROPERTY->items+1)
+#define AGENT_SCHEDULER_STATUS_STEP_ITEM			(AGENT_SCHEDULER_STATUS_PROPERTY->items+2)
+
+#define AGENT_START_PROCESS_PROPERTY					(DEVICE_PRIVATE_DATA->agent_start_process_property)
+#define AGENT_SCHEDULER_START_SCHEDULE_ITEM		(AGENT_START_PROCESS_PROPERTY->items+0)
+
+#define AGENT_ABORT_PROCESS_PROPERTY					(DEVICE_PRIVATE_DATA->agent_abort_process_property)
+#define AGENT_ABORT_PROCESS_ITEM							(AGENT_ABORT_PROCESS_PROPERTY->items+0)
+
+#define SCHEDULER_MAX_TARGETS									16
+#define SCHEDULER_WINDOW_STEP									300
+#define SCHEDULER_WINDOW_LENGTH								(24 * 3600)
+
+// nominal step durations used to advance simulated clock
+#define SCHEDULER_SLEW_RATE										2.0
+#define SCHEDULER_SLEW_SETTLE									10
+#define SCHEDULER_FRAME_OVERHEAD							5
+#define SCHEDULER_CENTER_ITERATIONS						3
+#define SCHEDULER_FOCUS_FRAMES								20
+#define SCHEDULER_GUIDE_DURATION							60
+
+#define SCHEDULER_SLEW_TIMEOUT								300
+#define SCHEDULER_CENTER_TIMEOUT							900
+#define SCHEDULER_FOCUS_TIMEOUT								900
+#define SCHEDULER_GUIDE_TIMEOUT								300
+
+// AGENT_GUIDER_STATS.PHASE values
+#define GUIDER_PHASE_GUIDING									0
+
+typedef struct {
+	char name[INDIGO_NAME_SIZE];
+	double ra, dec;
+	double app_ra, app_dec;
+	int priority;
+	double min_altitude, moon_distance;
+	time_t after, before;
+	double exposure;
+	int count;
+	double center, focus;
+	bool guide;
+	int done, attempts;
+	bool failed;
+	time_t skip_until;
+	time_t window_start, window_end;
+} scheduler_target;
+
+typedef struct {
+	indigo_property *agent_targets_property;
+	indigo_property *agent_windows_property;
+	indigo_property *agent_settings_property;
+	indigo_property *agent_clock_property;
+	indigo_property *agent_simulation_property;
+	indigo_property *agent_status_property;
+	indigo_property *agent_start_process_property;
+	indigo_property *agent_abort_process_property;
+	scheduler_target targets[SCHEDULER_MAX_TARGETS];
+	int target_count;
+	time_t clock;
+	double last_ra, last_dec;
+	double latitude, longitude, elevation;
+	indigo_property_state imager_state, guider_state, mount_state, park_state, centering_state;
+	int guider_phase;
+	pthread_mutex_t mutex;
+} agent_private_data;
+
+// -------------------------------------------------------------------------------- INDIGO agent common code
+
+static void save_config(indigo_device *device) {
+	pthread_mutex_lock(&DEVICE_PRIVATE_DATA->mutex);
+	indigo_save_property(device, NULL, AGENT_SCHEDULER_TARGETS_PROPERTY);
+	indigo_save_property(device, NULL, AGENT_SCHEDULER_SETTINGS_PROPERTY);
+	indigo_save_property(device, NULL, AGENT_SCHEDULER_CLOCK_PROPERTY);
+	indigo_save_property(device, NULL, AGENT_SCHEDULER_SIMULATION_PROPERTY);
+	if (indigo_commit_saved_properties(device, NULL) == INDIGO_OK)
+		CONFIG_PROPERTY->state = INDIGO_OK_STATE;
+	else
+		CONFIG_PROPERTY->state = INDIGO_ALERT_STATE;
+	CONFIG_SAVE_ITEM->sw.value = false;
+	indigo_update_property(device, CONFIG_PROPERTY, NULL);
+	pthread_mutex_unlock(&DEVICE_PRIVATE_DATA->mutex);
+}
+
+static char *related_agent(indigo_device *device, const char *prefix) {
+	indigo_property *list = FILTER_DEVICE_CONTEXT->filter_related_agent_list_property;
+	for (int i = 0; i < list->count; i++) {
+		indigo_item *item = list->items + i;
+		if (item->sw.value && !strncmp(prefix, item->name, strlen(prefix)))
+			return item->name;
+	}
+	return NULL;
+}
+
+static bool parse_target(char *text, scheduler_target *target, indigo_device *device) {
+	char buffer[INDIGO_VALUE_SIZE], *pnt;
+	bool has_ra = false, has_dec = false;
+	memset(target, 0, sizeof(scheduler_target));
+	target->min_altitude = AGENT_SCHEDULER_SETTINGS_MIN_ALTITUDE_ITEM->number.value;
+	target->moon_distance = AGENT_SCHEDULER_SETTINGS_MOON_DISTANCE_ITEM->number.value;
+	strncpy(buffer, text, INDIGO_VALUE_SIZE - 1);
+	buffer[INDIGO_VALUE_SIZE - 1] = 0;
+	for (char *token = strtok_r(buffer, ";", &pnt); token; token = strtok_r(NULL, ";", &pnt)) {
+		char *value = strchr(token, '=');
+		if (value == NULL)
+			continue;
+		*value++ = 0;
+		if (!strcasecmp(token, "name")) {
+			strncpy(target->name, value, INDIGO_NAME_SIZE - 1);
+		} else if (!strcasecmp(token, "ra")) {
+			target->ra = indigo_atod(value);
+			has_ra = true;
+		} else if (!strcasecmp(token, "dec")) {
+			target->dec = indigo_atod(value);
+			has_dec = true;
+		} else if (!strcasecmp(token, "priority")) {
+			target->priority = atoi(value);
+		} else if (!strcasecmp(token, "alt")) {
+			target->min_altitude = atof(value);
+		} else if (!strcasecmp(token, "moon")) {
+			target->moon_distance = atof(value);
+		} else if (!strcasecmp(token, "after")) {
+			target->after = indigo_isogmtotime(value);
+		} else if (!strcasecmp(token, "before")) {
+			target->before = indigo_isogmtotime(value);
+		} else if (!strcasecmp(token, "exposure")) {
+			target->exposure = atof(value);
+		} else if (!strcasecmp(token, "count")) {
+			target->count = atoi(value);
+		} else if (!strcasecmp(token, "center")) {
+			target->center = atof(value);
+		} else if (!strcasecmp(token, "focus")) {
+			target->focus = atof(value);
+		} else if (!strcasecmp(token, "guide")) {
+			target->guide = atoi(value) != 0;
+		}
+	}
+	if (*target->name == 0)
+		snprintf(target->name, INDIGO_NAME_SIZE, "%s %s", indigo_dtos(target->ra, "%02d:%02d:%02d"), indigo_dtos(target->dec, "%+03d:%02d:%02d"));
+	return has_ra && has_dec && target->ra >= 0 && target->ra < 24 && fabs(target->dec) <= 90 && target->exposure > 0 && target->count > 0;
+}
+
+static bool is_pending(scheduler_target *target) {
+	return !target->failed && target->done < target->count;
+}
+
+static double angular_distance(double ra1, double dec1, double ra2, double dec2) {
+	ra1 *= M_PI / 12;
+	ra2 *= M_PI / 12;
+	dec1 *= M_PI / 180;
+	dec2 *= M_PI / 180;
+	double c = sin(dec1) * sin(dec2) + cos(dec1) * cos(dec2) * cos(ra1 - ra2);
+	return acos(fmax(-1, fmin(1, c))) * 180 / M_PI;
+}
+
+static void compute_windows(indigo_device *device, time_t start) {
+	int count = DEVICE_PRIVATE_DATA->target_count;
+	scheduler_target *targets = DEVICE_PRIVATE_DATA->targets;
+	double latitude = DEVICE_PRIVATE_DATA->latitude, longitude = DEVICE_PRIVATE_DATA->longitude, elevation = DEVICE_PRIVATE_DATA->elevation;
+	double sun_altitude = AGENT_SCHEDULER_SETTINGS_SUN_ALTITUDE_ITEM->number.value;
+	double ra[SCHEDULER_MAX_TARGETS + 2], dec[SCHEDULER_MAX_TARGETS + 2], alt[SCHEDULER_MAX_TARGETS + 2], az[SCHEDULER_MAX_TARGETS + 2];
+	static const int bodies[] = { INDIGO_EPHEMERIS_SUN, INDIGO_EPHEMERIS_MOON };
+	indigo_novas_context context;
+	indigo_novas_context_init(&context, SCHEDULER_WINDOW_STEP);
+	// precession and nutation don't change significantly within the window
+	for (int i = 0; i < count; i++) {
+		targets[i].app_ra = targets[i].ra;
+		targets[i].app_dec = targets[i].dec;
+		targets[i].window_start = targets[i].window_end = 0;
+	}
+	for (int i = 0; i < count; i++) {
+		indigo_novas_app_star(&context, &start, 1, NULL, NULL, NULL, NULL, &targets[i].app_ra, &targets[i].app_dec);
+		ra[i + 2] = targets[i].app_ra;
+		dec[i + 2] = targets[i].app_dec;
+	}
+	for (time_t time = start; time <= start + SCHEDULER_WINDOW_LENGTH; time += SCHEDULER_WINDOW_STEP) {
+		if (!indigo_novas_topo_planet(&context, &time, latitude, longitude, elevation, 2, bodies, ra, dec, NULL))
+			continue;
+		indigo_novas_eq2hor(&context, &time, latitude, longitude, elevation, count + 2, ra, dec, alt, az);
+		for (int i = 0; i < count; i++) {
+			scheduler_target *target = targets + i;
+			if (!is_pending(target) || target->window_end)
+				continue;
+			bool observable = alt[0] < sun_altitude && alt[i + 2] > target->min_altitude && time >= target->skip_until && time >= target->after && (target->before == 0 || time < target->before);
+			if (observable && target->moon_distance > 0 && alt[1] > 0)
+				observable = angular_distance(ra[1], dec[1], ra[i + 2], dec[i + 2]) > target->moon_distance;
+			if (observable && target->window_start == 0)
+				target->window_start = time;
+			else if (!observable && target->window_start)
+				target->window_end = time;
+		}
+	}
+	for (int i = 0; i < count; i++) {
+		scheduler_target *target = targets + i;
+		if (target->window_start && target->window_end == 0)
+			target->window_end = start + SCHEDULER_WINDOW_LENGTH;
+		char *value = AGENT_SCHEDULER_WINDOWS_PROPERTY->items[i].text.value;
+		if (target->failed) {
+			snprintf(value, INDIGO_VALUE_SIZE, "%s: failed, %d/%d frames", target->name, target->done, target->count);
+		} else if (target->done >= target->count) {
+			snprintf(value, INDIGO_VALUE_SIZE, "%s: finished, %d/%d frames", target->name, target->done, target->count);
+		} else if (target->window_start) {
+			struct tm from, to;
+			gmtime_r(&target->window_start, &from);
+			gmtime_r(&target->window_end, &to);
+			snprintf(value, INDIGO_VALUE_SIZE, "%s: %02d:%02d - %02d:%02d UTC, %d/%d frames", target->name, from.tm_hour, from.tm_min, to.tm_hour, to.tm_min, target->done, target->count);
+		} else {
+			snprintf(value, INDIGO_VALUE_SIZE, "%s: not observable, %d/%d frames", target->name, target->done, target->count);
+		}
+	}
+	for (int i = count; i < AGENT_SCHEDULER_WINDOWS_PROPERTY->count; i++)
+		*AGENT_SCHEDULER_WINDOWS_PROPERTY->items[i].text.value = 0;
+	AGENT_SCHEDULER_WINDOWS_PROPERTY->state = INDIGO_OK_STATE;
+	indigo_update_property(device, AGENT_SCHEDULER_WINDOWS_PROPERTY, NULL);
+}
+
+static bool load_targets(indigo_device *device) {
+	int count = 0;
+	for (int i = 0; i < AGENT_SCHEDULER_TARGETS_PROPERTY->count; i++) {
+		char *text = AGENT_SCHEDULER_TARGETS_PROPERTY->items[i].text.value;
+		if (*text == 0)
+			continue;
+		if (parse_target(text, DEVICE_PRIVATE_DATA->targets + count, device)) {
+			count++;
+		} else {
+			indigo_send_message(device, "Target #%d is invalid", i + 1);
+			DEVICE_PRIVATE_DATA->target_count = 0;
+			return false;
+		}
+	}
+	DEVICE_PRIVATE_DATA->target_count = count;
+	return true;
+}
+
+static void plan_process(indigo_device *device) {
+	if (AGENT_START_PROCESS_PROPERTY->state == INDIGO_BUSY_STATE)
+		return;
+	if (!load_targets(device)) {
+		AGENT_SCHEDULER_TARGETS_PROPERTY->state = INDIGO_ALERT_STATE;
+		indigo_update_property(device, AGENT_SCHEDULER_TARGETS_PROPERTY, NULL);
+		return;
+	}
+	time_t start = time(NULL);
+	if (AGENT_SCHEDULER_CLOCK_SIMULATED_ITEM->sw.value && *AGENT_SCHEDULER_SIMULATION_START_ITEM->text.value)
+		start = indigo_isogmtotime(AGENT_SCHEDULER_SIMULATION_START_ITEM->text.value);
+	compute_windows(device, start);
+}
+
+// -------------------------------------------------------------------------------- Session clock
+
+static time_t clock_now(indigo_device *device) {
+	if (AGENT_SCHEDULER_CLOCK_SIMULATED_ITEM->sw.value)
+		return DEVICE_PRIVATE_DATA->clock;
+	struct timespec utc;
+	indigo_get_utc(&utc);
+	return utc.tv_sec;
+}
+
+static void update_status(indigo_device *device, const char *target, const char *step) {
+	indigo_timetoisogm(clock_now(device), AGENT_SCHEDULER_STATUS_CLOCK_ITEM->text.value, INDIGO_VALUE_SIZE);
+	if (target) {
+		strncpy(AGENT_SCHEDULER_STATUS_TARGET_ITEM->text.value, target, INDIGO_VALUE_SIZE - 1);
+		AGENT_SCHEDULER_STATUS_TARGET_ITEM->text.value[INDIGO_VALUE_SIZE - 1] = 0;
+	}
+	if (step) {
+		strncpy(AGENT_SCHEDULER_STATUS_STEP_ITEM->text.value, step, INDIGO_VALUE_SIZE - 1);
+		AGENT_SCHEDULER_STATUS_STEP_ITEM->text.value[INDIGO_VALUE_SIZE - 1] = 0;
+	}
+	AGENT_SCHEDULER_STATUS_PROPERTY->state = AGENT_START_PROCESS_PROPERTY->state;
+	indigo_update_property(device, AGENT_SCHEDULER_STATUS_PROPERTY, NULL);
+}
+
+static bool aborted(indigo_device *device) {
+	return AGENT_ABORT_PROCESS_PROPERTY->state == INDIGO_BUSY_STATE;
+}
+
+// simulated clock is advanced by nominal duration of the step, real clock runs by itself
+static void clock_advance(indigo_device *device, double seconds) {
+	if (AGENT_SCHEDULER_CLOCK_SIMULATED_ITEM->sw.value)
+		DEVICE_PRIVATE_DATA->clock += (time_t)ceil(seconds);
+}
+
+static void clock_wait_until(indigo_device *device, time_t time) {
+	if (AGENT_SCHEDULER_CLOCK_SIMULATED_ITEM->sw.value) {
+		if (DEVICE_PRIVATE_DATA->clock < time)
+			DEVICE_PRIVATE_DATA->clock = time;
+		return;
+	}
+	while (!aborted(device) && clock_now(device) < time) {
+		indigo_usleep(ONE_SECOND_DELAY);
+		if (clock_now(device) % 60 == 0)
+			update_status(device, NULL, NULL);
+	}
+}
+
+static bool wait_for_state(indigo_device *device, indigo_property_state *state, double timeout) {
+	for (double elapsed = 0; *state == INDIGO_BUSY_STATE && elapsed < timeout; elapsed += 0.2) {
+		if (aborted(device))
+			return false;
+		indigo_usleep(200000);
+	}
+	return *state == INDIGO_OK_STATE;
+}
+
+static double exposure_time(indigo_device *device, double exposure) {
+	if (AGENT_SCHEDULER_CLOCK_SIMULATED_ITEM->sw.value)
+		return fmax(0.01, exposure / AGENT_SCHEDULER_SETTINGS_SPEED_ITEM->number.value);
+	return exposure;
+}
+
+// -------------------------------------------------------------------------------- Session steps
+
+static void abort_agent(indigo_device *device, const char *prefix, indigo_property_state *state) {
+	char *agent = related_agent(device, prefix);
+	if (agent && *state == INDIGO_BUSY_STATE) {
+		indigo_change_switch_property_1(FILTER_DEVICE_CONTEXT->client, agent, AGENT_ABORT_PROCESS_PROPERTY_NAME, AGENT_ABORT_PROCESS_ITEM_NAME, true);
+		wait_for_state(device, state, 30);
+	}
+}
+
+static void abort_agents(indigo_device *device) {
+	abort_agent(device, "Imager Agent", &DEVICE_PRIVATE_DATA->imager_state);
+	abort_agent(device, "Guider Agent", &DEVICE_PRIVATE_DATA->guider_state);
+	abort_agent(device, "Mount Agent", &DEVICE_PRIVATE_DATA->centering_state);
+}
+
+static bool imager_start(indigo_device *device, const char *process, int count, double exposure, double timeout) {
+	char *imager = related_agent(device, "Imager Agent");
+	static const char *names[] = { AGENT_IMAGER_BATCH_COUNT_ITEM_NAME, AGENT_IMAGER_BATCH_EXPOSURE_ITEM_NAME, AGENT_IMAGER_BATCH_DELAY_ITEM_NAME };
+	double values[] = { count, exposure, 0 };
+	indigo_change_number_property(FILTER_DEVICE_CONTEXT->client, imager, AGENT_IMAGER_BATCH_PROPERTY_NAME, 3, names, values);
+	DEVICE_PRIVATE_DATA->imager_state = INDIGO_BUSY_STATE;
+	indigo_change_switch_property_1(FILTER_DEVICE_CONTEXT->client, imager, AGENT_START_PROCESS_PROPERTY_NAME, process, true);
+	return wait_for_state(device, &DEVICE_PRIVATE_DATA->imager_state, timeout);
+}
+
+static bool mount_slew(indigo_device *device, double ra, double dec) {
+	char *mount = related_agent(device, "Mount Agent");
+	indigo_change_switch_property_1(FILTER_DEVICE_CONTEXT->client, mount, MOUNT_ON_COORDINATES_SET_PROPERTY_NAME, MOUNT_ON_COORDINATES_SET_TRACK_ITEM_NAME, true);
+	static const char *names[] = { MOUNT_EQUATORIAL_COORDINATES_RA_ITEM_NAME, MOUNT_EQUATORIAL_COORDINATES_DEC_ITEM_NAME };
+	double values[] = { ra, dec };
+	DEVICE_PRIVATE_DATA->mount_state = INDIGO_BUSY_STATE;
+	indigo_change_number_property(FILTER_DEVICE_CONTEXT->client, mount, MOUNT_EQUATORIAL_COORDINATES_PROPERTY_NAME, 2, names, values);
+	return wait_for_state(device, &DEVICE_PRIVATE_DATA->mount_state, SCHEDULER_SLEW_TIMEOUT);
+}
+
+static void mount_park(indigo_device *device, bool park) {
+	char *mount = related_agent(device, "Mount Agent");
+	if (mount) {
+		DEVICE_PRIVATE_DATA->park_state = INDIGO_BUSY_STATE;
+		indigo_change_switch_property_1(FILTER_DEVICE_CONTEXT->client, mount, MOUNT_PARK_PROPERTY_NAME, park ? MOUNT_PARK_PARKED_ITEM_NAME : MOUNT_PARK_UNPARKED_ITEM_NAME, true);
+		wait_for_state(device, &DEVICE_PRIVATE_DATA->park_state, SCHEDULER_SLEW_TIMEOUT);
+	}
+	clock_advance(device, SCHEDULER_SLEW_SETTLE);
+}
+
+static bool slew_step(indigo_device *device, scheduler_target *target) {
+	update_status(device, NULL, "Slew");
+	double distance = angular_distance(DEVICE_PRIVATE_DATA->last_ra, DEVICE_PRIVATE_DATA->last_dec, target->ra, target->dec);
+	if (related_agent(device, "Mount Agent")) {
+		// apparent position at session clock, not at wall clock, so simulated session slews where the plan expects
+		double ra = target->ra, dec = target->dec;
+		time_t now = clock_now(device);
+		indigo_novas_context context;
+		indigo_novas_context_init(&context, SCHEDULER_WINDOW_STEP);
+		indigo_novas_app_star(&context, &now, 1, NULL, NULL, NULL, NULL, &ra, &dec);
+		if (!mount_slew(device, ra, dec)) {
+			indigo_send_message(device, "Slew to %s failed", target->name);
+			return false;
+		}
+	}
+	DEVICE_PRIVATE_DATA->last_ra = target->ra;
+	DEVICE_PRIVATE_DATA->last_dec = target->dec;
+	clock_advance(device, distance / SCHEDULER_SLEW_RATE + SCHEDULER_SLEW_SETTLE);
+	return true;
+}
+
+static bool center_step(indigo_device *device, scheduler_target *target) {
+	update_status(device, NULL, "Center");
+	char *mount = related_agent(device, "Mount Agent");
+	bool result = true;
+	if (mount) {
+		// mount agent iterates exposure, solve, sync and re-slew until target is within its tolerance
+		static const char *target_names[] = { AGENT_CENTERING_TARGET_RA_ITEM_NAME, AGENT_CENTERING_TARGET_DEC_ITEM_NAME };
+		double target_values[] = { target->ra, target->dec };
+		indigo_change_number_property(FILTER_DEVICE_CONTEXT->client, mount, AGENT_CENTERING_TARGET_PROPERTY_NAME, 2, target_names, target_values);
+		indigo_change_number_property_1(FILTER_DEVICE_CONTEXT->client, mount, AGENT_CENTERING_SETTINGS_PROPERTY_NAME, AGENT_CENTERING_SETTINGS_EXPOSURE_ITEM_NAME, exposure_time(device, target->center));
+		DEVICE_PRIVATE_DATA->centering_state = INDIGO_BUSY_STATE;
+		indigo_change_switch_property_1(FILTER_DEVICE_CONTEXT->client, mount, AGENT_START_PROCESS_PROPERTY_NAME, AGENT_MOUNT_START_CENTERING_ITEM_NAME, true);
+		result = wait_for_state(device, &DEVICE_PRIVATE_DATA->centering_state, SCHEDULER_CENTER_TIMEOUT);
+		if (!result)
+			indigo_send_message(device, "Centering of %s failed", target->name);
+	}
+	clock_advance(device, SCHEDULER_CENTER_ITERATIONS * (target->center + SCHEDULER_FRAME_OVERHEAD + SCHEDULER_SLEW_SETTLE));
+	return result;
+}
+
+static bool focus_step(indigo_device *device, scheduler_target *target) {
+	update_status(device, NULL, "Focus");
+	bool result = true;
+	if (related_agent(device, "Imager Agent")) {
+		result = imager_start(device, AGENT_IMAGER_START_FOCUSING_ITEM_NAME, 1, exposure_time(device, target->focus), SCHEDULER_FOCUS_TIMEOUT);
+		if (!result)
+			indigo_send_message(device, "Autofocus on %s failed, continuing with current focus", target->name);
+	}
+	clock_advance(device, SCHEDULER_FOCUS_FRAMES * (target->focus + SCHEDULER_FRAME_OVERHEAD));
+	return result;
+}
+
+static bool guide_step(indigo_device *device, scheduler_target *target) {
+	update_status(device, NULL, "Guide");
+	char *guider = related_agent(device, "Guider Agent");
+	if (guider) {
+		DEVICE_PRIVATE_DATA->guider_phase = -1;
+		DEVICE_PRIVATE_DATA->guider_state = INDIGO_BUSY_STATE;
+		indigo_change_switch_property_1(FILTER_DEVICE_CONTEXT->client, guider, AGENT_START_PROCESS_PROPERTY_NAME, AGENT_GUIDER_START_CALIBRATION_AND_GUIDING_ITEM_NAME, true);
+		// guiding process stays busy, so wait for guiding phase instead
+		for (double elapsed = 0; DEVICE_PRIVATE_DATA->guider_phase != GUIDER_PHASE_GUIDING && elapsed < SCHEDULER_GUIDE_TIMEOUT; elapsed += 0.2) {
+			if (aborted(device) || DEVICE_PRIVATE_DATA->guider_state != INDIGO_BUSY_STATE)
+				break;
+			indigo_usleep(200000);
+		}
+		if (DEVICE_PRIVATE_DATA->guider_phase != GUIDER_PHASE_GUIDING || DEVICE_PRIVATE_DATA->guider_state != INDIGO_BUSY_STATE) {
+			indigo_send_message(device, "Guiding on %s failed", target->name);
+			return false;
+		}
+	}
+	clock_advance(device, SCHEDULER_GUIDE_DURATION);
+	return true;
+}
+
+static bool capture_step(indigo_device *device, scheduler_target *target, int frames) {
+	update_status(device, NULL, "Capture");
+	if (related_agent(device, "Imager Agent")) {
+		double exposure = exposure_time(device, target->exposure);
+		if (!imager_start(device, AGENT_IMAGER_START_EXPOSURE_ITEM_NAME, frames, exposure, frames * (exposure + 60) + 60)) {
+			indigo_send_message(device, "Capture of %s failed", target->name);
+			return false;
+		}
+	}
+	target->done += frames;
+	clock_advance(device, frames * (target->exposure + SCHEDULER_FRAME_OVERHEAD));
+	return true;
+}
+
+static void observe_target(indigo_device *device, scheduler_target *target) {
+	time_t now = clock_now(device);
+	int frames = (int)((target->window_end - now) / (target->exposure + SCHEDULER_FRAME_OVERHEAD));
+	if (frames > target->count - target->done)
+		frames = target->count - target->done;
+	if (frames < 1) {
+		// rest of the window is too short even for a single frame
+		target->skip_until = target->window_end;
+		return;
+	}
+	update_status(device, target->name, NULL);
+	indigo_send_message(device, "Observing %s, %d frames", target->name, frames);
+	bool result = slew_step(device, target);
+	if (result && target->center > 0 && !aborted(device))
+		result = center_step(device, target);
+	// failed autofocus is not fatal, frames taken with previous focus are still usable
+	if (result && target->focus > 0 && !aborted(device) && !focus_step(device, target))
+		INDIGO_DRIVER_LOG(DRIVER_NAME, "Autofocus on %s failed, continuing with current focus", target->name);
+	if (result && target->guide && !aborted(device))
+		result = guide_step(device, target);
+	if (result && !aborted(device))
+		result = capture_step(device, target, frames);
+	if (aborted(device))
+		return;
+	abort_agent(device, "Guider Agent", &DEVICE_PRIVATE_DATA->guider_state);
+	if (!result) {
+		abort_agents(device);
+		if (++target->attempts > AGENT_SCHEDULER_SETTINGS_RETRIES_ITEM->number.value) {
+			target->failed = true;
+			indigo_send_message(device, "%s failed", target->name);
+		} else {
+			indigo_send_message(device, "%s will be retried", target->name);
+		}
+	}
+}
+
+static void scheduler_process(indigo_device *device) {
+	struct timespec utc;
+	indigo_get_utc(&utc);
+	DEVICE_PRIVATE_DATA->clock = utc.tv_sec;
+	if (AGENT_SCHEDULER_CLOCK_SIMULATED_ITEM->sw.value && *AGENT_SCHEDULER_SIMULATION_START_ITEM->text.value)
+		DEVICE_PRIVATE_DATA->clock = indigo_isogmtotime(AGENT_SCHEDULER_SIMULATION_START_ITEM->text.value);
+	DEVICE_PRIVATE_DATA->last_ra = DEVICE_PRIVATE_DATA->last_dec = 0;
+	if (load_targets(device)) {
+		indigo_send_message(device, "Session started with %d targets", DEVICE_PRIVATE_DATA->target_count);
+		mount_park(device, false);
+		while (!aborted(device)) {
+			time_t now = clock_now(device);
+			compute_windows(device, now);
+			scheduler_target *best = NULL;
+			time_t next = 0;
+			for (int i = 0; i < DEVICE_PRIVATE_DATA->target_count; i++) {
+				scheduler_target *target = DEVICE_PRIVATE_DATA->targets + i;
+				if (!is_pending(target) || target->window_start == 0)
+					continue;
+				if (target->window_start <= now) {
+					// higher priority first, then target closer to the end of its window
+					if (best == NULL || target->priority > best->priority || (target->priority == best->priority && target->window_end < best->window_end))
+						best = target;
+				} else if (next == 0 || target->window_start < next) {
+					next = target->window_start;
+				}
+			}
+			if (best) {
+				observe_target(device, best);
+			} else if (next) {
+				update_status(device, "", "Wait");
+				clock_wait_until(device, next);
+			} else {
+				break;
+			}
+		}
+		if (!aborted(device)) {
+			update_status(device, "", "Park");
+			mount_park(device, true);
+			AGENT_START_PROCESS_PROPERTY->state = INDIGO_OK_STATE;
+		} else {
+			abort_agents(device);
+			AGENT_START_PROCESS_PROPERTY->state = INDIGO_ALERT_STATE;
+		}
+		compute_windows(device, clock_now(device));
+	} else {
+		AGENT_START_PROCESS_PROPERTY->state = INDIGO_ALERT_STATE;
+	}
+	update_status(device, "", "");
+	AGENT_SCHEDULER_START_SCHEDULE_ITEM->sw.value = false;
+	indigo_update_property(device, AGENT_START_PROCESS_PROPERTY, AGENT_START_PROCESS_PROPERTY->state == INDIGO_OK_STATE ? "Session finished" : "Session failed");
+	if (AGENT_ABORT_PROCESS_PROPERTY->state == INDIGO_BUSY_STATE) {
+		AGENT_ABORT_PROCESS_PROPERTY->state = INDIGO_OK_STATE;
+		indigo_update_property(device, AGENT_ABORT_PROCESS_PROPERTY, NULL);
+	}
+}
+
+// -------------------------------------------------------------------------------- INDIGO agent device implementation
+
+static indigo_result agent_enumerate_properties(indigo_device *device, indigo_client *client, indigo_property *property);
+
+static indigo_result agent_device_attach(indigo_device *device) {
+	assert(device != NULL);
+	assert(DEVICE_PRIVATE_DATA != NULL);
+	if (indigo_filter_device_attach(device, DRIVER_NAME, DRIVER_VERSION, INDIGO_INTERFACE_AGENT) == INDIGO_OK) {
+		// -------------------------------------------------------------------------------- Device properties
+		FILTER_RELATED_AGENT_LIST_PROPERTY->hidden = false;
+		// -------------------------------------------------------------------------------- AGENT_SCHEDULER_TARGETS
+		AGENT_SCHEDULER_TARGETS_PROPERTY = indigo_init_text_property(NULL, device->name, AGENT_SCHEDULER_TARGETS_PROPERTY_NAME, "Agent", "Targets", INDIGO_OK_STATE, INDIGO_RW_PERM, SCHEDULER_MAX_TARGETS);
+		if (AGENT_SCHEDULER_TARGETS_PROPERTY == NULL)
+			return INDIGO_FAILED;
+		AGENT_SCHEDULER_WINDOWS_PROPERTY = indigo_init_text_property(NULL, device->name, AGENT_SCHEDULER_WINDOWS_PROPERTY_NAME, "Agent", "Observable windows", INDIGO_IDLE_STATE, INDIGO_RO_PERM, SCHEDULER_MAX_TARGETS);
+		if (AGENT_SCHEDULER_WINDOWS_PROPERTY == NULL)
+			return INDIGO_FAILED;
+		for (int i = 0; i < SCHEDULER_MAX_TARGETS; i++) {
+			char name[32], label[32];
+			sprintf(name, "%02d", i + 1);
+			sprintf(label, "Target #%d", i + 1);
+			indigo_init_text_item(AGENT_SCHEDULER_TARGETS_PROPERTY->items + i, name, label, "");
+			indigo_init_text_item(AGENT_SCHEDULER_WINDOWS_PROPERTY->items + i, name, label, "");
+		}
+		// -------------------------------------------------------------------------------- AGENT_SCHEDULER_SETTINGS
+		AGENT_SCHEDULER_SETTINGS_PROPERTY = indigo_init_number_property(NULL, device->name, AGENT_SCHEDULER_SETTINGS_PROPERTY_NAME, "Agent", "Settings", INDIGO_OK_STATE, INDIGO_RW_PERM, 5);
+		if (AGENT_SCHEDULER_SETTINGS_PROPERTY == NULL)
+			return INDIGO_FAILED;
+		indigo_init_number_item(AGENT_SCHEDULER_SETTINGS_MIN_ALTITUDE_ITEM, AGENT_SCHEDULER_SETTINGS_MIN_ALTITUDE_ITEM_NAME, "Minimal altitude (°)", 0, 90, 1, 30);
+		indigo_init_number_item(AGENT_SCHEDULER_SETTINGS_MOON_DISTANCE_ITEM, AGENT_SCHEDULER_SETTINGS_MOON_DISTANCE_ITEM_NAME, "Minimal moon distance (°)", 0, 180, 1, 30);
+		indigo_init_number_item(AGENT_SCHEDULER_SETTINGS_SUN_ALTITUDE_ITEM, AGENT_SCHEDULER_SETTINGS_SUN_ALTITUDE_ITEM_NAME, "Maximal sun altitude (°)", -90, 0, 1, INDIGO_EPHEMERIS_NAUTICAL_TWILIGHT);
+		indigo_init_number_item(AGENT_SCHEDULER_SETTINGS_RETRIES_ITEM, AGENT_SCHEDULER_SETTINGS_RETRIES_ITEM_NAME, "Retries after failure", 0, 10, 1, 2);
+		indigo_init_number_item(AGENT_SCHEDULER_SETTINGS_SPEED_ITEM, AGENT_SCHEDULER_SETTINGS_SPEED_ITEM_NAME, "Simulated exposure speedup", 1, 100000, 1, 1000);
+		// -------------------------------------------------------------------------------- AGENT_SCHEDULER_CLOCK
+		AGENT_SCHEDULER_CLOCK_PROPERTY = indigo_init_switch_property(NULL, device->name, AGENT_SCHEDULER_CLOCK_PROPERTY_NAME, "Agent", "Clock", INDIGO_OK_STATE, INDIGO_RW_PERM, INDIGO_ONE_OF_MANY_RULE, 2);
+		if (AGENT_SCHEDULER_CLOCK_PROPERTY == NULL)
+			return INDIGO_FAILED;
+		indigo_init_switch_item(AGENT_SCHEDULER_CLOCK_REAL_ITEM, AGENT_SCHEDULER_CLOCK_REAL_ITEM_NAME, "Real", true);
+		indigo_init_switch_item(AGENT_SCHEDULER_CLOCK_SIMULATED_ITEM, AGENT_SCHEDULER_CLOCK_SIMULATED_ITEM_NAME, "Simulated", false);
+		// -------------------------------------------------------------------------------- AGENT_SCHEDULER_SIMULATION
+		AGENT_SCHEDULER_SIMULATION_PROPERTY = indigo_init_text_property(NULL, device->name, AGENT_SCHEDULER_SIMULATION_PROPERTY_NAME, "Agent", "Simulation", INDIGO_OK_STATE, INDIGO_RW_PERM, 1);
+		if (AGENT_SCHEDULER_SIMULATION_PROPERTY == NULL)
+			return INDIGO_FAILED;
+		indigo_init_text_item(AGENT_SCHEDULER_SIMULATION_START_ITEM, AGENT_SCHEDULER_SIMULATION_START_ITEM_NAME, "Start time (UTC)", "");
+		// -------------------------------------------------------------------------------- AGENT_SCHEDULER_STATUS
+		AGENT_SCHEDULER_STATUS_PROPERTY = indigo_init_text_property(NULL, device->name, AGENT_SCHEDULER_STATUS_PROPERTY_NAME, "Agent", "Status", INDIGO_IDLE_STATE, INDIGO_RO_PERM, 3);
+		if (AGENT_SCHEDULER_STATUS_PROPERTY == NULL)
+			return INDIGO_FAILED;
+		indigo_init_text_item(AGENT_SCHEDULER_STATUS_CLOCK_ITEM, AGENT_SCHEDULER_STATUS_CLOCK_ITEM_NAME, "Clock (UTC)", "");
+		indigo_init_text_item(AGENT_SCHEDULER_STATUS_TARGET_ITEM, AGENT_SCHEDULER_STATUS_TARGET_ITEM_NAME, "Target", "");
+		indigo_init_text_item(AGENT_SCHEDULER_STATUS_STEP_ITEM, AGENT_SCHEDULER_STATUS_STEP_ITEM_NAME, "Step", "");
+		// -------------------------------------------------------------------------------- Process properties
+		AGENT_START_PROCESS_PROPERTY = indigo_init_switch_property(NULL, device->name, AGENT_START_PROCESS_PROPERTY_NAME, "Agent", "Start process", INDIGO_IDLE_STATE, INDIGO_RW_PERM, INDIGO_AT_MOST_ONE_RULE, 1);
+		if (AGENT_START_PROCESS_PROPERTY == NULL)
+			return INDIGO_FAILED;
+		indigo_init_switch_item(AGENT_SCHEDULER_START_SCHEDULE_ITEM, AGENT_SCHEDULER_START_SCHEDULE_ITEM_NAME, "Start session", false);
+		AGENT_ABORT_PROCESS_PROPERTY = indigo_init_switch_property(NULL, device->name, AGENT_ABORT_PROCESS_PROPERTY_NAME, "Agent", "Abort process", INDIGO_OK_STATE, INDIGO_RW_PERM, INDIGO_AT_MOST_ONE_RULE, 1);
+		if (AGENT_ABORT_PROCESS_PROPERTY == NULL)
+			return INDIGO_FAILED;
+		indigo_init_switch_item(AGENT_ABORT_PROCESS_ITEM, AGENT_ABORT_PROCESS_ITEM_NAME, "Abort", false);
+		// --------------------------------------------------------------------------------
+		DEVICE_PRIVATE_DATA->imager_state = DEVICE_PRIVATE_DATA->guider_state = DEVICE_PRIVATE_DATA->mount_state = DEVICE_PRIVATE_DATA->park_state = DEVICE_PRIVATE_DATA->centering_state = INDIGO_IDLE_STATE;
+		DEVICE_PRIVATE_DATA->guider_phase = -1;
+		CONNECTION_PROPERTY->hidden = true;
+		pthread_mutex_init(&DEVICE_PRIVATE_DATA->mutex, NULL);
+		indigo_load_properties(device, false);
+		indigo_set_timer(device, 0, plan_process, NULL);
+		INDIGO_DEVICE_ATTACH_LOG(DRIVER_NAME, device->name);
+		return agent_enumerate_properties(device, NULL, NULL);
+	}
+	return INDIGO_FAILED;
+}
+
+static indigo_result agent_enumerate_properties(indigo_device *device, indigo_client *client, indigo_property *property) {
+	if (client != NULL && client == FILTER_DEVICE_CONTEXT->client)
+		return INDIGO_OK;
+	if (indigo_property_match(AGENT_SCHEDULER_TARGETS_PROPERTY, property))
+		indigo_define_property(device, AGENT_SCHEDULER_TARGETS_PROPERTY, NULL);
+	if (indigo_property_match(AGENT_SCHEDULER_WINDOWS_PROPERTY, property))
+		indigo_define_property(device, AGENT_SCHEDULER_WINDOWS_PROPERTY, NULL);
+	if (indigo_property_match(AGENT_SCHEDULER_SETTINGS_PROPERTY, property))
+		indigo_define_property(device, AGENT_SCHEDULER_SETTINGS_PROPERTY, NULL);
+	if (indigo_property_match(AGENT_SCHEDULER_CLOCK_PROPERTY, property))
+		indigo_define_property(device, AGENT_SCHEDULER_CLOCK_PROPERTY, NULL);
+	if (indigo_property_match(AGENT_SCHEDULER_SIMULATION_PROPERTY, property))
+		indigo_define_property(device, AGENT_SCHEDULER_SIMULATION_PROPERTY, NULL);
+	if (indigo_property_match(AGENT_SCHEDULER_STATUS_PROPERTY, property))
+		indigo_define_property(device, AGENT_SCHEDULER_STATUS_PROPERTY, NULL);
+	if (indigo_property_match(AGENT_START_PROCESS_PROPERTY, property))
+		indigo_define_property(device, AGENT_START_PROCESS_PROPERTY, NULL);
+	if (indigo_property_match(AGENT_ABORT_PROCESS_PROPERTY, property))
+		indigo_define_property(device, AGENT_ABORT_PROCESS_PROPERTY, NULL);
+	return indigo_filter_enumerate_properties(device, client, property);
+}
+
+static indigo_result agent_change_property(indigo_device *device, indigo_client *client, indigo_property *property) {
+	assert(device != NULL);
+	assert(DEVICE_CONTEXT != NULL);
+	assert(property != NULL);
+	if (client == FILTER_DEVICE_CONTEXT->client)
+		return INDIGO_OK;
+	if (indigo_property_match(AGENT_SCHEDULER_TARGETS_PROPERTY, property)) {
+		// -------------------------------------------------------------------------------- AGENT_SCHEDULER_TARGETS
+		indigo_property_copy_values(AGENT_SCHEDULER_TARGETS_PROPERTY, property, false);
+		AGENT_SCHEDULER_TARGETS_PROPERTY->state = INDIGO_OK_STATE;
+		save_config(device);
+		indigo_update_property(device, AGENT_SCHEDULER_TARGETS_PROPERTY, NULL);
+		indigo_set_timer(device, 0, plan_process, NULL);
+		return INDIGO_OK;
+	} else if (indigo_property_match(AGENT_SCHEDULER_SETTINGS_PROPERTY, property)) {
+		// -------------------------------------------------------------------------------- AGENT_SCHEDULER_SETTINGS
+		indigo_property_copy_values(AGENT_SCHEDULER_SETTINGS_PROPERTY, property, false);
+		AGENT_SCHEDULER_SETTINGS_PROPERTY->state = INDIGO_OK_STATE;
+		save_config(device);
+		indigo_update_property(device, AGENT_SCHEDULER_SETTINGS_PROPERTY, NULL);
+		indigo_set_timer(device, 0, plan_process, NULL);
+		return INDIGO_OK;
+	} else if (indigo_property_match(AGENT_SCHEDULER_CLOCK_PROPERTY, property)) {
+		// -------------------------------------------------------------------------------- AGENT_SCHEDULER_CLOCK
+		if (AGENT_START_PROCESS_PROPERTY->state == INDIGO_BUSY_STATE) {
+			indigo_update_property(device, AGENT_SCHEDULER_CLOCK_PROPERTY, "Clock can't be changed while session is running");
+			return INDIGO_OK;
+		}
+		indigo_property_copy_values(AGENT_SCHEDULER_CLOCK_PROPERTY, property, false);
+		AGENT_SCHEDULER_CLOCK_PROPERTY->state = INDIGO_OK_STATE;
+		save_config(device);
+		indigo_update_property(device, AGENT_SCHEDULER_CLOCK_PROPERTY, NULL);
+		indigo_set_timer(device, 0, plan_process, NULL);
+		return INDIGO_OK;
+	} else if (indigo_property_match(AGENT_SCHEDULER_SIMULATION_PROPERTY, property)) {
+		// -------------------------------------------------------------------------------- AGENT_SCHEDULER_SIMULATION
+		indigo_property_copy_values(AGENT_SCHEDULER_SIMULATION_PROPERTY, property, false);
+		if (*AGENT_SCHEDULER_SIMULATION_START_ITEM->text.value && indigo_isogmtotime(AGENT_SCHEDULER_SIMULATION_START_ITEM->text.value) == -1) {
+			AGENT_SCHEDULER_SIMULATION_PROPERTY->state = INDIGO_ALERT_STATE;
+			indigo_update_property(device, AGENT_SCHEDULER_SIMULATION_PROPERTY, "Invalid start time, expected YYYY-MM-DDThh:mm:ss");
+			return INDIGO_OK;
+		}
+		AGENT_SCHEDULER_SIMULATION_PROPERTY->state = INDIGO_OK_STATE;
+		save_config(device);
+		indigo_update_property(device, AGENT_SCHEDULER_SIMULATION_PROPERTY, NULL);
+		indigo_set_timer(device, 0, plan_process, NULL);
+		return INDIGO_OK;
+	} else if (indigo_property_match(AGENT_START_PROCESS_PROPERTY, property)) {
+		// -------------------------------------------------------------------------------- AGENT_START_PROCESS
+		if (AGENT_START_PROCESS_PROPERTY->state != INDIGO_BUSY_STATE) {
+			indigo_property_copy_values(AGENT_START_PROCESS_PROPERTY, property, false);
+			if (AGENT_SCHEDULER_START_SCHEDULE_ITEM->sw.value) {
+				if (AGENT_SCHEDULER_CLOCK_REAL_ITEM->sw.value && related_agent(device, "Imager Agent") == NULL) {
+					AGENT_SCHEDULER_START_SCHEDULE_ITEM->sw.value = false;
+					AGENT_START_PROCESS_PROPERTY->state = INDIGO_ALERT_STATE;
+					indigo_update_property(device, AGENT_START_PROCESS_PROPERTY, "No imager agent is selected");
+					return INDIGO_OK;
+				}
+				AGENT_START_PROCESS_PROPERTY->state = INDIGO_BUSY_STATE;
+				indigo_set_timer(device, 0, scheduler_process, NULL);
+			}
+		}
+		indigo_update_property(device, AGENT_START_PROCESS_PROPERTY, NULL);
+		return INDIGO_OK;
+	} else if (indigo_property_match(AGENT_ABORT_PROCESS_PROPERTY, property)) {
+		// -------------------------------------------------------------------------------- AGENT_ABORT_PROCESS
+		if (AGENT_START_PROCESS_PROPERTY->state == INDIGO_BUSY_STATE) {
+			indigo_property_copy_values(AGENT_ABORT_PROCESS_PROPERTY, property, false);
+			AGENT_ABORT_PROCESS_PROPERTY->state = INDIGO_BUSY_STATE;
+		}
+		AGENT_ABORT_PROCESS_ITEM->sw.value = false;
+		indigo_update_property(device, AGENT_ABORT_PROCESS_PROPERTY, NULL);
+		return INDIGO_OK;
+	}
+	return indigo_filter_change_property(device, client, property);
+}
+
+static indigo_result agent_device_detach(indigo_device *device) {
+	assert(device != NULL);
+	indigo_release_property(AGENT_SCHEDULER_TARGETS_PROPERTY);
+	indigo_release_property(AGENT_SCHEDULER_WINDOWS_PROPERTY);
+	indigo_release_property(AGENT_SCHEDULER_SETTINGS_PROPERTY);
+	indigo_release_property(AGENT_SCHEDULER_CLOCK_PROPERTY);
+	indigo_release_property(AGENT_SCHEDULER_SIMULATION_PROPERTY);
+	indigo_release_property(AGENT_SCHEDULER_STATUS_PROPERTY);
+	indigo_release_property(AGENT_START_PROCESS_PROPERTY);
+	indigo_release_property(AGENT_ABORT_PROCESS_PROPERTY);
+	pthread_mutex_destroy(&DEVICE_PRIVATE_DATA->mutex);
+	return indigo_filter_device_detach(device);
+}
+
+// -------------------------------------------------------------------------------- INDIGO agent client implementation
+
+static bool is_related_agent(indigo_client *client, indigo_property *property, const char *prefix) {
+	indigo_property *list = FILTER_CLIENT_CONTEXT->filter_related_agent_list_property;
+	for (int i = 0; i < list->count; i++) {
+		indigo_item *item = list->items + i;
+		if (item->sw.value && !strncmp(prefix, item->name, strlen(prefix)))
+			return !strcmp(item->name, property->device);
+	}
+	return false;
+}
+
+static void process_snooping(indigo_client *client, indigo_device *device, indigo_property *property) {
+	if (is_related_agent(client, property, "Imager Agent")) {
+		if (!strcmp(property->name, AGENT_START_PROCESS_PROPERTY_NAME))
+			CLIENT_PRIVATE_DATA->imager_state = property->state;
+	} else if (is_related_agent(client, property, "Guider Agent")) {
+		if (!strcmp(property->name, AGENT_START_PROCESS_PROPERTY_NAME)) {
+			CLIENT_PRIVATE_DATA->guider_state = property->state;
+		} else if (!strcmp(property->name, AGENT_GUIDER_STATS_PROPERTY_NAME)) {
+			for (int i = 0; i < property->count; i++) {
+				if (!strcmp(property->items[i].name, AGENT_GUIDER_STATS_PHASE_ITEM_NAME)) {
+					CLIENT_PRIVATE_DATA->guider_phase = (int)property->items[i].number.value;
+					break;
+				}
+			}
+		}
+	} else if (is_related_agent(client, property, "Mount Agent")) {
+		if (!strcmp(property->name, MOUNT_EQUATORIAL_COORDINATES_PROPERTY_NAME)) {
+			CLIENT_PRIVATE_DATA->mount_state = property->state;
+		} else if (!strcmp(property->name, MOUNT_PARK_PROPERTY_NAME)) {
+			CLIENT_PRIVATE_DATA->park_state = property->state;
+		} else if (!strcmp(property->name, AGENT_START_PROCESS_PROPERTY_NAME)) {
+			CLIENT_PRIVATE_DATA->centering_state = property->state;
+		} else if (!strcmp(property->name, GEOGRAPHIC_COORDINATES_PROPERTY_NAME)) {
+			for (int i = 0; i < property->count; i++) {
+				if (!strcmp(property->items[i].name, GEOGRAPHIC_COORDINATES_LATITUDE_ITEM_NAME))
+					CLIENT_PRIVATE_DATA->latitude = property->items[i].number.value;
+				else if (!strcmp(property->items[i].name, GEOGRAPHIC_COORDINATES_LONGITUDE_ITEM_NAME))
+					CLIENT_PRIVATE_DATA->longitude = property->items[i].number.value;
+				else if (!strcmp(property->items[i].name, GEOGRAPHIC_COORDINATES_ELEVATION_ITEM_NAME))
+					CLIENT_PRIVATE_DATA->elevation = property->items[i].number.value;
+			}
+			indigo_set_timer(FILTER_CLIENT_CONTEXT->device, 0, plan_process, NULL);
+		}
+	}
+}
+
+static indigo_result agent_define_property(indigo_client *client, indigo_device *device, indigo_property *property, const char *message) {
+	if (device == FILTER_CLIENT_CONTEXT->device)
+		return INDIGO_OK;
+	process_snooping(client, device, property);
+	return indigo_filter_define_property(client, device, property, message);
+}
+
+static indigo_result agent_update_property(indigo_client *client, indigo_device *device, indigo_property *property, const char *message) {
+	if (device == FILTER_CLIENT_CONTEXT->device)
+		return INDIGO_OK;
+	process_snooping(client, device, property);
+	return indigo_filter_update_property(client, device, property, message);
+}
+
+// -------------------------------------------------------------------------------- Initialization
+
+static agent_private_data *private_data = NULL;
+
+static indigo_device *agent_device = NULL;
+static indigo_client *agent_client = NULL;
+
+indigo_result indigo_agent_scheduler(indigo_driver_action action, indigo_driver_info *info) {
+	static indigo_device agent_device_template = INDIGO_DEVICE_INITIALIZER(
+		SCHEDULER_AGENT_NAME,
+		agent_device_attach,
+		agent_enumerate_properties,
+		agent_change_property,
+		NULL,
+		agent_device_detach
+	);
+
+	static indigo_client agent_client_template = {
+		SCHEDULER_AGENT_NAME, false, NULL, INDIGO_OK, INDIGO_VERSION_CURRENT, NULL,
+		indigo_filter_client_attach,
+		agent_define_property,
+		agent_update_property,
+		indigo_filter_delete_property,
+		NULL,
+		indigo_filter_client_detach
+	};
+
+	static indigo_driver_action last_action = INDIGO_DRIVER_SHUTDOWN;
+
+	SET_DRIVER_INFO(info, SCHEDULER_AGENT_NAME, __FUNCTION__, DRIVER_VERSION, false, last_action);
+
+	if (action == last_action)
+		return INDIGO_OK;
+
+	switch(action) {
+		case INDIGO_DRIVER_INIT:
+			last_action = action;
+			private_data = malloc(sizeof(agent_private_data));
+			assert(private_data != NULL);
+			memset(private_data, 0, sizeof(agent_private_data));
+			agent_device = malloc(sizeof(indigo_device));
+			assert(agent_device != NULL);
+			memcpy(agent_device, &agent_device_template, sizeof(indigo_device));
+			agent_device->private_data = private_data;
+			indigo_attach_device(agent_device);
+
+			agent_client = malloc(sizeof(indigo_client));
+			assert(agent_client != NULL);
+			memcpy(agent_client, &agent_client_template, sizeof(indigo_client));
+			agent_client->client_context = agent_device->device_context;
+			indigo_attach_client(agent_client);
+			break;
+
+		case INDIGO_DRIVER_SHUTDOWN:
+			last_action = action;
+			if (agent_client != NULL) {
+				indigo_detach_client(agent_client);
+				free(agent_client);
+				agent_client = NULL;
+			}
+			if (agent_device != NULL) {
+				indigo_detach_device(agent_device);
+				free(agent_device);
+				agent_device = NULL;
+			}
+			if (private_data != NULL) {
+				free(private_data);
+				private_data = NULL;
+			}
+			break;
+
+		case INDIGO_DRIVER_INFO:
+			break;
+	}
+	return INDIGO_OK;
+}
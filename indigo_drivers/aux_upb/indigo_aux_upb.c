@@ -23,7 +23,7 @@
  \file indigo_aux_upb.c
  */
 
-#define DRIVER_VERSION 0x0010
+#define DRIVER_VERSION 0x0011
 #define DRIVER_NAME "indigo_aux_upb"
 
 #include <stdlib.h>
@@ -1205,47 +1205,50 @@ static indigo_result aux_change_property(indigo_device *device, indigo_client *c
 		indigo_property_copy_values(CONNECTION_PROPERTY, property, false);
 		CONNECTION_PROPERTY->state = INDIGO_BUSY_STATE;
 		indigo_update_property(device, CONNECTION_PROPERTY, NULL);
-		indigo_set_timer(device, 0, aux_connection_handler, NULL);
+		// queued requests are meaningless once disconnect is requested
+		if (CONNECTION_DISCONNECTED_ITEM->sw.value)
+			indigo_cancel_pending_handlers(device);
+		indigo_execute_handler(device, aux_connection_handler);
 		return INDIGO_OK;
 	} else if (indigo_property_match(AUX_OUTLET_NAMES_PROPERTY, property)) {
 		// -------------------------------------------------------------------------------- X_AUX_OUTLET_NAMES
 		indigo_property_copy_values(AUX_OUTLET_NAMES_PROPERTY, property, false);
-		indigo_set_timer(device, 0, aux_outlet_names_handler, NULL);
+		indigo_execute_handler(device, aux_outlet_names_handler);
 		return INDIGO_OK;
 	} else if (indigo_property_match(AUX_POWER_OUTLET_PROPERTY, property)) {
 		// -------------------------------------------------------------------------------- AUX_POWER_OUTLET
 		indigo_property_copy_values(AUX_POWER_OUTLET_PROPERTY, property, false);
-		indigo_set_timer(device, 0, aux_power_outlet_handler, NULL);
+		indigo_execute_handler(device, aux_power_outlet_handler);
 		return INDIGO_OK;
 	} else if (indigo_property_match(AUX_HEATER_OUTLET_PROPERTY, property)) {
 		// -------------------------------------------------------------------------------- AUX_HEATER_OUTLET
 		indigo_property_copy_values(AUX_HEATER_OUTLET_PROPERTY, property, false);
-		indigo_set_timer(device, 0, aux_heater_outlet_handler, NULL);
+		indigo_execute_handler(device, aux_heater_outlet_handler);
 		return INDIGO_OK;
 	} else if (indigo_property_match(AUX_DEW_CONTROL_PROPERTY, property)) {
 		// -------------------------------------------------------------------------------- AUX_DEW_CONTROL
 		indigo_property_copy_values(AUX_DEW_CONTROL_PROPERTY, property, false);
-		indigo_set_timer(device, 0, aux_dew_control_handler, NULL);
+		indigo_execute_handler(device, aux_dew_control_handler);
 		return INDIGO_OK;
 	} else if (indigo_property_match(AUX_USB_PORT_PROPERTY, property)) {
 		// -------------------------------------------------------------------------------- AUX_USB_PORT
 		indigo_property_copy_values(AUX_USB_PORT_PROPERTY, property, false);
-		indigo_set_timer(device, 0, aux_usb_port_handler, NULL);
+		indigo_execute_handler(device, aux_usb_port_handler);
 		return INDIGO_OK;
 	} else if (indigo_property_match(X_AUX_HUB_PROPERTY, property)) {
 		// -------------------------------------------------------------------------------- X_AUX_HUB
 		indigo_property_copy_values(X_AUX_HUB_PROPERTY, property, false);
-		indigo_set_timer(device, 0, aux_hub_handler, NULL);
+		indigo_execute_handler(device, aux_hub_handler);
 		return INDIGO_OK;
 	} else if (indigo_property_match(X_AUX_REBOOT_PROPERTY, property)) {
 		// -------------------------------------------------------------------------------- X_AUX_REBOOT
 		indigo_property_copy_values(X_AUX_REBOOT_PROPERTY, property, false);
-		indigo_set_timer(device, 0, aux_reboot_handler, NULL);
+		indigo_execute_handler(device, aux_reboot_handler);
 		return INDIGO_OK;
 	} else if (indigo_property_match(X_AUX_VARIABLE_POWER_OUTLET_PROPERTY, property)) {
 		// -------------------------------------------------------------------------------- X_AUX_VARIABLE_POWER_OUTLET
 		indigo_property_copy_values(X_AUX_VARIABLE_POWER_OUTLET_PROPERTY, property, false);
-		indigo_set_timer(device, 0, aux_variable_power_outlet_handler, NULL);
+		indigo_execute_handler(device, aux_variable_power_outlet_handler);
 		return INDIGO_OK;
 		// -------------------------------------------------------------------------------- CONFIG
 	} else if (indigo_property_match(CONFIG_PROPERTY, property)) {
@@ -1258,6 +1261,7 @@ static indigo_result aux_change_property(indigo_device *device, indigo_client *c
 
 static indigo_result aux_detach(indigo_device *device) {
 	assert(device != NULL);
+	indigo_cancel_pending_handlers_sync(device);
 	if (IS_CONNECTED) {
 		indigo_set_switch(CONNECTION_PROPERTY, CONNECTION_DISCONNECTED_ITEM, true);
 		aux_connection_handler(device);
@@ -1599,37 +1603,40 @@ static indigo_result focuser_change_property(indigo_device *device, indigo_clien
 		indigo_property_copy_values(CONNECTION_PROPERTY, property, false);
 		CONNECTION_PROPERTY->state = INDIGO_BUSY_STATE;
 		indigo_update_property(device, CONNECTION_PROPERTY, NULL);
-		indigo_set_timer(device, 0, focuser_connection_handler, NULL);
+		// queued requests are meaningless once disconnect is requested
+		if (CONNECTION_DISCONNECTED_ITEM->sw.value)
+			indigo_cancel_pending_handlers(device);
+		indigo_execute_handler(device, focuser_connection_handler);
 		return INDIGO_OK;
 	} else if (indigo_property_match(FOCUSER_SPEED_PROPERTY, property)) {
 		// -------------------------------------------------------------------------------- FOCUSER_SPEED
 		indigo_property_copy_values(FOCUSER_SPEED_PROPERTY, property, false);
-		indigo_set_timer(device, 0, focuser_speed_handler, NULL);
+		indigo_execute_handler(device, focuser_speed_handler);
 		return INDIGO_OK;
 	} else if (indigo_property_match(FOCUSER_STEPS_PROPERTY, property)) {
 		// -------------------------------------------------------------------------------- FOCUSER_STEPS
 		indigo_property_copy_values(FOCUSER_STEPS_PROPERTY, property, false);
-		indigo_set_timer(device, 0, focuser_steps_handler, NULL);
+		indigo_execute_handler(device, focuser_steps_handler);
 		return INDIGO_OK;
 	} else if (indigo_property_match(FOCUSER_POSITION_PROPERTY, property)) {
 		// -------------------------------------------------------------------------------- FOCUSER_POSITION
 		indigo_property_copy_values(FOCUSER_POSITION_PROPERTY, property, false);
-		indigo_set_timer(device, 0, focuser_position_handler, NULL);
+		indigo_execute_handler(device, focuser_position_handler);
 		return INDIGO_OK;
 	} else if (indigo_property_match(FOCUSER_ABORT_MOTION_PROPERTY, property)) {
 		// -------------------------------------------------------------------------------- FOCUSER_ABORT_MOTION
 		indigo_property_copy_values(FOCUSER_ABORT_MOTION_PROPERTY, property, false);
-		indigo_set_timer(device, 0, focuser_abort_handler, NULL);
+		indigo_execute_handler(device, focuser_abort_handler);
 		return INDIGO_OK;
 		// -------------------------------------------------------------------------------- FOCUSER_REVERSE_MOTION
 	} else if (indigo_property_match(FOCUSER_REVERSE_MOTION_PROPERTY, property)) {
 		indigo_property_copy_values(FOCUSER_REVERSE_MOTION_PROPERTY, property, false);
-		indigo_set_timer(device, 0, focuser_reverse_motion_handler, NULL);
+		indigo_execute_handler(device, focuser_reverse_motion_handler);
 		return INDIGO_OK;
 		// -------------------------------------------------------------------------------- FOCUSER_BACKLASH
 	} else if (indigo_property_match(FOCUSER_BACKLASH_PROPERTY, property)) {
 		indigo_property_copy_values(FOCUSER_BACKLASH_PROPERTY, property, false);
-		indigo_set_timer(device, 0, focuser_backlash_handler, NULL);
+		indigo_execute_handler(device, focuser_backlash_handler);
 		return INDIGO_OK;
 	}
 	return indigo_focuser_change_property(device, client, property);
@@ -1637,6 +1644,7 @@ static indigo_result focuser_change_property(indigo_device *device, indigo_clien
 
 static indigo_result focuser_detach(indigo_device *device) {
 	assert(device != NULL);
+	indigo_cancel_pending_handlers_sync(device);
 	if (IS_CONNECTED) {
 		indigo_set_switch(CONNECTION_PROPERTY, CONNECTION_DISCONNECTED_ITEM, true);
 		focuser_connection_handler(device);
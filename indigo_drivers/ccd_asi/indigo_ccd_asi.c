@@ -26,7 +26,7 @@
  \file indigo_ccd_asi.c
  */
 
-#define DRIVER_VERSION 0x0015
+#define DRIVER_VERSION 0x0016
 #define DRIVER_NAME "indigo_ccd_asi"
 
 #include <stdlib.h>
@@ -318,6 +318,7 @@ static bool asi_start_exposure(indigo_device *device, double exposure, bool dark
 		INDIGO_DRIVER_ERROR(DRIVER_NAME, "ASIStartExposure(%d) = %d", id, res);
 		return false;
 	}
+	indigo_ccd_shutter_opened(device);
 	INDIGO_DRIVER_DEBUG(DRIVER_NAME, "ASIStartExposure(%d) = %d", id, res);
 	return true;
 }
@@ -336,6 +337,7 @@ static bool asi_read_pixels(indigo_device *device) {
 		indigo_usleep(2000);
 	}
 	if (status == ASI_EXP_SUCCESS) {
+		indigo_ccd_shutter_closed(device);
 		pthread_mutex_lock(&PRIVATE_DATA->usb_mutex);
 		res = ASIGetDataAfterExp(PRIVATE_DATA->dev_id, PRIVATE_DATA->buffer + FITS_HEADER_SIZE, PRIVATE_DATA->buffer_size);
 		pthread_mutex_unlock(&PRIVATE_DATA->usb_mutex);
@@ -499,24 +501,30 @@ static void streaming_timer_callback(indigo_device *device) {
 		pthread_mutex_unlock(&PRIVATE_DATA->usb_mutex);
 		if (res) {
 			INDIGO_DRIVER_ERROR(DRIVER_NAME, "ASIStartVideoCapture(%d) = %d", id, res);
+		} else if (!indigo_ccd_stream_start(device, PRIVATE_DATA->buffer_size)) {
+			INDIGO_DRIVER_ERROR(DRIVER_NAME, "indigo_ccd_stream_start(%d) failed", id);
+			res = ASI_ERROR_GENERAL_ERROR;
+			pthread_mutex_lock(&PRIVATE_DATA->usb_mutex);
+			ASIStopVideoCapture(id);
+			pthread_mutex_unlock(&PRIVATE_DATA->usb_mutex);
 		} else {
 			INDIGO_DRIVER_DEBUG(DRIVER_NAME, "ASIStartVideoCapture(%d) = %d", id, res);
+			/* if colour (bayer) image but not RGB */
+			indigo_fits_keyword *frame_keywords = (color_string && PRIVATE_DATA->exp_bpp != 24 && PRIVATE_DATA->exp_bpp != 48) ? keywords : NULL;
 			while (CCD_STREAMING_COUNT_ITEM->number.value != 0) {
+				unsigned char *buffer = indigo_ccd_stream_acquire_buffer(device);
 				pthread_mutex_lock(&PRIVATE_DATA->usb_mutex);
-				res = ASIGetVideoData(id, PRIVATE_DATA->buffer + FITS_HEADER_SIZE, PRIVATE_DATA->buffer_size, timeout);
+				/* no free buffer in the ring, frame is still read from camera to keep video capture running, but it is dropped */
+				res = ASIGetVideoData(id, (buffer ? buffer : PRIVATE_DATA->buffer) + FITS_HEADER_SIZE, PRIVATE_DATA->buffer_size - FITS_HEADER_SIZE, timeout);
 				pthread_mutex_unlock(&PRIVATE_DATA->usb_mutex);
 				if (res) {
 					INDIGO_DRIVER_ERROR(DRIVER_NAME, "ASIGetVideoData((%d) = %d", id, res);
 					break;
 				}
 				INDIGO_DRIVER_DEBUG(DRIVER_NAME, "ASIGetVideoData((%d) = %d", id, res);
-				if ((color_string) &&   /* if colour (bayer) image but not RGB */
-				    (PRIVATE_DATA->exp_bpp != 24) &&
-				    (PRIVATE_DATA->exp_bpp != 48)) {
-					indigo_process_image(device, PRIVATE_DATA->buffer, (int)(PRIVATE_DATA->exp_frame_width / PRIVATE_DATA->exp_bin_x), (int)(PRIVATE_DATA->exp_frame_height / PRIVATE_DATA->exp_bin_y), PRIVATE_DATA->exp_bpp, true, false, keywords, true);
-				} else {
-					indigo_process_image(device, PRIVATE_DATA->buffer, (int)(PRIVATE_DATA->exp_frame_width / PRIVATE_DATA->exp_bin_x), (int)(PRIVATE_DATA->exp_frame_height / PRIVATE_DATA->exp_bin_y), PRIVATE_DATA->exp_bpp, true, false, NULL, true);
-				}
+				if (buffer == NULL)
+					continue;
+				indigo_ccd_stream_commit_buffer(device, buffer, (int)(PRIVATE_DATA->exp_frame_width / PRIVATE_DATA->exp_bin_x), (int)(PRIVATE_DATA->exp_frame_height / PRIVATE_DATA->exp_bin_y), PRIVATE_DATA->exp_bpp, true, false, frame_keywords);
 				if (CCD_STREAMING_COUNT_ITEM->number.value > 0)
 					CCD_STREAMING_COUNT_ITEM->number.value -= 1;
 				CCD_STREAMING_PROPERTY->state = INDIGO_BUSY_STATE;
@@ -529,6 +537,7 @@ static void streaming_timer_callback(indigo_device *device) {
 				INDIGO_DRIVER_ERROR(DRIVER_NAME, "ASIStopVideoCapture(%d) = %d", id, res);
 			else
 				INDIGO_DRIVER_DEBUG(DRIVER_NAME, "ASIStopVideoCapture(%d) = %d", id, res);
+			indigo_ccd_stream_stop(device);
 		}
 		pthread_mutex_unlock(&PRIVATE_DATA->usb_mutex);
 	} else {
@@ -713,6 +722,8 @@ static indigo_result ccd_attach(indigo_device *device) {
 		CCD_MODE_PROPERTY->count = mode_count;
 		// -------------------------------------------------------------------------------- CCD_STREAMING
 		CCD_STREAMING_PROPERTY->hidden = false;
+		CCD_STREAMING_BUFFER_PROPERTY->hidden = false;
+		CCD_STREAMING_STATS_PROPERTY->hidden = false;
 		CCD_IMAGE_FORMAT_PROPERTY->count = 7;
 		CCD_STREAMING_EXPOSURE_ITEM->number.max = 4.0;
 
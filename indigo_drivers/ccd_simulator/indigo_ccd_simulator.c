@@ -23,13 +23,15 @@
  \file indigo_ccd_simulator.c
  */
 
-#define DRIVER_VERSION 0x0010
+#define DRIVER_VERSION 0x0011
 #define DRIVER_NAME	"indigo_ccd_simulator"
 
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <math.h>
+#include <stdint.h>
+#include <time.h>
 #include <assert.h>
 #include <pthread.h>
 
@@ -43,6 +45,7 @@
 #define STARS               30
 #define HOTPIXELS						50
 #define ECLIPSE							360
+#define MAX_RENDER_THREADS		16
 
 // gp_bits is used as boolean
 #define is_connected                     gp_bits
@@ -75,9 +78,46 @@
 #define GUIDER_IMAGE_RA_OFFSET_ITEM	(GUIDER_SETTINGS_PROPERTY->items + 10)
 #define GUIDER_IMAGE_DEC_OFFSET_ITEM	(GUIDER_SETTINGS_PROPERTY->items + 11)
 
+#define RENDERER										PRIVATE_DATA->renderer[device == PRIVATE_DATA->imager ? 0 : device == PRIVATE_DATA->guider ? 1 : 2]
+#define RENDER_PROPERTY							RENDERER.property
+#define RENDER_SEED_ITEM						(RENDER_PROPERTY->items + 0)
+#define RENDER_THREADS_ITEM					(RENDER_PROPERTY->items + 1)
+
 extern unsigned short indigo_ccd_simulator_raw_image[];
 extern unsigned char indigo_ccd_simulator_rgb_image[];
 
+typedef struct {
+	indigo_property *property;
+	uint64_t frame;
+	bool lut_valid;
+	double lut_gain, lut_gamma;
+	int lut_offset;
+	unsigned short lut[65536];
+	int star_x[STARS], star_y[STARS], star_a[STARS], hotpixel_x[HOTPIXELS + 1], hotpixel_y[HOTPIXELS + 1];
+} simulator_renderer;
+
+struct render_context;
+
+struct render_pool;
+
+typedef struct {
+	struct render_pool *pool;
+	int index;
+	pthread_t thread;
+} render_worker;
+
+typedef struct render_pool {
+	pthread_mutex_t mutex;
+	pthread_cond_t start_cond, done_cond;
+	render_worker workers[MAX_RENDER_THREADS];
+	int worker_count, active, pending;
+	unsigned generation;
+	bool shutdown;
+	struct render_context *context;
+	void (*function)(struct render_context *context, int first, int last);
+	int count;
+} render_pool;
+
 typedef struct {
 	indigo_device *imager, *guider, *dslr;
 	indigo_property *dslr_program_property;
@@ -89,7 +129,6 @@ typedef struct {
 	indigo_property *guider_mode_property;
 	indigo_property *guider_settings_property;
 
-	int star_x[STARS], star_y[STARS], star_a[STARS], hotpixel_x[HOTPIXELS + 1], hotpixel_y[HOTPIXELS + 1];
 	char imager_image[FITS_HEADER_SIZE + 3 * WIDTH * HEIGHT + 2880];
 	char guider_image[FITS_HEADER_SIZE + 3 * WIDTH * HEIGHT + 2880];
 	char dslr_image[FITS_HEADER_SIZE + 3 * WIDTH * HEIGHT + 2880];
@@ -101,72 +140,242 @@ typedef struct {
 	double ao_ra_offset, ao_dec_offset;
 	int eclipse;
 	double guide_rate;
+	simulator_renderer renderer[3];
+	render_pool render_pool;
 } simulator_private_data;
 
 // -------------------------------------------------------------------------------- INDIGO CCD device implementation
 
+// frames are rendered in row (or column) bands by up to MAX_RENDER_THREADS threads, every row has its own xorshift64* generator
+// seeded from frame seed and row index, so the result doesn't depend on the number of threads and the same seed gives the same frames
+
+static inline uint64_t splitmix64(uint64_t x) {
+	x += 0x9E3779B97F4A7C15ULL;
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+	return x ^ (x >> 31);
+}
+
+static inline uint64_t rng_init(uint64_t seed, uint64_t stream) {
+	uint64_t state = splitmix64(seed ^ splitmix64(stream));
+	return state ? state : 1;
+}
+
+static inline uint32_t rng_next(uint64_t *state) {
+	uint64_t x = *state;
+	x ^= x >> 12;
+	x ^= x << 25;
+	x ^= x >> 27;
+	*state = x;
+	return (uint32_t)((x * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+// every camera has its own field, so changing seed of one of them doesn't change frames of the others
+
+static void generate_field(simulator_renderer *renderer, uint64_t seed) {
+	uint64_t rng = rng_init(seed, 0);
+	for (int i = 0; i < STARS; i++) {
+		renderer->star_x[i] = rng_next(&rng) % WIDTH;
+		renderer->star_y[i] = rng_next(&rng) % HEIGHT;
+		renderer->star_a[i] = (i < 5 ? 100 : 30) * (rng_next(&rng) % 100);
+	}
+	for (int i = 0; i <= HOTPIXELS; i++) {
+		renderer->hotpixel_x[i] = rng_next(&rng) % (WIDTH - 200) + 100;
+		renderer->hotpixel_y[i] = rng_next(&rng) % (HEIGHT - 200) + 100;
+	}
+}
+
+typedef enum {
+	BACKGROUND_NONE,
+	BACKGROUND_IMAGE,
+	BACKGROUND_GRADIENT
+} render_background;
+
+typedef enum {
+	NOISE_IMAGER,
+	NOISE_GUIDER,
+	NOISE_DARK
+} render_noise;
+
+typedef struct {
+	int left, top, width, height, a;
+	double ex[9], ey[9];
+} render_stamp;
+
+typedef struct render_context {
+	uint64_t seed;
+	render_pool *pool;
+	int threads;
+	unsigned short *raw, *tmp, *lut;
+	int *sums;
+	unsigned char *rgb;
+	int frame_left, frame_top, frame_width, frame_height, horizontal_bin, vertical_bin;
+	render_background background;
+	render_noise noise;
+	double gradient, blur;
+	bool blurred;
+	int noise_fix, noise_var;
+	int stamp_count;
+	render_stamp stamps[STARS];
+	bool sun, eclipse;
+	double center_x, center_y, eclipse_x, eclipse_y;
+} render_context;
+
+typedef void (*render_band_function)(render_context *context, int first, int last);
+
+// bands are rendered by persistent worker threads, the calling thread renders the first band and waits for the rest;
+// workers are started on demand and stopped on driver shutdown, pool is used only under image_mutex
+
+static void render_band_run(render_pool *pool, int index) {
+	int first = (int)((long)pool->count * index / pool->active);
+	int last = (int)((long)pool->count * (index + 1) / pool->active);
+	pool->function(pool->context, first, last);
+}
+
+static void *render_worker_thread(void *arg) {
+	render_worker *worker = (render_worker *)arg;
+	render_pool *pool = worker->pool;
+	unsigned generation = 0;
+	pthread_mutex_lock(&pool->mutex);
+	while (true) {
+		while (!pool->shutdown && pool->generation == generation)
+			pthread_cond_wait(&pool->start_cond, &pool->mutex);
+		if (pool->shutdown)
+			break;
+		generation = pool->generation;
+		if (worker->index < pool->active) {
+			pthread_mutex_unlock(&pool->mutex);
+			render_band_run(pool, worker->index);
+			pthread_mutex_lock(&pool->mutex);
+			if (--pool->pending == 0)
+				pthread_cond_signal(&pool->done_cond);
+		}
+	}
+	pthread_mutex_unlock(&pool->mutex);
+	return NULL;
+}
+
+static void render_pool_init(render_pool *pool) {
+	pthread_mutex_init(&pool->mutex, NULL);
+	pthread_cond_init(&pool->start_cond, NULL);
+	pthread_cond_init(&pool->done_cond, NULL);
+	pool->worker_count = 1;
+}
+
+static void render_pool_release(render_pool *pool) {
+	pthread_mutex_lock(&pool->mutex);
+	pool->shutdown = true;
+	pthread_cond_broadcast(&pool->start_cond);
+	pthread_mutex_unlock(&pool->mutex);
+	for (int i = 1; i < pool->worker_count; i++)
+		pthread_join(pool->workers[i].thread, NULL);
+	pthread_cond_destroy(&pool->start_cond);
+	pthread_cond_destroy(&pool->done_cond);
+	pthread_mutex_destroy(&pool->mutex);
+}
+
+static void render_parallel(render_context *context, int count, render_band_function function) {
+	render_pool *pool = context->pool;
+	int threads = context->threads < count ? context->threads : count;
+	if (threads < 1)
+		return;
+	pthread_mutex_lock(&pool->mutex);
+	while (pool->worker_count < threads) {
+		render_worker *worker = pool->workers + pool->worker_count;
+		worker->pool = pool;
+		worker->index = pool->worker_count;
+		if (pthread_create(&worker->thread, NULL, render_worker_thread, worker) != 0)
+			break;
+		pool->worker_count++;
+	}
+	pool->active = threads < pool->worker_count ? threads : pool->worker_count;
+	pool->pending = pool->active - 1;
+	pool->context = context;
+	pool->function = function;
+	pool->count = count;
+	pool->generation++;
+	pthread_cond_broadcast(&pool->start_cond);
+	pthread_mutex_unlock(&pool->mutex);
+	render_band_run(pool, 0);
+	pthread_mutex_lock(&pool->mutex);
+	while (pool->pending > 0)
+		pthread_cond_wait(&pool->done_cond, &pool->mutex);
+	pthread_mutex_unlock(&pool->mutex);
+}
+
 // gausian blur algorithm is based on the paper http://blog.ivank.net/fastest-gaussian-blur.html by Ivan Kuckir
 
-static void box_blur_h(unsigned short *scl, unsigned short *tcl, int w, int h, double r) {
+static void box_blur_h(unsigned short *scl, unsigned short *tcl, int w, int h, double r, int first, int last) {
 	double iarr = 1 / (r + r + 1);
-	for (int i = 0; i < h; i++) {
+	for (int i = first; i < last; i++) {
 		int ti = i * w, li = ti, ri = ti + r;
 		int fv = scl[ti], lv = scl[ti + w - 1], val = (r + 1) * fv;
 		for (int j = 0; j < r; j++)
 			val += scl[ti + j];
 		for (int j = 0  ; j <= r ; j++) {
 			val += scl[ri++] - fv;
-			tcl[ti++] = round(val * iarr);
+			tcl[ti++] = (unsigned short)(val * iarr + 0.5);
 		}
 		for (int j = r + 1; j < w-r; j++) {
 			val += scl[ri++] - scl[li++];
-			tcl[ti++] = round(val * iarr);
+			tcl[ti++] = (unsigned short)(val * iarr + 0.5);
 		}
 		for (int j = w - r; j < w  ; j++) {
 			val += lv - scl[li++];
-			tcl[ti++] = round(val * iarr);
+			tcl[ti++] = (unsigned short)(val * iarr + 0.5);
 		}
 	}
 }
 
-static void box_blur_t(unsigned short *scl, unsigned short *tcl, int w, int h, double r) {
+static void box_blur_t(unsigned short *scl, unsigned short *tcl, int *val, int w, int h, double r, int first, int last) {
+	// columns are processed side by side row after row to keep memory access sequential, val holds running sums of columns first..last-1
 	double iarr = 1 / ( r + r + 1);
-	for (int i = 0; i < w; i++) {
-		int ti = i, li = ti, ri = ti + r * w;
-		int fv = scl[ti], lv = scl[ti + w * (h - 1)], val = (r + 1) * fv;
-		for (int j = 0; j < r; j++)
-			val += scl[ti + j * w];
-		for (int j = 0  ; j <= r ; j++) {
-			val += scl[ri] - fv;
-			tcl[ti] = round(val * iarr);
-			ri += w;
-			ti += w;
+	int count = last - first;
+	unsigned short *fv = scl + first, *lv = scl + w * (h - 1) + first;
+	for (int i = 0; i < count; i++)
+		val[i] = (r + 1) * fv[i];
+	for (int j = 0; j < r; j++) {
+		unsigned short *s = scl + j * w + first;
+		for (int i = 0; i < count; i++)
+			val[i] += s[i];
+	}
+	int ti = first, li = first, ri = first + r * w;
+	for (int j = 0  ; j <= r ; j++) {
+		for (int i = 0; i < count; i++) {
+			val[i] += scl[ri + i] - fv[i];
+			tcl[ti + i] = (unsigned short)(val[i] * iarr + 0.5);
 		}
-		for (int j = r + 1; j<h-r; j++) {
-			val += scl[ri] - scl[li];
-			tcl[ti] = round(val*iarr);
-			li += w;
-			ri += w;
-			ti += w;
+		ri += w;
+		ti += w;
+	}
+	for (int j = r + 1; j<h-r; j++) {
+		for (int i = 0; i < count; i++) {
+			val[i] += scl[ri + i] - scl[li + i];
+			tcl[ti + i] = (unsigned short)(val[i] * iarr + 0.5);
 		}
-		for (int j = h - r; j < h  ; j++) {
-			val += lv - scl[li];
-			tcl[ti] = round(val * iarr);
-			li += w;
-			ti += w;
+		li += w;
+		ri += w;
+		ti += w;
+	}
+	for (int j = h - r; j < h  ; j++) {
+		for (int i = 0; i < count; i++) {
+			val[i] += lv[i] - scl[li + i];
+			tcl[ti + i] = (unsigned short)(val[i] * iarr + 0.5);
 		}
+		li += w;
+		ti += w;
 	}
 }
 
-static void box_blur(unsigned short *scl, unsigned short *tcl, int w, int h, double r) {
-	int length = w * h;
-	for (int i = 0; i < length; i++)
-		tcl[i] = scl[i];
-	box_blur_h(tcl, scl, w, h, r);
-	box_blur_t(scl, tcl, w, h, r);
+static void box_blur_h_band(render_context *context, int first, int last) {
+	box_blur_h(context->raw, context->tmp, context->frame_width, context->frame_height, context->blur, first, last);
+}
+
+static void box_blur_t_band(render_context *context, int first, int last) {
+	box_blur_t(context->tmp, context->raw, context->sums + first, context->frame_width, context->frame_height, context->blur, first, last);
 }
 
-static void gauss_blur(unsigned short *scl, unsigned short *tcl, int w, int h, double r) {
+static void gauss_blur(render_context *context, double r) {
 	double ideal = sqrt((12 * r * r / 3) + 1);
 	int wl = floor(ideal);
 	if (wl % 2 == 0)
@@ -174,27 +383,165 @@ static void gauss_blur(unsigned short *scl, unsigned short *tcl, int w, int h, d
 	int wu = wl + 2;
 	ideal = (12 * r * r - 3 * wl * wl - 12 * wl - 9)/(-4 * wl - 4);
 	int m = round(ideal);
-	int sizes[3];
-	for (int i = 0; i < 3; i++)
-		sizes[i] = i < m ? wl : wu;
-	box_blur(scl, tcl, w, h, (sizes[0] - 1) / 2);
-	box_blur(tcl, scl, w, h, (sizes[1] - 1) / 2);
-	box_blur(scl, tcl, w, h, (sizes[2] - 1) / 2);
+	for (int i = 0; i < 3; i++) {
+		context->blur = ((i < m ? wl : wu) - 1) / 2;
+		render_parallel(context, context->frame_height, box_blur_h_band);
+		render_parallel(context, context->frame_width, box_blur_t_band);
+	}
+}
+
+static void render_noise_band(render_context *context, int first, int last) {
+	int width = context->frame_width;
+	for (int j = first; j < last; j++) {
+		unsigned short *row = context->raw + j * width;
+		uint64_t rng = rng_init(context->seed, 0x100000000ULL | j);
+		int value;
+		switch (context->noise) {
+			case NOISE_IMAGER:
+				for (int i = 0; i < width; i++) {
+					value = row[i] + (rng_next(&rng) & 0x7F);
+					row[i] = (value > 65535) ? 65535 : value;
+				}
+				break;
+			case NOISE_GUIDER:
+				for (int i = 0; i < width; i++) {
+					value = row[i] + (rng_next(&rng) % context->noise_var) + context->noise_fix;
+					row[i] = (value > 65535) ? 65535 : value;
+				}
+				break;
+			case NOISE_DARK:
+				for (int i = 0; i < width; i++)
+					row[i] = (rng_next(&rng) & 0x7F);
+				break;
+		}
+	}
+}
+
+static void render_band_rows(render_context *context, int first, int last) {
+	int width = context->frame_width;
+	for (int j = first; j < last; j++) {
+		unsigned short *row = context->raw + j * width;
+		if (context->background == BACKGROUND_IMAGE) {
+			unsigned short *source = indigo_ccd_simulator_raw_image + (context->frame_top + j) * context->vertical_bin * WIDTH + context->frame_left * context->horizontal_bin;
+			for (int i = 0; i < width; i++)
+				row[i] = source[i * context->horizontal_bin];
+		} else if (context->background == BACKGROUND_GRADIENT) {
+			int jj = j * j;
+			for (int i = 0; i < width; i++)
+				row[i] = context->gradient * sqrt(i * i + jj);
+		} else {
+			continue;
+		}
+		for (int s = 0; s < context->stamp_count; s++) {
+			render_stamp *stamp = context->stamps + s;
+			int y = j - stamp->top;
+			if (y < 0 || y >= stamp->height)
+				continue;
+			double ay = stamp->a * stamp->ey[y];
+			for (int x = 0; x < stamp->width; x++) {
+				int i = stamp->left + x;
+				if (i < 0 || i >= width)
+					continue;
+				row[i] += (unsigned short)(ay * stamp->ex[x]);
+			}
+		}
+		if (context->sun) {
+			double yy = (context->center_y - j) * context->vertical_bin;
+			double eclipse_yy = (context->eclipse_y - j) * context->vertical_bin;
+			for (int i = 0; i < width; i++) {
+				double xx = (context->center_x - i) * context->horizontal_bin;
+				double eclipse_xx = (context->eclipse_x - i) * context->horizontal_bin;
+				double value = 500000 * exp(-((xx * xx + yy * yy) / 20000.0));
+				if (context->eclipse && eclipse_xx * eclipse_xx + eclipse_yy * eclipse_yy < 50000)
+					value = 0;
+				if (value < 65535)
+					row[i] += (unsigned short)value;
+				else
+					row[i] = 65535;
+			}
+		}
+		unsigned short *lut = context->lut;
+		for (int i = 0; i < width; i++)
+			row[i] = lut[row[i]];
+	}
+	if (!context->blurred)
+		render_noise_band(context, first, last);
+}
+
+static void render_dslr_band(render_context *context, int first, int last) {
+	for (int j = first; j < last; j++) {
+		unsigned char *source = indigo_ccd_simulator_rgb_image + j * WIDTH * 3;
+		unsigned char *row = context->rgb + j * WIDTH * 3;
+		uint64_t rng = rng_init(context->seed, j);
+		for (int i = 0; i < WIDTH * 3; i++) {
+			int rgb = source[i];
+			if (rgb < 0xF0)
+				row[i] = rgb + (rng_next(&rng) & 0x0F);
+			else
+				row[i] = rgb;
+		}
+	}
+}
+
+static void render_stamp_init(render_stamp *stamp, double center_x, double center_y, int a, int horizontal_bin, int vertical_bin) {
+	int x_max = (int)round(center_x) + 4 / horizontal_bin;
+	int y_max = (int)round(center_y) + 4 / vertical_bin;
+	stamp->width = 8 / horizontal_bin + 1;
+	stamp->height = 8 / vertical_bin + 1;
+	stamp->left = x_max - stamp->width + 1;
+	stamp->top = y_max - stamp->height + 1;
+	stamp->a = a;
+	for (int x = 0; x < stamp->width; x++) {
+		double xx = center_x - (stamp->left + x);
+		stamp->ex[x] = exp(-xx * xx / 4);
+	}
+	for (int y = 0; y < stamp->height; y++) {
+		double yy = center_y - (stamp->top + y);
+		stamp->ey[y] = exp(-yy * yy / 4);
+	}
+}
+
+static unsigned short *render_lut(indigo_device *device, double gain, int offset, double gamma) {
+	simulator_renderer *renderer = &RENDERER;
+	if (!renderer->lut_valid || renderer->lut_gain != gain || renderer->lut_offset != offset || renderer->lut_gamma != gamma) {
+		for (int i = 0; i < 65536; i++) {
+			double value = i - offset;
+			if (value < 0)
+				value = 0;
+			value = gain * pow(value, gamma);
+			if (value > 65535)
+				value = 65535;
+			renderer->lut[i] = (unsigned short)value;
+		}
+		renderer->lut_gain = gain;
+		renderer->lut_offset = offset;
+		renderer->lut_gamma = gamma;
+		renderer->lut_valid = true;
+	}
+	return renderer->lut;
 }
 
 static void create_frame(indigo_device *device) {
 	pthread_mutex_lock(&PRIVATE_DATA->image_mutex);
 	simulator_private_data *private_data = PRIVATE_DATA;
+	simulator_renderer *renderer = &RENDERER;
+	render_context context = { 0 };
+	context.pool = &private_data->render_pool;
+	uint64_t frame = RENDERER.frame++;
+	if (RENDER_SEED_ITEM->number.value > 0)
+		context.seed = rng_init((uint64_t)RENDER_SEED_ITEM->number.value, frame);
+	else
+		context.seed = rng_init(((uint64_t)rand() << 31) ^ (uint64_t)rand(), frame);
+	context.threads = (int)RENDER_THREADS_ITEM->number.value;
+	if (context.threads <= 0)
+		context.threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	if (context.threads < 1)
+		context.threads = 1;
+	if (context.threads > MAX_RENDER_THREADS)
+		context.threads = MAX_RENDER_THREADS;
 	if (device == PRIVATE_DATA->dslr) {
-		unsigned char *raw = (unsigned char *)(private_data->dslr_image + FITS_HEADER_SIZE);
-		int size = WIDTH * HEIGHT * 3;
-		for (int i = 0; i < size; i++) {
-			int rgb = indigo_ccd_simulator_rgb_image[i];
-			if (rgb < 0xF0)
-				raw[i] = rgb  + (rand() & 0x0F);
-			else
-				raw[i] = rgb;
-		}
+		context.rgb = (unsigned char *)(private_data->dslr_image + FITS_HEADER_SIZE);
+		render_parallel(&context, HEIGHT, render_dslr_band);
 		void *data_out;
 		unsigned long size_out;
 		indigo_raw_to_jpeg(device, private_data->dslr_image, WIDTH, HEIGHT, 24, true, true, &data_out, &size_out);
@@ -202,106 +549,68 @@ static void create_frame(indigo_device *device) {
 			indigo_process_dslr_preview_image(device, data_out, (int)size_out);
 		indigo_process_dslr_image(device, data_out, (int)size_out, ".jpeg", CCD_STREAMING_PROPERTY->state == INDIGO_BUSY_STATE);
 	} else {
-		unsigned short *raw = (unsigned short *)((device == PRIVATE_DATA->guider ? private_data->guider_image : private_data->imager_image) + FITS_HEADER_SIZE);
-		int horizontal_bin = (int)CCD_BIN_HORIZONTAL_ITEM->number.value;
-		int vertical_bin = (int)CCD_BIN_VERTICAL_ITEM->number.value;
-		int frame_left = (int)CCD_FRAME_LEFT_ITEM->number.value / horizontal_bin;
-		int frame_top = (int)CCD_FRAME_TOP_ITEM->number.value / vertical_bin;
-		int frame_width = (int)CCD_FRAME_WIDTH_ITEM->number.value / horizontal_bin;
-		int frame_height = (int)CCD_FRAME_HEIGHT_ITEM->number.value / vertical_bin;
+		unsigned short *raw = context.raw = (unsigned short *)((device == PRIVATE_DATA->guider ? private_data->guider_image : private_data->imager_image) + FITS_HEADER_SIZE);
+		int horizontal_bin = context.horizontal_bin = (int)CCD_BIN_HORIZONTAL_ITEM->number.value;
+		int vertical_bin = context.vertical_bin = (int)CCD_BIN_VERTICAL_ITEM->number.value;
+		int frame_left = context.frame_left = (int)CCD_FRAME_LEFT_ITEM->number.value / horizontal_bin;
+		int frame_top = context.frame_top = (int)CCD_FRAME_TOP_ITEM->number.value / vertical_bin;
+		int frame_width = context.frame_width = (int)CCD_FRAME_WIDTH_ITEM->number.value / horizontal_bin;
+		int frame_height = context.frame_height = (int)CCD_FRAME_HEIGHT_ITEM->number.value / vertical_bin;
 		int size = frame_width * frame_height;
-		double gain = (CCD_GAIN_ITEM->number.value / 100);
-		int offset = (int)CCD_OFFSET_ITEM->number.value;
-		double gamma = CCD_GAMMA_ITEM->number.value;
 		bool light_frame = CCD_FRAME_TYPE_LIGHT_ITEM->sw.value || CCD_FRAME_TYPE_FLAT_ITEM->sw.value;
 
 		if (device == PRIVATE_DATA->imager && light_frame) {
-			for (int j = 0; j < frame_height; j++) {
-				int jj = (frame_top + j) * vertical_bin;
-				for (int i = 0; i < frame_width; i++) {
-					raw[j * frame_width + i] = indigo_ccd_simulator_raw_image[jj * WIDTH + (frame_left + i) * horizontal_bin];
-				}
-			}
+			context.background = BACKGROUND_IMAGE;
+			context.noise = NOISE_IMAGER;
 		} else if (device == PRIVATE_DATA->guider) {
-			for (int j = 0; j < frame_height; j++) {
-				int jj = j * j;
-				for (int i = 0; i < frame_width; i++) {
-					raw[j * frame_width + i] = GUIDER_IMAGE_GRADIENT_ITEM->number.target * sqrt(i * i + jj);
-				}
-			}
+			context.background = BACKGROUND_GRADIENT;
+			context.gradient = GUIDER_IMAGE_GRADIENT_ITEM->number.target;
+			context.noise = NOISE_GUIDER;
+			context.noise_fix = (int)GUIDER_IMAGE_NOISE_FIX_ITEM->number.target;
+			context.noise_var = (int)GUIDER_IMAGE_NOISE_VAR_ITEM->number.target;
+			if (context.noise_var < 1)
+				context.noise_var = 1;
 		} else {
-			for (int i = 0; i < size; i++)
-				raw[i] = (rand() & 0x7F);
+			// dark and bias frames are pure noise, nothing else survives
+			context.background = BACKGROUND_NONE;
+			context.noise = NOISE_DARK;
 		}
 
 		if (device == PRIVATE_DATA->guider && light_frame) {
 			static time_t start_time = 0;
 			if (start_time == 0)
 				start_time = time(NULL);
-			double ra_offset = GUIDER_IMAGE_PERR_VAL_ITEM->number.target * sin(GUIDER_IMAGE_PERR_SPD_ITEM->number.target * M_PI * ((time(NULL) - start_time) % 360) / 180) + GUIDER_IMAGE_RA_OFFSET_ITEM->number.value;
+			uint64_t rng = rng_init(context.seed, 0x200000000ULL);
+			long phase = RENDER_SEED_ITEM->number.value > 0 ? (long)(frame % 360) : (long)((time(NULL) - start_time) % 360);
+			double ra_offset = GUIDER_IMAGE_PERR_VAL_ITEM->number.target * sin(GUIDER_IMAGE_PERR_SPD_ITEM->number.target * M_PI * phase / 180) + GUIDER_IMAGE_RA_OFFSET_ITEM->number.value;
 			double guider_sin = sin(M_PI * GUIDER_IMAGE_ANGLE_ITEM->number.target / 180.0);
 			double guider_cos = cos(M_PI * GUIDER_IMAGE_ANGLE_ITEM->number.target / 180.0);
 			double ao_sin = sin(M_PI * GUIDER_IMAGE_AO_ANGLE_ITEM->number.target / 180.0);
 			double ao_cos = cos(M_PI * GUIDER_IMAGE_AO_ANGLE_ITEM->number.target / 180.0);
-			double x_offset = ra_offset * guider_cos - GUIDER_IMAGE_DEC_OFFSET_ITEM->number.value * guider_sin + PRIVATE_DATA->ao_ra_offset * ao_cos - PRIVATE_DATA->ao_dec_offset * ao_sin + rand() / (double)RAND_MAX/10 - 0.1;
-			double y_offset = ra_offset * guider_sin + GUIDER_IMAGE_DEC_OFFSET_ITEM->number.value * guider_cos + PRIVATE_DATA->ao_ra_offset * ao_sin + PRIVATE_DATA->ao_dec_offset * ao_cos + rand() / (double)RAND_MAX/10 - 0.1;
+			double x_offset = ra_offset * guider_cos - GUIDER_IMAGE_DEC_OFFSET_ITEM->number.value * guider_sin + PRIVATE_DATA->ao_ra_offset * ao_cos - PRIVATE_DATA->ao_dec_offset * ao_sin + rng_next(&rng) / (double)UINT32_MAX/10 - 0.1;
+			double y_offset = ra_offset * guider_sin + GUIDER_IMAGE_DEC_OFFSET_ITEM->number.value * guider_cos + PRIVATE_DATA->ao_ra_offset * ao_sin + PRIVATE_DATA->ao_dec_offset * ao_cos + rng_next(&rng) / (double)UINT32_MAX/10 - 0.1;
 			bool y_flip = GUIDER_MODE_FLIP_STARS_ITEM->sw.value;
 			if (GUIDER_MODE_STARS_ITEM->sw.value || GUIDER_MODE_FLIP_STARS_ITEM->sw.value) {
 				for (int i = 0; i < STARS; i++) {
-					double center_x = (private_data->star_x[i] + x_offset) / horizontal_bin;
+					double center_x = (renderer->star_x[i] + x_offset) / horizontal_bin;
 					if (center_x < 0)
 						center_x += WIDTH;
 					if (center_x >= WIDTH)
 						center_x -= WIDTH;
-					double center_y = (private_data->star_y[i] + (y_flip ? -y_offset : y_offset)) / vertical_bin;
+					double center_y = (renderer->star_y[i] + (y_flip ? -y_offset : y_offset)) / vertical_bin;
 					if (center_y < 0)
 						center_y += HEIGHT;
 					if (center_y >= HEIGHT)
 						center_y -= HEIGHT;
-					center_x -= frame_left;
-					center_y -= frame_top;
-					int a = private_data->star_a[i];
-					int xMax = (int)round(center_x) + 4 / horizontal_bin;
-					int yMax = (int)round(center_y) + 4 / vertical_bin;
-					for (int y = yMax - 8 / vertical_bin; y <= yMax; y++) {
-						if (y < 0 || y >= frame_height)
-							continue;
-						int yw = y * frame_width;
-						double yy = center_y - y;
-						for (int x = xMax - 8 / horizontal_bin; x <= xMax; x++) {
-							if (x < 0 || x >= frame_width)
-								continue;
-							double xx = center_x - x;
-							double v = a * exp(-(xx * xx / 4 + yy * yy / 4));
-							raw[yw + x] += (unsigned short)v;
-						}
-					}
+					render_stamp_init(context.stamps + context.stamp_count++, center_x - frame_left, center_y - frame_top, renderer->star_a[i], horizontal_bin, vertical_bin);
 				}
 			} else {
-				double center_x = (WIDTH / 2 + x_offset) / horizontal_bin - frame_left;
-				double center_y = (HEIGHT / 2 + y_offset) / vertical_bin - frame_top;
-				double eclipse_x = (WIDTH / 2 + PRIVATE_DATA->eclipse + x_offset) / horizontal_bin - frame_left;
-				double eclipse_y = (HEIGHT / 2 + PRIVATE_DATA->eclipse + y_offset) / vertical_bin - frame_top;
-				for (int y = 0; y <= HEIGHT / vertical_bin; y++) {
-					if (y < 0 || y >= frame_height)
-						continue;
-					int yw = y * frame_width;
-					double yy = (center_y - y) * vertical_bin;
-					double eclipse_yy = (eclipse_y - y) * vertical_bin;
-					for (int x = 0; x <= WIDTH / horizontal_bin; x++) {
-						if (x < 0 || x >= frame_width)
-							continue;
-						double xx = (center_x - x) * horizontal_bin;
-						double eclipse_xx = (eclipse_x - x) * horizontal_bin;
-						double value = 500000 * exp(-((xx * xx + yy * yy) / 20000.0));
-						if (GUIDER_MODE_ECLIPSE_ITEM->sw.value && eclipse_xx*eclipse_xx+eclipse_yy*eclipse_yy < 50000)
-							value = 0;
-						if (value < 65535)
-							raw[yw + x] += (unsigned short)value;
-						else
-							raw[yw + x] = 65535;
-					}
-				}
+				context.sun = true;
+				context.eclipse = GUIDER_MODE_ECLIPSE_ITEM->sw.value;
+				context.center_x = (WIDTH / 2 + x_offset) / horizontal_bin - frame_left;
+				context.center_y = (HEIGHT / 2 + y_offset) / vertical_bin - frame_top;
+				context.eclipse_x = (WIDTH / 2 + PRIVATE_DATA->eclipse + x_offset) / horizontal_bin - frame_left;
+				context.eclipse_y = (HEIGHT / 2 + PRIVATE_DATA->eclipse + y_offset) / vertical_bin - frame_top;
 				if (GUIDER_MODE_ECLIPSE_ITEM->sw.value) {
 					PRIVATE_DATA->eclipse++;
 					if (PRIVATE_DATA->eclipse > ECLIPSE)
@@ -309,42 +618,32 @@ static void create_frame(indigo_device *device) {
 				}
 			}
 		}
-		for (int i = 0; i < size; i++) {
-			double value = raw[i] - offset;
-			if (value < 0)
-				value = 0;
-			value = gain * pow(value, gamma);
-			if (value > 65535)
-				value = 65535;
-			raw[i] = (unsigned short)value;
-		}
-		if (private_data->current_position != 0) {
-			unsigned short *tmp = malloc(2 * size);
-			gauss_blur(raw, tmp, frame_width, frame_height, private_data->current_position);
-			memcpy(raw, tmp, 2 * size);
-			free(tmp);
-		}
-
-		int value;
-		if (device == PRIVATE_DATA->imager && light_frame) {
-			for (int i = 0; i < size; i++) {
-				value = raw[i] + (rand() & 0x7F);
-				raw[i] = (value > 65535) ? 65535 : value;
-			}
-		} else if (device == PRIVATE_DATA->guider) {
-			for (int i = 0; i < size; i++) {
-				value = raw[i] + (rand() % (int)GUIDER_IMAGE_NOISE_VAR_ITEM->number.target) + GUIDER_IMAGE_NOISE_FIX_ITEM->number.target;
-				raw[i] = (value > 65535) ? 65535 : value;
+		if (context.background != BACKGROUND_NONE) {
+			context.lut = render_lut(device, CCD_GAIN_ITEM->number.value / 100, (int)CCD_OFFSET_ITEM->number.value, CCD_GAMMA_ITEM->number.value);
+			if (private_data->current_position != 0) {
+				context.blurred = true;
+				render_parallel(&context, frame_height, render_band_rows);
+				// column sums are allocated once per frame and shared by bands, every band uses its own slice
+				context.tmp = malloc(2 * size);
+				context.sums = malloc(frame_width * sizeof(int));
+				if (context.tmp != NULL && context.sums != NULL)
+					gauss_blur(&context, private_data->current_position);
+				else
+					INDIGO_DRIVER_ERROR(DRIVER_NAME, "Can't allocate blur buffers, frame is not blurred");
+				free(context.tmp);
+				free(context.sums);
+				render_parallel(&context, frame_height, render_noise_band);
+			} else {
+				render_parallel(&context, frame_height, render_band_rows);
 			}
 		} else {
-			for (int i = 0; i < size; i++)
-				raw[i] = (rand() & 0x7F);
+			render_parallel(&context, frame_height, render_noise_band);
 		}
 
 		for (int i = 0; i <= GUIDER_IMAGE_HOTPIXELS_ITEM->number.target; i++) {
-			unsigned x = private_data->hotpixel_x[i] / horizontal_bin - frame_left;
-			unsigned y = private_data->hotpixel_y[i] / vertical_bin - frame_top;
-			if (x < 0 || x >= frame_width || y < 0 || y > frame_height)
+			unsigned x = renderer->hotpixel_x[i] / horizontal_bin - frame_left;
+			unsigned y = renderer->hotpixel_y[i] / vertical_bin - frame_top;
+			if (x >= frame_width || y >= frame_height)
 				continue;
 			if (i) {
 				raw[y * frame_width + x] = 0xFFFF;
@@ -368,6 +667,7 @@ static void create_frame(indigo_device *device) {
 
 static void exposure_timer_callback(indigo_device *device) {
 	if (CCD_EXPOSURE_PROPERTY->state == INDIGO_BUSY_STATE) {
+		indigo_ccd_shutter_closed(device);
 		CCD_EXPOSURE_ITEM->number.value = 0;
 		indigo_update_property(device, CCD_EXPOSURE_PROPERTY, NULL);
 		create_frame(device);
@@ -386,8 +686,10 @@ static void streaming_timer_callback(indigo_device *device) {
 			CCD_IMAGE_PROPERTY->state = INDIGO_BUSY_STATE;
 			indigo_update_property(device, CCD_IMAGE_PROPERTY, NULL);
 		}
+		indigo_ccd_shutter_opened(device);
 		indigo_usleep(CCD_STREAMING_EXPOSURE_ITEM->number.target * ONE_SECOND_DELAY);
 		if (CCD_STREAMING_PROPERTY->state == INDIGO_BUSY_STATE && CCD_STREAMING_COUNT_ITEM->number.value != 0) {
+			indigo_ccd_shutter_closed(device);
 			create_frame(device);
 			if (CCD_STREAMING_COUNT_ITEM->number.value > 0)
 				CCD_STREAMING_COUNT_ITEM->number.value--;
@@ -543,20 +845,7 @@ static indigo_result ccd_attach(indigo_device *device) {
 			// -------------------------------------------------------------------------------- CCD_GAIN, CCD_OFFSET, CCD_GAMMA
 			CCD_GAIN_PROPERTY->hidden = CCD_OFFSET_PROPERTY->hidden = CCD_GAMMA_PROPERTY->hidden = false;
 			// -------------------------------------------------------------------------------- CCD_IMAGE
-			for (int i = 0; i < 5; i++) {
-				PRIVATE_DATA->star_x[i] = rand() % WIDTH;
-				PRIVATE_DATA->star_y[i] = rand() % HEIGHT;
-				PRIVATE_DATA->star_a[i] = 100 * (rand() % 100);
-			}
-			for (int i = 5; i < STARS; i++) {
-				PRIVATE_DATA->star_x[i] = rand() % WIDTH;
-				PRIVATE_DATA->star_y[i] = rand() % HEIGHT;
-				PRIVATE_DATA->star_a[i] = 30 * (rand() % 100);
-			}
-			for (int i = 0; i <= HOTPIXELS; i++) {
-				PRIVATE_DATA->hotpixel_x[i] = rand() % (WIDTH - 200) + 100;
-				PRIVATE_DATA->hotpixel_y[i] = rand() % (HEIGHT - 200) + 100;
-			}
+			generate_field(&RENDERER, rand());
 			// -------------------------------------------------------------------------------- CCD_COOLER, CCD_TEMPERATURE, CCD_COOLER_POWER
 			if (device == PRIVATE_DATA->imager) {
 				CCD_COOLER_PROPERTY->hidden = false;
@@ -575,6 +864,10 @@ static indigo_result ccd_attach(indigo_device *device) {
 		CCD_STREAMING_PROPERTY->hidden = false;
 		CCD_STREAMING_EXPOSURE_ITEM->number.min = 0.001;
 		CCD_STREAMING_EXPOSURE_ITEM->number.max = 0.5;
+		// -------------------------------------------------------------------------------- SIMULATOR_RENDER
+		RENDER_PROPERTY = indigo_init_number_property(NULL, device->name, "SIMULATOR_RENDER", MAIN_GROUP, "Renderer", INDIGO_OK_STATE, INDIGO_RW_PERM, 2);
+		indigo_init_number_item(RENDER_SEED_ITEM, "SEED", "Seed (0 = random)", 0, 2147483647, 1, 0);
+		indigo_init_number_item(RENDER_THREADS_ITEM, "THREADS", "Threads (0 = auto)", 0, MAX_RENDER_THREADS, 1, 0);
 		// --------------------------------------------------------------------------------
 		INDIGO_DEVICE_ATTACH_LOG(DRIVER_NAME, device->name);
 		return ccd_enumerate_properties(device, NULL, NULL);
@@ -607,6 +900,8 @@ indigo_result ccd_enumerate_properties(indigo_device *device, indigo_client *cli
 			if (indigo_property_match(GUIDER_SETTINGS_PROPERTY, property))
 				indigo_define_property(device, GUIDER_SETTINGS_PROPERTY, NULL);
 		}
+		if (indigo_property_match(RENDER_PROPERTY, property))
+			indigo_define_property(device, RENDER_PROPERTY, NULL);
 	}
 	return result;
 }
@@ -687,6 +982,7 @@ static indigo_result ccd_change_property(indigo_device *device, indigo_client *c
 			CCD_IMAGE_PROPERTY->state = INDIGO_BUSY_STATE;
 			indigo_update_property(device, CCD_IMAGE_PROPERTY, NULL);
 		}
+		indigo_ccd_shutter_opened(device);
 		if (device == PRIVATE_DATA->imager)
 			indigo_set_timer(device, CCD_EXPOSURE_ITEM->number.value > 0 ? CCD_EXPOSURE_ITEM->number.value : 0.1, exposure_timer_callback, &PRIVATE_DATA->imager_exposure_timer);
 		else if (device == PRIVATE_DATA->guider)
@@ -795,6 +1091,21 @@ static indigo_result ccd_change_property(indigo_device *device, indigo_client *c
 		GUIDER_SETTINGS_PROPERTY->state = INDIGO_OK_STATE;
 		indigo_update_property(device, GUIDER_SETTINGS_PROPERTY, NULL);
 		return INDIGO_OK;
+	} else if (indigo_property_match(RENDER_PROPERTY, property)) {
+		// -------------------------------------------------------------------------------- SIMULATOR_RENDER
+		pthread_mutex_lock(&PRIVATE_DATA->image_mutex);
+		indigo_property_copy_values(RENDER_PROPERTY, property, false);
+		if (RENDER_SEED_ITEM->number.value > 0) {
+			// restart the sequence, the same seed gives the same star field and frames
+			generate_field(&RENDERER, (uint64_t)RENDER_SEED_ITEM->number.value);
+			RENDERER.frame = 0;
+			if (device == PRIVATE_DATA->guider)
+				PRIVATE_DATA->eclipse = -ECLIPSE;
+		}
+		pthread_mutex_unlock(&PRIVATE_DATA->image_mutex);
+		RENDER_PROPERTY->state = INDIGO_OK_STATE;
+		indigo_update_property(device, RENDER_PROPERTY, NULL);
+		return INDIGO_OK;
 		// --------------------------------------------------------------------------------
 	}
 	return indigo_ccd_change_property(device, client, property);
@@ -817,6 +1128,7 @@ static indigo_result ccd_detach(indigo_device *device) {
 		indigo_release_property(GUIDER_MODE_PROPERTY);
 		indigo_release_property(GUIDER_SETTINGS_PROPERTY);
 	}
+	indigo_release_property(RENDER_PROPERTY);
 	INDIGO_DEVICE_DETACH_LOG(DRIVER_NAME, device->name);
 	return indigo_ccd_detach(device);
 }
@@ -1311,6 +1623,7 @@ indigo_result indigo_ccd_simulator(indigo_driver_action action, indigo_driver_in
 			pthread_mutex_init(&private_data->image_mutex, NULL);
 			assert(private_data != NULL);
 			memset(private_data, 0, sizeof(simulator_private_data));
+			render_pool_init(&private_data->render_pool);
 			imager_ccd = malloc(sizeof(indigo_device));
 			assert(imager_ccd != NULL);
 			memcpy(imager_ccd, &imager_camera_template, sizeof(indigo_device));
@@ -1397,6 +1710,7 @@ indigo_result indigo_ccd_simulator(indigo_driver_action action, indigo_driver_in
 				dslr = NULL;
 			}
 			if (private_data != NULL) {
+				render_pool_release(&private_data->render_pool);
 				pthread_mutex_destroy(&private_data->image_mutex);
 				free(private_data);
 				private_data = NULL;
@@ -23,7 +23,7 @@
  \file indigo_focuser_moonlite.c
  */
 
-#define DRIVER_VERSION 0x0009
+#define DRIVER_VERSION 0x000B
 #define DRIVER_NAME "indigo_focuser_moonlite"
 
 #include <stdlib.h>
@@ -48,45 +48,37 @@
 #define X_FOCUSER_STEPPING_MODE_HALF_ITEM			(X_FOCUSER_STEPPING_MODE_PROPERTY->items+0)
 #define X_FOCUSER_STEPPING_MODE_FULL_ITEM			(X_FOCUSER_STEPPING_MODE_PROPERTY->items+1)
 
+#define MOONLITE_RESPONSE_SIZE								16
+
 typedef struct {
-	int handle;
+	indigo_serial_transport *transport;
 	indigo_timer *timer;
+	bool poll_queued;
 	indigo_property *stepping_mode_property;
+	char temperature[MOONLITE_RESPONSE_SIZE], position[MOONLITE_RESPONSE_SIZE];
 	pthread_mutex_t mutex;
 } moonlite_private_data;
 
 static bool moonlite_command(indigo_device *device, char *command, char *response, int max) {
-	char c;
-	struct timeval tv;
-	tv.tv_sec = 1;
-	tv.tv_usec = 0;
-	indigo_write(PRIVATE_DATA->handle, command, strlen(command));
-	if (response != NULL) {
-		int index = 0;
-		while (index < max) {
-			fd_set readout;
-			FD_ZERO(&readout);
-			FD_SET(PRIVATE_DATA->handle, &readout);
-			long result = select(PRIVATE_DATA->handle+1, &readout, NULL, NULL, &tv);
-			if (result <= 0)
-				break;
-			result = read(PRIVATE_DATA->handle, &c, 1);
-			if (result < 1) {
-				INDIGO_DRIVER_ERROR(DRIVER_NAME, "Failed to read from %s -> %s (%d)", DEVICE_PORT_ITEM->text.value, strerror(errno), errno);
-				return false;
-			}
-			if (c < 0)
-				c = ':';
-			if (c == '#')
-				break;
-			response[index++] = c;
+	if (response == NULL) {
+		if (!indigo_serial_submit(PRIVATE_DATA->transport, command, -1, NULL, 0, 0, NULL, NULL)) {
+			INDIGO_DRIVER_ERROR(DRIVER_NAME, "Failed to write to %s", DEVICE_PORT_ITEM->text.value);
+			return false;
 		}
-		response[index] = 0;
+	} else if (indigo_serial_command(PRIVATE_DATA->transport, command, "#", 0, 1.0, response, max) < 0) {
+		INDIGO_DRIVER_ERROR(DRIVER_NAME, "No response to '%s' from %s", command, DEVICE_PORT_ITEM->text.value);
+		return false;
 	}
 	INDIGO_DRIVER_DEBUG(DRIVER_NAME, "Command '%s' -> '%s'", command, response != NULL ? response : "NULL");
 	return true;
 }
 
+static void moonlite_response(indigo_serial_transport *transport, void *data, const char *response, int length) {
+	// data points to private data buffer, so a response completed after the caller gave up is harmless
+	if (response != NULL)
+		strncpy(data, response, MOONLITE_RESPONSE_SIZE - 1);
+}
+
 // -------------------------------------------------------------------------------- INDIGO focuser device implementation
 
 static indigo_result focuser_attach(indigo_device *device) {
@@ -162,36 +154,23 @@ static indigo_result focuser_enumerate_properties(indigo_device *device, indigo_
 	return indigo_focuser_enumerate_properties(device, NULL, NULL);
 }
 
-static void focuser_timer_callback(indigo_device *device) {
+static void focuser_poll_handler(indigo_device *device) {
+	__atomic_store_n(&PRIVATE_DATA->poll_queued, false, __ATOMIC_RELEASE);
 	if (!IS_CONNECTED)
 		return;
 	pthread_mutex_lock(&PRIVATE_DATA->mutex);
 	static bool read_temperature = false;
-	char response[16];
-	if (read_temperature) {
-		if (moonlite_command(device, ":GT#", response, sizeof(response))) {
-			double temp = ((int8_t)strtol(response, NULL, 16)) / 2.0;
-			if (FOCUSER_TEMPERATURE_ITEM->number.value != temp) {
-				FOCUSER_TEMPERATURE_ITEM->number.value = temp;
-				FOCUSER_TEMPERATURE_PROPERTY->state = INDIGO_OK_STATE;
-				indigo_update_property(device, FOCUSER_TEMPERATURE_PROPERTY, NULL);
-			}
-		}
-		read_temperature = false;
-	} else {
-		moonlite_command(device, ":C#", NULL, 0);
-		read_temperature = true;
-	}
+	char *temperature = PRIVATE_DATA->temperature, *position = PRIVATE_DATA->position, moving[MOONLITE_RESPONSE_SIZE] = "";
+	*temperature = *position = 0;
+	// requests are pipelined, responses are matched in order so all are complete when the last one returns
+	if (read_temperature)
+		indigo_serial_submit(PRIVATE_DATA->transport, ":GT#", -1, "#", 0, 1.0, moonlite_response, temperature);
+	else
+		indigo_serial_submit(PRIVATE_DATA->transport, ":C#", -1, NULL, 0, 0, NULL, NULL);
+	indigo_serial_submit(PRIVATE_DATA->transport, ":GP#", -1, "#", 0, 1.0, moonlite_response, position);
 	bool update = false;
-	if (moonlite_command(device, ":GP#", response, sizeof(response))) {
-		long pos = strtol(response, NULL, 16);
-		if (FOCUSER_POSITION_ITEM->number.value != pos) {
-			FOCUSER_POSITION_ITEM->number.value = pos;
-			update = true;
-		}
-	}
-	if (moonlite_command(device, ":GI#", response, sizeof(response))) {
-		if (strcmp(response, "00") == 0) {
+	if (moonlite_command(device, ":GI#", moving, sizeof(moving))) {
+		if (strcmp(moving, "00") == 0) {
 			if (FOCUSER_POSITION_PROPERTY->state == INDIGO_BUSY_STATE) {
 				FOCUSER_STEPS_PROPERTY->state = INDIGO_OK_STATE;
 				FOCUSER_POSITION_PROPERTY->state = INDIGO_OK_STATE;
@@ -205,20 +184,47 @@ static void focuser_timer_callback(indigo_device *device) {
 			}
 		}
 	}
+	if (*temperature) {
+		double temp = ((int8_t)strtol(temperature, NULL, 16)) / 2.0;
+		if (FOCUSER_TEMPERATURE_ITEM->number.value != temp) {
+			FOCUSER_TEMPERATURE_ITEM->number.value = temp;
+			FOCUSER_TEMPERATURE_PROPERTY->state = INDIGO_OK_STATE;
+			indigo_update_property(device, FOCUSER_TEMPERATURE_PROPERTY, NULL);
+		}
+	}
+	read_temperature = !read_temperature;
+	if (*position) {
+		long pos = strtol(position, NULL, 16);
+		if (FOCUSER_POSITION_ITEM->number.value != pos) {
+			FOCUSER_POSITION_ITEM->number.value = pos;
+			update = true;
+		}
+	}
 	if (update) {
 		indigo_update_property(device, FOCUSER_POSITION_PROPERTY, NULL);
 		indigo_update_property(device, FOCUSER_STEPS_PROPERTY, NULL);
 	}
-	indigo_reschedule_timer(device, FOCUSER_POSITION_PROPERTY->state == INDIGO_BUSY_STATE ? 0.2 : 1.0, &PRIVATE_DATA->timer);
 	pthread_mutex_unlock(&PRIVATE_DATA->mutex);
 }
 
+// timer only queues polling to device handler queue, so it never runs in parallel with command handlers; at most one poll is queued at a time
+
+static void focuser_timer_callback(indigo_device *device) {
+	if (!__atomic_exchange_n(&PRIVATE_DATA->poll_queued, true, __ATOMIC_ACQ_REL)) {
+		if (!indigo_execute_handler(device, focuser_poll_handler))
+			__atomic_store_n(&PRIVATE_DATA->poll_queued, false, __ATOMIC_RELEASE);
+	}
+	indigo_reschedule_timer(device, FOCUSER_POSITION_PROPERTY->state == INDIGO_BUSY_STATE ? 0.2 : 1.0, &PRIVATE_DATA->timer);
+}
+
 static void focuser_connection_handler(indigo_device *device) {
 	pthread_mutex_lock(&PRIVATE_DATA->mutex);
 	char response[64];
 	if (CONNECTION_CONNECTED_ITEM->sw.value) {
-		PRIVATE_DATA->handle = indigo_open_serial_with_speed(DEVICE_PORT_ITEM->text.value, 9600);
-		if (PRIVATE_DATA->handle > 0) {
+		int handle = indigo_open_serial_with_speed(DEVICE_PORT_ITEM->text.value, 9600);
+		if (handle > 0 && (PRIVATE_DATA->transport = indigo_serial_open(handle, 4)) == NULL)
+			close(handle);
+		if (PRIVATE_DATA->transport != NULL) {
 			for (int i = 0; true; i++) {
 				if (moonlite_command(device, ":GV#", response, sizeof(response)) && strlen(response) == 2) {
 					INDIGO_DRIVER_LOG(DRIVER_NAME, "MoonLite focuser %c.%c", response[0], response[1]);
@@ -228,13 +234,13 @@ static void focuser_connection_handler(indigo_device *device) {
 					indigo_usleep(2 * ONE_SECOND_DELAY);
 				} else {
 					INDIGO_DRIVER_ERROR(DRIVER_NAME, "MoonLite focuser not detected");
-					close(PRIVATE_DATA->handle);
-					PRIVATE_DATA->handle = 0;
+					indigo_serial_close(PRIVATE_DATA->transport);
+					PRIVATE_DATA->transport = NULL;
 					break;
 				}
 			}
 		}
-		if (PRIVATE_DATA->handle > 0) {
+		if (PRIVATE_DATA->transport != NULL) {
 			moonlite_command(device, ":C#", NULL, 0);
 			moonlite_command(device, ":FQ#", NULL, 0);
 			moonlite_command(device, ":SF#", NULL, 0);
@@ -251,9 +257,10 @@ static void focuser_connection_handler(indigo_device *device) {
 				FOCUSER_COMPENSATION_ITEM->number.value = (char)strtol(response, NULL, 16);
 			}
 		}
-		if (PRIVATE_DATA->handle > 0) {
+		if (PRIVATE_DATA->transport != NULL) {
 			indigo_define_property(device, X_FOCUSER_STEPPING_MODE_PROPERTY, NULL);
 			INDIGO_DRIVER_LOG(DRIVER_NAME, "Connected to %s", DEVICE_PORT_ITEM->text.value);
+			PRIVATE_DATA->poll_queued = false;
 			indigo_set_timer(device, 0, focuser_timer_callback, &PRIVATE_DATA->timer);
 			CONNECTION_PROPERTY->state = INDIGO_OK_STATE;
 		} else {
@@ -262,13 +269,13 @@ static void focuser_connection_handler(indigo_device *device) {
 			indigo_set_switch(CONNECTION_PROPERTY, CONNECTION_DISCONNECTED_ITEM, true);
 		}
 	} else {
-		if (PRIVATE_DATA->handle > 0) {
+		if (PRIVATE_DATA->transport != NULL) {
 			indigo_cancel_timer_sync(device, &PRIVATE_DATA->timer);
 			moonlite_command(device, ":FQ#", NULL, 0);
 			indigo_delete_property(device, X_FOCUSER_STEPPING_MODE_PROPERTY, NULL);
 			INDIGO_DRIVER_LOG(DRIVER_NAME, "Disconnected");
-			close(PRIVATE_DATA->handle);
-			PRIVATE_DATA->handle = 0;
+			indigo_serial_close(PRIVATE_DATA->transport);
+			PRIVATE_DATA->transport = NULL;
 		}
 		CONNECTION_PROPERTY->state = INDIGO_OK_STATE;
 	}
@@ -404,42 +411,45 @@ static indigo_result focuser_change_property(indigo_device *device, indigo_clien
 		indigo_property_copy_values(CONNECTION_PROPERTY, property, false);
 		CONNECTION_PROPERTY->state = INDIGO_BUSY_STATE;
 		indigo_update_property(device, CONNECTION_PROPERTY, NULL);
-		indigo_set_timer(device, 0, focuser_connection_handler, NULL);
+		// queued requests are meaningless once disconnect is requested
+		if (CONNECTION_DISCONNECTED_ITEM->sw.value)
+			indigo_cancel_pending_handlers(device);
+		indigo_execute_handler(device, focuser_connection_handler);
 		return INDIGO_OK;
 	} else if (indigo_property_match(FOCUSER_SPEED_PROPERTY, property)) {
 		// -------------------------------------------------------------------------------- FOCUSER_SPEED
 		indigo_property_copy_values(FOCUSER_SPEED_PROPERTY, property, false);
-		indigo_set_timer(device, 0, focuser_speed_handler, NULL);
+		indigo_execute_handler(device, focuser_speed_handler);
 		return INDIGO_OK;
 	} else if (indigo_property_match(FOCUSER_STEPS_PROPERTY, property)) {
 		// -------------------------------------------------------------------------------- FOCUSER_STEPS
 		indigo_property_copy_values(FOCUSER_STEPS_PROPERTY, property, false);
-		indigo_set_timer(device, 0, focuser_steps_handler, NULL);
+		indigo_execute_handler(device, focuser_steps_handler);
 		return INDIGO_OK;
 	} else if (indigo_property_match(FOCUSER_POSITION_PROPERTY, property)) {
 		// -------------------------------------------------------------------------------- FOCUSER_POSITION
 		indigo_property_copy_values(FOCUSER_POSITION_PROPERTY, property, false);
-		indigo_set_timer(device, 0, focuser_position_handler, NULL);
+		indigo_execute_handler(device, focuser_position_handler);
 		return INDIGO_OK;
 	} else if (indigo_property_match(FOCUSER_ABORT_MOTION_PROPERTY, property)) {
 		// -------------------------------------------------------------------------------- FOCUSER_ABORT_MOTION
 		indigo_property_copy_values(FOCUSER_ABORT_MOTION_PROPERTY, property, false);
-		indigo_set_timer(device, 0, focuser_abort_handler, NULL);
+		indigo_execute_handler(device, focuser_abort_handler);
 		return INDIGO_OK;
 		// -------------------------------------------------------------------------------- FOCUSER_MODE
 	} else if (indigo_property_match(FOCUSER_MODE_PROPERTY, property)) {
 		indigo_property_copy_values(FOCUSER_MODE_PROPERTY, property, false);
-		indigo_set_timer(device, 0, focuser_mode_handler, NULL);
+		indigo_execute_handler(device, focuser_mode_handler);
 		return INDIGO_OK;
 		// -------------------------------------------------------------------------------- FOCUSER_COMPENSATION
 	} else if (indigo_property_match(FOCUSER_COMPENSATION_PROPERTY, property)) {
 		indigo_property_copy_values(FOCUSER_COMPENSATION_PROPERTY, property, false);
-		indigo_set_timer(device, 0, focuser_compensation_handler, NULL);
+		indigo_execute_handler(device, focuser_compensation_handler);
 		return INDIGO_OK;
 		// -------------------------------------------------------------------------------- X_FOCUSER_STEPPING_MODE
 	} else if (indigo_property_match(X_FOCUSER_STEPPING_MODE_PROPERTY, property)) {
 		indigo_property_copy_values(X_FOCUSER_STEPPING_MODE_PROPERTY, property, false);
-		indigo_set_timer(device, 0, focuser_stepping_mode_handler, NULL);
+		indigo_execute_handler(device, focuser_stepping_mode_handler);
 		return INDIGO_OK;
 	}
 	return indigo_focuser_change_property(device, client, property);
@@ -447,6 +457,7 @@ static indigo_result focuser_change_property(indigo_device *device, indigo_clien
 
 static indigo_result focuser_detach(indigo_device *device) {
 	assert(device != NULL);
+	indigo_cancel_pending_handlers_sync(device);
 	if (IS_CONNECTED) {
 		indigo_set_switch(CONNECTION_PROPERTY, CONNECTION_DISCONNECTED_ITEM, true);
 		focuser_connection_handler(device);
@@ -25,16 +25,24 @@
  \file indigo_gps_nmea.c
  */
 
-#define DRIVER_VERSION 0x000A
+#define DRIVER_VERSION 0x000B
 #define DRIVER_NAME	"idnigo_gps_nmea"
 
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <pthread.h>
 #include <math.h>
+#include <time.h>
 #include <assert.h>
 
+#ifdef INDIGO_LINUX
+#include <sys/ioctl.h>
+#include <linux/pps.h>
+#endif
+
 #include <indigo/indigo_driver_xml.h>
 #include <indigo/indigo_io.h>
 
@@ -42,12 +50,172 @@
 
 #define PRIVATE_DATA        ((nmea_private_data *)device->private_data)
 
+#define X_GPS_PPS_PROPERTY						(PRIVATE_DATA->pps_property)
+#define X_GPS_PPS_DEVICE_ITEM					(X_GPS_PPS_PROPERTY->items + 0)
+
+#define X_GPS_PPS_STATUS_PROPERTY			(PRIVATE_DATA->pps_status_property)
+#define X_GPS_PPS_STATUS_OFFSET_ITEM	(X_GPS_PPS_STATUS_PROPERTY->items + 0)
+#define X_GPS_PPS_STATUS_JITTER_ITEM	(X_GPS_PPS_STATUS_PROPERTY->items + 1)
+
+#define NMEA_MAX_TOKENS	32
+#define MAX_TALKERS			8
+#define TALKER_TIMEOUT	10		// satellites in view reported by talker which is silent for longer are not counted
+
+#define PPS_MAX_ERROR		0.01	// larger deviation restarts discipline
+#define PPS_GAIN				0.1
+#define PPS_MIN_SAMPLES	4
+
+typedef struct {
+	char talker[3];
+	int in_view;
+	double updated;
+} nmea_talker;
+
 typedef struct {
 	int handle;
 	pthread_mutex_t serial_mutex;
-	indigo_timer *timer_callback;
+	indigo_serial_transport *transport;
+	nmea_talker talkers[MAX_TALKERS];
+	time_t utc;
+	bool valid;
+	indigo_property *pps_property;
+	indigo_property *pps_status_property;
+	int pps_handle;
+	bool pps_running;
+	indigo_timer *pps_timer;
+	pthread_mutex_t pps_mutex;
+	double pps_mono, pps_real;
+	time_t pps_utc;
+	double pps_offset, pps_jitter;
+	int pps_samples;
 } nmea_private_data;
 
+static double monotonic_time(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// -------------------------------------------------------------------------------- PPS
+
+#ifdef INDIGO_LINUX
+
+static void pps_reader(indigo_device *device) {
+	unsigned int sequence = 0;
+	INDIGO_DRIVER_LOG(DRIVER_NAME, "PPS reader started");
+	while (PRIVATE_DATA->pps_running) {
+		struct pps_fdata data;
+		memset(&data, 0, sizeof(data));
+		data.timeout.sec = 1;
+		if (ioctl(PRIVATE_DATA->pps_handle, PPS_FETCH, &data) < 0) {
+			if (errno == ETIMEDOUT || errno == EINTR)
+				continue;
+			INDIGO_DRIVER_ERROR(DRIVER_NAME, "PPS_FETCH failed (%s)", strerror(errno));
+			break;
+		}
+		if (data.info.assert_sequence == sequence)
+			continue;
+		sequence = data.info.assert_sequence;
+		// kernel timestamps pulse by realtime clock, it is converted to monotonic clock which is not stepped
+		struct timespec real, mono;
+		clock_gettime(CLOCK_REALTIME, &real);
+		clock_gettime(CLOCK_MONOTONIC, &mono);
+		double pulse = data.info.assert_tu.sec + data.info.assert_tu.nsec / 1e9;
+		pthread_mutex_lock(&PRIVATE_DATA->pps_mutex);
+		PRIVATE_DATA->pps_real = pulse;
+		PRIVATE_DATA->pps_mono = mono.tv_sec + mono.tv_nsec / 1e9 - (real.tv_sec + real.tv_nsec / 1e9 - pulse);
+		pthread_mutex_unlock(&PRIVATE_DATA->pps_mutex);
+	}
+	INDIGO_DRIVER_LOG(DRIVER_NAME, "PPS reader finished");
+}
+
+static bool pps_open(indigo_device *device) {
+	char *name = X_GPS_PPS_DEVICE_ITEM->text.value;
+	int handle = open(name, O_RDWR);
+	if (handle < 0)
+		handle = open(name, O_RDONLY);
+	if (handle < 0) {
+		INDIGO_DRIVER_ERROR(DRIVER_NAME, "Failed to open %s (%s)", name, strerror(errno));
+		return false;
+	}
+	int mode = 0;
+	if (ioctl(handle, PPS_GETCAP, &mode) < 0 || !(mode & PPS_CANWAIT) || !(mode & PPS_CAPTUREASSERT)) {
+		INDIGO_DRIVER_ERROR(DRIVER_NAME, "%s can't wait for assert events", name);
+		close(handle);
+		return false;
+	}
+	struct pps_kparams params;
+	if (ioctl(handle, PPS_GETPARAMS, &params) == 0 && !(params.mode & PPS_CAPTUREASSERT)) {
+		params.mode |= PPS_CAPTUREASSERT;
+		if (ioctl(handle, PPS_SETPARAMS, &params) < 0)
+			INDIGO_DRIVER_ERROR(DRIVER_NAME, "Failed to enable assert capture on %s (%s)", name, strerror(errno));
+	}
+	PRIVATE_DATA->pps_handle = handle;
+	PRIVATE_DATA->pps_mono = PRIVATE_DATA->pps_real = 0;
+	PRIVATE_DATA->pps_utc = 0;
+	PRIVATE_DATA->pps_samples = 0;
+	PRIVATE_DATA->pps_running = true;
+	indigo_set_timer(device, 0, pps_reader, &PRIVATE_DATA->pps_timer);
+	INDIGO_DRIVER_LOG(DRIVER_NAME, "Connected to %s", name);
+	return true;
+}
+
+static void pps_close(indigo_device *device) {
+	if (PRIVATE_DATA->pps_handle < 0)
+		return;
+	PRIVATE_DATA->pps_running = false;
+	indigo_cancel_timer_sync(device, &PRIVATE_DATA->pps_timer);
+	close(PRIVATE_DATA->pps_handle);
+	PRIVATE_DATA->pps_handle = -1;
+	INDIGO_DRIVER_LOG(DRIVER_NAME, "Disconnected from %s", X_GPS_PPS_DEVICE_ITEM->text.value);
+}
+
+#else
+
+static bool pps_open(indigo_device *device) {
+	INDIGO_DRIVER_ERROR(DRIVER_NAME, "PPS is supported on Linux only");
+	return false;
+}
+
+static void pps_close(indigo_device *device) {
+}
+
+#endif
+
+static void pps_discipline(indigo_device *device, time_t utc) {
+	pthread_mutex_lock(&PRIVATE_DATA->pps_mutex);
+	double pulse_mono = PRIVATE_DATA->pps_mono;
+	double pulse_real = PRIVATE_DATA->pps_real;
+	pthread_mutex_unlock(&PRIVATE_DATA->pps_mutex);
+	if (pulse_mono == 0 || utc == PRIVATE_DATA->pps_utc)
+		return;
+	// sentence is reported shortly after the pulse marking the beginning of its second
+	double age = monotonic_time() - pulse_mono;
+	if (age <= 0 || age >= 0.9)
+		return;
+	PRIVATE_DATA->pps_utc = utc;
+	double offset = utc - pulse_mono;
+	double error = offset - PRIVATE_DATA->pps_offset;
+	if (PRIVATE_DATA->pps_samples == 0 || fabs(error) > PPS_MAX_ERROR) {
+		if (PRIVATE_DATA->pps_samples)
+			INDIGO_DRIVER_LOG(DRIVER_NAME, "PPS discipline restarted (error %.3fs)", error);
+		PRIVATE_DATA->pps_offset = offset;
+		PRIVATE_DATA->pps_jitter = 0;
+		PRIVATE_DATA->pps_samples = 1;
+	} else {
+		PRIVATE_DATA->pps_offset += PPS_GAIN * error;
+		PRIVATE_DATA->pps_jitter += PPS_GAIN * (fabs(error) - PRIVATE_DATA->pps_jitter);
+		PRIVATE_DATA->pps_samples++;
+	}
+	if (PRIVATE_DATA->pps_samples < PPS_MIN_SAMPLES)
+		return;
+	indigo_set_utc_offset(PRIVATE_DATA->pps_offset, PRIVATE_DATA->pps_jitter);
+	X_GPS_PPS_STATUS_OFFSET_ITEM->number.value = round((pulse_real - utc) * 1e6) / 1e3;
+	X_GPS_PPS_STATUS_JITTER_ITEM->number.value = round(PRIVATE_DATA->pps_jitter * 1e6);
+	X_GPS_PPS_STATUS_PROPERTY->state = INDIGO_OK_STATE;
+	indigo_update_property(device, X_GPS_PPS_STATUS_PROPERTY, NULL);
+}
+
 // -------------------------------------------------------------------------------- INDIGO GPS device implementation
 
 static bool gps_open(indigo_device *device) {
@@ -61,6 +229,10 @@ static bool gps_open(indigo_device *device) {
 		indigo_network_protocol proto = INDIGO_PROTOCOL_TCP;
 		PRIVATE_DATA->handle = indigo_open_network_device(name, 9999, &proto);
 	}
+	if (PRIVATE_DATA->handle >= 0 && (PRIVATE_DATA->transport = indigo_serial_open(PRIVATE_DATA->handle, 1)) == NULL) {
+		close(PRIVATE_DATA->handle);
+		PRIVATE_DATA->handle = -1;
+	}
 	if (PRIVATE_DATA->handle >= 0) {
 		INDIGO_DRIVER_LOG(DRIVER_NAME, "Connected to %s", name);
 		pthread_mutex_unlock(&PRIVATE_DATA->serial_mutex);
@@ -74,17 +246,22 @@ static bool gps_open(indigo_device *device) {
 
 static void gps_close(indigo_device *device) {
 	pthread_mutex_lock(&PRIVATE_DATA->serial_mutex);
-	close(PRIVATE_DATA->handle);
+	indigo_serial_close(PRIVATE_DATA->transport);
+	PRIVATE_DATA->transport = NULL;
 	PRIVATE_DATA->handle = -1;
 	INDIGO_DRIVER_LOG(DRIVER_NAME, "Disconnected from %s", DEVICE_PORT_ITEM->text.value);
 	pthread_mutex_unlock(&PRIVATE_DATA->serial_mutex);
 }
 
-static char **parse(char *buffer) {
+static int parse(char *buffer, char **tokens, char *talker) {
 	INDIGO_DRIVER_DEBUG(DRIVER_NAME, "%s", buffer);
-	if (strncmp("$GP", buffer, 3))
-		return NULL;
-	char *index = strchr(buffer, '*');
+	char *index = buffer + strlen(buffer);
+	while (index > buffer && (index[-1] == '\r' || index[-1] == '\n'))
+		*--index = 0;
+	// $ttSSS with any talker, proprietary $P sentences are ignored
+	if (*buffer != '$' || buffer[1] == 'P' || strlen(buffer) < 6 || buffer[6] != ',')
+		return 0;
+	index = strchr(buffer, '*');
 	if (index) {
 		*index++ = 0;
 		int c1 = (int)strtol(index, NULL, 16);
@@ -93,148 +270,189 @@ static char **parse(char *buffer) {
 		while (*index)
 			c2 ^= *index++;
 		if (c1 != c2)
-			return NULL;
+			return 0;
 	}
-	static char *tokens[32];
-	int token = 0;
-	memset(tokens, 0, sizeof(tokens));
+	talker[0] = buffer[1];
+	talker[1] = buffer[2];
+	talker[2] = 0;
+	int count = 0;
 	index = buffer + 3;
-	while (index) {
-		tokens[token++] = index;
+	while (index && count < NMEA_MAX_TOKENS) {
+		tokens[count++] = index;
 		index = strchr(index, ',');
 		if (index)
 			*index++ = 0;
 	}
-	return tokens;
+	return count;
+}
+
+static double parse_coordinate(char *value, char *hemisphere, char negative) {
+	double result = indigo_atod(value);
+	result = floor(result / 100) + fmod(result, 100) / 60;
+	if (*hemisphere == negative)
+		result = -result;
+	return round(result * 10000) / 10000;
+}
+
+static void update_utc(indigo_device *device, int year, int month, int day, double time) {
+	if (year == 0 || month == 0 || day == 0)
+		return;
+	int seconds = (int)time;
+	struct tm tm;
+	memset(&tm, 0, sizeof(tm));
+	tm.tm_year = year - 1900;
+	tm.tm_mon = month - 1;
+	tm.tm_mday = day;
+	tm.tm_hour = seconds / 10000;
+	tm.tm_min = (seconds / 100) % 100;
+	tm.tm_sec = seconds % 100;
+	time_t utc = timegm(&tm);
+	if (PRIVATE_DATA->pps_handle >= 0 && PRIVATE_DATA->valid && time == seconds)
+		pps_discipline(device, utc);
+	if (utc == PRIVATE_DATA->utc && GPS_UTC_TIME_PROPERTY->state == INDIGO_OK_STATE)
+		return;
+	PRIVATE_DATA->utc = utc;
+	strftime(GPS_UTC_ITEM->text.value, INDIGO_VALUE_SIZE, "%Y-%m-%dT%H:%M:%S", &tm);
+	GPS_UTC_TIME_PROPERTY->state = INDIGO_OK_STATE;
+	indigo_update_property(device, GPS_UTC_TIME_PROPERTY, NULL);
+}
+
+static void update_in_view(indigo_device *device, char *talker, int in_view) {
+	double now = monotonic_time();
+	nmea_talker *slot = NULL;
+	int total = 0;
+	for (int i = 0; i < MAX_TALKERS; i++) {
+		nmea_talker *entry = PRIVATE_DATA->talkers + i;
+		if (!strcmp(entry->talker, talker) || (slot == NULL && (*entry->talker == 0 || now - entry->updated > TALKER_TIMEOUT))) {
+			slot = entry;
+		}
+	}
+	if (slot == NULL)
+		return;
+	strcpy(slot->talker, talker);
+	slot->in_view = in_view;
+	slot->updated = now;
+	for (int i = 0; i < MAX_TALKERS; i++) {
+		nmea_talker *entry = PRIVATE_DATA->talkers + i;
+		if (*entry->talker && now - entry->updated <= TALKER_TIMEOUT)
+			total += entry->in_view;
+	}
+	if (GPS_ADVANCED_STATUS_SVS_IN_VIEW_ITEM->number.value != total) {
+		GPS_ADVANCED_STATUS_SVS_IN_VIEW_ITEM->number.value = total;
+		GPS_ADVANCED_STATUS_PROPERTY->state = INDIGO_OK_STATE;
+		if (GPS_ADVANCED_ENABLED_ITEM->sw.value) {
+			indigo_update_property(device, GPS_ADVANCED_STATUS_PROPERTY, NULL);
+		}
+	}
 }
 
-static void gps_refresh_callback(indigo_device *device) {
-	char buffer[128];
-	char **tokens;
-	INDIGO_DRIVER_LOG(DRIVER_NAME, "NMEA reader started");
-	while (IS_CONNECTED && PRIVATE_DATA->handle >= 0) {
-		//pthread_mutex_lock(&PRIVATE_DATA->serial_mutex);
-		if (indigo_read_line(PRIVATE_DATA->handle, buffer, sizeof(buffer)) > 0 && (tokens = parse(buffer))) {
-			if (!strcmp(tokens[0], "RMC")) { // Recommended Minimum sentence C
-				int time = atoi(tokens[1]);
-				int date = atoi(tokens[9]);
-				sprintf(GPS_UTC_ITEM->text.value, "20%02d-%02d-%02dT%02d:%02d:%02d", date % 100, (date / 100) % 100, date / 10000, time / 10000, (time / 100) % 100, time % 100);
+static void nmea_listener(indigo_serial_transport *transport, void *data, const char *response, int length) {
+	indigo_device *device = data;
+	char buffer[128], talker[3];
+	char *tokens[NMEA_MAX_TOKENS];
+	if (length >= sizeof(buffer))
+		return;
+	memcpy(buffer, response, length + 1);
+	int count = parse(buffer, tokens, talker);
+	if (count == 0)
+		return;
+	if (!strcmp(tokens[0], "RMC") && count >= 10) { // Recommended Minimum sentence C
+		int date = atoi(tokens[9]);
+		PRIVATE_DATA->valid = *tokens[2] == 'A';
+		update_utc(device, 2000 + date % 100, (date / 100) % 100, date / 10000, indigo_atod(tokens[1]));
+		if (!PRIVATE_DATA->valid)
+			return;
+		double lat = parse_coordinate(tokens[3], tokens[4], 'S');
+		double lon = parse_coordinate(tokens[5], tokens[6], 'W');
+		if (GPS_GEOGRAPHIC_COORDINATES_LONGITUDE_ITEM->number.value != lon || GPS_GEOGRAPHIC_COORDINATES_LATITUDE_ITEM->number.value != lat) {
+			GPS_GEOGRAPHIC_COORDINATES_LONGITUDE_ITEM->number.value = lon;
+			GPS_GEOGRAPHIC_COORDINATES_LATITUDE_ITEM->number.value = lat;
+			GPS_GEOGRAPHIC_COORDINATES_PROPERTY->state = INDIGO_OK_STATE;
+			indigo_update_property(device, GPS_GEOGRAPHIC_COORDINATES_PROPERTY, NULL);
+		}
+	} else if (!strcmp(tokens[0], "ZDA") && count >= 5) { // Time & Date
+		update_utc(device, atoi(tokens[4]), atoi(tokens[3]), atoi(tokens[2]), indigo_atod(tokens[1]));
+	} else if (!strcmp(tokens[0], "GGA") && count >= 10) { // Global Positioning System Fix Data
+		if (atoi(tokens[6]) == 0)
+			return;
+		double lat = parse_coordinate(tokens[2], tokens[3], 'S');
+		double lon = parse_coordinate(tokens[4], tokens[5], 'W');
+		double elv = round(indigo_atod(tokens[9]));
+		if (GPS_GEOGRAPHIC_COORDINATES_LONGITUDE_ITEM->number.value != lon || GPS_GEOGRAPHIC_COORDINATES_LATITUDE_ITEM->number.value != lat || GPS_GEOGRAPHIC_COORDINATES_ELEVATION_ITEM->number.value != elv) {
+			GPS_GEOGRAPHIC_COORDINATES_LONGITUDE_ITEM->number.value = lon;
+			GPS_GEOGRAPHIC_COORDINATES_LATITUDE_ITEM->number.value = lat;
+			GPS_GEOGRAPHIC_COORDINATES_ELEVATION_ITEM->number.value = elv;
+			GPS_GEOGRAPHIC_COORDINATES_PROPERTY->state = INDIGO_OK_STATE;
+			indigo_update_property(device, GPS_GEOGRAPHIC_COORDINATES_PROPERTY, NULL);
+		}
+		int in_use = atoi(tokens[7]);
+		if (GPS_ADVANCED_STATUS_SVS_IN_USE_ITEM->number.value != in_use) {
+			GPS_ADVANCED_STATUS_SVS_IN_USE_ITEM->number.value = in_use;
+			GPS_ADVANCED_STATUS_PROPERTY->state = INDIGO_OK_STATE;
+			if (GPS_ADVANCED_ENABLED_ITEM->sw.value) {
+				indigo_update_property(device, GPS_ADVANCED_STATUS_PROPERTY, NULL);
+			}
+		}
+	} else if (!strcmp(tokens[0], "GSV") && count >= 4) { // Satellites in view, reported separately by each constellation
+		update_in_view(device, talker, atoi(tokens[3]));
+	} else if (!strcmp(tokens[0], "GSA") && count >= 18) { // Satellite status
+		char fix = *tokens[2] - '0';
+		if (fix == 1 && GPS_STATUS_NO_FIX_ITEM->light.value != INDIGO_ALERT_STATE) {
+			GPS_STATUS_NO_FIX_ITEM->light.value = INDIGO_ALERT_STATE;
+			GPS_STATUS_2D_FIX_ITEM->light.value = INDIGO_IDLE_STATE;
+			GPS_STATUS_3D_FIX_ITEM->light.value = INDIGO_IDLE_STATE;
+			GPS_STATUS_PROPERTY->state = INDIGO_OK_STATE;
+			if (GPS_GEOGRAPHIC_COORDINATES_PROPERTY->state != INDIGO_BUSY_STATE) {
+				GPS_GEOGRAPHIC_COORDINATES_PROPERTY->state = INDIGO_BUSY_STATE;
+				indigo_update_property(device, GPS_GEOGRAPHIC_COORDINATES_PROPERTY, NULL);
+			}
+			if (GPS_UTC_TIME_PROPERTY->state != INDIGO_BUSY_STATE) {
+				GPS_UTC_TIME_PROPERTY->state = INDIGO_BUSY_STATE;
+				indigo_update_property(device, GPS_UTC_TIME_PROPERTY, NULL);
+			}
+			indigo_update_property(device, GPS_STATUS_PROPERTY, NULL);
+		} else if (fix == 2 && GPS_STATUS_2D_FIX_ITEM->light.value != INDIGO_BUSY_STATE) {
+			GPS_STATUS_NO_FIX_ITEM->light.value = INDIGO_IDLE_STATE;
+			GPS_STATUS_2D_FIX_ITEM->light.value = INDIGO_BUSY_STATE;
+			GPS_STATUS_3D_FIX_ITEM->light.value = INDIGO_IDLE_STATE;
+			GPS_STATUS_PROPERTY->state = INDIGO_OK_STATE;
+			indigo_update_property(device, GPS_STATUS_PROPERTY, NULL);
+			if (GPS_GEOGRAPHIC_COORDINATES_PROPERTY->state != INDIGO_BUSY_STATE) {
+				GPS_GEOGRAPHIC_COORDINATES_PROPERTY->state = INDIGO_BUSY_STATE;
+				indigo_update_property(device, GPS_GEOGRAPHIC_COORDINATES_PROPERTY, NULL);
+			}
+			if (GPS_UTC_TIME_PROPERTY->state != INDIGO_BUSY_STATE) {
+				GPS_UTC_TIME_PROPERTY->state = INDIGO_BUSY_STATE;
+				indigo_update_property(device, GPS_UTC_TIME_PROPERTY, NULL);
+			}
+		} else if (fix == 3 && GPS_STATUS_3D_FIX_ITEM->light.value != INDIGO_OK_STATE) {
+			GPS_STATUS_NO_FIX_ITEM->light.value = INDIGO_IDLE_STATE;
+			GPS_STATUS_2D_FIX_ITEM->light.value = INDIGO_IDLE_STATE;
+			GPS_STATUS_3D_FIX_ITEM->light.value = INDIGO_OK_STATE;
+			GPS_STATUS_PROPERTY->state = INDIGO_OK_STATE;
+			if (GPS_GEOGRAPHIC_COORDINATES_PROPERTY->state != INDIGO_OK_STATE) {
+				GPS_GEOGRAPHIC_COORDINATES_PROPERTY->state = INDIGO_OK_STATE;
+				indigo_update_property(device, GPS_GEOGRAPHIC_COORDINATES_PROPERTY, NULL);
+			}
+			if (GPS_UTC_TIME_PROPERTY->state != INDIGO_OK_STATE) {
 				GPS_UTC_TIME_PROPERTY->state = INDIGO_OK_STATE;
 				indigo_update_property(device, GPS_UTC_TIME_PROPERTY, NULL);
-				double lat = indigo_atod(tokens[3]);
-				lat = floor(lat / 100) + fmod(lat, 100) / 60;
-				if (!strcmp(tokens[4], "S"))
-					lat = -lat;
-				lat = round(lat * 10000) / 10000;
-				double lon = indigo_atod(tokens[5]);
-				lon = floor(lon / 100) + fmod(lon, 100) / 60;
-				if (!strcmp(tokens[6], "W"))
-					lon = -lon;
-				lon = round(lon * 10000) / 10000;
-				if (GPS_GEOGRAPHIC_COORDINATES_LONGITUDE_ITEM->number.value != lon || GPS_GEOGRAPHIC_COORDINATES_LATITUDE_ITEM->number.value != lat) {
-					GPS_GEOGRAPHIC_COORDINATES_LONGITUDE_ITEM->number.value = lon;
-					GPS_GEOGRAPHIC_COORDINATES_LATITUDE_ITEM->number.value = lat;
-					GPS_GEOGRAPHIC_COORDINATES_PROPERTY->state = INDIGO_OK_STATE;
-					indigo_update_property(device, GPS_GEOGRAPHIC_COORDINATES_PROPERTY, NULL);
-				}
-			} else if (!strcmp(tokens[0], "GGA")) { // Global Positioning System Fix Data
-				double lat = indigo_atod(tokens[2]);
-				lat = floor(lat / 100) + fmod(lat, 100) / 60;
-				if (!strcmp(tokens[3], "S"))
-					lat = -lat;
-				lat = round(lat * 10000) / 10000;
-				double lon = indigo_atod(tokens[4]);
-				lon = floor(lon / 100) + fmod(lon, 100) / 60;
-				if (!strcmp(tokens[5], "W"))
-					lon = -lon;
-				lon = round(lon * 10000) / 10000;
-				double elv = round(indigo_atod(tokens[9]));
-				if (GPS_GEOGRAPHIC_COORDINATES_LONGITUDE_ITEM->number.value != lon || GPS_GEOGRAPHIC_COORDINATES_LATITUDE_ITEM->number.value != lat || GPS_GEOGRAPHIC_COORDINATES_ELEVATION_ITEM->number.value != elv) {
-					GPS_GEOGRAPHIC_COORDINATES_LONGITUDE_ITEM->number.value = lon;
-					GPS_GEOGRAPHIC_COORDINATES_LATITUDE_ITEM->number.value = lat;
-					GPS_GEOGRAPHIC_COORDINATES_ELEVATION_ITEM->number.value = elv;
-					GPS_GEOGRAPHIC_COORDINATES_PROPERTY->state = INDIGO_OK_STATE;
-					indigo_update_property(device, GPS_GEOGRAPHIC_COORDINATES_PROPERTY, NULL);
-				}
-				int in_use = atoi(tokens[7]);
-				if (GPS_ADVANCED_STATUS_SVS_IN_USE_ITEM->number.value != in_use) {
-					GPS_ADVANCED_STATUS_SVS_IN_USE_ITEM->number.value = in_use;
-					GPS_ADVANCED_STATUS_PROPERTY->state = INDIGO_OK_STATE;
-					if (GPS_ADVANCED_ENABLED_ITEM->sw.value) {
-						indigo_update_property(device, GPS_ADVANCED_STATUS_PROPERTY, NULL);
-					}
-				}
-			} else if (!strcmp(tokens[0], "GSV")) { // Satellites in view
-				int in_view = atoi(tokens[3]);
-				if (GPS_ADVANCED_STATUS_SVS_IN_VIEW_ITEM->number.value != in_view) {
-					GPS_ADVANCED_STATUS_SVS_IN_VIEW_ITEM->number.value = in_view;
-					GPS_ADVANCED_STATUS_PROPERTY->state = INDIGO_OK_STATE;
-					if (GPS_ADVANCED_ENABLED_ITEM->sw.value) {
-						indigo_update_property(device, GPS_ADVANCED_STATUS_PROPERTY, NULL);
-					}
-				}
-			} else if (!strcmp(tokens[0], "GSA")) { // Satellite status
-				char fix = *tokens[2] - '0';
-				if (fix == 1 && GPS_STATUS_NO_FIX_ITEM->light.value != INDIGO_ALERT_STATE) {
-					GPS_STATUS_NO_FIX_ITEM->light.value = INDIGO_ALERT_STATE;
-					GPS_STATUS_2D_FIX_ITEM->light.value = INDIGO_IDLE_STATE;
-					GPS_STATUS_3D_FIX_ITEM->light.value = INDIGO_IDLE_STATE;
-					GPS_STATUS_PROPERTY->state = INDIGO_OK_STATE;
-					if (GPS_GEOGRAPHIC_COORDINATES_PROPERTY->state != INDIGO_BUSY_STATE) {
-						GPS_GEOGRAPHIC_COORDINATES_PROPERTY->state = INDIGO_BUSY_STATE;
-						indigo_update_property(device, GPS_GEOGRAPHIC_COORDINATES_PROPERTY, NULL);
-					}
-					if (GPS_UTC_TIME_PROPERTY->state != INDIGO_BUSY_STATE) {
-						GPS_UTC_TIME_PROPERTY->state = INDIGO_BUSY_STATE;
-						indigo_update_property(device, GPS_UTC_TIME_PROPERTY, NULL);
-					}
-					indigo_update_property(device, GPS_STATUS_PROPERTY, NULL);
-				} else if (fix == 2 && GPS_STATUS_2D_FIX_ITEM->light.value != INDIGO_BUSY_STATE) {
-					GPS_STATUS_NO_FIX_ITEM->light.value = INDIGO_IDLE_STATE;
-					GPS_STATUS_2D_FIX_ITEM->light.value = INDIGO_BUSY_STATE;
-					GPS_STATUS_3D_FIX_ITEM->light.value = INDIGO_IDLE_STATE;
-					GPS_STATUS_PROPERTY->state = INDIGO_OK_STATE;
-					indigo_update_property(device, GPS_STATUS_PROPERTY, NULL);
-					if (GPS_GEOGRAPHIC_COORDINATES_PROPERTY->state != INDIGO_BUSY_STATE) {
-						GPS_GEOGRAPHIC_COORDINATES_PROPERTY->state = INDIGO_BUSY_STATE;
-						indigo_update_property(device, GPS_GEOGRAPHIC_COORDINATES_PROPERTY, NULL);
-					}
-					if (GPS_UTC_TIME_PROPERTY->state != INDIGO_BUSY_STATE) {
-						GPS_UTC_TIME_PROPERTY->state = INDIGO_BUSY_STATE;
-						indigo_update_property(device, GPS_UTC_TIME_PROPERTY, NULL);
-					}
-				} else if (fix == 3 && GPS_STATUS_3D_FIX_ITEM->light.value != INDIGO_OK_STATE) {
-					GPS_STATUS_NO_FIX_ITEM->light.value = INDIGO_IDLE_STATE;
-					GPS_STATUS_2D_FIX_ITEM->light.value = INDIGO_IDLE_STATE;
-					GPS_STATUS_3D_FIX_ITEM->light.value = INDIGO_OK_STATE;
-					GPS_STATUS_PROPERTY->state = INDIGO_OK_STATE;
-					if (GPS_GEOGRAPHIC_COORDINATES_PROPERTY->state != INDIGO_OK_STATE) {
-						GPS_GEOGRAPHIC_COORDINATES_PROPERTY->state = INDIGO_OK_STATE;
-						indigo_update_property(device, GPS_GEOGRAPHIC_COORDINATES_PROPERTY, NULL);
-					}
-					if (GPS_UTC_TIME_PROPERTY->state != INDIGO_OK_STATE) {
-						GPS_UTC_TIME_PROPERTY->state = INDIGO_OK_STATE;
-						indigo_update_property(device, GPS_UTC_TIME_PROPERTY, NULL);
-					}
-					indigo_update_property(device, GPS_STATUS_PROPERTY, NULL);
-				}
-				double pdop = indigo_atod(tokens[15]);
-				double hdop = indigo_atod(tokens[16]);
-				double vdop = indigo_atod(tokens[17]);
-				if (GPS_ADVANCED_STATUS_PDOP_ITEM->number.value != pdop || GPS_ADVANCED_STATUS_HDOP_ITEM->number.value != hdop || GPS_ADVANCED_STATUS_VDOP_ITEM->number.value != vdop) {
-					GPS_ADVANCED_STATUS_PDOP_ITEM->number.value = pdop;
-					GPS_ADVANCED_STATUS_HDOP_ITEM->number.value = hdop;
-					GPS_ADVANCED_STATUS_VDOP_ITEM->number.value = vdop;
-					GPS_ADVANCED_STATUS_PROPERTY->state = INDIGO_OK_STATE;
-					if (GPS_ADVANCED_ENABLED_ITEM->sw.value) {
-						indigo_update_property(device, GPS_ADVANCED_STATUS_PROPERTY, NULL);
-					}
-				}
+			}
+			indigo_update_property(device, GPS_STATUS_PROPERTY, NULL);
+		}
+		double pdop = indigo_atod(tokens[15]);
+		double hdop = indigo_atod(tokens[16]);
+		double vdop = indigo_atod(tokens[17]);
+		if (GPS_ADVANCED_STATUS_PDOP_ITEM->number.value != pdop || GPS_ADVANCED_STATUS_HDOP_ITEM->number.value != hdop || GPS_ADVANCED_STATUS_VDOP_ITEM->number.value != vdop) {
+			GPS_ADVANCED_STATUS_PDOP_ITEM->number.value = pdop;
+			GPS_ADVANCED_STATUS_HDOP_ITEM->number.value = hdop;
+			GPS_ADVANCED_STATUS_VDOP_ITEM->number.value = vdop;
+			GPS_ADVANCED_STATUS_PROPERTY->state = INDIGO_OK_STATE;
+			if (GPS_ADVANCED_ENABLED_ITEM->sw.value) {
+				indigo_update_property(device, GPS_ADVANCED_STATUS_PROPERTY, NULL);
 			}
 		}
-		//pthread_mutex_unlock(&PRIVATE_DATA->serial_mutex);
 	}
-	INDIGO_DRIVER_LOG(DRIVER_NAME, "NMEA reader finished");
 }
 
 static indigo_result gps_attach(indigo_device *device) {
@@ -251,10 +469,24 @@ static indigo_result gps_attach(indigo_device *device) {
 		GPS_GEOGRAPHIC_COORDINATES_PROPERTY->count = 3;
 		GPS_UTC_TIME_PROPERTY->hidden = false;
 		GPS_UTC_TIME_PROPERTY->count = 1;
+		// -------------------------------------------------------------------------------- X_GPS_PPS
+		X_GPS_PPS_PROPERTY = indigo_init_text_property(NULL, device->name, "X_GPS_PPS", GPS_ADVANCED_GROUP, "PPS source", INDIGO_OK_STATE, INDIGO_RW_PERM, 1);
+		if (X_GPS_PPS_PROPERTY == NULL)
+			return INDIGO_FAILED;
+		indigo_init_text_item(X_GPS_PPS_DEVICE_ITEM, "DEVICE", "Device (e.g. /dev/pps0)", "");
+		// -------------------------------------------------------------------------------- X_GPS_PPS_STATUS
+		X_GPS_PPS_STATUS_PROPERTY = indigo_init_number_property(NULL, device->name, "X_GPS_PPS_STATUS", GPS_ADVANCED_GROUP, "PPS status", INDIGO_BUSY_STATE, INDIGO_RO_PERM, 2);
+		if (X_GPS_PPS_STATUS_PROPERTY == NULL)
+			return INDIGO_FAILED;
+		indigo_init_number_item(X_GPS_PPS_STATUS_OFFSET_ITEM, "OFFSET", "System clock offset (ms)", -1e9, 1e9, 0, 0);
+		indigo_init_number_item(X_GPS_PPS_STATUS_JITTER_ITEM, "JITTER", "Jitter (us)", 0, 1e9, 0, 0);
+		pthread_mutex_init(&PRIVATE_DATA->pps_mutex, NULL);
+		// --------------------------------------------------------------------------------
 #ifdef INDIGO_LINUX
 		for (int i = 0; i < DEVICE_PORTS_PROPERTY->count; i++) {
 			if (strstr(DEVICE_PORTS_PROPERTY->items[i].name, "ttyGPS")) {
-				strncpy(DEVICE_PORT_ITEM->text.value, DEVICE_PORTS_PROPERTY->items[i].name, INDIGO_VALUE_SIZE);
+				strncpy(DEVICE_PORT_ITEM->text.value, DEVICE_PORTS_PROPERTY->items[i].name, INDIGO_VALUE_SIZE - 1);
+				DEVICE_PORT_ITEM->text.value[INDIGO_VALUE_SIZE - 1] = 0;
 				break;
 			}
 		}
@@ -265,6 +497,16 @@ static indigo_result gps_attach(indigo_device *device) {
 	return INDIGO_FAILED;
 }
 
+static indigo_result gps_enumerate_properties(indigo_device *device, indigo_client *client, indigo_property *property) {
+	if (IS_CONNECTED && PRIVATE_DATA->pps_handle >= 0) {
+		if (indigo_property_match(X_GPS_PPS_STATUS_PROPERTY, property))
+			indigo_define_property(device, X_GPS_PPS_STATUS_PROPERTY, NULL);
+	}
+	if (indigo_property_match(X_GPS_PPS_PROPERTY, property))
+		indigo_define_property(device, X_GPS_PPS_PROPERTY, NULL);
+	return indigo_gps_enumerate_properties(device, NULL, NULL);
+}
+
 static void gps_connect_callback(indigo_device *device) {
 	if (CONNECTION_CONNECTED_ITEM->sw.value) {
 		if (PRIVATE_DATA->handle == -1) {
@@ -279,7 +521,20 @@ static void gps_connect_callback(indigo_device *device) {
 				GPS_STATUS_PROPERTY->state = INDIGO_BUSY_STATE;
 				GPS_UTC_TIME_PROPERTY->state = INDIGO_BUSY_STATE;
 				sprintf(GPS_UTC_ITEM->text.value, "0000-00-00T00:00:00.00");
-				indigo_set_timer(device, 0, gps_refresh_callback, &PRIVATE_DATA->timer_callback);
+				PRIVATE_DATA->utc = 0;
+				PRIVATE_DATA->valid = false;
+				memset(PRIVATE_DATA->talkers, 0, sizeof(PRIVATE_DATA->talkers));
+				if (*X_GPS_PPS_DEVICE_ITEM->text.value) {
+					if (pps_open(device)) {
+						X_GPS_PPS_STATUS_PROPERTY->state = INDIGO_BUSY_STATE;
+						indigo_define_property(device, X_GPS_PPS_STATUS_PROPERTY, NULL);
+						X_GPS_PPS_PROPERTY->state = INDIGO_OK_STATE;
+					} else {
+						X_GPS_PPS_PROPERTY->state = INDIGO_ALERT_STATE;
+					}
+					indigo_update_property(device, X_GPS_PPS_PROPERTY, NULL);
+				}
+				indigo_serial_set_listener(PRIVATE_DATA->transport, "\n", nmea_listener, device);
 				CONNECTION_PROPERTY->state = INDIGO_OK_STATE;
 			} else {
 				indigo_set_switch(CONNECTION_PROPERTY, CONNECTION_DISCONNECTED_ITEM, true);
@@ -288,7 +543,10 @@ static void gps_connect_callback(indigo_device *device) {
 		}
 	} else {
 		if (PRIVATE_DATA->handle != -1) {
-			indigo_cancel_timer_sync(device, &PRIVATE_DATA->timer_callback);
+			if (PRIVATE_DATA->pps_handle >= 0) {
+				pps_close(device);
+				indigo_delete_property(device, X_GPS_PPS_STATUS_PROPERTY, NULL);
+			}
 			gps_close(device);
 			CONNECTION_PROPERTY->state = INDIGO_OK_STATE;
 		}
@@ -309,6 +567,17 @@ static indigo_result gps_change_property(indigo_device *device, indigo_client *c
 		indigo_update_property(device, CONNECTION_PROPERTY, NULL);
 		indigo_set_timer(device, 0, gps_connect_callback, NULL);
 		return INDIGO_OK;
+	} else if (indigo_property_match(X_GPS_PPS_PROPERTY, property)) {
+		// -------------------------------------------------------------------------------- X_GPS_PPS
+		indigo_property_copy_values(X_GPS_PPS_PROPERTY, property, false);
+		X_GPS_PPS_PROPERTY->state = INDIGO_OK_STATE;
+		indigo_update_property(device, X_GPS_PPS_PROPERTY, IS_CONNECTED ? "PPS source will be used after reconnection" : NULL);
+		return INDIGO_OK;
+		// -------------------------------------------------------------------------------- CONFIG
+	} else if (indigo_property_match(CONFIG_PROPERTY, property)) {
+		if (indigo_switch_match(CONFIG_SAVE_ITEM, property)) {
+			indigo_save_property(device, NULL, X_GPS_PPS_PROPERTY);
+		}
 	}
 	return indigo_gps_change_property(device, client, property);
 }
@@ -319,6 +588,9 @@ static indigo_result gps_detach(indigo_device *device) {
 		indigo_set_switch(CONNECTION_PROPERTY, CONNECTION_DISCONNECTED_ITEM, true);
 		gps_connect_callback(device);
 	}
+	indigo_release_property(X_GPS_PPS_PROPERTY);
+	indigo_release_property(X_GPS_PPS_STATUS_PROPERTY);
+	pthread_mutex_destroy(&PRIVATE_DATA->pps_mutex);
 	INDIGO_DEVICE_DETACH_LOG(DRIVER_NAME, device->name);
 	return indigo_gps_detach(device);
 }
@@ -333,7 +605,7 @@ indigo_result indigo_gps_nmea(indigo_driver_action action, indigo_driver_info *i
 	static indigo_device gps_template = INDIGO_DEVICE_INITIALIZER(
 		GPS_NMEA_NAME,
 		gps_attach,
-		indigo_gps_enumerate_properties,
+		gps_enumerate_properties,
 		gps_change_property,
 		NULL,
 		gps_detach
@@ -353,6 +625,7 @@ indigo_result indigo_gps_nmea(indigo_driver_action action, indigo_driver_info *i
 		assert(private_data != NULL);
 		memset(private_data, 0, sizeof(nmea_private_data));
 		private_data->handle = -1;
+		private_data->pps_handle = -1;
 		gps = malloc(sizeof(indigo_device));
 		assert(gps != NULL);
 		memcpy(gps, &gps_template, sizeof(indigo_device));
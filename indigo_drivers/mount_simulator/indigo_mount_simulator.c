@@ -24,7 +24,7 @@
  \file indigo_mount_simulator.c
  */
 
-#define DRIVER_VERSION 0x0006
+#define DRIVER_VERSION 0x0008
 #define DRIVER_NAME "indigo_mount_simulator"
 
 #include <stdlib.h>
@@ -44,6 +44,7 @@ typedef struct {
 	bool parking, parked, going_home, at_home;
 	indigo_timer *position_timer, *move_timer, *guider_timer;
 	double ha;
+	double tracking_time;
 	bool slew_in_progress;
 	pthread_mutex_t position_mutex;
 } simulator_private_data;
@@ -52,6 +53,10 @@ typedef struct {
 
 static void position_timer_callback(indigo_device *device) {
 	pthread_mutex_lock(&PRIVATE_DATA->position_mutex);
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	double elapsed = PRIVATE_DATA->tracking_time > 0 ? now.tv_sec + now.tv_nsec / 1e9 - PRIVATE_DATA->tracking_time : 0;
+	PRIVATE_DATA->tracking_time = now.tv_sec + now.tv_nsec / 1e9;
 	if (IS_CONNECTED) {
 		double diffRA = MOUNT_RAW_COORDINATES_RA_ITEM->number.target - MOUNT_RAW_COORDINATES_RA_ITEM->number.value;
 		double diffDec = MOUNT_RAW_COORDINATES_DEC_ITEM->number.target - MOUNT_RAW_COORDINATES_DEC_ITEM->number.value;
@@ -98,6 +103,10 @@ static void position_timer_callback(indigo_device *device) {
 		} else {
 			if (PRIVATE_DATA->parked || (MOUNT_EQUATORIAL_COORDINATES_PROPERTY->state == INDIGO_OK_STATE && MOUNT_TRACKING_OFF_ITEM->sw.value)) {
 				MOUNT_RAW_COORDINATES_RA_ITEM->number.value = fmod(indigo_lst(NULL, MOUNT_GEOGRAPHIC_COORDINATES_LONGITUDE_ITEM->number.value) - PRIVATE_DATA->ha + 24, 24);
+			} else if (MOUNT_EQUATORIAL_COORDINATES_PROPERTY->state == INDIGO_OK_STATE && MOUNT_TRACKING_ON_ITEM->sw.value && MOUNT_TRACK_RATE_CUSTOM_ITEM->sw.value) {
+				// custom rate is relative to sidereal one, so raw coordinates move just by the rate (arcsec/s)
+				MOUNT_RAW_COORDINATES_RA_ITEM->number.value = MOUNT_RAW_COORDINATES_RA_ITEM->number.target = fmod(MOUNT_RAW_COORDINATES_RA_ITEM->number.value + MOUNT_CUSTOM_TRACKING_RATE_RA_ITEM->number.value * elapsed / 54000 + 24, 24);
+				MOUNT_RAW_COORDINATES_DEC_ITEM->number.value = MOUNT_RAW_COORDINATES_DEC_ITEM->number.target = fmax(-90, fmin(90, MOUNT_RAW_COORDINATES_DEC_ITEM->number.value + MOUNT_CUSTOM_TRACKING_RATE_DEC_ITEM->number.value * elapsed / 3600));
 			}
 			indigo_reschedule_timer(device, 1.0, &PRIVATE_DATA->position_timer);
 		}
@@ -125,10 +134,11 @@ static void move_timer_callback(indigo_device *device) {
 	else if (MOUNT_MOTION_SOUTH_ITEM->sw.value)
 		decStep = -speed * 15;
 	double raStep = 0;
+	// west increases hour angle, i.e. decreases RA
 	if (MOUNT_MOTION_WEST_ITEM->sw.value)
-		raStep = speed;
-	else if (MOUNT_MOTION_EAST_ITEM->sw.value)
 		raStep = -speed;
+	else if (MOUNT_MOTION_EAST_ITEM->sw.value)
+		raStep = speed;
 	if (raStep == 0 && decStep == 0) {
 		MOUNT_EQUATORIAL_COORDINATES_PROPERTY->state = MOUNT_RAW_COORDINATES_PROPERTY->state = INDIGO_OK_STATE;
 		PRIVATE_DATA->move_timer = NULL;
@@ -178,7 +188,14 @@ static indigo_result mount_attach(indigo_device *device) {
 		MOUNT_ALIGNMENT_MODE_PROPERTY->hidden = false;
 		// -------------------------------------------------------------------------------- MOUNT_TRACK_RATE
 		MOUNT_TRACK_RATE_PROPERTY->count = 5;
+		// -------------------------------------------------------------------------------- MOUNT_CUSTOM_TRACKING_RATE, MOUNT_TRACKING_EPHEMERIS, MOUNT_EPHEMERIS_TARGET
+		MOUNT_CUSTOM_TRACKING_RATE_PROPERTY->hidden = false;
+		MOUNT_TRACKING_EPHEMERIS_PROPERTY->hidden = false;
+		MOUNT_EPHEMERIS_TARGET_PROPERTY->hidden = false;
 		indigo_set_switch(MOUNT_TRACKING_PROPERTY, MOUNT_TRACKING_OFF_ITEM, true);
+		// -------------------------------------------------------------------------------- MOUNT_LIMITS, MOUNT_HORIZON
+		MOUNT_LIMITS_PROPERTY->hidden = false;
+		MOUNT_HORIZON_PROPERTY->hidden = false;
 		// -------------------------------------------------------------------------------- AUTHENTICATION
 		AUTHENTICATION_PROPERTY->hidden = false;
 		AUTHENTICATION_PROPERTY->count = 1;
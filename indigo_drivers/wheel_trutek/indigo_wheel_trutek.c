@@ -23,7 +23,7 @@
  \file indigo_ccd_trutek.c
  */
 
-#define DRIVER_VERSION 0x0003
+#define DRIVER_VERSION 0x0004
 #define DRIVER_NAME "indigo_wheel_trutek"
 
 #include <stdlib.h>
@@ -130,7 +130,7 @@ static void wheel_connect_callback(indigo_device *device) {
 	if (CONNECTION_CONNECTED_ITEM->sw.value) {
 		if (trutek_open(device)) {
 			CONNECTION_PROPERTY->state = INDIGO_OK_STATE;
-			indigo_set_timer(device, 0, trutek_query, NULL);
+			indigo_execute_handler(device, trutek_query);
 		} else {
 			CONNECTION_PROPERTY->state = INDIGO_ALERT_STATE;
 			indigo_set_switch(CONNECTION_PROPERTY, CONNECTION_DISCONNECTED_ITEM, true);
@@ -154,7 +154,10 @@ static indigo_result wheel_change_property(indigo_device *device, indigo_client
 		indigo_property_copy_values(CONNECTION_PROPERTY, property, false);
 		CONNECTION_PROPERTY->state = INDIGO_BUSY_STATE;
 		indigo_update_property(device, CONNECTION_PROPERTY, NULL);
-		indigo_set_timer(device, 0, wheel_connect_callback, NULL);
+		// queued requests are meaningless once disconnect is requested
+		if (CONNECTION_DISCONNECTED_ITEM->sw.value)
+			indigo_cancel_pending_handlers(device);
+		indigo_execute_handler(device, wheel_connect_callback);
 		return INDIGO_OK;
 	} else if (indigo_property_match(WHEEL_SLOT_PROPERTY, property)) {
 		// -------------------------------------------------------------------------------- WHEEL_SLOT
@@ -166,7 +169,7 @@ static indigo_result wheel_change_property(indigo_device *device, indigo_client
 		} else {
 			WHEEL_SLOT_PROPERTY->state = INDIGO_BUSY_STATE;
 			WHEEL_SLOT_ITEM->number.value = PRIVATE_DATA->slot;
-			indigo_set_timer(device, 0, trutek_goto, NULL);
+			indigo_execute_handler(device, trutek_goto);
 		}
 		indigo_update_property(device, WHEEL_SLOT_PROPERTY, NULL);
 		return INDIGO_OK;
@@ -177,6 +180,7 @@ static indigo_result wheel_change_property(indigo_device *device, indigo_client
 
 static indigo_result wheel_detach(indigo_device *device) {
 	assert(device != NULL);
+	indigo_cancel_pending_handlers_sync(device);
 	if (IS_CONNECTED) {
 		indigo_set_switch(CONNECTION_PROPERTY, CONNECTION_DISCONNECTED_ITEM, true);
 		wheel_connect_callback(device);
@@ -16,7 +16,7 @@
 
 #if 1
 
-// INDIGO hack, JPLEPH.421 is embeded into executable
+// INDIGO hack, JPLEPH.421 is embeded into executable (and exported for indigo_ephemeris.c)
 
 extern char binary_jpleph_start[];
 extern char binary_jpleph_end[];
@@ -24,6 +24,8 @@ extern char binary_jpleph_end[];
 #if defined(INDIGO_LINUX)
 
 __asm__(".section \".rodata\", \"\"");
+__asm__(".globl binary_jpleph_start");
+__asm__(".globl binary_jpleph_end");
 __asm__("binary_jpleph_start:");
 __asm__(".incbin \"JPLEPH.421\"");
 __asm__("binary_jpleph_end:");
@@ -35,6 +37,8 @@ __asm__(".previous");
 #if defined(INDIGO_MACOS)
 
 __asm__(".section \".rodata\", \"\"");
+__asm__(".globl _binary_jpleph_start");
+__asm__(".globl _binary_jpleph_end");
 __asm__("_binary_jpleph_start:");
 __asm__(".incbin \"JPLEPH.421\"");
 __asm__("_binary_jpleph_end:");
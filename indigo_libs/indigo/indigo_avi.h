@@ -40,6 +40,8 @@
 #define H_GWAVI
 
 #include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
 
 struct gwavi_header_t {
 	unsigned int time_delay;	/* dwMicroSecPerFrame */
@@ -90,17 +92,33 @@ struct gwavi_stream_format_t {
 	unsigned int palette_count;
 };
 
+/* OpenDML limits, RIFF chunks are kept under 1GB for compatibility, super index has fixed number of slots */
+#define GWAVI_RIFF_LIMIT				(1024 * 1024 * 1024)
+#define GWAVI_SUPER_INDEX_SIZE	1024
+
+struct gwavi_super_index_entry_t {
+	uint64_t offset;		/* qwOffset of ix00 chunk */
+	uint32_t size;			/* dwSize of ix00 chunk */
+	uint32_t duration;	/* dwDuration in frames */
+};
+
 struct gwavi_t {
 	int handle;
 	struct gwavi_header_t avi_header;
 	struct gwavi_stream_header_t stream_header;
 	struct gwavi_stream_format_t stream_format;
-	long marker;
-	int offsets_ptr;
+	uint64_t position;					/* current end of file */
+	uint64_t riff_start;				/* offset of current RIFF chunk */
+	uint64_t movi_start;				/* offset of current movi LIST chunk */
+	int riff_count;
+	uint32_t *offsets;					/* idx1 entries (offset, size) for frames in the first RIFF chunk */
 	int offsets_len;
-	long offsets_start;
-	unsigned int *offsets;
 	int offset_count;
+	uint32_t *std_index;				/* ix00 entries (offset, size) for frames in current movi LIST */
+	int std_index_len;
+	int std_index_count;
+	struct gwavi_super_index_entry_t super_index[GWAVI_SUPER_INDEX_SIZE];
+	int super_index_count;
 };
 
 extern struct gwavi_t *gwavi_open(const char *filename, unsigned int width, unsigned int height, const char *fourcc, unsigned int fps);
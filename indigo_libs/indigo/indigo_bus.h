@@ -360,7 +360,7 @@ typedef struct {
 	pthread_mutex_t mutext;							///< BLOB mutex
 } indigo_blob_entry;
 
-/** Last diagnostic messages.
+/** Last error message.
  */
 extern char indigo_last_message[];
 
@@ -373,9 +373,14 @@ extern char indigo_log_name[];
 extern void (*indigo_log_message_handler)(const char *message);
 
 /** Print diagnostic messages.
+ Messages are queued and written by background thread, errors are written before the call returns.
  */
 extern void indigo_log_message(const char *format, va_list args);
 
+/** Wait until all queued diagnostic messages are written.
+ */
+extern void indigo_log_flush(void);
+
 /** Print diagnostic messages on trace level, wrap calls to INDIGO_TRACE() macro.
  */
 extern void indigo_trace(const char *format, ...);
@@ -658,6 +663,10 @@ extern const char **indigo_main_argv;
  */
 extern bool indigo_use_syslog;
 
+/** Prefix stderr log lines with #thread id (off by default, it changes line format expected by log parsers).
+ */
+extern bool indigo_log_thread_ids;
+
 /** Ignore messages from remote devices containing local service name to avoid loops.
  */
 extern char indigo_local_service_name[INDIGO_NAME_SIZE];
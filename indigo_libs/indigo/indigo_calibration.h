@@ -0,0 +1,160 @@
+// Copyright (c) 2020 CloudMakers, s. r. o.
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// version history
+// 2.0 by Peter Polakovic <peter.polakovic@cloudmakers.eu>
+
+/** INDIGO CCD calibration (master dark, bias and flat frames)
+ \file indigo_calibration.h
+ */
+
+#ifndef indigo_calibration_h
+#define indigo_calibration_h
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include <indigo/indigo_bus.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Max number of frames combined into master frame.
+ */
+#define INDIGO_CALIBRATION_MAX_STACK	64
+
+/** Max sensor temperature difference between master frame and light frame.
+ */
+#define INDIGO_CALIBRATION_TEMPERATURE_TOLERANCE	2.0
+
+/** Calibration frame type.
+ */
+typedef enum {
+	INDIGO_CALIBRATION_NONE = 0,
+	INDIGO_CALIBRATION_BIAS,
+	INDIGO_CALIBRATION_DARK,
+	INDIGO_CALIBRATION_FLAT
+} indigo_calibration_type;
+
+/** Master frame record.
+ */
+typedef struct indigo_calibration_frame {
+	indigo_calibration_type type;							///< frame type
+	char file_name[INDIGO_VALUE_SIZE];				///< FITS file name
+	int width;																///< frame width
+	int height;																///< frame height
+	int channels;															///< 1 for mono, 3 for RGB
+	int bin_x;																///< horizontal binning
+	int bin_y;																///< vertical binning
+	double exposure;													///< exposure time [s]
+	double temperature;												///< sensor temperature [C] or NAN if unknown
+	float *data;															///< pixel data (interleaved like RAW), loaded on first use
+	struct indigo_calibration_frame *next;		///< next record
+} indigo_calibration_frame;
+
+/** File names of master frames applied to calibrated frame, empty if not used.
+ */
+typedef struct {
+	char bias[INDIGO_VALUE_SIZE];							///< master bias
+	char dark[INDIGO_VALUE_SIZE];							///< master dark
+	char flat[INDIGO_VALUE_SIZE];							///< master flat
+} indigo_calibration_masters;
+
+/** Callback invoked when master frame combined in background is saved (result is true) or failed.
+ */
+typedef void (*indigo_calibration_callback)(void *data, bool result, const char *file_name);
+
+/** Calibration context.
+ */
+typedef struct {
+	pthread_mutex_t mutex;										///< context mutex
+	indigo_calibration_frame *frames;					///< master frame library
+	indigo_calibration_frame *bias;						///< selected master bias
+	indigo_calibration_frame *dark;						///< selected master dark
+	indigo_calibration_frame *flat;						///< selected master flat
+	double exposure;													///< exposure used for offset frame
+	long samples;															///< number of samples in offset and gain
+	float *offset;														///< bias + scaled dark
+	float *gain;															///< normalized inverse flat
+	indigo_calibration_type build_type;				///< type of master frame in progress
+	int build_count;													///< number of frames to combine
+	int build_collected;											///< number of frames collected so far
+	double build_sigma;												///< kappa for sigma clipping, 0 for median
+	int build_width;													///< master frame width
+	int build_height;													///< master frame height
+	int build_channels;												///< master frame channels
+	int build_bin_x;													///< master frame horizontal binning
+	int build_bin_y;													///< master frame vertical binning
+	double build_exposure;										///< master frame exposure time
+	double build_temperature;									///< master frame temperature sum
+	uint16_t *build_stack;										///< collected frames
+	pthread_t combine_thread;									///< thread combining master frame in background
+	bool combine_thread_started;							///< combine_thread is valid and not joined yet
+} indigo_calibration;
+
+/** Create calibration context.
+ */
+extern indigo_calibration *indigo_calibration_create(void);
+
+/** Release calibration context.
+ */
+extern void indigo_calibration_release(indigo_calibration *calibration);
+
+/** Scan directory for master frames, returns number of master frames found.
+ */
+extern int indigo_calibration_scan(indigo_calibration *calibration, const char *dir);
+
+/** Select master frames matching the frame, returns true if any master is selected.
+ */
+extern bool indigo_calibration_select(indigo_calibration *calibration, int width, int height, int channels, int bin_x, int bin_y, double exposure, double temperature);
+
+/** Apply selected master frames in-place to RAW data with 8 or 16 bits per sample (24 or 48 bits per pixel for RGB), masters (if not NULL) receives master frames actually applied.
+ */
+extern bool indigo_calibration_apply(indigo_calibration *calibration, void *data, int width, int height, int bpp, bool little_endian, indigo_calibration_masters *masters);
+
+/** Start collection of frames for master frame.
+ */
+extern bool indigo_calibration_start_master(indigo_calibration *calibration, indigo_calibration_type type, int count, double sigma);
+
+/** Add frame to master frame in progress, returns number of frames collected, 0 if no master frame is in progress or -1 if the frame doesn't match.
+ */
+extern int indigo_calibration_add_frame(indigo_calibration *calibration, void *data, int width, int height, int bpp, bool little_endian, int bin_x, int bin_y, double exposure, double temperature);
+
+/** Combine collected frames, save master frame to directory and add it to library.
+ */
+extern bool indigo_calibration_finish_master(indigo_calibration *calibration, const char *dir, const char *instrument, char *file_name, int file_name_size);
+
+/** Detach collected frames and combine, save and add master frame to library on background thread, callback is called from that thread.
+ */
+extern bool indigo_calibration_finish_master_async(indigo_calibration *calibration, const char *dir, const char *instrument, indigo_calibration_callback callback, void *callback_data);
+
+/** Wait for master frame combined in background.
+ */
+extern void indigo_calibration_wait_master(indigo_calibration *calibration);
+
+/** Abort master frame in progress.
+ */
+extern void indigo_calibration_abort_master(indigo_calibration *calibration);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* indigo_calibration_h */
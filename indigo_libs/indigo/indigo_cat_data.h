@@ -0,0 +1,66 @@
+// Copyright (c) 2019 CloudMakers, s. r. o.
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// version history
+// 2.0 by Peter Polakovic <peter.polakovic@cloudmakers.eu>
+
+/** INDIGO star, DSO and constellation catalogue data
+ \file indigo_cat_data.h
+ */
+
+
+#ifndef indigo_cat_data_h
+#define indigo_cat_data_h
+
+#include <indigo/indigo_cat_index.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define INDIGO_CAT_STARS_MAX_MAG		6
+#define INDIGO_CAT_DSOS_MAX_MAG			10
+
+#define INDIGO_CAT_FEATURES_HEADER	"{\"type\":\"FeatureCollection\",\"features\": ["
+#define INDIGO_CAT_FEATURES_FOOTER	"]}"
+#define INDIGO_CAT_LINES_HEADER			"{\"type\":\"FeatureCollection\",\"features\":[{\"type\":\"Feature\",\"id\":\"Const\",\"properties\":{},\"geometry\":{\"type\":\"MultiLineString\",\"coordinates\":["
+#define INDIGO_CAT_LINES_FOOTER			"]}}]}"
+
+/** Bundled Hipparcos stars (J2000), terminated by hip == 0.
+ */
+extern indigo_star_entry indigo_star_data[];
+
+/** Bundled DSOs (J2000), terminated by id == NULL.
+ */
+extern indigo_dso_entry indigo_dso_data[];
+
+/** Constellation lines as zero terminated HIP number sequences, terminated by empty sequence.
+ */
+extern int indigo_constellation_lines[];
+
+/** Format star, DSO or line vertex as d3-celestial GeoJSON, returns length.
+ */
+extern int indigo_cat_star_feature(char *buffer, indigo_star_entry *star, double ra, double dec);
+extern int indigo_cat_dso_feature(char *buffer, indigo_dso_entry *dso, double ra, double dec);
+extern int indigo_cat_line_vertex(char *buffer, double ra, double dec);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* indigo_cat_data_h */
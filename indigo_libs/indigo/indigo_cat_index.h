@@ -0,0 +1,80 @@
+// Copyright (c) 2020 CloudMakers, s. r. o.
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// version history
+// 2.0 by Peter Polakovic <peter.polakovic@cloudmakers.eu>
+
+/** INDIGO star and DSO catalogue spatial index
+ \file indigo_cat_index.h
+ */
+
+#ifndef indigo_cat_index_h
+#define indigo_cat_index_h
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Star catalogue entry (RA in hours, Dec in degrees).
+ */
+typedef struct {
+	int hip;
+	double ra, dec;
+	float promora, promodec, px, rv, mag;
+	char *name;
+} indigo_star_entry;
+
+/** DSO catalogue entry (RA in hours, Dec in degrees).
+ */
+typedef struct {
+	char *id;
+	double ra, dec;
+	float mag, r1, r2, angle;
+	char *name;
+} indigo_dso_entry;
+
+/** Build HEALPix index over star (terminated by hip == 0) and DSO (terminated by id == NULL) catalogues, any of them may be NULL.
+ Index refers to entries in place, catalogues must stay allocated and positions should not be changed afterwards.
+ */
+extern bool indigo_cat_index_build(indigo_star_entry *stars, indigo_dso_entry *dsos);
+
+/** Release index.
+ */
+extern void indigo_cat_index_release(void);
+
+/** Find star by Hipparcos number.
+ */
+extern indigo_star_entry *indigo_cat_star_by_hip(int hip);
+
+/** Find stars brighter than max_mag within radius (degrees) around ra (hours) and dec (degrees).
+ Up to max_count brightest stars are stored in result, number of stored stars is returned.
+ */
+extern int indigo_cat_stars_in_cone(double ra, double dec, double radius, double max_mag, indigo_star_entry **result, int max_count);
+
+/** Find DSOs brighter than max_mag within radius (degrees) around ra (hours) and dec (degrees).
+ Up to max_count brightest objects are stored in result, number of stored objects is returned.
+ */
+extern int indigo_cat_dsos_in_cone(double ra, double dec, double radius, double max_mag, indigo_dso_entry **result, int max_count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* indigo_cat_index_h */
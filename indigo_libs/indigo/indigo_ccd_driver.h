@@ -45,6 +45,10 @@ extern "C" {
  */
 #define CCD_COOLER_GROUP                  "Cooler"
 
+/** CCD Calibration group name string.
+ */
+#define CCD_CALIBRATION_GROUP             "Calibration"
+
 /** Device context pointer.
  */
 #define CCD_CONTEXT                ((indigo_ccd_context *)device->device_context)
@@ -420,6 +424,78 @@ extern "C" {
  */
 #define CCD_RBI_FLUSH_DISABLED_ITEM     (CCD_RBI_FLUSH_ENABLE_PROPERTY->items + 1)
 
+/** CCD_CALIBRATION property pointer.
+ */
+#define CCD_CALIBRATION_PROPERTY        (CCD_CONTEXT->ccd_calibration_property)
+
+/** CCD_CALIBRATION.ENABLED property item pointer.
+ */
+#define CCD_CALIBRATION_ENABLED_ITEM    (CCD_CALIBRATION_PROPERTY->items + 0)
+
+/** CCD_CALIBRATION.DISABLED property item pointer.
+ */
+#define CCD_CALIBRATION_DISABLED_ITEM   (CCD_CALIBRATION_PROPERTY->items + 1)
+
+/** CCD_CALIBRATION_LIBRARY property pointer.
+ */
+#define CCD_CALIBRATION_LIBRARY_PROPERTY (CCD_CONTEXT->ccd_calibration_library_property)
+
+/** CCD_CALIBRATION_LIBRARY.DIR property item pointer.
+ */
+#define CCD_CALIBRATION_LIBRARY_DIR_ITEM (CCD_CALIBRATION_LIBRARY_PROPERTY->items + 0)
+
+/** CCD_CALIBRATION_MASTERS property pointer.
+ */
+#define CCD_CALIBRATION_MASTERS_PROPERTY (CCD_CONTEXT->ccd_calibration_masters_property)
+
+/** CCD_CALIBRATION_MASTERS.BIAS property item pointer.
+ */
+#define CCD_CALIBRATION_MASTERS_BIAS_ITEM (CCD_CALIBRATION_MASTERS_PROPERTY->items + 0)
+
+/** CCD_CALIBRATION_MASTERS.DARK property item pointer.
+ */
+#define CCD_CALIBRATION_MASTERS_DARK_ITEM (CCD_CALIBRATION_MASTERS_PROPERTY->items + 1)
+
+/** CCD_CALIBRATION_MASTERS.FLAT property item pointer.
+ */
+#define CCD_CALIBRATION_MASTERS_FLAT_ITEM (CCD_CALIBRATION_MASTERS_PROPERTY->items + 2)
+
+/** CCD_CALIBRATION_BUILD property pointer.
+ */
+#define CCD_CALIBRATION_BUILD_PROPERTY  (CCD_CONTEXT->ccd_calibration_build_property)
+
+/** CCD_CALIBRATION_BUILD.COUNT property item pointer.
+ */
+#define CCD_CALIBRATION_BUILD_COUNT_ITEM (CCD_CALIBRATION_BUILD_PROPERTY->items + 0)
+
+/** CCD_CALIBRATION_BUILD.SIGMA property item pointer.
+ */
+#define CCD_CALIBRATION_BUILD_SIGMA_ITEM (CCD_CALIBRATION_BUILD_PROPERTY->items + 1)
+
+/** CCD_STREAMING_BUFFER property pointer.
+ */
+#define CCD_STREAMING_BUFFER_PROPERTY   (CCD_CONTEXT->ccd_streaming_buffer_property)
+
+/** CCD_STREAMING_BUFFER.FRAMES property item pointer.
+ */
+#define CCD_STREAMING_BUFFER_FRAMES_ITEM (CCD_STREAMING_BUFFER_PROPERTY->items + 0)
+
+/** CCD_STREAMING_STATS property pointer.
+ */
+#define CCD_STREAMING_STATS_PROPERTY    (CCD_CONTEXT->ccd_streaming_stats_property)
+
+/** CCD_STREAMING_STATS.CAPTURED property item pointer.
+ */
+#define CCD_STREAMING_STATS_CAPTURED_ITEM (CCD_STREAMING_STATS_PROPERTY->items + 0)
+
+/** CCD_STREAMING_STATS.PROCESSED property item pointer.
+ */
+#define CCD_STREAMING_STATS_PROCESSED_ITEM (CCD_STREAMING_STATS_PROPERTY->items + 1)
+
+/** CCD_STREAMING_STATS.DROPPED property item pointer.
+ */
+#define CCD_STREAMING_STATS_DROPPED_ITEM (CCD_STREAMING_STATS_PROPERTY->items + 2)
+
 
 /** CCD device context structure.
  */
@@ -430,6 +506,12 @@ typedef struct {
 	void *preview_image;													///< preview image buffer
 	unsigned long preview_image_size;							///< preview image buffer size
 	void *video_stream;														///< video stream control structure
+	void *calibration;														///< calibration context
+	void *stream_ring;														///< streaming ring buffer
+	double exposure_start;												///< UTC of shutter opening stamped by indigo_ccd_shutter_opened(), 0 if not stamped
+	double exposure_end;													///< UTC of shutter closing stamped by indigo_ccd_shutter_closed(), 0 if not stamped
+	bool exposure_start_precise;									///< exposure_start was taken from clock disciplined by PPS
+	bool exposure_end_precise;										///< exposure_end was taken from clock disciplined by PPS
 	indigo_property *ccd_info_property;           ///< CCD_INFO property pointer
 	indigo_property *ccd_lens_property;						///< CCD_LENS property pointer
 	indigo_property *ccd_upload_mode_property;    ///< CCD_UPLOAD_MODE property pointer
@@ -457,6 +539,12 @@ typedef struct {
 	indigo_property *ccd_jpeg_settings;						///< CCD_JPEG_SETTINGS property pointer
 	indigo_property *ccd_rbi_flush_enable_property; ///< CCD_RBI_FLUSH_ENABLE property pointer
 	indigo_property *ccd_rbi_flush_property;			///< CCD_RBI_FLUSH property pointer
+	indigo_property *ccd_calibration_property;		///< CCD_CALIBRATION property pointer
+	indigo_property *ccd_calibration_library_property; ///< CCD_CALIBRATION_LIBRARY property pointer
+	indigo_property *ccd_calibration_masters_property; ///< CCD_CALIBRATION_MASTERS property pointer
+	indigo_property *ccd_calibration_build_property; ///< CCD_CALIBRATION_BUILD property pointer
+	indigo_property *ccd_streaming_buffer_property; ///< CCD_STREAMING_BUFFER property pointer
+	indigo_property *ccd_streaming_stats_property; ///< CCD_STREAMING_STATS property pointer
 } indigo_ccd_context;
 
 /** Suspend countdown.
@@ -467,6 +555,15 @@ extern void indigo_ccd_suspend_countdown(indigo_device *device);
  */
 extern void indigo_ccd_resume_countdown(indigo_device *device);
 
+/** Stamp time of shutter opening, drivers should call it as close to the actual start of exposure as the camera allows.
+ Frames without stamps get DATE-OBS derived from the time they were handed over and exposure time, with one second resolution.
+ */
+extern void indigo_ccd_shutter_opened(indigo_device *device);
+
+/** Stamp time of shutter closing, stamps are used for the next frame processed or committed to the stream.
+ */
+extern void indigo_ccd_shutter_closed(indigo_device *device);
+
 /** Set shortest exposure in case of a bias frame, otherwise does nothing.
     The intended use is in exposure propery handling.
  */
@@ -518,6 +615,24 @@ extern void indigo_process_dslr_preview_image(indigo_device *device, void *data,
  */
 extern void indigo_finalize_video_stream(indigo_device *device);
 
+/** Start streaming with a ring of CCD_STREAMING_BUFFER.FRAMES preallocated buffers of frame_size bytes (including FITS_HEADER_SIZE) and a thread processing committed frames.
+ */
+extern bool indigo_ccd_stream_start(indigo_device *device, long frame_size);
+
+/** Get buffer to be filled by the driver (raw data starting on FITS_HEADER_SIZE offset).
+ If processing is behind, the oldest frame waiting for processing is dropped and its buffer is reused.
+ NULL is returned (and the frame is counted as dropped) if no buffer is free, driver must skip the frame then.
+ */
+extern void *indigo_ccd_stream_acquire_buffer(indigo_device *device);
+
+/** Queue filled buffer for processing by indigo_process_image(), keywords must stay valid until indigo_ccd_stream_stop() is called.
+ */
+extern void indigo_ccd_stream_commit_buffer(indigo_device *device, void *buffer, int frame_width, int frame_height, int bpp, bool little_endian, bool byte_order_rgb, indigo_fits_keyword *keywords);
+
+/** Wait until queued frames are processed, stop processing thread and release the ring.
+ */
+extern void indigo_ccd_stream_stop(indigo_device *device);
+
 #ifdef __cplusplus
 }
 #endif
@@ -133,6 +133,14 @@ extern "C" {
  */
 #define DOME_SLAVING_THRESHOLD_ITEM							(DOME_SLAVING_PARAMETERS_PROPERTY->items+0)
 
+/** DOME_SLAVING_PARAMETERS.SLIT_MARGIN property item pointer.
+ */
+#define DOME_SLAVING_MARGIN_ITEM							(DOME_SLAVING_PARAMETERS_PROPERTY->items+1)
+
+/** DOME_SLAVING_PARAMETERS.LEAD_TIME property item pointer.
+ */
+#define DOME_SLAVING_LEAD_TIME_ITEM							(DOME_SLAVING_PARAMETERS_PROPERTY->items+2)
+
 
 /** DOME_ABORT_MOTION property pointer, property is optional, property change request should be fully handled by dome driver
  */
@@ -245,6 +253,54 @@ extern "C" {
 */
 #define DOME_SET_HOST_TIME_ITEM											(DOME_SET_HOST_TIME_PROPERTY->items+0)
 
+/** DOME_MOUNT_TRACKING property pointer, property is mandatory, snooped from MOUNT_TRACKING of the mount, property change request is fully handled by indigo_dome_change_property
+ */
+#define DOME_MOUNT_TRACKING_PROPERTY					(DOME_CONTEXT->dome_mount_tracking_property)
+
+/** DOME_MOUNT_TRACKING.ON property item pointer.
+ */
+#define DOME_MOUNT_TRACKING_ON_ITEM					(DOME_MOUNT_TRACKING_PROPERTY->items+0)
+
+/** DOME_MOUNT_TRACKING.OFF property item pointer.
+ */
+#define DOME_MOUNT_TRACKING_OFF_ITEM					(DOME_MOUNT_TRACKING_PROPERTY->items+1)
+
+/** DOME_MOUNT_TRACK_RATE property pointer, property is mandatory, snooped from MOUNT_TRACK_RATE of the mount, property change request is fully handled by indigo_dome_change_property
+ */
+#define DOME_MOUNT_TRACK_RATE_PROPERTY					(DOME_CONTEXT->dome_mount_track_rate_property)
+
+/** DOME_MOUNT_TRACK_RATE.SIDEREAL property item pointer.
+ */
+#define DOME_MOUNT_TRACK_RATE_SIDEREAL_ITEM				(DOME_MOUNT_TRACK_RATE_PROPERTY->items+0)
+
+/** DOME_MOUNT_TRACK_RATE.SOLAR property item pointer.
+ */
+#define DOME_MOUNT_TRACK_RATE_SOLAR_ITEM					(DOME_MOUNT_TRACK_RATE_PROPERTY->items+1)
+
+/** DOME_MOUNT_TRACK_RATE.LUNAR property item pointer.
+ */
+#define DOME_MOUNT_TRACK_RATE_LUNAR_ITEM					(DOME_MOUNT_TRACK_RATE_PROPERTY->items+2)
+
+/** DOME_MOUNT_TRACK_RATE.KING property item pointer.
+ */
+#define DOME_MOUNT_TRACK_RATE_KING_ITEM					(DOME_MOUNT_TRACK_RATE_PROPERTY->items+3)
+
+/** DOME_MOUNT_TRACK_RATE.CUSTOM property item pointer.
+ */
+#define DOME_MOUNT_TRACK_RATE_CUSTOM_ITEM				(DOME_MOUNT_TRACK_RATE_PROPERTY->items+4)
+
+/** DOME_MOUNT_CUSTOM_TRACKING_RATE property pointer, property is mandatory, snooped from MOUNT_CUSTOM_TRACKING_RATE of the mount, property change request is fully handled by indigo_dome_change_property
+ */
+#define DOME_MOUNT_CUSTOM_TRACKING_RATE_PROPERTY		(DOME_CONTEXT->dome_mount_custom_tracking_rate_property)
+
+/** DOME_MOUNT_CUSTOM_TRACKING_RATE.RA property item pointer, RA rate relative to sidereal tracking (arcsec/s).
+ */
+#define DOME_MOUNT_CUSTOM_TRACKING_RATE_RA_ITEM		(DOME_MOUNT_CUSTOM_TRACKING_RATE_PROPERTY->items+0)
+
+/** DOME_MOUNT_CUSTOM_TRACKING_RATE.DEC property item pointer, Dec rate (arcsec/s).
+ */
+#define DOME_MOUNT_CUSTOM_TRACKING_RATE_DEC_ITEM		(DOME_MOUNT_CUSTOM_TRACKING_RATE_PROPERTY->items+1)
+
 /** DOME_SNOOP_DEVICES property pointer, property is optional.
  */
 #define DOME_SNOOP_DEVICES_PROPERTY					(DOME_CONTEXT->dome_snoop_devices_property)
@@ -279,7 +335,16 @@ typedef struct {
 	indigo_property *dome_utc_time_property;               	///< DOME_UTC_TIME property_pointer
 	indigo_property *dome_set_host_time_property;          	///< DOME_UTC_FROM_HOST property_pointer
 	indigo_property *dome_snoop_devices_property;						///< DOME_SNOOP_DEVICES property pointer
-	indigo_timer *sync_timer;
+	indigo_property *dome_mount_tracking_property;					///< DOME_MOUNT_TRACKING property pointer
+	indigo_property *dome_mount_track_rate_property;				///< DOME_MOUNT_TRACK_RATE property pointer
+	indigo_property *dome_mount_custom_tracking_rate_property;	///< DOME_MOUNT_CUSTOM_TRACKING_RATE property pointer
+	pthread_mutex_t slaving_mutex;													///< slaving timer and prediction mutex
+	indigo_timer *sync_timer;																///< slaving timer, fired when telescope is about to leave the slit
+	time_t sync_time;																				///< time when slaving timer fires
+	bool sync_running;																			///< slaving timer callback is running
+	double slaving_ra, slaving_dec, slaving_az;							///< coordinates and dome azimuth the slaving deadline was predicted for
+	time_t slaving_utc;																			///< time the slaving deadline was predicted at
+	time_t slaving_deadline;																///< time when dome has to start moving to keep telescope within the slit
 } indigo_dome_context;
 
 /** Attach callback function.
@@ -294,7 +359,12 @@ extern indigo_result indigo_dome_change_property(indigo_device *device, indigo_c
 /** Detach callback function.
  */
 extern indigo_result indigo_dome_detach(indigo_device *device);
+/** Get dome UTC if available otherwise return host UTC.
+ */
+extern time_t indigo_get_dome_utc(indigo_device *device);
 /** Update dome azimuth according to mount and OTA dimensions.
+ If the telescope leaves the slit (reduced by slit margin) within the lead time, the dome is moved ahead of the target as far as the slit allows and the slaving timer is scheduled for the next predicted slit edge or meridian flip.
+ Target motion is predicted from tracking state and rate reported by the mount (DOME_MOUNT_TRACKING, DOME_MOUNT_TRACK_RATE and DOME_MOUNT_CUSTOM_TRACKING_RATE).
  */
 extern bool indigo_fix_dome_azimuth(indigo_device *device, double ra, double dec, double az_prev, double *az);
 
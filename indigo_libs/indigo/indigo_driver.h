@@ -32,6 +32,7 @@
 #include <indigo/indigo_bus.h>
 #include <indigo/indigo_names.h>
 #include <indigo/indigo_timer.h>
+#include <indigo/indigo_store.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -222,6 +223,7 @@ typedef struct {
 	indigo_property *device_baudrate_property;          ///< DEVICE_BAUDRATE property pointer
 	indigo_property *device_ports_property;		///< DEVICE_PORTS property pointer
 	indigo_property *device_auth_property;		///< SECURITY property pointer
+	void *work_queue;													///< queue of pending handlers
 } indigo_device_context;
 
 /** log macros
@@ -298,14 +300,22 @@ extern indigo_result indigo_device_detach(indigo_device *device);
 
 extern int indigo_open_config_file(char *device_name, int profile, int mode, const char *suffix);
 
-/** Load properties.
+/** Open config record store, path (of given size) is set to its file name.
+ */
+extern indigo_store *indigo_open_config_store(char *device_name, int profile, const char *suffix, bool create, char *path, int size);
+
+/** Load properties from .config.store (.config file of previous versions is imported) or from .default file.
  */
 extern indigo_result indigo_load_properties(indigo_device *device, bool default_properties);
 
-/** Save single property.
+/** Save single property, it is collected in memory until indigo_commit_saved_properties() is called.
  */
 extern indigo_result indigo_save_property(indigo_device*device, int *file_handle, indigo_property *property);
 
+/** Write properties saved since the last commit to .config.store by single write and flush, the store is replaced so that properties not saved this time are dropped.
+ */
+extern indigo_result indigo_commit_saved_properties(indigo_device*device, int *file_handle);
+
 /** Remove properties.
  */
 extern indigo_result indigo_remove_properties(indigo_device *device);
@@ -336,6 +346,14 @@ void indigo_timetoisolocal(time_t tstamp, char *isotime, int isotime_len);
  */
 time_t indigo_isolocaltotime(char *isotime);
 
+/** Set offset of UTC against monotonic clock measured by precise time source (e.g. GPS PPS) and its accuracy in seconds.
+ */
+extern void indigo_set_utc_offset(double offset, double accuracy);
+
+/** Get current UTC, disciplined by time source if it was updated recently. Returns accuracy in seconds or -1 if system clock is used.
+ */
+extern double indigo_get_utc(struct timespec *utc);
+
 /** Enumerate serial ports.
  */
 void indigo_enumerate_serial_ports(indigo_device *device, indigo_property *property);
@@ -344,6 +362,18 @@ void indigo_enumerate_serial_ports(indigo_device *device, indigo_property *prope
  */
 extern bool indigo_ignore_connection_change(indigo_device *device, indigo_property *request);
 
+/** Queue handler to be executed by shared worker thread. Handlers for the same device are executed one by one in the order of submission.
+ */
+extern bool indigo_execute_handler(indigo_device *device, indigo_timer_callback handler);
+
+/** Drop handlers queued for device, handler already running is not interrupted. Safe to call from change_property().
+ */
+extern void indigo_cancel_pending_handlers(indigo_device *device);
+
+/** Drop handlers queued for device and wait for the running one to finish. Must not be called with bus locked, e.g. from change_property().
+ */
+extern void indigo_cancel_pending_handlers_sync(indigo_device *device);
+
 #ifdef __cplusplus
 }
 #endif
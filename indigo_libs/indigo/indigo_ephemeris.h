@@ -0,0 +1,115 @@
+// Copyright (c) 2020 CloudMakers, s. r. o.
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// version history
+// 2.0 by Peter Polakovic <peter.polakovic@cloudmakers.eu>
+
+/** INDIGO solar system ephemeris
+ \file indigo_ephemeris.h
+ */
+
+#ifndef indigo_ephemeris_h
+#define indigo_ephemeris_h
+
+#include <time.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Solar system bodies, numbered as NOVAS make_object() does.
+ */
+typedef enum {
+	INDIGO_EPHEMERIS_MERCURY = 1,
+	INDIGO_EPHEMERIS_VENUS,
+	INDIGO_EPHEMERIS_EARTH,
+	INDIGO_EPHEMERIS_MARS,
+	INDIGO_EPHEMERIS_JUPITER,
+	INDIGO_EPHEMERIS_SATURN,
+	INDIGO_EPHEMERIS_URANUS,
+	INDIGO_EPHEMERIS_NEPTUNE,
+	INDIGO_EPHEMERIS_PLUTO,
+	INDIGO_EPHEMERIS_SUN,
+	INDIGO_EPHEMERIS_MOON
+} indigo_ephemeris_body;
+
+/** Altitude of planet or star centre at rise and set (refraction at horizon).
+ */
+#define INDIGO_EPHEMERIS_RISE_SET_ALTITUDE				-0.5667
+
+/** Altitude of Sun and Moon centre at rise and set (refraction and semidiameter).
+ */
+#define INDIGO_EPHEMERIS_SUN_RISE_SET_ALTITUDE		-0.8333
+
+/** Altitude of Sun at civil twilight boundary.
+ */
+#define INDIGO_EPHEMERIS_CIVIL_TWILIGHT						-6.0
+
+/** Altitude of Sun at nautical twilight boundary.
+ */
+#define INDIGO_EPHEMERIS_NAUTICAL_TWILIGHT				-12.0
+
+/** Altitude of Sun at astronomical twilight boundary.
+ */
+#define INDIGO_EPHEMERIS_ASTRONOMICAL_TWILIGHT		-18.0
+
+/** Heliocentric orbit in perihelion form (elliptic, parabolic or hyperbolic), angles are referred to J2000 ecliptic and equinox.
+ */
+typedef struct {
+	double q;								///< perihelion distance (AU)
+	double e;								///< eccentricity
+	double i;								///< inclination (degrees)
+	double node;						///< longitude of ascending node (degrees)
+	double peri;						///< argument of perihelion (degrees)
+	double tp;							///< time of perihelion passage (TT julian date)
+	double p[3], r[3];			///< unit vectors towards perihelion and 90 degrees ahead in ICRS (computed by indigo_ephemeris_init_orbit)
+} indigo_ephemeris_orbit;
+
+/** Map JPL ephemeris file (DE200, DE4xx binary) instead of one embedded into library, NULL path returns to embedded one.
+ File is mapped once and shared by all threads, decoded Chebyshev blocks are cached per thread, body and interval.
+ */
+extern bool indigo_ephemeris_open(const char *path);
+
+/** Barycentric ICRS position (AU) and velocity (AU/day, may be NULL) of body at TT julian date.
+ Without ephemeris data Sun, Earth and Moon are computed by low precision formulae and other bodies fail.
+ */
+extern bool indigo_ephemeris_state(int body, double jd_tt, double *pos, double *vel);
+
+/** Compute orientation vectors of orbit from its elements.
+ */
+extern void indigo_ephemeris_init_orbit(indigo_ephemeris_orbit *orbit);
+
+/** Parse orbit from "q e i node peri tp" (comet form) or "a e i node peri M epoch" (asteroid form with mean anomaly at epoch, elliptic only), dates are TT julian dates.
+ */
+extern bool indigo_ephemeris_parse_orbit(const char *text, indigo_ephemeris_orbit *orbit);
+
+/** Barycentric ICRS position (AU) of body on orbit at TT julian date.
+ */
+extern bool indigo_ephemeris_orbit_state(const indigo_ephemeris_orbit *orbit, double jd_tt, double *pos);
+
+/** Next rise, transit and set (UTC, 0 if event does not occur) of body within 24 hours after utc.
+ Rise and set are crossings of given altitude (degrees) by topocentric centre, e.g. INDIGO_EPHEMERIS_SUN_RISE_SET_ALTITUDE or twilight boundary for the Sun. Any of rise, transit or set may be NULL.
+ */
+extern bool indigo_ephemeris_events(time_t utc, double latitude, double longitude, double elevation, int body, double altitude, time_t *rise, time_t *transit, time_t *set);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* indigo_ephemeris_h */
@@ -102,6 +102,60 @@ extern bool indigo_printf(int handle, const char *format, ...);
 
 extern int indigo_scanf(int handle, const char *format, ...);
 
+#if defined(INDIGO_LINUX) || defined(INDIGO_MACOS)
+
+/** Serial transport, descriptor is owned by event thread which writes queued commands and frames responses.
+ */
+typedef struct indigo_serial_transport indigo_serial_transport;
+
+/** Completion callback, called on event thread; response is NULL on timeout or I/O error.
+ */
+typedef void (*indigo_serial_callback)(indigo_serial_transport *transport, void *data, const char *response, int length);
+
+/** Scripted loopback entry, response (or NULL) is sent when command is received.
+ */
+typedef struct {
+	const char *command;
+	const char *response;
+} indigo_serial_script;
+
+/** Scripted loopback device.
+ */
+typedef struct indigo_serial_loopback indigo_serial_loopback;
+
+/** Start transport on open handle; up to pipeline commands may wait for response at the same time.
+ */
+extern indigo_serial_transport *indigo_serial_open(int handle, int pipeline);
+
+/** Stop transport, fail pending commands and close handle.
+ */
+extern void indigo_serial_close(indigo_serial_transport *transport);
+
+/** Queue command (command_length -1 for string). Response is terminated by any of terminators (not included in response) or has fixed length if length > 0.
+ If neither is set, no response is expected and callback is called when command is written.
+ If the oldest pending command times out, all commands waiting for response fail and input is dropped until the line is quiet for 100ms.
+ */
+extern bool indigo_serial_submit(indigo_serial_transport *transport, const char *command, long command_length, const char *terminators, int length, double timeout, indigo_serial_callback callback, void *data);
+
+/** Queue command and wait for response, returns response length or -1 on timeout or error.
+ Must not be called from a transport callback or listener (fails with -1).
+ */
+extern int indigo_serial_command(indigo_serial_transport *transport, const char *command, const char *terminators, int length, double timeout, char *response, int max);
+
+/** Set handler for data received while no command waits for response, framed by terminators.
+ */
+extern void indigo_serial_set_listener(indigo_serial_transport *transport, const char *terminators, indigo_serial_callback callback, void *data);
+
+/** Open pseudo terminal answering commands from script (terminated by NULL command), device_name is set to the name to open.
+ */
+extern indigo_serial_loopback *indigo_serial_loopback_open(const indigo_serial_script *script, char *device_name, int size);
+
+/** Close loopback device.
+ */
+extern void indigo_serial_loopback_close(indigo_serial_loopback *loopback);
+
+#endif
+
 #ifdef __cplusplus
 }
 #endif
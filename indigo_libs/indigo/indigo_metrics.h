@@ -0,0 +1,105 @@
+// Copyright (c) 2020 CloudMakers, s. r. o.
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// version history
+// 2.0 by Peter Polakovic <peter.polakovic@cloudmakers.eu>
+
+/** INDIGO runtime metrics
+ \file indigo_metrics.h
+ */
+
+#ifndef indigo_metrics_h
+#define indigo_metrics_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Counters and gauges, values are accumulated per thread and summed when exported.
+ */
+typedef enum {
+	INDIGO_METRIC_BUS_DEFINE,						///< properties defined
+	INDIGO_METRIC_BUS_UPDATE,						///< properties updated
+	INDIGO_METRIC_BUS_DELETE,						///< properties deleted
+	INDIGO_METRIC_BUS_CHANGE,						///< change requests
+	INDIGO_METRIC_BUS_ENUMERATE,				///< enumeration requests
+	INDIGO_METRIC_BUS_MESSAGE,					///< messages sent
+	INDIGO_METRIC_BLOB_BYTES,						///< BLOB bytes published on the bus
+	INDIGO_METRIC_HTTP_BLOB_BYTES,			///< BLOB bytes served over HTTP
+	INDIGO_METRIC_CCD_FRAMES,						///< frames processed by CCD drivers
+	INDIGO_METRIC_SERVER_CONNECTIONS,		///< accepted server connections
+	INDIGO_METRIC_SERVER_CLIENTS,				///< connected clients (gauge)
+	INDIGO_METRIC_TIMER_CALLBACKS,			///< executed timer callbacks
+	INDIGO_METRIC_TIMER_THREADS,				///< timer threads (gauge)
+	INDIGO_METRIC_TIMER_RUNNING,				///< running timer callbacks (gauge)
+	INDIGO_METRIC_COUNTER_COUNT
+} indigo_metric_counter;
+
+/** Histograms of durations in seconds.
+ */
+typedef enum {
+	INDIGO_METRIC_BUS_CLIENT_LOCK_WAIT,	///< wait for client list lock
+	INDIGO_METRIC_BUS_CLIENT_LOCK_HOLD,	///< client list lock hold time
+	INDIGO_METRIC_BUS_DEVICE_LOCK_WAIT,	///< wait for device list lock
+	INDIGO_METRIC_BUS_DEVICE_LOCK_HOLD,	///< device list lock hold time
+	INDIGO_METRIC_TIMER_LATENESS,				///< timer callback start behind schedule
+	INDIGO_METRIC_TIMER_DURATION,				///< timer callback duration
+	INDIGO_METRIC_CCD_CAPTURE_TO_UPLOAD,	///< time from frame capture to upload to clients
+	INDIGO_METRIC_HISTOGRAM_COUNT
+} indigo_metric_histogram;
+
+/** Enable metric collection (default true).
+ */
+extern bool indigo_use_metrics;
+
+/** Monotonic time in seconds for duration measurement, 0 if metrics are disabled.
+ */
+extern double indigo_metric_time(void);
+
+/** Add value to counter or gauge.
+ */
+extern void indigo_metric_add(indigo_metric_counter counter, int64_t value);
+
+/** Record duration in seconds, measured from start returned by indigo_metric_time().
+ */
+extern void indigo_metric_observe_since(indigo_metric_histogram histogram, double start);
+
+/** Record duration in seconds.
+ */
+extern void indigo_metric_observe(indigo_metric_histogram histogram, double seconds);
+
+/** Register client connection to report its send queue length.
+ */
+extern void indigo_metric_register_socket(int socket, const char *protocol);
+
+/** Unregister client connection.
+ */
+extern void indigo_metric_unregister_socket(int socket);
+
+/** Render all metrics in Prometheus text exposition format, returned buffer should be freed by caller.
+ */
+extern char *indigo_metrics_text(long *length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* indigo_metrics_h */
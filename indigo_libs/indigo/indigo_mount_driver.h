@@ -385,6 +385,51 @@ extern "C" {
  */
 #define MOUNT_ALIGNMENT_DELETE_POINTS_PROPERTY				(MOUNT_CONTEXT->mount_alignment_delete_points_property)
 
+//------------------------------------------------
+/** MOUNT_ALIGNMENT_MODEL property pointer, property is mandatory, property is visible in MULTI_POINT alignment mode
+ */
+#define MOUNT_ALIGNMENT_MODEL_PROPERTY								(MOUNT_CONTEXT->mount_alignment_model_property)
+
+/** MOUNT_ALIGNMENT_MODEL.INDEX_HA property item pointer.
+ */
+#define MOUNT_ALIGNMENT_MODEL_INDEX_HA_ITEM						(MOUNT_ALIGNMENT_MODEL_PROPERTY->items+0)
+
+/** MOUNT_ALIGNMENT_MODEL.INDEX_DEC property item pointer.
+ */
+#define MOUNT_ALIGNMENT_MODEL_INDEX_DEC_ITEM					(MOUNT_ALIGNMENT_MODEL_PROPERTY->items+1)
+
+/** MOUNT_ALIGNMENT_MODEL.POLAR_AZIMUTH property item pointer.
+ */
+#define MOUNT_ALIGNMENT_MODEL_POLAR_AZIMUTH_ITEM			(MOUNT_ALIGNMENT_MODEL_PROPERTY->items+2)
+
+/** MOUNT_ALIGNMENT_MODEL.POLAR_ELEVATION property item pointer.
+ */
+#define MOUNT_ALIGNMENT_MODEL_POLAR_ELEVATION_ITEM		(MOUNT_ALIGNMENT_MODEL_PROPERTY->items+3)
+
+/** MOUNT_ALIGNMENT_MODEL.COLLIMATION property item pointer.
+ */
+#define MOUNT_ALIGNMENT_MODEL_COLLIMATION_ITEM				(MOUNT_ALIGNMENT_MODEL_PROPERTY->items+4)
+
+/** MOUNT_ALIGNMENT_MODEL.NON_PERPENDICULARITY property item pointer.
+ */
+#define MOUNT_ALIGNMENT_MODEL_NON_PERPENDICULARITY_ITEM	(MOUNT_ALIGNMENT_MODEL_PROPERTY->items+5)
+
+/** MOUNT_ALIGNMENT_MODEL.TUBE_FLEXURE property item pointer.
+ */
+#define MOUNT_ALIGNMENT_MODEL_TUBE_FLEXURE_ITEM				(MOUNT_ALIGNMENT_MODEL_PROPERTY->items+6)
+
+/** MOUNT_ALIGNMENT_MODEL.RMS property item pointer.
+ */
+#define MOUNT_ALIGNMENT_MODEL_RMS_ITEM								(MOUNT_ALIGNMENT_MODEL_PROPERTY->items+7)
+
+/** MOUNT_ALIGNMENT_MODEL.POINTS property item pointer.
+ */
+#define MOUNT_ALIGNMENT_MODEL_POINTS_ITEM							(MOUNT_ALIGNMENT_MODEL_PROPERTY->items+8)
+
+/** MOUNT_ALIGNMENT_MODEL.REJECTED property item pointer.
+ */
+#define MOUNT_ALIGNMENT_MODEL_REJECTED_ITEM						(MOUNT_ALIGNMENT_MODEL_PROPERTY->items+9)
+
 //------------------------------------------------
 /** MOUNT_EPOCH property pointer, property is optional
  */
@@ -435,9 +480,101 @@ extern "C" {
 #define MOUNT_PEC_TRAINIG_STARTED_ITEM           			(MOUNT_PEC_TRAINING_PROPERTY->items+0)
 #define MOUNT_PEC_TRAINIG_STOPPED_ITEM           			(MOUNT_PEC_TRAINING_PROPERTY->items+1)
 	
+//------------------------------------------------
+/** MOUNT_LIMITS property pointer, property is optional, if visible, base driver stops tracking below horizon and outside of meridian limits.
+ */
+#define MOUNT_LIMITS_PROPERTY													(MOUNT_CONTEXT->mount_limits_property)
+
+/** MOUNT_LIMITS.MIN_ALT property item pointer.
+ */
+#define MOUNT_LIMITS_MIN_ALT_ITEM											(MOUNT_LIMITS_PROPERTY->items+0)
+
+/** MOUNT_LIMITS.HYSTERESIS property item pointer.
+ */
+#define MOUNT_LIMITS_HYSTERESIS_ITEM									(MOUNT_LIMITS_PROPERTY->items+1)
+
+/** MOUNT_LIMITS.MERIDIAN_EAST property item pointer.
+ */
+#define MOUNT_LIMITS_MERIDIAN_EAST_ITEM								(MOUNT_LIMITS_PROPERTY->items+2)
+
+/** MOUNT_LIMITS.MERIDIAN_WEST property item pointer.
+ */
+#define MOUNT_LIMITS_MERIDIAN_WEST_ITEM								(MOUNT_LIMITS_PROPERTY->items+3)
+
+//------------------------------------------------
+/** MOUNT_HORIZON property pointer, property is optional, it is shown together with MOUNT_LIMITS.
+ */
+#define MOUNT_HORIZON_PROPERTY												(MOUNT_CONTEXT->mount_horizon_property)
+
+/** MOUNT_HORIZON.PROFILE property item pointer, list of "azimuth altitude" pairs separated by ';', altitude limit is linearly interpolated between them.
+ */
+#define MOUNT_HORIZON_PROFILE_ITEM										(MOUNT_HORIZON_PROPERTY->items+0)
+
+//------------------------------------------------
+/** MOUNT_CUSTOM_TRACKING_RATE property pointer, property is optional, driver shows it if mount can track at custom rate selected by MOUNT_TRACK_RATE.CUSTOM.
+ */
+#define MOUNT_CUSTOM_TRACKING_RATE_PROPERTY						(MOUNT_CONTEXT->mount_custom_tracking_rate_property)
+
+/** MOUNT_CUSTOM_TRACKING_RATE.RA property item pointer, RA rate relative to sidereal tracking (arcsec/s).
+ */
+#define MOUNT_CUSTOM_TRACKING_RATE_RA_ITEM						(MOUNT_CUSTOM_TRACKING_RATE_PROPERTY->items+0)
+
+/** MOUNT_CUSTOM_TRACKING_RATE.DEC property item pointer, Dec rate (arcsec/s).
+ */
+#define MOUNT_CUSTOM_TRACKING_RATE_DEC_ITEM						(MOUNT_CUSTOM_TRACKING_RATE_PROPERTY->items+1)
+
+//------------------------------------------------
+/** MOUNT_TRACKING_EPHEMERIS property pointer, property is optional, if visible, base driver tracks solar system body given by orbital elements, satellite given by TLE or target given by table of positions while MOUNT_TRACKING is on.
+ Rates are applied by MOUNT_CUSTOM_TRACKING_RATE if it is visible, otherwise by MOUNT_MOTION pulses at guide rate.
+ */
+#define MOUNT_TRACKING_EPHEMERIS_PROPERTY							(MOUNT_CONTEXT->mount_tracking_ephemeris_property)
+
+/** MOUNT_TRACKING_EPHEMERIS.ELEMENTS property item pointer, "q e i node peri tp" or "a e i node peri M epoch", see indigo_ephemeris_parse_orbit().
+ */
+#define MOUNT_TRACKING_EPHEMERIS_ELEMENTS_ITEM				(MOUNT_TRACKING_EPHEMERIS_PROPERTY->items+0)
+
+/** MOUNT_TRACKING_EPHEMERIS.TABLE property item pointer, name of file with "UTC RA Dec" lines (ISO time, hours and degrees in mount epoch).
+ */
+#define MOUNT_TRACKING_EPHEMERIS_TABLE_ITEM						(MOUNT_TRACKING_EPHEMERIS_PROPERTY->items+1)
+
+/** MOUNT_TRACKING_EPHEMERIS.TLE property item pointer, satellite two-line element set (optionally preceded by name line), see indigo_tle_parse().
+ */
+#define MOUNT_TRACKING_EPHEMERIS_TLE_ITEM							(MOUNT_TRACKING_EPHEMERIS_PROPERTY->items+2)
+
+//------------------------------------------------
+/** MOUNT_EPHEMERIS_TARGET property pointer, property is optional, it is shown together with MOUNT_TRACKING_EPHEMERIS.
+ */
+#define MOUNT_EPHEMERIS_TARGET_PROPERTY								(MOUNT_CONTEXT->mount_ephemeris_target_property)
+
+/** MOUNT_EPHEMERIS_TARGET.RA property item pointer.
+ */
+#define MOUNT_EPHEMERIS_TARGET_RA_ITEM								(MOUNT_EPHEMERIS_TARGET_PROPERTY->items+0)
+
+/** MOUNT_EPHEMERIS_TARGET.DEC property item pointer.
+ */
+#define MOUNT_EPHEMERIS_TARGET_DEC_ITEM								(MOUNT_EPHEMERIS_TARGET_PROPERTY->items+1)
+
+/** MOUNT_EPHEMERIS_TARGET.RA_RATE property item pointer, RA rate relative to sidereal tracking (arcsec/s).
+ */
+#define MOUNT_EPHEMERIS_TARGET_RA_RATE_ITEM						(MOUNT_EPHEMERIS_TARGET_PROPERTY->items+2)
+
+/** MOUNT_EPHEMERIS_TARGET.DEC_RATE property item pointer (arcsec/s).
+ */
+#define MOUNT_EPHEMERIS_TARGET_DEC_RATE_ITEM					(MOUNT_EPHEMERIS_TARGET_PROPERTY->items+3)
+
+/** MOUNT_EPHEMERIS_TARGET.RESIDUAL property item pointer, distance of mount from target (arcsec).
+ */
+#define MOUNT_EPHEMERIS_TARGET_RESIDUAL_ITEM					(MOUNT_EPHEMERIS_TARGET_PROPERTY->items+4)
 
 //------------------------------------------------
-/** Max number of alignment points.
+/** Size of precomputed horizon limit table (per 0.5°).
+ */
+
+#define MOUNT_HORIZON_TABLE_SIZE											720
+
+
+//------------------------------------------------
+/** Initial capacity of alignment point storage, it grows as points are added.
  */
 
 #define MOUNT_MAX_ALIGNMENT_POINTS										100
@@ -460,13 +597,31 @@ typedef struct {
 	int side_of_pier;					//  East or West DEC slew?
 } indigo_alignment_point;
 
+/** Pointing model terms.
+ */
+
+#define MOUNT_POINTING_MODEL_TERMS										7
+
+/** Pointing model fitted to alignment points, terms are in degrees in order IH, ID, MA, ME, CH, NP, TF.
+ */
+
+typedef struct {
+	bool valid;
+	double terms[MOUNT_POINTING_MODEL_TERMS];	//  Index HA & DEC, polar axis azimuth & elevation, collimation, non-perpendicularity, tube flexure
+	double rms;																//  RMS of residuals in degrees
+	int points, rejected;											//  Used and rejected alignment points
+} indigo_pointing_model;
+
 //------------------------------------------------
 /** Mount device context structure.
  */
 typedef struct {
 	indigo_device_context device_context;										///< device context base
 	int alignment_point_count;															///< number of defined alignment points
-	indigo_alignment_point alignment_points[MOUNT_MAX_ALIGNMENT_POINTS]; ///< alignment points
+	indigo_alignment_point *alignment_points;								///< alignment points
+	int alignment_point_capacity;														///< allocated size of alignment_points
+	void *alignment_index;																	///< spatial index of used alignment points for nearest point lookup
+	indigo_pointing_model pointing_model;										///< pointing model used in MULTI_POINT alignment mode
 	indigo_property *mount_geographic_coordinates_property;	///< MOUNT_GEOGRAPHIC_COORDINATES property pointer
 	indigo_property *mount_info_property;                   ///< MOUNT_INFO property pointer
 	indigo_property *mount_lst_time_property;								///< MOUNT_LST_TIME property pointer
@@ -492,11 +647,22 @@ typedef struct {
 	indigo_property *mount_raw_coordinates_property;				///< MOUNT_RAW_COORDINATES property pointer
 	indigo_property *mount_alignment_select_points_property;///< MOUNT_ALIGNMENT_SELECT_POINTS property pointer
 	indigo_property *mount_alignment_delete_points_property;///< MOUNT_ALIGNMENT_DELETE_POINTS property pointer
+	indigo_property *mount_alignment_model_property;				///< MOUNT_ALIGNMENT_MODEL property pointer
 	indigo_property *mount_epoch_property;									///< MOUNT_EPOCH property pointer
 	indigo_property *mount_side_of_pier_property;						///< MOUNT_SIDE_OF_PIER property pointer
 	indigo_property *mount_snoop_devices_property;					///< MOUNT_SNOOP_DEVICES property pointer
 	indigo_property *mount_pec_property;										///< MOUNT_PEC property pointer
 	indigo_property *mount_pec_training_property;						///< MOUNT_PEC_TRAINING property pointer
+	indigo_property *mount_limits_property;									///< MOUNT_LIMITS property pointer
+	indigo_property *mount_horizon_property;								///< MOUNT_HORIZON property pointer
+	indigo_property *mount_custom_tracking_rate_property;		///< MOUNT_CUSTOM_TRACKING_RATE property pointer
+	indigo_property *mount_tracking_ephemeris_property;			///< MOUNT_TRACKING_EPHEMERIS property pointer
+	indigo_property *mount_ephemeris_target_property;				///< MOUNT_EPHEMERIS_TARGET property pointer
+	void *ephemeris_tracking;																///< state of non-sidereal tracking by MOUNT_TRACKING_EPHEMERIS
+	float horizon_table[MOUNT_HORIZON_TABLE_SIZE];					///< altitude limit precomputed from MOUNT_HORIZON and MOUNT_LIMITS
+	bool limits_violated;																		///< mount is outside of limits, cleared when it is back within limits by hysteresis
+	bool limits_tracking_stopped;														///< tracking stop was requested for current limits violation
+	indigo_result (*driver_change_property)(indigo_device *device, indigo_client *client, indigo_property *property); ///< driver change_property callback, GOTO outside of limits is refused before it is called
 } indigo_mount_context;
 
 /** Attach callback function.
@@ -533,6 +699,17 @@ time_t indigo_get_mount_utc(indigo_device *device);
 
 extern void indigo_update_coordinates(indigo_device *device, const char *message);
 
+/** Altitude limit for given azimuth.
+ */
+
+extern double indigo_mount_horizon_limit(indigo_device *device, double az);
+
+/** Check if target is above horizon limit and within meridian limits (always true if MOUNT_LIMITS is hidden).
+ GOTO requests are checked by mount base before they reach driver, MOUNT_LIMITS should be made visible only by drivers which call indigo_update_coordinates().
+ */
+
+extern bool indigo_mount_within_limits(indigo_device *device, double ra, double dec);
+
 /** Load alignment points.
  */
 
@@ -548,6 +725,22 @@ extern void indigo_mount_save_alignment_points(indigo_device *device);
 
 extern void indigo_mount_update_alignment_points(indigo_device *device);
 
+/** Copy alignment point, points are guarded by the same mutex as nearest point lookup.
+ */
+
+extern bool indigo_mount_get_alignment_point(indigo_device *device, int index, indigo_alignment_point *point);
+
+/** Replace coordinates of existing alignment point (selection is kept).
+ Call indigo_mount_update_alignment_points() afterwards to save points and refit the model.
+ */
+
+extern bool indigo_mount_set_alignment_point(indigo_device *device, int index, const indigo_alignment_point *point);
+
+/** Fit pointing model to selected alignment points.
+ */
+
+extern void indigo_mount_fit_pointing_model(indigo_device *device);
+
 #ifdef __cplusplus
 }
 #endif
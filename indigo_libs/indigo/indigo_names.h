@@ -611,6 +611,84 @@
  */
 #define CCD_RBI_FLUSH_DISABLED_ITEM_NAME     "DISABLED"
 
+//----------------------------------------------------------------------
+/** CCD_CALIBRATION property name.
+ */
+#define CCD_CALIBRATION_PROPERTY_NAME					"CCD_CALIBRATION"
+
+/** CCD_CALIBRATION.ENABLED property item name.
+ */
+#define CCD_CALIBRATION_ENABLED_ITEM_NAME			"ENABLED"
+
+/** CCD_CALIBRATION.DISABLED property item name.
+ */
+#define CCD_CALIBRATION_DISABLED_ITEM_NAME		"DISABLED"
+
+//----------------------------------------------------------------------
+/** CCD_CALIBRATION_LIBRARY property name.
+ */
+#define CCD_CALIBRATION_LIBRARY_PROPERTY_NAME	"CCD_CALIBRATION_LIBRARY"
+
+/** CCD_CALIBRATION_LIBRARY.DIR property item name.
+ */
+#define CCD_CALIBRATION_LIBRARY_DIR_ITEM_NAME	"DIR"
+
+//----------------------------------------------------------------------
+/** CCD_CALIBRATION_MASTERS property name.
+ */
+#define CCD_CALIBRATION_MASTERS_PROPERTY_NAME	"CCD_CALIBRATION_MASTERS"
+
+/** CCD_CALIBRATION_MASTERS.BIAS property item name.
+ */
+#define CCD_CALIBRATION_MASTERS_BIAS_ITEM_NAME	"BIAS"
+
+/** CCD_CALIBRATION_MASTERS.DARK property item name.
+ */
+#define CCD_CALIBRATION_MASTERS_DARK_ITEM_NAME	"DARK"
+
+/** CCD_CALIBRATION_MASTERS.FLAT property item name.
+ */
+#define CCD_CALIBRATION_MASTERS_FLAT_ITEM_NAME	"FLAT"
+
+//----------------------------------------------------------------------
+/** CCD_CALIBRATION_BUILD property name.
+ */
+#define CCD_CALIBRATION_BUILD_PROPERTY_NAME		"CCD_CALIBRATION_BUILD"
+
+/** CCD_CALIBRATION_BUILD.COUNT property item name.
+ */
+#define CCD_CALIBRATION_BUILD_COUNT_ITEM_NAME	"COUNT"
+
+/** CCD_CALIBRATION_BUILD.SIGMA property item name.
+ */
+#define CCD_CALIBRATION_BUILD_SIGMA_ITEM_NAME	"SIGMA"
+
+//----------------------------------------------------------------------
+/** CCD_STREAMING_BUFFER property name.
+ */
+#define CCD_STREAMING_BUFFER_PROPERTY_NAME		"CCD_STREAMING_BUFFER"
+
+/** CCD_STREAMING_BUFFER.FRAMES property item name.
+ */
+#define CCD_STREAMING_BUFFER_FRAMES_ITEM_NAME	"FRAMES"
+
+//----------------------------------------------------------------------
+/** CCD_STREAMING_STATS property name.
+ */
+#define CCD_STREAMING_STATS_PROPERTY_NAME			"CCD_STREAMING_STATS"
+
+/** CCD_STREAMING_STATS.CAPTURED property item name.
+ */
+#define CCD_STREAMING_STATS_CAPTURED_ITEM_NAME	"CAPTURED"
+
+/** CCD_STREAMING_STATS.PROCESSED property item name.
+ */
+#define CCD_STREAMING_STATS_PROCESSED_ITEM_NAME	"PROCESSED"
+
+/** CCD_STREAMING_STATS.DROPPED property item name.
+ */
+#define CCD_STREAMING_STATS_DROPPED_ITEM_NAME	"DROPPED"
+
 //----------------------------------------------------------------------
 /** DSLR_PROGRAM property name.
  */
@@ -1658,6 +1736,51 @@
  */
 #define MOUNT_ALIGNMENT_DELETE_POINTS_PROPERTY_NAME	"MOUNT_ALIGNMENT_DELETE_POINTS"
 
+//----------------------------------------------------------------------
+/** MOUNT_ALIGNMENT_MODEL property name.
+ */
+#define MOUNT_ALIGNMENT_MODEL_PROPERTY_NAME			"MOUNT_ALIGNMENT_MODEL"
+
+/** MOUNT_ALIGNMENT_MODEL.INDEX_HA property item name.
+ */
+#define MOUNT_ALIGNMENT_MODEL_INDEX_HA_ITEM_NAME	"INDEX_HA"
+
+/** MOUNT_ALIGNMENT_MODEL.INDEX_DEC property item name.
+ */
+#define MOUNT_ALIGNMENT_MODEL_INDEX_DEC_ITEM_NAME	"INDEX_DEC"
+
+/** MOUNT_ALIGNMENT_MODEL.POLAR_AZIMUTH property item name.
+ */
+#define MOUNT_ALIGNMENT_MODEL_POLAR_AZIMUTH_ITEM_NAME	"POLAR_AZIMUTH"
+
+/** MOUNT_ALIGNMENT_MODEL.POLAR_ELEVATION property item name.
+ */
+#define MOUNT_ALIGNMENT_MODEL_POLAR_ELEVATION_ITEM_NAME	"POLAR_ELEVATION"
+
+/** MOUNT_ALIGNMENT_MODEL.COLLIMATION property item name.
+ */
+#define MOUNT_ALIGNMENT_MODEL_COLLIMATION_ITEM_NAME	"COLLIMATION"
+
+/** MOUNT_ALIGNMENT_MODEL.NON_PERPENDICULARITY property item name.
+ */
+#define MOUNT_ALIGNMENT_MODEL_NON_PERPENDICULARITY_ITEM_NAME	"NON_PERPENDICULARITY"
+
+/** MOUNT_ALIGNMENT_MODEL.TUBE_FLEXURE property item name.
+ */
+#define MOUNT_ALIGNMENT_MODEL_TUBE_FLEXURE_ITEM_NAME	"TUBE_FLEXURE"
+
+/** MOUNT_ALIGNMENT_MODEL.RMS property item name.
+ */
+#define MOUNT_ALIGNMENT_MODEL_RMS_ITEM_NAME	"RMS"
+
+/** MOUNT_ALIGNMENT_MODEL.POINTS property item name.
+ */
+#define MOUNT_ALIGNMENT_MODEL_POINTS_ITEM_NAME	"POINTS"
+
+/** MOUNT_ALIGNMENT_MODEL.REJECTED property item name.
+ */
+#define MOUNT_ALIGNMENT_MODEL_REJECTED_ITEM_NAME	"REJECTED"
+
 //----------------------------------------------------------------------
 /** MOUNT_PEC property name.
  */
@@ -1672,6 +1795,91 @@
 #define MOUNT_PEC_TRAINIG_STARTED_ITEM_NAME      "STARTED"
 #define MOUNT_PEC_TRAINIG_STOPPED_ITEM_NAME      "STOPPED"
 
+//----------------------------------------------------------------------
+/** MOUNT_LIMITS property name.
+ */
+#define MOUNT_LIMITS_PROPERTY_NAME								"MOUNT_LIMITS"
+
+/** MOUNT_LIMITS.MIN_ALT property item name.
+ */
+#define MOUNT_LIMITS_MIN_ALT_ITEM_NAME						"MIN_ALT"
+
+/** MOUNT_LIMITS.HYSTERESIS property item name.
+ */
+#define MOUNT_LIMITS_HYSTERESIS_ITEM_NAME					"HYSTERESIS"
+
+/** MOUNT_LIMITS.MERIDIAN_EAST property item name.
+ */
+#define MOUNT_LIMITS_MERIDIAN_EAST_ITEM_NAME			"MERIDIAN_EAST"
+
+/** MOUNT_LIMITS.MERIDIAN_WEST property item name.
+ */
+#define MOUNT_LIMITS_MERIDIAN_WEST_ITEM_NAME			"MERIDIAN_WEST"
+
+//----------------------------------------------------------------------
+/** MOUNT_HORIZON property name.
+ */
+#define MOUNT_HORIZON_PROPERTY_NAME								"MOUNT_HORIZON"
+
+/** MOUNT_HORIZON.PROFILE property item name.
+ */
+#define MOUNT_HORIZON_PROFILE_ITEM_NAME						"PROFILE"
+
+//----------------------------------------------------------------------
+/** MOUNT_CUSTOM_TRACKING_RATE property name.
+ */
+#define MOUNT_CUSTOM_TRACKING_RATE_PROPERTY_NAME	"MOUNT_CUSTOM_TRACKING_RATE"
+
+/** MOUNT_CUSTOM_TRACKING_RATE.RA property item name.
+ */
+#define MOUNT_CUSTOM_TRACKING_RATE_RA_ITEM_NAME		"RA"
+
+/** MOUNT_CUSTOM_TRACKING_RATE.DEC property item name.
+ */
+#define MOUNT_CUSTOM_TRACKING_RATE_DEC_ITEM_NAME	"DEC"
+
+//----------------------------------------------------------------------
+/** MOUNT_TRACKING_EPHEMERIS property name.
+ */
+#define MOUNT_TRACKING_EPHEMERIS_PROPERTY_NAME		"MOUNT_TRACKING_EPHEMERIS"
+
+/** MOUNT_TRACKING_EPHEMERIS.ELEMENTS property item name.
+ */
+#define MOUNT_TRACKING_EPHEMERIS_ELEMENTS_ITEM_NAME	"ELEMENTS"
+
+/** MOUNT_TRACKING_EPHEMERIS.TABLE property item name.
+ */
+#define MOUNT_TRACKING_EPHEMERIS_TABLE_ITEM_NAME	"TABLE"
+
+/** MOUNT_TRACKING_EPHEMERIS.TLE property item name.
+ */
+#define MOUNT_TRACKING_EPHEMERIS_TLE_ITEM_NAME		"TLE"
+
+//----------------------------------------------------------------------
+/** MOUNT_EPHEMERIS_TARGET property name.
+ */
+#define MOUNT_EPHEMERIS_TARGET_PROPERTY_NAME			"MOUNT_EPHEMERIS_TARGET"
+
+/** MOUNT_EPHEMERIS_TARGET.RA property item name.
+ */
+#define MOUNT_EPHEMERIS_TARGET_RA_ITEM_NAME				"RA"
+
+/** MOUNT_EPHEMERIS_TARGET.DEC property item name.
+ */
+#define MOUNT_EPHEMERIS_TARGET_DEC_ITEM_NAME			"DEC"
+
+/** MOUNT_EPHEMERIS_TARGET.RA_RATE property item name.
+ */
+#define MOUNT_EPHEMERIS_TARGET_RA_RATE_ITEM_NAME	"RA_RATE"
+
+/** MOUNT_EPHEMERIS_TARGET.DEC_RATE property item name.
+ */
+#define MOUNT_EPHEMERIS_TARGET_DEC_RATE_ITEM_NAME	"DEC_RATE"
+
+/** MOUNT_EPHEMERIS_TARGET.RESIDUAL property item name.
+ */
+#define MOUNT_EPHEMERIS_TARGET_RESIDUAL_ITEM_NAME	"RESIDUAL"
+
 
 //----------------------------------------------------------------------
 /** GPS_STATUS property name.
@@ -1834,6 +2042,65 @@
  */
 #define DOME_SLAVING_THRESHOLD_ITEM_NAME						"MOVE_THRESHOLD"
 
+/** DOME_SLAVING_PARAMETERS.SLIT_MARGIN property item name.
+ */
+#define DOME_SLAVING_MARGIN_ITEM_NAME						"SLIT_MARGIN"
+
+/** DOME_SLAVING_PARAMETERS.LEAD_TIME property item name.
+ */
+#define DOME_SLAVING_LEAD_TIME_ITEM_NAME						"LEAD_TIME"
+
+//----------------------------------------------------------------------
+/** DOME_MOUNT_TRACKING property name.
+ */
+#define DOME_MOUNT_TRACKING_PROPERTY_NAME					"DOME_MOUNT_TRACKING"
+
+/** DOME_MOUNT_TRACKING.ON property item name.
+ */
+#define DOME_MOUNT_TRACKING_ON_ITEM_NAME						"ON"
+
+/** DOME_MOUNT_TRACKING.OFF property item name.
+ */
+#define DOME_MOUNT_TRACKING_OFF_ITEM_NAME					"OFF"
+
+//----------------------------------------------------------------------
+/** DOME_MOUNT_TRACK_RATE property name.
+ */
+#define DOME_MOUNT_TRACK_RATE_PROPERTY_NAME				"DOME_MOUNT_TRACK_RATE"
+
+/** DOME_MOUNT_TRACK_RATE.SIDEREAL property item name.
+ */
+#define DOME_MOUNT_TRACK_RATE_SIDEREAL_ITEM_NAME		"SIDEREAL"
+
+/** DOME_MOUNT_TRACK_RATE.SOLAR property item name.
+ */
+#define DOME_MOUNT_TRACK_RATE_SOLAR_ITEM_NAME				"SOLAR"
+
+/** DOME_MOUNT_TRACK_RATE.LUNAR property item name.
+ */
+#define DOME_MOUNT_TRACK_RATE_LUNAR_ITEM_NAME				"LUNAR"
+
+/** DOME_MOUNT_TRACK_RATE.KING property item name.
+ */
+#define DOME_MOUNT_TRACK_RATE_KING_ITEM_NAME				"KING"
+
+/** DOME_MOUNT_TRACK_RATE.CUSTOM property item name.
+ */
+#define DOME_MOUNT_TRACK_RATE_CUSTOM_ITEM_NAME			"CUSTOM"
+
+//----------------------------------------------------------------------
+/** DOME_MOUNT_CUSTOM_TRACKING_RATE property name.
+ */
+#define DOME_MOUNT_CUSTOM_TRACKING_RATE_PROPERTY_NAME	"DOME_MOUNT_CUSTOM_TRACKING_RATE"
+
+/** DOME_MOUNT_CUSTOM_TRACKING_RATE.RA property item name.
+ */
+#define DOME_MOUNT_CUSTOM_TRACKING_RATE_RA_ITEM_NAME	"RA"
+
+/** DOME_MOUNT_CUSTOM_TRACKING_RATE.DEC property item name.
+ */
+#define DOME_MOUNT_CUSTOM_TRACKING_RATE_DEC_ITEM_NAME	"DEC"
+
 //----------------------------------------------------------------------
 /** DOME_ABORT_MOTION property name.
  */
@@ -2254,6 +2521,8 @@
 #define AGENT_GUIDER_START_CALIBRATION_ITEM_NAME 			"CALIBRATION"
 #define AGENT_GUIDER_START_CALIBRATION_AND_GUIDING_ITEM_NAME 	"CALIBRATION_AND_GUIDING"
 #define AGENT_GUIDER_START_GUIDING_ITEM_NAME 					"GUIDING"
+#define AGENT_SCHEDULER_START_SCHEDULE_ITEM_NAME			"SCHEDULE"
+#define AGENT_MOUNT_START_CENTERING_ITEM_NAME				"CENTERING"
 
 #define AGENT_PAUSE_PROCESS_PROPERTY_NAME							"AGENT_PAUSE_PROCESS"
 #define AGENT_PAUSE_PROCESS_ITEM_NAME      						"PAUSE"
@@ -2399,6 +2668,82 @@
 #define AGENT_HA_TRACKING_LIMIT_ITEM_NAME							"HA_TRACKING"
 #define AGENT_LOCAL_TIME_LIMIT_ITEM_NAME							"LOCAL_TIME"
 
+#define AGENT_PLATESOLVER_SOLVE_PROPERTY_NAME				"AGENT_PLATESOLVER_SOLVE"
+#define AGENT_PLATESOLVER_SOLVE_DISABLED_ITEM_NAME		"DISABLED"
+#define AGENT_PLATESOLVER_SOLVE_SOLVE_ITEM_NAME			"SOLVE"
+#define AGENT_PLATESOLVER_SOLVE_SYNC_ITEM_NAME				"SYNC"
+
+#define AGENT_PLATESOLVER_HINTS_PROPERTY_NAME				"AGENT_PLATESOLVER_HINTS"
+#define AGENT_PLATESOLVER_HINTS_RADIUS_ITEM_NAME			"RADIUS"
+#define AGENT_PLATESOLVER_HINTS_SCALE_ITEM_NAME			"SCALE"
+
+#define AGENT_PLATESOLVER_WCS_PROPERTY_NAME					"AGENT_PLATESOLVER_WCS"
+#define AGENT_PLATESOLVER_WCS_RA_ITEM_NAME					"RA"
+#define AGENT_PLATESOLVER_WCS_DEC_ITEM_NAME					"DEC"
+#define AGENT_PLATESOLVER_WCS_ANGLE_ITEM_NAME				"ANGLE"
+#define AGENT_PLATESOLVER_WCS_SCALE_ITEM_NAME				"SCALE"
+#define AGENT_PLATESOLVER_WCS_WIDTH_ITEM_NAME				"WIDTH"
+#define AGENT_PLATESOLVER_WCS_HEIGHT_ITEM_NAME				"HEIGHT"
+#define AGENT_PLATESOLVER_WCS_STARS_ITEM_NAME				"STARS"
+
+#define AGENT_PLATESOLVER_CATALOGUE_PROPERTY_NAME			"AGENT_PLATESOLVER_CATALOGUE"
+#define AGENT_PLATESOLVER_CATALOGUE_FILE_ITEM_NAME		"FILE"
+
+#define AGENT_CENTERING_TARGET_PROPERTY_NAME					"AGENT_CENTERING_TARGET"
+#define AGENT_CENTERING_TARGET_RA_ITEM_NAME					"RA"
+#define AGENT_CENTERING_TARGET_DEC_ITEM_NAME					"DEC"
+
+#define AGENT_CENTERING_SETTINGS_PROPERTY_NAME				"AGENT_CENTERING_SETTINGS"
+#define AGENT_CENTERING_SETTINGS_EXPOSURE_ITEM_NAME		"EXPOSURE"
+#define AGENT_CENTERING_SETTINGS_TOLERANCE_ITEM_NAME	"TOLERANCE"
+#define AGENT_CENTERING_SETTINGS_ITERATIONS_ITEM_NAME	"ITERATIONS"
+
+#define AGENT_CENTERING_STATS_PROPERTY_NAME					"AGENT_CENTERING_STATS"
+#define AGENT_CENTERING_STATS_ITERATION_ITEM_NAME		"ITERATION"
+#define AGENT_CENTERING_STATS_RA_ERROR_ITEM_NAME			"RA_ERROR"
+#define AGENT_CENTERING_STATS_DEC_ERROR_ITEM_NAME		"DEC_ERROR"
+#define AGENT_CENTERING_STATS_DISTANCE_ITEM_NAME			"DISTANCE"
+#define AGENT_CENTERING_STATS_STARS_ITEM_NAME				"STARS"
+
+#define AGENT_SATELLITES_CATALOGUE_PROPERTY_NAME			"AGENT_SATELLITES_CATALOGUE"
+#define AGENT_SATELLITES_CATALOGUE_FILE_ITEM_NAME		"FILE"
+
+#define AGENT_SATELLITES_PREDICTION_PROPERTY_NAME		"AGENT_SATELLITES_PREDICTION"
+#define AGENT_SATELLITES_PREDICTION_WINDOW_ITEM_NAME	"WINDOW"
+#define AGENT_SATELLITES_PREDICTION_MIN_ALTITUDE_ITEM_NAME	"MIN_ALTITUDE"
+
+#define AGENT_SATELLITES_PASSES_PROPERTY_NAME				"AGENT_SATELLITES_PASSES"
+
+#define AGENT_SATELLITES_POSITION_PROPERTY_NAME			"AGENT_SATELLITES_POSITION"
+#define AGENT_SATELLITES_POSITION_RA_ITEM_NAME				"RA"
+#define AGENT_SATELLITES_POSITION_DEC_ITEM_NAME			"DEC"
+#define AGENT_SATELLITES_POSITION_ALT_ITEM_NAME			"ALT"
+#define AGENT_SATELLITES_POSITION_AZ_ITEM_NAME				"AZ"
+#define AGENT_SATELLITES_POSITION_RANGE_ITEM_NAME		"RANGE"
+
+#define AGENT_SCHEDULER_TARGETS_PROPERTY_NAME				"AGENT_SCHEDULER_TARGETS"
+
+#define AGENT_SCHEDULER_WINDOWS_PROPERTY_NAME				"AGENT_SCHEDULER_WINDOWS"
+
+#define AGENT_SCHEDULER_SETTINGS_PROPERTY_NAME				"AGENT_SCHEDULER_SETTINGS"
+#define AGENT_SCHEDULER_SETTINGS_MIN_ALTITUDE_ITEM_NAME	"MIN_ALTITUDE"
+#define AGENT_SCHEDULER_SETTINGS_MOON_DISTANCE_ITEM_NAME	"MOON_DISTANCE"
+#define AGENT_SCHEDULER_SETTINGS_SUN_ALTITUDE_ITEM_NAME	"SUN_ALTITUDE"
+#define AGENT_SCHEDULER_SETTINGS_RETRIES_ITEM_NAME		"RETRIES"
+#define AGENT_SCHEDULER_SETTINGS_SPEED_ITEM_NAME			"SPEED"
+
+#define AGENT_SCHEDULER_CLOCK_PROPERTY_NAME					"AGENT_SCHEDULER_CLOCK"
+#define AGENT_SCHEDULER_CLOCK_REAL_ITEM_NAME					"REAL"
+#define AGENT_SCHEDULER_CLOCK_SIMULATED_ITEM_NAME		"SIMULATED"
+
+#define AGENT_SCHEDULER_SIMULATION_PROPERTY_NAME			"AGENT_SCHEDULER_SIMULATION"
+#define AGENT_SCHEDULER_SIMULATION_START_ITEM_NAME		"START"
+
+#define AGENT_SCHEDULER_STATUS_PROPERTY_NAME					"AGENT_SCHEDULER_STATUS"
+#define AGENT_SCHEDULER_STATUS_CLOCK_ITEM_NAME				"CLOCK"
+#define AGENT_SCHEDULER_STATUS_TARGET_ITEM_NAME			"TARGET"
+#define AGENT_SCHEDULER_STATUS_STEP_ITEM_NAME				"STEP"
+
 #define SERVER_INFO_PROPERTY_NAME											"INFO"
 #define SERVER_INFO_VERSION_ITEM_NAME									"VERSION"
 #define SERVER_INFO_SERVICE_ITEM_NAME									"SERVICE"
@@ -28,14 +28,81 @@
 
 #include <time.h>
 #include <stdio.h>
+#include <stdbool.h>
+
+#include <indigo/indigo_ephemeris.h>
+#include <indigo/indigo_sgp4.h>
 
 #define UT2JD(t) ((t) / 86400.0 + 2440587.5 + DELTA_UTC_UT1)
 #define JD UT2JD(time(NULL))
 #define JD2000       2451545.0
 
+/** Ratio of sidereal to solar time, Earth rotation angle rate used by NOVAS.
+ */
+#define INDIGO_SIDEREAL_RATE	1.00273781191135448
+
 extern double DELTA_T;
 extern double DELTA_UTC_UT1;
 
+/** Default validity of cached time dependent terms in seconds.
+ */
+#define INDIGO_NOVAS_CONTEXT_VALIDITY	60
+
+/** Transform context caching time dependent terms of coordinate transforms.
+ Context is refreshed when used for a time more than validity seconds away from the cached one, within the window sidereal time is extrapolated and remaining terms are considered constant.
+ Context is not thread safe, each thread should use its own one (legacy single position functions below share a mutex protected context).
+ */
+typedef struct {
+	double validity;									///< validity window in seconds
+	bool valid;												///< cached terms are computed
+	time_t utc;												///< time cached terms are computed for
+	double jd_ut1, jd_tt;							///< UT1 and TT julian date
+	double gmst;											///< Greenwich mean sidereal time (hours)
+	double equation_of_equinoxes;			///< GAST - GMST (hours)
+	double matrix[3][3];							///< ICRS to true equator and equinox of date rotation (frame bias, precession, nutation)
+	double earth_position[3];					///< Earth barycentric position (AU)
+	double earth_velocity[3];					///< Earth barycentric velocity (AU/day)
+	double sun_position[3];						///< Sun barycentric position (AU)
+} indigo_novas_context;
+
+/** Initialize context with given validity window (seconds, 0 means default).
+ */
+extern void indigo_novas_context_init(indigo_novas_context *context, double validity);
+
+/** Refresh cached terms if utc (NULL means now) is out of validity window.
+ If terms can't be computed, context is marked invalid and false is returned, functions below then return NAN coordinates (or false) until an update succeeds.
+ */
+extern bool indigo_novas_context_update(indigo_novas_context *context, time_t *utc);
+
+/** Local mean sidereal time (hours) for longitude (degrees).
+ */
+extern double indigo_novas_lst(indigo_novas_context *context, time_t *utc, double longitude);
+
+/** Convert count apparent positions (RA in hours, Dec in degrees) to altitude and azimuth (degrees, azimuth measured from north to east).
+ */
+extern void indigo_novas_eq2hor(indigo_novas_context *context, time_t *utc, double latitude, double longitude, double elevation, int count, const double *ra, const double *dec, double *alt, double *az);
+
+/** Convert count ICRS catalogue positions (RA in hours, Dec in degrees) to apparent geocentric positions in place.
+ Proper motion (mas/year), parallax (mas) and radial velocity (km/s) arrays may be NULL.
+ */
+extern void indigo_novas_app_star(indigo_novas_context *context, time_t *utc, int count, const double *promora, const double *promodec, const double *parallax, const double *rv, double *ra, double *dec);
+
+/** Convert count ICRS catalogue positions to apparent topocentric positions in place, see indigo_novas_app_star().
+ */
+extern void indigo_novas_topo_star(indigo_novas_context *context, time_t *utc, double latitude, double longitude, double elevation, int count, const double *promora, const double *promodec, const double *parallax, const double *rv, double *ra, double *dec);
+
+/** Compute count apparent topocentric positions (RA in hours, Dec in degrees) and distances (AU, may be NULL) of solar system bodies (see indigo_ephemeris_body) corrected for light time.
+ */
+extern bool indigo_novas_topo_planet(indigo_novas_context *context, time_t *utc, double latitude, double longitude, double elevation, int count, const int *id, double *ra, double *dec, double *distance);
+
+/** Compute count topocentric positions and distances of bodies on heliocentric orbits, apparent or astrometric (ICRS) if apparent is false, see indigo_novas_topo_planet().
+ */
+extern bool indigo_novas_topo_orbit(indigo_novas_context *context, time_t *utc, double latitude, double longitude, double elevation, int count, const indigo_ephemeris_orbit *orbit, bool apparent, double *ra, double *dec, double *distance);
+
+/** Compute count topocentric positions (apparent or astrometric if apparent is false) and ranges (km, may be NULL) of satellites at utc (seconds since 1970 with fraction), see indigo_sgp4_observe().
+ */
+extern bool indigo_novas_topo_satellite(indigo_novas_context *context, double utc, double latitude, double longitude, double elevation, int count, const indigo_tle *tle, bool apparent, double *ra, double *dec, double *range);
+
 extern double indigo_lst(time_t *utc, double longitude);
 extern void indigo_eq2hor(time_t *utc, double latitude, double longitude, double elevation, double ra, double dec, double *alt, double *az);
 extern void indigo_app_star(double promora, double promodec, double parallax, double rv, double *ra, double *dec);
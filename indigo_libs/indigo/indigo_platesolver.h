@@ -0,0 +1,100 @@
+// Copyright (c) 2020 CloudMakers, s. r. o.
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// version history
+// 2.0 by Peter Polakovic <peter.polakovic@cloudmakers.eu>
+
+/** INDIGO offline plate solver
+ \file indigo_platesolver.h
+ */
+
+#ifndef indigo_platesolver_h
+#define indigo_platesolver_h
+
+#include <stdbool.h>
+
+#include <indigo/indigo_bus.h>
+#include <indigo/indigo_guider_utils.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Plate solver hints.
+ */
+typedef struct {
+	double ra;						///< expected field centre RA (J2000, hours)
+	double dec;						///< expected field centre Dec (J2000, degrees)
+	double radius;				///< search radius around expected centre (degrees), 0 for blind solve
+	double min_scale;			///< min pixel scale (arcsec/pixel), 0 if unknown
+	double max_scale;			///< max pixel scale (arcsec/pixel), 0 if unknown
+} indigo_platesolver_hint;
+
+/** Plate solver result (FITS WCS, TAN projection).
+ */
+typedef struct {
+	double ra;						///< field centre RA (J2000, hours)
+	double dec;						///< field centre Dec (J2000, degrees)
+	double crpix1;				///< reference pixel X (1-based)
+	double crpix2;				///< reference pixel Y (1-based)
+	double crval1;				///< reference point RA (J2000, degrees)
+	double crval2;				///< reference point Dec (J2000, degrees)
+	double cd1_1;					///< linear transformation matrix (degrees/pixel)
+	double cd1_2;					///< linear transformation matrix (degrees/pixel)
+	double cd2_1;					///< linear transformation matrix (degrees/pixel)
+	double cd2_2;					///< linear transformation matrix (degrees/pixel)
+	double scale;					///< pixel scale (arcsec/pixel)
+	double angle;					///< position angle of image Y axis (degrees, east of north)
+	bool flipped;					///< image is mirrored
+	int matched;					///< number of matched stars
+} indigo_platesolver_wcs;
+
+/** Add star to solver catalogue (J2000, RA in hours, Dec in degrees), invalidates index.
+ The catalogue always starts with the bundled Hipparcos stars (indigo_star_data), they are added on first use.
+ */
+extern void indigo_platesolver_add_star(double ra, double dec, double mag);
+
+/** Load user catalogue from text file with "RA Dec Mag" lines (J2000, hours and degrees), returns number of stars added or -1 on error.
+ */
+extern int indigo_platesolver_load_catalogue(const char *file_name);
+
+/** Return number of stars in solver catalogue.
+ */
+extern int indigo_platesolver_catalogue_size(void);
+
+/** Build quad index over the catalogue (done lazily by first solve if not called).
+ */
+extern bool indigo_platesolver_build_index(void);
+
+/** Solve star list (brightest first, e.g. from indigo_find_stars()), hint may be NULL for blind solve.
+ */
+extern bool indigo_platesolver_solve(const indigo_star_detection *stars, int count, int width, int height, const indigo_platesolver_hint *hint, indigo_platesolver_wcs *wcs);
+
+/** Convert 0-based pixel coordinates to J2000 RA (hours) and Dec (degrees).
+ */
+extern void indigo_platesolver_pixel_to_radec(const indigo_platesolver_wcs *wcs, double x, double y, double *ra, double *dec);
+
+/** Convert J2000 RA (hours) and Dec (degrees) to 0-based pixel coordinates, returns false if point is behind the tangent plane.
+ */
+extern bool indigo_platesolver_radec_to_pixel(const indigo_platesolver_wcs *wcs, double ra, double dec, double *x, double *y);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* indigo_platesolver_h */
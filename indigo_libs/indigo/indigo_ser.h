@@ -23,14 +23,44 @@
 #define indigo_ser_h
 
 #include <stdbool.h>
+#include <stdint.h>
+#include <sys/time.h>
+
+/** Size of write buffers used by background writer (frames larger than this use buffer big enough for one frame).
+ */
+#define INDIGO_SER_CHUNK_SIZE		(16 * 1024 * 1024)
+
+/** Number of write buffers used by background writer.
+ */
+#define INDIGO_SER_CHUNKS				4
 
 typedef struct {
 	int handle;
 	int count;
+	size_t frame_size;
+	uint64_t *timestamps;
+	int timestamps_size;
+	void *writer;
 } indigo_ser;
 
+/** Create SER file for frames of the same format as RAW image in buffer.
+ */
 extern indigo_ser *indigo_ser_open(const char *filename, void *buffer, bool little_endian, bool byte_order_rgb);
+
+/** Add RAW frame with UTC timestamp (NULL means now), frame data are copied and written by background thread.
+ */
+extern bool indigo_ser_add_frame_timed(indigo_ser *ser, void *buffer, size_t len, struct timeval *utc);
+
+/** Add RAW frame timestamped with current time.
+ */
 extern bool indigo_ser_add_frame(indigo_ser *ser, void *buffer, size_t len);
+
+/** Flush pending frames, write timestamp trailer, update frame count and close the file.
+ */
 extern bool indigo_ser_close(indigo_ser *ser);
-	
+
+/** Repair SER file not properly closed (e.g. after crash), frame count is set to the number of complete frames and incomplete frame is truncated.
+ */
+extern bool indigo_ser_recover(const char *filename);
+
 #endif /* indigo_ser_h */
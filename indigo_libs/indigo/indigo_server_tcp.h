@@ -36,6 +36,10 @@ extern "C" {
  */
 typedef void (*indigo_server_tcp_callback)(int);
 
+/** Dynamic document handler, writes complete HTTP response for path and query string and returns false if connection should be closed.
+ */
+typedef bool (*indigo_server_tcp_handler)(int socket, const char *path, const char *params);
+
 /** TCP port to run on.
  */
 extern int indigo_server_tcp_port;
@@ -52,6 +56,10 @@ extern void indigo_server_add_resource(const char *path, unsigned char *data, un
  */
 extern void indigo_server_add_file_resource(const char *path, const char *file_name, const char *content_type);
 	
+/** Add dynamic document.
+ */
+extern void indigo_server_add_handler(const char *path, indigo_server_tcp_handler handler);
+
 /** Remove document.
  */
 extern void indigo_server_remove_resource(const char *path);
@@ -0,0 +1,92 @@
+// Copyright (c) 2020 CloudMakers, s. r. o.
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// version history
+// 2.0 by Peter Polakovic <peter.polakovic@cloudmakers.eu>
+
+/** INDIGO SGP4/SDP4 satellite propagator
+ \file indigo_sgp4.h
+ */
+
+#ifndef indigo_sgp4_h
+#define indigo_sgp4_h
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximal length of satellite name.
+ */
+#define INDIGO_SGP4_NAME_SIZE		32
+
+/** Two-line element set with initialized SGP4 (near earth) or SDP4 (deep space, period >= 225 minutes) state.
+ Propagation doesn't modify it, so it can be shared by threads.
+ */
+typedef struct {
+	char name[INDIGO_SGP4_NAME_SIZE];	///< satellite name (line 0) or catalog number
+	int number;												///< catalog number
+	double epoch;											///< epoch (UTC seconds since 1970)
+	double jd_epoch;									///< epoch (UTC julian date)
+	double bstar, ndot, nddot;				///< drag term (1/earth radii), mean motion derivatives (rad/min^2, rad/min^3)
+	double ecco, inclo, nodeo, argpo, mo, no_kozai;	///< mean elements (rad, rad/min)
+	// initialized state (see Vallado et al., Revisiting Spacetrack Report #3, AIAA 2006-6753)
+	bool deep_space, simple;
+	int irez;
+	double no_unkozai, gsto;
+	double aycof, con41, cc1, cc4, cc5, d2, d3, d4, delmo, eta, argpdot, omgcof, sinmao, t2cof, t3cof, t4cof, t5cof, x1mth2, x7thm1, mdot, nodedot, xlcof, xmcof, nodecf;
+	double d2201, d2211, d3210, d3222, d4410, d4422, d5220, d5232, d5421, d5433, dedt, del1, del2, del3, didt, dmdt, dnodt, domdt;
+	double e3, ee2, peo, pgho, pho, pinco, plo, se2, se3, sgh2, sgh3, sgh4, sh2, sh3, si2, si3, sl2, sl3, sl4, xfact, xgh2, xgh3, xgh4, xh2, xh3, xi2, xi3, xl2, xl3, xl4, xlamo, zmol, zmos;
+} indigo_tle;
+
+/** Satellite pass over observer.
+ */
+typedef struct {
+	int satellite;										///< index of satellite in TLE array
+	double rise;											///< time when satellite rises above minimal altitude (UTC seconds since 1970, start of window if it is already up)
+	double culmination;								///< time of maximal altitude
+	double set;												///< time when satellite sets below minimal altitude (end of window if it is still up)
+	double max_altitude;							///< maximal altitude (degrees)
+	double rise_azimuth, set_azimuth;	///< azimuth at rise and set (degrees)
+} indigo_sgp4_pass;
+
+/** Parse element set from two lines or three lines (name, line 1, line 2) and initialize propagator state.
+ */
+extern bool indigo_tle_parse(const char *text, indigo_tle *tle);
+
+/** Position (km) and velocity (km/s, may be NULL) in TEME frame at given minutes since epoch, fails for decayed or otherwise invalid orbit.
+ */
+extern bool indigo_sgp4_propagate(const indigo_tle *tle, double minutes, double *pos, double *vel);
+
+/** Compute count topocentric positions of satellites at utc (seconds since 1970 with fraction) for observer (WGS84 geodetic, degrees and metres).
+ RA (hours) and Dec (degrees) are referred to TEME (true equator, mean equinox of date), altitude and azimuth are geometric (degrees), range is in km, any output may be NULL.
+ Result is false if any satellite can't be propagated.
+ */
+extern bool indigo_sgp4_observe(int count, const indigo_tle *tle, double utc, double latitude, double longitude, double elevation, double *ra, double *dec, double *alt, double *az, double *range);
+
+/** Predict passes of count satellites above minimal altitude between start and end (UTC seconds since 1970), all satellites are sampled together.
+ Up to max passes ordered by rise time are stored, number of stored passes is returned.
+ */
+extern int indigo_sgp4_passes(int count, const indigo_tle *tle, double start, double end, double latitude, double longitude, double elevation, double min_altitude, indigo_sgp4_pass *passes, int max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* indigo_sgp4_h */
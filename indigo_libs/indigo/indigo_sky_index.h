@@ -0,0 +1,68 @@
+// Copyright (c) 2020 CloudMakers, s. r. o.
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// version history
+// 2.0 by Peter Polakovic <peter.polakovic@cloudmakers.eu>
+
+/** INDIGO HEALPix sky index shared by catalogue queries and plate solver
+ \file indigo_sky_index.h
+ */
+
+#ifndef indigo_sky_index_h
+#define indigo_sky_index_h
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** HEALPix RING scheme index of points on the sky, entries of each pixel are ordered by magnitude.
+ */
+typedef struct {
+	int nside;								///< HEALPix resolution
+	int count;								///< number of entries
+	int *start;								///< first entry of each pixel, 12 * nside * nside + 1 items
+	int *entries;							///< entry indices ordered by pixel and magnitude
+	double (*vectors)[3];			///< unit vectors of entries
+	float *mags;							///< magnitudes of entries
+	double max_pixrad;				///< max distance of pixel corner from its centre (radians)
+} indigo_sky_index;
+
+/** Convert RA and Dec (radians) to unit vector.
+ */
+extern void indigo_sky_vector(double ra, double dec, double v[3]);
+
+/** Build index over count unit vectors and magnitudes (both are copied).
+ */
+extern bool indigo_sky_index_build(indigo_sky_index *index, int nside, int count, const double (*vectors)[3], const float *mags);
+
+/** Release index.
+ */
+extern void indigo_sky_index_release(indigo_sky_index *index);
+
+/** Find entries not fainter than max_mag within radius (radians) around unit vector centre.
+ Entry indices are stored in *result reallocated as needed (*size is its capacity), their number is returned.
+ */
+extern int indigo_sky_index_search(const indigo_sky_index *index, const double center[3], double radius, double max_mag, int **result, int *size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* indigo_sky_index_h */
@@ -0,0 +1,96 @@
+// Copyright (c) 2020 CloudMakers, s. r. o.
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// version history
+// 2.0 by Peter Polakovic <peter.polakovic@cloudmakers.eu>
+
+/** INDIGO record store
+ \file indigo_store.h
+ */
+
+#ifndef indigo_store_h
+#define indigo_store_h
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Store file format version.
+ */
+#define INDIGO_STORE_VERSION	1
+
+/** Record store, append only file of checksummed key/value records, the last record for a key wins.
+ Records are flushed to disk as they are appended, file is compacted by writing live records to temporary file renamed over the store.
+ */
+typedef struct indigo_store indigo_store;
+
+/** Open store (and create it if create is true), valid records are loaded from memory mapped file and torn tail left by interrupted write is dropped.
+ */
+extern indigo_store *indigo_store_open(const char *path, bool create);
+
+/** Number of live records.
+ */
+extern int indigo_store_count(indigo_store *store);
+
+/** Key of live record, records are ordered by time of last change.
+ */
+extern const char *indigo_store_key(indigo_store *store, int index);
+
+/** Value of live record.
+ */
+extern const void *indigo_store_value(indigo_store *store, int index, int *length);
+
+/** Value of record with given key or NULL.
+ */
+extern const void *indigo_store_get(indigo_store *store, const char *key, int *length);
+
+/** Append record and flush it to disk, key must be shorter than 2 * INDIGO_NAME_SIZE and value at most 64MB long.
+ */
+extern bool indigo_store_put(indigo_store *store, const char *key, const void *value, int length);
+
+/** Append removal record and flush it to disk.
+ */
+extern bool indigo_store_remove(indigo_store *store, const char *key);
+
+/** Write live records to temporary file and atomically rename it over the store.
+ */
+extern bool indigo_store_compact(indigo_store *store);
+
+/** Start writing new content of store at path, returns handle for indigo_store_append() or -1.
+ */
+extern int indigo_store_begin(const char *path);
+
+/** Add record to content started by indigo_store_begin(), records are kept in memory until commit.
+ */
+extern bool indigo_store_append(int handle, const char *key, const void *value, int length);
+
+/** Write records added since indigo_store_begin() by single write, flush them and atomically replace the store, handle is closed.
+ */
+extern bool indigo_store_commit(int handle);
+
+/** Close store and release records.
+ */
+extern void indigo_store_close(indigo_store *store);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* indigo_store_h */
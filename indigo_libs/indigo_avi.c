@@ -46,169 +46,242 @@
 #include <string.h>
 #include <stdbool.h>
 #include <fcntl.h>
+#include <sys/uio.h>
 
 #include <indigo/indigo_bus.h>
 #include <indigo/indigo_io.h>
 #include <indigo/indigo_avi.h>
 
-static bool write_int(int handle, uint32_t n) {
-	unsigned char buffer[4];
+#define AVIF_HASINDEX						0x10
+#define AVIIF_KEYFRAME					0x10
+#define AVI_INDEX_OF_INDEXES		0x00
+#define AVI_INDEX_OF_CHUNKS			0x01
+
+#define SUPER_INDEX_CHUNK_SIZE	(24 + 16 * GWAVI_SUPER_INDEX_SIZE)
+#define DMLH_CHUNK_SIZE					248
+#define HDRL_SIZE								(12 + 8 + 56 + 12 + 8 + 56 + 8 + 40 + 8 + SUPER_INDEX_CHUNK_SIZE + 12 + 8 + DMLH_CHUNK_SIZE)
+
+/* headers and indexes are serialized to memory and written with a single write */
+
+static void put_chars(unsigned char **p, const char *s) {
+	memcpy(*p, s, 4);
+	*p += 4;
+}
+
+static void put_int(unsigned char **p, uint32_t n) {
+	unsigned char *buffer = *p;
 	buffer[0] = n;
 	buffer[1] = n >> 8;
 	buffer[2] = n >> 16;
 	buffer[3] = n >> 24;
-	return indigo_write(handle, (const char *)buffer, 4);
+	*p += 4;
 }
 
-static bool write_short(int handle, uint16_t n) {
-	unsigned char buffer[2];
+static void put_short(unsigned char **p, uint16_t n) {
+	unsigned char *buffer = *p;
 	buffer[0] = n;
 	buffer[1] = n >> 8;
-	return indigo_write(handle, (const char *)buffer, 2);
+	*p += 2;
 }
 
-static bool write_chars(int handle, const char *s) {
-	int count = (int)strlen(s);
-	return indigo_write(handle, s, count);
+static void put_byte(unsigned char **p, uint8_t n) {
+	**p = n;
+	*p += 1;
 }
 
-static bool write_chars_bin(int handle, const char *s, int count) {
-	return indigo_write(handle, s, count);
+static void put_long(unsigned char **p, uint64_t n) {
+	put_int(p, (uint32_t)n);
+	put_int(p, (uint32_t)(n >> 32));
 }
 
-static bool tell(int handle, long *offset) {
-	return (*offset = lseek(handle, 0, SEEK_CUR)) != -1;
+static bool patch_int(int handle, uint64_t offset, uint32_t n) {
+	unsigned char buffer[4], *p = buffer;
+	put_int(&p, n);
+	return pwrite(handle, buffer, 4, offset) == 4;
 }
 
-static bool seek(int handle, long offset) {
-	return lseek(handle, offset, SEEK_SET);
+static bool append(struct gwavi_t *gwavi, const unsigned char *buffer, size_t len) {
+	if (!indigo_write(gwavi->handle, (const char *)buffer, len))
+		return false;
+	gwavi->position += len;
+	return true;
 }
 
-static bool write_avi_header(int handle, struct gwavi_header_t *avi_header) {
-	long marker, t;
-	return
-		write_chars_bin(handle, "avih", 4) &&
-		tell(handle, &marker) &&
-		write_int(handle, 0) &&
-		write_int(handle, avi_header->time_delay) &&
-		write_int(handle, avi_header->data_rate) &&
-		write_int(handle, avi_header->reserved) &&
-		write_int(handle, avi_header->flags) &&
-		write_int(handle, avi_header->number_of_frames) &&
-		write_int(handle, avi_header->initial_frames) &&
-		write_int(handle, avi_header->data_streams) &&
-		write_int(handle, avi_header->buffer_size) &&
-		write_int(handle, avi_header->width) &&
-		write_int(handle, avi_header->height) &&
-		write_int(handle, avi_header->time_scale) &&
-		write_int(handle, avi_header->playback_data_rate) &&
-		write_int(handle, avi_header->starting_time) &&
-		write_int(handle, avi_header->data_length) &&
-		tell(handle, &t) &&
-		seek(handle, marker) &&
-		write_int(handle, (unsigned int)(t - marker - 4)) &&
-		seek(handle, t);
+static void put_avi_header(unsigned char **p, struct gwavi_header_t *avi_header) {
+	put_chars(p, "avih");
+	put_int(p, 56);
+	put_int(p, avi_header->time_delay);
+	put_int(p, avi_header->data_rate);
+	put_int(p, avi_header->reserved);
+	put_int(p, avi_header->flags);
+	put_int(p, avi_header->number_of_frames);
+	put_int(p, avi_header->initial_frames);
+	put_int(p, avi_header->data_streams);
+	put_int(p, avi_header->buffer_size);
+	put_int(p, avi_header->width);
+	put_int(p, avi_header->height);
+	put_int(p, avi_header->time_scale);
+	put_int(p, avi_header->playback_data_rate);
+	put_int(p, avi_header->starting_time);
+	put_int(p, avi_header->data_length);
 }
 
-static bool write_stream_header(int handle, struct gwavi_stream_header_t *stream_header) {
-	long marker, t;
-	return
-		write_chars_bin(handle, "strh", 4) &&
-		tell(handle, &marker) &&
-		write_int(handle, 0) &&
-		write_chars_bin(handle, stream_header->data_type, 4) &&
-		write_chars_bin(handle, stream_header->codec, 4) &&
-		write_int(handle, stream_header->flags) &&
-		write_int(handle, stream_header->priority) &&
-		write_int(handle, stream_header->initial_frames) &&
-		write_int(handle, stream_header->time_scale) &&
-		write_int(handle, stream_header->data_rate) &&
-		write_int(handle, stream_header->start_time) &&
-		write_int(handle, stream_header->data_length) &&
-		write_int(handle, stream_header->buffer_size) &&
-		write_int(handle, stream_header->video_quality) &&
-		write_int(handle, stream_header->sample_size) &&
-		write_int(handle, 0) &&
-		write_int(handle, 0) &&
-		tell(handle, &t) &&
-		seek(handle, marker) &&
-		write_int(handle, (unsigned int)(t - marker - 4)) &&
-		seek(handle, t);
+static void put_stream_header(unsigned char **p, struct gwavi_stream_header_t *stream_header) {
+	put_chars(p, "strh");
+	put_int(p, 56);
+	put_chars(p, stream_header->data_type);
+	put_chars(p, stream_header->codec);
+	put_int(p, stream_header->flags);
+	put_int(p, stream_header->priority);
+	put_int(p, stream_header->initial_frames);
+	put_int(p, stream_header->time_scale);
+	put_int(p, stream_header->data_rate);
+	put_int(p, stream_header->start_time);
+	put_int(p, stream_header->data_length);
+	put_int(p, stream_header->buffer_size);
+	put_int(p, stream_header->video_quality);
+	put_int(p, stream_header->sample_size);
+	put_int(p, 0);
+	put_int(p, 0);
 }
 
-static bool write_stream_format(int handle, struct gwavi_stream_format_t *stream_format) {
-	long marker, t;
-	return
-		write_chars_bin(handle, "strf", 4) &&
-		tell(handle, &marker) &&
-		write_int(handle, 0) &&
-		write_int(handle, stream_format->header_size) &&
-		write_int(handle, stream_format->width) &&
-		write_int(handle, stream_format->height) &&
-		write_short(handle, stream_format->num_planes) &&
-		write_short(handle, stream_format->bits_per_pixel) &&
-		write_int(handle, stream_format->compression_type) &&
-		write_int(handle, stream_format->image_size) &&
-		write_int(handle, stream_format->x_pels_per_meter) &&
-		write_int(handle, stream_format->y_pels_per_meter) &&
-		write_int(handle, stream_format->colors_used) &&
-		write_int(handle, stream_format->colors_important) &&
-		tell(handle, &t) &&
-		seek(handle, marker) &&
-		write_int(handle, (unsigned int)(t - marker - 4)) &&
-		seek(handle, t);
+static void put_stream_format(unsigned char **p, struct gwavi_stream_format_t *stream_format) {
+	put_chars(p, "strf");
+	put_int(p, 40);
+	put_int(p, stream_format->header_size);
+	put_int(p, stream_format->width);
+	put_int(p, stream_format->height);
+	put_short(p, stream_format->num_planes);
+	put_short(p, stream_format->bits_per_pixel);
+	put_int(p, stream_format->compression_type);
+	put_int(p, stream_format->image_size);
+	put_int(p, stream_format->x_pels_per_meter);
+	put_int(p, stream_format->y_pels_per_meter);
+	put_int(p, stream_format->colors_used);
+	put_int(p, stream_format->colors_important);
 }
 
-static bool write_avi_header_chunk(struct gwavi_t *gwavi) {
-	long marker, sub_marker, t;
-	int handle = gwavi->handle;
-	return
-		write_chars_bin(handle, "LIST", 4) &&
-		tell(handle, &marker) &&
-		write_int(handle, 0) &&
-		write_chars_bin(handle, "hdrl", 4) &&
-		write_avi_header(handle, &gwavi->avi_header) &&
-		write_chars_bin(handle, "LIST", 4) &&
-		tell(handle, &sub_marker) &&
-		write_int(handle, 0) &&
-		write_chars_bin(handle, "strl", 4) &&
-		write_stream_header(handle, &gwavi->stream_header) &&
-		write_stream_format(handle, &gwavi->stream_format) &&
-		tell(handle, &t) &&
-		seek(handle, sub_marker) &&
-		write_int(handle, (unsigned int)(t - sub_marker - 4)) &&
-		seek(handle, t) &&
-		tell(handle, &t) &&
-		seek(handle, marker) &&
-		write_int(handle, (unsigned int)(t - marker - 4)) &&
-		seek(handle, t);
+static void put_super_index(unsigned char **p, struct gwavi_t *gwavi) {
+	put_chars(p, "indx");
+	put_int(p, SUPER_INDEX_CHUNK_SIZE);
+	put_short(p, 4);
+	put_byte(p, 0);
+	put_byte(p, AVI_INDEX_OF_INDEXES);
+	put_int(p, gwavi->super_index_count);
+	put_chars(p, "00dc");
+	put_int(p, 0);
+	put_int(p, 0);
+	put_int(p, 0);
+	for (int i = 0; i < GWAVI_SUPER_INDEX_SIZE; i++) {
+		put_long(p, gwavi->super_index[i].offset);
+		put_int(p, gwavi->super_index[i].size);
+		put_int(p, gwavi->super_index[i].duration);
+	}
 }
 
-static bool write_index(int handle, int count, unsigned int *offsets) {
-	long marker = 0, t;
-	unsigned int offset = 4;
-	bool result = (offsets != 0) &&
-		write_chars_bin(handle, "idx1", 4) &&
-		tell(handle, &marker) &&
-		write_int(handle, 0);
-	if (!result)
+static bool write_avi_header_chunk(struct gwavi_t *gwavi, uint64_t offset) {
+	unsigned char *buffer = malloc(HDRL_SIZE), *p = buffer;
+	if (buffer == NULL)
 		return false;
-	for (t = 0; t < count; t++) {
-		if ((offsets[t] & 0x80000000) == 0) {
-			result = write_chars(handle, "00dc");
-		} else {
-			result = write_chars(handle, "01wb");
-			offsets[t] &= 0x7fffffff;
-		}
-		result = result && write_int(handle, 0x10) && write_int(handle, offset) && write_int(handle, offsets[t]);
-		if (!result)
-			return false;
-		offset = offset + offsets[t] + 8;
+	memset(buffer, 0, HDRL_SIZE);
+	put_chars(&p, "LIST");
+	put_int(&p, HDRL_SIZE - 8);
+	put_chars(&p, "hdrl");
+	put_avi_header(&p, &gwavi->avi_header);
+	put_chars(&p, "LIST");
+	put_int(&p, 4 + 8 + 56 + 8 + 40 + 8 + SUPER_INDEX_CHUNK_SIZE);
+	put_chars(&p, "strl");
+	put_stream_header(&p, &gwavi->stream_header);
+	put_stream_format(&p, &gwavi->stream_format);
+	put_super_index(&p, gwavi);
+	put_chars(&p, "LIST");
+	put_int(&p, 4 + 8 + DMLH_CHUNK_SIZE);
+	put_chars(&p, "odml");
+	put_chars(&p, "dmlh");
+	put_int(&p, DMLH_CHUNK_SIZE);
+	put_int(&p, gwavi->stream_header.data_length);
+	bool result;
+	if (offset == gwavi->position)
+		result = append(gwavi, buffer, HDRL_SIZE);
+	else
+		result = pwrite(gwavi->handle, buffer, HDRL_SIZE, offset) == HDRL_SIZE;
+	free(buffer);
+	return result;
+}
+
+static bool start_riff(struct gwavi_t *gwavi) {
+	unsigned char buffer[12], *p = buffer;
+	gwavi->riff_start = gwavi->position;
+	put_chars(&p, "RIFF");
+	put_int(&p, 0);
+	put_chars(&p, gwavi->riff_count == 0 ? "AVI " : "AVIX");
+	if (!append(gwavi, buffer, 12))
+		return false;
+	if (gwavi->riff_count == 0 && !write_avi_header_chunk(gwavi, gwavi->position))
+		return false;
+	p = buffer;
+	gwavi->movi_start = gwavi->position;
+	put_chars(&p, "LIST");
+	put_int(&p, 0);
+	put_chars(&p, "movi");
+	if (!append(gwavi, buffer, 12))
+		return false;
+	gwavi->riff_count++;
+	gwavi->std_index_count = 0;
+	return true;
+}
+
+static bool write_std_index(struct gwavi_t *gwavi) {
+	uint32_t size = 24 + 8 * gwavi->std_index_count;
+	unsigned char *buffer = malloc(size + 8), *p = buffer;
+	if (buffer == NULL)
+		return false;
+	put_chars(&p, "ix00");
+	put_int(&p, size);
+	put_short(&p, 2);
+	put_byte(&p, 0);
+	put_byte(&p, AVI_INDEX_OF_CHUNKS);
+	put_int(&p, gwavi->std_index_count);
+	put_chars(&p, "00dc");
+	put_long(&p, gwavi->riff_start);
+	put_int(&p, 0);
+	for (int i = 0; i < 2 * gwavi->std_index_count; i++)
+		put_int(&p, gwavi->std_index[i]);
+	struct gwavi_super_index_entry_t *entry = gwavi->super_index + gwavi->super_index_count++;
+	entry->offset = gwavi->position;
+	entry->size = size + 8;
+	entry->duration = gwavi->std_index_count;
+	bool result = append(gwavi, buffer, size + 8);
+	free(buffer);
+	return result;
+}
+
+static bool write_legacy_index(struct gwavi_t *gwavi) {
+	uint32_t size = 16 * gwavi->offset_count;
+	unsigned char *buffer = malloc(size + 8), *p = buffer;
+	if (buffer == NULL)
+		return false;
+	put_chars(&p, "idx1");
+	put_int(&p, size);
+	for (int i = 0; i < gwavi->offset_count; i++) {
+		put_chars(&p, "00dc");
+		put_int(&p, AVIIF_KEYFRAME);
+		put_int(&p, gwavi->offsets[2 * i]);
+		put_int(&p, gwavi->offsets[2 * i + 1]);
 	}
-	result = tell(handle, &t) && seek(handle, marker) && write_int(handle, (unsigned int)(t - marker - 4)) && seek(handle, t);
+	bool result = append(gwavi, buffer, size + 8);
+	free(buffer);
 	return result;
 }
 
+static bool finish_riff(struct gwavi_t *gwavi) {
+	if (!write_std_index(gwavi) || !patch_int(gwavi->handle, gwavi->movi_start + 4, (uint32_t)(gwavi->position - gwavi->movi_start - 8)))
+		return false;
+	if (gwavi->riff_count == 1 && !write_legacy_index(gwavi))
+		return false;
+	return patch_int(gwavi->handle, gwavi->riff_start + 4, (uint32_t)(gwavi->position - gwavi->riff_start - 8));
+}
+
 /**
  * This is the first function you should call when using gwavi library.
  * It allocates memory for a gwavi_t structure and returns it and takes care of
@@ -218,6 +291,9 @@ static bool write_index(int handle, int count, unsigned int *offsets) {
  * function to free memory allocated for the gwavi_t structure and properly
  * close the output file.
  *
+ * File is written in OpenDML (AVI 2.0) format, first RIFF chunk contains also
+ * legacy idx1 index for players not supporting OpenDML.
+ *
  * @param filename This is the name of the AVI file which will be generated by
  * this library.
  * @param width Width of a frame.
@@ -226,9 +302,6 @@ static bool write_index(int handle, int count, unsigned int *offsets) {
  * FourCC is a sequence of four chars used to uniquely identify data formats.
  * For more information, you can visit www.fourcc.org.
  * @param fps Number of frames per second of your video. It needs to be > 0.
- * @param audio This parameter is optionnal. It is used for the audio track. If
- * you do not want to add an audio track to your AVI file, simply pass NULL for
- * this argument.
  *
  * @return Structure containing required information in order to create the AVI
  * file. If an error occured, NULL is returned.
@@ -249,7 +322,7 @@ struct gwavi_t *gwavi_open(const char *filename, unsigned int width, unsigned in
 	/* set avi header */
 	gwavi->avi_header.time_delay= 1000000 / fps;
 	gwavi->avi_header.data_rate = width * height * 3;
-	gwavi->avi_header.flags = 0x10;
+	gwavi->avi_header.flags = AVIF_HASINDEX;
 	gwavi->avi_header.data_streams = 1;
 	/* this field gets updated when calling gwavi_close() */
 	gwavi->avi_header.number_of_frames = 0;
@@ -279,18 +352,14 @@ struct gwavi_t *gwavi_open(const char *filename, unsigned int width, unsigned in
 	gwavi->stream_format.colors_important = 0;
 	gwavi->stream_format.palette = 0;
 	gwavi->stream_format.palette_count = 0;
-	if (!write_chars_bin(handle, "RIFF", 4) || !write_int(handle, 0))
-		goto failure;
-	if (!write_chars_bin(handle, "AVI ", 4) ||  !write_avi_header_chunk(gwavi))
-		goto failure;
-	if (!write_chars_bin(handle, "LIST", 4) || !tell(handle, &gwavi->marker) || !write_int(handle, 0) || !write_chars_bin(handle, "movi", 4))
-		goto failure;
 	gwavi->offsets_len = 1024;
-	if ((gwavi->offsets = (unsigned int *)malloc((size_t)gwavi->offsets_len * sizeof(unsigned int))) == NULL) {
+	gwavi->std_index_len = 1024;
+	if ((gwavi->offsets = (uint32_t *)malloc((size_t)gwavi->offsets_len * 2 * sizeof(uint32_t))) == NULL || (gwavi->std_index = (uint32_t *)malloc((size_t)gwavi->std_index_len * 2 * sizeof(uint32_t))) == NULL) {
 		INDIGO_ERROR(indigo_error("gwavi_open: could not allocate memory for gwavi offsets table"));
 		goto failure;
 	}
-	gwavi->offsets_ptr = 0;
+	if (!start_riff(gwavi))
+		goto failure;
 	return gwavi;
 failure:
 	if (handle != -1) {
@@ -299,6 +368,8 @@ failure:
 	if (gwavi) {
 		if (gwavi->offsets)
 			free(gwavi->offsets);
+		if (gwavi->std_index)
+			free(gwavi->std_index);
 		free(gwavi);
 	}
 	return NULL;
@@ -306,6 +377,8 @@ failure:
 
 /**
  * This function allows you to add an encoded video frame to the AVI file.
+ * Frame chunk is written with a single write, new RIFF-AVIX chunk is started
+ * when the current one would exceed GWAVI_RIFF_LIMIT.
  *
  * @param gwavi Main gwavi structure initialized with gwavi_open()-
  * @param buffer Video buffer size.
@@ -314,27 +387,57 @@ failure:
  * @return true on success, false on error.
  */
 bool gwavi_add_frame(struct gwavi_t *gwavi, unsigned char *buffer, size_t len) {
-	size_t maxi_pad;  /* if your frame is raggin, give it some paddin' */
-	size_t t;
-	char zero = 0;
+	static unsigned char zero[4] = { 0 };
 	if (!gwavi || !buffer || len < 256)
 		return false;
-	gwavi->offset_count++;
-	gwavi->stream_header.data_length++;
-	maxi_pad = len % 4;
-	if (maxi_pad > 0)
-		maxi_pad = 4 - maxi_pad;
-	if (gwavi->offset_count >= gwavi->offsets_len) {
+	size_t pad = len % 2;
+	uint64_t riff_size = gwavi->position - gwavi->riff_start;
+	uint64_t index_size = 32 + 8 * (gwavi->std_index_count + 1) + (gwavi->riff_count == 1 ? 8 + 16 * (gwavi->offset_count + 1) : 0);
+	if (riff_size + 8 + len + pad + index_size > GWAVI_RIFF_LIMIT && gwavi->std_index_count > 0) {
+		if (gwavi->super_index_count == GWAVI_SUPER_INDEX_SIZE - 1) {
+			INDIGO_ERROR(indigo_error("gwavi_add_frame: super index is full"));
+			return false;
+		}
+		if (!finish_riff(gwavi) || !start_riff(gwavi))
+			return false;
+	}
+	if (gwavi->std_index_count >= gwavi->std_index_len) {
+		uint32_t *std_index = (uint32_t *)realloc(gwavi->std_index, (size_t)(gwavi->std_index_len + 1024) * 2 * sizeof(uint32_t));
+		if (std_index == NULL)
+			return false;
+		gwavi->std_index = std_index;
+		gwavi->std_index_len += 1024;
+	}
+	if (gwavi->riff_count == 1 && gwavi->offset_count >= gwavi->offsets_len) {
+		uint32_t *offsets = (uint32_t *)realloc(gwavi->offsets, (size_t)(gwavi->offsets_len + 1024) * 2 * sizeof(uint32_t));
+		if (offsets == NULL)
+			return false;
+		gwavi->offsets = offsets;
 		gwavi->offsets_len += 1024;
-		gwavi->offsets = (unsigned int *)realloc(gwavi->offsets, (size_t)gwavi->offsets_len * sizeof(unsigned int));
 	}
-	gwavi->offsets[gwavi->offsets_ptr++] = (unsigned int)(len + maxi_pad);
-	if (!write_chars_bin(gwavi->handle, "00dc", 4) || !write_int(gwavi->handle, (unsigned int)(len + maxi_pad)) || !indigo_write(gwavi->handle, (const char *)buffer, len))
-		return false;
-	for (t = 0; t < maxi_pad; t++) {
-		if (!indigo_write(gwavi->handle, &zero, 1))
+	unsigned char header[8], *p = header;
+	put_chars(&p, "00dc");
+	put_int(&p, (uint32_t)len);
+	struct iovec iov[3] = { { header, 8 }, { buffer, len }, { zero, pad } };
+	size_t total = 8 + len + pad;
+	ssize_t written = writev(gwavi->handle, iov, pad ? 3 : 2);
+	if (written != (ssize_t)total) {
+		/* finish partial write */
+		if (written < 0 || lseek(gwavi->handle, gwavi->position, SEEK_SET) == -1)
+			return false;
+		if (!indigo_write(gwavi->handle, (const char *)header, 8) || !indigo_write(gwavi->handle, (const char *)buffer, len) || !indigo_write(gwavi->handle, (const char *)zero, pad))
 			return false;
 	}
+	gwavi->std_index[2 * gwavi->std_index_count] = (uint32_t)(gwavi->position + 8 - gwavi->riff_start);
+	gwavi->std_index[2 * gwavi->std_index_count + 1] = (uint32_t)len;
+	gwavi->std_index_count++;
+	if (gwavi->riff_count == 1) {
+		gwavi->offsets[2 * gwavi->offset_count] = (uint32_t)(gwavi->position - gwavi->movi_start - 8);
+		gwavi->offsets[2 * gwavi->offset_count + 1] = (uint32_t)len;
+		gwavi->offset_count++;
+	}
+	gwavi->position += total;
+	gwavi->stream_header.data_length++;
 	return true;
 }
 
@@ -345,31 +448,18 @@ bool gwavi_add_frame(struct gwavi_t *gwavi, unsigned char *buffer, size_t len) {
  *
  * @param gwavi Main gwavi structure initialized with gwavi_open()-
  *
- * @return 0 on success, -1 on error.
+ * @return true on success, false on error.
  */
 bool gwavi_close(struct gwavi_t *gwavi) {
-	long t;
 	if (!gwavi)
 		return false;
 	int handle = gwavi->handle;
-	if (!tell(handle, &t) || !seek(handle, gwavi->marker) || !write_int(handle, (unsigned int)(t - gwavi->marker - 4)))
-		goto failure;
-	if (!seek(handle, t) || !write_index(handle, gwavi->offset_count, gwavi->offsets))
-		goto failure;
+	bool result = finish_riff(gwavi);
+	gwavi->avi_header.number_of_frames = gwavi->offset_count;
+	result = result && write_avi_header_chunk(gwavi, 12);
 	free(gwavi->offsets);
-	gwavi->offsets = NULL;
-	gwavi->avi_header.number_of_frames = gwavi->stream_header.data_length;
-	if (!tell(handle, &t) || !seek(handle, 12) || !write_avi_header_chunk(gwavi) || !seek(handle, t))
-		goto failure;
-	if (!seek(handle, 4) || !write_int(handle, (unsigned int)(t - 8)))
-		goto failure;
+	free(gwavi->std_index);
 	close(handle);
 	free(gwavi);
-	return true;
-failure:
-	if (gwavi->offsets)
-		free(gwavi->offsets);
-	close(handle);
-	free(gwavi);
-	return false;
+	return result;
 }
@@ -52,6 +52,7 @@
 #include <indigo/indigo_names.h>
 #include <indigo/indigo_io.h>
 #include <indigo/indigo_token.h>
+#include <indigo/indigo_metrics.h>
 
 #define MAX_DEVICES 256
 #define MAX_CLIENTS 256
@@ -107,6 +108,7 @@ indigo_property INDIGO_ALL_PROPERTIES;
 
 static indigo_log_levels indigo_log_level = INDIGO_LOG_ERROR;
 bool indigo_use_syslog = false;
+bool indigo_log_thread_ids = false;
 
 void (*indigo_log_message_handler)(const char *message) = NULL;
 
@@ -155,25 +157,62 @@ int clock_gettime(clockid_t clk_id, struct timespec *ts) {
 }
 #endif
 
-void indigo_log_message(const char *format, va_list args) {
-	static pthread_mutex_t log_mutex = PTHREAD_MUTEX_INITIALIZER;
-	pthread_mutex_lock(&log_mutex);
-	vsnprintf(indigo_last_message, sizeof(indigo_last_message), format, args);
-	char *line = indigo_last_message;
+// log records are formatted into bounded MPSC ring by producers without locking and written by background thread
+
+#define LOG_RING_SIZE				2048
+#define LOG_RECORD_SIZE			512
+#define LOG_HEAP_LIMIT			(4 * 1024 * 1024)
+#define LOG_WRITER_TIMEOUT	100000000L
+
+typedef struct {
+	size_t sequence;
+	double time;
+	int thread;
+	bool error;
+	char *long_text;
+	char text[LOG_RECORD_SIZE];
+} log_record;
+
+static log_record log_ring[LOG_RING_SIZE];
+static size_t log_head = 0;
+static size_t log_tail = 0;
+static long log_heap = 0;
+static unsigned long log_dropped = 0;
+static int log_thread_count = 0;
+static __thread int log_thread_id = 0;
+static __thread bool log_writing = false;
+static bool log_writer_running = false;
+static bool log_writer_sleeping = false;
+static bool log_writer_failed = false;
+static double log_time_offset = 0;
+static pthread_mutex_t log_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t log_writer_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t log_writer_cond = PTHREAD_COND_INITIALIZER;
+static pthread_mutex_t last_message_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static double log_time(int clock) {
+	struct timespec ts;
+	clock_gettime(clock, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void log_write(const char *message, double when, int thread) {
+	char *line = (char *)message;
 	if (indigo_log_message_handler != NULL) {
-		indigo_log_message_handler(indigo_last_message);
+		indigo_log_message_handler(message);
 #if defined(INDIGO_LINUX) || defined(INDIGO_MACOS)
-  } else if (indigo_use_syslog) {
+	} else if (indigo_use_syslog) {
 		static bool initialize = true;
-		if (initialize)
+		if (initialize) {
 			openlog("INDIGO", LOG_NDELAY, LOG_USER | LOG_PERROR);
+			initialize = false;
+		}
 		while (line) {
 			char *eol = strchr(line, '\n');
 			if (eol)
 				*eol = 0;
-			if (eol > line)
-				syslog (LOG_NOTICE, "%s", indigo_last_message);
-			syslog (LOG_NOTICE, "%s", line);
+			if (*line)
+				syslog (LOG_NOTICE, "%s", line);
 			if (eol)
 				line = eol + 1;
 			else
@@ -182,26 +221,22 @@ void indigo_log_message(const char *format, va_list args) {
 #endif
 	} else {
 		char timestamp[16];
-		struct timeval tmnow;
-		gettimeofday(&tmnow, NULL);
+		when += log_time_offset;
+		time_t seconds = (time_t)when;
+		long usec = (long)((when - seconds) * 1000000);
 #if defined(INDIGO_WINDOWS)
 		struct tm *lt;
 		time_t rawtime;
-		lt = localtime((const time_t *) &(tmnow.tv_sec));
+		lt = localtime(&seconds);
 		if (lt == NULL) {
 			time(&rawtime);
 			lt = localtime(&rawtime);
 		}
 		strftime (timestamp, 9, "%H:%M:%S", lt);
 #else
-		strftime (timestamp, 9, "%H:%M:%S", localtime((const time_t *) &tmnow.tv_sec));
-#endif
-
-#ifdef INDIGO_MACOS
-		snprintf(timestamp + 8, sizeof(timestamp) - 8, ".%06d", tmnow.tv_usec);
-#else
-		snprintf(timestamp + 8, sizeof(timestamp) - 8, ".%06ld", tmnow.tv_usec);
+		strftime (timestamp, 9, "%H:%M:%S", localtime(&seconds));
 #endif
+		snprintf(timestamp + 8, sizeof(timestamp) - 8, ".%06ld", usec);
 		if (indigo_log_name[0] == '\0') {
 			if (indigo_main_argc == 0) {
 				strncpy(indigo_log_name, "Application", sizeof(indigo_log_name));
@@ -223,21 +258,201 @@ void indigo_log_message(const char *format, va_list args) {
 			char *eol = strchr(line, '\n');
 			if (eol)
 				*eol = 0;
-			if (*line)
-				fprintf(stderr, "%s %s: %s\n", timestamp, indigo_log_name, line);
+			if (*line) {
+				if (indigo_log_thread_ids)
+					fprintf(stderr, "%s %s #%d: %s\n", timestamp, indigo_log_name, thread, line);
+				else
+					fprintf(stderr, "%s %s: %s\n", timestamp, indigo_log_name, line);
+			}
 			if (eol)
 				line = eol + 1;
 			else
 				line = NULL;
 		}
 	}
+}
+
+// log_writing marks thread inside of log_write(), log handler logging from there must not wait for the writer
+
+static bool log_consume(void) {
+	unsigned long dropped = __atomic_exchange_n(&log_dropped, 0, __ATOMIC_RELAXED);
+	log_writing = true;
+	if (dropped) {
+		char message[64];
+		snprintf(message, sizeof(message), "%lu log messages dropped", dropped);
+		log_write(message, log_time(CLOCK_MONOTONIC), 0);
+	}
+	log_record *record = log_ring + (log_tail & (LOG_RING_SIZE - 1));
+	if (__atomic_load_n(&record->sequence, __ATOMIC_ACQUIRE) != log_tail + 1) {
+		log_writing = false;
+		return false;
+	}
+	if (record->long_text) {
+		log_write(record->long_text, record->time, record->thread);
+		__atomic_sub_fetch(&log_heap, strlen(record->long_text) + 1, __ATOMIC_RELAXED);
+		free(record->long_text);
+		record->long_text = NULL;
+	} else {
+		log_write(record->text, record->time, record->thread);
+	}
+	__atomic_store_n(&record->sequence, log_tail + LOG_RING_SIZE, __ATOMIC_RELEASE);
+	__atomic_store_n(&log_tail, log_tail + 1, __ATOMIC_RELEASE);
+	log_writing = false;
+	return true;
+}
+
+static void *log_writer(void *data) {
+	pthread_detach(pthread_self());
+	while (true) {
+		while (log_consume())
+			;
+		pthread_mutex_lock(&log_writer_mutex);
+		__atomic_store_n(&log_writer_sleeping, true, __ATOMIC_SEQ_CST);
+		if (!log_consume()) {
+			struct timespec timeout;
+			clock_gettime(CLOCK_REALTIME, &timeout);
+			timeout.tv_nsec += LOG_WRITER_TIMEOUT;
+			if (timeout.tv_nsec >= 1000000000L) {
+				timeout.tv_sec++;
+				timeout.tv_nsec -= 1000000000L;
+			}
+			pthread_cond_timedwait(&log_writer_cond, &log_writer_mutex, &timeout);
+		}
+		__atomic_store_n(&log_writer_sleeping, false, __ATOMIC_SEQ_CST);
+		pthread_mutex_unlock(&log_writer_mutex);
+	}
+	return NULL;
+}
+
+static void log_wake_writer(void) {
+	// writer calling log handler holds log_writer_mutex and is awake anyway
+	if (!log_writing && __atomic_load_n(&log_writer_sleeping, __ATOMIC_SEQ_CST)) {
+		pthread_mutex_lock(&log_writer_mutex);
+		pthread_cond_signal(&log_writer_cond);
+		pthread_mutex_unlock(&log_writer_mutex);
+	}
+}
+
+static void log_after_fork(void) {
+	log_writer_running = false;
+}
+
+static bool log_start_writer(void) {
+	pthread_mutex_lock(&log_mutex);
+	if (!log_writer_running && !log_writer_failed) {
+		static bool initialize = true;
+		if (initialize) {
+			for (int i = 0; i < LOG_RING_SIZE; i++)
+				log_ring[i].sequence = i;
+			log_time_offset = log_time(CLOCK_REALTIME) - log_time(CLOCK_MONOTONIC);
+			atexit(indigo_log_flush);
+#if defined(INDIGO_LINUX) || defined(INDIGO_MACOS)
+			pthread_atfork(NULL, NULL, log_after_fork);
+#endif
+			initialize = false;
+		}
+		pthread_t thread;
+		if (pthread_create(&thread, NULL, log_writer, NULL) == 0)
+			__atomic_store_n(&log_writer_running, true, __ATOMIC_RELEASE);
+		else
+			log_writer_failed = true;
+	}
 	pthread_mutex_unlock(&log_mutex);
+	return log_writer_running;
+}
+
+void indigo_log_flush(void) {
+	if (log_writing) {
+		fflush(stderr);
+		return;
+	}
+	size_t head = __atomic_load_n(&log_head, __ATOMIC_ACQUIRE);
+	while (__atomic_load_n(&log_writer_running, __ATOMIC_ACQUIRE) && ((long)(head - __atomic_load_n(&log_tail, __ATOMIC_ACQUIRE)) > 0 || __atomic_load_n(&log_dropped, __ATOMIC_RELAXED))) {
+		log_wake_writer();
+		indigo_usleep(1000);
+	}
+	fflush(stderr);
+}
+
+static void log_enqueue(bool error, const char *format, va_list args) {
+	if (error) {
+		va_list copy;
+		va_copy(copy, args);
+		pthread_mutex_lock(&last_message_mutex);
+		vsnprintf(indigo_last_message, sizeof(indigo_last_message), format, copy);
+		pthread_mutex_unlock(&last_message_mutex);
+		va_end(copy);
+	}
+	if (log_thread_id == 0)
+		log_thread_id = __atomic_add_fetch(&log_thread_count, 1, __ATOMIC_RELAXED);
+	double time = log_time(CLOCK_MONOTONIC);
+	// message logged by log handler is queued without waiting, if it is an error it may be dropped
+	bool nested = log_writing;
+	if (nested && !__atomic_load_n(&log_writer_running, __ATOMIC_ACQUIRE)) {
+		// handler called synchronously under log_mutex, nothing to queue to
+		__atomic_add_fetch(&log_dropped, 1, __ATOMIC_RELAXED);
+		return;
+	}
+	if (!__atomic_load_n(&log_writer_running, __ATOMIC_ACQUIRE) && !log_start_writer()) {
+		char message[LOG_RECORD_SIZE];
+		vsnprintf(message, sizeof(message), format, args);
+		pthread_mutex_lock(&log_mutex);
+		log_writing = true;
+		log_write(message, time, log_thread_id);
+		log_writing = false;
+		pthread_mutex_unlock(&log_mutex);
+		return;
+	}
+	log_record *record;
+	size_t position = __atomic_load_n(&log_head, __ATOMIC_RELAXED);
+	while (true) {
+		record = log_ring + (position & (LOG_RING_SIZE - 1));
+		long difference = (long)(__atomic_load_n(&record->sequence, __ATOMIC_ACQUIRE) - position);
+		if (difference == 0) {
+			if (__atomic_compare_exchange_n(&log_head, &position, position + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+				break;
+		} else if (difference < 0) {
+			log_wake_writer();
+			if (!error || nested) {
+				__atomic_add_fetch(&log_dropped, 1, __ATOMIC_RELAXED);
+				return;
+			}
+			// errors are never dropped, wait for free record
+			indigo_usleep(1000);
+			position = __atomic_load_n(&log_head, __ATOMIC_RELAXED);
+		} else {
+			position = __atomic_load_n(&log_head, __ATOMIC_RELAXED);
+		}
+	}
+	record->time = time;
+	record->thread = log_thread_id;
+	record->long_text = NULL;
+	va_list copy;
+	va_copy(copy, args);
+	int length = vsnprintf(record->text, LOG_RECORD_SIZE, format, copy);
+	va_end(copy);
+	if (length >= LOG_RECORD_SIZE && __atomic_add_fetch(&log_heap, length + 1, __ATOMIC_RELAXED) <= LOG_HEAP_LIMIT) {
+		if ((record->long_text = malloc(length + 1)) != NULL)
+			vsnprintf(record->long_text, length + 1, format, args);
+		else
+			__atomic_sub_fetch(&log_heap, length + 1, __ATOMIC_RELAXED);
+	} else if (length >= LOG_RECORD_SIZE) {
+		__atomic_sub_fetch(&log_heap, length + 1, __ATOMIC_RELAXED);
+	}
+	__atomic_store_n(&record->sequence, position + 1, __ATOMIC_RELEASE);
+	log_wake_writer();
+	if (error && !nested)
+		indigo_log_flush();
+}
+
+void indigo_log_message(const char *format, va_list args) {
+	log_enqueue(false, format, args);
 }
 
 void indigo_error(const char *format, ...) {
 	va_list argList;
 	va_start(argList, format);
-	indigo_log_message(format, argList);
+	log_enqueue(true, format, argList);
 	va_end(argList);
 }
 
@@ -435,11 +650,29 @@ indigo_result indigo_detach_client(indigo_client *client) {
 	return INDIGO_OK;
 }
 
+static inline double lock_bus(pthread_mutex_t *mutex, indigo_metric_histogram wait) {
+	double start = indigo_metric_time();
+	pthread_mutex_lock(mutex);
+	if (start > 0) {
+		double locked = indigo_metric_time();
+		indigo_metric_observe(wait, locked - start);
+		return locked;
+	}
+	return 0;
+}
+
+static inline void unlock_bus(pthread_mutex_t *mutex, indigo_metric_histogram hold, double locked) {
+	indigo_metric_observe_since(hold, locked);
+	pthread_mutex_unlock(mutex);
+}
+
 indigo_result indigo_enumerate_properties(indigo_client *client, indigo_property *property) {
 	if (!is_started)
 		return INDIGO_FAILED;
+	indigo_metric_add(INDIGO_METRIC_BUS_ENUMERATE, 1);
+	double locked = 0;
 	if (indigo_use_strict_locking)
-		pthread_mutex_lock(&device_mutex);
+		locked = lock_bus(&device_mutex, INDIGO_METRIC_BUS_DEVICE_LOCK_WAIT);
 	for (int i = 0; i < MAX_DEVICES; i++) {
 		indigo_device *device = devices[i];
 		if (device != NULL && device->enumerate_properties != NULL) {
@@ -452,15 +685,17 @@ indigo_result indigo_enumerate_properties(indigo_client *client, indigo_property
 		}
 	}
 	if (indigo_use_strict_locking)
-		pthread_mutex_unlock(&device_mutex);
+		unlock_bus(&device_mutex, INDIGO_METRIC_BUS_DEVICE_LOCK_HOLD, locked);
 	return INDIGO_OK;
 }
 
 indigo_result indigo_change_property(indigo_client *client, indigo_property *property) {
 	if ((!is_started) || (property == NULL) || (property->perm == INDIGO_RO_PERM))
 		return INDIGO_FAILED;
+	indigo_metric_add(INDIGO_METRIC_BUS_CHANGE, 1);
+	double locked = 0;
 	if (indigo_use_strict_locking)
-		pthread_mutex_lock(&device_mutex);
+		locked = lock_bus(&device_mutex, INDIGO_METRIC_BUS_DEVICE_LOCK_WAIT);
 	INDIGO_TRACE(indigo_trace_property("INDIGO Bus: property change request", property, false, true));
 	for (int i = 0; i < MAX_DEVICES; i++) {
 		indigo_device *device = devices[i];
@@ -480,15 +715,16 @@ indigo_result indigo_change_property(indigo_client *client, indigo_property *pro
 		}
 	}
 	if (indigo_use_strict_locking)
-		pthread_mutex_unlock(&device_mutex);
+		unlock_bus(&device_mutex, INDIGO_METRIC_BUS_DEVICE_LOCK_HOLD, locked);
 	return INDIGO_OK;
 }
 
 indigo_result indigo_enable_blob(indigo_client *client, indigo_property *property, indigo_enable_blob_mode mode) {
 	if ((!is_started) || (property == NULL))
 		return INDIGO_FAILED;
+	double locked = 0;
 	if (indigo_use_strict_locking)
-		pthread_mutex_lock(&device_mutex);
+		locked = lock_bus(&device_mutex, INDIGO_METRIC_BUS_DEVICE_LOCK_WAIT);
 	INDIGO_TRACE(indigo_trace_property("INDIGO Bus: enable BLOB mode change request", property, false, true));
 	for (int i = 0; i < MAX_DEVICES; i++) {
 		indigo_device *device = devices[i];
@@ -502,15 +738,17 @@ indigo_result indigo_enable_blob(indigo_client *client, indigo_property *propert
 		}
 	}
 	if (indigo_use_strict_locking)
-		pthread_mutex_unlock(&device_mutex);
+		unlock_bus(&device_mutex, INDIGO_METRIC_BUS_DEVICE_LOCK_HOLD, locked);
 	return INDIGO_OK;
 }
 
 indigo_result indigo_define_property(indigo_device *device, indigo_property *property, const char *format, ...) {
 	if ((!is_started) || (property == NULL))
 		return INDIGO_FAILED;
+	indigo_metric_add(INDIGO_METRIC_BUS_DEFINE, 1);
+	double locked = 0;
 	if (indigo_use_strict_locking)
-		pthread_mutex_lock(&client_mutex);
+		locked = lock_bus(&client_mutex, INDIGO_METRIC_BUS_CLIENT_LOCK_WAIT);
 	if (!property->hidden) {
 		INDIGO_TRACE(indigo_trace_property("INDIGO Bus: property definition", property, true, true));
 		char message[INDIGO_VALUE_SIZE];
@@ -527,15 +765,17 @@ indigo_result indigo_define_property(indigo_device *device, indigo_property *pro
 		}
 	}
 	if (indigo_use_strict_locking)
-		pthread_mutex_unlock(&client_mutex);
+		unlock_bus(&client_mutex, INDIGO_METRIC_BUS_CLIENT_LOCK_HOLD, locked);
 	return INDIGO_OK;
 }
 
 indigo_result indigo_update_property(indigo_device *device, indigo_property *property, const char *format, ...) {
 	if ((!is_started) || (property == NULL))
 		return INDIGO_FAILED;
+	indigo_metric_add(INDIGO_METRIC_BUS_UPDATE, 1);
+	double locked = 0;
 	if (indigo_use_strict_locking)
-		pthread_mutex_lock(&client_mutex);
+		locked = lock_bus(&client_mutex, INDIGO_METRIC_BUS_CLIENT_LOCK_WAIT);
 	if (!property->hidden) {
 		char message[INDIGO_VALUE_SIZE];
 		int count = property->count;
@@ -548,6 +788,10 @@ indigo_result indigo_update_property(indigo_device *device, indigo_property *pro
 			vsnprintf(message, INDIGO_VALUE_SIZE, format, args);
 			va_end(args);
 		}
+		if (property->type == INDIGO_BLOB_VECTOR && property->state == INDIGO_OK_STATE) {
+			for (int i = 0; i < property->count; i++)
+				indigo_metric_add(INDIGO_METRIC_BLOB_BYTES, property->items[i].blob.size);
+		}
 		if (indigo_use_blob_caching && property->type == INDIGO_BLOB_VECTOR && property->state == INDIGO_OK_STATE) {
 			pthread_mutex_lock(&blob_mutex);
 			for (int i = 0; i < property->count; i++) {
@@ -578,7 +822,7 @@ indigo_result indigo_update_property(indigo_device *device, indigo_property *pro
 				} else {
 					pthread_mutex_unlock(&blob_mutex);
 					if (indigo_use_strict_locking)
-						pthread_mutex_unlock(&client_mutex);
+						unlock_bus(&client_mutex, INDIGO_METRIC_BUS_CLIENT_LOCK_HOLD, locked);
 					return INDIGO_TOO_MANY_ELEMENTS;
 				}
 			}
@@ -592,15 +836,17 @@ indigo_result indigo_update_property(indigo_device *device, indigo_property *pro
 		property->count = count;
 	}
 	if (indigo_use_strict_locking)
-		pthread_mutex_unlock(&client_mutex);
+		unlock_bus(&client_mutex, INDIGO_METRIC_BUS_CLIENT_LOCK_HOLD, locked);
 	return INDIGO_OK;
 }
 
 indigo_result indigo_delete_property(indigo_device *device, indigo_property *property, const char *format, ...) {
 	if ((!is_started) || (property == NULL))
 		return INDIGO_FAILED;
+	indigo_metric_add(INDIGO_METRIC_BUS_DELETE, 1);
+	double locked = 0;
 	if (indigo_use_strict_locking)
-		pthread_mutex_lock(&client_mutex);
+		locked = lock_bus(&client_mutex, INDIGO_METRIC_BUS_CLIENT_LOCK_WAIT);
 	if (!property->hidden) {
 		char message[INDIGO_VALUE_SIZE];
 		INDIGO_TRACE(indigo_trace_property("INDIGO Bus: property removal", property, false, false));
@@ -617,15 +863,17 @@ indigo_result indigo_delete_property(indigo_device *device, indigo_property *pro
 		}
 	}
 	if (indigo_use_strict_locking)
-		pthread_mutex_unlock(&client_mutex);
+		unlock_bus(&client_mutex, INDIGO_METRIC_BUS_CLIENT_LOCK_HOLD, locked);
 	return INDIGO_OK;
 }
 
 indigo_result indigo_send_message(indigo_device *device, const char *format, ...) {
 	if (!is_started)
 		return INDIGO_FAILED;
+	indigo_metric_add(INDIGO_METRIC_BUS_MESSAGE, 1);
+	double locked = 0;
 	if (indigo_use_strict_locking)
-		pthread_mutex_lock(&client_mutex);
+		locked = lock_bus(&client_mutex, INDIGO_METRIC_BUS_CLIENT_LOCK_WAIT);
 	char message[INDIGO_VALUE_SIZE];
 	if (format != NULL) {
 		va_list args;
@@ -640,7 +888,7 @@ indigo_result indigo_send_message(indigo_device *device, const char *format, ...
 			client->last_result = client->send_message(client, device, format != NULL ? message : NULL);
 	}
 	if (indigo_use_strict_locking)
-		pthread_mutex_unlock(&client_mutex);
+		unlock_bus(&client_mutex, INDIGO_METRIC_BUS_CLIENT_LOCK_HOLD, locked);
 	return INDIGO_OK;
 }
 
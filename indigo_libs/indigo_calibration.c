@@ -0,0 +1,776 @@
+// Copyright (c) 2020 CloudMakers, s. r. o.
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// version history
+// 2.0 by Peter Polakovic <peter.polakovic@cloudmakers.eu>
+
+/** INDIGO CCD calibration (master dark, bias and flat frames)
+ \file indigo_calibration.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <math.h>
+#include <time.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <indigo/indigo_bus.h>
+#include <indigo/indigo_io.h>
+#include <indigo/indigo_calibration.h>
+
+#define FITS_BLOCK	2880
+#define FITS_CARD		80
+
+static const char *type_names[] = { "None", "Bias", "Dark", "Flat" };
+
+// -------------------------------------------------------------------------------- FITS I/O
+
+static indigo_calibration_type parse_type(const char *value) {
+	char lower[FITS_CARD + 1];
+	int i;
+	for (i = 0; value[i] && i < FITS_CARD; i++)
+		lower[i] = tolower(value[i]);
+	lower[i] = 0;
+	if (strstr(lower, "dark"))
+		return INDIGO_CALIBRATION_DARK;
+	if (strstr(lower, "flat"))
+		return INDIGO_CALIBRATION_FLAT;
+	if (strstr(lower, "bias") || strstr(lower, "offset"))
+		return INDIGO_CALIBRATION_BIAS;
+	return INDIGO_CALIBRATION_NONE;
+}
+
+static bool read_header(int handle, indigo_calibration_frame *frame, int *bitpix, double *bzero, double *bscale, long *data_offset) {
+	char block[FITS_BLOCK];
+	int naxis = 0;
+	frame->type = INDIGO_CALIBRATION_NONE;
+	frame->width = frame->height = 0;
+	frame->channels = 1;
+	frame->bin_x = frame->bin_y = 1;
+	frame->exposure = 0;
+	frame->temperature = NAN;
+	*bitpix = 0;
+	*bzero = 0;
+	*bscale = 1;
+	*data_offset = 0;
+	for (int blocks = 0; blocks < 32; blocks++) {
+		if (indigo_read(handle, block, FITS_BLOCK) != FITS_BLOCK)
+			return false;
+		if (blocks == 0 && strncmp(block, "SIMPLE  =", 9))
+			return false;
+		*data_offset += FITS_BLOCK;
+		for (char *card = block; card < block + FITS_BLOCK; card += FITS_CARD) {
+			char key[9], value[FITS_CARD];
+			memcpy(key, card, 8);
+			key[8] = 0;
+			for (int i = 7; i >= 0 && key[i] == ' '; i--)
+				key[i] = 0;
+			if (!strcmp(key, "END"))
+				return *bitpix != 0 && naxis >= 2 && frame->width > 0 && frame->height > 0;
+			if (card[8] != '=')
+				continue;
+			memcpy(value, card + 10, FITS_CARD - 10);
+			value[FITS_CARD - 10] = 0;
+			char *start = value;
+			while (*start == ' ')
+				start++;
+			if (*start == '\'') {
+				char *end = strchr(++start, '\'');
+				if (end)
+					*end = 0;
+			} else {
+				char *slash = strchr(start, '/');
+				if (slash)
+					*slash = 0;
+			}
+			if (!strcmp(key, "BITPIX"))
+				*bitpix = atoi(start);
+			else if (!strcmp(key, "NAXIS"))
+				naxis = atoi(start);
+			else if (!strcmp(key, "NAXIS1"))
+				frame->width = atoi(start);
+			else if (!strcmp(key, "NAXIS2"))
+				frame->height = atoi(start);
+			else if (!strcmp(key, "NAXIS3"))
+				frame->channels = atoi(start);
+			else if (!strcmp(key, "BZERO"))
+				*bzero = indigo_atod(start);
+			else if (!strcmp(key, "BSCALE"))
+				*bscale = indigo_atod(start);
+			else if (!strcmp(key, "XBINNING"))
+				frame->bin_x = atoi(start);
+			else if (!strcmp(key, "YBINNING"))
+				frame->bin_y = atoi(start);
+			else if (!strcmp(key, "EXPTIME") || !strcmp(key, "EXPOSURE"))
+				frame->exposure = indigo_atod(start);
+			else if (!strcmp(key, "CCD-TEMP"))
+				frame->temperature = indigo_atod(start);
+			else if (!strcmp(key, "IMAGETYP") || !strcmp(key, "FRAME"))
+				frame->type = parse_type(start);
+		}
+	}
+	return false;
+}
+
+static bool load_data(indigo_calibration_frame *frame) {
+	if (frame->data)
+		return true;
+	int handle = open(frame->file_name, O_RDONLY);
+	if (handle < 0) {
+		INDIGO_ERROR(indigo_error("indigo_calibration: failed to open %s", frame->file_name));
+		return false;
+	}
+	int bitpix;
+	double bzero, bscale;
+	long data_offset;
+	indigo_calibration_frame header = *frame;
+	if (!read_header(handle, &header, &bitpix, &bzero, &bscale, &data_offset) || header.width != frame->width || header.height != frame->height || header.channels != frame->channels) {
+		INDIGO_ERROR(indigo_error("indigo_calibration: invalid FITS header in %s", frame->file_name));
+		close(handle);
+		return false;
+	}
+	long plane = (long)frame->width * frame->height;
+	long samples = plane * frame->channels;
+	int bytes = abs(bitpix) / 8;
+	unsigned char *raw = malloc(samples * bytes);
+	float *data = malloc(samples * sizeof(float));
+	bool result = raw != NULL && data != NULL && indigo_read(handle, (char *)raw, samples * bytes) == samples * bytes;
+	close(handle);
+	if (result) {
+		// FITS is big endian and planar, RAW data are interleaved
+		for (long i = 0; i < samples; i++) {
+			unsigned char *b = raw + i * bytes;
+			double value;
+			switch (bitpix) {
+				case 8:
+					value = b[0];
+					break;
+				case 16:
+					value = (int16_t)(b[0] << 8 | b[1]);
+					break;
+				case 32:
+					value = (int32_t)((uint32_t)b[0] << 24 | (uint32_t)b[1] << 16 | (uint32_t)b[2] << 8 | b[3]);
+					break;
+				case -32: {
+					union { uint32_t i; float f; } u;
+					u.i = (uint32_t)b[0] << 24 | (uint32_t)b[1] << 16 | (uint32_t)b[2] << 8 | b[3];
+					value = u.f;
+					break;
+				}
+				case -64: {
+					union { uint64_t i; double d; } u;
+					u.i = 0;
+					for (int j = 0; j < 8; j++)
+						u.i = u.i << 8 | b[j];
+					value = u.d;
+					break;
+				}
+				default:
+					value = 0;
+					result = false;
+			}
+			long channel = i / plane;
+			data[(i - channel * plane) * frame->channels + channel] = value * bscale + bzero;
+		}
+	}
+	free(raw);
+	if (!result) {
+		INDIGO_ERROR(indigo_error("indigo_calibration: failed to read data from %s", frame->file_name));
+		free(data);
+		return false;
+	}
+	frame->data = data;
+	INDIGO_DEBUG(indigo_debug("indigo_calibration: %s loaded", frame->file_name));
+	return true;
+}
+
+static bool write_card(char **header, const char *format, ...) {
+	char card[FITS_CARD + 1];
+	va_list args;
+	va_start(args, format);
+	int length = vsnprintf(card, sizeof(card), format, args);
+	va_end(args);
+	indigo_fix_locale(card);
+	memset(*header, ' ', FITS_CARD);
+	memcpy(*header, card, length < FITS_CARD ? length : FITS_CARD);
+	*header += FITS_CARD;
+	return true;
+}
+
+static bool save_frame(indigo_calibration_frame *frame, const char *instrument, int count) {
+	long plane = (long)frame->width * frame->height;
+	long samples = plane * frame->channels;
+	long size = FITS_BLOCK + ((samples * 4 + FITS_BLOCK - 1) / FITS_BLOCK) * FITS_BLOCK;
+	char *buffer = malloc(size);
+	if (buffer == NULL)
+		return false;
+	memset(buffer, 0, size);
+	char *header = buffer;
+	char date[32];
+	time_t now = time(NULL);
+	strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", gmtime(&now));
+	write_card(&header, "SIMPLE  =                    T / file conforms to FITS standard");
+	write_card(&header, "BITPIX  =                  -32 / number of bits per data pixel");
+	write_card(&header, "NAXIS   = %20d / number of data axes", frame->channels == 3 ? 3 : 2);
+	write_card(&header, "NAXIS1  = %20d / length of data axis 1 [pixels]", frame->width);
+	write_card(&header, "NAXIS2  = %20d / length of data axis 2 [pixels]", frame->height);
+	if (frame->channels == 3)
+		write_card(&header, "NAXIS3  = %20d / length of data axis 3 [RGB]", 3);
+	write_card(&header, "XBINNING= %20d / horizontal binning [pixels]", frame->bin_x);
+	write_card(&header, "YBINNING= %20d / vertical binning [pixels]", frame->bin_y);
+	write_card(&header, "EXPTIME = %20.3f / exposure time [s]", frame->exposure);
+	if (!isnan(frame->temperature))
+		write_card(&header, "CCD-TEMP= %20.2f / CCD temperature [C]", frame->temperature);
+	write_card(&header, "IMAGETYP= 'Master %s'%*c / frame type", type_names[frame->type], (int)(11 - strlen(type_names[frame->type])), ' ');
+	write_card(&header, "NCOMBINE= %20d / number of combined frames", count);
+	write_card(&header, "DATE-OBS= '%s' / UTC date that FITS file was created", date);
+	write_card(&header, "INSTRUME= '%.40s' / instrument name", instrument);
+	write_card(&header, "COMMENT   Created by INDIGO %d.%d framework, see www.indigo-astronomy.org", (INDIGO_VERSION_CURRENT >> 8) & 0xFF, INDIGO_VERSION_CURRENT & 0xFF);
+	write_card(&header, "END");
+	unsigned char *raw = (unsigned char *)buffer + FITS_BLOCK;
+	for (long i = 0; i < samples; i++) {
+		long channel = i / plane;
+		union { uint32_t i; float f; } u;
+		u.f = frame->data[(i - channel * plane) * frame->channels + channel];
+		*raw++ = u.i >> 24;
+		*raw++ = u.i >> 16;
+		*raw++ = u.i >> 8;
+		*raw++ = u.i;
+	}
+	bool result = false;
+	int handle = open(frame->file_name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (handle >= 0) {
+		result = indigo_write(handle, buffer, size);
+		close(handle);
+	}
+	free(buffer);
+	if (!result)
+		INDIGO_ERROR(indigo_error("indigo_calibration: failed to write %s", frame->file_name));
+	return result;
+}
+
+// -------------------------------------------------------------------------------- Library
+
+static void reset_selection(indigo_calibration *calibration) {
+	calibration->bias = calibration->dark = calibration->flat = NULL;
+	calibration->samples = 0;
+	if (calibration->offset) {
+		free(calibration->offset);
+		calibration->offset = NULL;
+	}
+	if (calibration->gain) {
+		free(calibration->gain);
+		calibration->gain = NULL;
+	}
+}
+
+static void release_frames(indigo_calibration *calibration) {
+	indigo_calibration_frame *frame = calibration->frames;
+	while (frame) {
+		indigo_calibration_frame *next = frame->next;
+		if (frame->data)
+			free(frame->data);
+		free(frame);
+		frame = next;
+	}
+	calibration->frames = NULL;
+}
+
+indigo_calibration *indigo_calibration_create(void) {
+	indigo_calibration *calibration = malloc(sizeof(indigo_calibration));
+	if (calibration) {
+		memset(calibration, 0, sizeof(indigo_calibration));
+		pthread_mutex_init(&calibration->mutex, NULL);
+	}
+	return calibration;
+}
+
+void indigo_calibration_release(indigo_calibration *calibration) {
+	if (calibration == NULL)
+		return;
+	indigo_calibration_wait_master(calibration);
+	pthread_mutex_lock(&calibration->mutex);
+	reset_selection(calibration);
+	release_frames(calibration);
+	if (calibration->build_stack)
+		free(calibration->build_stack);
+	pthread_mutex_unlock(&calibration->mutex);
+	pthread_mutex_destroy(&calibration->mutex);
+	free(calibration);
+}
+
+int indigo_calibration_scan(indigo_calibration *calibration, const char *dir) {
+	int count = 0;
+	pthread_mutex_lock(&calibration->mutex);
+	reset_selection(calibration);
+	release_frames(calibration);
+	DIR *folder = opendir(dir);
+	if (folder) {
+		struct dirent *entry;
+		while ((entry = readdir(folder)) != NULL) {
+			char *suffix = strrchr(entry->d_name, '.');
+			if (suffix == NULL || (strcasecmp(suffix, ".fits") && strcasecmp(suffix, ".fit") && strcasecmp(suffix, ".fts")))
+				continue;
+			indigo_calibration_frame *frame = malloc(sizeof(indigo_calibration_frame));
+			if (frame == NULL)
+				break;
+			memset(frame, 0, sizeof(indigo_calibration_frame));
+			snprintf(frame->file_name, sizeof(frame->file_name), "%s%s%s", dir, dir[strlen(dir) - 1] == '/' ? "" : "/", entry->d_name);
+			int handle = open(frame->file_name, O_RDONLY);
+			int bitpix;
+			double bzero, bscale;
+			long data_offset;
+			if (handle >= 0 && read_header(handle, frame, &bitpix, &bzero, &bscale, &data_offset) && frame->type != INDIGO_CALIBRATION_NONE && (frame->channels == 1 || frame->channels == 3)) {
+				frame->next = calibration->frames;
+				calibration->frames = frame;
+				count++;
+				INDIGO_DEBUG(indigo_debug("indigo_calibration: %s master %dx%dx%d, bin %dx%d, %gs, %gC found in %s", type_names[frame->type], frame->width, frame->height, frame->channels, frame->bin_x, frame->bin_y, frame->exposure, frame->temperature, frame->file_name));
+			} else {
+				free(frame);
+			}
+			if (handle >= 0)
+				close(handle);
+		}
+		closedir(folder);
+	}
+	pthread_mutex_unlock(&calibration->mutex);
+	return count;
+}
+
+static indigo_calibration_frame *find_best(indigo_calibration *calibration, indigo_calibration_type type, int width, int height, int channels, int bin_x, int bin_y, double exposure, double temperature) {
+	indigo_calibration_frame *best = NULL;
+	double best_exposure_diff = 0, best_temperature_diff = 0;
+	for (indigo_calibration_frame *frame = calibration->frames; frame; frame = frame->next) {
+		if (frame->type != type || frame->width != width || frame->height != height || frame->channels != channels || frame->bin_x != bin_x || frame->bin_y != bin_y)
+			continue;
+		double temperature_diff = 0;
+		if (!isnan(temperature) && !isnan(frame->temperature)) {
+			temperature_diff = fabs(frame->temperature - temperature);
+			if (temperature_diff > INDIGO_CALIBRATION_TEMPERATURE_TOLERANCE && type != INDIGO_CALIBRATION_FLAT)
+				continue;
+		}
+		double exposure_diff = type == INDIGO_CALIBRATION_DARK ? fabs(frame->exposure - exposure) : 0;
+		if (best == NULL || exposure_diff < best_exposure_diff || (exposure_diff == best_exposure_diff && temperature_diff < best_temperature_diff)) {
+			best = frame;
+			best_exposure_diff = exposure_diff;
+			best_temperature_diff = temperature_diff;
+		}
+	}
+	return best;
+}
+
+static void compute_offset(indigo_calibration_frame *bias, indigo_calibration_frame *dark, double exposure, long samples, float *offset) {
+	if (dark && bias && dark->exposure > 0 && dark->exposure != exposure) {
+		// scale thermal signal of the dark to light frame exposure
+		const float *restrict d = dark->data;
+		const float *restrict b = bias->data;
+		float scale = exposure / dark->exposure;
+		for (long i = 0; i < samples; i++)
+			offset[i] = b[i] + (d[i] - b[i]) * scale;
+	} else if (dark) {
+		memcpy(offset, dark->data, samples * sizeof(float));
+	} else if (bias) {
+		memcpy(offset, bias->data, samples * sizeof(float));
+	} else {
+		memset(offset, 0, samples * sizeof(float));
+	}
+}
+
+bool indigo_calibration_select(indigo_calibration *calibration, int width, int height, int channels, int bin_x, int bin_y, double exposure, double temperature) {
+	pthread_mutex_lock(&calibration->mutex);
+	long samples = (long)width * height * channels;
+	indigo_calibration_frame *bias = find_best(calibration, INDIGO_CALIBRATION_BIAS, width, height, channels, bin_x, bin_y, exposure, temperature);
+	indigo_calibration_frame *dark = find_best(calibration, INDIGO_CALIBRATION_DARK, width, height, channels, bin_x, bin_y, exposure, temperature);
+	indigo_calibration_frame *flat = find_best(calibration, INDIGO_CALIBRATION_FLAT, width, height, channels, bin_x, bin_y, exposure, temperature);
+	if (bias && !load_data(bias))
+		bias = NULL;
+	if (dark && !load_data(dark))
+		dark = NULL;
+	if (flat && !load_data(flat))
+		flat = NULL;
+	bool scaled = dark && bias && dark->exposure != exposure;
+	if (bias != calibration->bias || dark != calibration->dark || flat != calibration->flat || samples != calibration->samples || (scaled && exposure != calibration->exposure)) {
+		reset_selection(calibration);
+		if (bias || dark || flat) {
+			calibration->offset = malloc(samples * sizeof(float));
+			calibration->gain = malloc(samples * sizeof(float));
+			if (calibration->offset && calibration->gain) {
+				compute_offset(bias, dark, exposure, samples, calibration->offset);
+				float *restrict gain = calibration->gain;
+				if (flat) {
+					for (int c = 0; c < channels; c++) {
+						double sum = 0;
+						for (long i = c; i < samples; i += channels)
+							sum += flat->data[i];
+						float mean = sum / (samples / channels);
+						for (long i = c; i < samples; i += channels)
+							gain[i] = flat->data[i] > 0 ? mean / flat->data[i] : 1;
+					}
+				} else {
+					for (long i = 0; i < samples; i++)
+						gain[i] = 1;
+				}
+				calibration->bias = bias;
+				calibration->dark = dark;
+				calibration->flat = flat;
+				calibration->samples = samples;
+				calibration->exposure = exposure;
+			} else {
+				reset_selection(calibration);
+			}
+		}
+	}
+	bool result = calibration->samples != 0;
+	pthread_mutex_unlock(&calibration->mutex);
+	return result;
+}
+
+// -------------------------------------------------------------------------------- Apply
+
+// plain loops over restrict pointers, vectorized by the compiler at -O3
+
+static void swap_16(uint16_t *restrict raw, long count) {
+	for (long i = 0; i < count; i++)
+		raw[i] = raw[i] << 8 | raw[i] >> 8;
+}
+
+static void apply_8(uint8_t *restrict raw, const float *restrict offset, const float *restrict gain, long count) {
+	for (long i = 0; i < count; i++) {
+		float value = (raw[i] - offset[i]) * gain[i] + 0.5f;
+		value = value < 0.0f ? 0.0f : value;
+		value = value > 255.0f ? 255.0f : value;
+		raw[i] = (uint8_t)value;
+	}
+}
+
+static void apply_16(uint16_t *restrict raw, const float *restrict offset, const float *restrict gain, long count) {
+	for (long i = 0; i < count; i++) {
+		float value = (raw[i] - offset[i]) * gain[i] + 0.5f;
+		value = value < 0.0f ? 0.0f : value;
+		value = value > 65535.0f ? 65535.0f : value;
+		raw[i] = (uint16_t)value;
+	}
+}
+
+bool indigo_calibration_apply(indigo_calibration *calibration, void *data, int width, int height, int bpp, bool little_endian, indigo_calibration_masters *masters) {
+	bool result = false;
+	if (masters)
+		memset(masters, 0, sizeof(indigo_calibration_masters));
+	INDIGO_DEBUG(clock_t start = clock());
+	pthread_mutex_lock(&calibration->mutex);
+	long samples = (long)width * height * (bpp == 24 || bpp == 48 ? 3 : 1);
+	if (calibration->samples == samples) {
+		if (bpp == 8 || bpp == 24) {
+			apply_8(data, calibration->offset, calibration->gain, samples);
+			result = true;
+		} else if (bpp == 16 || bpp == 48) {
+			if (!little_endian)
+				swap_16(data, samples);
+			apply_16(data, calibration->offset, calibration->gain, samples);
+			if (!little_endian)
+				swap_16(data, samples);
+			result = true;
+		}
+		if (result && masters) {
+			if (calibration->bias)
+				snprintf(masters->bias, sizeof(masters->bias), "%s", calibration->bias->file_name);
+			if (calibration->dark)
+				snprintf(masters->dark, sizeof(masters->dark), "%s", calibration->dark->file_name);
+			if (calibration->flat)
+				snprintf(masters->flat, sizeof(masters->flat), "%s", calibration->flat->file_name);
+		}
+	}
+	pthread_mutex_unlock(&calibration->mutex);
+	INDIGO_DEBUG(if (result) indigo_debug("Calibration in %gs", (clock() - start) / (double)CLOCKS_PER_SEC));
+	return result;
+}
+
+// -------------------------------------------------------------------------------- Master builder
+
+void indigo_calibration_abort_master(indigo_calibration *calibration) {
+	pthread_mutex_lock(&calibration->mutex);
+	if (calibration->build_stack) {
+		free(calibration->build_stack);
+		calibration->build_stack = NULL;
+	}
+	calibration->build_type = INDIGO_CALIBRATION_NONE;
+	calibration->build_count = calibration->build_collected = 0;
+	pthread_mutex_unlock(&calibration->mutex);
+}
+
+bool indigo_calibration_start_master(indigo_calibration *calibration, indigo_calibration_type type, int count, double sigma) {
+	if (type == INDIGO_CALIBRATION_NONE || count < 1 || count > INDIGO_CALIBRATION_MAX_STACK)
+		return false;
+	indigo_calibration_abort_master(calibration);
+	pthread_mutex_lock(&calibration->mutex);
+	calibration->build_type = type;
+	calibration->build_count = count;
+	calibration->build_sigma = sigma;
+	calibration->build_collected = 0;
+	pthread_mutex_unlock(&calibration->mutex);
+	return true;
+}
+
+int indigo_calibration_add_frame(indigo_calibration *calibration, void *data, int width, int height, int bpp, bool little_endian, int bin_x, int bin_y, double exposure, double temperature) {
+	int channels = bpp == 24 || bpp == 48 ? 3 : 1;
+	long samples = (long)width * height * channels;
+	int result = 0;
+	pthread_mutex_lock(&calibration->mutex);
+	if (calibration->build_type != INDIGO_CALIBRATION_NONE && calibration->build_collected < calibration->build_count) {
+		result = -1;
+		if (calibration->build_collected == 0) {
+			if (calibration->build_stack)
+				free(calibration->build_stack);
+			calibration->build_stack = malloc(samples * calibration->build_count * sizeof(uint16_t));
+			calibration->build_width = width;
+			calibration->build_height = height;
+			calibration->build_channels = channels;
+			calibration->build_bin_x = bin_x;
+			calibration->build_bin_y = bin_y;
+			calibration->build_exposure = exposure;
+			calibration->build_temperature = 0;
+		}
+		if (calibration->build_stack && width == calibration->build_width && height == calibration->build_height && channels == calibration->build_channels && bin_x == calibration->build_bin_x && bin_y == calibration->build_bin_y) {
+			uint16_t *restrict slot = calibration->build_stack + samples * calibration->build_collected;
+			if (bpp == 8 || bpp == 24) {
+				const uint8_t *restrict raw = data;
+				for (long i = 0; i < samples; i++)
+					slot[i] = raw[i];
+			} else {
+				memcpy(slot, data, samples * sizeof(uint16_t));
+				if (!little_endian)
+					swap_16(slot, samples);
+			}
+			calibration->build_temperature += temperature;
+			result = ++calibration->build_collected;
+		}
+	}
+	pthread_mutex_unlock(&calibration->mutex);
+	return result;
+}
+
+static int compare_uint16(const void *a, const void *b) {
+	return *(const uint16_t *)a - *(const uint16_t *)b;
+}
+
+static float combine(uint16_t *values, int count, double sigma) {
+	qsort(values, count, sizeof(uint16_t), compare_uint16);
+	float median = count % 2 ? values[count / 2] : (values[count / 2 - 1] + values[count / 2]) / 2.0f;
+	if (sigma <= 0 || count < 3)
+		return median;
+	double sum = 0, sum2 = 0;
+	for (int i = 0; i < count; i++) {
+		sum += values[i];
+		sum2 += (double)values[i] * values[i];
+	}
+	double mean = sum / count;
+	double limit = sigma * sqrt(fmax(sum2 / count - mean * mean, 0));
+	sum = 0;
+	int used = 0;
+	for (int i = 0; i < count; i++) {
+		if (fabs(values[i] - median) <= limit) {
+			sum += values[i];
+			used++;
+		}
+	}
+	return used ? sum / used : median;
+}
+
+/* collected frames are detached from the context, so the next master frame can be collected while this one is combined */
+
+typedef struct {
+	indigo_calibration *calibration;
+	indigo_calibration_frame *frame;
+	uint16_t *stack;
+	int count;
+	double sigma;
+	char dir[INDIGO_VALUE_SIZE];
+	char instrument[INDIGO_NAME_SIZE];
+	indigo_calibration_callback callback;
+	void *callback_data;
+} master_build;
+
+static master_build *take_build(indigo_calibration *calibration, const char *dir, const char *instrument) {
+	pthread_mutex_lock(&calibration->mutex);
+	if (calibration->build_type == INDIGO_CALIBRATION_NONE || calibration->build_stack == NULL || calibration->build_collected == 0) {
+		pthread_mutex_unlock(&calibration->mutex);
+		return NULL;
+	}
+	master_build *build = malloc(sizeof(master_build));
+	indigo_calibration_frame *frame = malloc(sizeof(indigo_calibration_frame));
+	if (build == NULL || frame == NULL) {
+		if (build)
+			free(build);
+		if (frame)
+			free(frame);
+		pthread_mutex_unlock(&calibration->mutex);
+		return NULL;
+	}
+	memset(build, 0, sizeof(master_build));
+	memset(frame, 0, sizeof(indigo_calibration_frame));
+	frame->type = calibration->build_type;
+	frame->width = calibration->build_width;
+	frame->height = calibration->build_height;
+	frame->channels = calibration->build_channels;
+	frame->bin_x = calibration->build_bin_x;
+	frame->bin_y = calibration->build_bin_y;
+	frame->exposure = frame->type == INDIGO_CALIBRATION_BIAS ? 0 : calibration->build_exposure;
+	frame->temperature = calibration->build_temperature / calibration->build_collected;
+	build->calibration = calibration;
+	build->frame = frame;
+	build->stack = calibration->build_stack;
+	build->count = calibration->build_collected;
+	build->sigma = calibration->build_sigma;
+	strncpy(build->dir, dir, sizeof(build->dir) - 1);
+	strncpy(build->instrument, instrument, sizeof(build->instrument) - 1);
+	calibration->build_stack = NULL;
+	calibration->build_type = INDIGO_CALIBRATION_NONE;
+	calibration->build_count = calibration->build_collected = 0;
+	pthread_mutex_unlock(&calibration->mutex);
+	return build;
+}
+
+static bool combine_build(master_build *build, char *file_name, int file_name_size) {
+	indigo_calibration *calibration = build->calibration;
+	indigo_calibration_frame *frame = build->frame;
+	INDIGO_DEBUG(clock_t start = clock());
+	int count = build->count;
+	long samples = (long)frame->width * frame->height * frame->channels;
+	float *data = malloc(samples * sizeof(float));
+	if (data == NULL) {
+		free(frame);
+		free(build->stack);
+		return false;
+	}
+	uint16_t values[INDIGO_CALIBRATION_MAX_STACK];
+	for (long i = 0; i < samples; i++) {
+		for (int j = 0; j < count; j++)
+			values[j] = build->stack[j * samples + i];
+		data[i] = combine(values, count, build->sigma);
+	}
+	free(build->stack);
+	build->stack = NULL;
+	pthread_mutex_lock(&calibration->mutex);
+	if (frame->type == INDIGO_CALIBRATION_FLAT) {
+		// remove bias or dark flat signal from master flat
+		indigo_calibration_frame *bias = find_best(calibration, INDIGO_CALIBRATION_BIAS, frame->width, frame->height, frame->channels, frame->bin_x, frame->bin_y, frame->exposure, frame->temperature);
+		indigo_calibration_frame *dark = find_best(calibration, INDIGO_CALIBRATION_DARK, frame->width, frame->height, frame->channels, frame->bin_x, frame->bin_y, frame->exposure, frame->temperature);
+		if ((bias && load_data(bias)) | (dark && load_data(dark))) {
+			float *offset = malloc(samples * sizeof(float));
+			if (offset) {
+				compute_offset(bias && bias->data ? bias : NULL, dark && dark->data ? dark : NULL, frame->exposure, samples, offset);
+				for (long i = 0; i < samples; i++)
+					data[i] -= offset[i];
+				free(offset);
+			}
+		}
+	}
+	pthread_mutex_unlock(&calibration->mutex);
+	frame->data = data;
+	char temperature[32] = "";
+	if (!isnan(frame->temperature))
+		snprintf(temperature, sizeof(temperature), "_%.0fC", frame->temperature);
+	const char *dir = build->dir;
+	snprintf(frame->file_name, sizeof(frame->file_name), "%s%sMaster_%s_%dx%d_%dx%d_%gs%s.fits", dir, *dir && dir[strlen(dir) - 1] == '/' ? "" : "/", type_names[frame->type], frame->width, frame->height, frame->bin_x, frame->bin_y, frame->exposure, temperature);
+	bool result = save_frame(frame, build->instrument, count);
+	if (result) {
+		pthread_mutex_lock(&calibration->mutex);
+		indigo_calibration_frame **previous = &calibration->frames;
+		while (*previous) {
+			indigo_calibration_frame *old = *previous;
+			if (!strcmp(old->file_name, frame->file_name)) {
+				*previous = old->next;
+				if (old->data)
+					free(old->data);
+				free(old);
+			} else {
+				previous = &old->next;
+			}
+		}
+		reset_selection(calibration);
+		frame->next = calibration->frames;
+		calibration->frames = frame;
+		pthread_mutex_unlock(&calibration->mutex);
+		if (file_name && file_name_size > 0) {
+			strncpy(file_name, frame->file_name, file_name_size - 1);
+			file_name[file_name_size - 1] = 0;
+		}
+	} else {
+		free(frame->data);
+		free(frame);
+	}
+	INDIGO_DEBUG(indigo_debug("Master frame of %d frames combined in %gs", count, (clock() - start) / (double)CLOCKS_PER_SEC));
+	return result;
+}
+
+bool indigo_calibration_finish_master(indigo_calibration *calibration, const char *dir, const char *instrument, char *file_name, int file_name_size) {
+	master_build *build = take_build(calibration, dir, instrument);
+	if (build == NULL)
+		return false;
+	bool result = combine_build(build, file_name, file_name_size);
+	free(build);
+	return result;
+}
+
+static void *combine_thread(void *data) {
+	master_build *build = data;
+	char file_name[INDIGO_VALUE_SIZE] = "";
+	bool result = combine_build(build, file_name, sizeof(file_name));
+	build->callback(build->callback_data, result, file_name);
+	free(build);
+	return NULL;
+}
+
+bool indigo_calibration_finish_master_async(indigo_calibration *calibration, const char *dir, const char *instrument, indigo_calibration_callback callback, void *callback_data) {
+	master_build *build = take_build(calibration, dir, instrument);
+	if (build == NULL)
+		return false;
+	build->callback = callback;
+	build->callback_data = callback_data;
+	// only one master frame is combined at a time, previous one is usually done long before next set is collected
+	indigo_calibration_wait_master(calibration);
+	pthread_mutex_lock(&calibration->mutex);
+	calibration->combine_thread_started = pthread_create(&calibration->combine_thread, NULL, combine_thread, build) == 0;
+	bool result = calibration->combine_thread_started;
+	pthread_mutex_unlock(&calibration->mutex);
+	if (!result) {
+		free(build->stack);
+		free(build->frame);
+		free(build);
+	}
+	return result;
+}
+
+void indigo_calibration_wait_master(indigo_calibration *calibration) {
+	if (calibration == NULL)
+		return;
+	pthread_mutex_lock(&calibration->mutex);
+	bool started = calibration->combine_thread_started;
+	pthread_t thread = calibration->combine_thread;
+	calibration->combine_thread_started = false;
+	pthread_mutex_unlock(&calibration->mutex);
+	if (started && !pthread_equal(thread, pthread_self()))
+		pthread_join(thread, NULL);
+}
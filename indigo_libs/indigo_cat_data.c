@@ -19,19 +19,15 @@
 // version history
 // 2.0 by Peter Polakovic <peter.polakovic@cloudmakers.eu>
 
-/** INDIGO Mount control agent
+/** INDIGO star, DSO and constellation catalogue data
  \file indigo_cat_data.c
  */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <zlib.h>
-#include <stdarg.h>
 
-#include <indigo/indigo_server_tcp.h>
-#include <indigo/indigo_novas.h>
-#include "indigo_cat_data.h"
+#include <indigo/indigo_cat_data.h>
 
 indigo_star_entry indigo_star_data[] = {
 	{ 3, 0.0003, 38.8593, 5.24, -2.91, 2.81, 3e-06, 6.61, NULL },
@@ -41288,246 +41284,152 @@ indigo_dso_entry indigo_dso_data[] = {
 	{ NULL }
 };
 
+int indigo_constellation_lines[] = {
+	25428, 20889, 20455, 20205, 20894, 21421, 26451, 0,
+	114341, 113136, 112716, 112961, 111497, 110960, 110395, 109074, 106278, 102618, 0,
+	78384, 76297, 75264, 74376, 74395, 0,
+	71860, 73273, 75141, 75177, 0,
+	76297, 75141, 0,
+	76127, 75695, 76267, 76952, 77512, 78159, 0,
+	93747, 97649, 98036, 99473, 97804, 95501, 93747, 0,
+	97278, 97649, 95501, 93805, 0,
+	93174, 93825, 94114, 94160, 94005, 93542, 0,
+	76333, 74785, 72622, 73714, 0,
+	93506, 93864, 92855, 92041, 90496, 89931, 90185, 89642, 0,
+	89931, 88635, 0,
+	90496, 89341, 0,
+	92855, 93683, 94141, 0,
+	93683, 93085, 0,
+	7083, 6867, 2081, 5165, 7083, 0,
+	100751, 102395, 98495, 91792, 86929, 92609, 99240, 102395, 0,
+	98337, 97365, 96837, 0,
+	97365, 96757, 0,
+	81852, 81065, 80047, 72370, 0,
+	14879, 13147, 0,
+	42515, 42828, 43409, 0,
+	19893, 21281, 26069, 0,
+	75323, 71908, 74824, 0,
+	11767, 85822, 82080, 77055, 72607, 75097, 79822, 77055, 0,
+	7097, 8198, 9487, 8833, 7884, 7007, 5737, 4906, 3786, 118268, 116771, 115830, 114971, 0,
+	8796, 10064, 10670, 8796, 0,
+	64241, 64394, 60742, 0,
+	25859, 26634, 27628, 28199, 30277, 0,
+	67301, 65378, 62956, 59774, 58001, 53910, 54061, 59774, 0,
+	58001, 57399, 54539, 50801, 0,
+	54061, 46733, 41704, 0,
+	46733, 48319, 46853, 44127, 0,
+	74666, 72105, 69673, 71053, 71075, 73555, 74666, 0,
+	67927, 69673, 0,
+	101772, 102333, 103227, 100751, 0,
+	44816, 39953, 42913, 44816, 45941, 42913, 0,
+	110538, 111169, 110609, 111022, 110351, 0,
+	63121, 61317, 0,
+	28360, 28380, 25428, 23015, 23179, 23416, 24608, 28360, 0,
+	91262, 91971, 92420, 93194, 92791, 91971, 0,
+	45860, 45688, 44248, 41075, 0,
+	90422, 90568, 0,
+	92946, 89962, 88404, 88048, 86263, 84012, 0,
+	77450, 77233, 78072, 0,
+	77233, 76276, 77070, 77622, 79593, 0,
+	17440, 19780, 19921, 18772, 18597, 17440, 0,
+	24436, 24674, 25930, 25336, 0,
+	27366, 26727, 27989, 0,
+	26727, 26311, 25930, 0,
+	111954, 113368, 113246, 112948, 111188, 0,
+	14328, 15863, 17358, 18532, 18246, 0,
+	15863, 14576, 0,
+	40702, 51839, 52633, 0,
+	82273, 77952, 76440, 74946, 82273, 0,
+	44066, 42911, 42806, 43100, 0,
+	42911, 40526, 0,
+	8886, 6686, 4427, 3179, 746, 0,
+	9236, 17678, 2021, 0,
+	113881, 677, 1067, 113963, 0,
+	107315, 109427, 112029, 112447, 113963, 113881, 112158, 0,
+	45556, 48002, 45238, 50099, 52419, 51576, 50371, 45556, 41037, 30438, 0,
+	53229, 51233, 0,
+	100027, 100345, 101027, 102485, 102978, 104234, 105881, 106723, 107556, 106985, 105515, 104139, 100345, 0,
+	9640, 5447, 3092, 677, 0,
+	23522, 22783, 0,
+	68895, 64962, 57936, 56343, 54682, 53740, 52943, 51069, 49841, 48356, 46390, 47431, 45336, 43813, 43109, 42313, 42402, 42799, 43234, 43109, 0,
+	24305, 25985, 27288, 28103, 0,
+	25985, 25606, 0,
+	27654, 27072, 25606, 23685, 0,
+	47908, 48455, 50335, 50583, 49583, 49669, 54879, 57632, 54872, 50583, 0,
+	108085, 109111, 109908, 110997, 111043, 112122, 112623, 0,
+	109268, 111043, 0,
+	57380, 57757, 60129, 61941, 63090, 63608, 0,
+	61941, 64238, 66249, 0,
+	65474, 64238, 0,
+	44382, 41312, 35228, 34473, 37504, 0,
+	92175, 91117, 0,
+	94779, 95853, 97165, 100453, 102488, 104732, 0,
+	102098, 100453, 98110, 95947, 0,
+	78820, 80112, 78265, 0,
+	78401, 80112, 80763, 81266, 82396, 82514, 82729, 84143, 86228, 87073, 86670, 85927, 0,
+	87808, 85112, 84380, 81833, 81126, 79992, 0,
+	81833, 81693, 0,
+	84380, 83207, 0,
+	80170, 80816, 81693, 83207, 84379, 85693, 86974, 87933, 88794, 0,
+	59316, 59803, 60965, 61359, 59316, 0,
+	60718, 61084, 0,
+	62434, 59747, 0,
+	23875, 22109, 21444, 19587, 18543, 17378, 16537, 13701, 12770, 12843, 14146, 15474, 16611, 17651, 21393, 20535, 20042, 17797, 13847, 12486, 11407, 10602, 9007, 7588, 0,
+	55705, 54682, 53740, 55282, 55705, 0,
+	88048, 87108, 86742, 86032, 84345, 83000, 80883, 79593, 79882, 81377, 84012, 84970, 0,
+	31681, 34088, 35550, 37826, 36850, 32246, 30343, 29655, 0,
+	107089, 112405, 70638, 0,
+	37279, 36188, 0,
+	110130, 114996, 2484, 0,
+	87585, 85819, 85670, 87833, 87585, 94376, 97433, 89937, 83895, 80331, 78527, 75458, 68756, 61281, 56211, 0,
+	104987, 104858, 104521, 0,
+	30324, 32349, 33977, 34444, 33856, 33579, 30122, 0,
+	34444, 35904, 0,
+	12706, 14135, 0,
+	12828, 11484, 12706, 12387, 10826, 8645, 6537, 5364, 1562, 3419, 5364, 0,
+	8645, 8102, 0,
+	9884, 8903, 8832, 0,
+	101421, 101769, 102281, 102532, 101958, 101769, 0,
+	32768, 31685, 35264, 39429, 36377, 32768, 0,
+	39757, 38835, 38170, 37229, 36917, 35264, 0,
+	102422, 105199, 106032, 116727, 112724, 110991, 109492, 105199, 0,
+	32607, 27530, 27321, 0,
+	71683, 68702, 66657, 68002, 67472, 67464, 68933, 71352, 73334, 0,
+	66657, 61932, 59196, 0,
+	67464, 65109, 0,
+	80582, 80000, 0,
+	85727, 85267, 85258, 85792, 0,
+	83153, 83081, 82363, 0,
+	83081, 85258, 0,
+	37447, 34769, 30867, 29651, 0,
+	61585, 61199, 63613, 62322, 61585, 59929, 57363, 0,
+	0
+};
+
 static double h2deg(double ra) {
 	return ra > 12 ? (ra - 24) * 15 : ra * 15;
 }
 
-static void indigo_compress(char *name, char *buffer, unsigned size, unsigned char **data, unsigned *data_size) {
-	z_stream defstream;
-	defstream.zalloc = Z_NULL;
-	defstream.zfree = Z_NULL;
-	defstream.opaque = Z_NULL;
-	defstream.avail_in = size;
-	defstream.next_in = (Bytef *)buffer;
-	defstream.avail_out = *data_size;
-	defstream.next_out = (Bytef *)*data;
-	gz_header header = { 0 };
-	header.name = (Bytef *)name;
-	header.comment = Z_NULL;
-	header.extra = Z_NULL;
-	int r = deflateInit2(&defstream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 9, Z_DEFAULT_STRATEGY);
-	r = deflateSetHeader(&defstream, &header);
-	r = deflate(&defstream, Z_FINISH);
-	r = deflateEnd(&defstream);
-	*data_size = (unsigned)((unsigned char *)defstream.next_out - (unsigned char *)*data);
-	*data = realloc(*data, *data_size);
-}
-
-void *indigo_add_star_json_resource(int max_mag) {
-	int buffer_size = 1024 * 1024;
-	char *buffer =  malloc(buffer_size);
-	strcpy(buffer, "{\"type\":\"FeatureCollection\",\"features\": [");
-	unsigned size = (unsigned)strlen(buffer);
-	char *sep = "";
-	for (int i = 0; indigo_star_data[i].hip; i++) {
-		if (indigo_star_data[i].mag > max_mag)
-			continue;
-		double ra = indigo_star_data[i].ra;
-		double dec = indigo_star_data[i].dec;
-		indigo_app_star(indigo_star_data[i].promora, indigo_star_data[i].promodec, indigo_star_data[i].px, indigo_star_data[i].rv, &ra, &dec);
-    char desig[256] = "";
-    char *name = "";
-    if (indigo_star_data[i].name) {
-			strcpy(desig, indigo_star_data[i].name);
-      name = strrchr(desig, ',');
-      if (name) {
-        *name = 0;
-        name += 2;
-			} else {
-				name = "";
-			}
-    }
-		size += sprintf(buffer + size, "%s{\"type\":\"Feature\",\"id\":%d,\"properties\":{\"name\": \"%s\",\"desig\":\"%s\",\"mag\": %.2f,\"con\":\"\",\"bv\":0},\"geometry\":{\"type\":\"Point\",\"coordinates\":[%.4f,%.4f]}}", sep, indigo_star_data[i].hip, name, desig, indigo_star_data[i].mag, h2deg(indigo_star_data[i].ra = ra), indigo_star_data[i].dec = dec);
-		if (buffer_size - size < 1024) {
-			buffer = realloc(buffer, buffer_size *= 2);
-		}
-		sep = ",";
-	}
-	size += sprintf(buffer + size, "]}");
-	unsigned char *data = malloc(buffer_size);
-	unsigned data_size = buffer_size;
-	indigo_compress("stars.json", buffer, size, &data, &data_size);
-	free(buffer);
-	indigo_server_add_resource("/data/stars.json", data, (int)data_size, "application/json; charset=utf-8");
-	return data;
-}
-
-void *indigo_add_dso_json_resource(int max_mag) {
-	int buffer_size = 1024 * 1024;
-	char *buffer =  malloc(buffer_size);
-	strcpy(buffer, "{\"type\":\"FeatureCollection\",\"features\": [");
-	unsigned size = (unsigned)strlen(buffer);
-	char *sep = "";
-	for (int i = 0; indigo_dso_data[i].id; i++) {
-		if (indigo_dso_data[i].mag > max_mag)
-			continue;
-		double ra = indigo_dso_data[i].ra;
-		double dec = indigo_dso_data[i].dec;
-		indigo_app_star(0, 0, 0, 0, &ra, &dec);
-		size += sprintf(buffer + size, "%s{\"type\":\"Feature\",\"id\":\"%s\",\"properties\":{\"name\": \"%s\",\"desig\": \"%s\",\"type\":\"oc\",\"mag\": %.2f},\"geometry\":{\"type\":\"Point\",\"coordinates\":[%.4f,%.4f]}}", sep, indigo_dso_data[i].id, indigo_dso_data[i].id, indigo_dso_data[i].name, indigo_dso_data[i].mag, h2deg(indigo_dso_data[i].ra = ra), indigo_dso_data[i].dec = dec);
-		if (buffer_size - size < 1024) {
-			buffer = realloc(buffer, buffer_size *= 2);
+int indigo_cat_star_feature(char *buffer, indigo_star_entry *star, double ra, double dec) {
+	char desig[256] = "";
+	char *name = "";
+	if (star->name) {
+		strcpy(desig, star->name);
+		name = strrchr(desig, ',');
+		if (name) {
+			*name = 0;
+			name += 2;
+		} else {
+			name = "";
 		}
-		sep = ",";
 	}
-	size += sprintf(buffer + size, "]}");
-	unsigned char *data = malloc(buffer_size);
-	unsigned data_size = buffer_size;
-	indigo_compress("stars.json", buffer, size, &data, &data_size);
-	free(buffer);
-	indigo_server_add_resource("/data/dsos.json", data, (int)data_size, "application/json; charset=utf-8");
-	return data;
+	return sprintf(buffer, "{\"type\":\"Feature\",\"id\":%d,\"properties\":{\"name\": \"%s\",\"desig\":\"%s\",\"mag\": %.2f,\"con\":\"\",\"bv\":0},\"geometry\":{\"type\":\"Point\",\"coordinates\":[%.4f,%.4f]}}", star->hip, name, desig, star->mag, h2deg(ra), dec);
 }
 
-static int add_multiline(char *buffer, ...) {
-	int size = 0;
-	va_list ap;
-	va_start(ap, buffer);
-	char *sep = "";
-	static char *sep2 = "";
-	size += sprintf(buffer, "%s[", sep2);
-	sep2 = ",";
-	for (int hip = va_arg(ap, int); hip; hip = va_arg(ap, int)) {
-		for (int i = 0; indigo_star_data[i].hip; i++) {
-			if (indigo_star_data[i].hip == hip) {
-				size += sprintf(buffer + size, "%s[%.4f,%.4f]", sep, h2deg(indigo_star_data[i].ra), indigo_star_data[i].dec);
-				sep = ",";
-				break;
-			}
-		}
-	}
-	size += sprintf(buffer + size, "]");
-	return size;
+int indigo_cat_dso_feature(char *buffer, indigo_dso_entry *dso, double ra, double dec) {
+	return sprintf(buffer, "{\"type\":\"Feature\",\"id\":\"%s\",\"properties\":{\"name\": \"%s\",\"desig\": \"%s\",\"type\":\"oc\",\"mag\": %.2f},\"geometry\":{\"type\":\"Point\",\"coordinates\":[%.4f,%.4f]}}", dso->id, dso->id, dso->name, dso->mag, h2deg(ra), dec);
 }
 
-void *indigo_add_constellations_lines_json_resource() {
-	int buffer_size = 1024 * 1024;
-	char *buffer =  malloc(buffer_size);
-	strcpy(buffer, "{\"type\":\"FeatureCollection\",\"features\":[{\"type\":\"Feature\",\"id\":\"Const\",\"properties\":{},\"geometry\":{\"type\":\"MultiLineString\",\"coordinates\":[");
-	unsigned size = (unsigned)strlen(buffer);
-	size += add_multiline(buffer + size, 25428, 20889, 20455, 20205, 20894, 21421, 26451, 0);
-	size += add_multiline(buffer + size, 114341, 113136, 112716, 112961, 111497, 110960, 110395, 109074, 106278, 102618, 0);
-	size += add_multiline(buffer + size, 78384, 76297, 75264, 74376, 74395, 0);
-	size += add_multiline(buffer + size, 71860, 73273, 75141, 75177, 0);
-	size += add_multiline(buffer + size, 76297, 75141, 0);
-	size += add_multiline(buffer + size, 76127, 75695, 76267, 76952, 77512, 78159, 0);
-	size += add_multiline(buffer + size, 93747, 97649, 98036, 99473, 97804, 95501, 93747, 0);
-	size += add_multiline(buffer + size, 97278, 97649, 95501, 93805, 0);
-	size += add_multiline(buffer + size, 93174, 93825, 94114, 94160, 94005, 93542, 0);
-	size += add_multiline(buffer + size, 76333, 74785, 72622, 73714, 0);
-	size += add_multiline(buffer + size, 93506, 93864, 92855, 92041, 90496, 89931, 90185, 89642, 0);
-	size += add_multiline(buffer + size, 89931, 88635, 0);
-	size += add_multiline(buffer + size, 90496, 89341, 0);
-	size += add_multiline(buffer + size, 92855, 93683, 94141, 0);
-	size += add_multiline(buffer + size, 93683, 93085, 0);
-	size += add_multiline(buffer + size, 7083, 6867, 2081, 5165, 7083, 0);
-	size += add_multiline(buffer + size, 100751, 102395, 98495, 91792, 86929, 92609, 99240, 102395, 0);
-	size += add_multiline(buffer + size, 98337, 97365, 96837, 0);
-	size += add_multiline(buffer + size, 97365, 96757, 0);
-	size += add_multiline(buffer + size, 81852, 81065, 80047, 72370, 0);
-	size += add_multiline(buffer + size, 14879, 13147, 0);
-	size += add_multiline(buffer + size, 42515, 42828, 43409, 0);
-	size += add_multiline(buffer + size, 19893, 21281, 26069, 0);
-	size += add_multiline(buffer + size, 75323, 71908, 74824, 0);
-	size += add_multiline(buffer + size, 11767, 85822, 82080, 77055, 72607, 75097, 79822, 77055, 0);
-	size += add_multiline(buffer + size, 7097, 8198, 9487, 8833, 7884, 7007, 5737, 4906, 3786, 118268, 116771, 115830, 114971, 0);
-	size += add_multiline(buffer + size, 8796, 10064, 10670, 8796, 0);
-	size += add_multiline(buffer + size, 64241, 64394, 60742, 0);
-	size += add_multiline(buffer + size, 25859, 26634, 27628, 28199, 30277, 0);
-	size += add_multiline(buffer + size, 67301, 65378, 62956, 59774, 58001, 53910, 54061, 59774, 0);
-	size += add_multiline(buffer + size, 58001, 57399, 54539, 50801, 0);
-	size += add_multiline(buffer + size, 54061, 46733, 41704, 0);
-	size += add_multiline(buffer + size, 46733, 48319, 46853, 44127, 0);
-	size += add_multiline(buffer + size, 74666, 72105, 69673, 71053, 71075, 73555, 74666, 0);
-	size += add_multiline(buffer + size, 67927, 69673, 0);
-	size += add_multiline(buffer + size, 101772, 102333, 103227, 100751, 0);
-	size += add_multiline(buffer + size, 44816, 39953, 42913, 44816, 45941, 42913, 0);
-	size += add_multiline(buffer + size, 110538, 111169, 110609, 111022, 110351, 0);
-	size += add_multiline(buffer + size, 63121, 61317, 0);
-	size += add_multiline(buffer + size, 28360, 28380, 25428, 23015, 23179, 23416, 24608, 28360, 0);
-	size += add_multiline(buffer + size, 91262, 91971, 92420, 93194, 92791, 91971, 0);
-	size += add_multiline(buffer + size, 45860, 45688, 44248, 41075, 0);
-	size += add_multiline(buffer + size, 90422, 90568, 0);
-	size += add_multiline(buffer + size, 92946, 89962, 88404, 88048, 86263, 84012, 0);
-	size += add_multiline(buffer + size, 77450, 77233, 78072, 0);
-	size += add_multiline(buffer + size, 77233, 76276, 77070, 77622, 79593, 0);
-	size += add_multiline(buffer + size, 17440, 19780, 19921, 18772, 18597, 17440, 0);
-	size += add_multiline(buffer + size, 24436, 24674, 25930, 25336, 0);
-	size += add_multiline(buffer + size, 27366, 26727, 27989, 0);
-	size += add_multiline(buffer + size, 26727, 26311, 25930, 0);
-	size += add_multiline(buffer + size, 111954, 113368, 113246, 112948, 111188, 0);
-	size += add_multiline(buffer + size, 14328, 15863, 17358, 18532, 18246, 0);
-	size += add_multiline(buffer + size, 15863, 14576, 0);
-	size += add_multiline(buffer + size, 40702, 51839, 52633, 0);
-	size += add_multiline(buffer + size, 82273, 77952, 76440, 74946, 82273, 0);
-	size += add_multiline(buffer + size, 44066, 42911, 42806, 43100, 0);
-	size += add_multiline(buffer + size, 42911, 40526, 0);
-	size += add_multiline(buffer + size, 8886, 6686, 4427, 3179, 746, 0);
-	size += add_multiline(buffer + size, 9236, 17678, 2021, 0);
-	size += add_multiline(buffer + size, 113881, 677, 1067, 113963, 0);
-	size += add_multiline(buffer + size, 107315, 109427, 112029, 112447, 113963, 113881, 112158, 0);
-	size += add_multiline(buffer + size, 45556, 48002, 45238, 50099, 52419, 51576, 50371, 45556, 41037, 30438, 0);
-	size += add_multiline(buffer + size, 53229, 51233, 0);
-	size += add_multiline(buffer + size, 100027, 100345, 101027, 102485, 102978, 104234, 105881, 106723, 107556, 106985, 105515, 104139, 100345, 0);
-	size += add_multiline(buffer + size, 9640, 5447, 3092, 677, 0);
-	size += add_multiline(buffer + size, 23522, 22783, 0);
-	size += add_multiline(buffer + size, 68895, 64962, 57936, 56343, 54682, 53740, 52943, 51069, 49841, 48356, 46390, 47431, 45336, 43813, 43109, 42313, 42402, 42799, 43234, 43109, 0);
-	size += add_multiline(buffer + size, 24305, 25985, 27288, 28103, 0);
-	size += add_multiline(buffer + size, 25985, 25606, 0);
-	size += add_multiline(buffer + size, 27654, 27072, 25606, 23685, 0);
-	size += add_multiline(buffer + size, 47908, 48455, 50335, 50583, 49583, 49669, 54879, 57632, 54872, 50583, 0);
-	size += add_multiline(buffer + size, 108085, 109111, 109908, 110997, 111043, 112122, 112623, 0);
-	size += add_multiline(buffer + size, 109268, 111043, 0);
-	size += add_multiline(buffer + size, 57380, 57757, 60129, 61941, 63090, 63608, 0);
-	size += add_multiline(buffer + size, 61941, 64238, 66249, 0);
-	size += add_multiline(buffer + size, 65474, 64238, 0);
-	size += add_multiline(buffer + size, 44382, 41312, 35228, 34473, 37504, 0);
-	size += add_multiline(buffer + size, 92175, 91117, 0);
-	size += add_multiline(buffer + size, 94779, 95853, 97165, 100453, 102488, 104732, 0);
-	size += add_multiline(buffer + size, 102098, 100453, 98110, 95947, 0);
-	size += add_multiline(buffer + size, 78820, 80112, 78265, 0);
-	size += add_multiline(buffer + size, 78401, 80112, 80763, 81266, 82396, 82514, 82729, 84143, 86228, 87073, 86670, 85927, 0);
-	size += add_multiline(buffer + size, 87808, 85112, 84380, 81833, 81126, 79992, 0);
-	size += add_multiline(buffer + size, 81833, 81693, 0);
-	size += add_multiline(buffer + size, 84380, 83207, 0);
-	size += add_multiline(buffer + size, 80170, 80816, 81693, 83207, 84379, 85693, 86974, 87933, 88794, 0);
-	size += add_multiline(buffer + size, 59316, 59803, 60965, 61359, 59316, 0);
-	size += add_multiline(buffer + size, 60718, 61084, 0);
-	size += add_multiline(buffer + size, 62434, 59747, 0);
-	size += add_multiline(buffer + size, 23875, 22109, 21444, 19587, 18543, 17378, 16537, 13701, 12770, 12843, 14146, 15474, 16611, 17651, 21393, 20535, 20042, 17797, 13847, 12486, 11407, 10602, 9007, 7588, 0);
-	size += add_multiline(buffer + size, 55705, 54682, 53740, 55282, 55705, 0);
-	size += add_multiline(buffer + size, 88048, 87108, 86742, 86032, 84345, 83000, 80883, 79593, 79882, 81377, 84012, 84970, 0);
-	size += add_multiline(buffer + size, 31681, 34088, 35550, 37826, 36850, 32246, 30343, 29655, 0);
-	size += add_multiline(buffer + size, 107089, 112405, 70638, 0);
-	size += add_multiline(buffer + size, 37279, 36188, 0);
-	size += add_multiline(buffer + size, 110130, 114996, 2484, 0);
-	size += add_multiline(buffer + size, 87585, 85819, 85670, 87833, 87585, 94376, 97433, 89937, 83895, 80331, 78527, 75458, 68756, 61281, 56211, 0);
-	size += add_multiline(buffer + size, 104987, 104858, 104521, 0);
-	size += add_multiline(buffer + size, 30324, 32349, 33977, 34444, 33856, 33579, 30122, 0);
-	size += add_multiline(buffer + size, 34444, 35904, 0);
-	size += add_multiline(buffer + size, 12706, 14135, 0);
-	size += add_multiline(buffer + size, 12828, 11484, 12706, 12387, 10826, 8645, 6537, 5364, 1562, 3419, 5364, 0);
-	size += add_multiline(buffer + size, 8645, 8102, 0);
-	size += add_multiline(buffer + size, 9884, 8903, 8832, 0);
-	size += add_multiline(buffer + size, 101421, 101769, 102281, 102532, 101958, 101769, 0);
-	size += add_multiline(buffer + size, 32768, 31685, 35264, 39429, 36377, 32768, 0);
-	size += add_multiline(buffer + size, 39757, 38835, 38170, 37229, 36917, 35264, 0);
-	size += add_multiline(buffer + size, 102422, 105199, 106032, 116727, 112724, 110991, 109492, 105199, 0);
-	size += add_multiline(buffer + size, 32607, 27530, 27321, 0);
-	size += add_multiline(buffer + size, 71683, 68702, 66657, 68002, 67472, 67464, 68933, 71352, 73334, 0);
-	size += add_multiline(buffer + size, 66657, 61932, 59196, 0);
-	size += add_multiline(buffer + size, 67464, 65109, 0);
-	size += add_multiline(buffer + size, 80582, 80000, 0);
-	size += add_multiline(buffer + size, 85727, 85267, 85258, 85792, 0);
-	size += add_multiline(buffer + size, 83153, 83081, 82363, 0);
-	size += add_multiline(buffer + size, 83081, 85258, 0);
-	size += add_multiline(buffer + size, 37447, 34769, 30867, 29651, 0);
-	size += add_multiline(buffer + size, 61585, 61199, 63613, 62322, 61585, 59929, 57363, 0);
-	size += sprintf(buffer + size, "]}}]}");
-	unsigned char *data = malloc(buffer_size);
-	unsigned data_size = buffer_size;
-	indigo_compress("constellations.lines.json", buffer, size, &data, &data_size);
-	free(buffer);
-	indigo_server_add_resource("/data/constellations.lines.json", data, (int)data_size, "application/json; charset=utf-8");
-	return data;
+int indigo_cat_line_vertex(char *buffer, double ra, double dec) {
+	return sprintf(buffer, "[%.4f,%.4f]", h2deg(ra), dec);
 }
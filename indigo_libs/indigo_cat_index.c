@@ -0,0 +1,190 @@
+// Copyright (c) 2020 CloudMakers, s. r. o.
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// version history
+// 2.0 by Peter Polakovic <peter.polakovic@cloudmakers.eu>
+
+/** INDIGO star and DSO catalogue spatial index
+ \file indigo_cat_index.c
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+#include <indigo/indigo_bus.h>
+#include <indigo/indigo_cat_index.h>
+#include <indigo/indigo_sky_index.h>
+
+// HEALPix RING scheme, ~3.7° pixels, ~15 Hipparcos stars per pixel
+#define NSIDE		16
+
+#define DEG2RAD	(M_PI / 180.0)
+
+typedef struct {
+	int entry;
+	float mag;
+} match;
+
+static pthread_mutex_t index_mutex = PTHREAD_MUTEX_INITIALIZER;
+static indigo_star_entry *star_data = NULL;
+static indigo_dso_entry *dso_data = NULL;
+static indigo_sky_index star_index = { 0 };
+static indigo_sky_index dso_index = { 0 };
+static int *hip_table = NULL;
+static int hip_max = 0;
+
+static bool build_index(indigo_sky_index *index, int count, const double *ra, const double *dec, const float *mags) {
+	double (*vectors)[3] = malloc((count + 1) * sizeof(double[3]));
+	if (vectors == NULL)
+		return false;
+	for (int i = 0; i < count; i++)
+		indigo_sky_vector(ra[i] * 15 * DEG2RAD, dec[i] * DEG2RAD, vectors[i]);
+	bool result = indigo_sky_index_build(index, NSIDE, count, (const double (*)[3])vectors, mags);
+	free(vectors);
+	return result;
+}
+
+static int compare_matches(const void *a, const void *b) {
+	float ma = ((const match *)a)->mag;
+	float mb = ((const match *)b)->mag;
+	return ma < mb ? -1 : ma > mb ? 1 : 0;
+}
+
+static int cone_search(indigo_sky_index *index, double ra, double dec, double radius, double max_mag, match **matches) {
+	double center[3];
+	indigo_sky_vector(ra * 15 * DEG2RAD, dec * DEG2RAD, center);
+	int *entries = NULL, size = 0;
+	int count = indigo_sky_index_search(index, center, radius * DEG2RAD, max_mag, &entries, &size);
+	match *result = malloc((count + 1) * sizeof(match));
+	for (int i = 0; i < count; i++) {
+		result[i].entry = entries[i];
+		result[i].mag = index->mags[entries[i]];
+	}
+	free(entries);
+	qsort(result, count, sizeof(match), compare_matches);
+	*matches = result;
+	return count;
+}
+
+bool indigo_cat_index_build(indigo_star_entry *stars, indigo_dso_entry *dsos) {
+	pthread_mutex_lock(&index_mutex);
+	indigo_sky_index_release(&star_index);
+	indigo_sky_index_release(&dso_index);
+	free(hip_table);
+	hip_table = NULL;
+	hip_max = 0;
+	bool result = true;
+	star_data = stars;
+	dso_data = dsos;
+	if (stars) {
+		int count = 0;
+		while (stars[count].hip) {
+			if (stars[count].hip > hip_max)
+				hip_max = stars[count].hip;
+			count++;
+		}
+		double *ra = malloc((count + 1) * sizeof(double)), *dec = malloc((count + 1) * sizeof(double));
+		float *mag = malloc((count + 1) * sizeof(float));
+		for (int i = 0; i < count; i++) {
+			ra[i] = stars[i].ra;
+			dec[i] = stars[i].dec;
+			mag[i] = stars[i].mag;
+		}
+		result = build_index(&star_index, count, ra, dec, mag);
+		free(ra);
+		free(dec);
+		free(mag);
+		hip_table = malloc((hip_max + 1) * sizeof(int));
+		for (int i = 0; i <= hip_max; i++)
+			hip_table[i] = -1;
+		for (int i = 0; i < count; i++)
+			hip_table[stars[i].hip] = i;
+	}
+	if (dsos && result) {
+		int count = 0;
+		while (dsos[count].id)
+			count++;
+		double *ra = malloc((count + 1) * sizeof(double)), *dec = malloc((count + 1) * sizeof(double));
+		float *mag = malloc((count + 1) * sizeof(float));
+		for (int i = 0; i < count; i++) {
+			ra[i] = dsos[i].ra;
+			dec[i] = dsos[i].dec;
+			mag[i] = dsos[i].mag;
+		}
+		result = build_index(&dso_index, count, ra, dec, mag);
+		free(ra);
+		free(dec);
+		free(mag);
+	}
+	if (result) {
+		INDIGO_DEBUG(indigo_debug("Catalogue index: %d stars, %d DSOs, %d pixels", star_index.count, dso_index.count, 12 * NSIDE * NSIDE));
+	} else {
+		INDIGO_ERROR(indigo_error("Failed to build catalogue index"));
+	}
+	pthread_mutex_unlock(&index_mutex);
+	return result;
+}
+
+void indigo_cat_index_release(void) {
+	pthread_mutex_lock(&index_mutex);
+	indigo_sky_index_release(&star_index);
+	indigo_sky_index_release(&dso_index);
+	free(hip_table);
+	hip_table = NULL;
+	hip_max = 0;
+	star_data = NULL;
+	dso_data = NULL;
+	pthread_mutex_unlock(&index_mutex);
+}
+
+indigo_star_entry *indigo_cat_star_by_hip(int hip) {
+	indigo_star_entry *result = NULL;
+	pthread_mutex_lock(&index_mutex);
+	if (hip_table != NULL && hip > 0 && hip <= hip_max && hip_table[hip] >= 0)
+		result = star_data + hip_table[hip];
+	pthread_mutex_unlock(&index_mutex);
+	return result;
+}
+
+int indigo_cat_stars_in_cone(double ra, double dec, double radius, double max_mag, indigo_star_entry **result, int max_count) {
+	pthread_mutex_lock(&index_mutex);
+	match *matches;
+	int count = cone_search(&star_index, ra, dec, radius, max_mag, &matches);
+	if (count > max_count)
+		count = max_count;
+	for (int i = 0; i < count; i++)
+		result[i] = star_data + matches[i].entry;
+	free(matches);
+	pthread_mutex_unlock(&index_mutex);
+	return count;
+}
+
+int indigo_cat_dsos_in_cone(double ra, double dec, double radius, double max_mag, indigo_dso_entry **result, int max_count) {
+	pthread_mutex_lock(&index_mutex);
+	match *matches;
+	int count = cone_search(&dso_index, ra, dec, radius, max_mag, &matches);
+	if (count > max_count)
+		count = max_count;
+	for (int i = 0; i < count; i++)
+		result[i] = dso_data + matches[i].entry;
+	free(matches);
+	pthread_mutex_unlock(&index_mutex);
+	return count;
+}
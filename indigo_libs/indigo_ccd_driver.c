@@ -41,6 +41,18 @@
 #include <indigo/indigo_tiff.h>
 #include <indigo/indigo_avi.h>
 #include <indigo/indigo_ser.h>
+#include <indigo/indigo_calibration.h>
+#include <indigo/indigo_metrics.h>
+
+//  Exposure start and end are taken from shutter stamps made by the driver, otherwise end is the time when frame was handed over for processing
+//  and start is derived from exposure time. Only stamped times taken from disciplined clock are written with milliseconds.
+
+typedef struct {
+	double start, end;
+	bool start_precise, end_precise;
+} exposure_time;
+
+static void stream_exposure_time(indigo_device *device, exposure_time *time);
 
 static void countdown_timer_callback(indigo_device *device) {
 	if (CCD_CONTEXT->countdown_enabled && CCD_EXPOSURE_PROPERTY->state == INDIGO_BUSY_STATE && CCD_EXPOSURE_ITEM->number.value >= 1) {
@@ -270,6 +282,45 @@ indigo_result indigo_ccd_attach(indigo_device *device, const char* driver_name,
 			CCD_RBI_FLUSH_PROPERTY->hidden = true;
 			indigo_init_number_item(CCD_RBI_FLUSH_EXPOSURE_ITEM, CCD_RBI_FLUSH_EXPOSURE_ITEM_NAME, "NIR flood time (s)", 0, 16, 0, 1);
 			indigo_init_number_item(CCD_RBI_FLUSH_COUNT_ITEM, CCD_RBI_FLUSH_COUNT_ITEM_NAME, "Number of flushes", 1, 10, 1, 3);
+			// -------------------------------------------------------------------------------- CCD_CALIBRATION
+			CCD_CALIBRATION_PROPERTY = indigo_init_switch_property(NULL, device->name, CCD_CALIBRATION_PROPERTY_NAME, CCD_CALIBRATION_GROUP, "Calibration", INDIGO_OK_STATE, INDIGO_RW_PERM, INDIGO_ONE_OF_MANY_RULE, 2);
+			if (CCD_CALIBRATION_PROPERTY == NULL)
+				return INDIGO_FAILED;
+			indigo_init_switch_item(CCD_CALIBRATION_ENABLED_ITEM, CCD_CALIBRATION_ENABLED_ITEM_NAME, "Enabled", false);
+			indigo_init_switch_item(CCD_CALIBRATION_DISABLED_ITEM, CCD_CALIBRATION_DISABLED_ITEM_NAME, "Disabled", true);
+			// -------------------------------------------------------------------------------- CCD_CALIBRATION_LIBRARY
+			CCD_CALIBRATION_LIBRARY_PROPERTY = indigo_init_text_property(NULL, device->name, CCD_CALIBRATION_LIBRARY_PROPERTY_NAME, CCD_CALIBRATION_GROUP, "Master frame library", INDIGO_OK_STATE, INDIGO_RW_PERM, 1);
+			if (CCD_CALIBRATION_LIBRARY_PROPERTY == NULL)
+				return INDIGO_FAILED;
+			indigo_init_text_item(CCD_CALIBRATION_LIBRARY_DIR_ITEM, CCD_CALIBRATION_LIBRARY_DIR_ITEM_NAME, "Directory", "%s/", getenv("HOME"));
+			// -------------------------------------------------------------------------------- CCD_CALIBRATION_MASTERS
+			CCD_CALIBRATION_MASTERS_PROPERTY = indigo_init_text_property(NULL, device->name, CCD_CALIBRATION_MASTERS_PROPERTY_NAME, CCD_CALIBRATION_GROUP, "Selected master frames", INDIGO_OK_STATE, INDIGO_RO_PERM, 3);
+			if (CCD_CALIBRATION_MASTERS_PROPERTY == NULL)
+				return INDIGO_FAILED;
+			indigo_init_text_item(CCD_CALIBRATION_MASTERS_BIAS_ITEM, CCD_CALIBRATION_MASTERS_BIAS_ITEM_NAME, "Bias", "None");
+			indigo_init_text_item(CCD_CALIBRATION_MASTERS_DARK_ITEM, CCD_CALIBRATION_MASTERS_DARK_ITEM_NAME, "Dark", "None");
+			indigo_init_text_item(CCD_CALIBRATION_MASTERS_FLAT_ITEM, CCD_CALIBRATION_MASTERS_FLAT_ITEM_NAME, "Flat", "None");
+			// -------------------------------------------------------------------------------- CCD_CALIBRATION_BUILD
+			CCD_CALIBRATION_BUILD_PROPERTY = indigo_init_number_property(NULL, device->name, CCD_CALIBRATION_BUILD_PROPERTY_NAME, CCD_CALIBRATION_GROUP, "Build master frame", INDIGO_OK_STATE, INDIGO_RW_PERM, 2);
+			if (CCD_CALIBRATION_BUILD_PROPERTY == NULL)
+				return INDIGO_FAILED;
+			indigo_init_number_item(CCD_CALIBRATION_BUILD_COUNT_ITEM, CCD_CALIBRATION_BUILD_COUNT_ITEM_NAME, "Frame count (0 to abort)", 0, INDIGO_CALIBRATION_MAX_STACK, 1, 0);
+			indigo_init_number_item(CCD_CALIBRATION_BUILD_SIGMA_ITEM, CCD_CALIBRATION_BUILD_SIGMA_ITEM_NAME, "Sigma clipping (0 for median)", 0, 10, 0.1, 0);
+			CCD_CONTEXT->calibration = indigo_calibration_create();
+			// -------------------------------------------------------------------------------- CCD_STREAMING_BUFFER
+			CCD_STREAMING_BUFFER_PROPERTY = indigo_init_number_property(NULL, device->name, CCD_STREAMING_BUFFER_PROPERTY_NAME, CCD_MAIN_GROUP, "Streaming buffer", INDIGO_OK_STATE, INDIGO_RW_PERM, 1);
+			if (CCD_STREAMING_BUFFER_PROPERTY == NULL)
+				return INDIGO_FAILED;
+			CCD_STREAMING_BUFFER_PROPERTY->hidden = true;
+			indigo_init_number_item(CCD_STREAMING_BUFFER_FRAMES_ITEM, CCD_STREAMING_BUFFER_FRAMES_ITEM_NAME, "Frame buffers", 3, 64, 1, 4);
+			// -------------------------------------------------------------------------------- CCD_STREAMING_STATS
+			CCD_STREAMING_STATS_PROPERTY = indigo_init_number_property(NULL, device->name, CCD_STREAMING_STATS_PROPERTY_NAME, CCD_MAIN_GROUP, "Streaming statistics", INDIGO_OK_STATE, INDIGO_RO_PERM, 3);
+			if (CCD_STREAMING_STATS_PROPERTY == NULL)
+				return INDIGO_FAILED;
+			CCD_STREAMING_STATS_PROPERTY->hidden = true;
+			indigo_init_number_item(CCD_STREAMING_STATS_CAPTURED_ITEM, CCD_STREAMING_STATS_CAPTURED_ITEM_NAME, "Captured frames", 0, 0xFFFFFFFF, 0, 0);
+			indigo_init_number_item(CCD_STREAMING_STATS_PROCESSED_ITEM, CCD_STREAMING_STATS_PROCESSED_ITEM_NAME, "Processed frames", 0, 0xFFFFFFFF, 0, 0);
+			indigo_init_number_item(CCD_STREAMING_STATS_DROPPED_ITEM, CCD_STREAMING_STATS_DROPPED_ITEM_NAME, "Dropped frames", 0, 0xFFFFFFFF, 0, 0);
 			// --------------------------------------------------------------------------------
 			return INDIGO_OK;
 		}
@@ -335,6 +386,18 @@ indigo_result indigo_ccd_enumerate_properties(indigo_device *device, indigo_clie
 			indigo_define_property(device, CCD_RBI_FLUSH_ENABLE_PROPERTY, NULL);
 		if (indigo_property_match(CCD_RBI_FLUSH_PROPERTY, property))
 			indigo_define_property(device, CCD_RBI_FLUSH_PROPERTY, NULL);
+		if (indigo_property_match(CCD_CALIBRATION_PROPERTY, property))
+			indigo_define_property(device, CCD_CALIBRATION_PROPERTY, NULL);
+		if (indigo_property_match(CCD_CALIBRATION_LIBRARY_PROPERTY, property))
+			indigo_define_property(device, CCD_CALIBRATION_LIBRARY_PROPERTY, NULL);
+		if (indigo_property_match(CCD_CALIBRATION_MASTERS_PROPERTY, property))
+			indigo_define_property(device, CCD_CALIBRATION_MASTERS_PROPERTY, NULL);
+		if (indigo_property_match(CCD_CALIBRATION_BUILD_PROPERTY, property))
+			indigo_define_property(device, CCD_CALIBRATION_BUILD_PROPERTY, NULL);
+		if (indigo_property_match(CCD_STREAMING_BUFFER_PROPERTY, property))
+			indigo_define_property(device, CCD_STREAMING_BUFFER_PROPERTY, NULL);
+		if (indigo_property_match(CCD_STREAMING_STATS_PROPERTY, property))
+			indigo_define_property(device, CCD_STREAMING_STATS_PROPERTY, NULL);
 	}
 	return indigo_device_enumerate_properties(device, client, property);
 }
@@ -373,6 +436,13 @@ indigo_result indigo_ccd_change_property(indigo_device *device, indigo_client *c
 			indigo_define_property(device, CCD_JPEG_SETTINGS_PROPERTY, NULL);
 			indigo_define_property(device, CCD_RBI_FLUSH_ENABLE_PROPERTY, NULL);
 			indigo_define_property(device, CCD_RBI_FLUSH_PROPERTY, NULL);
+			indigo_calibration_scan(CCD_CONTEXT->calibration, CCD_CALIBRATION_LIBRARY_DIR_ITEM->text.value);
+			indigo_define_property(device, CCD_CALIBRATION_PROPERTY, NULL);
+			indigo_define_property(device, CCD_CALIBRATION_LIBRARY_PROPERTY, NULL);
+			indigo_define_property(device, CCD_CALIBRATION_MASTERS_PROPERTY, NULL);
+			indigo_define_property(device, CCD_CALIBRATION_BUILD_PROPERTY, NULL);
+			indigo_define_property(device, CCD_STREAMING_BUFFER_PROPERTY, NULL);
+			indigo_define_property(device, CCD_STREAMING_STATS_PROPERTY, NULL);
 		} else {
 			CCD_STREAMING_COUNT_ITEM->number.value = 0;
 			CCD_EXPOSURE_ITEM->number.value = 0;
@@ -408,6 +478,16 @@ indigo_result indigo_ccd_change_property(indigo_device *device, indigo_client *c
 			indigo_delete_property(device, CCD_JPEG_SETTINGS_PROPERTY, NULL);
 			indigo_delete_property(device, CCD_RBI_FLUSH_ENABLE_PROPERTY, NULL);
 			indigo_delete_property(device, CCD_RBI_FLUSH_PROPERTY, NULL);
+			if (CCD_CALIBRATION_BUILD_PROPERTY->state == INDIGO_BUSY_STATE) {
+				indigo_calibration_abort_master(CCD_CONTEXT->calibration);
+				CCD_CALIBRATION_BUILD_PROPERTY->state = INDIGO_OK_STATE;
+			}
+			indigo_delete_property(device, CCD_CALIBRATION_PROPERTY, NULL);
+			indigo_delete_property(device, CCD_CALIBRATION_LIBRARY_PROPERTY, NULL);
+			indigo_delete_property(device, CCD_CALIBRATION_MASTERS_PROPERTY, NULL);
+			indigo_delete_property(device, CCD_CALIBRATION_BUILD_PROPERTY, NULL);
+			indigo_delete_property(device, CCD_STREAMING_BUFFER_PROPERTY, NULL);
+			indigo_delete_property(device, CCD_STREAMING_STATS_PROPERTY, NULL);
 		}
 	} else if (indigo_property_match(CONFIG_PROPERTY, property)) {
 		// -------------------------------------------------------------------------------- CONFIG
@@ -427,6 +507,9 @@ indigo_result indigo_ccd_change_property(indigo_device *device, indigo_client *c
 			indigo_save_property(device, NULL, CCD_JPEG_SETTINGS_PROPERTY);
 			indigo_save_property(device, NULL, CCD_RBI_FLUSH_ENABLE_PROPERTY);
 			indigo_save_property(device, NULL, CCD_RBI_FLUSH_PROPERTY);
+			indigo_save_property(device, NULL, CCD_CALIBRATION_PROPERTY);
+			indigo_save_property(device, NULL, CCD_CALIBRATION_LIBRARY_PROPERTY);
+			indigo_save_property(device, NULL, CCD_STREAMING_BUFFER_PROPERTY);
 		}
 	} else if (indigo_property_match(CCD_LENS_PROPERTY, property)) {
 		indigo_property_copy_values(CCD_LENS_PROPERTY, property, false);
@@ -757,6 +840,63 @@ indigo_result indigo_ccd_change_property(indigo_device *device, indigo_client *c
 			indigo_update_property(device, CCD_RBI_FLUSH_PROPERTY, NULL);
 		}
 		return INDIGO_OK;
+	} else if (indigo_property_match(CCD_CALIBRATION_PROPERTY, property)) {
+		// -------------------------------------------------------------------------------- CCD_CALIBRATION
+		indigo_property_copy_values(CCD_CALIBRATION_PROPERTY, property, false);
+		CCD_CALIBRATION_PROPERTY->state = INDIGO_OK_STATE;
+		if (IS_CONNECTED)
+			indigo_update_property(device, CCD_CALIBRATION_PROPERTY, NULL);
+		return INDIGO_OK;
+	} else if (indigo_property_match(CCD_CALIBRATION_LIBRARY_PROPERTY, property)) {
+		// -------------------------------------------------------------------------------- CCD_CALIBRATION_LIBRARY
+		indigo_property_copy_values(CCD_CALIBRATION_LIBRARY_PROPERTY, property, false);
+		long len = strlen(CCD_CALIBRATION_LIBRARY_DIR_ITEM->text.value);
+		if (len == 0)
+			snprintf(CCD_CALIBRATION_LIBRARY_DIR_ITEM->text.value, INDIGO_VALUE_SIZE, "%s/", getenv("HOME"));
+		else if (CCD_CALIBRATION_LIBRARY_DIR_ITEM->text.value[len - 1] != '/' && len < INDIGO_VALUE_SIZE - 1)
+			strcat(CCD_CALIBRATION_LIBRARY_DIR_ITEM->text.value, "/");
+		int count = indigo_calibration_scan(CCD_CONTEXT->calibration, CCD_CALIBRATION_LIBRARY_DIR_ITEM->text.value);
+		strncpy(CCD_CALIBRATION_MASTERS_BIAS_ITEM->text.value, "None", INDIGO_VALUE_SIZE);
+		strncpy(CCD_CALIBRATION_MASTERS_DARK_ITEM->text.value, "None", INDIGO_VALUE_SIZE);
+		strncpy(CCD_CALIBRATION_MASTERS_FLAT_ITEM->text.value, "None", INDIGO_VALUE_SIZE);
+		CCD_CALIBRATION_LIBRARY_PROPERTY->state = INDIGO_OK_STATE;
+		if (IS_CONNECTED) {
+			indigo_update_property(device, CCD_CALIBRATION_LIBRARY_PROPERTY, "%d master frames found", count);
+			indigo_update_property(device, CCD_CALIBRATION_MASTERS_PROPERTY, NULL);
+		}
+		return INDIGO_OK;
+	} else if (indigo_property_match(CCD_CALIBRATION_BUILD_PROPERTY, property)) {
+		// -------------------------------------------------------------------------------- CCD_CALIBRATION_BUILD
+		indigo_property_copy_values(CCD_CALIBRATION_BUILD_PROPERTY, property, false);
+		indigo_calibration_type type = INDIGO_CALIBRATION_NONE;
+		if (CCD_FRAME_TYPE_BIAS_ITEM->sw.value)
+			type = INDIGO_CALIBRATION_BIAS;
+		else if (CCD_FRAME_TYPE_DARK_ITEM->sw.value || CCD_FRAME_TYPE_DARKFLAT_ITEM->sw.value)
+			type = INDIGO_CALIBRATION_DARK;
+		else if (CCD_FRAME_TYPE_FLAT_ITEM->sw.value)
+			type = INDIGO_CALIBRATION_FLAT;
+		if (CCD_CALIBRATION_BUILD_COUNT_ITEM->number.value == 0) {
+			indigo_calibration_abort_master(CCD_CONTEXT->calibration);
+			CCD_CALIBRATION_BUILD_PROPERTY->state = INDIGO_OK_STATE;
+			indigo_update_property(device, CCD_CALIBRATION_BUILD_PROPERTY, "Master frame aborted");
+		} else if (type == INDIGO_CALIBRATION_NONE) {
+			CCD_CALIBRATION_BUILD_PROPERTY->state = INDIGO_ALERT_STATE;
+			indigo_update_property(device, CCD_CALIBRATION_BUILD_PROPERTY, "Select bias, dark or flat frame type first");
+		} else if (indigo_calibration_start_master(CCD_CONTEXT->calibration, type, CCD_CALIBRATION_BUILD_COUNT_ITEM->number.value, CCD_CALIBRATION_BUILD_SIGMA_ITEM->number.value)) {
+			CCD_CALIBRATION_BUILD_PROPERTY->state = INDIGO_BUSY_STATE;
+			indigo_update_property(device, CCD_CALIBRATION_BUILD_PROPERTY, "Waiting for %d frames", (int)CCD_CALIBRATION_BUILD_COUNT_ITEM->number.value);
+		} else {
+			CCD_CALIBRATION_BUILD_PROPERTY->state = INDIGO_ALERT_STATE;
+			indigo_update_property(device, CCD_CALIBRATION_BUILD_PROPERTY, NULL);
+		}
+		return INDIGO_OK;
+	} else if (indigo_property_match(CCD_STREAMING_BUFFER_PROPERTY, property)) {
+		// -------------------------------------------------------------------------------- CCD_STREAMING_BUFFER
+		indigo_property_copy_values(CCD_STREAMING_BUFFER_PROPERTY, property, false);
+		CCD_STREAMING_BUFFER_PROPERTY->state = INDIGO_OK_STATE;
+		if (IS_CONNECTED)
+			indigo_update_property(device, CCD_STREAMING_BUFFER_PROPERTY, CCD_CONTEXT->stream_ring ? "Change will be applied when streaming is restarted" : NULL);
+		return INDIGO_OK;
 		// --------------------------------------------------------------------------------
 	}
 	return indigo_device_change_property(device, client, property);
@@ -764,6 +904,8 @@ indigo_result indigo_ccd_change_property(indigo_device *device, indigo_client *c
 
 indigo_result indigo_ccd_detach(indigo_device *device) {
 	assert(device != NULL);
+	// master frame combined in background reports to properties released below
+	indigo_calibration_wait_master(CCD_CONTEXT->calibration);
 	indigo_release_property(CCD_INFO_PROPERTY);
 	indigo_release_property(CCD_LENS_PROPERTY);
 	indigo_release_property(CCD_UPLOAD_MODE_PROPERTY);
@@ -791,6 +933,14 @@ indigo_result indigo_ccd_detach(indigo_device *device) {
 	indigo_release_property(CCD_JPEG_SETTINGS_PROPERTY);
 	indigo_release_property(CCD_RBI_FLUSH_ENABLE_PROPERTY);
 	indigo_release_property(CCD_RBI_FLUSH_PROPERTY);
+	indigo_release_property(CCD_CALIBRATION_PROPERTY);
+	indigo_release_property(CCD_CALIBRATION_LIBRARY_PROPERTY);
+	indigo_release_property(CCD_CALIBRATION_MASTERS_PROPERTY);
+	indigo_release_property(CCD_CALIBRATION_BUILD_PROPERTY);
+	indigo_ccd_stream_stop(device);
+	indigo_release_property(CCD_STREAMING_BUFFER_PROPERTY);
+	indigo_release_property(CCD_STREAMING_STATS_PROPERTY);
+	indigo_calibration_release(CCD_CONTEXT->calibration);
 	if (CCD_CONTEXT->preview_image)
 		free(CCD_CONTEXT->preview_image);
 	return indigo_device_detach(device);
@@ -972,10 +1122,89 @@ static void raw_to_tiff(indigo_device *device, void *data_in, int frame_width, i
 	free(memory_handle);
 }
 
+static void set_master_name(indigo_item *item, const char *file_name, bool *changed) {
+	const char *name = "None";
+	if (*file_name) {
+		name = strrchr(file_name, '/');
+		name = name ? name + 1 : file_name;
+	}
+	if (strcmp(item->text.value, name)) {
+		strncpy(item->text.value, name, INDIGO_VALUE_SIZE);
+		*changed = true;
+	}
+}
+
+static void master_finished(void *data, bool result, const char *file_name) {
+	indigo_device *device = data;
+	if (result) {
+		CCD_CALIBRATION_BUILD_PROPERTY->state = INDIGO_OK_STATE;
+		indigo_update_property(device, CCD_CALIBRATION_BUILD_PROPERTY, "Master frame saved to %s", file_name);
+	} else {
+		CCD_CALIBRATION_BUILD_PROPERTY->state = INDIGO_ALERT_STATE;
+		indigo_update_property(device, CCD_CALIBRATION_BUILD_PROPERTY, "Failed to create master frame");
+	}
+}
+
+/* calstat receives FITS CALSTAT value (B, D and F for master frames applied), returns true if frame was calibrated */
+
+static bool calibrate_image(indigo_device *device, void *data, int frame_width, int frame_height, int bpp, bool little_endian, int horizontal_bin, int vertical_bin, char *calstat) {
+	indigo_calibration *calibration = CCD_CONTEXT->calibration;
+	double exposure = CCD_STREAMING_PROPERTY->state == INDIGO_BUSY_STATE ? CCD_STREAMING_EXPOSURE_ITEM->number.target : CCD_EXPOSURE_ITEM->number.target;
+	double temperature = CCD_TEMPERATURE_PROPERTY->hidden ? NAN : CCD_TEMPERATURE_ITEM->number.value;
+	int channels = bpp == 24 || bpp == 48 ? 3 : 1;
+	bool result = false;
+	if (CCD_CALIBRATION_BUILD_PROPERTY->state == INDIGO_BUSY_STATE && !CCD_FRAME_TYPE_LIGHT_ITEM->sw.value) {
+		int collected = indigo_calibration_add_frame(calibration, data + FITS_HEADER_SIZE, frame_width, frame_height, bpp, little_endian, horizontal_bin, vertical_bin, exposure, temperature);
+		if (collected < 0) {
+			indigo_calibration_abort_master(calibration);
+			CCD_CALIBRATION_BUILD_PROPERTY->state = INDIGO_ALERT_STATE;
+			indigo_update_property(device, CCD_CALIBRATION_BUILD_PROPERTY, "Frame doesn't match master frame in progress");
+		} else if (collected > 0 && collected < CCD_CALIBRATION_BUILD_COUNT_ITEM->number.value) {
+			indigo_update_property(device, CCD_CALIBRATION_BUILD_PROPERTY, "%d of %d frames collected", collected, (int)CCD_CALIBRATION_BUILD_COUNT_ITEM->number.value);
+		} else if (collected > 0) {
+			// combining takes seconds for large stacks, don't hold exposure thread
+			if (indigo_calibration_finish_master_async(calibration, CCD_CALIBRATION_LIBRARY_DIR_ITEM->text.value, device->name, master_finished, device)) {
+				indigo_update_property(device, CCD_CALIBRATION_BUILD_PROPERTY, "Combining %d frames", collected);
+			} else {
+				CCD_CALIBRATION_BUILD_PROPERTY->state = INDIGO_ALERT_STATE;
+				indigo_update_property(device, CCD_CALIBRATION_BUILD_PROPERTY, "Failed to create master frame");
+			}
+		}
+	}
+	*calstat = 0;
+	if (CCD_CALIBRATION_ENABLED_ITEM->sw.value && CCD_FRAME_TYPE_LIGHT_ITEM->sw.value) {
+		indigo_calibration_masters masters = { 0 };
+		if (indigo_calibration_select(calibration, frame_width, frame_height, channels, horizontal_bin, vertical_bin, exposure, temperature))
+			result = indigo_calibration_apply(calibration, data + FITS_HEADER_SIZE, frame_width, frame_height, bpp, little_endian, &masters);
+		sprintf(calstat, "%s%s%s", *masters.bias ? "B" : "", *masters.dark ? "D" : "", *masters.flat ? "F" : "");
+		bool changed = false;
+		set_master_name(CCD_CALIBRATION_MASTERS_BIAS_ITEM, masters.bias, &changed);
+		set_master_name(CCD_CALIBRATION_MASTERS_DARK_ITEM, masters.dark, &changed);
+		set_master_name(CCD_CALIBRATION_MASTERS_FLAT_ITEM, masters.flat, &changed);
+		if (changed)
+			indigo_update_property(device, CCD_CALIBRATION_MASTERS_PROPERTY, NULL);
+	}
+	return result;
+}
+
+static void format_utc(double time, bool fraction, const char *suffix, char *buffer, int size) {
+	time_t seconds = (time_t)floor(time);
+	struct tm tm_info;
+	gmtime_r(&seconds, &tm_info);
+	int length = (int)strftime(buffer, size, "%Y-%m-%dT%H:%M:%S", &tm_info);
+	if (fraction)
+		length += snprintf(buffer + length, size - length, ".%03d", (int)((time - seconds) * 1000));
+	snprintf(buffer + length, size - length, "%s", suffix);
+}
+
 void indigo_process_image(indigo_device *device, void *data, int frame_width, int frame_height, int bpp, bool little_endian, bool byte_order_rgb, indigo_fits_keyword *keywords, bool streaming) {
 	assert(device != NULL);
 	assert(data != NULL);
 	INDIGO_DEBUG(clock_t start = clock());
+	// frame is stamped before calibration and conversion, streamed frames keep time of their commit
+	exposure_time exposure;
+	stream_exposure_time(device, &exposure);
+	indigo_metric_add(INDIGO_METRIC_CCD_FRAMES, 1);
 	int horizontal_bin = CCD_BIN_HORIZONTAL_ITEM->number.value;
 	int vertical_bin = CCD_BIN_VERTICAL_ITEM->number.value;
 	int byte_per_pixel = bpp / 8;
@@ -990,6 +1219,11 @@ void indigo_process_image(indigo_device *device, void *data, int frame_width, in
 		naxis = 3;
 	}
 
+	bool calibrated = false;
+	char calstat[4] = "";
+	if (byte_per_pixel <= 2 && CCD_CONTEXT->calibration)
+		calibrated = calibrate_image(device, data, frame_width, frame_height, bpp, little_endian, horizontal_bin, vertical_bin, calstat);
+
 	void *jpeg_data = NULL;
 	unsigned long jpeg_size = 0;
 	if (CCD_IMAGE_FORMAT_JPEG_ITEM->sw.value || CCD_IMAGE_FORMAT_JPEG_AVI_ITEM->sw.value || CCD_PREVIEW_ENABLED_ITEM->sw.value) {
@@ -1015,13 +1249,9 @@ void indigo_process_image(indigo_device *device, void *data, int frame_width, in
 
 	if (CCD_IMAGE_FORMAT_FITS_ITEM->sw.value) {
 		INDIGO_DEBUG(clock_t start = clock());
-		time_t timer;
-		struct tm* tm_info;
-		char date_time_end[20];
-		time(&timer);
-		timer -= CCD_EXPOSURE_ITEM->number.target;
-		tm_info = gmtime(&timer);
-		strftime(date_time_end, 20, "%Y-%m-%dT%H:%M:%S", tm_info);
+		char date_time_start[32], date_time_end[32];
+		format_utc(exposure.start, exposure.start_precise, "", date_time_start, sizeof(date_time_start));
+		format_utc(exposure.end, exposure.end_precise, "", date_time_end, sizeof(date_time_end));
 		char *header = data;
 		memset(header, ' ', FITS_HEADER_SIZE);
 		int t = sprintf(header, "SIMPLE  =                    T / file conforms to FITS standard");
@@ -1088,6 +1318,10 @@ void indigo_process_image(indigo_device *device, void *data, int frame_width, in
 		else if (CCD_FRAME_TYPE_DARKFLAT_ITEM->sw.value)
 			t = sprintf(header += 80, "IMAGETYP= 'DarkFlat'            / frame type");
 		header[t] = ' ';
+		if (calibrated) {
+			t = sprintf(header += 80, "CALSTAT = '%s'%*c / calibration applied", calstat, 19 - (int)strlen(calstat), ' ');
+			header[t] = ' ';
+		}
 		if (!CCD_GAIN_PROPERTY->hidden) {
 			t = sprintf(header += 80, "GAIN    = %20.2f / Gain", CCD_GAIN_ITEM->number.value);
 			indigo_fix_locale(header - 80);
@@ -1103,7 +1337,9 @@ void indigo_process_image(indigo_device *device, void *data, int frame_width, in
 			indigo_fix_locale(header - 80);
 			header[t] = ' ';
 		}
-		t = sprintf(header += 80, "DATE-OBS= '%s' / UTC date that FITS file was created", date_time_end);
+		t = sprintf(header += 80, "DATE-OBS= '%s' / observation start time, UT", date_time_start);
+		header[t] = ' ';
+		t = sprintf(header += 80, "DATE-END= '%s' / observation end time, UT", date_time_end);
 		header[t] = ' ';
 		t = sprintf(header += 80, "INSTRUME= '%s'%*c / instrument name", device->name, (int)(19 - strlen(device->name)), ' ');
 		header[t] = ' ';
@@ -1226,16 +1462,10 @@ void indigo_process_image(indigo_device *device, void *data, int frame_width, in
 		INDIGO_DEBUG(indigo_debug("RAW to FITS conversion in %gs", (clock() - start) / (double)CLOCKS_PER_SEC));
 	} else if (CCD_IMAGE_FORMAT_XISF_ITEM->sw.value) {
 		INDIGO_DEBUG(clock_t start = clock());
-		time_t timer;
-		struct tm* tm_info;
-		char date_time_end[21], date_time_start[21], fits_date_obs[21];
-		time(&timer);
-		tm_info = gmtime(&timer);
-		strftime(date_time_end, 21, "%Y-%m-%dT%H:%M:%SZ", tm_info);
-		timer -= CCD_EXPOSURE_ITEM->number.target;
-		tm_info = gmtime(&timer);
-		strftime(date_time_start, 21, "%Y-%m-%dT%H:%M:%SZ", tm_info);
-		strftime(fits_date_obs, 21, "%Y-%m-%dT%H:%M:%S", tm_info);
+		char date_time_end[32], date_time_start[32], fits_date_obs[32];
+		format_utc(exposure.end, exposure.end_precise, "Z", date_time_end, sizeof(date_time_end));
+		format_utc(exposure.start, exposure.start_precise, "Z", date_time_start, sizeof(date_time_start));
+		format_utc(exposure.start, exposure.start_precise, "", fits_date_obs, sizeof(fits_date_obs));
 		char *header = data;
 		strcpy(header, "XISF0100");
 		header += 16;
@@ -1529,6 +1759,12 @@ void indigo_process_image(indigo_device *device, void *data, int frame_width, in
 						else
 							break;
 					}
+					if (use_ser && i > 1) {
+						// previous stream in the sequence may be left unclosed by a crash, repair its frame count before starting next one
+						char previous_name[INDIGO_VALUE_SIZE];
+						snprintf(previous_name, sizeof(previous_name), format, i - 1);
+						indigo_ser_recover(previous_name);
+					}
 				}
 				strncpy(CCD_IMAGE_FILE_ITEM->text.value, file_name, INDIGO_VALUE_SIZE);
 				CCD_IMAGE_FILE_PROPERTY->state = INDIGO_OK_STATE;
@@ -1551,7 +1787,8 @@ void indigo_process_image(indigo_device *device, void *data, int frame_width, in
 					message = strerror(errno);
 				}
 			} else if (use_ser) {
-				if (!indigo_ser_add_frame((indigo_ser *)(CCD_CONTEXT->video_stream), data + FITS_HEADER_SIZE - sizeof(indigo_raw_header), blobsize + sizeof(indigo_raw_header))) {
+				struct timeval utc = { (time_t)exposure.end, (suseconds_t)((exposure.end - floor(exposure.end)) * 1e6) };
+				if (!indigo_ser_add_frame_timed((indigo_ser *)(CCD_CONTEXT->video_stream), data + FITS_HEADER_SIZE - sizeof(indigo_raw_header), blobsize + sizeof(indigo_raw_header), &utc)) {
 					CCD_IMAGE_FILE_PROPERTY->state = INDIGO_ALERT_STATE;
 					message = strerror(errno);
 				}
@@ -1616,6 +1853,11 @@ void indigo_process_image(indigo_device *device, void *data, int frame_width, in
 		}
 		CCD_IMAGE_PROPERTY->state = INDIGO_OK_STATE;
 		indigo_update_property(device, CCD_IMAGE_PROPERTY, NULL);
+		if (indigo_use_metrics) {
+			struct timespec uploaded;
+			indigo_get_utc(&uploaded);
+			indigo_metric_observe(INDIGO_METRIC_CCD_CAPTURE_TO_UPLOAD, uploaded.tv_sec + uploaded.tv_nsec / 1e9 - exposure.end);
+		}
 		INDIGO_DEBUG(indigo_debug("Client upload in %gs", (clock() - start) / (double)CLOCKS_PER_SEC));
 	}
 	if (jpeg_data)
@@ -1625,6 +1867,7 @@ void indigo_process_image(indigo_device *device, void *data, int frame_width, in
 void indigo_process_dslr_image(indigo_device *device, void *data, int blobsize, const char *suffix, bool streaming) {
 	assert(device != NULL);
 	assert(data != NULL);
+	indigo_metric_add(INDIGO_METRIC_CCD_FRAMES, 1);
 	INDIGO_DEBUG(clock_t start = clock());
 	char standard_suffix[16];
 	strncpy(standard_suffix, suffix, sizeof(standard_suffix));
@@ -1757,3 +2000,229 @@ void indigo_finalize_video_stream(indigo_device *device) {
 		}
 	}
 }
+
+typedef struct {
+	void *buffer;
+	int frame_width, frame_height, bpp;
+	bool little_endian, byte_order_rgb;
+	indigo_fits_keyword *keywords;
+	exposure_time time;
+} stream_frame;
+
+typedef struct {
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	pthread_t consumer;
+	bool running;
+	int size;
+	stream_frame *frames;
+	int *free_slots, free_count;
+	int *queue, queue_head, queue_count;
+	unsigned long captured, processed, dropped;
+	time_t last_update;
+	stream_frame *current;
+} stream_ring;
+
+static double utc_now(bool *precise) {
+	struct timespec now;
+	double accuracy = indigo_get_utc(&now);
+	if (precise)
+		*precise = accuracy >= 0;
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+void indigo_ccd_shutter_opened(indigo_device *device) {
+	CCD_CONTEXT->exposure_start = utc_now(&CCD_CONTEXT->exposure_start_precise);
+	CCD_CONTEXT->exposure_end = 0;
+}
+
+void indigo_ccd_shutter_closed(indigo_device *device) {
+	CCD_CONTEXT->exposure_end = utc_now(&CCD_CONTEXT->exposure_end_precise);
+}
+
+static void take_exposure_time(indigo_device *device, exposure_time *time) {
+	if (CCD_CONTEXT->exposure_end > 0) {
+		time->end = CCD_CONTEXT->exposure_end;
+		time->end_precise = CCD_CONTEXT->exposure_end_precise;
+	} else {
+		time->end = utc_now(NULL);
+		time->end_precise = false;
+	}
+	if (CCD_CONTEXT->exposure_start > 0 && CCD_CONTEXT->exposure_start <= time->end) {
+		time->start = CCD_CONTEXT->exposure_start;
+		time->start_precise = CCD_CONTEXT->exposure_start_precise;
+	} else {
+		time->start = time->end - CCD_EXPOSURE_ITEM->number.target;
+		time->start_precise = false;
+	}
+	CCD_CONTEXT->exposure_start = CCD_CONTEXT->exposure_end = 0;
+}
+
+static void stream_exposure_time(indigo_device *device, exposure_time *time) {
+	stream_ring *ring = CCD_CONTEXT->stream_ring;
+	if (ring && ring->current)
+		*time = ring->current->time;
+	else
+		take_exposure_time(device, time);
+}
+
+static void update_stream_stats(indigo_device *device, stream_ring *ring) {
+	pthread_mutex_lock(&ring->mutex);
+	CCD_STREAMING_STATS_CAPTURED_ITEM->number.value = ring->captured;
+	CCD_STREAMING_STATS_PROCESSED_ITEM->number.value = ring->processed;
+	CCD_STREAMING_STATS_DROPPED_ITEM->number.value = ring->dropped;
+	CCD_STREAMING_STATS_PROPERTY->state = ring->running ? INDIGO_BUSY_STATE : (ring->dropped ? INDIGO_ALERT_STATE : INDIGO_OK_STATE);
+	ring->last_update = time(NULL);
+	pthread_mutex_unlock(&ring->mutex);
+	indigo_update_property(device, CCD_STREAMING_STATS_PROPERTY, NULL);
+}
+
+static void *stream_consumer(indigo_device *device) {
+	stream_ring *ring = CCD_CONTEXT->stream_ring;
+	pthread_mutex_lock(&ring->mutex);
+	while (true) {
+		while (ring->running && ring->queue_count == 0)
+			pthread_cond_wait(&ring->cond, &ring->mutex);
+		if (ring->queue_count == 0)
+			break;
+		int slot = ring->queue[ring->queue_head];
+		ring->queue_head = (ring->queue_head + 1) % ring->size;
+		ring->queue_count--;
+		pthread_mutex_unlock(&ring->mutex);
+		stream_frame *frame = ring->frames + slot;
+		ring->current = frame;
+		indigo_process_image(device, frame->buffer, frame->frame_width, frame->frame_height, frame->bpp, frame->little_endian, frame->byte_order_rgb, frame->keywords, true);
+		ring->current = NULL;
+		pthread_mutex_lock(&ring->mutex);
+		ring->free_slots[ring->free_count++] = slot;
+		ring->processed++;
+		bool update = time(NULL) != ring->last_update;
+		pthread_mutex_unlock(&ring->mutex);
+		if (update)
+			update_stream_stats(device, ring);
+		pthread_mutex_lock(&ring->mutex);
+	}
+	pthread_mutex_unlock(&ring->mutex);
+	return NULL;
+}
+
+static void release_stream_ring(stream_ring *ring) {
+	if (ring->frames) {
+		for (int i = 0; i < ring->size; i++)
+			if (ring->frames[i].buffer)
+				free(ring->frames[i].buffer);
+		free(ring->frames);
+	}
+	if (ring->free_slots)
+		free(ring->free_slots);
+	if (ring->queue)
+		free(ring->queue);
+	free(ring);
+}
+
+bool indigo_ccd_stream_start(indigo_device *device, long frame_size) {
+	if (CCD_CONTEXT->stream_ring)
+		indigo_ccd_stream_stop(device);
+	stream_ring *ring = malloc(sizeof(stream_ring));
+	if (ring == NULL)
+		return false;
+	memset(ring, 0, sizeof(stream_ring));
+	ring->size = (int)CCD_STREAMING_BUFFER_FRAMES_ITEM->number.value;
+	if (ring->size < 3)
+		ring->size = 3;
+	ring->frames = malloc(ring->size * sizeof(stream_frame));
+	ring->free_slots = malloc(ring->size * sizeof(int));
+	ring->queue = malloc(ring->size * sizeof(int));
+	if (ring->frames)
+		memset(ring->frames, 0, ring->size * sizeof(stream_frame));
+	if (ring->frames == NULL || ring->free_slots == NULL || ring->queue == NULL) {
+		release_stream_ring(ring);
+		return false;
+	}
+	for (int i = 0; i < ring->size; i++) {
+		ring->frames[i].buffer = indigo_alloc_blob_buffer(frame_size);
+		if (ring->frames[i].buffer == NULL) {
+			INDIGO_ERROR(indigo_error("Can't allocate %d streaming buffers", ring->size));
+			release_stream_ring(ring);
+			return false;
+		}
+		ring->free_slots[ring->free_count++] = i;
+	}
+	pthread_mutex_init(&ring->mutex, NULL);
+	pthread_cond_init(&ring->cond, NULL);
+	ring->running = true;
+	CCD_CONTEXT->stream_ring = ring;
+	if (pthread_create(&ring->consumer, NULL, (void * (*)(void*))stream_consumer, device)) {
+		INDIGO_ERROR(indigo_error("Can't create streaming thread (%s)", strerror(errno)));
+		CCD_CONTEXT->stream_ring = NULL;
+		pthread_mutex_destroy(&ring->mutex);
+		pthread_cond_destroy(&ring->cond);
+		release_stream_ring(ring);
+		return false;
+	}
+	update_stream_stats(device, ring);
+	return true;
+}
+
+void *indigo_ccd_stream_acquire_buffer(indigo_device *device) {
+	stream_ring *ring = CCD_CONTEXT->stream_ring;
+	if (ring == NULL)
+		return NULL;
+	void *buffer = NULL;
+	pthread_mutex_lock(&ring->mutex);
+	if (ring->free_count > 0) {
+		buffer = ring->frames[ring->free_slots[--ring->free_count]].buffer;
+	} else if (ring->queue_count > 0) {
+		// processing is behind, reuse the oldest frame waiting for it
+		buffer = ring->frames[ring->queue[ring->queue_head]].buffer;
+		ring->queue_head = (ring->queue_head + 1) % ring->size;
+		ring->queue_count--;
+		ring->dropped++;
+	} else {
+		// all buffers are held by the driver or processed, driver drops the frame
+		ring->dropped++;
+	}
+	pthread_mutex_unlock(&ring->mutex);
+	return buffer;
+}
+
+void indigo_ccd_stream_commit_buffer(indigo_device *device, void *buffer, int frame_width, int frame_height, int bpp, bool little_endian, bool byte_order_rgb, indigo_fits_keyword *keywords) {
+	stream_ring *ring = CCD_CONTEXT->stream_ring;
+	if (ring == NULL || buffer == NULL)
+		return;
+	pthread_mutex_lock(&ring->mutex);
+	for (int slot = 0; slot < ring->size; slot++) {
+		stream_frame *frame = ring->frames + slot;
+		if (frame->buffer == buffer) {
+			frame->frame_width = frame_width;
+			frame->frame_height = frame_height;
+			frame->bpp = bpp;
+			frame->little_endian = little_endian;
+			frame->byte_order_rgb = byte_order_rgb;
+			frame->keywords = keywords;
+			take_exposure_time(device, &frame->time);
+			ring->queue[(ring->queue_head + ring->queue_count++) % ring->size] = slot;
+			ring->captured++;
+			pthread_cond_signal(&ring->cond);
+			break;
+		}
+	}
+	pthread_mutex_unlock(&ring->mutex);
+}
+
+void indigo_ccd_stream_stop(indigo_device *device) {
+	stream_ring *ring = CCD_CONTEXT->stream_ring;
+	if (ring == NULL)
+		return;
+	pthread_mutex_lock(&ring->mutex);
+	ring->running = false;
+	pthread_cond_signal(&ring->cond);
+	pthread_mutex_unlock(&ring->mutex);
+	pthread_join(ring->consumer, NULL);
+	update_stream_stats(device, ring);
+	CCD_CONTEXT->stream_ring = NULL;
+	INDIGO_DEBUG(indigo_debug("Streaming finished, %lu frames captured, %lu processed, %lu dropped", ring->captured, ring->processed, ring->dropped));
+	pthread_mutex_destroy(&ring->mutex);
+	pthread_cond_destroy(&ring->cond);
+	release_stream_ring(ring);
+}
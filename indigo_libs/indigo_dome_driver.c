@@ -39,14 +39,45 @@
 #include <indigo/indigo_novas.h>
 
 #define SYNC_INTERAL 15.0  /* in seconds */
+#define SLAVING_LOOKAHEAD 3600.0  /* in seconds */
+#define SLAVING_STEP 10.0  /* in seconds */
+#define SIDEREAL_HA_RATE (15 * INDIGO_SIDEREAL_RATE)  /* in arcsec/s */
+#define SOLAR_HA_RATE 15.0  /* in arcsec/s */
+#define LUNAR_HA_RATE 14.685  /* in arcsec/s */
+#define KING_HA_RATE 15.0369  /* in arcsec/s */
 
 static indigo_client dummy_client = { "Client", false, NULL, INDIGO_OK, INDIGO_VERSION_CURRENT, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
 
 static void sync_timer_callback(indigo_device *device) {
-	if (!DOME_PARK_PARKED_ITEM->sw.value) {
+	pthread_mutex_lock(&DOME_CONTEXT->slaving_mutex);
+	DOME_CONTEXT->sync_running = true;
+	pthread_mutex_unlock(&DOME_CONTEXT->slaving_mutex);
+	if (!DOME_PARK_PARKED_ITEM->sw.value && DOME_SLAVING_ENABLE_ITEM->sw.value) {
 		indigo_change_property(&dummy_client, DOME_EQUATORIAL_COORDINATES_PROPERTY);
 	}
-	indigo_reschedule_timer(device, SYNC_INTERAL, &DOME_CONTEXT->sync_timer);
+	pthread_mutex_lock(&DOME_CONTEXT->slaving_mutex);
+	DOME_CONTEXT->sync_running = false;
+	time_t utc = indigo_get_dome_utc(device);
+	double delay = DOME_CONTEXT->slaving_deadline > utc ? DOME_CONTEXT->slaving_deadline - utc : SYNC_INTERAL;
+	DOME_CONTEXT->sync_time = utc + delay;
+	indigo_reschedule_timer(device, delay, &DOME_CONTEXT->sync_timer);
+	pthread_mutex_unlock(&DOME_CONTEXT->slaving_mutex);
+}
+
+static void add_slaving_snoop_rules(indigo_device *device) {
+	indigo_add_snoop_rule(DOME_EQUATORIAL_COORDINATES_PROPERTY, DOME_SNOOP_MOUNT_ITEM->text.value, MOUNT_EQUATORIAL_COORDINATES_PROPERTY_NAME);
+	indigo_add_snoop_rule(DOME_MOUNT_TRACKING_PROPERTY, DOME_SNOOP_MOUNT_ITEM->text.value, MOUNT_TRACKING_PROPERTY_NAME);
+	indigo_add_snoop_rule(DOME_MOUNT_TRACK_RATE_PROPERTY, DOME_SNOOP_MOUNT_ITEM->text.value, MOUNT_TRACK_RATE_PROPERTY_NAME);
+	indigo_add_snoop_rule(DOME_MOUNT_CUSTOM_TRACKING_RATE_PROPERTY, DOME_SNOOP_MOUNT_ITEM->text.value, MOUNT_CUSTOM_TRACKING_RATE_PROPERTY_NAME);
+	indigo_add_snoop_rule(DOME_GEOGRAPHIC_COORDINATES_PROPERTY, DOME_SNOOP_GPS_ITEM->text.value, GEOGRAPHIC_COORDINATES_PROPERTY_NAME);
+}
+
+static void remove_slaving_snoop_rules(indigo_device *device) {
+	indigo_remove_snoop_rule(DOME_EQUATORIAL_COORDINATES_PROPERTY, DOME_SNOOP_MOUNT_ITEM->text.value, MOUNT_EQUATORIAL_COORDINATES_PROPERTY_NAME);
+	indigo_remove_snoop_rule(DOME_MOUNT_TRACKING_PROPERTY, DOME_SNOOP_MOUNT_ITEM->text.value, MOUNT_TRACKING_PROPERTY_NAME);
+	indigo_remove_snoop_rule(DOME_MOUNT_TRACK_RATE_PROPERTY, DOME_SNOOP_MOUNT_ITEM->text.value, MOUNT_TRACK_RATE_PROPERTY_NAME);
+	indigo_remove_snoop_rule(DOME_MOUNT_CUSTOM_TRACKING_RATE_PROPERTY, DOME_SNOOP_MOUNT_ITEM->text.value, MOUNT_CUSTOM_TRACKING_RATE_PROPERTY_NAME);
+	indigo_remove_snoop_rule(DOME_GEOGRAPHIC_COORDINATES_PROPERTY, DOME_SNOOP_GPS_ITEM->text.value, GEOGRAPHIC_COORDINATES_PROPERTY_NAME);
 }
 
 indigo_result indigo_dome_attach(indigo_device *device, const char* driver_name, unsigned version) {
@@ -56,6 +87,7 @@ indigo_result indigo_dome_attach(indigo_device *device, const char* driver_name,
 		device->device_context = malloc(sizeof(indigo_dome_context));
 		assert(device->device_context);
 		memset(device->device_context, 0, sizeof(indigo_dome_context));
+		pthread_mutex_init(&DOME_CONTEXT->slaving_mutex, NULL);
 	}
 	if (DOME_CONTEXT != NULL) {
 		if (indigo_device_attach(device, driver_name, version, INDIGO_INTERFACE_DOME) == INDIGO_OK) {
@@ -102,11 +134,13 @@ indigo_result indigo_dome_attach(indigo_device *device, const char* driver_name,
 			indigo_init_switch_item(DOME_SLAVING_ENABLE_ITEM, DOME_SLAVING_ENABLE_ITEM_NAME, "Enable", false);
 			indigo_init_switch_item(DOME_SLAVING_DISABLE_ITEM, DOME_SLAVING_DISABLE_ITEM_NAME, "Disable", true);
 			// -------------------------------------------------------------------------------- DOME_SYNC
-			DOME_SLAVING_PARAMETERS_PROPERTY = indigo_init_number_property(NULL, device->name, DOME_SLAVING_PARAMETERS_PROPERTY_NAME, DOME_MAIN_GROUP, "Slaving parameteres", INDIGO_OK_STATE, INDIGO_RW_PERM, 1);
+			DOME_SLAVING_PARAMETERS_PROPERTY = indigo_init_number_property(NULL, device->name, DOME_SLAVING_PARAMETERS_PROPERTY_NAME, DOME_MAIN_GROUP, "Slaving parameteres", INDIGO_OK_STATE, INDIGO_RW_PERM, 3);
 			if (DOME_SLAVING_PARAMETERS_PROPERTY == NULL)
 				return INDIGO_FAILED;
 			DOME_SLAVING_PARAMETERS_PROPERTY->hidden = true;
 			indigo_init_number_item(DOME_SLAVING_THRESHOLD_ITEM, DOME_SLAVING_THRESHOLD_ITEM_NAME, "Minimal move threshold (0 to 20°)", 0, 20, 0, 1);
+			indigo_init_number_item(DOME_SLAVING_MARGIN_ITEM, DOME_SLAVING_MARGIN_ITEM_NAME, "Slit edge margin (0 to 20°)", 0, 20, 0, 2);
+			indigo_init_number_item(DOME_SLAVING_LEAD_TIME_ITEM, DOME_SLAVING_LEAD_TIME_ITEM_NAME, "Move lead time (0 to 600s)", 0, 600, 1, 60);
 			// -------------------------------------------------------------------------------- DOME_ABORT_MOTION
 			DOME_ABORT_MOTION_PROPERTY = indigo_init_switch_property(NULL, device->name, DOME_ABORT_MOTION_PROPERTY_NAME, DOME_MAIN_GROUP, "Abort motion", INDIGO_OK_STATE, INDIGO_RW_PERM, INDIGO_AT_MOST_ONE_RULE, 1);
 			if (DOME_ABORT_MOTION_PROPERTY == NULL)
@@ -167,6 +201,27 @@ indigo_result indigo_dome_attach(indigo_device *device, const char* driver_name,
 				return INDIGO_FAILED;
 			indigo_init_text_item(DOME_SNOOP_MOUNT_ITEM, SNOOP_MOUNT_ITEM_NAME, "Mount", "");
 			indigo_init_text_item(DOME_SNOOP_GPS_ITEM, SNOOP_GPS_ITEM_NAME, "GPS", "");
+			// -------------------------------------------------------------------------------- DOME_MOUNT_TRACKING
+			DOME_MOUNT_TRACKING_PROPERTY = indigo_init_switch_property(NULL, device->name, DOME_MOUNT_TRACKING_PROPERTY_NAME, DOME_MAIN_GROUP, "Mount tracking", INDIGO_OK_STATE, INDIGO_RW_PERM, INDIGO_ONE_OF_MANY_RULE, 2);
+			if (DOME_MOUNT_TRACKING_PROPERTY == NULL)
+				return INDIGO_FAILED;
+			indigo_init_switch_item(DOME_MOUNT_TRACKING_ON_ITEM, DOME_MOUNT_TRACKING_ON_ITEM_NAME, "Tracking", true);
+			indigo_init_switch_item(DOME_MOUNT_TRACKING_OFF_ITEM, DOME_MOUNT_TRACKING_OFF_ITEM_NAME, "Stopped", false);
+			// -------------------------------------------------------------------------------- DOME_MOUNT_TRACK_RATE
+			DOME_MOUNT_TRACK_RATE_PROPERTY = indigo_init_switch_property(NULL, device->name, DOME_MOUNT_TRACK_RATE_PROPERTY_NAME, DOME_MAIN_GROUP, "Mount track rate", INDIGO_OK_STATE, INDIGO_RW_PERM, INDIGO_ONE_OF_MANY_RULE, 5);
+			if (DOME_MOUNT_TRACK_RATE_PROPERTY == NULL)
+				return INDIGO_FAILED;
+			indigo_init_switch_item(DOME_MOUNT_TRACK_RATE_SIDEREAL_ITEM, DOME_MOUNT_TRACK_RATE_SIDEREAL_ITEM_NAME, "Sidereal rate", true);
+			indigo_init_switch_item(DOME_MOUNT_TRACK_RATE_SOLAR_ITEM, DOME_MOUNT_TRACK_RATE_SOLAR_ITEM_NAME, "Solar rate", false);
+			indigo_init_switch_item(DOME_MOUNT_TRACK_RATE_LUNAR_ITEM, DOME_MOUNT_TRACK_RATE_LUNAR_ITEM_NAME, "Lunar rate", false);
+			indigo_init_switch_item(DOME_MOUNT_TRACK_RATE_KING_ITEM, DOME_MOUNT_TRACK_RATE_KING_ITEM_NAME, "King rate", false);
+			indigo_init_switch_item(DOME_MOUNT_TRACK_RATE_CUSTOM_ITEM, DOME_MOUNT_TRACK_RATE_CUSTOM_ITEM_NAME, "Custom rate", false);
+			// -------------------------------------------------------------------------------- DOME_MOUNT_CUSTOM_TRACKING_RATE
+			DOME_MOUNT_CUSTOM_TRACKING_RATE_PROPERTY = indigo_init_number_property(NULL, device->name, DOME_MOUNT_CUSTOM_TRACKING_RATE_PROPERTY_NAME, DOME_MAIN_GROUP, "Mount custom tracking rate", INDIGO_OK_STATE, INDIGO_RW_PERM, 2);
+			if (DOME_MOUNT_CUSTOM_TRACKING_RATE_PROPERTY == NULL)
+				return INDIGO_FAILED;
+			indigo_init_number_item(DOME_MOUNT_CUSTOM_TRACKING_RATE_RA_ITEM, DOME_MOUNT_CUSTOM_TRACKING_RATE_RA_ITEM_NAME, "RA rate (\"/s)", -36000, 36000, 0.001, 0);
+			indigo_init_number_item(DOME_MOUNT_CUSTOM_TRACKING_RATE_DEC_ITEM, DOME_MOUNT_CUSTOM_TRACKING_RATE_DEC_ITEM_NAME, "Dec rate (\"/s)", -36000, 36000, 0.001, 0);
 			// --------------------------------------------------------------------------------
 			return INDIGO_OK;
 		}
@@ -212,6 +267,12 @@ indigo_result indigo_dome_enumerate_properties(indigo_device *device, indigo_cli
 			indigo_define_property(device, DOME_SET_HOST_TIME_PROPERTY, NULL);
 		if (indigo_property_match(DOME_SNOOP_DEVICES_PROPERTY, property))
 			indigo_define_property(device, DOME_SNOOP_DEVICES_PROPERTY, NULL);
+		if (indigo_property_match(DOME_MOUNT_TRACKING_PROPERTY, property))
+			indigo_define_property(device, DOME_MOUNT_TRACKING_PROPERTY, NULL);
+		if (indigo_property_match(DOME_MOUNT_TRACK_RATE_PROPERTY, property))
+			indigo_define_property(device, DOME_MOUNT_TRACK_RATE_PROPERTY, NULL);
+		if (indigo_property_match(DOME_MOUNT_CUSTOM_TRACKING_RATE_PROPERTY, property))
+			indigo_define_property(device, DOME_MOUNT_CUSTOM_TRACKING_RATE_PROPERTY, NULL);
 	}
 	return indigo_device_enumerate_properties(device, client, property);
 }
@@ -240,21 +301,28 @@ indigo_result indigo_dome_change_property(indigo_device *device, indigo_client *
 			indigo_define_property(device, DOME_UTC_TIME_PROPERTY, NULL);
 			indigo_define_property(device, DOME_SET_HOST_TIME_PROPERTY, NULL);
 			indigo_define_property(device, DOME_SNOOP_DEVICES_PROPERTY, NULL);
+			indigo_define_property(device, DOME_MOUNT_TRACKING_PROPERTY, NULL);
+			indigo_define_property(device, DOME_MOUNT_TRACK_RATE_PROPERTY, NULL);
+			indigo_define_property(device, DOME_MOUNT_CUSTOM_TRACKING_RATE_PROPERTY, NULL);
 			if (DOME_SLAVING_ENABLE_ITEM->sw.value) {
-				indigo_add_snoop_rule(DOME_EQUATORIAL_COORDINATES_PROPERTY, DOME_SNOOP_MOUNT_ITEM->text.value, MOUNT_EQUATORIAL_COORDINATES_PROPERTY_NAME);
-				indigo_add_snoop_rule(DOME_GEOGRAPHIC_COORDINATES_PROPERTY, DOME_SNOOP_GPS_ITEM->text.value, GEOGRAPHIC_COORDINATES_PROPERTY_NAME);
+				add_slaving_snoop_rules(device);
 			}
+			pthread_mutex_lock(&DOME_CONTEXT->slaving_mutex);
+			DOME_CONTEXT->slaving_deadline = 0;
+			DOME_CONTEXT->sync_time = indigo_get_dome_utc(device) + SYNC_INTERAL;
 			indigo_set_timer(device, SYNC_INTERAL, sync_timer_callback, &DOME_CONTEXT->sync_timer);
+			pthread_mutex_unlock(&DOME_CONTEXT->slaving_mutex);
 		} else {
+			pthread_mutex_lock(&DOME_CONTEXT->slaving_mutex);
 			indigo_cancel_timer(device, &DOME_CONTEXT->sync_timer);
+			pthread_mutex_unlock(&DOME_CONTEXT->slaving_mutex);
 			DOME_STEPS_PROPERTY->state = INDIGO_OK_STATE;
 			DOME_EQUATORIAL_COORDINATES_PROPERTY->state = INDIGO_OK_STATE;
 			DOME_HORIZONTAL_COORDINATES_PROPERTY->state = INDIGO_OK_STATE;
 			DOME_SHUTTER_PROPERTY->state = INDIGO_OK_STATE;
 			DOME_FLAP_PROPERTY->state = INDIGO_OK_STATE;
 			DOME_PARK_PROPERTY->state = INDIGO_OK_STATE;
-			indigo_remove_snoop_rule(DOME_EQUATORIAL_COORDINATES_PROPERTY, DOME_SNOOP_MOUNT_ITEM->text.value, MOUNT_EQUATORIAL_COORDINATES_PROPERTY_NAME);
-			indigo_remove_snoop_rule(DOME_GEOGRAPHIC_COORDINATES_PROPERTY, DOME_SNOOP_GPS_ITEM->text.value, GEOGRAPHIC_COORDINATES_PROPERTY_NAME);
+			remove_slaving_snoop_rules(device);
 			indigo_delete_property(device, DOME_SPEED_PROPERTY, NULL);
 			indigo_delete_property(device, DOME_DIRECTION_PROPERTY, NULL);
 			indigo_delete_property(device, DOME_ON_HORIZONTAL_COORDINATES_SET_PROPERTY, NULL);
@@ -272,6 +340,9 @@ indigo_result indigo_dome_change_property(indigo_device *device, indigo_client *
 			indigo_delete_property(device, DOME_UTC_TIME_PROPERTY, NULL);
 			indigo_delete_property(device, DOME_SET_HOST_TIME_PROPERTY, NULL);
 			indigo_delete_property(device, DOME_SNOOP_DEVICES_PROPERTY, NULL);
+			indigo_delete_property(device, DOME_MOUNT_TRACKING_PROPERTY, NULL);
+			indigo_delete_property(device, DOME_MOUNT_TRACK_RATE_PROPERTY, NULL);
+			indigo_delete_property(device, DOME_MOUNT_CUSTOM_TRACKING_RATE_PROPERTY, NULL);
 		}
 		// -------------------------------------------------------------------------------- DOME_SPEED
 	} else if (indigo_property_match(DOME_SPEED_PROPERTY, property)) {
@@ -306,6 +377,7 @@ indigo_result indigo_dome_change_property(indigo_device *device, indigo_client *
 		// -------------------------------------------------------------------------------- DOME_GEOGRAPHIC_COORDINATES
 	} else if (indigo_property_match(DOME_GEOGRAPHIC_COORDINATES_PROPERTY, property)) {
 		indigo_property_copy_values(DOME_GEOGRAPHIC_COORDINATES_PROPERTY, property, false);
+		DOME_CONTEXT->slaving_deadline = 0;
 		DOME_GEOGRAPHIC_COORDINATES_PROPERTY->state = INDIGO_OK_STATE;
 		indigo_update_property(device, DOME_GEOGRAPHIC_COORDINATES_PROPERTY, NULL);
 		return INDIGO_OK;
@@ -314,16 +386,14 @@ indigo_result indigo_dome_change_property(indigo_device *device, indigo_client *
 		indigo_property_copy_values(DOME_SLAVING_PROPERTY, property, false);
 		DOME_SLAVING_PROPERTY->state = INDIGO_OK_STATE;
 		if (IS_CONNECTED) {
-			indigo_remove_snoop_rule(DOME_EQUATORIAL_COORDINATES_PROPERTY, DOME_SNOOP_MOUNT_ITEM->text.value, MOUNT_EQUATORIAL_COORDINATES_PROPERTY_NAME);
-			indigo_remove_snoop_rule(DOME_GEOGRAPHIC_COORDINATES_PROPERTY, DOME_SNOOP_GPS_ITEM->text.value, GEOGRAPHIC_COORDINATES_PROPERTY_NAME);
+			remove_slaving_snoop_rules(device);
 			if (DOME_SLAVING_ENABLE_ITEM->sw.value) {
 				if (!DOME_ON_HORIZONTAL_COORDINATES_SET_PROPERTY->hidden && !DOME_ON_HORIZONTAL_COORDINATES_SET_GOTO_ITEM->sw.value) {
 					DOME_ON_HORIZONTAL_COORDINATES_SET_PROPERTY->state = INDIGO_OK_STATE;
 					indigo_set_switch(DOME_ON_HORIZONTAL_COORDINATES_SET_PROPERTY, DOME_ON_HORIZONTAL_COORDINATES_SET_GOTO_ITEM, true);
 					indigo_update_property(device, DOME_ON_HORIZONTAL_COORDINATES_SET_PROPERTY, "Switching to GOTO mode." );
 				}
-				indigo_add_snoop_rule(DOME_EQUATORIAL_COORDINATES_PROPERTY, DOME_SNOOP_MOUNT_ITEM->text.value, MOUNT_EQUATORIAL_COORDINATES_PROPERTY_NAME);
-				indigo_add_snoop_rule(DOME_GEOGRAPHIC_COORDINATES_PROPERTY, DOME_SNOOP_GPS_ITEM->text.value, GEOGRAPHIC_COORDINATES_PROPERTY_NAME);
+				add_slaving_snoop_rules(device);
 			}
 			indigo_update_property(device, DOME_SLAVING_PROPERTY, NULL);
 		}
@@ -331,6 +401,7 @@ indigo_result indigo_dome_change_property(indigo_device *device, indigo_client *
 		// -------------------------------------------------------------------------------- DOME_SLAVING_PARAMETERS
 	} else if (indigo_property_match(DOME_SLAVING_PARAMETERS_PROPERTY, property)) {
 		indigo_property_copy_values(DOME_SLAVING_PARAMETERS_PROPERTY, property, false);
+		DOME_CONTEXT->slaving_deadline = 0;
 		DOME_SLAVING_PARAMETERS_PROPERTY->state = INDIGO_OK_STATE;
 		if (IS_CONNECTED) {
 			indigo_update_property(device, DOME_SLAVING_PARAMETERS_PROPERTY, NULL);
@@ -339,6 +410,7 @@ indigo_result indigo_dome_change_property(indigo_device *device, indigo_client *
 		// -------------------------------------------------------------------------------- DOME_DIMENSION
 	} else if (indigo_property_match(DOME_DIMENSION_PROPERTY, property)) {
 		indigo_property_copy_values(DOME_DIMENSION_PROPERTY, property, false);
+		DOME_CONTEXT->slaving_deadline = 0;
 		DOME_DIMENSION_PROPERTY->state = INDIGO_OK_STATE;
 		indigo_update_property(device, DOME_DIMENSION_PROPERTY, NULL);
 		return INDIGO_OK;
@@ -353,15 +425,40 @@ indigo_result indigo_dome_change_property(indigo_device *device, indigo_client *
 		}
 		// -------------------------------------------------------------------------------- SNOOP_DEVICES
 	} else if (indigo_property_match(DOME_SNOOP_DEVICES_PROPERTY, property)) {
-		indigo_remove_snoop_rule(DOME_EQUATORIAL_COORDINATES_PROPERTY, DOME_SNOOP_MOUNT_ITEM->text.value, MOUNT_EQUATORIAL_COORDINATES_PROPERTY_NAME);
-		indigo_remove_snoop_rule(DOME_GEOGRAPHIC_COORDINATES_PROPERTY, DOME_SNOOP_GPS_ITEM->text.value, GEOGRAPHIC_COORDINATES_PROPERTY_NAME);
+		remove_slaving_snoop_rules(device);
 		indigo_property_copy_values(DOME_SNOOP_DEVICES_PROPERTY, property, false);
 		indigo_trim_local_service(DOME_SNOOP_MOUNT_ITEM->text.value);
 		indigo_trim_local_service(DOME_SNOOP_GPS_ITEM->text.value);
-		indigo_add_snoop_rule(DOME_EQUATORIAL_COORDINATES_PROPERTY, DOME_SNOOP_MOUNT_ITEM->text.value, MOUNT_EQUATORIAL_COORDINATES_PROPERTY_NAME);
-		indigo_add_snoop_rule(DOME_GEOGRAPHIC_COORDINATES_PROPERTY, DOME_SNOOP_GPS_ITEM->text.value, GEOGRAPHIC_COORDINATES_PROPERTY_NAME);
+		add_slaving_snoop_rules(device);
 		DOME_SNOOP_DEVICES_PROPERTY->state = INDIGO_OK_STATE;
 		indigo_update_property(device, DOME_SNOOP_DEVICES_PROPERTY, NULL);
+		// -------------------------------------------------------------------------------- DOME_MOUNT_TRACKING
+	} else if (indigo_property_match(DOME_MOUNT_TRACKING_PROPERTY, property)) {
+		indigo_property_copy_values(DOME_MOUNT_TRACKING_PROPERTY, property, false);
+		DOME_CONTEXT->slaving_deadline = 0;
+		DOME_MOUNT_TRACKING_PROPERTY->state = INDIGO_OK_STATE;
+		if (IS_CONNECTED) {
+			indigo_update_property(device, DOME_MOUNT_TRACKING_PROPERTY, NULL);
+		}
+		return INDIGO_OK;
+		// -------------------------------------------------------------------------------- DOME_MOUNT_TRACK_RATE
+	} else if (indigo_property_match(DOME_MOUNT_TRACK_RATE_PROPERTY, property)) {
+		indigo_property_copy_values(DOME_MOUNT_TRACK_RATE_PROPERTY, property, false);
+		DOME_CONTEXT->slaving_deadline = 0;
+		DOME_MOUNT_TRACK_RATE_PROPERTY->state = INDIGO_OK_STATE;
+		if (IS_CONNECTED) {
+			indigo_update_property(device, DOME_MOUNT_TRACK_RATE_PROPERTY, NULL);
+		}
+		return INDIGO_OK;
+		// -------------------------------------------------------------------------------- DOME_MOUNT_CUSTOM_TRACKING_RATE
+	} else if (indigo_property_match(DOME_MOUNT_CUSTOM_TRACKING_RATE_PROPERTY, property)) {
+		indigo_property_copy_values(DOME_MOUNT_CUSTOM_TRACKING_RATE_PROPERTY, property, false);
+		DOME_CONTEXT->slaving_deadline = 0;
+		DOME_MOUNT_CUSTOM_TRACKING_RATE_PROPERTY->state = INDIGO_OK_STATE;
+		if (IS_CONNECTED) {
+			indigo_update_property(device, DOME_MOUNT_CUSTOM_TRACKING_RATE_PROPERTY, NULL);
+		}
+		return INDIGO_OK;
 	}
 	return indigo_device_change_property(device, client, property);
 }
@@ -385,6 +482,10 @@ indigo_result indigo_dome_detach(indigo_device *device) {
 	indigo_release_property(DOME_UTC_TIME_PROPERTY);
 	indigo_release_property(DOME_SET_HOST_TIME_PROPERTY);
 	indigo_release_property(DOME_SNOOP_DEVICES_PROPERTY);
+	indigo_release_property(DOME_MOUNT_TRACKING_PROPERTY);
+	indigo_release_property(DOME_MOUNT_TRACK_RATE_PROPERTY);
+	indigo_release_property(DOME_MOUNT_CUSTOM_TRACKING_RATE_PROPERTY);
+	pthread_mutex_destroy(&DOME_CONTEXT->slaving_mutex);
 	return indigo_device_detach(device);
 }
 
@@ -396,31 +497,132 @@ time_t indigo_get_dome_utc(indigo_device *device) {
 	}
 }
 
+static double dome_azimuth(indigo_device *device, double ha, double dec) {
+	return indigo_dome_solve_azimuth (
+		map24(ha),
+		dec,
+		DOME_GEOGRAPHIC_COORDINATES_LATITUDE_ITEM->number.value,
+		DOME_RADIUS_ITEM->number.value,
+		DOME_MOUNT_PIVOT_VERTICAL_OFFSET_ITEM->number.value,
+		DOME_MOUNT_PIVOT_OTA_OFFSET_ITEM->number.value,
+		DOME_MOUNT_PIVOT_OFFSET_NS_ITEM->number.value,
+		DOME_MOUNT_PIVOT_OFFSET_EW_ITEM->number.value
+	);
+}
+
+static double azimuth_difference(double az1, double az2) {
+	double diff = fmod(az1 - az2 + 540, 360) - 180;
+	return diff;
+}
+
+/* hour angle and declination rates of the telescope in arcsec/s as reported by the snooped mount */
+
+static double mount_ha_rate(indigo_device *device) {
+	if (DOME_MOUNT_TRACKING_OFF_ITEM->sw.value)
+		return 0;
+	if (DOME_MOUNT_TRACK_RATE_SOLAR_ITEM->sw.value)
+		return SOLAR_HA_RATE;
+	if (DOME_MOUNT_TRACK_RATE_LUNAR_ITEM->sw.value)
+		return LUNAR_HA_RATE;
+	if (DOME_MOUNT_TRACK_RATE_KING_ITEM->sw.value)
+		return KING_HA_RATE;
+	if (DOME_MOUNT_TRACK_RATE_CUSTOM_ITEM->sw.value)
+		return SIDEREAL_HA_RATE - DOME_MOUNT_CUSTOM_TRACKING_RATE_RA_ITEM->number.value;
+	return SIDEREAL_HA_RATE;
+}
+
+static double mount_dec_rate(indigo_device *device) {
+	if (DOME_MOUNT_TRACKING_ON_ITEM->sw.value && DOME_MOUNT_TRACK_RATE_CUSTOM_ITEM->sw.value)
+		return DOME_MOUNT_CUSTOM_TRACKING_RATE_DEC_ITEM->number.value;
+	return 0;
+}
+
+static double predicted_dome_azimuth(indigo_device *device, double ha, double dec, double ha_rate, double dec_rate, double t) {
+	return dome_azimuth(device, ha + t * ha_rate / 54000.0, fmax(-90, fmin(90, dec + t * dec_rate / 3600.0)));
+}
+
+/* seconds until hour angle crosses meridian or anti-meridian where solver switches the side of pier */
+
+static double time_to_flip(double ha, double ha_rate) {
+	double ha0 = map24(ha);
+	if (ha0 >= 12.0)
+		ha0 -= 24.0;
+	if (ha_rate > 0)
+		return (ha0 < 0 ? -ha0 : 12.0 - ha0) * 54000.0 / ha_rate;
+	if (ha_rate < 0)
+		return (ha0 > 0 ? ha0 : 12.0 + ha0) * 54000.0 / -ha_rate;
+	return INFINITY;
+}
+
 bool indigo_fix_dome_azimuth(indigo_device *device, double ra, double dec, double az_prev, double *az) {
 	bool update_needed = false;
 	if (!DOME_GEOGRAPHIC_COORDINATES_PROPERTY->hidden && !DOME_HORIZONTAL_COORDINATES_PROPERTY->hidden) {
 		double threshold = DOME_SLAVING_THRESHOLD_ITEM->number.value;
+		double lead = DOME_SLAVING_LEAD_TIME_ITEM->number.value;
+		double half_width = asin(fmin(1, DOME_SHUTTER_WIDTH_ITEM->number.value / 2 / DOME_RADIUS_ITEM->number.value)) * 180 / M_PI - DOME_SLAVING_MARGIN_ITEM->number.value;
 		time_t utc = indigo_get_dome_utc(device);
 		double lst = indigo_lst(&utc, DOME_GEOGRAPHIC_COORDINATES_LONGITUDE_ITEM->number.value);
 		double ha = map24(lst - ra);
-		*az = indigo_dome_solve_azimuth (
-			ha,
-			dec,
-			DOME_GEOGRAPHIC_COORDINATES_LATITUDE_ITEM->number.value,
-			DOME_RADIUS_ITEM->number.value,
-			DOME_MOUNT_PIVOT_VERTICAL_OFFSET_ITEM->number.value,
-			DOME_MOUNT_PIVOT_OTA_OFFSET_ITEM->number.value,
-			DOME_MOUNT_PIVOT_OFFSET_NS_ITEM->number.value,
-			DOME_MOUNT_PIVOT_OFFSET_EW_ITEM->number.value
-		);
-		double diff = az_prev - *az;
-		if (fabs(diff) >= threshold) {
-			INDIGO_DRIVER_DEBUG("dome_driver", "Update dome Az diff = %.4f, threshold = %.4f", fabs(diff), threshold);
-			update_needed = true;
-		} else {
-			INDIGO_DRIVER_DEBUG("dome_driver", "No dome Az update needed diff = %.4f, threshold = %.4f", fabs(diff), threshold);
+		double ha_rate = mount_ha_rate(device);
+		double dec_rate = mount_dec_rate(device);
+		*az = dome_azimuth(device, ha, dec);
+		pthread_mutex_lock(&DOME_CONTEXT->slaving_mutex);
+		if (half_width <= 0) {
+			/* slit is too narrow to predict, follow the telescope as soon as it moves more than threshold */
+			double diff = azimuth_difference(az_prev, *az);
+			if (fabs(diff) >= threshold) {
+				INDIGO_DRIVER_DEBUG("dome_driver", "Update dome Az diff = %.4f, threshold = %.4f", fabs(diff), threshold);
+				update_needed = true;
+			} else {
+				INDIGO_DRIVER_DEBUG("dome_driver", "No dome Az update needed diff = %.4f, threshold = %.4f", fabs(diff), threshold);
+				update_needed = false;
+			}
+			DOME_CONTEXT->slaving_deadline = utc + SYNC_INTERAL;
+		} else if (utc < DOME_CONTEXT->slaving_deadline && fabs(map24(ra - DOME_CONTEXT->slaving_ra - (utc - DOME_CONTEXT->slaving_utc) * (SIDEREAL_HA_RATE - ha_rate) / 54000.0 + 12) - 12) * 15 + fabs(dec - DOME_CONTEXT->slaving_dec - (utc - DOME_CONTEXT->slaving_utc) * dec_rate / 3600.0) < 0.01 && fabs(azimuth_difference(az_prev, DOME_CONTEXT->slaving_az)) < 0.01) {
+			/* telescope is where it was expected to be when the deadline was computed */
+			INDIGO_DRIVER_DEBUG("dome_driver", "No dome Az update needed for next %lds", (long)(DOME_CONTEXT->slaving_deadline - utc));
 			update_needed = false;
+		} else {
+			/* don't look over the meridian, after flip the telescope is on the other side of the dome */
+			double horizon = fmin(time_to_flip(ha, ha_rate), SLAVING_LOOKAHEAD);
+			double dome_az = az_prev;
+			if (fabs(azimuth_difference(*az, az_prev)) > half_width || (lead < horizon && fabs(azimuth_difference(predicted_dome_azimuth(device, ha, dec, ha_rate, dec_rate, lead), az_prev)) > half_width)) {
+				/* move ahead of the telescope as far as the slit still covers it now */
+				double target = *az;
+				for (double t = SLAVING_STEP; t < horizon; t += SLAVING_STEP) {
+					double az_t = predicted_dome_azimuth(device, ha, dec, ha_rate, dec_rate, t);
+					if (fabs(azimuth_difference(az_t, *az)) > half_width)
+						break;
+					target = az_t;
+				}
+				double diff = azimuth_difference(az_prev, target);
+				if (fabs(diff) >= threshold) {
+					INDIGO_DRIVER_DEBUG("dome_driver", "Update dome Az diff = %.4f, threshold = %.4f, slit half width = %.4f", fabs(diff), threshold, half_width);
+					dome_az = *az = target;
+					update_needed = true;
+				}
+			}
+			/* wake up when telescope is about to leave the slit or when it crosses the meridian */
+			double deadline = horizon + 1;
+			for (double t = SLAVING_STEP; t < horizon; t += SLAVING_STEP) {
+				if (fabs(azimuth_difference(predicted_dome_azimuth(device, ha, dec, ha_rate, dec_rate, t), dome_az)) > half_width) {
+					deadline = fmax(1, t - SLAVING_STEP - lead);
+					break;
+				}
+			}
+			DOME_CONTEXT->slaving_ra = ra;
+			DOME_CONTEXT->slaving_dec = dec;
+			DOME_CONTEXT->slaving_utc = utc;
+			DOME_CONTEXT->slaving_az = round(dome_az * 100) / 100;
+			DOME_CONTEXT->slaving_deadline = utc + (time_t)deadline;
+			INDIGO_DRIVER_DEBUG("dome_driver", "Dome Az = %.4f covers telescope for next %.0fs", dome_az, deadline);
+		}
+		if (DOME_CONTEXT->sync_timer != NULL && !DOME_CONTEXT->sync_running && DOME_CONTEXT->slaving_deadline < DOME_CONTEXT->sync_time) {
+			indigo_cancel_timer(device, &DOME_CONTEXT->sync_timer);
+			DOME_CONTEXT->sync_time = DOME_CONTEXT->slaving_deadline;
+			indigo_set_timer(device, DOME_CONTEXT->slaving_deadline - utc, sync_timer_callback, &DOME_CONTEXT->sync_timer);
 		}
+		pthread_mutex_unlock(&DOME_CONTEXT->slaving_mutex);
 		*az = round(*az * 100) / 100;
 		INDIGO_DRIVER_DEBUG("dome_driver","ha = %.5f, lst = %.5f, dec = %.5f, az = %.4f, az_prev = %.4f", ha, lst, dec, *az, az_prev);
 	}
@@ -66,6 +66,7 @@
 #include <indigo/indigo_xml.h>
 #include <indigo/indigo_names.h>
 #include <indigo/indigo_io.h>
+#include <indigo/indigo_store.h>
 
 indigo_result indigo_try_global_lock(indigo_device *device) {
 	if (indigo_is_sandboxed)
@@ -228,6 +229,173 @@ void indigo_enumerate_serial_ports(indigo_device *device, indigo_property *prope
 #endif
 }
 
+// per-device handler queues executed by shared worker pool, device is in ready list only while not being executed so its handlers never run concurrently
+
+#define MAX_WORKERS		32
+
+typedef struct work_item {
+	indigo_timer_callback handler;
+	struct work_item *next;
+} work_item;
+
+typedef struct work_queue {
+	indigo_device *device;
+	work_item *head, *tail;
+	bool ready, running;
+	pthread_t thread;
+	struct work_queue *next;
+} work_queue;
+
+static pthread_mutex_t work_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t work_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t work_done_cond = PTHREAD_COND_INITIALIZER;
+static work_queue *ready_head = NULL, *ready_tail = NULL;
+static int worker_count = 0, idle_workers = 0;
+
+static void *worker_thread(void *data) {
+	pthread_detach(pthread_self());
+	pthread_mutex_lock(&work_mutex);
+	while (true) {
+		while (ready_head == NULL) {
+			idle_workers++;
+			pthread_cond_wait(&work_cond, &work_mutex);
+			idle_workers--;
+		}
+		work_queue *queue = ready_head;
+		if ((ready_head = queue->next) == NULL)
+			ready_tail = NULL;
+		queue->ready = false;
+		work_item *item = queue->head;
+		if ((queue->head = item->next) == NULL)
+			queue->tail = NULL;
+		queue->running = true;
+		queue->thread = pthread_self();
+		pthread_mutex_unlock(&work_mutex);
+		item->handler(queue->device);
+		free(item);
+		pthread_mutex_lock(&work_mutex);
+		queue->running = false;
+		if (queue->device == NULL) {
+			// device was detached by its own handler
+			free(queue);
+		} else if (queue->head) {
+			queue->ready = true;
+			queue->next = NULL;
+			if (ready_tail)
+				ready_tail->next = queue;
+			else
+				ready_head = queue;
+			ready_tail = queue;
+		}
+		pthread_cond_broadcast(&work_done_cond);
+	}
+	return NULL;
+}
+
+bool indigo_execute_handler(indigo_device *device, indigo_timer_callback handler) {
+	assert(device != NULL && DEVICE_CONTEXT != NULL);
+	work_item *item = malloc(sizeof(work_item));
+	if (item == NULL)
+		return false;
+	item->handler = handler;
+	item->next = NULL;
+	pthread_mutex_lock(&work_mutex);
+	work_queue *queue = DEVICE_CONTEXT->work_queue;
+	if (queue == NULL) {
+		queue = DEVICE_CONTEXT->work_queue = malloc(sizeof(work_queue));
+		if (queue == NULL) {
+			pthread_mutex_unlock(&work_mutex);
+			free(item);
+			return false;
+		}
+		memset(queue, 0, sizeof(work_queue));
+		queue->device = device;
+	}
+	if (queue->tail)
+		queue->tail->next = item;
+	else
+		queue->head = item;
+	queue->tail = item;
+	if (!queue->ready && !queue->running) {
+		queue->ready = true;
+		queue->next = NULL;
+		if (ready_tail)
+			ready_tail->next = queue;
+		else
+			ready_head = queue;
+		ready_tail = queue;
+		if (idle_workers == 0 && worker_count < MAX_WORKERS) {
+			pthread_t thread;
+			if (pthread_create(&thread, NULL, worker_thread, NULL) == 0)
+				worker_count++;
+			else
+				INDIGO_ERROR(indigo_error("%s(): %s", __FUNCTION__, strerror(errno)));
+		}
+		pthread_cond_signal(&work_cond);
+	}
+	pthread_mutex_unlock(&work_mutex);
+	return true;
+}
+
+static work_queue *drop_pending_handlers(indigo_device *device) {
+	work_queue *queue = DEVICE_CONTEXT->work_queue;
+	if (queue) {
+		while (queue->head) {
+			work_item *item = queue->head;
+			queue->head = item->next;
+			free(item);
+		}
+		queue->tail = NULL;
+		if (queue->ready) {
+			work_queue **previous = &ready_head;
+			ready_tail = NULL;
+			while (*previous) {
+				if (*previous == queue)
+					*previous = queue->next;
+				else {
+					ready_tail = *previous;
+					previous = &(*previous)->next;
+				}
+			}
+			queue->ready = false;
+		}
+	}
+	return queue;
+}
+
+void indigo_cancel_pending_handlers(indigo_device *device) {
+	if (DEVICE_CONTEXT == NULL)
+		return;
+	pthread_mutex_lock(&work_mutex);
+	drop_pending_handlers(device);
+	pthread_mutex_unlock(&work_mutex);
+}
+
+void indigo_cancel_pending_handlers_sync(indigo_device *device) {
+	if (DEVICE_CONTEXT == NULL)
+		return;
+	pthread_mutex_lock(&work_mutex);
+	work_queue *queue = drop_pending_handlers(device);
+	// handler can't wait for itself, e.g. when device is detached from its own handler
+	while (queue && queue->running && !pthread_equal(queue->thread, pthread_self()))
+		pthread_cond_wait(&work_done_cond, &work_mutex);
+	pthread_mutex_unlock(&work_mutex);
+}
+
+static void release_work_queue(indigo_device *device) {
+	indigo_cancel_pending_handlers_sync(device);
+	pthread_mutex_lock(&work_mutex);
+	work_queue *queue = DEVICE_CONTEXT->work_queue;
+	if (queue != NULL) {
+		if (queue->running)
+			queue->device = NULL;
+		else
+			free(queue);
+		DEVICE_CONTEXT->work_queue = NULL;
+	}
+	pthread_mutex_unlock(&work_mutex);
+}
+
 indigo_result indigo_device_attach(indigo_device *device, const char* driver_name, indigo_version version, int interface) {
 	assert(device != NULL);
 	assert(device != NULL);
@@ -375,13 +543,10 @@ indigo_result indigo_device_change_property(indigo_device *device, indigo_client
 			indigo_save_property(device, NULL, SIMULATION_PROPERTY);
 			indigo_save_property(device, NULL, DEVICE_PORT_PROPERTY);
 			indigo_save_property(device, NULL, DEVICE_BAUDRATE_PROPERTY);
-			if (DEVICE_CONTEXT->property_save_file_handle) {
+			if (indigo_commit_saved_properties(device, NULL) == INDIGO_OK)
 				CONFIG_PROPERTY->state = INDIGO_OK_STATE;
-				close(DEVICE_CONTEXT->property_save_file_handle);
-				DEVICE_CONTEXT->property_save_file_handle = 0;
-			} else {
+			else
 				CONFIG_PROPERTY->state = INDIGO_ALERT_STATE;
-			}
 			CONFIG_SAVE_ITEM->sw.value = false;
 		} else if (indigo_switch_match(CONFIG_REMOVE_ITEM, property)) {
 			if (indigo_remove_properties(device) == INDIGO_OK)
@@ -465,6 +630,7 @@ indigo_result indigo_device_detach(indigo_device *device) {
 	indigo_property *all_properties = indigo_init_text_property(NULL, device->name, "", "", "", INDIGO_OK_STATE, INDIGO_RO_PERM, 0);
 	indigo_delete_property(device, all_properties, NULL);
 	indigo_release_property(all_properties);
+	release_work_queue(device);
 	free(DEVICE_CONTEXT);
 	device->device_context = NULL;
 	return INDIGO_OK;
@@ -511,6 +677,220 @@ int indigo_open_config_file(char *device_name, int profile, int mode, const char
 	return -1;
 }
 
+indigo_store *indigo_open_config_store(char *device_name, int profile, const char *suffix, bool create, char *path, int size) {
+	if (make_config_file_name(device_name, profile, suffix, path, size))
+		return indigo_store_open(path, create);
+	INDIGO_DEBUG(indigo_debug("Can't create %s (%s)", path, strerror(errno)));
+	return NULL;
+}
+
+//  Property record is format version and property type followed by item names and values (zero terminated text, double or byte)
+
+#define PROPERTY_RECORD_VERSION	1
+
+static void *property_record(indigo_property *property, int *length) {
+	int size = 2;
+	for (int i = 0; i < property->count; i++) {
+		indigo_item *item = property->items + i;
+		size += strlen(item->name) + 1;
+		if (property->type == INDIGO_TEXT_VECTOR)
+			size += strlen(item->text.value) + 1;
+		else if (property->type == INDIGO_NUMBER_VECTOR)
+			size += sizeof(double);
+		else
+			size += 1;
+	}
+	uint8_t *record = malloc(size);
+	assert(record != NULL);
+	uint8_t *pnt = record;
+	*pnt++ = PROPERTY_RECORD_VERSION;
+	*pnt++ = property->type;
+	for (int i = 0; i < property->count; i++) {
+		indigo_item *item = property->items + i;
+		pnt = (uint8_t *)stpcpy((char *)pnt, item->name) + 1;
+		if (property->type == INDIGO_TEXT_VECTOR) {
+			pnt = (uint8_t *)stpcpy((char *)pnt, item->text.value) + 1;
+		} else if (property->type == INDIGO_NUMBER_VECTOR) {
+			memcpy(pnt, &item->number.value, sizeof(double));
+			pnt += sizeof(double);
+		} else {
+			*pnt++ = item->sw.value;
+		}
+	}
+	*length = size;
+	return record;
+}
+
+static bool property_record_item(int type, const uint8_t **pnt, const uint8_t *end, const char **name, const uint8_t **value) {
+	const uint8_t *terminator = memchr(*pnt, 0, end - *pnt);
+	if (terminator == NULL)
+		return false;
+	*name = (const char *)*pnt;
+	*value = terminator + 1;
+	if (type == INDIGO_TEXT_VECTOR) {
+		terminator = memchr(*value, 0, end - *value);
+		if (terminator == NULL)
+			return false;
+		*pnt = terminator + 1;
+	} else {
+		*pnt = *value + (type == INDIGO_NUMBER_VECTOR ? sizeof(double) : 1);
+	}
+	return *pnt <= end;
+}
+
+static indigo_property *record_property(const char *device_name, const char *name, const uint8_t *record, int length) {
+	if (length < 2 || record[0] != PROPERTY_RECORD_VERSION)
+		return NULL;
+	int type = record[1], count = 0;
+	const uint8_t *end = record + length, *pnt = record + 2, *value;
+	const char *item_name;
+	while (pnt < end) {
+		if (count == INDIGO_MAX_ITEMS || !property_record_item(type, &pnt, end, &item_name, &value))
+			return NULL;
+		count++;
+	}
+	indigo_property *property;
+	switch (type) {
+		case INDIGO_TEXT_VECTOR:
+			property = indigo_init_text_property(NULL, device_name, name, "", "", INDIGO_OK_STATE, INDIGO_RW_PERM, count);
+			break;
+		case INDIGO_NUMBER_VECTOR:
+			property = indigo_init_number_property(NULL, device_name, name, "", "", INDIGO_OK_STATE, INDIGO_RW_PERM, count);
+			break;
+		case INDIGO_SWITCH_VECTOR:
+			property = indigo_init_switch_property(NULL, device_name, name, "", "", INDIGO_OK_STATE, INDIGO_RW_PERM, INDIGO_ANY_OF_MANY_RULE, count);
+			break;
+		default:
+			return NULL;
+	}
+	pnt = record + 2;
+	for (int i = 0; i < count; i++) {
+		indigo_item *item = property->items + i;
+		property_record_item(type, &pnt, end, &item_name, &value);
+		if (type == INDIGO_TEXT_VECTOR) {
+			indigo_init_text_item(item, item_name, "", "%s", (const char *)value);
+		} else if (type == INDIGO_NUMBER_VECTOR) {
+			double number;
+			memcpy(&number, value, sizeof(double));
+			indigo_init_number_item(item, item_name, "", 0, 0, 0, number);
+		} else {
+			indigo_init_switch_item(item, item_name, "", *value != 0);
+		}
+	}
+	return property;
+}
+
+static void xml_unescape(char *string) {
+	static struct { const char *entity; char c; } entities[] = { { "&amp;", '&' }, { "&lt;", '<' }, { "&gt;", '>' }, { "&quot;", '"' }, { "&apos;", '\'' } };
+	char *out = string;
+	while (*string) {
+		bool found = false;
+		if (*string == '&') {
+			for (int i = 0; i < 5; i++) {
+				int length = strlen(entities[i].entity);
+				if (!strncmp(string, entities[i].entity, length)) {
+					*out++ = entities[i].c;
+					string += length;
+					found = true;
+					break;
+				}
+			}
+		}
+		if (!found)
+			*out++ = *string++;
+	}
+	*out = 0;
+}
+
+//  Import .config file written by previous versions (one element per line as written by indigo_save_property)
+
+static bool import_config_file(indigo_store *store, int handle) {
+	char buffer[INDIGO_VALUE_SIZE * 6 + 128], type[16], name[INDIGO_NAME_SIZE];
+	indigo_property *property = NULL;
+	bool result = true;
+	while (result && indigo_read_line(handle, buffer, sizeof(buffer) - 1) >= 0) {
+		char *line = buffer;
+		while (*line == ' ' || *line == '\t')
+			line++;
+		if (*line == 0)
+			continue;
+		if (property == NULL) {
+			if (sscanf(line, "<new%15[^V]Vector device='%*[^']' name='%63[^']'>", type, name) != 2) {
+				result = false;
+			} else if (!strcmp(type, "Text")) {
+				property = indigo_init_text_property(NULL, "", name, "", "", INDIGO_OK_STATE, INDIGO_RW_PERM, INDIGO_MAX_ITEMS);
+			} else if (!strcmp(type, "Number")) {
+				property = indigo_init_number_property(NULL, "", name, "", "", INDIGO_OK_STATE, INDIGO_RW_PERM, INDIGO_MAX_ITEMS);
+			} else if (!strcmp(type, "Switch")) {
+				property = indigo_init_switch_property(NULL, "", name, "", "", INDIGO_OK_STATE, INDIGO_RW_PERM, INDIGO_ANY_OF_MANY_RULE, INDIGO_MAX_ITEMS);
+			} else {
+				result = false;
+			}
+			if (property)
+				property->count = 0;
+		} else if (!strncmp(line, "</new", 5)) {
+			int length;
+			void *record = property_record(property, &length);
+			result = indigo_store_put(store, property->name, record, length);
+			free(record);
+			indigo_release_property(property);
+			property = NULL;
+		} else {
+			char *item_name = strstr(line, "name='");
+			char *value = item_name ? strstr(item_name + 6, "'>") : NULL;
+			char *value_end = value ? strstr(value + 2, "</one") : NULL;
+			if (strncmp(line, "<one", 4) || value_end == NULL || property->count == INDIGO_MAX_ITEMS) {
+				result = false;
+				break;
+			}
+			indigo_item *item = property->items + property->count++;
+			*value = *value_end = 0;
+			value += 2;
+			xml_unescape(value);
+			strncpy(item->name, item_name + 6, INDIGO_NAME_SIZE - 1);
+			if (property->type == INDIGO_TEXT_VECTOR)
+				strncpy(item->text.value, value, INDIGO_VALUE_SIZE - 1);
+			else if (property->type == INDIGO_NUMBER_VECTOR)
+				item->number.value = indigo_atod(value);
+			else
+				item->sw.value = !strcmp(value, "On");
+		}
+	}
+	if (property) {
+		indigo_release_property(property);
+		result = false;
+	}
+	return result;
+}
+
+//  Open .config.store, if there is only .config from previous version, it is imported to temporary store renamed to .config.store when complete
+
+static indigo_store *open_config_store(char *device_name, int profile) {
+	char path[512];
+	indigo_store *store = indigo_open_config_store(device_name, profile, ".config.store", false, path, sizeof(path));
+	if (store == NULL) {
+		int handle = indigo_open_config_file(device_name, profile, O_RDONLY, ".config");
+		if (handle > 0) {
+			char import_path[512];
+			make_config_file_name(device_name, profile, ".config.import", import_path, sizeof(import_path));
+			unlink(import_path);
+			store = indigo_store_open(import_path, true);
+			if (store != NULL) {
+				if (import_config_file(store, handle) && rename(import_path, path) == 0) {
+					INDIGO_LOG(indigo_log("%s imported to %s", device_name, path));
+				} else {
+					INDIGO_ERROR(indigo_error("Can't import .config file of %s", device_name));
+					indigo_store_close(store);
+					unlink(import_path);
+					store = NULL;
+				}
+			}
+			close(handle);
+		}
+	}
+	return store;
+}
+
 indigo_result indigo_load_properties(indigo_device *device, bool default_properties) {
 	assert(device != NULL);
 	int profile = 0;
@@ -521,32 +901,49 @@ indigo_result indigo_load_properties(indigo_device *device, bool default_propert
 				break;
 			}
 	}
+	indigo_client *client = malloc(sizeof(indigo_client));
+	assert(client != NULL);
+	memset(client, 0, sizeof(indigo_client));
+	strcpy(client->name, CONFIG_READER);
+	client->version = INDIGO_VERSION_CURRENT;
+	indigo_store *store = default_properties ? NULL : open_config_store(device->name, profile);
+	if (store != NULL) {
+		for (int i = 0; i < indigo_store_count(store); i++) {
+			int length;
+			const void *record = indigo_store_value(store, i, &length);
+			indigo_property *property = record_property(device->name, indigo_store_key(store, i), record, length);
+			if (property) {
+				indigo_change_property(client, property);
+				indigo_release_property(property);
+			} else {
+				INDIGO_DEBUG(indigo_debug("Invalid record %s of %s", indigo_store_key(store, i), device->name));
+			}
+		}
+		indigo_store_close(store);
+		free(client);
+		return INDIGO_OK;
+	}
 	int handle = indigo_open_config_file(device->name, profile, O_RDONLY, default_properties ? ".default" : ".config");
 	if (handle > 0) {
-		indigo_client *client = malloc(sizeof(indigo_client));
-		memset(client, 0, sizeof(indigo_client));
-		strcpy(client->name, CONFIG_READER);
 		indigo_adapter_context *context = malloc(sizeof(indigo_adapter_context));
 		context->input = handle;
 		client->client_context = context;
-		client->version = INDIGO_VERSION_CURRENT;
 		indigo_xml_parse(NULL, client);
 		close(handle);
 		free(context);
-		free(client);
 	}
+	free(client);
 	return handle > 0 ? INDIGO_OK : INDIGO_FAILED;
 }
 
 indigo_result indigo_save_property(indigo_device*device, int *file_handle, indigo_property *property) {
 	if (property == NULL)
 		return INDIGO_FAILED;
-	if (!property->hidden && property->perm != INDIGO_RO_PERM) {
-		char b1[32];
+	if (!property->hidden && property->perm != INDIGO_RO_PERM && (property->type == INDIGO_TEXT_VECTOR || property->type == INDIGO_NUMBER_VECTOR || property->type == INDIGO_SWITCH_VECTOR)) {
 		if (file_handle == NULL)
 			file_handle = &DEVICE_CONTEXT->property_save_file_handle;
 		int handle = *file_handle;
-		if (handle == 0) {
+		if (handle <= 0) {
 			int profile = 0;
 			if (DEVICE_CONTEXT) {
 				for (int i = 0; i < PROFILE_COUNT; i++)
@@ -555,42 +952,35 @@ indigo_result indigo_save_property(indigo_device*device, int *file_handle, indig
 						break;
 					}
 			}
-			*file_handle = handle = indigo_open_config_file(property->device, profile, O_WRONLY | O_CREAT | O_TRUNC, ".config");
-			if (handle == 0)
+			//  Save replaces whole store on commit, so properties which are no longer saved are dropped
+			char path[512];
+			if (!make_config_file_name(property->device, profile, ".config.store", path, sizeof(path)))
 				return INDIGO_FAILED;
+			handle = indigo_store_begin(path);
+			if (handle < 0)
+				return INDIGO_FAILED;
+			*file_handle = handle;
 		}
-		switch (property->type) {
-		case INDIGO_TEXT_VECTOR:
-			indigo_printf(handle, "<newTextVector device='%s' name='%s'>\n", indigo_xml_escape(property->device), property->name, indigo_property_state_text[property->state]);
-			for (int i = 0; i < property->count; i++) {
-				indigo_item *item = &property->items[i];
-				indigo_printf(handle, "<oneText name='%s'>%s</oneText>\n", item->name, indigo_xml_escape(item->text.value));
-			}
-			indigo_printf(handle, "</newTextVector>\n");
-			break;
-		case INDIGO_NUMBER_VECTOR:
-			indigo_printf(handle, "<newNumberVector device='%s' name='%s'>\n", indigo_xml_escape(property->device), property->name, indigo_property_state_text[property->state]);
-			for (int i = 0; i < property->count; i++) {
-				indigo_item *item = &property->items[i];
-				indigo_printf(handle, "<oneNumber name='%s'>%s</oneNumber>\n", item->name, indigo_dtoa(item->number.value, b1));
-			}
-			indigo_printf(handle, "</newNumberVector>\n");
-			break;
-		case INDIGO_SWITCH_VECTOR:
-			indigo_printf(handle, "<newSwitchVector device='%s' name='%s'>\n", indigo_xml_escape(property->device), property->name, indigo_property_state_text[property->state]);
-			for (int i = 0; i < property->count; i++) {
-				indigo_item *item = &property->items[i];
-				indigo_printf(handle, "<oneSwitch name='%s'>%s</oneSwitch>\n", item->name, item->sw.value ? "On" : "Off");
-			}
-			indigo_printf(handle, "</newSwitchVector>\n");
-			break;
-		default:
-			break;
-		}
+		int length;
+		void *record = property_record(property, &length);
+		bool result = indigo_store_append(handle, property->name, record, length);
+		free(record);
+		if (!result)
+			return INDIGO_FAILED;
 	}
 	return INDIGO_OK;
 }
 
+indigo_result indigo_commit_saved_properties(indigo_device *device, int *file_handle) {
+	if (file_handle == NULL)
+		file_handle = &DEVICE_CONTEXT->property_save_file_handle;
+	int handle = *file_handle;
+	if (handle <= 0)
+		return INDIGO_FAILED;
+	*file_handle = 0;
+	return indigo_store_commit(handle) ? INDIGO_OK : INDIGO_FAILED;
+}
+
 indigo_result indigo_remove_properties(indigo_device *device) {
 	assert(device != NULL);
 	int profile = 0;
@@ -601,12 +991,17 @@ indigo_result indigo_remove_properties(indigo_device *device) {
 				break;
 			}
 	}
-	static char path[512];
+	char path[512];
+	indigo_result result = INDIGO_FAILED;
+	if (make_config_file_name(device->name, profile, ".config.store", path, sizeof(path))) {
+		if (unlink(path) == 0)
+			result = INDIGO_OK;
+	}
 	if (make_config_file_name(device->name, profile, ".config", path, sizeof(path))) {
 		if (unlink(path) == 0)
-			return INDIGO_OK;
+			result = INDIGO_OK;
 	}
-	return INDIGO_FAILED;
+	return result;
 }
 
 static void *hotplug_thread(void *arg) {
@@ -680,6 +1075,42 @@ time_t indigo_isolocaltotime(char *isotime) {
 	return -1;
 }
 
+#define UTC_OFFSET_VALIDITY	10
+
+static pthread_mutex_t utc_mutex = PTHREAD_MUTEX_INITIALIZER;
+static double utc_offset = 0, utc_accuracy = -1, utc_updated = 0;
+
+static double monotonic_time(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void indigo_set_utc_offset(double offset, double accuracy) {
+	pthread_mutex_lock(&utc_mutex);
+	utc_offset = offset;
+	utc_accuracy = accuracy;
+	utc_updated = monotonic_time();
+	pthread_mutex_unlock(&utc_mutex);
+}
+
+double indigo_get_utc(struct timespec *utc) {
+	double now = monotonic_time();
+	pthread_mutex_lock(&utc_mutex);
+	// monotonic clock drifts against UTC, so stale offset is not used
+	double accuracy = utc_accuracy >= 0 && now - utc_updated < UTC_OFFSET_VALIDITY ? utc_accuracy : -1;
+	double offset = utc_offset;
+	pthread_mutex_unlock(&utc_mutex);
+	if (accuracy < 0) {
+		clock_gettime(CLOCK_REALTIME, utc);
+	} else {
+		double time = now + offset;
+		utc->tv_sec = (time_t)time;
+		utc->tv_nsec = (long)((time - utc->tv_sec) * 1e9);
+	}
+	return accuracy;
+}
+
 bool indigo_ignore_connection_change(indigo_device *device, indigo_property *request) {
 	indigo_item *connected_item = NULL;
 	indigo_item *disconnected_item = NULL;
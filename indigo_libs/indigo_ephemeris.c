@@ -0,0 +1,480 @@
+// Copyright (c) 2020 CloudMakers, s. r. o.
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// version history
+// 2.0 by Peter Polakovic <peter.polakovic@cloudmakers.eu>
+
+/** INDIGO solar system ephemeris
+ \file indigo_ephemeris.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <novas.h>
+
+#include <indigo/indigo_bus.h>
+#include <indigo/indigo_novas.h>
+#include <indigo/indigo_ephemeris.h>
+
+#if defined(INDIGO_LINUX) || defined(INDIGO_MACOS)
+// JPLEPH.421 embedded into libnovas by eph_manager.c
+extern char binary_jpleph_start[];
+extern char binary_jpleph_end[];
+#define EMBEDDED_EPHEMERIS
+#endif
+
+// offsets of constants in the first record of JPL binary file (see ephem_open() in eph_manager.c)
+
+#define HEADER_SS						2652
+#define HEADER_AU						2680
+#define HEADER_EMRAT				2688
+#define HEADER_IPT					2696
+#define HEADER_DENUM				2840
+#define HEADER_LPT					2844
+#define HEADER_SIZE					2856
+
+#define BODY_COUNT					11
+#define JPL_EMB							2
+#define JPL_MOON						9
+#define JPL_SUN							10
+#define MAX_COEFFICIENTS		20
+
+#define GAUSS_K							0.01720209895
+#define J2000_OBLIQUITY			(23.4392911 * DEG2RAD)
+
+#define EVENT_STEP					600
+#define EVENT_WINDOW				86400
+
+static struct {
+	const char *data;										///< mapped file or embedded data
+	size_t size;												///< data size
+	bool mapped;												///< data is mapped file
+	int generation;											///< incremented when file is changed to invalidate cached blocks
+	double start, end, span;						///< ephemeris range and record span (julian date)
+	double au;													///< AU in km
+	double emrat;												///< Earth/Moon mass ratio
+	int ipt[12][3];											///< coefficient offset, count and number of subintervals per body
+	long record_length;									///< record length in bytes
+	long record_count;									///< number of data records
+} jpl = { 0 };
+
+static pthread_rwlock_t ephemeris_lock = PTHREAD_RWLOCK_INITIALIZER;
+static pthread_once_t ephemeris_once = PTHREAD_ONCE_INIT;
+
+typedef struct {
+	double start, end;									///< subinterval (julian date)
+	int count;													///< coefficients per component
+	double coefficients[3 * MAX_COEFFICIENTS];
+} chebyshev_block;
+
+static __thread struct {
+	int generation;
+	double au, emrat;
+	chebyshev_block blocks[BODY_COUNT];
+} cache = { 0 };
+
+static bool parse_header(const char *data, size_t size) {
+	if (data == NULL || size < HEADER_SIZE)
+		return false;
+	double ss[3], au, emrat;
+	int ipt[12][3], denum, lpt[3];
+	memcpy(ss, data + HEADER_SS, sizeof(ss));
+	memcpy(&au, data + HEADER_AU, sizeof(au));
+	memcpy(&emrat, data + HEADER_EMRAT, sizeof(emrat));
+	memcpy(ipt, data + HEADER_IPT, sizeof(ipt));
+	memcpy(&denum, data + HEADER_DENUM, sizeof(denum));
+	memcpy(lpt, data + HEADER_LPT, sizeof(lpt));
+	if (denum <= 0 || ss[2] <= 0 || ss[1] <= ss[0] || au <= 0 || emrat <= 0)
+		return false;
+	// record length is given by the last coefficient of any body, nutations have 2 and librations 3 components
+	long length = lpt[0] - 1 + 3 * lpt[1] * lpt[2];
+	for (int i = 0; i < 12; i++) {
+		if (i < BODY_COUNT && (ipt[i][0] < 3 || ipt[i][1] < 2 || ipt[i][1] > MAX_COEFFICIENTS || ipt[i][2] < 1))
+			return false;
+		long last = ipt[i][0] - 1 + (i == 11 ? 2 : 3) * ipt[i][1] * ipt[i][2];
+		if (last > length)
+			length = last;
+	}
+	length *= sizeof(double);
+	long count = (long)((ss[1] - ss[0]) / ss[2] + 0.5);
+	if (length < HEADER_SIZE || count < 1 || (size_t)(count + 2) * length > size)
+		return false;
+	jpl.start = ss[0];
+	jpl.end = ss[1];
+	jpl.span = ss[2];
+	jpl.au = au;
+	jpl.emrat = emrat;
+	memcpy(jpl.ipt, ipt, sizeof(ipt));
+	jpl.record_length = length;
+	jpl.record_count = count;
+	INDIGO_DEBUG(indigo_debug("Ephemeris DE%d %.1f - %.1f, %ld records", denum, ss[0], ss[1], count));
+	return true;
+}
+
+static void release_data() {
+	if (jpl.mapped)
+		munmap((void *)jpl.data, jpl.size);
+	jpl.data = NULL;
+	jpl.size = 0;
+	jpl.mapped = false;
+}
+
+bool indigo_ephemeris_open(const char *path) {
+	const char *data = NULL;
+	size_t size = 0;
+	bool mapped = false;
+	if (path) {
+		int handle = open(path, O_RDONLY);
+		if (handle < 0) {
+			INDIGO_ERROR(indigo_error("Failed to open %s (%s)", path, strerror(errno)));
+			return false;
+		}
+		struct stat file_stat;
+		if (fstat(handle, &file_stat) == 0 && file_stat.st_size > 0) {
+			size = file_stat.st_size;
+			data = mmap(NULL, size, PROT_READ, MAP_SHARED, handle, 0);
+			if (data == MAP_FAILED)
+				data = NULL;
+			mapped = data != NULL;
+		}
+		close(handle);
+	} else {
+#ifdef EMBEDDED_EPHEMERIS
+		data = binary_jpleph_start;
+		size = binary_jpleph_end - binary_jpleph_start;
+#endif
+	}
+	pthread_rwlock_wrlock(&ephemeris_lock);
+	release_data();
+	bool result = parse_header(data, size);
+	if (result) {
+		jpl.data = data;
+		jpl.size = size;
+		jpl.mapped = mapped;
+	} else {
+		if (mapped)
+			munmap((void *)data, size);
+		if (path)
+			INDIGO_ERROR(indigo_error("%s is not valid JPL ephemeris file", path));
+		else
+			INDIGO_ERROR(indigo_error("Embedded JPL ephemeris is not available, low precision Sun and Moon positions are used"));
+	}
+	jpl.generation++;
+	pthread_rwlock_unlock(&ephemeris_lock);
+	return result;
+}
+
+static void open_embedded() {
+	indigo_ephemeris_open(NULL);
+}
+
+static bool load_block(int index, double jd, chebyshev_block *block) {
+	bool result = false;
+	pthread_rwlock_rdlock(&ephemeris_lock);
+	if (cache.generation != jpl.generation) {
+		memset(cache.blocks, 0, sizeof(cache.blocks));
+		cache.generation = jpl.generation;
+		cache.au = jpl.au;
+		cache.emrat = jpl.emrat;
+	}
+	if (jpl.data && jd >= jpl.start && jd <= jpl.end) {
+		long record = (long)((jd - jpl.start) / jpl.span);
+		if (record >= jpl.record_count)
+			record = jpl.record_count - 1;
+		int count = jpl.ipt[index][1], intervals = jpl.ipt[index][2];
+		double record_start = jpl.start + record * jpl.span, length = jpl.span / intervals;
+		int interval = (int)((jd - record_start) / length);
+		if (interval >= intervals)
+			interval = intervals - 1;
+		const char *coefficients = jpl.data + (record + 2) * jpl.record_length + (jpl.ipt[index][0] - 1 + 3 * count * interval) * sizeof(double);
+		// copy, embedded data is not guaranteed to be aligned
+		memcpy(block->coefficients, coefficients, 3 * count * sizeof(double));
+		block->start = record_start + interval * length;
+		block->end = block->start + length;
+		block->count = count;
+		result = true;
+	}
+	pthread_rwlock_unlock(&ephemeris_lock);
+	return result;
+}
+
+static bool chebyshev(int index, double jd, double *pos, double *vel) {
+	chebyshev_block *block = cache.blocks + index;
+	if (cache.generation != jpl.generation || jd < block->start || jd >= block->end) {
+		if (!load_block(index, jd, block))
+			return false;
+	}
+	double length = block->end - block->start;
+	double tc = 2.0 * (jd - block->start) / length - 1.0;
+	double t[MAX_COEFFICIENTS], dt[MAX_COEFFICIENTS];
+	int count = block->count;
+	t[0] = 1.0;
+	t[1] = tc;
+	dt[0] = 0.0;
+	dt[1] = 1.0;
+	for (int i = 2; i < count; i++) {
+		t[i] = 2.0 * tc * t[i - 1] - t[i - 2];
+		dt[i] = 2.0 * t[i - 1] + 2.0 * tc * dt[i - 1] - dt[i - 2];
+	}
+	const double *c = block->coefficients;
+	for (int j = 0; j < 3; j++, c += count) {
+		double p = 0, v = 0;
+		for (int i = count - 1; i >= 0; i--) {
+			p += c[i] * t[i];
+			v += c[i] * dt[i];
+		}
+		pos[j] = p / cache.au;
+		vel[j] = v * 2.0 / length / cache.au;
+	}
+	return true;
+}
+
+static void ecliptic_sun(double jd, double *pos) {
+	// low precision geocentric Sun position (Astronomical Almanac)
+	double n = jd - T0;
+	double g = (357.528 + 0.9856003 * n) * DEG2RAD;
+	double l = (280.460 + 0.9856474 * n) * DEG2RAD + (1.915 * sin(g) + 0.020 * sin(2 * g)) * DEG2RAD;
+	double r = 1.00014 - 0.01671 * cos(g) - 0.00014 * cos(2 * g);
+	double e = (23.439 - 0.0000004 * n) * DEG2RAD;
+	pos[0] = r * cos(l);
+	pos[1] = r * cos(e) * sin(l);
+	pos[2] = r * sin(e) * sin(l);
+}
+
+static void ecliptic_moon(double jd, double *pos) {
+	// low precision geocentric Moon position (Astronomical Almanac)
+	double t = (jd - T0) / 36525.0;
+	double l = 218.32 + 481267.881 * t + 6.29 * sin((135.0 + 477198.87 * t) * DEG2RAD) - 1.27 * sin((259.3 - 413335.36 * t) * DEG2RAD) + 0.66 * sin((235.7 + 890534.22 * t) * DEG2RAD) + 0.21 * sin((269.9 + 954397.74 * t) * DEG2RAD) - 0.19 * sin((357.5 + 35999.05 * t) * DEG2RAD) - 0.11 * sin((186.5 + 966404.03 * t) * DEG2RAD);
+	double b = 5.13 * sin((93.3 + 483202.02 * t) * DEG2RAD) + 0.28 * sin((228.2 + 960400.89 * t) * DEG2RAD) - 0.28 * sin((318.3 + 6003.15 * t) * DEG2RAD) - 0.17 * sin((217.6 - 407332.21 * t) * DEG2RAD);
+	double p = 0.9508 + 0.0518 * cos((135.0 + 477198.87 * t) * DEG2RAD) + 0.0095 * cos((259.3 - 413335.36 * t) * DEG2RAD) + 0.0078 * cos((235.7 + 890534.22 * t) * DEG2RAD) + 0.0028 * cos((269.9 + 954397.74 * t) * DEG2RAD);
+	double r = ERAD / 1000.0 / AU_KM / sin(p * DEG2RAD);
+	double e = (23.439 - 0.0000004 * (jd - T0)) * DEG2RAD;
+	l *= DEG2RAD;
+	b *= DEG2RAD;
+	double x = r * cos(b) * cos(l), y = r * cos(b) * sin(l), z = r * sin(b);
+	pos[0] = x;
+	pos[1] = y * cos(e) - z * sin(e);
+	pos[2] = y * sin(e) + z * cos(e);
+}
+
+static bool low_precision_state(int body, double jd, double *pos) {
+	// Sun is placed to barycentre
+	double moon[3];
+	switch (body) {
+		case INDIGO_EPHEMERIS_SUN:
+			pos[0] = pos[1] = pos[2] = 0;
+			return true;
+		case INDIGO_EPHEMERIS_EARTH:
+			ecliptic_sun(jd, pos);
+			for (int i = 0; i < 3; i++)
+				pos[i] = -pos[i];
+			return true;
+		case INDIGO_EPHEMERIS_MOON:
+			ecliptic_sun(jd, pos);
+			ecliptic_moon(jd, moon);
+			for (int i = 0; i < 3; i++)
+				pos[i] = moon[i] - pos[i];
+			return true;
+	}
+	return false;
+}
+
+bool indigo_ephemeris_state(int body, double jd_tt, double *pos, double *vel) {
+	pthread_once(&ephemeris_once, open_embedded);
+	double emb_pos[3], emb_vel[3], moon_pos[3], moon_vel[3], velocity[3];
+	if (vel == NULL)
+		vel = velocity;
+	bool result = false;
+	switch (body) {
+		case INDIGO_EPHEMERIS_EARTH:
+		case INDIGO_EPHEMERIS_MOON:
+			if (chebyshev(JPL_EMB, jd_tt, emb_pos, emb_vel) && chebyshev(JPL_MOON, jd_tt, moon_pos, moon_vel)) {
+				double k = body == INDIGO_EPHEMERIS_EARTH ? -1.0 / (1.0 + cache.emrat) : cache.emrat / (1.0 + cache.emrat);
+				for (int i = 0; i < 3; i++) {
+					pos[i] = emb_pos[i] + k * moon_pos[i];
+					vel[i] = emb_vel[i] + k * moon_vel[i];
+				}
+				result = true;
+			}
+			break;
+		case INDIGO_EPHEMERIS_SUN:
+			result = chebyshev(JPL_SUN, jd_tt, pos, vel);
+			break;
+		default:
+			if (body >= INDIGO_EPHEMERIS_MERCURY && body <= INDIGO_EPHEMERIS_PLUTO)
+				result = chebyshev(body - 1, jd_tt, pos, vel);
+			break;
+	}
+	if (!result) {
+		double before[3], after[3];
+		if (!low_precision_state(body, jd_tt, pos))
+			return false;
+		low_precision_state(body, jd_tt - 0.5, before);
+		low_precision_state(body, jd_tt + 0.5, after);
+		for (int i = 0; i < 3; i++)
+			vel[i] = after[i] - before[i];
+	}
+	return true;
+}
+
+void indigo_ephemeris_init_orbit(indigo_ephemeris_orbit *orbit) {
+	double w = orbit->peri * DEG2RAD, o = orbit->node * DEG2RAD, i = orbit->i * DEG2RAD;
+	double ecliptic_p[3] = { cos(w) * cos(o) - sin(w) * sin(o) * cos(i), cos(w) * sin(o) + sin(w) * cos(o) * cos(i), sin(w) * sin(i) };
+	double ecliptic_r[3] = { -sin(w) * cos(o) - cos(w) * sin(o) * cos(i), -sin(w) * sin(o) + cos(w) * cos(o) * cos(i), cos(w) * sin(i) };
+	double c = cos(J2000_OBLIQUITY), s = sin(J2000_OBLIQUITY);
+	orbit->p[0] = ecliptic_p[0];
+	orbit->p[1] = ecliptic_p[1] * c - ecliptic_p[2] * s;
+	orbit->p[2] = ecliptic_p[1] * s + ecliptic_p[2] * c;
+	orbit->r[0] = ecliptic_r[0];
+	orbit->r[1] = ecliptic_r[1] * c - ecliptic_r[2] * s;
+	orbit->r[2] = ecliptic_r[1] * s + ecliptic_r[2] * c;
+}
+
+bool indigo_ephemeris_parse_orbit(const char *text, indigo_ephemeris_orbit *orbit) {
+	double v[7];
+	int count = sscanf(text, "%lf %lf %lf %lf %lf %lf %lf", v, v + 1, v + 2, v + 3, v + 4, v + 5, v + 6);
+	memset(orbit, 0, sizeof(indigo_ephemeris_orbit));
+	if (count == 6) {
+		orbit->q = v[0];
+		orbit->tp = v[5];
+	} else if (count == 7 && v[1] < 1) {
+		double n = GAUSS_K / (v[0] * sqrt(v[0]));
+		orbit->q = v[0] * (1 - v[1]);
+		orbit->tp = v[6] - v[5] * DEG2RAD / n;
+	} else {
+		return false;
+	}
+	orbit->e = v[1];
+	orbit->i = v[2];
+	orbit->node = v[3];
+	orbit->peri = v[4];
+	if (orbit->q <= 0 || orbit->e < 0)
+		return false;
+	indigo_ephemeris_init_orbit(orbit);
+	return true;
+}
+
+bool indigo_ephemeris_orbit_state(const indigo_ephemeris_orbit *orbit, double jd_tt, double *pos) {
+	// position in orbital plane (x towards perihelion) from Kepler's equation or Barker's equation for parabola
+	double q = orbit->q, e = orbit->e, t = jd_tt - orbit->tp, x, y;
+	if (fabs(e - 1) < 1e-8) {
+		double w = 3 * GAUSS_K / sqrt(2 * q * q * q) * t;
+		double g = cbrt(w / 2 + sqrt(w * w / 4 + 1));
+		double s = g - 1 / g;
+		x = q * (1 - s * s);
+		y = 2 * q * s;
+	} else if (e < 1) {
+		double a = q / (1 - e), m = fmod(GAUSS_K / (a * sqrt(a)) * t, 2 * M_PI);
+		double ea = e < 0.8 ? m : M_PI * (m < 0 ? -1 : 1);
+		for (int i = 0; i < 50; i++) {
+			double d = (ea - e * sin(ea) - m) / (1 - e * cos(ea));
+			ea -= d;
+			if (fabs(d) < 1e-14)
+				break;
+		}
+		x = a * (cos(ea) - e);
+		y = a * sqrt(1 - e * e) * sin(ea);
+	} else {
+		double a = q / (e - 1), m = GAUSS_K / (a * sqrt(a)) * t;
+		double h = asinh(m / e);
+		for (int i = 0; i < 50; i++) {
+			double d = (e * sinh(h) - h - m) / (e * cosh(h) - 1);
+			h -= d;
+			if (fabs(d) < 1e-14)
+				break;
+		}
+		x = a * (e - cosh(h));
+		y = a * sqrt(e * e - 1) * sinh(h);
+	}
+	double sun[3];
+	if (!indigo_ephemeris_state(INDIGO_EPHEMERIS_SUN, jd_tt, sun, NULL))
+		return false;
+	for (int i = 0; i < 3; i++)
+		pos[i] = sun[i] + x * orbit->p[i] + y * orbit->r[i];
+	return true;
+}
+
+static bool event_values(indigo_novas_context *context, time_t utc, double latitude, double longitude, double elevation, int body, double altitude, double *alt, double *ha) {
+	// altitude above given one (degrees) and hour angle in range -12 to 12 (hours)
+	double ra, dec, az;
+	if (!indigo_novas_topo_planet(context, &utc, latitude, longitude, elevation, 1, &body, &ra, &dec, NULL))
+		return false;
+	indigo_novas_eq2hor(context, &utc, latitude, longitude, elevation, 1, &ra, &dec, alt, &az);
+	*alt -= altitude;
+	*ha = indigo_novas_lst(context, &utc, longitude) - ra;
+	*ha = *ha < -12 ? *ha + 24 : *ha >= 12 ? *ha - 24 : *ha;
+	return true;
+}
+
+static time_t refine_event(indigo_novas_context *context, time_t a, time_t b, double fa, double latitude, double longitude, double elevation, int body, double altitude, bool transit) {
+	while (b - a > 1) {
+		time_t m = a + (b - a) / 2;
+		double alt, ha;
+		if (!event_values(context, m, latitude, longitude, elevation, body, altitude, &alt, &ha))
+			break;
+		double fm = transit ? ha : alt;
+		if ((fm < 0) == (fa < 0)) {
+			a = m;
+			fa = fm;
+		} else {
+			b = m;
+		}
+	}
+	return b;
+}
+
+bool indigo_ephemeris_events(time_t utc, double latitude, double longitude, double elevation, int body, double altitude, time_t *rise, time_t *transit, time_t *set) {
+	// positions sampled every EVENT_STEP seconds are good enough with time dependent terms refreshed every hour
+	indigo_novas_context context;
+	indigo_novas_context_init(&context, 3600);
+	double alt0, ha0;
+	if (!event_values(&context, utc, latitude, longitude, elevation, body, altitude, &alt0, &ha0))
+		return false;
+	if (rise)
+		*rise = 0;
+	if (transit)
+		*transit = 0;
+	if (set)
+		*set = 0;
+	for (time_t t0 = utc, t1 = utc + EVENT_STEP; t1 <= utc + EVENT_WINDOW; t0 = t1, t1 += EVENT_STEP) {
+		double alt1, ha1;
+		if (!event_values(&context, t1, latitude, longitude, elevation, body, altitude, &alt1, &ha1))
+			return false;
+		if (rise && *rise == 0 && alt0 < 0 && alt1 >= 0)
+			*rise = refine_event(&context, t0, t1, alt0, latitude, longitude, elevation, body, altitude, false);
+		if (set && *set == 0 && alt0 >= 0 && alt1 < 0)
+			*set = refine_event(&context, t0, t1, alt0, latitude, longitude, elevation, body, altitude, false);
+		// hour angle wraps from +12h to -12h at lower culmination
+		if (transit && *transit == 0 && ha0 < 0 && ha1 >= 0 && ha1 - ha0 < 12)
+			*transit = refine_event(&context, t0, t1, ha0, latitude, longitude, elevation, body, altitude, true);
+		if ((rise == NULL || *rise) && (transit == NULL || *transit) && (set == NULL || *set))
+			break;
+		alt0 = alt1;
+		ha0 = ha1;
+	}
+	return true;
+}
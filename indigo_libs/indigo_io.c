@@ -24,6 +24,10 @@
  \file indigo_io.c
  */
 
+#if defined(INDIGO_LINUX)
+#define _GNU_SOURCE
+#endif
+
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -35,6 +39,8 @@
 #if defined(INDIGO_LINUX) || defined(INDIGO_MACOS)
 #include <unistd.h>
 #include <termios.h>
+#include <poll.h>
+#include <time.h>
 #include <netdb.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
@@ -462,3 +468,500 @@ int indigo_scanf(int handle, const char *format, ...) {
 	va_end(args);
 	return count;
 }
+
+#if defined(INDIGO_LINUX) || defined(INDIGO_MACOS)
+
+// serial transport - descriptor is owned by event thread, commands are queued, written in order and responses are matched in FIFO order
+
+#define SERIAL_BUFFER_SIZE	4096
+#define SERIAL_TERMINATORS	8
+#define SERIAL_RESYNC_QUIET	0.1
+
+typedef struct serial_request {
+	char *command;
+	long command_length;
+	char terminators[SERIAL_TERMINATORS];
+	int length;
+	double timeout;
+	double deadline;
+	indigo_serial_callback callback;
+	void *data;
+	struct serial_request *next;
+} serial_request;
+
+struct indigo_serial_transport {
+	int handle;
+	int wake[2];
+	int pipeline;
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	serial_request *queue, *queue_tail;
+	serial_request *flight, *flight_tail;
+	int in_flight;
+	double resync_until;
+	bool stop, broken;
+	char buffer[SERIAL_BUFFER_SIZE + 1];
+	int length;
+	char listener_terminators[SERIAL_TERMINATORS];
+	indigo_serial_callback listener;
+	void *listener_data;
+};
+
+static double serial_time(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void serial_complete(indigo_serial_transport *transport, serial_request *request, const char *response, int length) {
+	if (response)
+		INDIGO_TRACE_PROTOCOL(indigo_trace("%d → %.*s", transport->handle, length, response));
+	else
+		INDIGO_TRACE_PROTOCOL(indigo_trace("%d → TIMEOUT", transport->handle));
+	if (request->callback)
+		request->callback(transport, request->data, response, length);
+	free(request->command);
+	free(request);
+}
+
+static int serial_frame(indigo_serial_transport *transport, const char *terminators, int length, int *consumed) {
+	if (length > 0) {
+		if (transport->length < length)
+			return -1;
+		*consumed = length;
+		return length;
+	}
+	for (int i = 0; i < transport->length; i++) {
+		if (strchr(terminators, transport->buffer[i]) && transport->buffer[i]) {
+			*consumed = i + 1;
+			return i;
+		}
+	}
+	if (transport->length == SERIAL_BUFFER_SIZE) {
+		*consumed = SERIAL_BUFFER_SIZE;
+		return SERIAL_BUFFER_SIZE;
+	}
+	return -1;
+}
+
+static void serial_consume(indigo_serial_transport *transport, int consumed) {
+	transport->length -= consumed;
+	memmove(transport->buffer, transport->buffer + consumed, transport->length);
+}
+
+static void serial_dispatch(indigo_serial_transport *transport) {
+	while (transport->length > 0) {
+		int consumed = 0, length;
+		pthread_mutex_lock(&transport->mutex);
+		serial_request *request = transport->flight;
+		if (request) {
+			if ((length = serial_frame(transport, request->terminators, request->length, &consumed)) < 0) {
+				pthread_mutex_unlock(&transport->mutex);
+				return;
+			}
+			if ((transport->flight = request->next) == NULL)
+				transport->flight_tail = NULL;
+			else
+				transport->flight->deadline = serial_time() + transport->flight->timeout;
+			transport->in_flight--;
+			pthread_mutex_unlock(&transport->mutex);
+			char saved = transport->buffer[length];
+			transport->buffer[length] = 0;
+			serial_complete(transport, request, transport->buffer, length);
+			transport->buffer[length] = saved;
+		} else {
+			pthread_mutex_unlock(&transport->mutex);
+			if (transport->listener && (length = serial_frame(transport, transport->listener_terminators, 0, &consumed)) >= 0) {
+				if (length > 0) {
+					char saved = transport->buffer[length];
+					transport->buffer[length] = 0;
+					transport->listener(transport, transport->listener_data, transport->buffer, length);
+					transport->buffer[length] = saved;
+				}
+			} else if (transport->listener) {
+				return;
+			} else {
+				INDIGO_TRACE_PROTOCOL(indigo_trace("%d → %d unexpected bytes dropped", transport->handle, transport->length));
+				consumed = transport->length;
+			}
+		}
+		serial_consume(transport, consumed);
+	}
+}
+
+static void serial_fail(indigo_serial_transport *transport, serial_request **list) {
+	pthread_mutex_lock(&transport->mutex);
+	serial_request *request = *list;
+	*list = NULL;
+	if (list == &transport->flight) {
+		transport->flight_tail = NULL;
+		transport->in_flight = 0;
+	} else {
+		transport->queue_tail = NULL;
+	}
+	pthread_mutex_unlock(&transport->mutex);
+	while (request) {
+		serial_request *next = request->next;
+		serial_complete(transport, request, NULL, 0);
+		request = next;
+	}
+}
+
+static void *serial_event_thread(indigo_serial_transport *transport) {
+	bool is_tty = isatty(transport->handle);
+	while (!transport->stop) {
+		// write queued commands up to pipeline depth
+		while (true) {
+			pthread_mutex_lock(&transport->mutex);
+			serial_request *request = transport->queue;
+			if (request == NULL || transport->in_flight >= transport->pipeline || transport->broken || transport->resync_until > 0) {
+				pthread_mutex_unlock(&transport->mutex);
+				break;
+			}
+			if ((transport->queue = request->next) == NULL)
+				transport->queue_tail = NULL;
+			request->next = NULL;
+			bool expects_response = request->length > 0 || *request->terminators;
+			if (expects_response) {
+				if (transport->flight_tail)
+					transport->flight_tail->next = request;
+				else
+					transport->flight = request;
+				transport->flight_tail = request;
+				transport->in_flight++;
+			}
+			pthread_mutex_unlock(&transport->mutex);
+			INDIGO_TRACE_PROTOCOL(indigo_trace("%d ← %.*s", transport->handle, (int)request->command_length, request->command));
+			if (!indigo_write(transport->handle, request->command, request->command_length)) {
+				transport->broken = true;
+				if (!expects_response)
+					serial_complete(transport, request, NULL, 0);
+				break;
+			}
+			if (expects_response) {
+				pthread_mutex_lock(&transport->mutex);
+				if (transport->flight == request)
+					request->deadline = serial_time() + request->timeout;
+				pthread_mutex_unlock(&transport->mutex);
+			} else {
+				serial_complete(transport, request, "", 0);
+			}
+		}
+		if (transport->broken) {
+			serial_fail(transport, &transport->flight);
+			serial_fail(transport, &transport->queue);
+		}
+		// wait for data, new command or head deadline
+		int timeout = -1;
+		pthread_mutex_lock(&transport->mutex);
+		if (transport->resync_until > 0) {
+			double remains = transport->resync_until - serial_time();
+			timeout = remains > 0 ? (int)(remains * 1000) + 1 : 0;
+		} else if (transport->flight) {
+			double remains = transport->flight->deadline - serial_time();
+			timeout = remains > 0 ? (int)(remains * 1000) + 1 : 0;
+		}
+		pthread_mutex_unlock(&transport->mutex);
+		struct pollfd fds[2] = { { transport->wake[0], POLLIN, 0 }, { transport->handle, POLLIN, 0 } };
+		int result = poll(fds, transport->broken ? 1 : 2, timeout);
+		if (result < 0 && errno != EINTR) {
+			INDIGO_ERROR(indigo_error("%s(): %s", __FUNCTION__, strerror(errno)));
+			transport->broken = true;
+			continue;
+		}
+		if (result > 0 && (fds[0].revents & POLLIN)) {
+			char c[16];
+			while (read(transport->wake[0], c, sizeof(c)) == sizeof(c))
+				;
+		}
+		if (result > 0 && !transport->broken && (fds[1].revents & (POLLIN | POLLHUP | POLLERR))) {
+			long count = read(transport->handle, transport->buffer + transport->length, SERIAL_BUFFER_SIZE - transport->length);
+			if (count > 0 && transport->resync_until > 0) {
+				// late responses to expired requests are dropped until the line is quiet
+				INDIGO_TRACE_PROTOCOL(indigo_trace("%d → %ld bytes dropped while resynchronising", transport->handle, count));
+				transport->length = 0;
+				transport->resync_until = serial_time() + SERIAL_RESYNC_QUIET;
+			} else if (count > 0) {
+				transport->length += count;
+				serial_dispatch(transport);
+			} else if (count < 0 ? errno != EINTR && errno != EAGAIN : !is_tty) {
+				INDIGO_ERROR(indigo_error("%s(): %s", __FUNCTION__, count < 0 ? strerror(errno) : "connection closed"));
+				transport->broken = true;
+			}
+		}
+		if (transport->resync_until > 0 && transport->resync_until <= serial_time())
+			transport->resync_until = 0;
+		// expire head request; late response may still arrive and responses to pipelined requests can't be matched reliably,
+		// so all requests in flight are failed and nothing is written until the line is quiet
+		pthread_mutex_lock(&transport->mutex);
+		serial_request *request = transport->flight;
+		bool expired = request && request->deadline > 0 && request->deadline <= serial_time();
+		if (expired) {
+			transport->length = 0;
+			transport->resync_until = serial_time() + SERIAL_RESYNC_QUIET;
+			if (is_tty)
+				tcflush(transport->handle, TCIFLUSH);
+		}
+		pthread_mutex_unlock(&transport->mutex);
+		if (expired)
+			serial_fail(transport, &transport->flight);
+	}
+	serial_fail(transport, &transport->flight);
+	serial_fail(transport, &transport->queue);
+	return NULL;
+}
+
+static void serial_wake(indigo_serial_transport *transport) {
+	char c = 0;
+	if (write(transport->wake[1], &c, 1) < 0)
+		INDIGO_ERROR(indigo_error("%s(): %s", __FUNCTION__, strerror(errno)));
+}
+
+indigo_serial_transport *indigo_serial_open(int handle, int pipeline) {
+	indigo_serial_transport *transport = malloc(sizeof(indigo_serial_transport));
+	if (transport == NULL)
+		return NULL;
+	memset(transport, 0, sizeof(indigo_serial_transport));
+	transport->handle = handle;
+	transport->pipeline = pipeline < 1 ? 1 : pipeline;
+	pthread_mutex_init(&transport->mutex, NULL);
+	if (pipe(transport->wake) < 0) {
+		INDIGO_ERROR(indigo_error("%s(): %s", __FUNCTION__, strerror(errno)));
+		free(transport);
+		return NULL;
+	}
+	fcntl(transport->wake[0], F_SETFL, O_NONBLOCK);
+	if (pthread_create(&transport->thread, NULL, (void * (*)(void*))serial_event_thread, transport) != 0) {
+		close(transport->wake[0]);
+		close(transport->wake[1]);
+		free(transport);
+		return NULL;
+	}
+	return transport;
+}
+
+void indigo_serial_close(indigo_serial_transport *transport) {
+	if (transport == NULL)
+		return;
+	transport->stop = true;
+	serial_wake(transport);
+	pthread_join(transport->thread, NULL);
+	close(transport->wake[0]);
+	close(transport->wake[1]);
+	close(transport->handle);
+	pthread_mutex_destroy(&transport->mutex);
+	free(transport);
+}
+
+void indigo_serial_set_listener(indigo_serial_transport *transport, const char *terminators, indigo_serial_callback callback, void *data) {
+	pthread_mutex_lock(&transport->mutex);
+	strncpy(transport->listener_terminators, terminators ? terminators : "\n", SERIAL_TERMINATORS - 1);
+	transport->listener_data = data;
+	transport->listener = callback;
+	pthread_mutex_unlock(&transport->mutex);
+	serial_wake(transport);
+}
+
+bool indigo_serial_submit(indigo_serial_transport *transport, const char *command, long command_length, const char *terminators, int length, double timeout, indigo_serial_callback callback, void *data) {
+	if (transport == NULL || transport->broken || transport->stop)
+		return false;
+	serial_request *request = malloc(sizeof(serial_request));
+	if (request == NULL)
+		return false;
+	memset(request, 0, sizeof(serial_request));
+	if (command_length < 0)
+		command_length = strlen(command);
+	request->command = malloc(command_length);
+	if (request->command == NULL) {
+		free(request);
+		return false;
+	}
+	memcpy(request->command, command, command_length);
+	request->command_length = command_length;
+	if (terminators)
+		strncpy(request->terminators, terminators, SERIAL_TERMINATORS - 1);
+	request->length = length;
+	request->timeout = timeout;
+	request->callback = callback;
+	request->data = data;
+	pthread_mutex_lock(&transport->mutex);
+	if (transport->queue_tail)
+		transport->queue_tail->next = request;
+	else
+		transport->queue = request;
+	transport->queue_tail = request;
+	pthread_mutex_unlock(&transport->mutex);
+	serial_wake(transport);
+	return true;
+}
+
+typedef struct {
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	bool done;
+	char *response;
+	int max;
+	int length;
+} serial_waiter;
+
+static void serial_wait_callback(indigo_serial_transport *transport, void *data, const char *response, int length) {
+	serial_waiter *waiter = data;
+	pthread_mutex_lock(&waiter->mutex);
+	if (response == NULL) {
+		waiter->length = -1;
+	} else {
+		if (waiter->response) {
+			if (length >= waiter->max)
+				length = waiter->max - 1;
+			memcpy(waiter->response, response, length);
+			waiter->response[length] = 0;
+		}
+		waiter->length = length;
+	}
+	waiter->done = true;
+	pthread_cond_signal(&waiter->cond);
+	pthread_mutex_unlock(&waiter->mutex);
+}
+
+int indigo_serial_command(indigo_serial_transport *transport, const char *command, const char *terminators, int length, double timeout, char *response, int max) {
+	serial_waiter waiter = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, false, response, max, -1 };
+	if (response && max > 0)
+		*response = 0;
+	if (transport != NULL && pthread_equal(pthread_self(), transport->thread)) {
+		// waiting on the event thread would never return
+		INDIGO_ERROR(indigo_error("%s(): called from transport callback", __FUNCTION__));
+		return -1;
+	}
+	if (!indigo_serial_submit(transport, command, -1, terminators, length, timeout, serial_wait_callback, &waiter))
+		return -1;
+	pthread_mutex_lock(&waiter.mutex);
+	while (!waiter.done)
+		pthread_cond_wait(&waiter.cond, &waiter.mutex);
+	pthread_mutex_unlock(&waiter.mutex);
+	pthread_cond_destroy(&waiter.cond);
+	pthread_mutex_destroy(&waiter.mutex);
+	return waiter.length;
+}
+
+// scripted loopback device
+
+struct indigo_serial_loopback {
+	int master, slave;
+	int wake[2];
+	pthread_t thread;
+	const indigo_serial_script *script;
+};
+
+static void *serial_loopback_thread(indigo_serial_loopback *loopback) {
+	char buffer[SERIAL_BUFFER_SIZE];
+	int length = 0;
+	while (true) {
+		struct pollfd fds[2] = { { loopback->wake[0], POLLIN, 0 }, { loopback->master, POLLIN, 0 } };
+		if (poll(fds, 2, -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+		if (fds[0].revents)
+			break;
+		if (fds[1].revents & POLLIN) {
+			long count = read(loopback->master, buffer + length, sizeof(buffer) - length);
+			if (count < 0 && errno != EINTR && errno != EAGAIN)
+				break;
+			if (count <= 0)
+				continue;
+			length += count;
+		} else if (fds[1].revents) {
+			break;
+		}
+		while (length > 0) {
+			const indigo_serial_script *entry = loopback->script;
+			bool partial = false;
+			for (; entry->command; entry++) {
+				int command_length = (int)strlen(entry->command);
+				if (command_length <= length && !strncmp(buffer, entry->command, command_length))
+					break;
+				if (command_length > length && !strncmp(buffer, entry->command, length))
+					partial = true;
+			}
+			if (entry->command) {
+				int command_length = (int)strlen(entry->command);
+				if (entry->response)
+					indigo_write(loopback->master, entry->response, strlen(entry->response));
+				length -= command_length;
+				memmove(buffer, buffer + command_length, length);
+			} else if (partial && length < (int)sizeof(buffer)) {
+				break;
+			} else {
+				// unknown byte or buffer full with partial command which can't be completed
+				length--;
+				memmove(buffer, buffer + 1, length);
+			}
+		}
+	}
+	return NULL;
+}
+
+indigo_serial_loopback *indigo_serial_loopback_open(const indigo_serial_script *script, char *device_name, int size) {
+	indigo_serial_loopback *loopback = malloc(sizeof(indigo_serial_loopback));
+	if (loopback == NULL)
+		return NULL;
+	loopback->script = script;
+	loopback->master = posix_openpt(O_RDWR | O_NOCTTY);
+	if (loopback->master < 0 || grantpt(loopback->master) < 0 || unlockpt(loopback->master) < 0 || ptsname(loopback->master) == NULL) {
+		INDIGO_ERROR(indigo_error("%s(): %s", __FUNCTION__, strerror(errno)));
+		if (loopback->master >= 0)
+			close(loopback->master);
+		free(loopback);
+		return NULL;
+	}
+	strncpy(device_name, ptsname(loopback->master), size - 1);
+	device_name[size - 1] = 0;
+	// slave is kept open so the master doesn't report hangup before (and between) clients open it
+	loopback->slave = open(device_name, O_RDWR | O_NOCTTY);
+	if (loopback->slave < 0) {
+		INDIGO_ERROR(indigo_error("%s(): %s", __FUNCTION__, strerror(errno)));
+		close(loopback->master);
+		free(loopback);
+		return NULL;
+	}
+	struct termios options;
+	if (tcgetattr(loopback->master, &options) == 0) {
+		cfmakeraw(&options);
+		tcsetattr(loopback->master, TCSANOW, &options);
+	}
+	if (tcgetattr(loopback->slave, &options) == 0) {
+		cfmakeraw(&options);
+		tcsetattr(loopback->slave, TCSANOW, &options);
+	}
+	if (pipe(loopback->wake) < 0) {
+		close(loopback->slave);
+		close(loopback->master);
+		free(loopback);
+		return NULL;
+	}
+	if (pthread_create(&loopback->thread, NULL, (void * (*)(void*))serial_loopback_thread, loopback) != 0) {
+		close(loopback->wake[0]);
+		close(loopback->wake[1]);
+		close(loopback->slave);
+		close(loopback->master);
+		free(loopback);
+		return NULL;
+	}
+	return loopback;
+}
+
+void indigo_serial_loopback_close(indigo_serial_loopback *loopback) {
+	if (loopback == NULL)
+		return;
+	char c = 0;
+	if (write(loopback->wake[1], &c, 1) == 1)
+		pthread_join(loopback->thread, NULL);
+	close(loopback->wake[0]);
+	close(loopback->wake[1]);
+	close(loopback->slave);
+	close(loopback->master);
+	free(loopback);
+}
+
+#endif /* Linux and Mac */
@@ -0,0 +1,307 @@
+// Copyright (c) 2020 CloudMakers, s. r. o.
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// version history
+// 2.0 by Peter Polakovic <peter.polakovic@cloudmakers.eu>
+
+/** INDIGO runtime metrics
+ \file indigo_metrics.c
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+#if defined(INDIGO_LINUX)
+#include <sys/ioctl.h>
+#include <linux/sockios.h>
+#elif defined(INDIGO_MACOS)
+#include <sys/socket.h>
+#endif
+
+#include <indigo/indigo_metrics.h>
+
+#define BUCKET_COUNT	8
+#define MAX_SOCKETS		256
+
+// every thread updates its own block with plain relaxed stores, blocks of finished threads are folded into retired block
+
+typedef struct metric_block {
+	int64_t counters[INDIGO_METRIC_COUNTER_COUNT];
+	uint64_t buckets[INDIGO_METRIC_HISTOGRAM_COUNT][BUCKET_COUNT + 1];
+	double sums[INDIGO_METRIC_HISTOGRAM_COUNT];
+	struct metric_block *next;
+} metric_block;
+
+static struct {
+	const char *name;
+	const char *labels;
+	const char *type;
+	const char *help;
+} counter_info[INDIGO_METRIC_COUNTER_COUNT] = {
+	{ "indigo_bus_events_total", "event=\"define\"", "counter", "Property events routed through the bus" },
+	{ "indigo_bus_events_total", "event=\"update\"", "counter", NULL },
+	{ "indigo_bus_events_total", "event=\"delete\"", "counter", NULL },
+	{ "indigo_bus_events_total", "event=\"change\"", "counter", NULL },
+	{ "indigo_bus_events_total", "event=\"enumerate\"", "counter", NULL },
+	{ "indigo_bus_events_total", "event=\"message\"", "counter", NULL },
+	{ "indigo_blob_bytes_total", "path=\"bus\"", "counter", "BLOB payload bytes" },
+	{ "indigo_blob_bytes_total", "path=\"http\"", "counter", NULL },
+	{ "indigo_ccd_frames_total", NULL, "counter", "Frames processed by CCD drivers" },
+	{ "indigo_server_connections_total", NULL, "counter", "Accepted server connections" },
+	{ "indigo_server_clients", NULL, "gauge", "Connected clients" },
+	{ "indigo_timer_callbacks_total", NULL, "counter", "Executed timer callbacks" },
+	{ "indigo_timer_threads", NULL, "gauge", "Timer threads" },
+	{ "indigo_timer_callbacks_running", NULL, "gauge", "Timer callbacks in progress" }
+};
+
+static struct {
+	const char *name;
+	const char *labels;
+	const char *help;
+} histogram_info[INDIGO_METRIC_HISTOGRAM_COUNT] = {
+	{ "indigo_bus_lock_wait_seconds", "lock=\"client\"", "Time spent waiting for bus lock" },
+	{ "indigo_bus_lock_hold_seconds", "lock=\"client\"", "Time bus lock was held" },
+	{ "indigo_bus_lock_wait_seconds", "lock=\"device\"", NULL },
+	{ "indigo_bus_lock_hold_seconds", "lock=\"device\"", NULL },
+	{ "indigo_timer_lateness_seconds", NULL, "Delay of timer callback start behind schedule" },
+	{ "indigo_timer_callback_seconds", NULL, "Timer callback duration" },
+	{ "indigo_ccd_capture_to_upload_seconds", NULL, "Time from frame capture to upload to clients" }
+};
+
+static const double bucket_bounds[BUCKET_COUNT] = { 0.000001, 0.00001, 0.0001, 0.001, 0.01, 0.1, 1, 10 };
+
+static pthread_mutex_t metrics_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t metrics_once = PTHREAD_ONCE_INIT;
+static pthread_key_t metrics_key;
+static metric_block *blocks = NULL;
+static metric_block retired;
+static __thread metric_block *thread_block = NULL;
+
+static struct {
+	int socket;
+	const char *protocol;
+} sockets[MAX_SOCKETS];
+
+bool indigo_use_metrics = true;
+
+static void retire_block(void *data) {
+	metric_block *block = data;
+	pthread_mutex_lock(&metrics_mutex);
+	for (int i = 0; i < INDIGO_METRIC_COUNTER_COUNT; i++)
+		retired.counters[i] += block->counters[i];
+	for (int i = 0; i < INDIGO_METRIC_HISTOGRAM_COUNT; i++) {
+		for (int j = 0; j <= BUCKET_COUNT; j++)
+			retired.buckets[i][j] += block->buckets[i][j];
+		retired.sums[i] += block->sums[i];
+	}
+	metric_block **previous = &blocks;
+	while (*previous && *previous != block)
+		previous = &(*previous)->next;
+	if (*previous)
+		*previous = block->next;
+	pthread_mutex_unlock(&metrics_mutex);
+	free(block);
+}
+
+static void create_key(void) {
+	pthread_key_create(&metrics_key, retire_block);
+}
+
+static metric_block *get_block(void) {
+	metric_block *block = thread_block;
+	if (block == NULL) {
+		pthread_once(&metrics_once, create_key);
+		block = calloc(1, sizeof(metric_block));
+		if (block == NULL)
+			return NULL;
+		pthread_mutex_lock(&metrics_mutex);
+		block->next = blocks;
+		blocks = block;
+		pthread_mutex_unlock(&metrics_mutex);
+		pthread_setspecific(metrics_key, block);
+		thread_block = block;
+	}
+	return block;
+}
+
+double indigo_metric_time(void) {
+	if (!indigo_use_metrics)
+		return 0;
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void indigo_metric_add(indigo_metric_counter counter, int64_t value) {
+	metric_block *block;
+	if (!indigo_use_metrics || (block = get_block()) == NULL)
+		return;
+	// single writer per block, so relaxed load and store is enough and avoids locked instructions
+	__atomic_store_n(block->counters + counter, __atomic_load_n(block->counters + counter, __ATOMIC_RELAXED) + value, __ATOMIC_RELAXED);
+}
+
+void indigo_metric_observe(indigo_metric_histogram histogram, double seconds) {
+	metric_block *block;
+	if (!indigo_use_metrics || (block = get_block()) == NULL)
+		return;
+	int bucket = 0;
+	while (bucket < BUCKET_COUNT && seconds > bucket_bounds[bucket])
+		bucket++;
+	uint64_t *count = block->buckets[histogram] + bucket;
+	__atomic_store_n(count, __atomic_load_n(count, __ATOMIC_RELAXED) + 1, __ATOMIC_RELAXED);
+	double sum;
+	__atomic_load(block->sums + histogram, &sum, __ATOMIC_RELAXED);
+	sum += seconds;
+	__atomic_store(block->sums + histogram, &sum, __ATOMIC_RELAXED);
+}
+
+void indigo_metric_observe_since(indigo_metric_histogram histogram, double start) {
+	if (indigo_use_metrics && start > 0)
+		indigo_metric_observe(histogram, indigo_metric_time() - start);
+}
+
+void indigo_metric_register_socket(int socket, const char *protocol) {
+	pthread_mutex_lock(&metrics_mutex);
+	for (int i = 0; i < MAX_SOCKETS; i++) {
+		if (sockets[i].protocol == NULL) {
+			sockets[i].socket = socket;
+			sockets[i].protocol = protocol;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&metrics_mutex);
+}
+
+void indigo_metric_unregister_socket(int socket) {
+	pthread_mutex_lock(&metrics_mutex);
+	for (int i = 0; i < MAX_SOCKETS; i++) {
+		if (sockets[i].protocol != NULL && sockets[i].socket == socket) {
+			sockets[i].protocol = NULL;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&metrics_mutex);
+}
+
+static long send_queue_length(int socket) {
+	int value = -1;
+#if defined(INDIGO_LINUX)
+	if (ioctl(socket, SIOCOUTQ, &value) < 0)
+		value = -1;
+#elif defined(INDIGO_MACOS)
+	socklen_t size = sizeof(value);
+	if (getsockopt(socket, SOL_SOCKET, SO_NWRITE, &value, &size) < 0)
+		value = -1;
+#endif
+	return value;
+}
+
+typedef struct {
+	char *data;
+	long length, size;
+} text_buffer;
+
+static void append(text_buffer *buffer, const char *format, ...) {
+	while (buffer->data) {
+		va_list args;
+		va_start(args, format);
+		long available = buffer->size - buffer->length;
+		int count = vsnprintf(buffer->data + buffer->length, available, format, args);
+		va_end(args);
+		if (count < 0)
+			return;
+		if (count < available) {
+			buffer->length += count;
+			return;
+		}
+		char *data = realloc(buffer->data, buffer->size = 2 * buffer->size + count);
+		if (data == NULL)
+			free(buffer->data);
+		buffer->data = data;
+	}
+}
+
+static void append_labels(text_buffer *buffer, const char *labels, const char *extra) {
+	if (labels && extra)
+		append(buffer, "{%s,%s}", labels, extra);
+	else if (labels || extra)
+		append(buffer, "{%s}", labels ? labels : extra);
+}
+
+char *indigo_metrics_text(long *length) {
+	metric_block total;
+	pthread_mutex_lock(&metrics_mutex);
+	memcpy(&total, &retired, sizeof(total));
+	for (metric_block *block = blocks; block; block = block->next) {
+		for (int i = 0; i < INDIGO_METRIC_COUNTER_COUNT; i++)
+			total.counters[i] += __atomic_load_n(block->counters + i, __ATOMIC_RELAXED);
+		for (int i = 0; i < INDIGO_METRIC_HISTOGRAM_COUNT; i++) {
+			for (int j = 0; j <= BUCKET_COUNT; j++)
+				total.buckets[i][j] += __atomic_load_n(block->buckets[i] + j, __ATOMIC_RELAXED);
+			double sum;
+			__atomic_load(block->sums + i, &sum, __ATOMIC_RELAXED);
+			total.sums[i] += sum;
+		}
+	}
+	text_buffer buffer = { malloc(16 * 1024), 0, 16 * 1024 };
+	for (int i = 0; i < INDIGO_METRIC_COUNTER_COUNT; i++) {
+		if (counter_info[i].help)
+			append(&buffer, "# HELP %s %s\n# TYPE %s %s\n", counter_info[i].name, counter_info[i].help, counter_info[i].name, counter_info[i].type);
+		append(&buffer, "%s", counter_info[i].name);
+		append_labels(&buffer, counter_info[i].labels, NULL);
+		append(&buffer, " %lld\n", (long long)total.counters[i]);
+	}
+	for (int i = 0; i < INDIGO_METRIC_HISTOGRAM_COUNT; i++) {
+		const char *name = histogram_info[i].name;
+		const char *labels = histogram_info[i].labels;
+		if (histogram_info[i].help)
+			append(&buffer, "# HELP %s %s\n# TYPE %s histogram\n", name, histogram_info[i].help, name);
+		uint64_t count = 0;
+		char le[32];
+		for (int j = 0; j <= BUCKET_COUNT; j++) {
+			count += total.buckets[i][j];
+			if (j < BUCKET_COUNT)
+				snprintf(le, sizeof(le), "le=\"%g\"", bucket_bounds[j]);
+			else
+				strcpy(le, "le=\"+Inf\"");
+			append(&buffer, "%s_bucket", name);
+			append_labels(&buffer, labels, le);
+			append(&buffer, " %llu\n", (unsigned long long)count);
+		}
+		append(&buffer, "%s_sum", name);
+		append_labels(&buffer, labels, NULL);
+		append(&buffer, " %.9f\n%s_count", total.sums[i], name);
+		append_labels(&buffer, labels, NULL);
+		append(&buffer, " %llu\n", (unsigned long long)count);
+	}
+	append(&buffer, "# HELP indigo_server_client_send_queue_bytes Unsent bytes queued on client connection\n# TYPE indigo_server_client_send_queue_bytes gauge\n");
+	for (int i = 0; i < MAX_SOCKETS; i++) {
+		if (sockets[i].protocol) {
+			long queue = send_queue_length(sockets[i].socket);
+			if (queue >= 0)
+				append(&buffer, "indigo_server_client_send_queue_bytes{socket=\"%d\",protocol=\"%s\"} %ld\n", sockets[i].socket, sockets[i].protocol, queue);
+		}
+	}
+	pthread_mutex_unlock(&metrics_mutex);
+	*length = buffer.length;
+	return buffer.data;
+}
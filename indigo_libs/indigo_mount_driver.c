@@ -45,6 +45,493 @@ static double indigo_range24(double ha) {
 	return fmod(ha + (24000), 24);
 }
 
+//  Horizon profile is linearly interpolated to table of altitude limits per 0.5° of azimuth, so the limit is evaluated in constant time.
+
+static bool indigo_mount_build_horizon_table(indigo_device *device) {
+	double az[MOUNT_HORIZON_TABLE_SIZE], alt[MOUNT_HORIZON_TABLE_SIZE];
+	int count = 0;
+	char *s = MOUNT_HORIZON_PROFILE_ITEM->text.value;
+	while (true) {
+		while (*s == ' ' || *s == ';' || *s == ',' || *s == '\t' || *s == '\n')
+			s++;
+		if (*s == 0)
+			break;
+		char *end;
+		double a = strtod(s, &end);
+		if (end == s || count == MOUNT_HORIZON_TABLE_SIZE)
+			return false;
+		s = end;
+		double h = strtod(s, &end);
+		if (end == s || h < -90 || h > 90)
+			return false;
+		s = end;
+		a = fmod(fmod(a, 360) + 360, 360);
+		int i = count++;
+		while (i > 0 && az[i - 1] > a) {
+			az[i] = az[i - 1];
+			alt[i] = alt[i - 1];
+			i--;
+		}
+		az[i] = a;
+		alt[i] = h;
+	}
+	double min_alt = MOUNT_LIMITS_MIN_ALT_ITEM->number.value;
+	for (int i = 0; i < MOUNT_HORIZON_TABLE_SIZE; i++) {
+		double a = i * 360.0 / MOUNT_HORIZON_TABLE_SIZE, h = min_alt;
+		if (count == 1) {
+			h = alt[0];
+		} else if (count > 1) {
+			int j = 0;
+			while (j < count && az[j] <= a)
+				j++;
+			int k = (j + count - 1) % count;
+			j = j % count;
+			double span = fmod(az[j] - az[k] + 360, 360);
+			double offset = fmod(a - az[k] + 360, 360);
+			h = span > 0 ? alt[k] + (alt[j] - alt[k]) * offset / span : alt[k];
+		}
+		MOUNT_CONTEXT->horizon_table[i] = fmax(h, min_alt);
+	}
+	return true;
+}
+
+double indigo_mount_horizon_limit(indigo_device *device, double az) {
+	double x = fmod(fmod(az, 360) + 360, 360) * MOUNT_HORIZON_TABLE_SIZE / 360.0;
+	int i = (int)x % MOUNT_HORIZON_TABLE_SIZE;
+	double low = MOUNT_CONTEXT->horizon_table[i], high = MOUNT_CONTEXT->horizon_table[(i + 1) % MOUNT_HORIZON_TABLE_SIZE];
+	return low + (high - low) * (x - (int)x);
+}
+
+static bool indigo_mount_limits_check(indigo_device *device, double alt, double az, double ha, double margin) {
+	if (alt < indigo_mount_horizon_limit(device, az) + margin)
+		return false;
+	if (ha > MOUNT_LIMITS_MERIDIAN_WEST_ITEM->number.value - margin / 15 || ha < -MOUNT_LIMITS_MERIDIAN_EAST_ITEM->number.value + margin / 15)
+		return false;
+	return true;
+}
+
+bool indigo_mount_within_limits(indigo_device *device, double ra, double dec) {
+	if (MOUNT_LIMITS_PROPERTY->hidden || MOUNT_GEOGRAPHIC_COORDINATES_PROPERTY->hidden)
+		return true;
+	time_t utc = indigo_get_mount_utc(device);
+	double alt, az;
+	indigo_eq2hor(&utc, MOUNT_GEOGRAPHIC_COORDINATES_LATITUDE_ITEM->number.value, MOUNT_GEOGRAPHIC_COORDINATES_LONGITUDE_ITEM->number.value, MOUNT_GEOGRAPHIC_COORDINATES_ELEVATION_ITEM->number.value, ra, dec, &alt, &az);
+	double ha = fmod(indigo_lst(&utc, MOUNT_GEOGRAPHIC_COORDINATES_LONGITUDE_ITEM->number.value) - ra + 36, 24) - 12;
+	return indigo_mount_limits_check(device, alt, az, ha, 0);
+}
+
+//  Limits are checked before GOTO reaches the driver, so they are enforced for every driver which makes MOUNT_LIMITS visible
+
+static indigo_result indigo_mount_limits_change_property(indigo_device *device, indigo_client *client, indigo_property *property) {
+	if (IS_CONNECTED && !MOUNT_LIMITS_PROPERTY->hidden && !MOUNT_ON_COORDINATES_SET_SYNC_ITEM->sw.value && indigo_property_match(MOUNT_EQUATORIAL_COORDINATES_PROPERTY, property)) {
+		double ra = MOUNT_EQUATORIAL_COORDINATES_RA_ITEM->number.target;
+		double dec = MOUNT_EQUATORIAL_COORDINATES_DEC_ITEM->number.target;
+		for (int i = 0; i < property->count; i++) {
+			indigo_item *item = property->items + i;
+			if (!strcmp(item->name, MOUNT_EQUATORIAL_COORDINATES_RA_ITEM_NAME))
+				ra = item->number.value;
+			else if (!strcmp(item->name, MOUNT_EQUATORIAL_COORDINATES_DEC_ITEM_NAME))
+				dec = item->number.value;
+		}
+		if (!indigo_mount_within_limits(device, ra, dec)) {
+			MOUNT_EQUATORIAL_COORDINATES_PROPERTY->state = INDIGO_ALERT_STATE;
+			indigo_update_coordinates(device, "Target is outside of mount limits");
+			return INDIGO_OK;
+		}
+	}
+	return MOUNT_CONTEXT->driver_change_property(device, client, property);
+}
+
+static indigo_client limits_client = { "Mount limits", false, NULL, INDIGO_OK, INDIGO_VERSION_CURRENT, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
+
+static void indigo_mount_limits_handler(indigo_device *device) {
+	if (!IS_CONNECTED || !MOUNT_CONTEXT->limits_violated || !MOUNT_TRACKING_ON_ITEM->sw.value)
+		return;
+	indigo_property *property = indigo_init_switch_property(NULL, device->name, MOUNT_TRACKING_PROPERTY_NAME, NULL, NULL, INDIGO_OK_STATE, INDIGO_RW_PERM, INDIGO_ONE_OF_MANY_RULE, 2);
+	if (property == NULL)
+		return;
+	indigo_init_switch_item(property->items + 0, MOUNT_TRACKING_ON_ITEM_NAME, NULL, false);
+	indigo_init_switch_item(property->items + 1, MOUNT_TRACKING_OFF_ITEM_NAME, NULL, true);
+	INDIGO_LOG(indigo_log("%s: mount is outside of limits, tracking stopped", device->name));
+	indigo_send_message(device, "Mount is outside of limits, tracking stopped");
+	property->access_token = device->access_token;
+	indigo_change_property(&limits_client, property);
+	indigo_release_property(property);
+}
+
+//  Non-sidereal tracking follows target computed from orbit, satellite TLE or interpolated in table of positions. Feed forward rate is difference
+//  of target positions one period apart, residual between target and reported position is corrected proportionally.
+
+#define EPHEMERIS_TRACKING_PERIOD						1.0
+#define EPHEMERIS_TRACKING_SATELLITE_PERIOD	0.25
+#define EPHEMERIS_TRACKING_GAIN							(1.0 / 30)
+#define EPHEMERIS_TRACKING_MAX_CORRECTION		10.0
+#define EPHEMERIS_TRACKING_RESLEW						600.0
+#define EPHEMERIS_TRACKING_MAX_RESLEWS			3
+
+typedef struct {
+	pthread_mutex_t mutex;
+	indigo_novas_context context;
+	bool has_orbit;
+	indigo_ephemeris_orbit orbit;
+	bool has_tle;
+	indigo_tle tle;
+	int count;
+	double *time, *ra, *dec;
+	indigo_timer *timer, *ra_timer, *dec_timer;
+	bool slew, custom_rate;
+	bool active;
+	int slews;
+	double period;
+	double ra_rate, dec_rate;
+	double pulse_end, slew_start;
+} indigo_ephemeris_tracking;
+
+#define EPHEMERIS_TRACKING	((indigo_ephemeris_tracking *)MOUNT_CONTEXT->ephemeris_tracking)
+
+static double indigo_range12(double ra) {
+	return fmod(fmod(ra, 24) + 36, 24) - 12;
+}
+
+static bool indigo_ephemeris_table_load(indigo_ephemeris_tracking *tracking, const char *path) {
+	FILE *file = fopen(path, "r");
+	if (file == NULL)
+		return false;
+	char line[256];
+	int count = 0, size = 0;
+	double *times = NULL, *ra = NULL, *dec = NULL;
+	bool result = true;
+	while (result && fgets(line, sizeof(line), file)) {
+		char time_string[64];
+		double r, d;
+		char *s = line + strspn(line, " \t");
+		if (*s == '#' || *s == '\n' || *s == '\r' || *s == 0)
+			continue;
+		if (sscanf(s, "%63s %lf %lf", time_string, &r, &d) != 3 || r < 0 || r >= 24 || d < -90 || d > 90) {
+			result = false;
+			break;
+		}
+		time_t t = indigo_isogmtotime(time_string);
+		if (t == -1 || (count > 0 && t <= times[count - 1])) {
+			result = false;
+			break;
+		}
+		if (count == size) {
+			size = size ? 2 * size : 256;
+			times = realloc(times, size * sizeof(double));
+			ra = realloc(ra, size * sizeof(double));
+			dec = realloc(dec, size * sizeof(double));
+		}
+		times[count] = t;
+		ra[count] = r;
+		dec[count] = d;
+		count++;
+	}
+	fclose(file);
+	if (!result || count < 2) {
+		free(times);
+		free(ra);
+		free(dec);
+		return false;
+	}
+	tracking->count = count;
+	tracking->time = times;
+	tracking->ra = ra;
+	tracking->dec = dec;
+	return true;
+}
+
+static void indigo_ephemeris_tracking_clear(indigo_ephemeris_tracking *tracking) {
+	free(tracking->time);
+	free(tracking->ra);
+	free(tracking->dec);
+	tracking->time = tracking->ra = tracking->dec = NULL;
+	tracking->count = 0;
+	tracking->has_orbit = tracking->has_tle = false;
+}
+
+static bool indigo_ephemeris_tracking_target(indigo_device *device, double utc, double *ra, double *dec) {
+	indigo_ephemeris_tracking *tracking = EPHEMERIS_TRACKING;
+	if (tracking->has_tle) {
+		//  satellites move too fast for interpolation, TLE is propagated for exact time
+		return indigo_novas_topo_satellite(&tracking->context, utc, MOUNT_GEOGRAPHIC_COORDINATES_LATITUDE_ITEM->number.value, MOUNT_GEOGRAPHIC_COORDINATES_LONGITUDE_ITEM->number.value, MOUNT_GEOGRAPHIC_COORDINATES_ELEVATION_ITEM->number.value, 1, &tracking->tle, MOUNT_EPOCH_ITEM->number.value != 2000, ra, dec, NULL);
+	}
+	if (tracking->has_orbit) {
+		//  orbit is evaluated for whole seconds and interpolated linearly
+		double r[2], d[2], f = utc - floor(utc);
+		for (int i = 0; i < 2; i++) {
+			time_t t = (time_t)floor(utc) + i;
+			if (!indigo_novas_topo_orbit(&tracking->context, &t, MOUNT_GEOGRAPHIC_COORDINATES_LATITUDE_ITEM->number.value, MOUNT_GEOGRAPHIC_COORDINATES_LONGITUDE_ITEM->number.value, MOUNT_GEOGRAPHIC_COORDINATES_ELEVATION_ITEM->number.value, 1, &tracking->orbit, MOUNT_EPOCH_ITEM->number.value != 2000, r + i, d + i, NULL))
+				return false;
+		}
+		*ra = fmod(r[0] + f * indigo_range12(r[1] - r[0]) + 24, 24);
+		*dec = d[0] + f * (d[1] - d[0]);
+		return true;
+	}
+	//  table is interpolated by Lagrange polynomial through up to 4 nearest rows, RA is unwrapped around the first of them
+	int count = tracking->count;
+	if (count < 2 || utc < tracking->time[0] || utc > tracking->time[count - 1])
+		return false;
+	int low = 0, high = count - 1;
+	while (high - low > 1) {
+		int mid = (low + high) / 2;
+		if (tracking->time[mid] <= utc)
+			low = mid;
+		else
+			high = mid;
+	}
+	int n = count < 4 ? count : 4;
+	int first = low - (n / 2 - 1);
+	if (first < 0)
+		first = 0;
+	if (first + n > count)
+		first = count - n;
+	double r = 0, d = 0, ra0 = tracking->ra[first];
+	for (int i = first; i < first + n; i++) {
+		double l = 1;
+		for (int j = first; j < first + n; j++)
+			if (j != i)
+				l *= (utc - tracking->time[j]) / (tracking->time[i] - tracking->time[j]);
+		r += l * (ra0 + indigo_range12(tracking->ra[i] - ra0));
+		d += l * tracking->dec[i];
+	}
+	*ra = fmod(r + 24, 24);
+	*dec = d;
+	return true;
+}
+
+static indigo_client ephemeris_tracking_client = { "Ephemeris tracking", false, NULL, INDIGO_OK, INDIGO_VERSION_CURRENT, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
+
+//  Requests made on timer thread go through the bus to be serialised with client requests by device lock, requests made while
+//  handling a change request (tracking stopped by client) are already under the lock and are passed to the driver directly
+
+static void indigo_ephemeris_tracking_send(indigo_device *device, indigo_property *property, bool bus) {
+	property->access_token = device->access_token;
+	if (bus)
+		indigo_change_property(&ephemeris_tracking_client, property);
+	else
+		device->change_property(device, &ephemeris_tracking_client, property);
+	indigo_release_property(property);
+}
+
+static void indigo_ephemeris_tracking_request(indigo_device *device, const char *name, const char *item_1, bool value_1, const char *item_2, bool value_2, bool bus) {
+	indigo_property *property = indigo_init_switch_property(NULL, device->name, name, NULL, NULL, INDIGO_OK_STATE, INDIGO_RW_PERM, INDIGO_AT_MOST_ONE_RULE, item_2 ? 2 : 1);
+	if (property == NULL)
+		return;
+	indigo_init_switch_item(property->items + 0, item_1, NULL, value_1);
+	if (item_2)
+		indigo_init_switch_item(property->items + 1, item_2, NULL, value_2);
+	indigo_ephemeris_tracking_send(device, property, bus);
+}
+
+static void indigo_ephemeris_tracking_stop_ra(indigo_device *device) {
+	EPHEMERIS_TRACKING->ra_timer = NULL;
+	indigo_ephemeris_tracking_request(device, MOUNT_MOTION_RA_PROPERTY_NAME, MOUNT_MOTION_WEST_ITEM_NAME, false, MOUNT_MOTION_EAST_ITEM_NAME, false, true);
+}
+
+static void indigo_ephemeris_tracking_stop_dec(indigo_device *device) {
+	EPHEMERIS_TRACKING->dec_timer = NULL;
+	indigo_ephemeris_tracking_request(device, MOUNT_MOTION_DEC_PROPERTY_NAME, MOUNT_MOTION_NORTH_ITEM_NAME, false, MOUNT_MOTION_SOUTH_ITEM_NAME, false, true);
+}
+
+static void indigo_ephemeris_tracking_set_rate(indigo_device *device, double ra_rate, double dec_rate) {
+	indigo_ephemeris_tracking *tracking = EPHEMERIS_TRACKING;
+	if (!MOUNT_TRACK_RATE_CUSTOM_ITEM->sw.value)
+		indigo_ephemeris_tracking_request(device, MOUNT_TRACK_RATE_PROPERTY_NAME, MOUNT_TRACK_RATE_CUSTOM_ITEM_NAME, true, NULL, false, true);
+	tracking->custom_rate = true;
+	if (fabs(ra_rate - tracking->ra_rate) < 0.001 && fabs(dec_rate - tracking->dec_rate) < 0.001 && MOUNT_CUSTOM_TRACKING_RATE_PROPERTY->state == INDIGO_OK_STATE)
+		return;
+	indigo_property *property = indigo_init_number_property(NULL, device->name, MOUNT_CUSTOM_TRACKING_RATE_PROPERTY_NAME, NULL, NULL, INDIGO_OK_STATE, INDIGO_RW_PERM, 2);
+	if (property == NULL)
+		return;
+	indigo_init_number_item(property->items + 0, MOUNT_CUSTOM_TRACKING_RATE_RA_ITEM_NAME, NULL, 0, 0, 0, tracking->ra_rate = ra_rate);
+	indigo_init_number_item(property->items + 1, MOUNT_CUSTOM_TRACKING_RATE_DEC_ITEM_NAME, NULL, 0, 0, 0, tracking->dec_rate = dec_rate);
+	indigo_ephemeris_tracking_send(device, property, true);
+}
+
+static void indigo_ephemeris_tracking_pulse(indigo_device *device, double now, double ra_move, double dec_move) {
+	indigo_ephemeris_tracking *tracking = EPHEMERIS_TRACKING;
+	double ra_speed = MOUNT_GUIDE_RATE_RA_ITEM->number.value / 100 * 15;
+	double dec_speed = MOUNT_GUIDE_RATE_DEC_ITEM->number.value / 100 * 15;
+	double ra_duration = ra_speed > 0 ? fmin(fabs(ra_move) / ra_speed, 0.9 * tracking->period) : 0;
+	double dec_duration = dec_speed > 0 ? fmin(fabs(dec_move) / dec_speed, 0.9 * tracking->period) : 0;
+	if ((ra_duration > 0.01 || dec_duration > 0.01) && !MOUNT_SLEW_RATE_GUIDE_ITEM->sw.value)
+		indigo_ephemeris_tracking_request(device, MOUNT_SLEW_RATE_PROPERTY_NAME, MOUNT_SLEW_RATE_GUIDE_ITEM_NAME, true, NULL, false, true);
+	if (ra_duration > 0.01 || dec_duration > 0.01)
+		tracking->pulse_end = now + fmax(ra_duration, dec_duration);
+	if (ra_duration > 0.01 && tracking->ra_timer == NULL) {
+		//  motion is in hour angle (as :Mw#/:Me# on LX200), west increases hour angle and decreases RA
+		double ha_move = -ra_move;
+		indigo_ephemeris_tracking_request(device, MOUNT_MOTION_RA_PROPERTY_NAME, MOUNT_MOTION_WEST_ITEM_NAME, ha_move > 0, MOUNT_MOTION_EAST_ITEM_NAME, ha_move < 0, true);
+		indigo_set_timer(device, ra_duration, indigo_ephemeris_tracking_stop_ra, &tracking->ra_timer);
+	}
+	if (dec_duration > 0.01 && tracking->dec_timer == NULL) {
+		indigo_ephemeris_tracking_request(device, MOUNT_MOTION_DEC_PROPERTY_NAME, MOUNT_MOTION_NORTH_ITEM_NAME, dec_move > 0, MOUNT_MOTION_SOUTH_ITEM_NAME, dec_move < 0, true);
+		indigo_set_timer(device, dec_duration, indigo_ephemeris_tracking_stop_dec, &tracking->dec_timer);
+	}
+}
+
+typedef enum {
+	EPHEMERIS_TRACKING_IDLE,
+	EPHEMERIS_TRACKING_SLEW,
+	EPHEMERIS_TRACKING_RATE,
+	EPHEMERIS_TRACKING_PULSE
+} indigo_ephemeris_tracking_action;
+
+//  Target is computed under tracking mutex, requests are sent after it is released, because client request handling takes
+//  device lock first and tracking mutex second
+
+static void indigo_ephemeris_tracking_timer_callback(indigo_device *device) {
+	indigo_ephemeris_tracking *tracking = EPHEMERIS_TRACKING;
+	if (!IS_CONNECTED)
+		return;
+	pthread_mutex_lock(&tracking->mutex);
+	if (!tracking->active || (!tracking->has_orbit && !tracking->has_tle && tracking->count == 0)) {
+		pthread_mutex_unlock(&tracking->mutex);
+		return;
+	}
+	//  fraction of second is taken from host clock, mount clock is used only if it differs
+	struct timespec host;
+	indigo_get_utc(&host);
+	double now = host.tv_sec + host.tv_nsec / 1e9;
+	time_t mount = indigo_get_mount_utc(device);
+	if (labs(mount - host.tv_sec) > 1)
+		now += mount - host.tv_sec;
+	double period = tracking->period, ra, dec, next_ra, next_dec;
+	indigo_ephemeris_tracking_action action = EPHEMERIS_TRACKING_IDLE;
+	double action_ra = 0, action_dec = 0;
+	if (!indigo_ephemeris_tracking_target(device, now, &ra, &dec) || !indigo_ephemeris_tracking_target(device, now + period, &next_ra, &next_dec)) {
+		tracking->active = false;
+		pthread_mutex_unlock(&tracking->mutex);
+		if (tracking->custom_rate)
+			indigo_ephemeris_tracking_set_rate(device, 0, 0);
+		MOUNT_EPHEMERIS_TARGET_PROPERTY->state = INDIGO_ALERT_STATE;
+		indigo_update_property(device, MOUNT_EPHEMERIS_TARGET_PROPERTY, "Target position is not available, ephemeris tracking stopped");
+		return;
+	}
+	double ra_rate = indigo_range12(next_ra - ra) * 54000 / period;
+	double dec_rate = (next_dec - dec) * 3600 / period;
+	double ra_error = indigo_range12(ra - MOUNT_EQUATORIAL_COORDINATES_RA_ITEM->number.value) * 54000;
+	double dec_error = (dec - MOUNT_EQUATORIAL_COORDINATES_DEC_ITEM->number.value) * 3600;
+	MOUNT_EPHEMERIS_TARGET_RA_ITEM->number.value = ra;
+	MOUNT_EPHEMERIS_TARGET_DEC_ITEM->number.value = dec;
+	MOUNT_EPHEMERIS_TARGET_RA_RATE_ITEM->number.value = ra_rate;
+	MOUNT_EPHEMERIS_TARGET_DEC_RATE_ITEM->number.value = dec_rate;
+	double residual = MOUNT_EPHEMERIS_TARGET_RESIDUAL_ITEM->number.value = sqrt(pow(ra_error * cos(dec * DEG2RAD), 2) + dec_error * dec_error);
+	//  mount may report motion for a while after the last pulse, only other motion (e.g. slew) suspends tracking
+	bool moving = MOUNT_EQUATORIAL_COORDINATES_PROPERTY->state == INDIGO_BUSY_STATE && now > tracking->pulse_end + period;
+	if (MOUNT_PARK_PARKED_ITEM->sw.value || moving) {
+		MOUNT_EPHEMERIS_TARGET_PROPERTY->state = INDIGO_OK_STATE;
+	} else if (tracking->slew || (tracking->slew_start > 0 && residual > EPHEMERIS_TRACKING_RESLEW && tracking->slews < EPHEMERIS_TRACKING_MAX_RESLEWS)) {
+		//  fast target moves away during slew, so repeated slew leads it by duration of the previous one
+		double lead_ra, lead_dec;
+		if (tracking->slew) {
+			tracking->slews = 0;
+		} else {
+			tracking->slews++;
+			if (indigo_ephemeris_tracking_target(device, now + now - tracking->slew_start, &lead_ra, &lead_dec)) {
+				next_ra = lead_ra;
+				next_dec = lead_dec;
+			}
+		}
+		tracking->slew = false;
+		tracking->slew_start = now;
+		action = EPHEMERIS_TRACKING_SLEW;
+		action_ra = next_ra;
+		action_dec = next_dec;
+		MOUNT_EPHEMERIS_TARGET_PROPERTY->state = INDIGO_BUSY_STATE;
+	} else if (MOUNT_TRACKING_ON_ITEM->sw.value) {
+		tracking->slew_start = 0;
+		if (!MOUNT_CUSTOM_TRACKING_RATE_PROPERTY->hidden) {
+			//  correction limit grows with target rate to let fast targets catch up
+			double ra_limit = fmax(EPHEMERIS_TRACKING_MAX_CORRECTION, 0.1 * fabs(ra_rate));
+			double dec_limit = fmax(EPHEMERIS_TRACKING_MAX_CORRECTION, 0.1 * fabs(dec_rate));
+			double ra_correction = fmax(-ra_limit, fmin(ra_limit, ra_error * EPHEMERIS_TRACKING_GAIN));
+			double dec_correction = fmax(-dec_limit, fmin(dec_limit, dec_error * EPHEMERIS_TRACKING_GAIN));
+			action = EPHEMERIS_TRACKING_RATE;
+			action_ra = ra_rate + ra_correction;
+			action_dec = dec_rate + dec_correction;
+		} else {
+			action = EPHEMERIS_TRACKING_PULSE;
+			action_ra = ra_error + ra_rate * period;
+			action_dec = dec_error + dec_rate * period;
+		}
+		MOUNT_EPHEMERIS_TARGET_PROPERTY->state = INDIGO_BUSY_STATE;
+	} else {
+		MOUNT_EPHEMERIS_TARGET_PROPERTY->state = INDIGO_OK_STATE;
+	}
+	pthread_mutex_unlock(&tracking->mutex);
+	indigo_update_property(device, MOUNT_EPHEMERIS_TARGET_PROPERTY, NULL);
+	//  tracking stopped by a client request is not overridden by a tick that was already running
+	if (!__atomic_load_n(&tracking->active, __ATOMIC_ACQUIRE))
+		return;
+	switch (action) {
+		case EPHEMERIS_TRACKING_SLEW: {
+			if (!MOUNT_ON_COORDINATES_SET_TRACK_ITEM->sw.value)
+				indigo_ephemeris_tracking_request(device, MOUNT_ON_COORDINATES_SET_PROPERTY_NAME, MOUNT_ON_COORDINATES_SET_TRACK_ITEM_NAME, true, NULL, false, true);
+			indigo_property *property = indigo_init_number_property(NULL, device->name, MOUNT_EQUATORIAL_COORDINATES_PROPERTY_NAME, NULL, NULL, INDIGO_OK_STATE, INDIGO_RW_PERM, 2);
+			if (property != NULL) {
+				indigo_init_number_item(property->items + 0, MOUNT_EQUATORIAL_COORDINATES_RA_ITEM_NAME, NULL, 0, 24, 0, action_ra);
+				indigo_init_number_item(property->items + 1, MOUNT_EQUATORIAL_COORDINATES_DEC_ITEM_NAME, NULL, -90, 90, 0, action_dec);
+				INDIGO_DEBUG(indigo_debug("%s: ephemeris tracking slew to %g %g", device->name, action_ra, action_dec));
+				indigo_ephemeris_tracking_send(device, property, true);
+			}
+			break;
+		}
+		case EPHEMERIS_TRACKING_RATE:
+			indigo_ephemeris_tracking_set_rate(device, action_ra, action_dec);
+			break;
+		case EPHEMERIS_TRACKING_PULSE:
+			indigo_ephemeris_tracking_pulse(device, now, action_ra, action_dec);
+			break;
+		default:
+			break;
+	}
+	indigo_reschedule_timer(device, period, &tracking->timer);
+}
+
+static void indigo_ephemeris_tracking_start(indigo_device *device) {
+	indigo_ephemeris_tracking *tracking = EPHEMERIS_TRACKING;
+	if (tracking == NULL || (!tracking->has_orbit && !tracking->has_tle && tracking->count == 0))
+		return;
+	indigo_cancel_timer(device, &tracking->timer);
+	tracking->ra_rate = tracking->dec_rate = 0;
+	tracking->slew_start = 0;
+	tracking->period = tracking->has_tle ? EPHEMERIS_TRACKING_SATELLITE_PERIOD : EPHEMERIS_TRACKING_PERIOD;
+	__atomic_store_n(&tracking->active, true, __ATOMIC_RELEASE);
+	indigo_set_timer(device, 0, indigo_ephemeris_tracking_timer_callback, &tracking->timer);
+}
+
+//  Stop called while handling a change request holds device lock, so it can't wait for tick blocked on the same lock, only detach waits
+
+static void indigo_ephemeris_tracking_stop(indigo_device *device, bool sync) {
+	indigo_ephemeris_tracking *tracking = EPHEMERIS_TRACKING;
+	if (tracking == NULL)
+		return;
+	__atomic_store_n(&tracking->active, false, __ATOMIC_RELEASE);
+	bool ra_moving, dec_moving;
+	if (sync) {
+		indigo_cancel_timer_sync(device, &tracking->timer);
+		ra_moving = indigo_cancel_timer_sync(device, &tracking->ra_timer);
+		dec_moving = indigo_cancel_timer_sync(device, &tracking->dec_timer);
+	} else {
+		indigo_cancel_timer(device, &tracking->timer);
+		ra_moving = indigo_cancel_timer(device, &tracking->ra_timer);
+		dec_moving = indigo_cancel_timer(device, &tracking->dec_timer);
+	}
+	//  mount is left at sidereal rate, but requests are not sent to disconnected mount
+	if (IS_CONNECTED) {
+		if (ra_moving)
+			indigo_ephemeris_tracking_request(device, MOUNT_MOTION_RA_PROPERTY_NAME, MOUNT_MOTION_WEST_ITEM_NAME, false, MOUNT_MOTION_EAST_ITEM_NAME, false, sync);
+		if (dec_moving)
+			indigo_ephemeris_tracking_request(device, MOUNT_MOTION_DEC_PROPERTY_NAME, MOUNT_MOTION_NORTH_ITEM_NAME, false, MOUNT_MOTION_SOUTH_ITEM_NAME, false, sync);
+		if (tracking->custom_rate && MOUNT_TRACK_RATE_CUSTOM_ITEM->sw.value)
+			indigo_ephemeris_tracking_request(device, MOUNT_TRACK_RATE_PROPERTY_NAME, MOUNT_TRACK_RATE_SIDEREAL_ITEM_NAME, true, NULL, false, sync);
+	}
+	tracking->custom_rate = false;
+	MOUNT_EPHEMERIS_TARGET_PROPERTY->state = INDIGO_OK_STATE;
+}
+
 indigo_result indigo_mount_attach(indigo_device *device, const char* driver_name, unsigned version) {
 	assert(device != NULL);
 	assert(device != NULL);
@@ -210,6 +697,9 @@ indigo_result indigo_mount_attach(indigo_device *device, const char* driver_name
 			indigo_init_sexagesimal_number_item(MOUNT_RAW_COORDINATES_RA_ITEM, MOUNT_RAW_COORDINATES_RA_ITEM_NAME, "Raw right ascension (0 to 24 hrs)", 0, 24, 0, 0);
 			indigo_init_sexagesimal_number_item(MOUNT_RAW_COORDINATES_DEC_ITEM, MOUNT_RAW_COORDINATES_DEC_ITEM_NAME, "Raw declination (-90 to 90°)", -90, 90, 0, 90);
 			// -------------------------------------------------------------------------------- MOUNT_ALIGNMENT_SELECT_POINTS
+			MOUNT_CONTEXT->alignment_points = calloc(MOUNT_MAX_ALIGNMENT_POINTS, sizeof(indigo_alignment_point));
+			assert(MOUNT_CONTEXT->alignment_points != NULL);
+			MOUNT_CONTEXT->alignment_point_capacity = MOUNT_MAX_ALIGNMENT_POINTS;
 			MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY = indigo_init_switch_property(NULL, device->name, MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY_NAME, MOUNT_ALIGNMENT_GROUP, "Select alignment points", INDIGO_OK_STATE, INDIGO_RW_PERM, INDIGO_ONE_OF_MANY_RULE, MOUNT_MAX_ALIGNMENT_POINTS);
 			if (MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY == NULL)
 				return INDIGO_FAILED;
@@ -221,6 +711,21 @@ indigo_result indigo_mount_attach(indigo_device *device, const char* driver_name
 				return INDIGO_FAILED;
 			MOUNT_ALIGNMENT_DELETE_POINTS_PROPERTY->hidden = MOUNT_ALIGNMENT_MODE_CONTROLLER_ITEM->sw.value;
 			MOUNT_ALIGNMENT_DELETE_POINTS_PROPERTY->count = 0;
+			// -------------------------------------------------------------------------------- MOUNT_ALIGNMENT_MODEL
+			MOUNT_ALIGNMENT_MODEL_PROPERTY = indigo_init_number_property(NULL, device->name, MOUNT_ALIGNMENT_MODEL_PROPERTY_NAME, MOUNT_ALIGNMENT_GROUP, "Pointing model", INDIGO_IDLE_STATE, INDIGO_RO_PERM, 10);
+			if (MOUNT_ALIGNMENT_MODEL_PROPERTY == NULL)
+				return INDIGO_FAILED;
+			MOUNT_ALIGNMENT_MODEL_PROPERTY->hidden = true;
+			indigo_init_number_item(MOUNT_ALIGNMENT_MODEL_INDEX_HA_ITEM, MOUNT_ALIGNMENT_MODEL_INDEX_HA_ITEM_NAME, "HA index error (\")", -648000, 648000, 0, 0);
+			indigo_init_number_item(MOUNT_ALIGNMENT_MODEL_INDEX_DEC_ITEM, MOUNT_ALIGNMENT_MODEL_INDEX_DEC_ITEM_NAME, "DEC index error (\")", -648000, 648000, 0, 0);
+			indigo_init_number_item(MOUNT_ALIGNMENT_MODEL_POLAR_AZIMUTH_ITEM, MOUNT_ALIGNMENT_MODEL_POLAR_AZIMUTH_ITEM_NAME, "Polar axis azimuth error (\")", -648000, 648000, 0, 0);
+			indigo_init_number_item(MOUNT_ALIGNMENT_MODEL_POLAR_ELEVATION_ITEM, MOUNT_ALIGNMENT_MODEL_POLAR_ELEVATION_ITEM_NAME, "Polar axis elevation error (\")", -648000, 648000, 0, 0);
+			indigo_init_number_item(MOUNT_ALIGNMENT_MODEL_COLLIMATION_ITEM, MOUNT_ALIGNMENT_MODEL_COLLIMATION_ITEM_NAME, "Collimation error (\")", -648000, 648000, 0, 0);
+			indigo_init_number_item(MOUNT_ALIGNMENT_MODEL_NON_PERPENDICULARITY_ITEM, MOUNT_ALIGNMENT_MODEL_NON_PERPENDICULARITY_ITEM_NAME, "Axes non-perpendicularity (\")", -648000, 648000, 0, 0);
+			indigo_init_number_item(MOUNT_ALIGNMENT_MODEL_TUBE_FLEXURE_ITEM, MOUNT_ALIGNMENT_MODEL_TUBE_FLEXURE_ITEM_NAME, "Tube flexure (\")", -648000, 648000, 0, 0);
+			indigo_init_number_item(MOUNT_ALIGNMENT_MODEL_RMS_ITEM, MOUNT_ALIGNMENT_MODEL_RMS_ITEM_NAME, "Residual RMS (\")", 0, 648000, 0, 0);
+			indigo_init_number_item(MOUNT_ALIGNMENT_MODEL_POINTS_ITEM, MOUNT_ALIGNMENT_MODEL_POINTS_ITEM_NAME, "Points used", 0, 100000, 0, 0);
+			indigo_init_number_item(MOUNT_ALIGNMENT_MODEL_REJECTED_ITEM, MOUNT_ALIGNMENT_MODEL_REJECTED_ITEM_NAME, "Points rejected", 0, 100000, 0, 0);
 			// -------------------------------------------------------------------------------- MOUNT_EPOCH
 			MOUNT_EPOCH_PROPERTY = indigo_init_number_property(NULL, device->name, MOUNT_EPOCH_PROPERTY_NAME, MOUNT_ALIGNMENT_GROUP, "Current epoch", INDIGO_OK_STATE, INDIGO_RO_PERM, 1);
 			if (MOUNT_EPOCH_PROPERTY == NULL)
@@ -254,59 +759,377 @@ indigo_result indigo_mount_attach(indigo_device *device, const char* driver_name
 			MOUNT_PEC_TRAINING_PROPERTY->hidden = true;
 			indigo_init_switch_item(MOUNT_PEC_TRAINIG_STARTED_ITEM, MOUNT_PEC_TRAINIG_STARTED_ITEM_NAME, "Started", false);
 			indigo_init_switch_item(MOUNT_PEC_TRAINIG_STOPPED_ITEM, MOUNT_PEC_TRAINIG_STOPPED_ITEM_NAME, "Stopped", true);
+			// -------------------------------------------------------------------------------- MOUNT_LIMITS
+			MOUNT_LIMITS_PROPERTY = indigo_init_number_property(NULL, device->name, MOUNT_LIMITS_PROPERTY_NAME, MOUNT_SITE_GROUP, "Limits", INDIGO_OK_STATE, INDIGO_RW_PERM, 4);
+			if (MOUNT_LIMITS_PROPERTY == NULL)
+				return INDIGO_FAILED;
+			MOUNT_LIMITS_PROPERTY->hidden = true;
+			indigo_init_number_item(MOUNT_LIMITS_MIN_ALT_ITEM, MOUNT_LIMITS_MIN_ALT_ITEM_NAME, "Minimal altitude (-10 to 90°)", -10, 90, 1, 0);
+			indigo_init_number_item(MOUNT_LIMITS_HYSTERESIS_ITEM, MOUNT_LIMITS_HYSTERESIS_ITEM_NAME, "Hysteresis (0 to 10°)", 0, 10, 0.1, 1);
+			indigo_init_sexagesimal_number_item(MOUNT_LIMITS_MERIDIAN_EAST_ITEM, MOUNT_LIMITS_MERIDIAN_EAST_ITEM_NAME, "Limit east of meridian (0 to 12 hrs)", 0, 12, 0, 12);
+			indigo_init_sexagesimal_number_item(MOUNT_LIMITS_MERIDIAN_WEST_ITEM, MOUNT_LIMITS_MERIDIAN_WEST_ITEM_NAME, "Limit west of meridian (0 to 12 hrs)", 0, 12, 0, 12);
+			// -------------------------------------------------------------------------------- MOUNT_HORIZON
+			MOUNT_HORIZON_PROPERTY = indigo_init_text_property(NULL, device->name, MOUNT_HORIZON_PROPERTY_NAME, MOUNT_SITE_GROUP, "Horizon", INDIGO_OK_STATE, INDIGO_RW_PERM, 1);
+			if (MOUNT_HORIZON_PROPERTY == NULL)
+				return INDIGO_FAILED;
+			MOUNT_HORIZON_PROPERTY->hidden = true;
+			indigo_init_text_item(MOUNT_HORIZON_PROFILE_ITEM, MOUNT_HORIZON_PROFILE_ITEM_NAME, "Profile (az alt; ...)", "");
+			indigo_mount_build_horizon_table(device);
+			// -------------------------------------------------------------------------------- MOUNT_CUSTOM_TRACKING_RATE
+			MOUNT_CUSTOM_TRACKING_RATE_PROPERTY = indigo_init_number_property(NULL, device->name, MOUNT_CUSTOM_TRACKING_RATE_PROPERTY_NAME, MOUNT_MAIN_GROUP, "Custom tracking rate", INDIGO_OK_STATE, INDIGO_RW_PERM, 2);
+			if (MOUNT_CUSTOM_TRACKING_RATE_PROPERTY == NULL)
+				return INDIGO_FAILED;
+			MOUNT_CUSTOM_TRACKING_RATE_PROPERTY->hidden = true;
+			indigo_init_number_item(MOUNT_CUSTOM_TRACKING_RATE_RA_ITEM, MOUNT_CUSTOM_TRACKING_RATE_RA_ITEM_NAME, "RA rate relative to sidereal (\"/s)", -36000, 36000, 0.001, 0);
+			indigo_init_number_item(MOUNT_CUSTOM_TRACKING_RATE_DEC_ITEM, MOUNT_CUSTOM_TRACKING_RATE_DEC_ITEM_NAME, "Dec rate (\"/s)", -36000, 36000, 0.001, 0);
+			// -------------------------------------------------------------------------------- MOUNT_TRACKING_EPHEMERIS
+			MOUNT_TRACKING_EPHEMERIS_PROPERTY = indigo_init_text_property(NULL, device->name, MOUNT_TRACKING_EPHEMERIS_PROPERTY_NAME, MOUNT_MAIN_GROUP, "Ephemeris tracking", INDIGO_OK_STATE, INDIGO_RW_PERM, 3);
+			if (MOUNT_TRACKING_EPHEMERIS_PROPERTY == NULL)
+				return INDIGO_FAILED;
+			MOUNT_TRACKING_EPHEMERIS_PROPERTY->hidden = true;
+			indigo_init_text_item(MOUNT_TRACKING_EPHEMERIS_ELEMENTS_ITEM, MOUNT_TRACKING_EPHEMERIS_ELEMENTS_ITEM_NAME, "Orbital elements", "");
+			indigo_init_text_item(MOUNT_TRACKING_EPHEMERIS_TABLE_ITEM, MOUNT_TRACKING_EPHEMERIS_TABLE_ITEM_NAME, "Ephemeris table file", "");
+			indigo_init_text_item(MOUNT_TRACKING_EPHEMERIS_TLE_ITEM, MOUNT_TRACKING_EPHEMERIS_TLE_ITEM_NAME, "Satellite TLE", "");
+			// -------------------------------------------------------------------------------- MOUNT_EPHEMERIS_TARGET
+			MOUNT_EPHEMERIS_TARGET_PROPERTY = indigo_init_number_property(NULL, device->name, MOUNT_EPHEMERIS_TARGET_PROPERTY_NAME, MOUNT_MAIN_GROUP, "Ephemeris target", INDIGO_OK_STATE, INDIGO_RO_PERM, 5);
+			if (MOUNT_EPHEMERIS_TARGET_PROPERTY == NULL)
+				return INDIGO_FAILED;
+			MOUNT_EPHEMERIS_TARGET_PROPERTY->hidden = true;
+			indigo_init_sexagesimal_number_item(MOUNT_EPHEMERIS_TARGET_RA_ITEM, MOUNT_EPHEMERIS_TARGET_RA_ITEM_NAME, "Right ascension (0 to 24 hrs)", 0, 24, 0, 0);
+			indigo_init_sexagesimal_number_item(MOUNT_EPHEMERIS_TARGET_DEC_ITEM, MOUNT_EPHEMERIS_TARGET_DEC_ITEM_NAME, "Declination (-90 to 90°)", -90, 90, 0, 0);
+			indigo_init_number_item(MOUNT_EPHEMERIS_TARGET_RA_RATE_ITEM, MOUNT_EPHEMERIS_TARGET_RA_RATE_ITEM_NAME, "RA rate relative to sidereal (\"/s)", -36000, 36000, 0, 0);
+			indigo_init_number_item(MOUNT_EPHEMERIS_TARGET_DEC_RATE_ITEM, MOUNT_EPHEMERIS_TARGET_DEC_RATE_ITEM_NAME, "Dec rate (\"/s)", -36000, 36000, 0, 0);
+			indigo_init_number_item(MOUNT_EPHEMERIS_TARGET_RESIDUAL_ITEM, MOUNT_EPHEMERIS_TARGET_RESIDUAL_ITEM_NAME, "Residual (\")", 0, 1e6, 0, 0);
 			// --------------------------------------------------------------------------------
+			MOUNT_CONTEXT->driver_change_property = device->change_property;
+			device->change_property = indigo_mount_limits_change_property;
 			return INDIGO_OK;
 		}
 	}
 	return INDIGO_FAILED;
 }
 
-void indigo_mount_load_alignment_points(indigo_device *device) {
-	int handle = indigo_open_config_file(device->name, 0, O_RDONLY, ".alignment");
-	if (handle > 0) {
-		int count;
-		char buffer[1024], name[INDIGO_NAME_SIZE], label[INDIGO_VALUE_SIZE];
-		indigo_read_line(handle, buffer, sizeof(buffer));
-		sscanf(buffer, "%d", &count);
-		MOUNT_CONTEXT->alignment_point_count = count;
-		MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY->count = count;
-		MOUNT_ALIGNMENT_DELETE_POINTS_PROPERTY->count = count;
-		for (int i = 0; i < count; i++) {
-			indigo_alignment_point *point =  MOUNT_CONTEXT->alignment_points + i;
-			indigo_read_line(handle, buffer, sizeof(buffer));
-			point->used = false;
-			sscanf(buffer, "%d %lg %lg %lg %lg %lg %d", (int *)&point->used, &point->ra, &point->dec, &point->raw_ra, &point->raw_dec, &point->lst, &point->side_of_pier);
-			snprintf(name, INDIGO_NAME_SIZE, "%d", i);
-			snprintf(label, INDIGO_VALUE_SIZE, "%s %s %c", indigo_dtos(point->ra, "%2d:%02d:%02d"), indigo_dtos(point->dec, "%2d:%02d:%02d"), point->side_of_pier == MOUNT_SIDE_EAST ? 'E' : 'W');
-			indigo_init_switch_item(MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY->items + i, name, label, point->used);
-			indigo_init_switch_item(MOUNT_ALIGNMENT_DELETE_POINTS_PROPERTY->items + i, name, label, false);
+//  Alignment points are indexed by unit vectors of their hour angle and declination in balanced k-d tree stored
+//  in array (median of each subrange is its root), chord distance is monotonic with great circle distance.
+
+typedef struct {
+	double v[3];
+	int point;
+	int axis;
+} indigo_alignment_index_node;
+
+typedef struct {
+	int count;
+	indigo_alignment_index_node *observed;
+	indigo_alignment_index_node *raw;
+} indigo_alignment_index;
+
+//  Guards alignment point storage and index, nearest point lookup runs on driver threads while points are edited by change property
+
+static pthread_mutex_t alignment_index_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void indigo_alignment_index_vector(double ha, double dec, double *v) {
+	ha = 15 * ha * DEG2RAD;
+	dec = dec * DEG2RAD;
+	v[0] = cos(dec) * cos(ha);
+	v[1] = cos(dec) * sin(ha);
+	v[2] = sin(dec);
+}
+
+static void indigo_alignment_index_build(indigo_alignment_index_node *nodes, int count) {
+	if (count <= 0)
+		return;
+	double min[3] = { 2, 2, 2 }, max[3] = { -2, -2, -2 };
+	for (int i = 0; i < count; i++) {
+		for (int j = 0; j < 3; j++) {
+			if (nodes[i].v[j] < min[j])
+				min[j] = nodes[i].v[j];
+			if (nodes[i].v[j] > max[j])
+				max[j] = nodes[i].v[j];
 		}
-		close(handle);
-		if (IS_CONNECTED) {
-			MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY->state = INDIGO_OK_STATE;
-			indigo_update_property(device, MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY, NULL);
-			MOUNT_ALIGNMENT_DELETE_POINTS_PROPERTY->state = INDIGO_OK_STATE;
-			indigo_update_property(device, MOUNT_ALIGNMENT_DELETE_POINTS_PROPERTY, NULL);
+	}
+	int axis = 0;
+	for (int j = 1; j < 3; j++)
+		if (max[j] - min[j] > max[axis] - min[axis])
+			axis = j;
+	//  Quickselect median on axis with largest spread
+	int median = count / 2, left = 0, right = count - 1;
+	while (left < right) {
+		double pivot = nodes[(left + right) / 2].v[axis];
+		int i = left, j = right;
+		while (i <= j) {
+			while (nodes[i].v[axis] < pivot)
+				i++;
+			while (nodes[j].v[axis] > pivot)
+				j--;
+			if (i <= j) {
+				indigo_alignment_index_node tmp = nodes[i];
+				nodes[i++] = nodes[j];
+				nodes[j--] = tmp;
+			}
+		}
+		if (median <= j)
+			right = j;
+		else if (median >= i)
+			left = i;
+		else
+			break;
+	}
+	nodes[median].axis = axis;
+	indigo_alignment_index_build(nodes, median);
+	indigo_alignment_index_build(nodes + median + 1, count - median - 1);
+}
+
+static void indigo_alignment_index_search(indigo_alignment_index_node *nodes, int count, double *v, int *nearest, double *min_d) {
+	if (count <= 0)
+		return;
+	int median = count / 2;
+	indigo_alignment_index_node *node = nodes + median;
+	double dx = node->v[0] - v[0], dy = node->v[1] - v[1], dz = node->v[2] - v[2];
+	double d = dx * dx + dy * dy + dz * dz;
+	if (d < *min_d) {
+		*min_d = d;
+		*nearest = node->point;
+	}
+	double delta = v[node->axis] - node->v[node->axis];
+	if (delta < 0) {
+		indigo_alignment_index_search(nodes, median, v, nearest, min_d);
+		if (delta * delta < *min_d)
+			indigo_alignment_index_search(node + 1, count - median - 1, v, nearest, min_d);
+	} else {
+		indigo_alignment_index_search(node + 1, count - median - 1, v, nearest, min_d);
+		if (delta * delta < *min_d)
+			indigo_alignment_index_search(nodes, median, v, nearest, min_d);
+	}
+}
+
+static void indigo_mount_release_alignment_index(indigo_alignment_index *index) {
+	if (index != NULL) {
+		free(index->observed);
+		free(index->raw);
+		free(index);
+	}
+}
+
+//  Rebuild index of used alignment points, must be called whenever points or their selection change
+
+static void indigo_mount_index_alignment_points(indigo_device *device) {
+	indigo_alignment_index *index = calloc(1, sizeof(indigo_alignment_index));
+	assert(index != NULL);
+	int count = MOUNT_CONTEXT->alignment_point_count;
+	index->observed = malloc((count + 1) * sizeof(indigo_alignment_index_node));
+	assert(index->observed != NULL);
+	index->raw = malloc((count + 1) * sizeof(indigo_alignment_index_node));
+	assert(index->raw != NULL);
+	pthread_mutex_lock(&alignment_index_mutex);
+	for (int i = 0; i < count; i++) {
+		indigo_alignment_point *point = MOUNT_CONTEXT->alignment_points + i;
+		if (!point->used)
+			continue;
+		indigo_alignment_index_node *observed = index->observed + index->count;
+		indigo_alignment_index_node *raw = index->raw + index->count;
+		indigo_alignment_index_vector(indigo_range24(point->lst - point->ra), point->dec, observed->v);
+		indigo_alignment_index_vector(indigo_range24(point->lst - point->raw_ra), point->raw_dec, raw->v);
+		observed->point = raw->point = i;
+		index->count++;
+	}
+	indigo_alignment_index_build(index->observed, index->count);
+	indigo_alignment_index_build(index->raw, index->count);
+	indigo_alignment_index *old_index = MOUNT_CONTEXT->alignment_index;
+	MOUNT_CONTEXT->alignment_index = index;
+	pthread_mutex_unlock(&alignment_index_mutex);
+	indigo_mount_release_alignment_index(old_index);
+}
+
+//  Grow alignment point storage and point selection properties, properties must not be defined
+
+static void indigo_mount_reserve_alignment_points(indigo_device *device, int count) {
+	int capacity = MOUNT_CONTEXT->alignment_point_capacity;
+	if (count <= capacity)
+		return;
+	while (capacity < count)
+		capacity *= 2;
+	pthread_mutex_lock(&alignment_index_mutex);
+	MOUNT_CONTEXT->alignment_points = realloc(MOUNT_CONTEXT->alignment_points, capacity * sizeof(indigo_alignment_point));
+	assert(MOUNT_CONTEXT->alignment_points != NULL);
+	memset(MOUNT_CONTEXT->alignment_points + MOUNT_CONTEXT->alignment_point_capacity, 0, (capacity - MOUNT_CONTEXT->alignment_point_capacity) * sizeof(indigo_alignment_point));
+	pthread_mutex_unlock(&alignment_index_mutex);
+	int select_count = MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY->count;
+	int delete_count = MOUNT_ALIGNMENT_DELETE_POINTS_PROPERTY->count;
+	MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY->count = MOUNT_ALIGNMENT_DELETE_POINTS_PROPERTY->count = MOUNT_CONTEXT->alignment_point_capacity;
+	MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY = indigo_resize_property(MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY, capacity);
+	MOUNT_ALIGNMENT_DELETE_POINTS_PROPERTY = indigo_resize_property(MOUNT_ALIGNMENT_DELETE_POINTS_PROPERTY, capacity);
+	MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY->count = select_count;
+	MOUNT_ALIGNMENT_DELETE_POINTS_PROPERTY->count = delete_count;
+	MOUNT_CONTEXT->alignment_point_capacity = capacity;
+	INDIGO_DEBUG(indigo_debug("%s: alignment point capacity increased to %d", device->name, capacity));
+}
+
+//  Alignment points are stored as single record of .alignment.store, it is format version, point count and point size
+//  followed by points (used and side of pier as int32, LST, RA, DEC, raw RA and raw DEC as doubles)
+
+#define ALIGNMENT_RECORD_VERSION		1
+#define ALIGNMENT_RECORD_HEADER			(3 * sizeof(int32_t))
+#define ALIGNMENT_RECORD_POINT			(2 * sizeof(int32_t) + 5 * sizeof(double))
+
+static indigo_alignment_point *indigo_mount_decode_alignment_points(const uint8_t *record, int length, int *count) {
+	int32_t header[3];
+	if (record == NULL || length < ALIGNMENT_RECORD_HEADER)
+		return NULL;
+	memcpy(header, record, sizeof(header));
+	if (header[0] != ALIGNMENT_RECORD_VERSION || header[1] < 0 || header[2] < ALIGNMENT_RECORD_POINT || length < ALIGNMENT_RECORD_HEADER + (long)header[1] * header[2])
+		return NULL;
+	*count = header[1];
+	indigo_alignment_point *points = calloc(*count + 1, sizeof(indigo_alignment_point));
+	assert(points != NULL);
+	for (int i = 0; i < *count; i++) {
+		const uint8_t *pnt = record + ALIGNMENT_RECORD_HEADER + i * header[2];
+		int32_t flags[2];
+		double values[5];
+		memcpy(flags, pnt, sizeof(flags));
+		memcpy(values, pnt + sizeof(flags), sizeof(values));
+		points[i].used = flags[0] != 0;
+		points[i].side_of_pier = flags[1];
+		points[i].lst = values[0];
+		points[i].ra = values[1];
+		points[i].dec = values[2];
+		points[i].raw_ra = values[3];
+		points[i].raw_dec = values[4];
+	}
+	return points;
+}
+
+//  Read .alignment text file written by previous versions
+
+static indigo_alignment_point *indigo_mount_read_alignment_file(indigo_device *device, int *count) {
+	int handle = indigo_open_config_file(device->name, 0, O_RDONLY, ".alignment");
+	if (handle <= 0)
+		return NULL;
+	char buffer[1024];
+	if (indigo_read_line(handle, buffer, sizeof(buffer) - 1) < 0 || sscanf(buffer, "%d", count) != 1 || *count < 0)
+		*count = 0;
+	indigo_alignment_point *points = calloc(*count + 1, sizeof(indigo_alignment_point));
+	assert(points != NULL);
+	for (int i = 0; i < *count; i++) {
+		indigo_alignment_point *point = points + i;
+		int used = 0;
+		if (indigo_read_line(handle, buffer, sizeof(buffer) - 1) < 0) {
+			*count = i;
+			break;
 		}
+		sscanf(buffer, "%d %lg %lg %lg %lg %lg %d", &used, &point->ra, &point->dec, &point->raw_ra, &point->raw_dec, &point->lst, &point->side_of_pier);
+		point->used = used != 0;
+	}
+	close(handle);
+	return points;
+}
+
+void indigo_mount_load_alignment_points(indigo_device *device) {
+	int count = 0;
+	indigo_alignment_point *points = NULL;
+	char path[512];
+	indigo_store *store = indigo_open_config_store(device->name, 0, ".alignment.store", false, path, sizeof(path));
+	if (store != NULL) {
+		int length;
+		const void *record = indigo_store_get(store, "points", &length);
+		points = indigo_mount_decode_alignment_points(record, length, &count);
+		if (points == NULL)
+			INDIGO_ERROR(indigo_error("%s: invalid alignment point record in %s", device->name, path));
+		indigo_store_close(store);
+	} else {
+		points = indigo_mount_read_alignment_file(device, &count);
+	}
+	if (points == NULL)
+		return;
+	char name[INDIGO_NAME_SIZE], label[INDIGO_VALUE_SIZE];
+	if (IS_CONNECTED) {
+		indigo_delete_property(device, MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY, NULL);
+		indigo_delete_property(device, MOUNT_ALIGNMENT_DELETE_POINTS_PROPERTY, NULL);
+	}
+	indigo_mount_reserve_alignment_points(device, count);
+	pthread_mutex_lock(&alignment_index_mutex);
+	memcpy(MOUNT_CONTEXT->alignment_points, points, count * sizeof(indigo_alignment_point));
+	MOUNT_CONTEXT->alignment_point_count = count;
+	pthread_mutex_unlock(&alignment_index_mutex);
+	free(points);
+	MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY->count = count;
+	MOUNT_ALIGNMENT_DELETE_POINTS_PROPERTY->count = count;
+	for (int i = 0; i < count; i++) {
+		indigo_alignment_point *point =  MOUNT_CONTEXT->alignment_points + i;
+		snprintf(name, INDIGO_NAME_SIZE, "%d", i);
+		snprintf(label, INDIGO_VALUE_SIZE, "%s %s %c", indigo_dtos(point->ra, "%2d:%02d:%02d"), indigo_dtos(point->dec, "%2d:%02d:%02d"), point->side_of_pier == MOUNT_SIDE_EAST ? 'E' : 'W');
+		indigo_init_switch_item(MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY->items + i, name, label, point->used);
+		indigo_init_switch_item(MOUNT_ALIGNMENT_DELETE_POINTS_PROPERTY->items + i, name, label, false);
+	}
+	if (store == NULL)
+		indigo_mount_save_alignment_points(device);
+	indigo_mount_index_alignment_points(device);
+	indigo_mount_fit_pointing_model(device);
+	if (IS_CONNECTED) {
+		MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY->state = INDIGO_OK_STATE;
+		indigo_define_property(device, MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY, NULL);
+		MOUNT_ALIGNMENT_DELETE_POINTS_PROPERTY->state = INDIGO_OK_STATE;
+		indigo_define_property(device, MOUNT_ALIGNMENT_DELETE_POINTS_PROPERTY, NULL);
 	}
 }
 
 void indigo_mount_save_alignment_points(indigo_device *device) {
-	int handle = indigo_open_config_file(device->name, 0, O_WRONLY | O_CREAT | O_TRUNC, ".alignment");
-	if (handle > 0) {
+	char path[512];
+	indigo_store *store = indigo_open_config_store(device->name, 0, ".alignment.store", true, path, sizeof(path));
+	if (store != NULL) {
 		int count = MOUNT_CONTEXT->alignment_point_count;
-		char b1[32], b2[32], b3[32], b4[32], b5[32];
-		indigo_printf(handle, "%d\n", count);
+		int length = ALIGNMENT_RECORD_HEADER + count * ALIGNMENT_RECORD_POINT;
+		uint8_t *record = malloc(length);
+		assert(record != NULL);
+		int32_t header[3] = { ALIGNMENT_RECORD_VERSION, count, ALIGNMENT_RECORD_POINT };
+		memcpy(record, header, sizeof(header));
 		for (int i = 0; i < count; i++) {
 			indigo_alignment_point *point =  MOUNT_CONTEXT->alignment_points + i;
-			indigo_printf(handle, "%d %s %s %s %s %s %d\n", point->used, indigo_dtoa(point->ra, b1), indigo_dtoa(point->dec, b2), indigo_dtoa(point->raw_ra, b3), indigo_dtoa(point->raw_dec, b4), indigo_dtoa(point->lst, b5), point->side_of_pier);
+			int32_t flags[2] = { point->used, point->side_of_pier };
+			double values[5] = { point->lst, point->ra, point->dec, point->raw_ra, point->raw_dec };
+			uint8_t *pnt = record + ALIGNMENT_RECORD_HEADER + i * ALIGNMENT_RECORD_POINT;
+			memcpy(pnt, flags, sizeof(flags));
+			memcpy(pnt + sizeof(flags), values, sizeof(values));
 		}
-		close(handle);
+		if (!indigo_store_put(store, "points", record, length))
+			INDIGO_ERROR(indigo_error("%s: can't save alignment points to %s", device->name, path));
+		free(record);
+		indigo_store_close(store);
 	}
 }
 
+bool indigo_mount_get_alignment_point(indigo_device *device, int index, indigo_alignment_point *point) {
+	bool result = false;
+	pthread_mutex_lock(&alignment_index_mutex);
+	if (index >= 0 && index < MOUNT_CONTEXT->alignment_point_count) {
+		*point = MOUNT_CONTEXT->alignment_points[index];
+		result = true;
+	}
+	pthread_mutex_unlock(&alignment_index_mutex);
+	return result;
+}
+
+bool indigo_mount_set_alignment_point(indigo_device *device, int index, const indigo_alignment_point *point) {
+	bool result = false;
+	pthread_mutex_lock(&alignment_index_mutex);
+	if (index >= 0 && index < MOUNT_CONTEXT->alignment_point_count) {
+		indigo_alignment_point *alignment_point = MOUNT_CONTEXT->alignment_points + index;
+		alignment_point->ra = point->ra;
+		alignment_point->dec = point->dec;
+		alignment_point->raw_ra = point->raw_ra;
+		alignment_point->raw_dec = point->raw_dec;
+		alignment_point->lst = point->lst;
+		alignment_point->side_of_pier = point->side_of_pier;
+		result = true;
+	}
+	pthread_mutex_unlock(&alignment_index_mutex);
+	return result;
+}
+
 void indigo_mount_update_alignment_points(indigo_device *device) {
 	indigo_mount_save_alignment_points(device);
+	indigo_mount_index_alignment_points(device);
+	indigo_mount_fit_pointing_model(device);
 	char label[INDIGO_VALUE_SIZE];
 	for (int i = 0; i < MOUNT_CONTEXT->alignment_point_count; i++) {
 		indigo_alignment_point *point =  MOUNT_CONTEXT->alignment_points + i;
@@ -326,6 +1149,178 @@ void indigo_mount_update_alignment_points(indigo_device *device) {
 	indigo_define_property(device, MOUNT_ALIGNMENT_DELETE_POINTS_PROPERTY, NULL);
 }
 
+#define POINTING_MODEL_REJECT			3.0							// reject worst point if its residual exceeds REJECT * RMS
+#define POINTING_MODEL_MIN_RMS		(1.0 / 3600.0)	// don't reject points if RMS is below 1"
+#define POINTING_MODEL_SINGULAR		1e-9						// term is not fitted if it is not determined by alignment points
+
+static double indigo_range180(double angle) {
+	angle = fmod(angle, 360);
+	if (angle > 180)
+		angle -= 360;
+	else if (angle < -180)
+		angle += 360;
+	return angle;
+}
+
+//  Partial derivatives of HA correction (multiplied by cos(dec)) and DEC correction by model terms
+//  IH, ID, MA, ME, CH, NP, TF, on the other side of pier of german mount ID, CH and NP change sign
+static void indigo_pointing_model_derivatives(indigo_device *device, double ha, double dec, int side_of_pier, double *dh, double *dd) {
+	double lat = MOUNT_GEOGRAPHIC_COORDINATES_LATITUDE_ITEM->number.value * DEG2RAD;
+	double sin_ha = sin(ha * DEG2RAD), cos_ha = cos(ha * DEG2RAD);
+	double sin_dec = sin(dec * DEG2RAD), cos_dec = cos(dec * DEG2RAD);
+	double flip = (MOUNT_SIDE_OF_PIER_PROPERTY->hidden || side_of_pier == MOUNT_SIDE_WEST) ? 1 : -1;
+	dh[0] = cos_dec;                   dd[0] = 0;
+	dh[1] = 0;                         dd[1] = flip;
+	dh[2] = -cos_ha * sin_dec;         dd[2] = sin_ha;
+	dh[3] = sin_ha * sin_dec;          dd[3] = cos_ha;
+	dh[4] = flip;                      dd[4] = 0;
+	dh[5] = flip * sin_dec;            dd[5] = 0;
+	dh[6] = cos(lat) * sin_ha;         dd[6] = cos(lat) * cos_ha * sin_dec - sin(lat) * cos_dec;
+}
+
+//  HA and DEC correction in degrees, raw position = observed position + correction
+static void indigo_pointing_model_correction(indigo_device *device, const indigo_pointing_model *model, double ha, double dec, int side_of_pier, double *delta_ha, double *delta_dec) {
+	double dh[MOUNT_POINTING_MODEL_TERMS], dd[MOUNT_POINTING_MODEL_TERMS];
+	const double *terms = model->terms;
+	indigo_pointing_model_derivatives(device, ha, dec, side_of_pier, dh, dd);
+	*delta_ha = *delta_dec = 0;
+	for (int i = 0; i < MOUNT_POINTING_MODEL_TERMS; i++) {
+		*delta_ha += terms[i] * dh[i];
+		*delta_dec += terms[i] * dd[i];
+	}
+	//  HA correction is meaningless at the pole
+	*delta_ha /= fmax(cos(dec * DEG2RAD), 1e-3);
+}
+
+//  Observed to raw HA and DEC difference of alignment point, HA difference is multiplied by cos(dec)
+static void indigo_pointing_model_error(indigo_alignment_point *point, double *error_ha, double *error_dec) {
+	*error_ha = indigo_range180(15 * (point->ra - point->raw_ra)) * cos(point->dec * DEG2RAD);
+	*error_dec = point->raw_dec - point->dec;
+}
+
+static double indigo_pointing_model_residual(indigo_device *device, const indigo_pointing_model *model, indigo_alignment_point *point) {
+	double dh[MOUNT_POINTING_MODEL_TERMS], dd[MOUNT_POINTING_MODEL_TERMS];
+	double error_ha, error_dec;
+	indigo_pointing_model_derivatives(device, 15 * (point->lst - point->ra), point->dec, point->side_of_pier, dh, dd);
+	indigo_pointing_model_error(point, &error_ha, &error_dec);
+	for (int i = 0; i < MOUNT_POINTING_MODEL_TERMS; i++) {
+		error_ha -= model->terms[i] * dh[i];
+		error_dec -= model->terms[i] * dd[i];
+	}
+	return sqrt(error_ha * error_ha + error_dec * error_dec);
+}
+
+//  Least squares fit of model terms to points not rejected yet, terms not determined by points are set to 0
+static int indigo_pointing_model_solve(indigo_device *device, indigo_pointing_model *model, bool *rejected) {
+	double a[MOUNT_POINTING_MODEL_TERMS][MOUNT_POINTING_MODEL_TERMS] = { 0 }, b[MOUNT_POINTING_MODEL_TERMS] = { 0 }, diagonal[MOUNT_POINTING_MODEL_TERMS];
+	double dh[MOUNT_POINTING_MODEL_TERMS], dd[MOUNT_POINTING_MODEL_TERMS];
+	double *x = model->terms;
+	int points = 0;
+	for (int i = 0; i < MOUNT_CONTEXT->alignment_point_count; i++) {
+		indigo_alignment_point *point = MOUNT_CONTEXT->alignment_points + i;
+		if (!point->used || rejected[i])
+			continue;
+		double error_ha, error_dec;
+		indigo_pointing_model_derivatives(device, 15 * (point->lst - point->ra), point->dec, point->side_of_pier, dh, dd);
+		indigo_pointing_model_error(point, &error_ha, &error_dec);
+		for (int j = 0; j < MOUNT_POINTING_MODEL_TERMS; j++) {
+			for (int k = 0; k < MOUNT_POINTING_MODEL_TERMS; k++)
+				a[j][k] += dh[j] * dh[k] + dd[j] * dd[k];
+			b[j] += dh[j] * error_ha + dd[j] * error_dec;
+		}
+		points++;
+	}
+	//  Normal equations are eliminated in order of terms, so term already explained by previous ones is dropped
+	int count = points * 2 < MOUNT_POINTING_MODEL_TERMS ? points * 2 : MOUNT_POINTING_MODEL_TERMS;
+	for (int i = 0; i < count; i++)
+		diagonal[i] = a[i][i];
+	for (int i = 0; i < count; i++) {
+		if (a[i][i] <= POINTING_MODEL_SINGULAR * diagonal[i] || a[i][i] <= 0) {
+			for (int j = 0; j < count; j++)
+				a[i][j] = a[j][i] = 0;
+			a[i][i] = 1;
+			b[i] = 0;
+			continue;
+		}
+		for (int j = i + 1; j < count; j++) {
+			double factor = a[j][i] / a[i][i];
+			for (int k = i; k < count; k++)
+				a[j][k] -= factor * a[i][k];
+			b[j] -= factor * b[i];
+		}
+	}
+	for (int i = MOUNT_POINTING_MODEL_TERMS - 1; i >= 0; i--) {
+		if (i >= count) {
+			x[i] = 0;
+			continue;
+		}
+		double sum = b[i];
+		for (int j = i + 1; j < count; j++)
+			sum -= a[i][j] * x[j];
+		x[i] = sum / a[i][i];
+	}
+	return points;
+}
+
+//  Model is fitted into local copy and published under alignment_index_mutex, so readers never see partially fitted terms
+
+static bool indigo_pointing_model_snapshot(indigo_device *device, indigo_pointing_model *model) {
+	pthread_mutex_lock(&alignment_index_mutex);
+	*model = MOUNT_CONTEXT->pointing_model;
+	pthread_mutex_unlock(&alignment_index_mutex);
+	return model->valid;
+}
+
+void indigo_mount_fit_pointing_model(indigo_device *device) {
+	indigo_pointing_model fitted = { 0 }, *model = &fitted;
+	pthread_mutex_lock(&alignment_index_mutex);
+	int count = MOUNT_CONTEXT->alignment_point_count;
+	bool *rejected = calloc(count + 1, sizeof(bool));
+	assert(rejected != NULL);
+	while (true) {
+		model->points = indigo_pointing_model_solve(device, model, rejected);
+		if (model->points == 0)
+			break;
+		double sum = 0, worst_residual = 0;
+		int worst = -1;
+		for (int i = 0; i < count; i++) {
+			indigo_alignment_point *point = MOUNT_CONTEXT->alignment_points + i;
+			if (!point->used || rejected[i])
+				continue;
+			double residual = indigo_pointing_model_residual(device, model, point);
+			sum += residual * residual;
+			if (residual > worst_residual) {
+				worst_residual = residual;
+				worst = i;
+			}
+		}
+		model->rms = sqrt(sum / model->points);
+		model->valid = true;
+		//  Reject one outlier at a time while enough points remain to determine all terms
+		if (worst < 0 || model->rms < POINTING_MODEL_MIN_RMS || worst_residual < POINTING_MODEL_REJECT * model->rms || (model->points - 1) * 2 < MOUNT_POINTING_MODEL_TERMS)
+			break;
+		INDIGO_DEBUG(indigo_debug("%s: alignment point #%d rejected, residual %.1f\"", device->name, worst, worst_residual * 3600));
+		rejected[worst] = true;
+		model->rejected++;
+	}
+	for (int i = 0; i < count; i++) {
+		indigo_alignment_point *point = MOUNT_CONTEXT->alignment_points + i;
+		if (model->valid && point->used)
+			INDIGO_DEBUG(indigo_debug("%s: alignment point #%d residual %.1f\"%s", device->name, i, indigo_pointing_model_residual(device, model, point) * 3600, rejected[i] ? " (rejected)" : ""));
+	}
+	MOUNT_CONTEXT->pointing_model = fitted;
+	pthread_mutex_unlock(&alignment_index_mutex);
+	free(rejected);
+	for (int i = 0; i < MOUNT_POINTING_MODEL_TERMS; i++)
+		MOUNT_ALIGNMENT_MODEL_PROPERTY->items[i].number.value = round(model->terms[i] * 36000) / 10;
+	MOUNT_ALIGNMENT_MODEL_RMS_ITEM->number.value = round(model->rms * 36000) / 10;
+	MOUNT_ALIGNMENT_MODEL_POINTS_ITEM->number.value = model->points;
+	MOUNT_ALIGNMENT_MODEL_REJECTED_ITEM->number.value = model->rejected;
+	MOUNT_ALIGNMENT_MODEL_PROPERTY->state = model->valid ? INDIGO_OK_STATE : INDIGO_IDLE_STATE;
+	if (IS_CONNECTED)
+		indigo_update_property(device, MOUNT_ALIGNMENT_MODEL_PROPERTY, NULL);
+}
+
 indigo_result indigo_mount_enumerate_properties(indigo_device *device, indigo_client *client, indigo_property *property) {
 	assert(device != NULL);
 	assert(DEVICE_CONTEXT != NULL);
@@ -380,6 +1375,8 @@ indigo_result indigo_mount_enumerate_properties(indigo_device *device, indigo_cl
 			indigo_define_property(device, MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY, NULL);
 		if (indigo_property_match(MOUNT_ALIGNMENT_DELETE_POINTS_PROPERTY, property))
 			indigo_define_property(device, MOUNT_ALIGNMENT_DELETE_POINTS_PROPERTY, NULL);
+		if (indigo_property_match(MOUNT_ALIGNMENT_MODEL_PROPERTY, property))
+			indigo_define_property(device, MOUNT_ALIGNMENT_MODEL_PROPERTY, NULL);
 		if (indigo_property_match(MOUNT_EPOCH_PROPERTY, property))
 			indigo_define_property(device, MOUNT_EPOCH_PROPERTY, NULL);
 		if (indigo_property_match(MOUNT_SIDE_OF_PIER_PROPERTY, property))
@@ -390,6 +1387,16 @@ indigo_result indigo_mount_enumerate_properties(indigo_device *device, indigo_cl
 			indigo_define_property(device, MOUNT_PEC_PROPERTY, NULL);
 		if (indigo_property_match(MOUNT_PEC_TRAINING_PROPERTY, property))
 			indigo_define_property(device, MOUNT_PEC_TRAINING_PROPERTY, NULL);
+		if (indigo_property_match(MOUNT_LIMITS_PROPERTY, property))
+			indigo_define_property(device, MOUNT_LIMITS_PROPERTY, NULL);
+		if (indigo_property_match(MOUNT_HORIZON_PROPERTY, property))
+			indigo_define_property(device, MOUNT_HORIZON_PROPERTY, NULL);
+		if (indigo_property_match(MOUNT_CUSTOM_TRACKING_RATE_PROPERTY, property))
+			indigo_define_property(device, MOUNT_CUSTOM_TRACKING_RATE_PROPERTY, NULL);
+		if (indigo_property_match(MOUNT_TRACKING_EPHEMERIS_PROPERTY, property))
+			indigo_define_property(device, MOUNT_TRACKING_EPHEMERIS_PROPERTY, NULL);
+		if (indigo_property_match(MOUNT_EPHEMERIS_TARGET_PROPERTY, property))
+			indigo_define_property(device, MOUNT_EPHEMERIS_TARGET_PROPERTY, NULL);
 	}
 	return indigo_device_enumerate_properties(device, client, property);
 }
@@ -428,11 +1435,18 @@ indigo_result indigo_mount_change_property(indigo_device *device, indigo_client
 			indigo_define_property(device, MOUNT_RAW_COORDINATES_PROPERTY, NULL);
 			indigo_define_property(device, MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY, NULL);
 			indigo_define_property(device, MOUNT_ALIGNMENT_DELETE_POINTS_PROPERTY, NULL);
+			indigo_define_property(device, MOUNT_ALIGNMENT_MODEL_PROPERTY, NULL);
 			indigo_define_property(device, MOUNT_EPOCH_PROPERTY, NULL);
 			indigo_define_property(device, MOUNT_SIDE_OF_PIER_PROPERTY, NULL);
 			indigo_define_property(device, MOUNT_SNOOP_DEVICES_PROPERTY, NULL);
 			indigo_define_property(device, MOUNT_PEC_PROPERTY, NULL);
 			indigo_define_property(device, MOUNT_PEC_TRAINING_PROPERTY, NULL);
+			indigo_define_property(device, MOUNT_LIMITS_PROPERTY, NULL);
+			indigo_define_property(device, MOUNT_HORIZON_PROPERTY, NULL);
+			indigo_define_property(device, MOUNT_CUSTOM_TRACKING_RATE_PROPERTY, NULL);
+			indigo_define_property(device, MOUNT_TRACKING_EPHEMERIS_PROPERTY, NULL);
+			indigo_define_property(device, MOUNT_EPHEMERIS_TARGET_PROPERTY, NULL);
+			indigo_ephemeris_tracking_start(device);
 			indigo_add_snoop_rule(MOUNT_PARK_PROPERTY, MOUNT_SNOOP_JOYSTICK_ITEM->text.value, MOUNT_PARK_PROPERTY_NAME);
 			indigo_add_snoop_rule(MOUNT_SLEW_RATE_PROPERTY, MOUNT_SNOOP_JOYSTICK_ITEM->text.value, MOUNT_SLEW_RATE_PROPERTY_NAME);
 			indigo_add_snoop_rule(MOUNT_TRACKING_PROPERTY, MOUNT_SNOOP_JOYSTICK_ITEM->text.value, MOUNT_TRACKING_PROPERTY_NAME);
@@ -482,11 +1496,20 @@ indigo_result indigo_mount_change_property(indigo_device *device, indigo_client
 			indigo_delete_property(device, MOUNT_RAW_COORDINATES_PROPERTY, NULL);
 			indigo_delete_property(device, MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY, NULL);
 			indigo_delete_property(device, MOUNT_ALIGNMENT_DELETE_POINTS_PROPERTY, NULL);
+			indigo_delete_property(device, MOUNT_ALIGNMENT_MODEL_PROPERTY, NULL);
 			indigo_delete_property(device, MOUNT_EPOCH_PROPERTY, NULL);
 			indigo_delete_property(device, MOUNT_SIDE_OF_PIER_PROPERTY, NULL);
 			indigo_delete_property(device, MOUNT_SNOOP_DEVICES_PROPERTY, NULL);
 			indigo_delete_property(device, MOUNT_PEC_PROPERTY, NULL);
 			indigo_delete_property(device, MOUNT_PEC_TRAINING_PROPERTY, NULL);
+			indigo_delete_property(device, MOUNT_LIMITS_PROPERTY, NULL);
+			indigo_delete_property(device, MOUNT_HORIZON_PROPERTY, NULL);
+			indigo_ephemeris_tracking_stop(device, false);
+			indigo_delete_property(device, MOUNT_CUSTOM_TRACKING_RATE_PROPERTY, NULL);
+			indigo_delete_property(device, MOUNT_TRACKING_EPHEMERIS_PROPERTY, NULL);
+			indigo_delete_property(device, MOUNT_EPHEMERIS_TARGET_PROPERTY, NULL);
+			MOUNT_CONTEXT->limits_violated = MOUNT_CONTEXT->limits_tracking_stopped = false;
+			MOUNT_LIMITS_PROPERTY->state = INDIGO_OK_STATE;
 		}
 	} else if (indigo_property_match(MOUNT_GEOGRAPHIC_COORDINATES_PROPERTY, property)) {
 		// -------------------------------------------------------------------------------- MOUNT_GEOGRAPHIC_COORDINATES
@@ -512,6 +1535,7 @@ indigo_result indigo_mount_change_property(indigo_device *device, indigo_client
 				indigo_update_property(device, MOUNT_HOME_POSITION_PROPERTY, NULL);
 			}
 		}
+		indigo_mount_fit_pointing_model(device);
 		indigo_update_coordinates(device, NULL);
 		MOUNT_GEOGRAPHIC_COORDINATES_PROPERTY->state = INDIGO_OK_STATE;
 		if (IS_CONNECTED) {
@@ -606,6 +1630,79 @@ indigo_result indigo_mount_change_property(indigo_device *device, indigo_client
 		MOUNT_HOME_SET_PROPERTY->state = INDIGO_OK_STATE;
 		indigo_update_property(device, MOUNT_HOME_SET_PROPERTY, NULL);
 		return INDIGO_OK;
+	} else if (indigo_property_match(MOUNT_LIMITS_PROPERTY, property)) {
+		// -------------------------------------------------------------------------------- MOUNT_LIMITS
+		indigo_property_copy_values(MOUNT_LIMITS_PROPERTY, property, false);
+		indigo_mount_build_horizon_table(device);
+		MOUNT_CONTEXT->limits_violated = MOUNT_CONTEXT->limits_tracking_stopped = false;
+		MOUNT_LIMITS_PROPERTY->state = INDIGO_OK_STATE;
+		if (IS_CONNECTED) {
+			indigo_update_property(device, MOUNT_LIMITS_PROPERTY, NULL);
+			indigo_update_coordinates(device, NULL);
+		}
+		return INDIGO_OK;
+	} else if (indigo_property_match(MOUNT_HORIZON_PROPERTY, property)) {
+		// -------------------------------------------------------------------------------- MOUNT_HORIZON
+		char profile[INDIGO_VALUE_SIZE];
+		strncpy(profile, MOUNT_HORIZON_PROFILE_ITEM->text.value, INDIGO_VALUE_SIZE);
+		indigo_property_copy_values(MOUNT_HORIZON_PROPERTY, property, false);
+		if (indigo_mount_build_horizon_table(device)) {
+			MOUNT_CONTEXT->limits_violated = MOUNT_CONTEXT->limits_tracking_stopped = false;
+			MOUNT_HORIZON_PROPERTY->state = INDIGO_OK_STATE;
+			if (IS_CONNECTED) {
+				indigo_update_property(device, MOUNT_HORIZON_PROPERTY, NULL);
+				indigo_update_coordinates(device, NULL);
+			}
+		} else {
+			strncpy(MOUNT_HORIZON_PROFILE_ITEM->text.value, profile, INDIGO_VALUE_SIZE);
+			MOUNT_HORIZON_PROPERTY->state = INDIGO_ALERT_STATE;
+			if (IS_CONNECTED)
+				indigo_update_property(device, MOUNT_HORIZON_PROPERTY, "Invalid horizon profile, expected 'azimuth altitude; ...'");
+		}
+		return INDIGO_OK;
+	} else if (indigo_property_match(MOUNT_CUSTOM_TRACKING_RATE_PROPERTY, property)) {
+		// -------------------------------------------------------------------------------- MOUNT_CUSTOM_TRACKING_RATE
+		indigo_property_copy_values(MOUNT_CUSTOM_TRACKING_RATE_PROPERTY, property, false);
+		MOUNT_CUSTOM_TRACKING_RATE_PROPERTY->state = INDIGO_OK_STATE;
+		if (IS_CONNECTED)
+			indigo_update_property(device, MOUNT_CUSTOM_TRACKING_RATE_PROPERTY, NULL);
+		return INDIGO_OK;
+	} else if (indigo_property_match(MOUNT_TRACKING_EPHEMERIS_PROPERTY, property)) {
+		// -------------------------------------------------------------------------------- MOUNT_TRACKING_EPHEMERIS
+		if (MOUNT_CONTEXT->ephemeris_tracking == NULL) {
+			MOUNT_CONTEXT->ephemeris_tracking = calloc(1, sizeof(indigo_ephemeris_tracking));
+			pthread_mutex_init(&EPHEMERIS_TRACKING->mutex, NULL);
+			indigo_novas_context_init(&EPHEMERIS_TRACKING->context, 0);
+		}
+		indigo_ephemeris_tracking *tracking = EPHEMERIS_TRACKING;
+		indigo_ephemeris_tracking_stop(device, false);
+		pthread_mutex_lock(&tracking->mutex);
+		indigo_ephemeris_tracking_clear(tracking);
+		indigo_property_copy_values(MOUNT_TRACKING_EPHEMERIS_PROPERTY, property, false);
+		char *message = NULL;
+		if ((*MOUNT_TRACKING_EPHEMERIS_ELEMENTS_ITEM->text.value != 0) + (*MOUNT_TRACKING_EPHEMERIS_TABLE_ITEM->text.value != 0) + (*MOUNT_TRACKING_EPHEMERIS_TLE_ITEM->text.value != 0) > 1)
+			message = "Only one of orbital elements, ephemeris table or satellite TLE can be used";
+		else if (*MOUNT_TRACKING_EPHEMERIS_ELEMENTS_ITEM->text.value && !(tracking->has_orbit = indigo_ephemeris_parse_orbit(MOUNT_TRACKING_EPHEMERIS_ELEMENTS_ITEM->text.value, &tracking->orbit)))
+			message = "Invalid orbital elements, expected 'q e i node peri tp' or 'a e i node peri M epoch'";
+		else if (*MOUNT_TRACKING_EPHEMERIS_TABLE_ITEM->text.value && !indigo_ephemeris_table_load(tracking, MOUNT_TRACKING_EPHEMERIS_TABLE_ITEM->text.value))
+			message = "Can't load ephemeris table, expected lines 'UTC RA Dec'";
+		else if (*MOUNT_TRACKING_EPHEMERIS_TLE_ITEM->text.value && !(tracking->has_tle = indigo_tle_parse(MOUNT_TRACKING_EPHEMERIS_TLE_ITEM->text.value, &tracking->tle)))
+			message = "Invalid satellite TLE, expected two or three lines";
+		if (message) {
+			*MOUNT_TRACKING_EPHEMERIS_ELEMENTS_ITEM->text.value = *MOUNT_TRACKING_EPHEMERIS_TABLE_ITEM->text.value = *MOUNT_TRACKING_EPHEMERIS_TLE_ITEM->text.value = 0;
+			indigo_ephemeris_tracking_clear(tracking);
+			MOUNT_TRACKING_EPHEMERIS_PROPERTY->state = INDIGO_ALERT_STATE;
+		} else {
+			MOUNT_TRACKING_EPHEMERIS_PROPERTY->state = INDIGO_OK_STATE;
+		}
+		tracking->slew = true;
+		pthread_mutex_unlock(&tracking->mutex);
+		if (IS_CONNECTED) {
+			indigo_update_property(device, MOUNT_TRACKING_EPHEMERIS_PROPERTY, message);
+			indigo_update_property(device, MOUNT_EPHEMERIS_TARGET_PROPERTY, NULL);
+			indigo_ephemeris_tracking_start(device);
+		}
+		return INDIGO_OK;
 	} else if (indigo_property_match(MOUNT_HOME_POSITION_PROPERTY, property)) {
 		// -------------------------------------------------------------------------------- MOUNT_HOME_POSITION
 		indigo_property_copy_values(MOUNT_HOME_POSITION_PROPERTY, property, false);
@@ -623,6 +1720,8 @@ indigo_result indigo_mount_change_property(indigo_device *device, indigo_client
 			indigo_save_property(device, NULL, MOUNT_PARK_POSITION_PROPERTY);
 			indigo_save_property(device, NULL, MOUNT_EPOCH_PROPERTY);
 			indigo_save_property(device, NULL, MOUNT_PEC_PROPERTY);
+			indigo_save_property(device, NULL, MOUNT_LIMITS_PROPERTY);
+			indigo_save_property(device, NULL, MOUNT_HORIZON_PROPERTY);
 			indigo_mount_save_alignment_points(device);
 		} else if (indigo_switch_match(CONFIG_LOAD_ITEM, property)) {
 			indigo_mount_load_alignment_points(device);
@@ -633,13 +1732,13 @@ indigo_result indigo_mount_change_property(indigo_device *device, indigo_client
 			if (MOUNT_ALIGNMENT_MODE_CONTROLLER_ITEM->sw.value) {
 				MOUNT_EQUATORIAL_COORDINATES_PROPERTY->state = INDIGO_ALERT_STATE;
 				indigo_update_coordinates(device, "SYNC in CONTROLLER mode passed to indigo_mount_change_property");
-			} else if (MOUNT_CONTEXT->alignment_point_count >= MOUNT_MAX_ALIGNMENT_POINTS) {
-				MOUNT_EQUATORIAL_COORDINATES_PROPERTY->state = INDIGO_ALERT_STATE;
-				indigo_update_coordinates(device, "Too many alignment points");
 			} else {
 				indigo_property_copy_values(MOUNT_EQUATORIAL_COORDINATES_PROPERTY, property, false);
-				int index = MOUNT_CONTEXT->alignment_point_count++;
-				indigo_alignment_point *point = MOUNT_CONTEXT->alignment_points + index;
+				indigo_delete_property(device, MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY, NULL);
+				indigo_delete_property(device, MOUNT_ALIGNMENT_DELETE_POINTS_PROPERTY, NULL);
+				indigo_mount_reserve_alignment_points(device, MOUNT_CONTEXT->alignment_point_count + 1);
+				int index = MOUNT_CONTEXT->alignment_point_count;
+				indigo_alignment_point new_point = { 0 }, *point = &new_point;
 				time_t utc = indigo_get_mount_utc(device);
 				point->lst = indigo_lst(&utc, MOUNT_GEOGRAPHIC_COORDINATES_LONGITUDE_ITEM->number.value);
 				point->ra = MOUNT_EQUATORIAL_COORDINATES_RA_ITEM->number.value;
@@ -663,6 +1762,7 @@ indigo_result indigo_mount_change_property(indigo_device *device, indigo_client
 				indigo_init_switch_item(MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY->items + index, name, label, true);
 				point->used = true;
 
+				pthread_mutex_lock(&alignment_index_mutex);
 				//  Deselect other points if using single point mode
 				if (MOUNT_ALIGNMENT_MODE_SINGLE_POINT_ITEM->sw.value) {
 					for (int i = 0; i < MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY->count; i++) {
@@ -670,16 +1770,19 @@ indigo_result indigo_mount_change_property(indigo_device *device, indigo_client
 						MOUNT_CONTEXT->alignment_points[i].used = false;
 					}
 				}
+				MOUNT_CONTEXT->alignment_points[index] = new_point;
+				MOUNT_CONTEXT->alignment_point_count++;
+				pthread_mutex_unlock(&alignment_index_mutex);
 
 				indigo_mount_save_alignment_points(device);
+				indigo_mount_index_alignment_points(device);
+				indigo_mount_fit_pointing_model(device);
 				MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY->count = MOUNT_CONTEXT->alignment_point_count;
 				MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY->state = INDIGO_OK_STATE;
-				indigo_delete_property(device, MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY, NULL);
 				indigo_define_property(device, MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY, NULL);
 				indigo_init_switch_item(MOUNT_ALIGNMENT_DELETE_POINTS_PROPERTY->items + index, name, label, false);
 				MOUNT_ALIGNMENT_DELETE_POINTS_PROPERTY->count = MOUNT_CONTEXT->alignment_point_count;
 				MOUNT_ALIGNMENT_DELETE_POINTS_PROPERTY->state = INDIGO_OK_STATE;
-				indigo_delete_property(device, MOUNT_ALIGNMENT_DELETE_POINTS_PROPERTY, NULL);
 				indigo_define_property(device, MOUNT_ALIGNMENT_DELETE_POINTS_PROPERTY, NULL);
 				MOUNT_EQUATORIAL_COORDINATES_PROPERTY->state = INDIGO_OK_STATE;
 				indigo_update_coordinates(device, NULL);
@@ -693,7 +1796,9 @@ indigo_result indigo_mount_change_property(indigo_device *device, indigo_client
 			indigo_delete_property(device, MOUNT_RAW_COORDINATES_PROPERTY, NULL);
 			indigo_delete_property(device, MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY, NULL);
 			indigo_delete_property(device, MOUNT_ALIGNMENT_DELETE_POINTS_PROPERTY, NULL);
+			indigo_delete_property(device, MOUNT_ALIGNMENT_MODEL_PROPERTY, NULL);
 		}
+		MOUNT_ALIGNMENT_MODEL_PROPERTY->hidden = !MOUNT_ALIGNMENT_MODE_MULTI_POINT_ITEM->sw.value;
 		if (MOUNT_ALIGNMENT_MODE_SINGLE_POINT_ITEM->sw.value) {
 			MOUNT_RAW_COORDINATES_PROPERTY->hidden = false;
 			MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY->hidden = false;
@@ -708,20 +1813,29 @@ indigo_result indigo_mount_change_property(indigo_device *device, indigo_client
 			MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY->rule = INDIGO_ANY_OF_MANY_RULE;
 			MOUNT_ALIGNMENT_DELETE_POINTS_PROPERTY->hidden = false;
 			if (strcmp(client->name, CONFIG_READER)) {
+				pthread_mutex_lock(&alignment_index_mutex);
 				for (int i = 0; i < MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY->count; i++) {
 					MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY->items[i].sw.value = true;
+					MOUNT_CONTEXT->alignment_points[i].used = true;
 				}
+				pthread_mutex_unlock(&alignment_index_mutex);
 			}
+			indigo_mount_index_alignment_points(device);
 		} else if (MOUNT_ALIGNMENT_MODE_MULTI_POINT_ITEM->sw.value) {
 			MOUNT_RAW_COORDINATES_PROPERTY->hidden = false;
 			MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY->hidden = false;
 			MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY->rule = INDIGO_ANY_OF_MANY_RULE;
 			MOUNT_ALIGNMENT_DELETE_POINTS_PROPERTY->hidden = false;
 			if (strcmp(client->name, CONFIG_READER)) {
+				pthread_mutex_lock(&alignment_index_mutex);
 				for (int i = 0; i < MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY->count; i++) {
 					MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY->items[i].sw.value = true;
+					MOUNT_CONTEXT->alignment_points[i].used = true;
 				}
+				pthread_mutex_unlock(&alignment_index_mutex);
 			}
+			indigo_mount_index_alignment_points(device);
+			indigo_mount_fit_pointing_model(device);
 		} else {
 			MOUNT_RAW_COORDINATES_PROPERTY->hidden = true;
 			MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY->hidden = true;
@@ -732,6 +1846,7 @@ indigo_result indigo_mount_change_property(indigo_device *device, indigo_client
 			indigo_define_property(device, MOUNT_RAW_COORDINATES_PROPERTY, NULL);
 			indigo_define_property(device, MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY, NULL);
 			indigo_define_property(device, MOUNT_ALIGNMENT_DELETE_POINTS_PROPERTY, NULL);
+			indigo_define_property(device, MOUNT_ALIGNMENT_MODEL_PROPERTY, NULL);
 			indigo_raw_to_translated(device, MOUNT_RAW_COORDINATES_RA_ITEM->number.value, MOUNT_RAW_COORDINATES_DEC_ITEM->number.value, &MOUNT_EQUATORIAL_COORDINATES_RA_ITEM->number.value, &MOUNT_EQUATORIAL_COORDINATES_DEC_ITEM->number.value);
 			indigo_raw_to_translated(device, MOUNT_RAW_COORDINATES_RA_ITEM->number.target, MOUNT_RAW_COORDINATES_DEC_ITEM->number.target, &MOUNT_EQUATORIAL_COORDINATES_RA_ITEM->number.target, &MOUNT_EQUATORIAL_COORDINATES_DEC_ITEM->number.target);
 			MOUNT_EQUATORIAL_COORDINATES_PROPERTY->state = INDIGO_OK_STATE;
@@ -742,6 +1857,7 @@ indigo_result indigo_mount_change_property(indigo_device *device, indigo_client
 	} else if (indigo_property_match(MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY, property)) {
 		// -------------------------------------------------------------------------------- MOUNT_ALIGNMENT_SELECT_POINTS
 		indigo_property_copy_values(MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY, property, false);
+		pthread_mutex_lock(&alignment_index_mutex);
 		for (int i = 0; i < MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY->count; i++) {
 			int index = atoi(MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY->items[i].name);
 			if (index < MOUNT_CONTEXT->alignment_point_count) {
@@ -749,7 +1865,10 @@ indigo_result indigo_mount_change_property(indigo_device *device, indigo_client
 				MOUNT_CONTEXT->alignment_points[index].used = used;
 			}
 		}
+		pthread_mutex_unlock(&alignment_index_mutex);
 		indigo_mount_save_alignment_points(device);
+		indigo_mount_index_alignment_points(device);
+		indigo_mount_fit_pointing_model(device);
 		indigo_raw_to_translated(device, MOUNT_RAW_COORDINATES_RA_ITEM->number.value, MOUNT_RAW_COORDINATES_DEC_ITEM->number.value, &MOUNT_EQUATORIAL_COORDINATES_RA_ITEM->number.value, &MOUNT_EQUATORIAL_COORDINATES_DEC_ITEM->number.value);
 		indigo_raw_to_translated(device, MOUNT_RAW_COORDINATES_RA_ITEM->number.target, MOUNT_RAW_COORDINATES_DEC_ITEM->number.target, &MOUNT_EQUATORIAL_COORDINATES_RA_ITEM->number.target, &MOUNT_EQUATORIAL_COORDINATES_DEC_ITEM->number.target);
 		MOUNT_EQUATORIAL_COORDINATES_PROPERTY->state = INDIGO_OK_STATE;
@@ -759,6 +1878,7 @@ indigo_result indigo_mount_change_property(indigo_device *device, indigo_client
 		return INDIGO_OK;
 	} else if (indigo_property_match(MOUNT_ALIGNMENT_DELETE_POINTS_PROPERTY, property)) {
 		// -------------------------------------------------------------------------------- MOUNT_ALIGNMENT_DELETE_POINTS
+		pthread_mutex_lock(&alignment_index_mutex);
 		for (int i = 0; i < property->count; i++) {
 			int index = atoi(property->items[i].name);
 			if (index < MOUNT_CONTEXT->alignment_point_count) {
@@ -777,6 +1897,7 @@ indigo_result indigo_mount_change_property(indigo_device *device, indigo_client
 				}
 			}
 		}
+		pthread_mutex_unlock(&alignment_index_mutex);
 		indigo_mount_update_alignment_points(device);
 		return INDIGO_OK;
 	} else if (indigo_property_match(MOUNT_EPOCH_PROPERTY, property)) {
@@ -848,180 +1969,78 @@ indigo_result indigo_mount_detach(indigo_device *device) {
 	indigo_release_property(MOUNT_RAW_COORDINATES_PROPERTY);
 	indigo_release_property(MOUNT_ALIGNMENT_SELECT_POINTS_PROPERTY);
 	indigo_release_property(MOUNT_ALIGNMENT_DELETE_POINTS_PROPERTY);
+	indigo_release_property(MOUNT_ALIGNMENT_MODEL_PROPERTY);
 	indigo_release_property(MOUNT_SNOOP_DEVICES_PROPERTY);
 	indigo_release_property(MOUNT_PEC_PROPERTY);
 	indigo_release_property(MOUNT_PEC_TRAINING_PROPERTY);
-	return indigo_device_detach(device);
-}
-
-static void indigo_eq_to_encoder(indigo_device* device, double ha, double dec, int side_of_pier, double* enc_ha, double* enc_dec) {
-	//  Get hemisphere
-	bool south = MOUNT_GEOGRAPHIC_COORDINATES_LATITUDE_ITEM->number.value < 0;
-
-	//  Convert DEC to Degrees of encoder rotation relative to 0 position
-	//  [-90,90]
-	//
-	//  NORTHERN HEMISPHERE
-	//
-	//  DEC 90              Degrees = 90 W or 90 E
-	//  DEC 75              Degrees = 105 W or 75 E
-	//  DEC 45              Degrees = 135 W or 45 E
-	//  DEC 20              Degrees = 160 W or 20 E
-	//  DEC 0               Degrees = 180 W or 0 E
-	//  DEC -20             Degrees = 200 W or 340 E
-	//  DEC -45             Degrees = 225 W or 315 E
-	//  DEC -75             Degrees = 255 W or 285 E
-	//  DEC -90             Degrees = 270
-	//
-	//
-	//  SOUTHERN HEMISPHERE
-	//
-	//  DEC -90             Degrees = 90
-	//  DEC -75             Degrees = 105 E or 75 W
-	//  DEC -45             Degrees = 135 E or 45 W
-	//  DEC -20             Degrees = 160 E or 20 W
-	//  DEC 0               Degrees = 180 E or 0 W
-	//  DEC  20             Degrees = 200 E or 340 W
-	//  DEC  45             Degrees = 225 E or 315 W
-	//  DEC  75             Degrees = 255 E or 285 W
-	//  DEC  90             Degrees = 270
-
-	//  HA represents hours since the transit of the object
-	//  < 0 means object has yet to transit
-	//
-	//  convert to [-12,12]
-	if (ha > 12.0)
-		ha -= 24.0;
-	if (ha < -12.0)
-		ha += 24.0;
-	assert(ha >= -12.0 && ha <= 12.0);
-
-	//  Generate the DEC positions (east or west of meridian)
-	if (side_of_pier == MOUNT_SIDE_WEST) {
-		*enc_dec = 180.0 - dec;   //  NORTH variant by default
-		if (south) {
-			if (dec < 0)
-				*enc_dec = -dec;
-			else
-				*enc_dec = 360.0 - dec;
-		}
-
-		if (ha >= 0)
-			*enc_ha = ha;
-		else
-			*enc_ha = ha + 24.0;
-		if (south)
-			*enc_ha = 12.0 - ha;
+	indigo_release_property(MOUNT_LIMITS_PROPERTY);
+	indigo_release_property(MOUNT_HORIZON_PROPERTY);
+	if (MOUNT_CONTEXT->ephemeris_tracking) {
+		indigo_ephemeris_tracking_stop(device, true);
+		indigo_ephemeris_tracking_clear(EPHEMERIS_TRACKING);
+		pthread_mutex_destroy(&EPHEMERIS_TRACKING->mutex);
+		free(MOUNT_CONTEXT->ephemeris_tracking);
+		MOUNT_CONTEXT->ephemeris_tracking = NULL;
 	}
-	else {
-		*enc_dec = 180.0 + dec;   //  SOUTH variant by default
-		if (!south) {
-			if (dec < 0)
-				*enc_dec = 360.0 + dec;
-			else
-				*enc_dec = dec;
-		}
-
-		*enc_ha = ha + 12.0;
-		if (south) {
-			if (ha >= 0)
-				*enc_ha = 24.0 - ha;
-			else
-				*enc_ha = -ha;
-		}
-	}
-
-	//  Rebase the angle to optimise the DEC slew relative to HOME
-	if (*enc_dec > 270.0)
-		*enc_dec -= 360.0;
-
-	//  Remove units
-	*enc_ha /= 24.0;
-	*enc_dec /= 360.0;
+	indigo_release_property(MOUNT_CUSTOM_TRACKING_RATE_PROPERTY);
+	indigo_release_property(MOUNT_TRACKING_EPHEMERIS_PROPERTY);
+	indigo_release_property(MOUNT_EPHEMERIS_TARGET_PROPERTY);
+	indigo_mount_release_alignment_index(MOUNT_CONTEXT->alignment_index);
+	MOUNT_CONTEXT->alignment_index = NULL;
+	free(MOUNT_CONTEXT->alignment_points);
+	MOUNT_CONTEXT->alignment_points = NULL;
+	if (MOUNT_CONTEXT->driver_change_property)
+		device->change_property = MOUNT_CONTEXT->driver_change_property;
+	return indigo_device_detach(device);
 }
 
-static indigo_alignment_point* indigo_find_single_alignment_point(indigo_device* device) {
+static indigo_alignment_point* indigo_find_single_alignment_point(indigo_device* device, indigo_alignment_point *copy) {
+	indigo_alignment_point *result = NULL;
+	pthread_mutex_lock(&alignment_index_mutex);
 	for (int i = 0; i < MOUNT_CONTEXT->alignment_point_count; i++) {
-		//  Return first used point
+		//  Copy first used point
 		indigo_alignment_point *point = MOUNT_CONTEXT->alignment_points + i;
-		if (point->used)
-			return point;
+		if (point->used) {
+			*copy = *point;
+			result = copy;
+			break;
+		}
 	}
+	pthread_mutex_unlock(&alignment_index_mutex);
 
 	//  Return NULL if there are no used points
-	return NULL;
+	return result;
 }
 
-/*
-static indigo_alignment_point* indigo_nearest_alignment_point(indigo_device* device, double lst, double ra, double dec, int side_of_pier, int raw) {
-	//  Compute virtual encoder angles for RA/DEC
-	double enc_ra, enc_dec;
-	indigo_eq_to_encoder(device, indigo_range24(lst - ra), dec, side_of_pier, &enc_ra, &enc_dec);
-
-	//  Find nearest alignment point
-	double min_d = 10.0;   //  Larger than 2.0
-	indigo_alignment_point* nearest_point = 0;
-	for (int i = 0; i < MOUNT_CONTEXT->alignment_point_count; i++) {
-		//  Skip unused points
-		indigo_alignment_point *point = MOUNT_CONTEXT->alignment_points + i;
-		if (!point->used)
-			continue;
-
-		//  Compute virtual encoder angles for alignment point
-		double enc_p_ra, enc_p_dec;
-		if (raw)
-			indigo_eq_to_encoder(device, indigo_range24(point->lst - point->raw_ra), point->raw_dec, point->side_of_pier, &enc_p_ra, &enc_p_dec);
-		else
-			indigo_eq_to_encoder(device, indigo_range24(point->lst - point->ra), point->dec, point->side_of_pier, &enc_p_ra, &enc_p_dec);
-		//  FIXME!!! for closest point, GCD should be used Euclieadean distance is meaningless in spherical coordinates
-		//  Compute separation of encoder angles of RA/DEC and alignment point
-		//  Determine nearest point
-		double delta_ra = enc_p_ra - enc_ra;
-		double delta_dec = enc_p_dec - enc_dec;
-		double d = (delta_ra * delta_ra) + (delta_dec * delta_dec);
-		if (d < min_d) {
-			nearest_point = point;
-			min_d = d;
-		}
-	}
+static indigo_alignment_point* indigo_nearest_alignment_point(indigo_device* device, double lst, double ra, double dec, int raw, indigo_alignment_point *copy) {
+	//  Find nearest used alignment point in index
+	double v[3], min_d = 5.0;   //  Larger than 4.0 (squared chord of antipodal points)
+	int nearest = -1;
+	indigo_alignment_index_vector(indigo_range24(lst - ra), dec, v);
+	pthread_mutex_lock(&alignment_index_mutex);
+	indigo_alignment_index *index = MOUNT_CONTEXT->alignment_index;
+	if (index != NULL)
+		indigo_alignment_index_search(raw ? index->raw : index->observed, index->count, v, &nearest, &min_d);
+	//  Copy nearest point, storage can be reallocated as soon as mutex is released
+	if (nearest >= MOUNT_CONTEXT->alignment_point_count)
+		nearest = -1;
+	else if (nearest >= 0)
+		*copy = MOUNT_CONTEXT->alignment_points[nearest];
+	pthread_mutex_unlock(&alignment_index_mutex);
 
 	//  Return nearest point
-	return nearest_point;
+	return nearest < 0 ? NULL : copy;
 }
-*/
-
-static indigo_alignment_point* indigo_nearest_alignment_point(indigo_device* device, double lst, double ra, double dec, int raw) {
-	//  Find nearest alignment point
-	double sin_dec = sin(dec * DEG2RAD);
-	double cos_dec = cos(dec * DEG2RAD);
-	double min_d = 180.0;   //  Larger than 2.0
-	indigo_alignment_point* nearest_point = 0;
-	double ha = 15 * indigo_range24(lst - ra) * DEG2RAD;
-
-	for (int i = 0; i < MOUNT_CONTEXT->alignment_point_count; i++) {
-		//  Skip unused points
-		indigo_alignment_point *point = MOUNT_CONTEXT->alignment_points + i;
-		if (!point->used)
-			continue;
 
-		//  Compute virtual encoder angles for alignment point
-		double p_ha, p_dec;
-		if (raw) {
-			p_ha = 15 * indigo_range24(point->lst - point->raw_ra) * DEG2RAD;
-			p_dec = point->raw_dec * DEG2RAD;
-		} else {
-			p_ha = 15 * indigo_range24(point->lst - point->ra) * DEG2RAD;
-			p_dec = point->dec * DEG2RAD;
-		}
-		double d = acos(sin_dec * sin(p_dec) + cos_dec * cos(p_dec) * cos(ha - p_ha)) / DEG2RAD;
-		if (d < min_d) {
-			nearest_point = point;
-			min_d = d;
-		}
+static void indigo_normalize_coordinates(double *ra, double *dec) {
+	if (*dec > 90.0) {
+		*dec = 180.0 - *dec;
+		*ra += 12.0;
+	} else if (*dec < -90.0) {
+		*dec = -180.0 - *dec;
+		*ra += 12.0;
 	}
-
-	//  Return nearest point
-	return nearest_point;
+	*ra = indigo_range24(*ra);
 }
 
 //  Called to transform an observed position into a position for mount
@@ -1030,7 +2049,7 @@ indigo_result indigo_translated_to_raw(indigo_device *device, double ra, double
 		*raw_ra = ra;
 		*raw_dec = dec;
 		return INDIGO_OK;
-	} else if (MOUNT_ALIGNMENT_MODE_NEAREST_POINT_ITEM->sw.value || MOUNT_ALIGNMENT_MODE_SINGLE_POINT_ITEM->sw.value) {
+	} else if (MOUNT_ALIGNMENT_MODE_NEAREST_POINT_ITEM->sw.value || MOUNT_ALIGNMENT_MODE_SINGLE_POINT_ITEM->sw.value || MOUNT_ALIGNMENT_MODE_MULTI_POINT_ITEM->sw.value) {
 		time_t utc = indigo_get_mount_utc(device);
 		double lst = indigo_lst(&utc, MOUNT_GEOGRAPHIC_COORDINATES_LONGITUDE_ITEM->number.value);
 		double ha = indigo_range24(lst - ra);
@@ -1038,11 +2057,6 @@ indigo_result indigo_translated_to_raw(indigo_device *device, double ra, double
 			ha -= 24.0;
 		int side_of_pier = (ha >= 0.0) ? MOUNT_SIDE_WEST : MOUNT_SIDE_EAST;
 		return indigo_translated_to_raw_with_lst(device, lst, ra, dec, side_of_pier, raw_ra, raw_dec);
-	} else if (MOUNT_ALIGNMENT_MODE_MULTI_POINT_ITEM->sw.value) {
-
-		// TBD Rumen
-
-		return INDIGO_OK;
 	}
 	return INDIGO_FAILED;
 }
@@ -1053,12 +2067,11 @@ indigo_result indigo_translated_to_raw_with_lst(indigo_device *device, double ls
 		*raw_dec = dec;
 		return INDIGO_OK;
 	} else if (MOUNT_ALIGNMENT_MODE_NEAREST_POINT_ITEM->sw.value || MOUNT_ALIGNMENT_MODE_SINGLE_POINT_ITEM->sw.value) {
-		indigo_alignment_point* point;
+		indigo_alignment_point copy, *point;
 		if (MOUNT_ALIGNMENT_MODE_SINGLE_POINT_ITEM->sw.value)
-			point = indigo_find_single_alignment_point(device);
+			point = indigo_find_single_alignment_point(device, &copy);
 		else
-		  //point = indigo_nearest_alignment_point(device, lst, ra, dec, side_of_pier, 0);
-		  point = indigo_nearest_alignment_point(device, lst, ra, dec, 0);
+			point = indigo_nearest_alignment_point(device, lst, ra, dec, 0, &copy);
 		if (point) {
 			// Transform coordinates
 			// This should be a good approximation for small abs(point->raw_dec - point->dec) as this is true for a plain.
@@ -1098,9 +2111,17 @@ indigo_result indigo_translated_to_raw_with_lst(indigo_device *device, double ls
 		}
 		return INDIGO_OK;
 	} else if (MOUNT_ALIGNMENT_MODE_MULTI_POINT_ITEM->sw.value) {
-
-		// TBD Rumen
-
+		indigo_pointing_model model;
+		if (indigo_pointing_model_snapshot(device, &model)) {
+			double delta_ha, delta_dec;
+			indigo_pointing_model_correction(device, &model, 15 * (lst - ra), dec, side_of_pier, &delta_ha, &delta_dec);
+			*raw_ra = ra - delta_ha / 15;
+			*raw_dec = dec + delta_dec;
+			indigo_normalize_coordinates(raw_ra, raw_dec);
+		} else {
+			*raw_ra = ra;
+			*raw_dec = dec;
+		}
 		return INDIGO_OK;
 	}
 	return INDIGO_FAILED;
@@ -1112,7 +2133,7 @@ indigo_result indigo_raw_to_translated(indigo_device *device, double raw_ra, dou
 		*ra = raw_ra;
 		*dec = raw_dec;
 		return INDIGO_OK;
-	} else if (MOUNT_ALIGNMENT_MODE_NEAREST_POINT_ITEM->sw.value || MOUNT_ALIGNMENT_MODE_SINGLE_POINT_ITEM->sw.value) {
+	} else if (MOUNT_ALIGNMENT_MODE_NEAREST_POINT_ITEM->sw.value || MOUNT_ALIGNMENT_MODE_SINGLE_POINT_ITEM->sw.value || MOUNT_ALIGNMENT_MODE_MULTI_POINT_ITEM->sw.value) {
 		time_t utc = indigo_get_mount_utc(device);
 		double lst = indigo_lst(&utc, MOUNT_GEOGRAPHIC_COORDINATES_LONGITUDE_ITEM->number.value);
 		double ha = indigo_range24(lst - raw_ra);
@@ -1120,11 +2141,6 @@ indigo_result indigo_raw_to_translated(indigo_device *device, double raw_ra, dou
 			ha -= 24.0;
 		int side_of_pier = (ha >= 0.0) ? MOUNT_SIDE_WEST : MOUNT_SIDE_EAST;
 		return indigo_raw_to_translated_with_lst(device, lst, raw_ra, raw_dec, side_of_pier, ra, dec);
-	} else if (MOUNT_ALIGNMENT_MODE_MULTI_POINT_ITEM->sw.value) {
-
-		// TBD Rumen
-
-		return INDIGO_OK;
 	}
 	return INDIGO_FAILED;
 }
@@ -1136,12 +2152,11 @@ indigo_result indigo_raw_to_translated_with_lst(indigo_device *device, double ls
 		*dec = raw_dec;
 		return INDIGO_OK;
 	} else if (MOUNT_ALIGNMENT_MODE_NEAREST_POINT_ITEM->sw.value || MOUNT_ALIGNMENT_MODE_SINGLE_POINT_ITEM->sw.value) {
-		indigo_alignment_point* point;
+		indigo_alignment_point copy, *point;
 		if (MOUNT_ALIGNMENT_MODE_SINGLE_POINT_ITEM->sw.value)
-			point = indigo_find_single_alignment_point(device);
+			point = indigo_find_single_alignment_point(device, &copy);
 		else
-			//point = indigo_nearest_alignment_point(device, lst, raw_ra, raw_dec, side_of_pier, 1);
-			point = indigo_nearest_alignment_point(device, lst, raw_ra, raw_dec, 1);
+			point = indigo_nearest_alignment_point(device, lst, raw_ra, raw_dec, 1, &copy);
 		if (point) {
 			// Transform coordinates
 			// This should be a good approximation for small abs(point->raw_dec - point->dec) as this is true for a plain.
@@ -1180,9 +2195,19 @@ indigo_result indigo_raw_to_translated_with_lst(indigo_device *device, double ls
 		}
 		return INDIGO_OK;
 	} else if (MOUNT_ALIGNMENT_MODE_MULTI_POINT_ITEM->sw.value) {
-
-		// TBD Rumen
-
+		*ra = raw_ra;
+		*dec = raw_dec;
+		indigo_pointing_model model;
+		if (indigo_pointing_model_snapshot(device, &model)) {
+			//  Model is defined for observed position, so it is inverted by fixed point iteration
+			for (int i = 0; i < 3; i++) {
+				double delta_ha, delta_dec;
+				indigo_pointing_model_correction(device, &model, 15 * (lst - *ra), *dec, side_of_pier, &delta_ha, &delta_dec);
+				*ra = raw_ra + delta_ha / 15;
+				*dec = raw_dec - delta_dec;
+			}
+			indigo_normalize_coordinates(ra, dec);
+		}
 		return INDIGO_OK;
 	}
 	return INDIGO_FAILED;
@@ -1205,6 +2230,32 @@ void indigo_update_coordinates(indigo_device *device, const char *message) {
 			indigo_update_property(device, MOUNT_HORIZONTAL_COORDINATES_PROPERTY, NULL);
 	}
 	MOUNT_LST_TIME_ITEM->number.value = indigo_lst(&utc, MOUNT_GEOGRAPHIC_COORDINATES_LONGITUDE_ITEM->number.value);
+	if (!MOUNT_LIMITS_PROPERTY->hidden && !MOUNT_GEOGRAPHIC_COORDINATES_PROPERTY->hidden) {
+		double alt, az;
+		if (MOUNT_HORIZONTAL_COORDINATES_PROPERTY->hidden) {
+			indigo_eq2hor(&utc, MOUNT_GEOGRAPHIC_COORDINATES_LATITUDE_ITEM->number.value, MOUNT_GEOGRAPHIC_COORDINATES_LONGITUDE_ITEM->number.value, MOUNT_GEOGRAPHIC_COORDINATES_ELEVATION_ITEM->number.value, MOUNT_EQUATORIAL_COORDINATES_RA_ITEM->number.value, MOUNT_EQUATORIAL_COORDINATES_DEC_ITEM->number.value, &alt, &az);
+		} else {
+			alt = MOUNT_HORIZONTAL_COORDINATES_ALT_ITEM->number.value;
+			az = MOUNT_HORIZONTAL_COORDINATES_AZ_ITEM->number.value;
+		}
+		double ha = fmod(MOUNT_LST_TIME_ITEM->number.value - MOUNT_EQUATORIAL_COORDINATES_RA_ITEM->number.value + 36, 24) - 12;
+		if (MOUNT_CONTEXT->limits_violated) {
+			if (indigo_mount_limits_check(device, alt, az, ha, MOUNT_LIMITS_HYSTERESIS_ITEM->number.value)) {
+				MOUNT_CONTEXT->limits_violated = MOUNT_CONTEXT->limits_tracking_stopped = false;
+				MOUNT_LIMITS_PROPERTY->state = INDIGO_OK_STATE;
+				if (IS_CONNECTED)
+					indigo_update_property(device, MOUNT_LIMITS_PROPERTY, NULL);
+			}
+		} else if (!indigo_mount_limits_check(device, alt, az, ha, 0)) {
+			MOUNT_CONTEXT->limits_violated = true;
+			MOUNT_LIMITS_PROPERTY->state = INDIGO_ALERT_STATE;
+			if (IS_CONNECTED)
+				indigo_update_property(device, MOUNT_LIMITS_PROPERTY, "Mount is outside of limits");
+		}
+		//  tracking is stopped once per violation, position is reported more often than the handler runs
+		if (MOUNT_CONTEXT->limits_violated && !MOUNT_CONTEXT->limits_tracking_stopped && IS_CONNECTED && MOUNT_TRACKING_ON_ITEM->sw.value && MOUNT_EQUATORIAL_COORDINATES_PROPERTY->state != INDIGO_BUSY_STATE)
+			MOUNT_CONTEXT->limits_tracking_stopped = indigo_execute_handler(device, indigo_mount_limits_handler);
+	}
 	if (IS_CONNECTED) {
 		indigo_update_property(device, MOUNT_LST_TIME_PROPERTY, NULL);
 		indigo_update_property(device, MOUNT_EQUATORIAL_COORDINATES_PROPERTY, message);
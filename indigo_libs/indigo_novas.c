@@ -24,89 +24,315 @@
  */
 
 //#include <time.h>
+#include <math.h>
+#include <string.h>
+#include <pthread.h>
+
 #include <novas.h>
-#include <eph_manager.h>
 
 #include <indigo/indigo_bus.h>
 #include <indigo/indigo_novas.h>
+#include <indigo/indigo_ephemeris.h>
 
 #define UT2JD(t) ((t) / 86400.0 + 2440587.5 + DELTA_UTC_UT1)
 double DELTA_T = 34+32.184+0.477677;
 double DELTA_UTC_UT1 = -0.477677/86400.0;
 
-static void init() {
-	static int do_init = 1;
-	if (do_init) {
-		double jd_begin, jd_end;
-		short de_number;
-		ephem_open("JPLEPH.421", &jd_begin, &jd_end, &de_number);
-		do_init = 0;
-	}
+static void earth_state(indigo_novas_context *context) {
+	// without JPL ephemeris low precision Sun position is used
+	indigo_ephemeris_state(INDIGO_EPHEMERIS_EARTH, context->jd_tt, context->earth_position, context->earth_velocity);
+	indigo_ephemeris_state(INDIGO_EPHEMERIS_SUN, context->jd_tt, context->sun_position, NULL);
 }
 
-double indigo_lst(time_t *utc, double longitude) {
-	double ut1;
-	if (utc)
-		ut1 = UT2JD(*utc);
-	else
-		ut1 = UT2JD(time(NULL));
-
-	double gst;
-	int error = sidereal_time(ut1, 0.0, DELTA_T, 0, 0, 0, &gst);
+void indigo_novas_context_init(indigo_novas_context *context, double validity) {
+	memset(context, 0, sizeof(indigo_novas_context));
+	context->validity = validity > 0 ? validity : INDIGO_NOVAS_CONTEXT_VALIDITY;
+}
+
+bool indigo_novas_context_update(indigo_novas_context *context, time_t *utc) {
+	time_t now = utc ? *utc : time(NULL);
+	if (context->valid && fabs(difftime(now, context->utc)) <= context->validity)
+		return true;
+	// cached terms are replaced only when all of them are computed, so context never mixes terms for different times
+	double jd_ut1 = UT2JD(now);
+	double gmst, gast;
+	int error = sidereal_time(jd_ut1, 0.0, DELTA_T, 0, 0, 0, &gmst);
+	if (error == 0)
+		error = sidereal_time(jd_ut1, 0.0, DELTA_T, 1, 1, 1, &gast);
 	if (error != 0) {
+		// terms cached for other time must not be extrapolated that far, update is retried on next use
 		indigo_error("sidereal_time() -> %d", error);
-		return 0;
+		context->valid = false;
+		return false;
+	}
+	context->utc = now;
+	context->jd_ut1 = jd_ut1;
+	context->jd_tt = jd_ut1 + DELTA_T / 86400.0;
+	context->gmst = gmst;
+	context->equation_of_equinoxes = gast - gmst;
+	for (int i = 0; i < 3; i++) {
+		double basis[3] = { 0, 0, 0 }, pos1[3], pos2[3];
+		basis[i] = 1;
+		frame_tie(basis, -1, pos1);
+		precession(T0, pos1, context->jd_tt, pos2);
+		nutation(context->jd_tt, 0, 1, pos2, pos1);
+		for (int j = 0; j < 3; j++)
+			context->matrix[j][i] = pos1[j];
 	}
-	return fmod(gst + longitude/15.0 + 24.0, 24.0);
+	earth_state(context);
+	context->valid = true;
+	return true;
 }
 
-void indigo_eq2hor(time_t *utc, double latitude, double longitude, double elevation, double ra, double dec, double *alt, double *az) {
-	double ut1;
-	if (utc)
-		ut1 = UT2JD(*utc);
-	else
-		ut1 = UT2JD(time(NULL));
+static double sidereal_time_at(indigo_novas_context *context, time_t *utc) {
+	if (!indigo_novas_context_update(context, utc))
+		return NAN;
+	time_t now = utc ? *utc : time(NULL);
+	return context->gmst + difftime(now, context->utc) * INDIGO_SIDEREAL_RATE / 3600.0;
+}
 
-	on_surface position = { latitude, longitude, elevation, 0.0, 0.0 };
-	equ2hor(ut1, DELTA_T, 1, 0.0, 0.0, &position, ra, dec, 0, alt, az, &ra, &dec);
-	*alt = 90 - *alt;
+double indigo_novas_lst(indigo_novas_context *context, time_t *utc, double longitude) {
+	double lst = fmod(sidereal_time_at(context, utc) + longitude / 15.0, 24.0);
+	return lst < 0 ? lst + 24.0 : lst;
 }
 
-void indigo_app_star(double promora, double promodec, double parallax, double rv, double *ra, double *dec) {
-	double ut1_now = time(NULL) / 86400.0 + 2440587.5 + DELTA_UTC_UT1;
-	double tt_now = ut1_now + DELTA_T / 86400.0;
-	cat_entry star;
-	init();
-	make_cat_entry("HIP 1", "HP2", 1, *ra, *dec, promora, promodec, parallax, rv, &star);
-	int error = app_star(tt_now, &star, 1, ra, dec);
-	if (error != 0) {
-		indigo_error("app_star() -> %d", error);
+void indigo_novas_eq2hor(indigo_novas_context *context, time_t *utc, double latitude, double longitude, double elevation, int count, const double *ra, const double *dec, double *alt, double *az) {
+	double last = (sidereal_time_at(context, utc) + context->equation_of_equinoxes) * 15.0 + longitude;
+	double sin_lat = sin(latitude * DEG2RAD), cos_lat = cos(latitude * DEG2RAD);
+	for (int i = 0; i < count; i++) {
+		double ha = (last - ra[i] * 15.0) * DEG2RAD;
+		double d = dec[i] * DEG2RAD;
+		double sin_dec = sin(d), cos_dec = cos(d), cos_ha = cos(ha);
+		alt[i] = asin(sin_lat * sin_dec + cos_lat * cos_dec * cos_ha) * RAD2DEG;
+		double a = atan2(-cos_dec * sin(ha), sin_dec * cos_lat - cos_dec * sin_lat * cos_ha) * RAD2DEG;
+		az[i] = a < 0 ? a + 360.0 : a;
 	}
 }
 
-void indigo_topo_star(double latitude, double longitude, double elevation, double promora, double promodec, double parallax, double rv, double *ra, double *dec) {
-	double ut1_now = time(NULL) / 86400.0 + 2440587.5 + DELTA_UTC_UT1;
-	double tt_now = ut1_now + DELTA_T / 86400.0;
-	cat_entry star;
-	init();
-	make_cat_entry("HIP1", "HP2", 1, *ra, *dec, promora, promodec, parallax, rv, &star);
-	on_surface position = { latitude, longitude, elevation, 0.0, 0.0 };
-	int error = topo_star(tt_now, DELTA_T, &star, &position, 1, ra, dec);
-	if (error != 0) {
-		indigo_error("topo_star() -> %d", error);
+static void observer_state(indigo_novas_context *context, time_t *utc, double latitude, double longitude, double elevation, double *pos, double *vel) {
+	// geodetic (WGS84) to geocentric position and diurnal velocity in true equator of date, rotated back to ICRS
+	double last = (sidereal_time_at(context, utc) + context->equation_of_equinoxes) * 15.0 * DEG2RAD + longitude * DEG2RAD;
+	double f = 1.0 / 298.257223563, lat = latitude * DEG2RAD;
+	double c = 1.0 / sqrt(cos(lat) * cos(lat) + (1 - f) * (1 - f) * sin(lat) * sin(lat));
+	double s = (1 - f) * (1 - f) * c;
+	double xy = (ERAD * c + elevation) * cos(lat) / 1000.0 / AU_KM, z = (ERAD * s + elevation) * sin(lat) / 1000.0 / AU_KM;
+	double omega = ANGVEL * 86400.0;
+	double date_pos[3] = { xy * cos(last), xy * sin(last), z };
+	double date_vel[3] = { -omega * date_pos[1], omega * date_pos[0], 0 };
+	for (int i = 0; i < 3; i++) {
+		pos[i] = context->matrix[0][i] * date_pos[0] + context->matrix[1][i] * date_pos[1] + context->matrix[2][i] * date_pos[2];
+		vel[i] = context->matrix[0][i] * date_vel[0] + context->matrix[1][i] * date_vel[1] + context->matrix[2][i] * date_vel[2];
 	}
 }
 
-void indigo_topo_planet(double latitude, double longitude, double elevation, int id, double *ra, double *dec) {
-	cat_entry DUMMY_STAR;
-	object solarSystem;
-	double distance;
-	double ut1_now = time(NULL) / 86400.0 + 2440587.5 + DELTA_UTC_UT1;
-	on_surface position = { latitude, longitude, elevation, 0.0, 0.0 };
-	init();
-	make_object(0, id, "Dummy", &DUMMY_STAR, &solarSystem);
-	int error = topo_planet(ut1_now, &solarSystem, DELTA_T, &position, 1, ra, dec, &distance);
-	if (error != 0) {
-		indigo_error("topo_planet() -> %d", error);
+typedef struct {
+	double velocity[3];								// observer barycentric velocity (AU/day)
+	double sun[3];										// unit vector from Sun to observer
+	double deflection;								// gravitational deflection factor
+	double gamma_i;										// inverse Lorentz factor
+} observer_terms;
+
+static void compute_observer_terms(indigo_novas_context *context, const double *obs, const double *observer_vel, observer_terms *terms) {
+	double *e = terms->sun, *v = terms->velocity;
+	for (int j = 0; j < 3; j++) {
+		v[j] = context->earth_velocity[j] + observer_vel[j];
+		e[j] = obs[j] - context->sun_position[j];
 	}
+	double e_mag = sqrt(e[0] * e[0] + e[1] * e[1] + e[2] * e[2]);
+	for (int j = 0; j < 3; j++)
+		e[j] /= e_mag;
+	terms->deflection = 2.0 * GS / (C * C * e_mag * AU);
+	terms->gamma_i = sqrt(1.0 - (v[0] * v[0] + v[1] * v[1] + v[2] * v[2]) / (C_AUDAY * C_AUDAY));
+}
+
+static inline void apparent_direction(indigo_novas_context *context, const observer_terms *terms, double x, double y, double z, double *ra, double *dec) {
+	// light deflection by Sun, aberration and rotation to true equator and equinox of date of unit vector x, y, z
+	const double *e = terms->sun, *v = terms->velocity;
+	const double (*m)[3] = (const double (*)[3])context->matrix;
+	double v_dot = 1.0 / C_AUDAY, gamma_i = terms->gamma_i;
+	double e_dot_p = e[0] * x + e[1] * y + e[2] * z;
+	double fac = fabs(e_dot_p) > 0.99999999999 ? 0 : terms->deflection / (1.0 + e_dot_p);
+	x += fac * (e[0] - e_dot_p * x);
+	y += fac * (e[1] - e_dot_p * y);
+	z += fac * (e[2] - e_dot_p * z);
+	double p = (x * v[0] + y * v[1] + z * v[2]) * v_dot;
+	double q = (1.0 + p / (1.0 + gamma_i)) * v_dot;
+	x = (gamma_i * x + q * v[0]) / (1.0 + p);
+	y = (gamma_i * y + q * v[1]) / (1.0 + p);
+	z = (gamma_i * z + q * v[2]) / (1.0 + p);
+	double tx = m[0][0] * x + m[0][1] * y + m[0][2] * z;
+	double ty = m[1][0] * x + m[1][1] * y + m[1][2] * z;
+	double tz = m[2][0] * x + m[2][1] * y + m[2][2] * z;
+	double a = atan2(ty, tx) * RAD2DEG / 15.0;
+	*ra = a < 0 ? a + 24.0 : a;
+	*dec = atan2(tz, sqrt(tx * tx + ty * ty)) * RAD2DEG;
+}
+
+static void apparent_place(indigo_novas_context *context, const double *observer_pos, const double *observer_vel, int count, const double *promora, const double *promodec, const double *parallax, const double *rv, double *ra, double *dec) {
+	// same chain as NOVAS place() with reduced accuracy (gravitational deflection by Sun only), time dependent terms taken from context
+	double obs[3];
+	observer_terms terms;
+	for (int j = 0; j < 3; j++)
+		obs[j] = context->earth_position[j] + observer_pos[j];
+	compute_observer_terms(context, obs, observer_vel, &terms);
+	double dt = context->jd_tt - T0;
+	for (int i = 0; i < count; i++) {
+		double plx = parallax ? parallax[i] : 0;
+		plx = plx <= 0 ? 1.0e-6 : plx;
+		double r = ra[i] * 15.0 * DEG2RAD, d = dec[i] * DEG2RAD;
+		double cra = cos(r), sra = sin(r), cdc = cos(d), sdc = sin(d);
+		double dist = 1.0 / sin(plx * 1.0e-3 * ASEC2RAD);
+		double radial = rv ? rv[i] : 0;
+		double k = 1.0 / (1.0 - radial / C * 1000.0);
+		double pmr = (promora ? promora[i] : 0) / (plx * 365.25) * k * dt;
+		double pmd = (promodec ? promodec[i] : 0) / (plx * 365.25) * k * dt;
+		double rvl = radial * 86400.0 / AU_KM * k * dt;
+		double x = dist * cdc * cra - pmr * sra - pmd * sdc * cra + rvl * cdc * cra - obs[0];
+		double y = dist * cdc * sra + pmr * cra - pmd * sdc * sra + rvl * cdc * sra - obs[1];
+		double z = dist * sdc + pmd * cdc + rvl * sdc - obs[2];
+		double mag = sqrt(x * x + y * y + z * z);
+		apparent_direction(context, &terms, x / mag, y / mag, z / mag, ra + i, dec + i);
+	}
+}
+
+void indigo_novas_app_star(indigo_novas_context *context, time_t *utc, int count, const double *promora, const double *promodec, const double *parallax, const double *rv, double *ra, double *dec) {
+	static const double zero[3] = { 0, 0, 0 };
+	if (!indigo_novas_context_update(context, utc)) {
+		for (int i = 0; i < count; i++)
+			ra[i] = dec[i] = NAN;
+		return;
+	}
+	apparent_place(context, zero, zero, count, promora, promodec, parallax, rv, ra, dec);
+}
+
+void indigo_novas_topo_star(indigo_novas_context *context, time_t *utc, double latitude, double longitude, double elevation, int count, const double *promora, const double *promodec, const double *parallax, const double *rv, double *ra, double *dec) {
+	double pos[3], vel[3];
+	observer_state(context, utc, latitude, longitude, elevation, pos, vel);
+	if (!context->valid) {
+		for (int i = 0; i < count; i++)
+			ra[i] = dec[i] = NAN;
+		return;
+	}
+	apparent_place(context, pos, vel, count, promora, promodec, parallax, rv, ra, dec);
+}
+
+typedef bool (*body_state)(const void *bodies, int index, double jd_tt, double *pos);
+
+static bool planet_state(const void *bodies, int index, double jd_tt, double *pos) {
+	return indigo_ephemeris_state(((const int *)bodies)[index], jd_tt, pos, NULL);
+}
+
+static bool orbit_state(const void *bodies, int index, double jd_tt, double *pos) {
+	return indigo_ephemeris_orbit_state((const indigo_ephemeris_orbit *)bodies + index, jd_tt, pos);
+}
+
+static bool topo_bodies(indigo_novas_context *context, time_t *utc, double latitude, double longitude, double elevation, int count, body_state state, const void *bodies, bool apparent, double *ra, double *dec, double *distance) {
+	double pos[3], vel[3], obs[3];
+	observer_terms terms;
+	observer_state(context, utc, latitude, longitude, elevation, pos, vel);
+	if (!context->valid)
+		return false;
+	// bodies are evaluated for exact time, Earth position is extrapolated within context validity window
+	time_t now = utc ? *utc : time(NULL);
+	double dt = difftime(now, context->utc) / 86400.0, jd_tt = context->jd_tt + dt;
+	for (int j = 0; j < 3; j++)
+		obs[j] = context->earth_position[j] + context->earth_velocity[j] * dt + pos[j];
+	compute_observer_terms(context, obs, vel, &terms);
+	bool result = true;
+	for (int i = 0; i < count; i++) {
+		double body[3], x = 0, y = 0, z = 0, r = 0, tau = 0;
+		bool valid = true;
+		// light time iteration
+		for (int k = 0; k < 3 && valid; k++) {
+			valid = state(bodies, i, jd_tt - tau, body);
+			x = body[0] - obs[0];
+			y = body[1] - obs[1];
+			z = body[2] - obs[2];
+			r = sqrt(x * x + y * y + z * z);
+			tau = r / C_AUDAY;
+		}
+		if (!valid || r == 0) {
+			result = false;
+			continue;
+		}
+		if (apparent) {
+			apparent_direction(context, &terms, x / r, y / r, z / r, ra + i, dec + i);
+		} else {
+			double a = atan2(y, x) * RAD2DEG / 15.0;
+			ra[i] = a < 0 ? a + 24.0 : a;
+			dec[i] = asin(z / r) * RAD2DEG;
+		}
+		if (distance)
+			distance[i] = r;
+	}
+	return result;
+}
+
+bool indigo_novas_topo_planet(indigo_novas_context *context, time_t *utc, double latitude, double longitude, double elevation, int count, const int *id, double *ra, double *dec, double *distance) {
+	return topo_bodies(context, utc, latitude, longitude, elevation, count, planet_state, id, true, ra, dec, distance);
+}
+
+bool indigo_novas_topo_orbit(indigo_novas_context *context, time_t *utc, double latitude, double longitude, double elevation, int count, const indigo_ephemeris_orbit *orbit, bool apparent, double *ra, double *dec, double *distance) {
+	return topo_bodies(context, utc, latitude, longitude, elevation, count, orbit_state, orbit, apparent, ra, dec, distance);
+}
+
+bool indigo_novas_topo_satellite(indigo_novas_context *context, double utc, double latitude, double longitude, double elevation, int count, const indigo_tle *tle, bool apparent, double *ra, double *dec, double *range) {
+	time_t now = (time_t)floor(utc);
+	if (!indigo_novas_context_update(context, &now))
+		return false;
+	for (int i = 0; i < count; i++)
+		ra[i] = dec[i] = 0;
+	bool result = indigo_sgp4_observe(count, tle, utc, latitude, longitude, elevation, ra, dec, NULL, NULL, range);
+	// TEME to true equator and equinox of date and back to ICRS for astrometric positions
+	double ee = context->equation_of_equinoxes * 15.0 * DEG2RAD, sin_ee = sin(ee), cos_ee = cos(ee);
+	for (int i = 0; i < count; i++) {
+		double a = ra[i] * 15.0 * DEG2RAD, d = dec[i] * DEG2RAD;
+		double x = cos(d) * cos(a), y = cos(d) * sin(a), z = sin(d);
+		double pos[3] = { cos_ee * x - sin_ee * y, sin_ee * x + cos_ee * y, z };
+		if (!apparent) {
+			double icrs[3];
+			for (int j = 0; j < 3; j++)
+				icrs[j] = context->matrix[0][j] * pos[0] + context->matrix[1][j] * pos[1] + context->matrix[2][j] * pos[2];
+			memcpy(pos, icrs, sizeof(pos));
+		}
+		a = atan2(pos[1], pos[0]) * RAD2DEG / 15.0;
+		ra[i] = a < 0 ? a + 24.0 : a;
+		dec[i] = asin(pos[2]) * RAD2DEG;
+	}
+	return result;
+}
+
+static indigo_novas_context shared_context = { INDIGO_NOVAS_CONTEXT_VALIDITY };
+static pthread_mutex_t shared_context_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+double indigo_lst(time_t *utc, double longitude) {
+	pthread_mutex_lock(&shared_context_mutex);
+	double lst = indigo_novas_lst(&shared_context, utc, longitude);
+	pthread_mutex_unlock(&shared_context_mutex);
+	return lst;
+}
+
+void indigo_eq2hor(time_t *utc, double latitude, double longitude, double elevation, double ra, double dec, double *alt, double *az) {
+	pthread_mutex_lock(&shared_context_mutex);
+	indigo_novas_eq2hor(&shared_context, utc, latitude, longitude, elevation, 1, &ra, &dec, alt, az);
+	pthread_mutex_unlock(&shared_context_mutex);
+}
+
+void indigo_app_star(double promora, double promodec, double parallax, double rv, double *ra, double *dec) {
+	pthread_mutex_lock(&shared_context_mutex);
+	indigo_novas_app_star(&shared_context, NULL, 1, &promora, &promodec, &parallax, &rv, ra, dec);
+	pthread_mutex_unlock(&shared_context_mutex);
+}
+
+void indigo_topo_star(double latitude, double longitude, double elevation, double promora, double promodec, double parallax, double rv, double *ra, double *dec) {
+	pthread_mutex_lock(&shared_context_mutex);
+	indigo_novas_topo_star(&shared_context, NULL, latitude, longitude, elevation, 1, &promora, &promodec, &parallax, &rv, ra, dec);
+	pthread_mutex_unlock(&shared_context_mutex);
+}
+
+void indigo_topo_planet(double latitude, double longitude, double elevation, int id, double *ra, double *dec) {
+	pthread_mutex_lock(&shared_context_mutex);
+	if (!indigo_novas_topo_planet(&shared_context, NULL, latitude, longitude, elevation, 1, &id, ra, dec, NULL))
+		indigo_error("indigo_novas_topo_planet(%d) failed", id);
+	pthread_mutex_unlock(&shared_context_mutex);
 }
@@ -0,0 +1,658 @@
+// Copyright (c) 2020 CloudMakers, s. r. o.
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// version history
+// 2.0 by Peter Polakovic <peter.polakovic@cloudmakers.eu>
+
+/** INDIGO offline plate solver
+ \file indigo_platesolver.c
+ */
+
+// Geometric hashing of star quads: the two most distant stars of a quad define
+// a local frame where they map to (0,0) and (1,1), the positions of the other
+// two stars in this frame form a 4D code invariant to shift, scale and rotation.
+// Quads are built from each catalogue star and its nearest neighbours on several
+// magnitude levels, so both narrow and wide fields find a level with matching
+// star density.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+
+#include <indigo/indigo_bus.h>
+#include <indigo/indigo_platesolver.h>
+#include <indigo/indigo_cat_data.h>
+#include <indigo/indigo_sky_index.h>
+
+#define MAX_LEVELS					8
+#define NEIGHBOURS					5
+#define QUAD_STARS					12
+#define VERIFY_STARS				50
+#define MIN_MATCHED					5
+#define CODE_TOLERANCE			0.012
+#define MIN_QUAD_SIZE				10.0
+
+#define DEG2RAD							(M_PI / 180.0)
+#define RAD2DEG							(180.0 / M_PI)
+
+typedef struct {
+	double v[3];
+	double ra, dec;
+	float mag;
+} catalogue_star;
+
+typedef struct {
+	float code[4];
+	int star[4];
+} catalogue_quad;
+
+typedef struct {
+	double mag_limit;
+	int star_count;
+	catalogue_quad *quads;
+	int quad_count;
+} index_level;
+
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static catalogue_star *catalogue = NULL;
+static int catalogue_size = 0, catalogue_capacity = 0;
+static indigo_sky_index sky_index;
+static index_level levels[MAX_LEVELS];
+static int level_count = 0;
+static bool index_valid = false;
+static bool bundled_catalogue = false;
+
+static const double level_mag_limits[] = { 4.5, 6.0, 7.5, 9.0, 10.5, 12.0, 13.5, 99 };
+
+// -------------------------------------------------------------------------------- Geometry
+
+static bool project(double ra0, double dec0, double ra, double dec, double *xi, double *eta) {
+	double cos_c = sin(dec0) * sin(dec) + cos(dec0) * cos(dec) * cos(ra - ra0);
+	if (cos_c <= 0)
+		return false;
+	*xi = cos(dec) * sin(ra - ra0) / cos_c;
+	*eta = (cos(dec0) * sin(dec) - sin(dec0) * cos(dec) * cos(ra - ra0)) / cos_c;
+	return true;
+}
+
+static void deproject(double ra0, double dec0, double xi, double eta, double *ra, double *dec) {
+	double rho = sqrt(xi * xi + eta * eta);
+	if (rho == 0) {
+		*ra = ra0;
+		*dec = dec0;
+		return;
+	}
+	double c = atan(rho);
+	*dec = asin(cos(c) * sin(dec0) + eta * sin(c) * cos(dec0) / rho);
+	*ra = fmod(ra0 + atan2(xi * sin(c), rho * cos(dec0) * cos(c) - eta * sin(dec0) * sin(c)) + 2 * M_PI, 2 * M_PI);
+}
+
+static bool quad_code(const double x[4], const double y[4], float code[4], int order[4]) {
+	int a = 0, b = 1;
+	double max = 0;
+	for (int i = 0; i < 3; i++) {
+		for (int j = i + 1; j < 4; j++) {
+			double d = (x[j] - x[i]) * (x[j] - x[i]) + (y[j] - y[i]) * (y[j] - y[i]);
+			if (d > max) {
+				max = d;
+				a = i;
+				b = j;
+			}
+		}
+	}
+	if (max == 0)
+		return false;
+	int c = -1, d = -1;
+	for (int i = 0; i < 4; i++) {
+		if (i != a && i != b) {
+			if (c < 0)
+				c = i;
+			else
+				d = i;
+		}
+	}
+	double dx = x[b] - x[a], dy = y[b] - y[a];
+	double cx[2], cy[2];
+	int other[2] = { c, d };
+	for (int i = 0; i < 2; i++) {
+		double rx = x[other[i]] - x[a], ry = y[other[i]] - y[a];
+		double u = (rx * dx + ry * dy) / max;
+		double v = (ry * dx - rx * dy) / max;
+		cx[i] = u - v;
+		cy[i] = u + v;
+	}
+	if (cx[0] + cx[1] > 1) {
+		int t = a;
+		a = b;
+		b = t;
+		for (int i = 0; i < 2; i++) {
+			cx[i] = 1 - cx[i];
+			cy[i] = 1 - cy[i];
+		}
+	}
+	if (cx[0] > cx[1]) {
+		double t = cx[0];
+		cx[0] = cx[1];
+		cx[1] = t;
+		t = cy[0];
+		cy[0] = cy[1];
+		cy[1] = t;
+		int s = other[0];
+		other[0] = other[1];
+		other[1] = s;
+	}
+	code[0] = cx[0];
+	code[1] = cy[0];
+	code[2] = cx[1];
+	code[3] = cy[1];
+	order[0] = a;
+	order[1] = b;
+	order[2] = other[0];
+	order[3] = other[1];
+	return true;
+}
+
+// -------------------------------------------------------------------------------- Catalogue & index
+
+static void release_index(void) {
+	for (int i = 0; i < level_count; i++)
+		free(levels[i].quads);
+	indigo_sky_index_release(&sky_index);
+	memset(levels, 0, sizeof(levels));
+	level_count = 0;
+	index_valid = false;
+}
+
+static void add_star(double ra, double dec, double mag) {
+	if (catalogue_size == catalogue_capacity) {
+		catalogue_capacity = catalogue_capacity ? 2 * catalogue_capacity : 65536;
+		catalogue = realloc(catalogue, catalogue_capacity * sizeof(catalogue_star));
+	}
+	catalogue_star *star = catalogue + catalogue_size++;
+	star->ra = fmod(ra * 15 * DEG2RAD + 2 * M_PI, 2 * M_PI);
+	star->dec = dec * DEG2RAD;
+	star->mag = mag;
+	indigo_sky_vector(star->ra, star->dec, star->v);
+}
+
+static void add_bundled_catalogue(void) {
+	if (bundled_catalogue)
+		return;
+	bundled_catalogue = true;
+	for (int i = 0; indigo_star_data[i].hip; i++)
+		add_star(indigo_star_data[i].ra, indigo_star_data[i].dec, indigo_star_data[i].mag);
+}
+
+void indigo_platesolver_add_star(double ra, double dec, double mag) {
+	pthread_mutex_lock(&mutex);
+	add_bundled_catalogue();
+	add_star(ra, dec, mag);
+	release_index();
+	pthread_mutex_unlock(&mutex);
+}
+
+int indigo_platesolver_load_catalogue(const char *file_name) {
+	FILE *file = fopen(file_name, "r");
+	if (file == NULL) {
+		INDIGO_ERROR(indigo_error("indigo_platesolver: failed to open %s", file_name));
+		return -1;
+	}
+	char line[256];
+	int count = 0;
+	pthread_mutex_lock(&mutex);
+	add_bundled_catalogue();
+	while (fgets(line, sizeof(line), file)) {
+		double ra, dec, mag;
+		if (*line == '#')
+			continue;
+		if (sscanf(line, "%lf %lf %lf", &ra, &dec, &mag) == 3 && ra >= 0 && ra < 24 && dec >= -90 && dec <= 90) {
+			add_star(ra, dec, mag);
+			count++;
+		}
+	}
+	release_index();
+	pthread_mutex_unlock(&mutex);
+	fclose(file);
+	INDIGO_LOG(indigo_log("indigo_platesolver: %d stars loaded from %s", count, file_name));
+	return count;
+}
+
+int indigo_platesolver_catalogue_size(void) {
+	pthread_mutex_lock(&mutex);
+	add_bundled_catalogue();
+	int result = catalogue_size;
+	pthread_mutex_unlock(&mutex);
+	return result;
+}
+
+static int compare_quads(const void *a, const void *b) {
+	float ca = ((const catalogue_quad *)a)->code[0], cb = ((const catalogue_quad *)b)->code[0];
+	return ca < cb ? -1 : ca > cb ? 1 : 0;
+}
+
+static void build_level(index_level *level, double mag_limit, int star_count) {
+	// mean star separation on the level defines neighbour search radius
+	double radius = fmin(3 * sqrt(4 * M_PI / star_count), 20 * DEG2RAD);
+	level->mag_limit = mag_limit;
+	level->star_count = star_count;
+	int quad_size = 0;
+	int *neighbours = NULL, neighbours_size = 0;
+	for (int s = 0; s < catalogue_size; s++) {
+		catalogue_star *star = catalogue + s;
+		if (star->mag > mag_limit)
+			continue;
+		int neighbour_count = indigo_sky_index_search(&sky_index, star->v, radius, mag_limit, &neighbours, &neighbours_size);
+		int nearest[NEIGHBOURS];
+		double distance[NEIGHBOURS];
+		int nearest_count = 0;
+		for (int j = 0; j < neighbour_count; j++) {
+			int n = neighbours[j];
+			if (n == s)
+				continue;
+			double d = -(star->v[0] * catalogue[n].v[0] + star->v[1] * catalogue[n].v[1] + star->v[2] * catalogue[n].v[2]);
+			int k = nearest_count;
+			if (k == NEIGHBOURS) {
+				if (d >= distance[NEIGHBOURS - 1])
+					continue;
+				k--;
+			} else {
+				nearest_count++;
+			}
+			while (k > 0 && distance[k - 1] > d) {
+				nearest[k] = nearest[k - 1];
+				distance[k] = distance[k - 1];
+				k--;
+			}
+			nearest[k] = n;
+			distance[k] = d;
+		}
+		for (int a = 0; a < nearest_count; a++) {
+			for (int b = a + 1; b < nearest_count; b++) {
+				for (int c = b + 1; c < nearest_count; c++) {
+					int members[4] = { s, nearest[a], nearest[b], nearest[c] };
+					double x[4], y[4], v[3] = { 0, 0, 0 };
+					for (int m = 0; m < 4; m++)
+						for (int k = 0; k < 3; k++)
+							v[k] += catalogue[members[m]].v[k];
+					double ra0 = atan2(v[1], v[0]), dec0 = atan2(v[2], sqrt(v[0] * v[0] + v[1] * v[1]));
+					for (int m = 0; m < 4; m++)
+						project(ra0, dec0, catalogue[members[m]].ra, catalogue[members[m]].dec, x + m, y + m);
+					catalogue_quad quad;
+					int order[4];
+					if (!quad_code(x, y, quad.code, order))
+						continue;
+					for (int m = 0; m < 4; m++)
+						quad.star[m] = members[order[m]];
+					if (level->quad_count == quad_size) {
+						quad_size = quad_size ? 2 * quad_size : 65536;
+						level->quads = realloc(level->quads, quad_size * sizeof(catalogue_quad));
+					}
+					level->quads[level->quad_count++] = quad;
+				}
+			}
+		}
+	}
+	free(neighbours);
+	qsort(level->quads, level->quad_count, sizeof(catalogue_quad), compare_quads);
+}
+
+static bool build_index(void) {
+	if (index_valid)
+		return true;
+	add_bundled_catalogue();
+	if (catalogue_size < 4)
+		return false;
+	INDIGO_DEBUG(clock_t start = clock());
+	// one sky index serves all levels, pixels hold ~16 stars of the whole catalogue on average
+	double (*vectors)[3] = malloc(catalogue_size * sizeof(double[3]));
+	float *mags = malloc(catalogue_size * sizeof(float));
+	for (int i = 0; i < catalogue_size; i++) {
+		memcpy(vectors[i], catalogue[i].v, sizeof(double[3]));
+		mags[i] = catalogue[i].mag;
+	}
+	int nside = 4;
+	while (nside < 256 && 12 * nside * nside * 16 < catalogue_size)
+		nside *= 2;
+	bool result = indigo_sky_index_build(&sky_index, nside, catalogue_size, (const double (*)[3])vectors, mags);
+	free(vectors);
+	free(mags);
+	if (!result)
+		return false;
+	int previous = 0;
+	for (int i = 0; i < MAX_LEVELS; i++) {
+		double mag_limit = level_mag_limits[i];
+		int count = 0;
+		for (int j = 0; j < catalogue_size; j++)
+			if (catalogue[j].mag <= mag_limit)
+				count++;
+		// skip levels not significantly denser than previous one, last level always contains all stars
+		if (count < 4 || count == previous || (i < MAX_LEVELS - 1 && count < 1.5 * previous))
+			continue;
+		build_level(levels + level_count, mag_limit, count);
+		INDIGO_DEBUG(indigo_debug("indigo_platesolver: level %d, mag <= %.1f, %d stars, %d quads", level_count, mag_limit, levels[level_count].star_count, levels[level_count].quad_count));
+		level_count++;
+		previous = count;
+	}
+	if (level_count == 0) {
+		indigo_sky_index_release(&sky_index);
+		return false;
+	}
+	INDIGO_DEBUG(indigo_debug("indigo_platesolver: index built in %gs", (clock() - start) / (double)CLOCKS_PER_SEC));
+	index_valid = true;
+	return true;
+}
+
+bool indigo_platesolver_build_index(void) {
+	pthread_mutex_lock(&mutex);
+	bool result = build_index();
+	pthread_mutex_unlock(&mutex);
+	return result;
+}
+
+// -------------------------------------------------------------------------------- Solver
+
+typedef struct {
+	double ra0, dec0;
+	double a_re, a_im, b_re, b_im;
+	bool flipped;
+} transformation;
+
+typedef struct {
+	int detection;
+	int star;
+} star_pair;
+
+static void transform_to_pixel(transformation *t, double xi, double eta, double *x, double *y) {
+	double wr = xi - t->b_re, wi = eta - t->b_im;
+	double norm = t->a_re * t->a_re + t->a_im * t->a_im;
+	*x = (wr * t->a_re + wi * t->a_im) / norm;
+	*y = (wi * t->a_re - wr * t->a_im) / norm;
+	if (t->flipped)
+		*y = -*y;
+}
+
+static void transform_to_plane(transformation *t, double x, double y, double *xi, double *eta) {
+	if (t->flipped)
+		y = -y;
+	*xi = t->a_re * x - t->a_im * y + t->b_re;
+	*eta = t->a_im * x + t->a_re * y + t->b_im;
+}
+
+static bool fit_similarity(const indigo_star_detection *stars, const int detections[4], const int members[4], bool flipped, transformation *t) {
+	double v[3] = { 0, 0, 0 };
+	for (int m = 0; m < 4; m++)
+		for (int k = 0; k < 3; k++)
+			v[k] += catalogue[members[m]].v[k];
+	t->ra0 = atan2(v[1], v[0]);
+	t->dec0 = atan2(v[2], sqrt(v[0] * v[0] + v[1] * v[1]));
+	t->flipped = flipped;
+	double zr[4], zi[4], wr[4], wi[4], zr0 = 0, zi0 = 0, wr0 = 0, wi0 = 0;
+	for (int m = 0; m < 4; m++) {
+		zr[m] = stars[detections[m]].x;
+		zi[m] = flipped ? -stars[detections[m]].y : stars[detections[m]].y;
+		project(t->ra0, t->dec0, catalogue[members[m]].ra, catalogue[members[m]].dec, wr + m, wi + m);
+		zr0 += zr[m] / 4;
+		zi0 += zi[m] / 4;
+		wr0 += wr[m] / 4;
+		wi0 += wi[m] / 4;
+	}
+	double num_re = 0, num_im = 0, den = 0;
+	for (int m = 0; m < 4; m++) {
+		double dzr = zr[m] - zr0, dzi = zi[m] - zi0, dwr = wr[m] - wr0, dwi = wi[m] - wi0;
+		num_re += dwr * dzr + dwi * dzi;
+		num_im += dwi * dzr - dwr * dzi;
+		den += dzr * dzr + dzi * dzi;
+	}
+	if (den == 0)
+		return false;
+	t->a_re = num_re / den;
+	t->a_im = num_im / den;
+	t->b_re = wr0 - (t->a_re * zr0 - t->a_im * zi0);
+	t->b_im = wi0 - (t->a_im * zr0 + t->a_re * zi0);
+	return true;
+}
+
+static int verify(const indigo_star_detection *stars, int count, int width, int height, transformation *t, star_pair *pairs, int *expected) {
+	double scale = sqrt(t->a_re * t->a_re + t->a_im * t->a_im);
+	double xi, eta, ra, dec;
+	transform_to_plane(t, width / 2.0, height / 2.0, &xi, &eta);
+	deproject(t->ra0, t->dec0, xi, eta, &ra, &dec);
+	double radius = atan(scale * sqrt(width * width + height * height) / 2);
+	double tolerance = fmax(3.0, 0.005 * sqrt(width * width + height * height));
+	double center[3];
+	indigo_sky_vector(ra, dec, center);
+	int *candidates = NULL, candidates_size = 0;
+	int candidate_count = indigo_sky_index_search(&sky_index, center, radius, INFINITY, &candidates, &candidates_size);
+	bool used[VERIFY_STARS] = { false };
+	int matched = 0;
+	*expected = 0;
+	for (int i = 0; i < candidate_count; i++) {
+		catalogue_star *star = catalogue + candidates[i];
+		double x, y;
+		if (!project(t->ra0, t->dec0, star->ra, star->dec, &xi, &eta))
+			continue;
+		transform_to_pixel(t, xi, eta, &x, &y);
+		if (x < 0 || y < 0 || x >= width || y >= height)
+			continue;
+		(*expected)++;
+		int best = -1;
+		double best_distance = tolerance * tolerance;
+		for (int j = 0; j < count && j < VERIFY_STARS; j++) {
+			double d = (stars[j].x - x) * (stars[j].x - x) + (stars[j].y - y) * (stars[j].y - y);
+			if (!used[j] && d < best_distance) {
+				best = j;
+				best_distance = d;
+			}
+		}
+		if (best >= 0) {
+			used[best] = true;
+			pairs[matched].detection = best;
+			pairs[matched].star = candidates[i];
+			matched++;
+		}
+	}
+	free(candidates);
+	return matched;
+}
+
+static bool solve3(double m[3][3], double r[3], double x[3]) {
+	double det = m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+	if (fabs(det) < 1e-30)
+		return false;
+	for (int i = 0; i < 3; i++) {
+		double t[3][3];
+		memcpy(t, m, sizeof(t));
+		for (int j = 0; j < 3; j++)
+			t[j][i] = r[j];
+		x[i] = (t[0][0] * (t[1][1] * t[2][2] - t[1][2] * t[2][1]) - t[0][1] * (t[1][0] * t[2][2] - t[1][2] * t[2][0]) + t[0][2] * (t[1][0] * t[2][1] - t[1][1] * t[2][0])) / det;
+	}
+	return true;
+}
+
+static bool refine(const indigo_star_detection *stars, int width, int height, transformation *t, star_pair *pairs, int matched, indigo_platesolver_wcs *wcs) {
+	double cx = width / 2.0, cy = height / 2.0;
+	double xi, eta, ra0, dec0;
+	transform_to_plane(t, cx, cy, &xi, &eta);
+	deproject(t->ra0, t->dec0, xi, eta, &ra0, &dec0);
+	double p[3], q[3];
+	for (int iteration = 0; iteration < 3; iteration++) {
+		// affine least squares fit of tangent plane coordinates around current centre
+		double m[3][3] = { { 0 } }, rx[3] = { 0 }, ry[3] = { 0 };
+		for (int i = 0; i < matched; i++) {
+			catalogue_star *star = catalogue + pairs[i].star;
+			if (!project(ra0, dec0, star->ra, star->dec, &xi, &eta))
+				continue;
+			double u[3] = { stars[pairs[i].detection].x - cx, stars[pairs[i].detection].y - cy, 1 };
+			for (int j = 0; j < 3; j++) {
+				for (int k = 0; k < 3; k++)
+					m[j][k] += u[j] * u[k];
+				rx[j] += u[j] * xi;
+				ry[j] += u[j] * eta;
+			}
+		}
+		if (!solve3(m, rx, p) || !solve3(m, ry, q))
+			return false;
+		deproject(ra0, dec0, p[2], q[2], &ra0, &dec0);
+	}
+	wcs->crpix1 = cx + 1;
+	wcs->crpix2 = cy + 1;
+	wcs->crval1 = ra0 * RAD2DEG;
+	wcs->crval2 = dec0 * RAD2DEG;
+	wcs->cd1_1 = p[0] * RAD2DEG;
+	wcs->cd1_2 = p[1] * RAD2DEG;
+	wcs->cd2_1 = q[0] * RAD2DEG;
+	wcs->cd2_2 = q[1] * RAD2DEG;
+	double det = wcs->cd1_1 * wcs->cd2_2 - wcs->cd1_2 * wcs->cd2_1;
+	wcs->ra = wcs->crval1 / 15;
+	wcs->dec = wcs->crval2;
+	wcs->scale = sqrt(fabs(det)) * 3600;
+	wcs->flipped = det < 0;
+	wcs->angle = atan2(-wcs->cd1_2, -wcs->cd2_2) * RAD2DEG;
+	wcs->matched = matched;
+	return true;
+}
+
+bool indigo_platesolver_solve(const indigo_star_detection *stars, int count, int width, int height, const indigo_platesolver_hint *hint, indigo_platesolver_wcs *wcs) {
+	if (stars == NULL || wcs == NULL || count < 4)
+		return false;
+	pthread_mutex_lock(&mutex);
+	if (!build_index()) {
+		pthread_mutex_unlock(&mutex);
+		INDIGO_ERROR(indigo_error("indigo_platesolver: no catalogue"));
+		return false;
+	}
+	INDIGO_DEBUG(clock_t start = clock());
+	double min_scale = 0, max_scale = INFINITY, hint_ra = 0, hint_dec = 0, hint_radius = 0;
+	if (hint) {
+		if (hint->min_scale > 0)
+			min_scale = hint->min_scale / 3600 * DEG2RAD;
+		if (hint->max_scale > 0)
+			max_scale = hint->max_scale / 3600 * DEG2RAD;
+		if (hint->radius > 0) {
+			hint_ra = hint->ra * 15 * DEG2RAD;
+			hint_dec = hint->dec * DEG2RAD;
+			hint_radius = hint->radius * DEG2RAD;
+		}
+	}
+	double hint_v[3];
+	indigo_sky_vector(hint_ra, hint_dec, hint_v);
+	int quad_stars = count < QUAD_STARS ? count : QUAD_STARS;
+	star_pair pairs[VERIFY_STARS], best_pairs[VERIFY_STARS];
+	int best_matched = 0;
+	transformation best;
+	bool found = false;
+	for (int a = 0; a < quad_stars && !found; a++) {
+		for (int b = a + 1; b < quad_stars && !found; b++) {
+			for (int c = b + 1; c < quad_stars && !found; c++) {
+				for (int d = c + 1; d < quad_stars && !found; d++) {
+					int members[4] = { a, b, c, d };
+					for (int flipped = 0; flipped < 2 && !found; flipped++) {
+						double x[4], y[4];
+						for (int m = 0; m < 4; m++) {
+							x[m] = stars[members[m]].x;
+							y[m] = flipped ? -stars[members[m]].y : stars[members[m]].y;
+						}
+						float code[4];
+						int order[4];
+						if (!quad_code(x, y, code, order))
+							continue;
+						double size = hypot(x[order[1]] - x[order[0]], y[order[1]] - y[order[0]]);
+						if (size < MIN_QUAD_SIZE)
+							continue;
+						int detections[4];
+						for (int m = 0; m < 4; m++)
+							detections[m] = members[order[m]];
+						for (int l = 0; l < level_count && !found; l++) {
+							index_level *level = levels + l;
+							int from = 0, to = level->quad_count;
+							while (from < to) {
+								int mid = (from + to) / 2;
+								if (level->quads[mid].code[0] < code[0] - CODE_TOLERANCE)
+									from = mid + 1;
+								else
+									to = mid;
+							}
+							for (int i = from; i < level->quad_count && level->quads[i].code[0] <= code[0] + CODE_TOLERANCE && !found; i++) {
+								catalogue_quad *quad = level->quads + i;
+								double distance = 0;
+								for (int k = 0; k < 4; k++)
+									distance += (quad->code[k] - code[k]) * (quad->code[k] - code[k]);
+								if (distance > CODE_TOLERANCE * CODE_TOLERANCE)
+									continue;
+								catalogue_star *sa = catalogue + quad->star[0], *sb = catalogue + quad->star[1];
+								double angular_size = acos(fmin(1, sa->v[0] * sb->v[0] + sa->v[1] * sb->v[1] + sa->v[2] * sb->v[2]));
+								double scale = angular_size / size;
+								if (scale < min_scale || scale > max_scale)
+									continue;
+								if (hint_radius > 0 && sa->v[0] * hint_v[0] + sa->v[1] * hint_v[1] + sa->v[2] * hint_v[2] < cos(fmin(M_PI, hint_radius + scale * hypot(width, height))))
+									continue;
+								transformation t;
+								if (!fit_similarity(stars, detections, quad->star, flipped, &t))
+									continue;
+								int expected;
+								int matched = verify(stars, count, width, height, &t, pairs, &expected);
+								int limit = count < VERIFY_STARS ? count : VERIFY_STARS;
+								if (matched >= MIN_MATCHED && 2 * matched >= (expected < limit ? expected : limit) && matched > best_matched) {
+									best = t;
+									best_matched = matched;
+									memcpy(best_pairs, pairs, matched * sizeof(star_pair));
+									// accept immediately if most of the expected stars are matched
+									found = 4 * matched >= 3 * (expected < limit ? expected : limit);
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+	bool result = best_matched > 0 && refine(stars, width, height, &best, best_pairs, best_matched, wcs);
+	pthread_mutex_unlock(&mutex);
+	if (result) {
+		INDIGO_DEBUG(indigo_debug("indigo_platesolver: solved in %gs, RA = %g, Dec = %g, scale = %g\"/px, angle = %g, %d stars matched", (clock() - start) / (double)CLOCKS_PER_SEC, wcs->ra, wcs->dec, wcs->scale, wcs->angle, wcs->matched));
+	} else {
+		INDIGO_DEBUG(indigo_debug("indigo_platesolver: failed in %gs", (clock() - start) / (double)CLOCKS_PER_SEC));
+	}
+	return result;
+}
+
+void indigo_platesolver_pixel_to_radec(const indigo_platesolver_wcs *wcs, double x, double y, double *ra, double *dec) {
+	double dx = x + 1 - wcs->crpix1, dy = y + 1 - wcs->crpix2;
+	double xi = (wcs->cd1_1 * dx + wcs->cd1_2 * dy) * DEG2RAD;
+	double eta = (wcs->cd2_1 * dx + wcs->cd2_2 * dy) * DEG2RAD;
+	deproject(wcs->crval1 * DEG2RAD, wcs->crval2 * DEG2RAD, xi, eta, ra, dec);
+	*ra *= RAD2DEG / 15;
+	*dec *= RAD2DEG;
+}
+
+bool indigo_platesolver_radec_to_pixel(const indigo_platesolver_wcs *wcs, double ra, double dec, double *x, double *y) {
+	double xi, eta;
+	if (!project(wcs->crval1 * DEG2RAD, wcs->crval2 * DEG2RAD, ra * 15 * DEG2RAD, dec * DEG2RAD, &xi, &eta))
+		return false;
+	xi *= RAD2DEG;
+	eta *= RAD2DEG;
+	double det = wcs->cd1_1 * wcs->cd2_2 - wcs->cd1_2 * wcs->cd2_1;
+	if (det == 0)
+		return false;
+	*x = (wcs->cd2_2 * xi - wcs->cd1_2 * eta) / det + wcs->crpix1 - 1;
+	*y = (-wcs->cd2_1 * xi + wcs->cd1_1 * eta) / det + wcs->crpix2 - 1;
+	return true;
+}
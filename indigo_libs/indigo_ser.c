@@ -23,33 +23,137 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <errno.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <pthread.h>
+#include <sys/stat.h>
 
 #include <indigo/indigo_bus.h>
 #include <indigo/indigo_io.h>
 #include <indigo/indigo_ser.h>
 
-static bool write_int(int handle, uint32_t n) {
-	unsigned char buffer[4];
+#define SER_HEADER_SIZE			178
+#define SER_COUNT_OFFSET		38
+#define SER_ALIGNMENT				4096
+#define TICKS_1970					621355968000000000LL
+
+typedef struct {
+	void *data;
+	size_t used;
+	int frames;
+} ser_chunk;
+
+typedef struct {
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	ser_chunk chunks[INDIGO_SER_CHUNKS];
+	size_t chunk_size;
+	int current;
+	int pending_head, pending_count;
+	int written;
+	bool running;
+	bool failed;
+} ser_writer;
+
+static void put_int(unsigned char *buffer, uint32_t n) {
 	buffer[0] = n;
 	buffer[1] = n >> 8;
 	buffer[2] = n >> 16;
 	buffer[3] = n >> 24;
-	return indigo_write(handle, (const char *)buffer, 4);
 }
 
-static bool write_long(int handle, uint64_t n) {
-	unsigned char buffer[8];
-	buffer[0] = n;
-	buffer[1] = n >> 8;
-	buffer[2] = n >> 16;
-	buffer[3] = n >> 24;
-	buffer[4] = n >> 32;
-	buffer[5] = n >> 40;
-	buffer[6] = n >> 48;
-	buffer[7] = n >> 56;
-	return indigo_write(handle, (const char *)buffer, 8);
+static void put_long(unsigned char *buffer, uint64_t n) {
+	put_int(buffer, (uint32_t)n);
+	put_int(buffer + 4, (uint32_t)(n >> 32));
+}
+
+static uint32_t get_int(unsigned char *buffer) {
+	return buffer[0] | buffer[1] << 8 | buffer[2] << 16 | (uint32_t)buffer[3] << 24;
+}
+
+static uint64_t ticks(struct timeval *utc) {
+	return TICKS_1970 + (uint64_t)utc->tv_sec * 10000000LL + (uint64_t)utc->tv_usec * 10LL;
+}
+
+static bool write_count(int handle, uint32_t count) {
+	unsigned char buffer[4];
+	put_int(buffer, count);
+	return pwrite(handle, buffer, 4, SER_COUNT_OFFSET) == 4;
+}
+
+static size_t frame_size(unsigned char *header) {
+	uint32_t color = get_int(header + 18), width = get_int(header + 26), height = get_int(header + 30), depth = get_int(header + 34);
+	return (size_t)width * height * (depth > 8 ? 2 : 1) * (color >= 100 ? 3 : 1);
+}
+
+static void *writer_thread(indigo_ser *ser) {
+	ser_writer *writer = ser->writer;
+	pthread_mutex_lock(&writer->mutex);
+	while (true) {
+		while (writer->running && writer->pending_count == 0)
+			pthread_cond_wait(&writer->cond, &writer->mutex);
+		if (writer->pending_count == 0)
+			break;
+		ser_chunk *chunk = writer->chunks + writer->pending_head;
+		pthread_mutex_unlock(&writer->mutex);
+		// frames are written in large chunks and frame count is updated after each one, so file is consistent up to last written chunk
+		bool result = !writer->failed && indigo_write(ser->handle, chunk->data, chunk->used) && write_count(ser->handle, writer->written + chunk->frames);
+		pthread_mutex_lock(&writer->mutex);
+		if (result)
+			writer->written += chunk->frames;
+		else
+			writer->failed = true;
+		chunk->used = 0;
+		chunk->frames = 0;
+		writer->pending_head = (writer->pending_head + 1) % INDIGO_SER_CHUNKS;
+		writer->pending_count--;
+		pthread_cond_broadcast(&writer->cond);
+	}
+	pthread_mutex_unlock(&writer->mutex);
+	return NULL;
+}
+
+static void release_writer(ser_writer *writer) {
+	for (int i = 0; i < INDIGO_SER_CHUNKS; i++)
+		if (writer->chunks[i].data)
+			free(writer->chunks[i].data);
+	free(writer);
+}
+
+static ser_writer *create_writer(size_t frame_size) {
+	ser_writer *writer = malloc(sizeof(ser_writer));
+	if (writer == NULL)
+		return NULL;
+	memset(writer, 0, sizeof(ser_writer));
+	writer->chunk_size = INDIGO_SER_CHUNK_SIZE;
+	if (writer->chunk_size < frame_size)
+		writer->chunk_size = (frame_size + SER_ALIGNMENT - 1) / SER_ALIGNMENT * SER_ALIGNMENT;
+	for (int i = 0; i < INDIGO_SER_CHUNKS; i++) {
+		if (posix_memalign(&writer->chunks[i].data, SER_ALIGNMENT, writer->chunk_size)) {
+			writer->chunks[i].data = NULL;
+			release_writer(writer);
+			return NULL;
+		}
+	}
+	pthread_mutex_init(&writer->mutex, NULL);
+	pthread_cond_init(&writer->cond, NULL);
+	writer->running = true;
+	return writer;
+}
+
+// chunk is submitted with writer mutex locked, waits for the next one to be available
+
+static void submit_chunk(ser_writer *writer) {
+	if (writer->chunks[writer->current].used == 0)
+		return;
+	writer->pending_count++;
+	pthread_cond_broadcast(&writer->cond);
+	writer->current = (writer->current + 1) % INDIGO_SER_CHUNKS;
+	while (writer->pending_count == INDIGO_SER_CHUNKS)
+		pthread_cond_wait(&writer->cond, &writer->mutex);
 }
 
 indigo_ser *indigo_ser_open(const char *filename, void *buffer, bool little_endian, bool byte_order_rgb) {
@@ -63,44 +167,51 @@ indigo_ser *indigo_ser_open(const char *filename, void *buffer, bool little_endi
 		INDIGO_ERROR(indigo_error("indigo_ser: could not allocate memory for indigo_ser structure"));
 		goto failure;
 	}
+	memset(ser, 0, sizeof(indigo_ser));
 	ser->handle = handle;
-	ser->count = 0;
-	int result = indigo_write(handle, "LUCAM-RECORDER", 14); // 0
-	result = result && write_int(handle, 0); // 14
-	indigo_raw_header *header = (indigo_raw_header *)buffer;
+	indigo_raw_header *raw_header = (indigo_raw_header *)buffer;
+	unsigned char header[SER_HEADER_SIZE] = { 0 };
+	memcpy(header, "LUCAM-RECORDER", 14); // 0
 	int bits_per_pixel = 8;
-	switch (header->signature) {
+	switch (raw_header->signature) {
 		case INDIGO_RAW_MONO8:
-			result = result && write_int(handle, 0); // 18
+			put_int(header + 18, 0);
 			break;
 		case INDIGO_RAW_MONO16:
-			result = result && write_int(handle, 0); // 18
+			put_int(header + 18, 0);
 			bits_per_pixel = 16;
 			break;
 		case INDIGO_RAW_RGB24:
-			result = result && write_int(handle, byte_order_rgb ? 101 : 100); // 18
+			put_int(header + 18, byte_order_rgb ? 101 : 100);
 			break;
 		case INDIGO_RAW_RGB48:
-			result = result && write_int(handle, byte_order_rgb ? 101 : 100); // 18
+			put_int(header + 18, byte_order_rgb ? 101 : 100);
 			bits_per_pixel = 16;
 			break;
 	}
-	result = result && write_int(handle, !little_endian); // 22
-	result = result && write_int(handle, header->width); // 26
-	result = result && write_int(handle, header->height); // 30
-	result = result && write_int(handle, bits_per_pixel); // 34
-	result = result && write_int(handle, 0); // 38
-	static char zero[40] = { 0 };
-	result = result && indigo_write(handle, zero, 40); // 42
-	result = result && indigo_write(handle, zero, 40); // 82
-	result = result && indigo_write(handle, zero, 40); // 122
-	tzset();
-	long time_utc = (time(NULL) + 62135600400L) * 10000000L;
-	long timezone_diff =  (timezone - daylight ? 3600 : 0) * 10000000L;
-	result = result && write_long(handle, time_utc); // 162
-	result = result && write_long(handle, time_utc + timezone_diff); // 170
-	if (!result)
+	put_int(header + 22, !little_endian);
+	put_int(header + 26, raw_header->width);
+	put_int(header + 30, raw_header->height);
+	put_int(header + 34, bits_per_pixel);
+	// frame count (38) is updated as frames are written, observer (42), instrument (82) and telescope (122) are left empty
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	struct tm local;
+	localtime_r(&now.tv_sec, &local);
+	put_long(header + 162, ticks(&now) + local.tm_gmtoff * 10000000LL);
+	put_long(header + 170, ticks(&now));
+	ser->frame_size = frame_size(header);
+	if (!indigo_write(handle, (const char *)header, SER_HEADER_SIZE))
+		goto failure;
+	if ((ser->writer = create_writer(ser->frame_size)) == NULL) {
+		INDIGO_ERROR(indigo_error("indigo_ser: could not allocate memory for write buffers"));
+		goto failure;
+	}
+	if (pthread_create(&((ser_writer *)ser->writer)->thread, NULL, (void * (*)(void*))writer_thread, ser)) {
+		INDIGO_ERROR(indigo_error("indigo_ser: failed to create writer thread"));
+		release_writer(ser->writer);
 		goto failure;
+	}
 	return ser;
 failure:
 	if (handle != -1) {
@@ -112,17 +223,101 @@ failure:
 	return NULL;
 }
 
+bool indigo_ser_add_frame_timed(indigo_ser *ser, void *buffer, size_t len, struct timeval *utc) {
+	ser_writer *writer = ser->writer;
+	if (len - sizeof(indigo_raw_header) != ser->frame_size) {
+		INDIGO_ERROR(indigo_error("indigo_ser: frame size changed"));
+		errno = EINVAL;
+		return false;
+	}
+	if (ser->count == ser->timestamps_size) {
+		int size = ser->timestamps_size ? 2 * ser->timestamps_size : 1024;
+		uint64_t *timestamps = realloc(ser->timestamps, size * sizeof(uint64_t));
+		if (timestamps == NULL)
+			return false;
+		ser->timestamps = timestamps;
+		ser->timestamps_size = size;
+	}
+	struct timeval now;
+	if (utc == NULL) {
+		gettimeofday(&now, NULL);
+		utc = &now;
+	}
+	pthread_mutex_lock(&writer->mutex);
+	if (writer->chunks[writer->current].used + ser->frame_size > writer->chunk_size)
+		submit_chunk(writer);
+	ser_chunk *chunk = writer->chunks + writer->current;
+	memcpy(chunk->data + chunk->used, buffer + sizeof(indigo_raw_header), ser->frame_size);
+	chunk->used += ser->frame_size;
+	chunk->frames++;
+	bool result = !writer->failed;
+	pthread_mutex_unlock(&writer->mutex);
+	ser->timestamps[ser->count++] = ticks(utc);
+	if (!result)
+		errno = EIO;
+	return result;
+}
+
 bool indigo_ser_add_frame(indigo_ser *ser, void *buffer, size_t len) {
-	ser->count++;
-	return indigo_write(ser->handle, buffer + 12, len - 12);
+	return indigo_ser_add_frame_timed(ser, buffer, len, NULL);
 }
 
 bool indigo_ser_close(indigo_ser *ser) {
-	int handle = ser->handle;
-	if (lseek(handle, 38, SEEK_SET) && write_int(handle, ser->count)) {
+	ser_writer *writer = ser->writer;
+	pthread_mutex_lock(&writer->mutex);
+	submit_chunk(writer);
+	writer->running = false;
+	pthread_cond_broadcast(&writer->cond);
+	pthread_mutex_unlock(&writer->mutex);
+	pthread_join(writer->thread, NULL);
+	bool result = !writer->failed && writer->written == ser->count;
+	pthread_mutex_destroy(&writer->mutex);
+	pthread_cond_destroy(&writer->cond);
+	release_writer(writer);
+	if (result && ser->count > 0) {
+		// SER v3 trailer with UTC timestamp of each frame
+		unsigned char *trailer = malloc(ser->count * 8);
+		if (trailer) {
+			for (int i = 0; i < ser->count; i++)
+				put_long(trailer + i * 8, ser->timestamps[i]);
+			result = indigo_write(ser->handle, (const char *)trailer, ser->count * 8);
+			free(trailer);
+		} else {
+			result = false;
+		}
+	}
+	result = result && write_count(ser->handle, ser->count);
+	close(ser->handle);
+	if (ser->timestamps)
+		free(ser->timestamps);
+	free(ser);
+	return result;
+}
+
+bool indigo_ser_recover(const char *filename) {
+	int handle = open(filename, O_RDWR);
+	if (handle == -1) {
+		INDIGO_ERROR(indigo_error("indigo_ser: failed to open %s (%s)", filename, strerror(errno)));
+		return false;
+	}
+	unsigned char header[SER_HEADER_SIZE];
+	struct stat sb;
+	if (read(handle, header, SER_HEADER_SIZE) != SER_HEADER_SIZE || memcmp(header, "LUCAM-RECORDER", 14) || fstat(handle, &sb) == -1) {
+		INDIGO_ERROR(indigo_error("indigo_ser: %s is not SER file", filename));
 		close(handle);
-		free(ser);
-		return true;
+		return false;
+	}
+	size_t size = frame_size(header);
+	uint32_t count = get_int(header + SER_COUNT_OFFSET);
+	off_t data_size = sb.st_size - SER_HEADER_SIZE;
+	if (size == 0 || (off_t)(count * (size + 8)) == data_size) {
+		// properly closed file with timestamp trailer
+		close(handle);
+		return size != 0;
 	}
-	return false;
+	count = (uint32_t)(data_size / size);
+	bool result = ftruncate(handle, SER_HEADER_SIZE + (off_t)count * size) == 0 && write_count(handle, count);
+	close(handle);
+	INDIGO_DEBUG(indigo_debug("indigo_ser: %s recovered with %u frames", filename, count));
+	return result;
 }
@@ -52,6 +52,7 @@
 #include <indigo/indigo_client_xml.h>
 #include <indigo/indigo_base64.h>
 #include <indigo/indigo_io.h>
+#include <indigo/indigo_metrics.h>
 
 #define SHA1_SIZE 20
 #if _MSC_VER
@@ -78,6 +79,7 @@ static struct resource {
 	unsigned length;
 	const char *file_name;
 	char *content_type;
+	indigo_server_tcp_handler handler;
 	struct resource *next;
 } *resources = NULL;
 
@@ -87,6 +89,8 @@ static void start_worker_thread(int *client_socket) {
 	int socket = *client_socket;
 	INDIGO_LOG(indigo_log("Worker thread started socket = %d", socket));
 	server_callback(++client_count);
+	indigo_metric_add(INDIGO_METRIC_SERVER_CONNECTIONS, 1);
+	indigo_metric_add(INDIGO_METRIC_SERVER_CLIENTS, 1);
 	int res = 0;
 	char c;
 	if (recv(socket, &c, 1, MSG_PEEK) == 1) {
@@ -94,6 +98,7 @@ static void start_worker_thread(int *client_socket) {
 			INDIGO_LOG(indigo_log("Protocol switched to XML"));
 			indigo_client *protocol_adapter = indigo_xml_device_adapter(socket, socket);
 			assert(protocol_adapter != NULL);
+			indigo_metric_register_socket(socket, "xml");
 			indigo_attach_client(protocol_adapter);
 			indigo_xml_parse(NULL, protocol_adapter);
 			indigo_detach_client(protocol_adapter);
@@ -102,6 +107,7 @@ static void start_worker_thread(int *client_socket) {
 			INDIGO_LOG(indigo_log("Protocol switched to JSON"));
 			indigo_client *protocol_adapter = indigo_json_device_adapter(socket, socket, false);
 			assert(protocol_adapter != NULL);
+			indigo_metric_register_socket(socket, "json");
 			indigo_attach_client(protocol_adapter);
 			indigo_json_parse(NULL, protocol_adapter);
 			indigo_detach_client(protocol_adapter);
@@ -118,7 +124,7 @@ static void start_worker_thread(int *client_socket) {
 						*space = 0;
 					char *param = strchr(path, '?');
 					if (param)
-						*param = 0;
+						*param++ = 0;
 					char websocket_key[256] = "";
 					while (indigo_read_line(socket, header, BUFFER_SIZE) > 0) {
 						if (!strncasecmp(header, "Sec-WebSocket-Key: ", 19))
@@ -142,6 +148,7 @@ static void start_worker_thread(int *client_socket) {
 							INDIGO_LOG(indigo_log("Protocol switched to JSON-over-WebSockets"));
 							indigo_client *protocol_adapter = indigo_json_device_adapter(socket, socket, true);
 							assert(protocol_adapter != NULL);
+							indigo_metric_register_socket(socket, "websocket");
 							indigo_attach_client(protocol_adapter);
 							indigo_json_parse(NULL, protocol_adapter);
 							indigo_detach_client(protocol_adapter);
@@ -172,6 +179,7 @@ static void start_worker_thread(int *client_socket) {
 							INDIGO_PRINTF(socket, "Content-Length: %ld\r\n", entry->size);
 							INDIGO_PRINTF(socket, "\r\n");
 							if (indigo_write(socket, entry->content, entry->size)) {
+								indigo_metric_add(INDIGO_METRIC_HTTP_BLOB_BYTES, entry->size);
 								INDIGO_LOG(indigo_log("%s -> OK (%ld bytes)", request, entry->size));
 							} else {
 								INDIGO_LOG(indigo_log("%s -> Failed (%s)", request, strerror(errno)));
@@ -189,6 +197,23 @@ static void start_worker_thread(int *client_socket) {
 							INDIGO_LOG(indigo_log("%s -> Failed", request));
 							keep_alive = false;
 						}
+					} else if (!strcmp(path, "/metrics")) {
+						long length = 0;
+						char *text = indigo_metrics_text(&length);
+						if (text == NULL)
+							goto failure;
+						bool sent = indigo_printf(socket, "HTTP/1.1 200 OK\r\n");
+						sent = sent && indigo_printf(socket, "Server: INDIGO/%d.%d-%s\r\n", (INDIGO_VERSION_CURRENT >> 8) & 0xFF, INDIGO_VERSION_CURRENT & 0xFF, INDIGO_BUILD);
+						sent = sent && indigo_printf(socket, "Content-Type: text/plain; version=0.0.4\r\n");
+						if (keep_alive)
+							sent = sent && indigo_printf(socket, "Connection: keep-alive\r\n");
+						sent = sent && indigo_printf(socket, "Content-Length: %ld\r\n", length);
+						sent = sent && indigo_printf(socket, "\r\n");
+						sent = sent && indigo_write(socket, text, length);
+						free(text);
+						if (!sent)
+							goto failure;
+						INDIGO_LOG(indigo_log("%s -> OK (%ld bytes)", request, length));
 					} else {
 						struct resource *resource = resources;
 						while (resource) {
@@ -203,6 +228,13 @@ static void start_worker_thread(int *client_socket) {
 							INDIGO_PRINTF(socket, "%s not found!\r\n", path);
 							INDIGO_LOG(indigo_log("%s -> Failed", request));
 							keep_alive = false;
+						} else if (resource->handler) {
+							if (resource->handler(socket, path, param ? param : "")) {
+								INDIGO_LOG(indigo_log("%s -> OK", request));
+							} else {
+								INDIGO_LOG(indigo_log("%s -> Failed", request));
+								keep_alive = false;
+							}
 						} else if (resource->data) {
 							INDIGO_PRINTF(socket, "HTTP/1.1 200 OK\r\n");
 							INDIGO_PRINTF(socket, "Server: INDIGO/%d.%d-%s\r\n", (INDIGO_VERSION_CURRENT >> 8) & 0xFF, INDIGO_VERSION_CURRENT & 0xFF, INDIGO_BUILD);
@@ -261,10 +293,12 @@ static void start_worker_thread(int *client_socket) {
 		}
 	}
 failure:
+	indigo_metric_unregister_socket(socket);
 	shutdown(socket, SHUT_RDWR);
 	//indigo_usleep(ONE_SECOND_DELAY); // ???
 	close(socket);
 	server_callback(--client_count);
+	indigo_metric_add(INDIGO_METRIC_SERVER_CLIENTS, -1);
 	free(client_socket);
 	INDIGO_LOG(indigo_log("Worker thread finished"));
 }
@@ -300,6 +334,16 @@ void indigo_server_add_file_resource(const char *path, const char *file_name, co
 	INDIGO_LOG(indigo_log("Resource %s (%s, %s) added", path, file_name, content_type));
 }
 
+void indigo_server_add_handler(const char *path, indigo_server_tcp_handler handler) {
+	struct resource *resource = malloc(sizeof(struct resource));
+	memset(resource, 0, sizeof(struct resource));
+	resource->path = path;
+	resource->handler = handler;
+	resource->next = resources;
+	resources = resource;
+	INDIGO_LOG(indigo_log("Handler %s added", path));
+}
+
 void indigo_server_remove_resource(const char *path) {
 	struct resource *resource = resources;
 	struct resource *prev = NULL;
@@ -0,0 +1,909 @@
+// Copyright (c) 2020 CloudMakers, s. r. o.
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// version history
+// 2.0 by Peter Polakovic <peter.polakovic@cloudmakers.eu>
+
+/** INDIGO SGP4/SDP4 satellite propagator
+ \file indigo_sgp4.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+
+#include <indigo/indigo_bus.h>
+#include <indigo/indigo_novas.h>
+#include <indigo/indigo_sgp4.h>
+
+// propagator follows Vallado et al., Revisiting Spacetrack Report #3 (AIAA 2006-6753), "improved" mode with WGS72 constants
+
+#define PI									3.14159265358979323846
+#define TWOPI								(2.0 * PI)
+#define X2O3								(2.0 / 3.0)
+
+#define MU									398600.8
+#define RADIUS_EARTH_KM			6378.135
+#define XKE									0.0743669161331734132	// 60 / sqrt(RADIUS_EARTH_KM^3 / MU)
+#define J2									0.001082616
+#define J3									-0.00000253881
+#define J4									-0.00000165597
+#define J3OJ2								(J3 / J2)
+#define VKMPERSEC						(RADIUS_EARTH_KM * XKE / 60.0)
+
+#define WGS84_A							6378.137
+#define WGS84_F							(1.0 / 298.257223563)
+
+#define PASS_STEP						30.0
+#define PASS_PRECISION			0.1
+
+// Greenwich mean sidereal time (IAU 1982) in radians
+
+static double gstime(double jd_ut1) {
+	double tut1 = (jd_ut1 - 2451545.0) / 36525.0;
+	double temp = -6.2e-6 * tut1 * tut1 * tut1 + 0.093104 * tut1 * tut1 + (876600.0 * 3600 + 8640184.812866) * tut1 + 67310.54841;
+	temp = fmod(temp * PI / 180.0 / 240.0, TWOPI);
+	return temp < 0 ? temp + TWOPI : temp;
+}
+
+// deep space common terms
+
+typedef struct {
+	double snodm, cnodm, sinim, cosim, sinomm, cosomm, day, emsq, gam, rtemsq;
+	double s1, s2, s3, s4, s5, s6, s7, ss1, ss2, ss3, ss4, ss5, ss6, ss7;
+	double sz1, sz2, sz3, sz11, sz12, sz13, sz21, sz22, sz23, sz31, sz32, sz33;
+	double z1, z2, z3, z11, z12, z13, z21, z22, z23, z31, z32, z33;
+	double em, nm;
+} dscom_terms;
+
+static void dscom(double epoch, double ep, double argpp, double tc, double inclp, double nodep, double np, indigo_tle *tle, dscom_terms *d) {
+	const double zes = 0.01675, zel = 0.05490, c1ss = 2.9864797e-6, c1l = 4.7968065e-7;
+	const double zsinis = 0.39785416, zcosis = 0.91744867, zcosgs = 0.1945905, zsings = -0.98088458;
+	d->nm = np;
+	d->em = ep;
+	d->snodm = sin(nodep);
+	d->cnodm = cos(nodep);
+	d->sinomm = sin(argpp);
+	d->cosomm = cos(argpp);
+	d->sinim = sin(inclp);
+	d->cosim = cos(inclp);
+	d->emsq = d->em * d->em;
+	double betasq = 1.0 - d->emsq;
+	d->rtemsq = sqrt(betasq);
+	tle->peo = tle->pinco = tle->plo = tle->pgho = tle->pho = 0.0;
+	d->day = epoch + 18261.5 + tc / 1440.0;
+	double xnodce = fmod(4.5236020 - 9.2422029e-4 * d->day, TWOPI);
+	double stem = sin(xnodce), ctem = cos(xnodce);
+	double zcosil = 0.91375164 - 0.03568096 * ctem;
+	double zsinil = sqrt(1.0 - zcosil * zcosil);
+	double zsinhl = 0.089683511 * stem / zsinil;
+	double zcoshl = sqrt(1.0 - zsinhl * zsinhl);
+	d->gam = 5.8351514 + 0.0019443680 * d->day;
+	double zx = 0.39785416 * stem / zsinil;
+	double zy = zcoshl * ctem + 0.91744867 * zsinhl * stem;
+	zx = atan2(zx, zy);
+	zx = d->gam + zx - xnodce;
+	double zcosgl = cos(zx), zsingl = sin(zx);
+	double zcosg = zcosgs, zsing = zsings, zcosi = zcosis, zsini = zsinis, zcosh = d->cnodm, zsinh = d->snodm, cc = c1ss;
+	double xnoi = 1.0 / d->nm;
+	double cosim = d->cosim, sinim = d->sinim, cosomm = d->cosomm, sinomm = d->sinomm, emsq = d->emsq;
+	// solar terms in the first pass, lunar terms in the second one
+	for (int lsflg = 1; lsflg <= 2; lsflg++) {
+		double a1 = zcosg * zcosh + zsing * zcosi * zsinh;
+		double a3 = -zsing * zcosh + zcosg * zcosi * zsinh;
+		double a7 = -zcosg * zsinh + zsing * zcosi * zcosh;
+		double a8 = zsing * zsini;
+		double a9 = zsing * zsinh + zcosg * zcosi * zcosh;
+		double a10 = zcosg * zsini;
+		double a2 = cosim * a7 + sinim * a8;
+		double a4 = cosim * a9 + sinim * a10;
+		double a5 = -sinim * a7 + cosim * a8;
+		double a6 = -sinim * a9 + cosim * a10;
+		double x1 = a1 * cosomm + a2 * sinomm;
+		double x2 = a3 * cosomm + a4 * sinomm;
+		double x3 = -a1 * sinomm + a2 * cosomm;
+		double x4 = -a3 * sinomm + a4 * cosomm;
+		double x5 = a5 * sinomm;
+		double x6 = a6 * sinomm;
+		double x7 = a5 * cosomm;
+		double x8 = a6 * cosomm;
+		d->z31 = 12.0 * x1 * x1 - 3.0 * x3 * x3;
+		d->z32 = 24.0 * x1 * x2 - 6.0 * x3 * x4;
+		d->z33 = 12.0 * x2 * x2 - 3.0 * x4 * x4;
+		d->z1 = 3.0 * (a1 * a1 + a2 * a2) + d->z31 * emsq;
+		d->z2 = 6.0 * (a1 * a3 + a2 * a4) + d->z32 * emsq;
+		d->z3 = 3.0 * (a3 * a3 + a4 * a4) + d->z33 * emsq;
+		d->z11 = -6.0 * a1 * a5 + emsq * (-24.0 * x1 * x7 - 6.0 * x3 * x5);
+		d->z12 = -6.0 * (a1 * a6 + a3 * a5) + emsq * (-24.0 * (x2 * x7 + x1 * x8) - 6.0 * (x3 * x6 + x4 * x5));
+		d->z13 = -6.0 * a3 * a6 + emsq * (-24.0 * x2 * x8 - 6.0 * x4 * x6);
+		d->z21 = 6.0 * a2 * a5 + emsq * (24.0 * x1 * x5 - 6.0 * x3 * x7);
+		d->z22 = 6.0 * (a4 * a5 + a2 * a6) + emsq * (24.0 * (x2 * x5 + x1 * x6) - 6.0 * (x4 * x7 + x3 * x8));
+		d->z23 = 6.0 * a4 * a6 + emsq * (24.0 * x2 * x6 - 6.0 * x4 * x8);
+		d->z1 = d->z1 + d->z1 + betasq * d->z31;
+		d->z2 = d->z2 + d->z2 + betasq * d->z32;
+		d->z3 = d->z3 + d->z3 + betasq * d->z33;
+		d->s3 = cc * xnoi;
+		d->s2 = -0.5 * d->s3 / d->rtemsq;
+		d->s4 = d->s3 * d->rtemsq;
+		d->s1 = -15.0 * d->em * d->s4;
+		d->s5 = x1 * x3 + x2 * x4;
+		d->s6 = x2 * x3 + x1 * x4;
+		d->s7 = x2 * x4 - x1 * x3;
+		if (lsflg == 1) {
+			d->ss1 = d->s1; d->ss2 = d->s2; d->ss3 = d->s3; d->ss4 = d->s4; d->ss5 = d->s5; d->ss6 = d->s6; d->ss7 = d->s7;
+			d->sz1 = d->z1; d->sz2 = d->z2; d->sz3 = d->z3;
+			d->sz11 = d->z11; d->sz12 = d->z12; d->sz13 = d->z13;
+			d->sz21 = d->z21; d->sz22 = d->z22; d->sz23 = d->z23;
+			d->sz31 = d->z31; d->sz32 = d->z32; d->sz33 = d->z33;
+			zcosg = zcosgl;
+			zsing = zsingl;
+			zcosi = zcosil;
+			zsini = zsinil;
+			zcosh = zcoshl * d->cnodm + zsinhl * d->snodm;
+			zsinh = d->snodm * zcoshl - d->cnodm * zsinhl;
+			cc = c1l;
+		}
+	}
+	tle->zmol = fmod(4.7199672 + 0.22997150 * d->day - d->gam, TWOPI);
+	tle->zmos = fmod(6.2565837 + 0.017201977 * d->day, TWOPI);
+	tle->se2 = 2.0 * d->ss1 * d->ss6;
+	tle->se3 = 2.0 * d->ss1 * d->ss7;
+	tle->si2 = 2.0 * d->ss2 * d->sz12;
+	tle->si3 = 2.0 * d->ss2 * (d->sz13 - d->sz11);
+	tle->sl2 = -2.0 * d->ss3 * d->sz2;
+	tle->sl3 = -2.0 * d->ss3 * (d->sz3 - d->sz1);
+	tle->sl4 = -2.0 * d->ss3 * (-21.0 - 9.0 * emsq) * zes;
+	tle->sgh2 = 2.0 * d->ss4 * d->sz32;
+	tle->sgh3 = 2.0 * d->ss4 * (d->sz33 - d->sz31);
+	tle->sgh4 = -18.0 * d->ss4 * zes;
+	tle->sh2 = -2.0 * d->ss2 * d->sz22;
+	tle->sh3 = -2.0 * d->ss2 * (d->sz23 - d->sz21);
+	tle->ee2 = 2.0 * d->s1 * d->s6;
+	tle->e3 = 2.0 * d->s1 * d->s7;
+	tle->xi2 = 2.0 * d->s2 * d->z12;
+	tle->xi3 = 2.0 * d->s2 * (d->z13 - d->z11);
+	tle->xl2 = -2.0 * d->s3 * d->z2;
+	tle->xl3 = -2.0 * d->s3 * (d->z3 - d->z1);
+	tle->xl4 = -2.0 * d->s3 * (-21.0 - 9.0 * emsq) * zel;
+	tle->xgh2 = 2.0 * d->s4 * d->z32;
+	tle->xgh3 = 2.0 * d->s4 * (d->z33 - d->z31);
+	tle->xgh4 = -18.0 * d->s4 * zel;
+	tle->xh2 = -2.0 * d->s2 * d->z22;
+	tle->xh3 = -2.0 * d->s2 * (d->z23 - d->z21);
+}
+
+// deep space lunar-solar periodics
+
+static void dpper(const indigo_tle *tle, double t, double *ep, double *inclp, double *nodep, double *argpp, double *mp) {
+	const double zns = 1.19459e-5, zes = 0.01675, znl = 1.5835218e-4, zel = 0.05490;
+	double zm = tle->zmos + zns * t;
+	double zf = zm + 2.0 * zes * sin(zm);
+	double sinzf = sin(zf);
+	double f2 = 0.5 * sinzf * sinzf - 0.25;
+	double f3 = -0.5 * sinzf * cos(zf);
+	double ses = tle->se2 * f2 + tle->se3 * f3;
+	double sis = tle->si2 * f2 + tle->si3 * f3;
+	double sls = tle->sl2 * f2 + tle->sl3 * f3 + tle->sl4 * sinzf;
+	double sghs = tle->sgh2 * f2 + tle->sgh3 * f3 + tle->sgh4 * sinzf;
+	double shs = tle->sh2 * f2 + tle->sh3 * f3;
+	zm = tle->zmol + znl * t;
+	zf = zm + 2.0 * zel * sin(zm);
+	sinzf = sin(zf);
+	f2 = 0.5 * sinzf * sinzf - 0.25;
+	f3 = -0.5 * sinzf * cos(zf);
+	double sel = tle->ee2 * f2 + tle->e3 * f3;
+	double sil = tle->xi2 * f2 + tle->xi3 * f3;
+	double sll = tle->xl2 * f2 + tle->xl3 * f3 + tle->xl4 * sinzf;
+	double sghl = tle->xgh2 * f2 + tle->xgh3 * f3 + tle->xgh4 * sinzf;
+	double shll = tle->xh2 * f2 + tle->xh3 * f3;
+	double pe = ses + sel - tle->peo;
+	double pinc = sis + sil - tle->pinco;
+	double pl = sls + sll - tle->plo;
+	double pgh = sghs + sghl - tle->pgho;
+	double ph = shs + shll - tle->pho;
+	*inclp += pinc;
+	*ep += pe;
+	double sinip = sin(*inclp), cosip = cos(*inclp);
+	if (*inclp >= 0.2) {
+		ph = ph / sinip;
+		pgh = pgh - cosip * ph;
+		*argpp += pgh;
+		*nodep += ph;
+		*mp += pl;
+	} else {
+		// Lyddane modification for low inclinations
+		double sinop = sin(*nodep), cosop = cos(*nodep);
+		double alfdp = sinip * sinop + ph * cosop + pinc * cosip * sinop;
+		double betdp = sinip * cosop - ph * sinop + pinc * cosip * cosop;
+		*nodep = fmod(*nodep, TWOPI);
+		double xls = *mp + *argpp + cosip * *nodep + pl + pgh - pinc * *nodep * sinip;
+		double xnoh = *nodep;
+		*nodep = atan2(alfdp, betdp);
+		if (fabs(xnoh - *nodep) > PI) {
+			if (*nodep < xnoh)
+				*nodep += TWOPI;
+			else
+				*nodep -= TWOPI;
+		}
+		*mp += pl;
+		*argpp = xls - *mp - cosip * *nodep;
+	}
+}
+
+// deep space secular effects and resonance initialization
+
+static void dsinit(indigo_tle *tle, const dscom_terms *d, double xpidot, double *em, double *inclm) {
+	const double q22 = 1.7891679e-6, q31 = 2.1460748e-6, q33 = 2.2123015e-7;
+	const double root22 = 1.7891679e-6, root44 = 7.3636953e-9, root54 = 2.1765803e-9, root32 = 3.7393792e-7, root52 = 1.1428639e-7;
+	const double rptim = 4.37526908801129966e-3, znl = 1.5835218e-4, zns = 1.19459e-5;
+	double nm = d->nm, emsq = d->emsq, cosim = d->cosim, sinim = d->sinim;
+	tle->irez = 0;
+	if (nm < 0.0052359877 && nm > 0.0034906585)
+		tle->irez = 1;
+	if (nm >= 8.26e-3 && nm <= 9.24e-3 && *em >= 0.5)
+		tle->irez = 2;
+	double ses = d->ss1 * zns * d->ss5;
+	double sis = d->ss2 * zns * (d->sz11 + d->sz13);
+	double sls = -zns * d->ss3 * (d->sz1 + d->sz3 - 14.0 - 6.0 * emsq);
+	double sghs = d->ss4 * zns * (d->sz31 + d->sz33 - 6.0);
+	double shs = -zns * d->ss2 * (d->sz21 + d->sz23);
+	if (*inclm < 5.2359877e-2 || *inclm > PI - 5.2359877e-2)
+		shs = 0.0;
+	if (sinim != 0.0)
+		shs = shs / sinim;
+	double sgs = sghs - cosim * shs;
+	tle->dedt = ses + d->s1 * znl * d->s5;
+	tle->didt = sis + d->s2 * znl * (d->z11 + d->z13);
+	tle->dmdt = sls - znl * d->s3 * (d->z1 + d->z3 - 14.0 - 6.0 * emsq);
+	double sghl = d->s4 * znl * (d->z31 + d->z33 - 6.0);
+	double shll = -znl * d->s2 * (d->z21 + d->z23);
+	if (*inclm < 5.2359877e-2 || *inclm > PI - 5.2359877e-2)
+		shll = 0.0;
+	tle->domdt = sgs + sghl;
+	tle->dnodt = shs;
+	if (sinim != 0.0) {
+		tle->domdt = tle->domdt - cosim / sinim * shll;
+		tle->dnodt = tle->dnodt + shll / sinim;
+	}
+	double theta = fmod(tle->gsto, TWOPI);
+	if (tle->irez != 0) {
+		double aonv = pow(nm / XKE, X2O3);
+		if (tle->irez == 2) {
+			// geopotential resonance for 12 hour orbits
+			double cosisq = cosim * cosim;
+			double e = tle->ecco, esq = e * e, eoc = e * esq;
+			double g201 = -0.306 - (e - 0.64) * 0.440, g211, g310, g322, g410, g422, g520, g521, g532, g533;
+			if (e <= 0.65) {
+				g211 = 3.616 - 13.2470 * e + 16.2900 * esq;
+				g310 = -19.302 + 117.3900 * e - 228.4190 * esq + 156.5910 * eoc;
+				g322 = -18.9068 + 109.7927 * e - 214.6334 * esq + 146.5816 * eoc;
+				g410 = -41.122 + 242.6940 * e - 471.0940 * esq + 313.9530 * eoc;
+				g422 = -146.407 + 841.8800 * e - 1629.014 * esq + 1083.4350 * eoc;
+				g520 = -532.114 + 3017.977 * e - 5740.032 * esq + 3708.2760 * eoc;
+			} else {
+				g211 = -72.099 + 331.819 * e - 508.738 * esq + 266.724 * eoc;
+				g310 = -346.844 + 1582.851 * e - 2415.925 * esq + 1246.113 * eoc;
+				g322 = -342.585 + 1554.908 * e - 2366.899 * esq + 1215.972 * eoc;
+				g410 = -1052.797 + 4758.686 * e - 7193.992 * esq + 3651.957 * eoc;
+				g422 = -3581.690 + 16178.110 * e - 24462.770 * esq + 12422.520 * eoc;
+				if (e > 0.715)
+					g520 = -5149.66 + 29936.92 * e - 54087.36 * esq + 31324.56 * eoc;
+				else
+					g520 = 1464.74 - 4664.75 * e + 3763.64 * esq;
+			}
+			if (e < 0.7) {
+				g533 = -919.22770 + 4988.6100 * e - 9064.7700 * esq + 5542.21 * eoc;
+				g521 = -822.71072 + 4568.6173 * e - 8491.4146 * esq + 5337.524 * eoc;
+				g532 = -853.66600 + 4690.2500 * e - 8624.7700 * esq + 5341.4 * eoc;
+			} else {
+				g533 = -37995.780 + 161616.52 * e - 229838.20 * esq + 109377.94 * eoc;
+				g521 = -51752.104 + 218913.95 * e - 309468.16 * esq + 146349.42 * eoc;
+				g532 = -40023.880 + 170470.89 * e - 242699.48 * esq + 115605.82 * eoc;
+			}
+			double sini2 = sinim * sinim;
+			double f220 = 0.75 * (1.0 + 2.0 * cosim + cosisq);
+			double f221 = 1.5 * sini2;
+			double f321 = 1.875 * sinim * (1.0 - 2.0 * cosim - 3.0 * cosisq);
+			double f322 = -1.875 * sinim * (1.0 + 2.0 * cosim - 3.0 * cosisq);
+			double f441 = 35.0 * sini2 * f220;
+			double f442 = 39.3750 * sini2 * sini2;
+			double f522 = 9.84375 * sinim * (sini2 * (1.0 - 2.0 * cosim - 5.0 * cosisq) + 0.33333333 * (-2.0 + 4.0 * cosim + 6.0 * cosisq));
+			double f523 = sinim * (4.92187512 * sini2 * (-2.0 - 4.0 * cosim + 10.0 * cosisq) + 6.56250012 * (1.0 + 2.0 * cosim - 3.0 * cosisq));
+			double f542 = 29.53125 * sinim * (2.0 - 8.0 * cosim + cosisq * (-12.0 + 8.0 * cosim + 10.0 * cosisq));
+			double f543 = 29.53125 * sinim * (-2.0 - 8.0 * cosim + cosisq * (12.0 + 8.0 * cosim - 10.0 * cosisq));
+			double xno2 = nm * nm;
+			double ainv2 = aonv * aonv;
+			double temp1 = 3.0 * xno2 * ainv2;
+			double temp = temp1 * root22;
+			tle->d2201 = temp * f220 * g201;
+			tle->d2211 = temp * f221 * g211;
+			temp1 = temp1 * aonv;
+			temp = temp1 * root32;
+			tle->d3210 = temp * f321 * g310;
+			tle->d3222 = temp * f322 * g322;
+			temp1 = temp1 * aonv;
+			temp = 2.0 * temp1 * root44;
+			tle->d4410 = temp * f441 * g410;
+			tle->d4422 = temp * f442 * g422;
+			temp1 = temp1 * aonv;
+			temp = temp1 * root52;
+			tle->d5220 = temp * f522 * g520;
+			tle->d5232 = temp * f523 * g532;
+			temp = 2.0 * temp1 * root54;
+			tle->d5421 = temp * f542 * g521;
+			tle->d5433 = temp * f543 * g533;
+			tle->xlamo = fmod(tle->mo + tle->nodeo + tle->nodeo - theta - theta, TWOPI);
+			tle->xfact = tle->mdot + tle->dmdt + 2.0 * (tle->nodedot + tle->dnodt - rptim) - tle->no_unkozai;
+		} else {
+			// synchronous resonance
+			double g200 = 1.0 + emsq * (-2.5 + 0.8125 * emsq);
+			double g310 = 1.0 + 2.0 * emsq;
+			double g300 = 1.0 + emsq * (-6.0 + 6.60937 * emsq);
+			double f220 = 0.75 * (1.0 + cosim) * (1.0 + cosim);
+			double f311 = 0.9375 * sinim * sinim * (1.0 + 3.0 * cosim) - 0.75 * (1.0 + cosim);
+			double f330 = 1.0 + cosim;
+			f330 = 1.875 * f330 * f330 * f330;
+			tle->del1 = 3.0 * nm * nm * aonv * aonv;
+			tle->del2 = 2.0 * tle->del1 * f220 * g200 * q22;
+			tle->del3 = 3.0 * tle->del1 * f330 * g300 * q33 * aonv;
+			tle->del1 = tle->del1 * f311 * g310 * q31 * aonv;
+			tle->xlamo = fmod(tle->mo + tle->nodeo + tle->argpo - theta, TWOPI);
+			tle->xfact = tle->mdot + xpidot - rptim + tle->dmdt + tle->domdt + tle->dnodt - tle->no_unkozai;
+		}
+	}
+}
+
+// deep space secular effects and resonance integration, integrator always starts at epoch so that state is not modified
+
+static void dspace(const indigo_tle *tle, double t, double *em, double *argpm, double *inclm, double *mm, double *nodem, double *nm) {
+	const double fasx2 = 0.13130908, fasx4 = 2.8843198, fasx6 = 0.37448087;
+	const double g22 = 5.7686396, g32 = 0.95240898, g44 = 1.8014998, g52 = 1.0508330, g54 = 4.4108898;
+	const double rptim = 4.37526908801129966e-3, stepp = 720.0, stepn = -720.0, step2 = 259200.0;
+	double theta = fmod(tle->gsto + t * rptim, TWOPI);
+	*em += tle->dedt * t;
+	*inclm += tle->didt * t;
+	*argpm += tle->domdt * t;
+	*nodem += tle->dnodt * t;
+	*mm += tle->dmdt * t;
+	if (tle->irez == 0)
+		return;
+	double atime = 0.0, xni = tle->no_unkozai, xli = tle->xlamo, delt = t > 0.0 ? stepp : stepn, ft = 0.0;
+	double xndt, xldot, xnddt;
+	while (true) {
+		if (tle->irez != 2) {
+			xndt = tle->del1 * sin(xli - fasx2) + tle->del2 * sin(2.0 * (xli - fasx4)) + tle->del3 * sin(3.0 * (xli - fasx6));
+			xldot = xni + tle->xfact;
+			xnddt = tle->del1 * cos(xli - fasx2) + 2.0 * tle->del2 * cos(2.0 * (xli - fasx4)) + 3.0 * tle->del3 * cos(3.0 * (xli - fasx6));
+			xnddt = xnddt * xldot;
+		} else {
+			double xomi = tle->argpo + tle->argpdot * atime;
+			double x2omi = xomi + xomi;
+			double x2li = xli + xli;
+			xndt = tle->d2201 * sin(x2omi + xli - g22) + tle->d2211 * sin(xli - g22) + tle->d3210 * sin(xomi + xli - g32) + tle->d3222 * sin(-xomi + xli - g32) + tle->d4410 * sin(x2omi + x2li - g44) + tle->d4422 * sin(x2li - g44) + tle->d5220 * sin(xomi + xli - g52) + tle->d5232 * sin(-xomi + xli - g52) + tle->d5421 * sin(xomi + x2li - g54) + tle->d5433 * sin(-xomi + x2li - g54);
+			xldot = xni + tle->xfact;
+			xnddt = tle->d2201 * cos(x2omi + xli - g22) + tle->d2211 * cos(xli - g22) + tle->d3210 * cos(xomi + xli - g32) + tle->d3222 * cos(-xomi + xli - g32) + tle->d5220 * cos(xomi + xli - g52) + tle->d5232 * cos(-xomi + xli - g52) + 2.0 * (tle->d4410 * cos(x2omi + x2li - g44) + tle->d4422 * cos(x2li - g44) + tle->d5421 * cos(xomi + x2li - g54) + tle->d5433 * cos(-xomi + x2li - g54));
+			xnddt = xnddt * xldot;
+		}
+		if (fabs(t - atime) < stepp) {
+			ft = t - atime;
+			break;
+		}
+		xli = xli + xldot * delt + xndt * step2;
+		xni = xni + xndt * delt + xnddt * step2;
+		atime = atime + delt;
+	}
+	*nm = xni + xndt * ft + xnddt * ft * ft * 0.5;
+	double xl = xli + xldot * ft + xndt * ft * ft * 0.5;
+	if (tle->irez != 1)
+		*mm = xl - 2.0 * *nodem + 2.0 * theta;
+	else
+		*mm = xl - *nodem - *argpm + theta;
+}
+
+bool indigo_sgp4_propagate(const indigo_tle *tle, double t, double *pos, double *vel) {
+	// secular gravity and atmospheric drag
+	double xmdf = tle->mo + tle->mdot * t;
+	double argpdf = tle->argpo + tle->argpdot * t;
+	double nodedf = tle->nodeo + tle->nodedot * t;
+	double argpm = argpdf, mm = xmdf, t2 = t * t;
+	double nodem = nodedf + tle->nodecf * t2;
+	double tempa = 1.0 - tle->cc1 * t;
+	double tempe = tle->bstar * tle->cc4 * t;
+	double templ = tle->t2cof * t2;
+	if (!tle->simple) {
+		double delomg = tle->omgcof * t;
+		double delmtemp = 1.0 + tle->eta * cos(xmdf);
+		double delm = tle->xmcof * (delmtemp * delmtemp * delmtemp - tle->delmo);
+		double temp = delomg + delm;
+		mm = xmdf + temp;
+		argpm = argpdf - temp;
+		double t3 = t2 * t, t4 = t3 * t;
+		tempa = tempa - tle->d2 * t2 - tle->d3 * t3 - tle->d4 * t4;
+		tempe = tempe + tle->bstar * tle->cc5 * (sin(mm) - tle->sinmao);
+		templ = templ + tle->t3cof * t3 + t4 * (tle->t4cof + t * tle->t5cof);
+	}
+	double nm = tle->no_unkozai, em = tle->ecco, inclm = tle->inclo;
+	if (tle->deep_space)
+		dspace(tle, t, &em, &argpm, &inclm, &mm, &nodem, &nm);
+	if (nm <= 0.0)
+		return false;
+	double am = pow(XKE / nm, X2O3) * tempa * tempa;
+	nm = XKE / pow(am, 1.5);
+	em = em - tempe;
+	if (em >= 1.0 || em < -0.001)
+		return false;
+	if (em < 1.0e-6)
+		em = 1.0e-6;
+	mm = mm + tle->no_unkozai * templ;
+	double xlm = mm + argpm + nodem;
+	nodem = fmod(nodem, TWOPI);
+	argpm = fmod(argpm, TWOPI);
+	xlm = fmod(xlm, TWOPI);
+	mm = fmod(xlm - argpm - nodem, TWOPI);
+	// lunar-solar periodics
+	double ep = em, xincp = inclm, argpp = argpm, nodep = nodem, mp = mm;
+	double sinip = sin(inclm), cosip = cos(inclm), aycof = tle->aycof, xlcof = tle->xlcof;
+	if (tle->deep_space) {
+		dpper(tle, t, &ep, &xincp, &nodep, &argpp, &mp);
+		if (xincp < 0.0) {
+			xincp = -xincp;
+			nodep = nodep + PI;
+			argpp = argpp - PI;
+		}
+		if (ep < 0.0 || ep > 1.0)
+			return false;
+		sinip = sin(xincp);
+		cosip = cos(xincp);
+		aycof = -0.5 * J3OJ2 * sinip;
+		xlcof = -0.25 * J3OJ2 * sinip * (3.0 + 5.0 * cosip) / (fabs(cosip + 1.0) > 1.5e-12 ? 1.0 + cosip : 1.5e-12);
+	}
+	// long period periodics
+	double axnl = ep * cos(argpp);
+	double temp = 1.0 / (am * (1.0 - ep * ep));
+	double aynl = ep * sin(argpp) + temp * aycof;
+	double xl = mp + argpp + nodep + temp * xlcof * axnl;
+	// Kepler's equation
+	double u = fmod(xl - nodep, TWOPI);
+	double eo1 = u, tem5 = 9999.9, sineo1 = 0, coseo1 = 0;
+	for (int ktr = 1; fabs(tem5) >= 1.0e-12 && ktr <= 10; ktr++) {
+		sineo1 = sin(eo1);
+		coseo1 = cos(eo1);
+		tem5 = 1.0 - coseo1 * axnl - sineo1 * aynl;
+		tem5 = (u - aynl * coseo1 + axnl * sineo1 - eo1) / tem5;
+		if (fabs(tem5) >= 0.95)
+			tem5 = tem5 > 0.0 ? 0.95 : -0.95;
+		eo1 = eo1 + tem5;
+	}
+	// short period preliminary quantities
+	double ecose = axnl * coseo1 + aynl * sineo1;
+	double esine = axnl * sineo1 - aynl * coseo1;
+	double el2 = axnl * axnl + aynl * aynl;
+	double pl = am * (1.0 - el2);
+	if (pl < 0.0)
+		return false;
+	double rl = am * (1.0 - ecose);
+	double rdotl = sqrt(am) * esine / rl;
+	double rvdotl = sqrt(pl) / rl;
+	double betal = sqrt(1.0 - el2);
+	temp = esine / (1.0 + betal);
+	double sinu = am / rl * (sineo1 - aynl - axnl * temp);
+	double cosu = am / rl * (coseo1 - axnl + aynl * temp);
+	double su = atan2(sinu, cosu);
+	double sin2u = (cosu + cosu) * sinu;
+	double cos2u = 1.0 - 2.0 * sinu * sinu;
+	temp = 1.0 / pl;
+	double temp1 = 0.5 * J2 * temp;
+	double temp2 = temp1 * temp;
+	// short period periodics
+	double con41 = tle->con41, x1mth2 = tle->x1mth2, x7thm1 = tle->x7thm1;
+	if (tle->deep_space) {
+		double cosisq = cosip * cosip;
+		con41 = 3.0 * cosisq - 1.0;
+		x1mth2 = 1.0 - cosisq;
+		x7thm1 = 7.0 * cosisq - 1.0;
+	}
+	double mrt = rl * (1.0 - 1.5 * temp2 * betal * con41) + 0.5 * temp1 * x1mth2 * cos2u;
+	if (mrt < 1.0)
+		return false; // decayed
+	su = su - 0.25 * temp2 * x7thm1 * sin2u;
+	double xnode = nodep + 1.5 * temp2 * cosip * sin2u;
+	double xinc = xincp + 1.5 * temp2 * cosip * sinip * cos2u;
+	double mvt = rdotl - nm * temp1 * x1mth2 * sin2u / XKE;
+	double rvdot = rvdotl + nm * temp1 * (x1mth2 * cos2u + 1.5 * con41) / XKE;
+	// orientation vectors
+	double sinsu = sin(su), cossu = cos(su), snod = sin(xnode), cnod = cos(xnode), sini = sin(xinc), cosi = cos(xinc);
+	double xmx = -snod * cosi, xmy = cnod * cosi;
+	double ux = xmx * sinsu + cnod * cossu, uy = xmy * sinsu + snod * cossu, uz = sini * sinsu;
+	double vx = xmx * cossu - cnod * sinsu, vy = xmy * cossu - snod * sinsu, vz = sini * cossu;
+	pos[0] = mrt * ux * RADIUS_EARTH_KM;
+	pos[1] = mrt * uy * RADIUS_EARTH_KM;
+	pos[2] = mrt * uz * RADIUS_EARTH_KM;
+	if (vel) {
+		vel[0] = (mvt * ux + rvdot * vx) * VKMPERSEC;
+		vel[1] = (mvt * uy + rvdot * vy) * VKMPERSEC;
+		vel[2] = (mvt * uz + rvdot * vz) * VKMPERSEC;
+	}
+	return true;
+}
+
+static bool sgp4_init(indigo_tle *tle) {
+	double epoch = tle->jd_epoch - 2433281.5;
+	double ss = 78.0 / RADIUS_EARTH_KM + 1.0;
+	double qzms2t = pow((120.0 - 78.0) / RADIUS_EARTH_KM, 4);
+	// un-Kozai mean motion
+	double ecco = tle->ecco, eccsq = ecco * ecco, omeosq = 1.0 - eccsq, rteosq = sqrt(omeosq);
+	double cosio = cos(tle->inclo), cosio2 = cosio * cosio;
+	double ak = pow(XKE / tle->no_kozai, X2O3);
+	double d1 = 0.75 * J2 * (3.0 * cosio2 - 1.0) / (rteosq * omeosq);
+	double del = d1 / (ak * ak);
+	double adel = ak * (1.0 - del * del - del * (1.0 / 3.0 + 134.0 * del * del / 81.0));
+	del = d1 / (adel * adel);
+	tle->no_unkozai = tle->no_kozai / (1.0 + del);
+	double ao = pow(XKE / tle->no_unkozai, X2O3);
+	double sinio = sin(tle->inclo);
+	double po = ao * omeosq;
+	double con42 = 1.0 - 5.0 * cosio2;
+	tle->con41 = -con42 - cosio2 - cosio2;
+	double posq = po * po;
+	double rp = ao * (1.0 - ecco);
+	tle->gsto = gstime(tle->jd_epoch);
+	if (omeosq < 0.0 && tle->no_unkozai < 0.0)
+		return false;
+	tle->simple = rp < 220.0 / RADIUS_EARTH_KM + 1.0;
+	double sfour = ss, qzms24 = qzms2t;
+	double perige = (rp - 1.0) * RADIUS_EARTH_KM;
+	// for perigees below 156 km, s and qoms2t are altered
+	if (perige < 156.0) {
+		sfour = perige < 98.0 ? 20.0 : perige - 78.0;
+		qzms24 = pow((120.0 - sfour) / RADIUS_EARTH_KM, 4);
+		sfour = sfour / RADIUS_EARTH_KM + 1.0;
+	}
+	double pinvsq = 1.0 / posq;
+	double tsi = 1.0 / (ao - sfour);
+	tle->eta = ao * ecco * tsi;
+	double etasq = tle->eta * tle->eta;
+	double eeta = ecco * tle->eta;
+	double psisq = fabs(1.0 - etasq);
+	double coef = qzms24 * pow(tsi, 4.0);
+	double coef1 = coef / pow(psisq, 3.5);
+	double cc2 = coef1 * tle->no_unkozai * (ao * (1.0 + 1.5 * etasq + eeta * (4.0 + etasq)) + 0.375 * J2 * tsi / psisq * tle->con41 * (8.0 + 3.0 * etasq * (8.0 + etasq)));
+	tle->cc1 = tle->bstar * cc2;
+	double cc3 = 0.0;
+	if (ecco > 1.0e-4)
+		cc3 = -2.0 * coef * tsi * J3OJ2 * tle->no_unkozai * sinio / ecco;
+	tle->x1mth2 = 1.0 - cosio2;
+	tle->cc4 = 2.0 * tle->no_unkozai * coef1 * ao * omeosq * (tle->eta * (2.0 + 0.5 * etasq) + ecco * (0.5 + 2.0 * etasq) - J2 * tsi / (ao * psisq) * (-3.0 * tle->con41 * (1.0 - 2.0 * eeta + etasq * (1.5 - 0.5 * eeta)) + 0.75 * tle->x1mth2 * (2.0 * etasq - eeta * (1.0 + etasq)) * cos(2.0 * tle->argpo)));
+	tle->cc5 = 2.0 * coef1 * ao * omeosq * (1.0 + 2.75 * (etasq + eeta) + eeta * etasq);
+	double cosio4 = cosio2 * cosio2;
+	double temp1 = 1.5 * J2 * pinvsq * tle->no_unkozai;
+	double temp2 = 0.5 * temp1 * J2 * pinvsq;
+	double temp3 = -0.46875 * J4 * pinvsq * pinvsq * tle->no_unkozai;
+	tle->mdot = tle->no_unkozai + 0.5 * temp1 * rteosq * tle->con41 + 0.0625 * temp2 * rteosq * (13.0 - 78.0 * cosio2 + 137.0 * cosio4);
+	tle->argpdot = -0.5 * temp1 * con42 + 0.0625 * temp2 * (7.0 - 114.0 * cosio2 + 395.0 * cosio4) + temp3 * (3.0 - 36.0 * cosio2 + 49.0 * cosio4);
+	double xhdot1 = -temp1 * cosio;
+	tle->nodedot = xhdot1 + (0.5 * temp2 * (4.0 - 19.0 * cosio2) + 2.0 * temp3 * (3.0 - 7.0 * cosio2)) * cosio;
+	double xpidot = tle->argpdot + tle->nodedot;
+	tle->omgcof = tle->bstar * cc3 * cos(tle->argpo);
+	tle->xmcof = 0.0;
+	if (ecco > 1.0e-4)
+		tle->xmcof = -X2O3 * coef * tle->bstar / eeta;
+	tle->nodecf = 3.5 * omeosq * xhdot1 * tle->cc1;
+	tle->t2cof = 1.5 * tle->cc1;
+	tle->xlcof = -0.25 * J3OJ2 * sinio * (3.0 + 5.0 * cosio) / (fabs(cosio + 1.0) > 1.5e-12 ? 1.0 + cosio : 1.5e-12);
+	tle->aycof = -0.5 * J3OJ2 * sinio;
+	double delmotemp = 1.0 + tle->eta * cos(tle->mo);
+	tle->delmo = delmotemp * delmotemp * delmotemp;
+	tle->sinmao = sin(tle->mo);
+	tle->x7thm1 = 7.0 * cosio2 - 1.0;
+	if (TWOPI / tle->no_unkozai >= 225.0) {
+		// deep space
+		dscom_terms d = { 0 };
+		tle->deep_space = true;
+		tle->simple = true;
+		double em = ecco, inclm = tle->inclo;
+		dscom(epoch, ecco, tle->argpo, 0.0, tle->inclo, tle->nodeo, tle->no_unkozai, tle, &d);
+		dsinit(tle, &d, xpidot, &em, &inclm);
+	}
+	if (!tle->simple) {
+		double cc1sq = tle->cc1 * tle->cc1;
+		tle->d2 = 4.0 * ao * tsi * cc1sq;
+		double temp = tle->d2 * tsi * tle->cc1 / 3.0;
+		tle->d3 = (17.0 * ao + sfour) * temp;
+		tle->d4 = 0.5 * temp * ao * tsi * (221.0 * ao + 31.0 * sfour) * tle->cc1;
+		tle->t3cof = tle->d2 + 2.0 * cc1sq;
+		tle->t4cof = 0.25 * (3.0 * tle->d3 + tle->cc1 * (12.0 * tle->d2 + 10.0 * cc1sq));
+		tle->t5cof = 0.2 * (3.0 * tle->d4 + 12.0 * tle->cc1 * tle->d3 + 6.0 * tle->d2 * tle->d2 + 15.0 * cc1sq * (2.0 * tle->d2 + cc1sq));
+	}
+	double pos[3];
+	return indigo_sgp4_propagate(tle, 0.0, pos, NULL);
+}
+
+// fixed column TLE fields (columns are 1-based and inclusive as in format description)
+
+static double field(const char *line, int first, int last) {
+	char buffer[32];
+	int length = (int)strlen(line), count = 0;
+	for (int i = first - 1; i < last && i < length; i++)
+		if (line[i] != ' ')
+			buffer[count++] = line[i];
+	buffer[count] = 0;
+	return atof(buffer);
+}
+
+// field with assumed leading decimal point and exponent, e.g. " 12345-3" is 0.12345e-3
+
+static double exponent_field(const char *line, int first, int last) {
+	char buffer[32];
+	int length = (int)strlen(line), count = 0;
+	for (int i = first - 1; i < last && i < length; i++) {
+		char c = line[i];
+		if (c == ' ')
+			continue;
+		if ((c == '-' || c == '+') && count > 0 && isdigit(buffer[count - 1]))
+			buffer[count++] = 'e';
+		else if (isdigit(c) && (count == 0 || (count == 1 && (buffer[0] == '-' || buffer[0] == '+'))))
+			buffer[count++] = '.';
+		buffer[count++] = c;
+	}
+	buffer[count] = 0;
+	return atof(buffer);
+}
+
+bool indigo_tle_parse(const char *text, indigo_tle *tle) {
+	char lines[3][80];
+	int count = 0;
+	const char *cursor = text;
+	memset(tle, 0, sizeof(indigo_tle));
+	while (*cursor && count < 3) {
+		const char *end = cursor;
+		while (*end && *end != '\n' && *end != '\r')
+			end++;
+		int length = (int)(end - cursor);
+		while (length > 0 && isspace(cursor[length - 1]))
+			length--;
+		if (length > 0) {
+			if (length > 79)
+				length = 79;
+			strncpy(lines[count], cursor, length);
+			lines[count++][length] = 0;
+		}
+		cursor = *end ? end + 1 : end;
+	}
+	if (count < 2)
+		return false;
+	const char *line1 = lines[count - 2], *line2 = lines[count - 1];
+	if (line1[0] != '1' || line2[0] != '2' || strlen(line1) < 61 || strlen(line2) < 63)
+		return false;
+	tle->number = (int)field(line1, 3, 7);
+	if (count == 3) {
+		const char *name = lines[0];
+		if (name[0] == '0' && name[1] == ' ')
+			name += 2;
+		strncpy(tle->name, name, INDIGO_SGP4_NAME_SIZE - 1);
+		tle->name[INDIGO_SGP4_NAME_SIZE - 1] = 0;
+	} else {
+		snprintf(tle->name, INDIGO_SGP4_NAME_SIZE, "%05d", tle->number);
+	}
+	int year = (int)field(line1, 19, 20);
+	double days = field(line1, 21, 32);
+	year += year < 57 ? 2000 : 1900;
+	int y = year - 1;
+	double days_since_1970 = 365.0 * (year - 1970) + (y / 4 - y / 100 + y / 400) - (1969 / 4 - 1969 / 100 + 1969 / 400);
+	tle->epoch = (days_since_1970 + days - 1.0) * 86400.0;
+	tle->jd_epoch = tle->epoch / 86400.0 + 2440587.5;
+	double xpdotp = 1440.0 / TWOPI;
+	tle->ndot = field(line1, 34, 43) / (xpdotp * 1440.0);
+	tle->nddot = exponent_field(line1, 45, 52) / (xpdotp * 1440.0 * 1440.0);
+	tle->bstar = exponent_field(line1, 54, 61);
+	tle->inclo = field(line2, 9, 16) * PI / 180.0;
+	tle->nodeo = field(line2, 18, 25) * PI / 180.0;
+	tle->ecco = exponent_field(line2, 27, 33);
+	tle->argpo = field(line2, 35, 42) * PI / 180.0;
+	tle->mo = field(line2, 44, 51) * PI / 180.0;
+	tle->no_kozai = field(line2, 53, 63) / xpdotp;
+	if (tle->no_kozai <= 0 || tle->ecco >= 1.0)
+		return false;
+	if (!sgp4_init(tle)) {
+		indigo_error("Failed to initialize SGP4 for %s", tle->name);
+		return false;
+	}
+	return true;
+}
+
+// observer in Earth fixed frame
+
+typedef struct {
+	double sin_lat, cos_lat, sin_lon, cos_lon;
+	double pos[3];
+} observer;
+
+static void observer_init(observer *site, double latitude, double longitude, double elevation) {
+	double lat = latitude * PI / 180.0, lon = longitude * PI / 180.0, h = elevation / 1000.0;
+	double e2 = WGS84_F * (2.0 - WGS84_F);
+	site->sin_lat = sin(lat);
+	site->cos_lat = cos(lat);
+	site->sin_lon = sin(lon);
+	site->cos_lon = cos(lon);
+	double n = WGS84_A / sqrt(1.0 - e2 * site->sin_lat * site->sin_lat);
+	site->pos[0] = (n + h) * site->cos_lat * site->cos_lon;
+	site->pos[1] = (n + h) * site->cos_lat * site->sin_lon;
+	site->pos[2] = (n * (1.0 - e2) + h) * site->sin_lat;
+}
+
+static inline double utc_gmst(double utc) {
+	return gstime(utc / 86400.0 + 2440587.5 + DELTA_UTC_UT1);
+}
+
+// TEME position to topocentric vector in TEME (rho) and horizontal coordinates
+
+static bool topocentric(const indigo_tle *tle, double utc, double sin_gmst, double cos_gmst, const observer *site, double *rho, double *alt, double *az) {
+	double pos[3];
+	if (!indigo_sgp4_propagate(tle, (utc - tle->epoch) / 60.0, pos, NULL))
+		return false;
+	// TEME to Earth fixed frame, polar motion is ignored
+	double x = cos_gmst * pos[0] + sin_gmst * pos[1] - site->pos[0];
+	double y = -sin_gmst * pos[0] + cos_gmst * pos[1] - site->pos[1];
+	double z = pos[2] - site->pos[2];
+	if (rho) {
+		rho[0] = cos_gmst * x - sin_gmst * y;
+		rho[1] = sin_gmst * x + cos_gmst * y;
+		rho[2] = z;
+	}
+	double e = -site->sin_lon * x + site->cos_lon * y;
+	double n = -site->sin_lat * site->cos_lon * x - site->sin_lat * site->sin_lon * y + site->cos_lat * z;
+	double u = site->cos_lat * site->cos_lon * x + site->cos_lat * site->sin_lon * y + site->sin_lat * z;
+	*alt = atan2(u, sqrt(e * e + n * n)) * 180.0 / PI;
+	if (az) {
+		double a = atan2(e, n) * 180.0 / PI;
+		*az = a < 0 ? a + 360.0 : a;
+	}
+	return true;
+}
+
+bool indigo_sgp4_observe(int count, const indigo_tle *tle, double utc, double latitude, double longitude, double elevation, double *ra, double *dec, double *alt, double *az, double *range) {
+	observer site;
+	observer_init(&site, latitude, longitude, elevation);
+	double gmst = utc_gmst(utc), sin_gmst = sin(gmst), cos_gmst = cos(gmst);
+	bool result = true;
+	for (int i = 0; i < count; i++) {
+		double rho[3], h, a;
+		if (!topocentric(tle + i, utc, sin_gmst, cos_gmst, &site, rho, &h, &a)) {
+			result = false;
+			continue;
+		}
+		double r = sqrt(rho[0] * rho[0] + rho[1] * rho[1] + rho[2] * rho[2]);
+		if (ra) {
+			double x = atan2(rho[1], rho[0]) * 12.0 / PI;
+			ra[i] = x < 0 ? x + 24.0 : x;
+		}
+		if (dec)
+			dec[i] = asin(rho[2] / r) * 180.0 / PI;
+		if (alt)
+			alt[i] = h;
+		if (az)
+			az[i] = a;
+		if (range)
+			range[i] = r;
+	}
+	return result;
+}
+
+static double altitude(const indigo_tle *tle, double utc, const observer *site, double *az) {
+	double gmst = utc_gmst(utc), alt;
+	if (!topocentric(tle, utc, sin(gmst), cos(gmst), site, NULL, &alt, az))
+		return -90.0;
+	return alt;
+}
+
+// bisect crossing of min_altitude between time below (or above if rising is false) and time above
+
+static double crossing(const indigo_tle *tle, double a, double b, bool rising, const observer *site, double min_altitude) {
+	while (b - a > PASS_PRECISION) {
+		double m = (a + b) / 2;
+		if ((altitude(tle, m, site, NULL) >= min_altitude) == rising)
+			b = m;
+		else
+			a = m;
+	}
+	return rising ? b : a;
+}
+
+static int compare_passes(const void *a, const void *b) {
+	double d = ((const indigo_sgp4_pass *)a)->rise - ((const indigo_sgp4_pass *)b)->rise;
+	return d < 0 ? -1 : d > 0 ? 1 : 0;
+}
+
+int indigo_sgp4_passes(int count, const indigo_tle *tle, double start, double end, double latitude, double longitude, double elevation, double min_altitude, indigo_sgp4_pass *passes, int max) {
+	if (count <= 0 || max <= 0 || end <= start)
+		return 0;
+	observer site;
+	observer_init(&site, latitude, longitude, elevation);
+	double *previous = malloc(count * sizeof(double));
+	double *rise = malloc(count * sizeof(double));
+	int found = 0, size = max;
+	indigo_sgp4_pass *list = malloc(size * sizeof(indigo_sgp4_pass));
+	if (previous == NULL || rise == NULL || list == NULL) {
+		free(previous);
+		free(rise);
+		free(list);
+		return 0;
+	}
+	for (double t = start, last = start; last < end; t += PASS_STEP) {
+		if (t > end)
+			t = end;
+		double gmst = utc_gmst(t), sin_gmst = sin(gmst), cos_gmst = cos(gmst);
+		// all satellites are evaluated for the same sample, pass boundaries are refined individually
+		for (int i = 0; i < count; i++) {
+			double alt;
+			if (!topocentric(tle + i, t, sin_gmst, cos_gmst, &site, NULL, &alt, NULL))
+				alt = -90.0;
+			bool up = alt >= min_altitude;
+			if (t == start) {
+				rise[i] = up ? start : -1;
+			} else if (up && previous[i] < min_altitude) {
+				rise[i] = crossing(tle + i, last, t, true, &site, min_altitude);
+			}
+			bool finished = !up && previous[i] >= min_altitude && t != start;
+			if ((finished || (up && t >= end)) && rise[i] >= 0) {
+				double set = finished ? crossing(tle + i, last, t, false, &site, min_altitude) : end;
+				// golden section search for culmination
+				double a = rise[i], b = set, r = (sqrt(5.0) - 1) / 2;
+				double c = b - r * (b - a), d = a + r * (b - a);
+				double fc = altitude(tle + i, c, &site, NULL), fd = altitude(tle + i, d, &site, NULL);
+				while (b - a > PASS_PRECISION) {
+					if (fc > fd) {
+						b = d; d = c; fd = fc;
+						c = b - r * (b - a);
+						fc = altitude(tle + i, c, &site, NULL);
+					} else {
+						a = c; c = d; fc = fd;
+						d = a + r * (b - a);
+						fd = altitude(tle + i, d, &site, NULL);
+					}
+				}
+				if (found == size) {
+					indigo_sgp4_pass *tmp = realloc(list, (size *= 2) * sizeof(indigo_sgp4_pass));
+					if (tmp == NULL)
+						break;
+					list = tmp;
+				}
+				indigo_sgp4_pass *pass = list + found++;
+				pass->satellite = i;
+				pass->rise = rise[i];
+				pass->set = set;
+				pass->culmination = (a + b) / 2;
+				pass->max_altitude = altitude(tle + i, pass->culmination, &site, NULL);
+				altitude(tle + i, pass->rise, &site, &pass->rise_azimuth);
+				altitude(tle + i, pass->set, &site, &pass->set_azimuth);
+				rise[i] = -1;
+			}
+			previous[i] = alt;
+		}
+		last = t;
+	}
+	qsort(list, found, sizeof(indigo_sgp4_pass), compare_passes);
+	if (found > max)
+		found = max;
+	memcpy(passes, list, found * sizeof(indigo_sgp4_pass));
+	free(previous);
+	free(rise);
+	free(list);
+	return found;
+}
@@ -0,0 +1,224 @@
+// Copyright (c) 2020 CloudMakers, s. r. o.
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// version history
+// 2.0 by Peter Polakovic <peter.polakovic@cloudmakers.eu>
+
+/** INDIGO HEALPix sky index shared by catalogue queries and plate solver
+ \file indigo_sky_index.c
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <indigo/indigo_sky_index.h>
+
+typedef struct {
+	float mag;
+	int entry;
+} sort_item;
+
+void indigo_sky_vector(double ra, double dec, double v[3]) {
+	double cos_dec = cos(dec);
+	v[0] = cos_dec * cos(ra);
+	v[1] = cos_dec * sin(ra);
+	v[2] = sin(dec);
+}
+
+static int ang2pix(int nside, double z, double phi) {
+	int npix = 12 * nside * nside, ncap = 2 * nside * (nside - 1);
+	double za = fabs(z);
+	double tt = fmod(phi / M_PI_2, 4.0);
+	if (tt < 0)
+		tt += 4.0;
+	if (za <= 2.0 / 3.0) {
+		double temp1 = nside * (0.5 + tt);
+		double temp2 = nside * z * 0.75;
+		int jp = (int)(temp1 - temp2);
+		int jm = (int)(temp1 + temp2);
+		int ir = nside + 1 + jp - jm;
+		int kshift = 1 - (ir & 1);
+		int ip = (jp + jm - nside + kshift + 1) / 2;
+		ip = ((ip % (4 * nside)) + 4 * nside) % (4 * nside);
+		return ncap + (ir - 1) * 4 * nside + ip;
+	}
+	double tp = tt - (int)tt;
+	double tmp = nside * sqrt(3 * (1 - za));
+	int jp = (int)(tp * tmp);
+	int jm = (int)((1.0 - tp) * tmp);
+	int ir = jp + jm + 1;
+	int ip = (int)(tt * ir);
+	ip = ((ip % (4 * ir)) + 4 * ir) % (4 * ir);
+	if (z > 0)
+		return 2 * ir * (ir - 1) + ip;
+	return npix - 2 * ir * (ir + 1) + ip;
+}
+
+static void ring_info(int nside, int ring, int *start, int *count, double *z, double *offset) {
+	if (ring < nside) {
+		*start = 2 * ring * (ring - 1);
+		*count = 4 * ring;
+		*z = 1.0 - ring * ring / (3.0 * nside * nside);
+		*offset = 0.5;
+	} else if (ring <= 3 * nside) {
+		*start = 2 * nside * (nside - 1) + (ring - nside) * 4 * nside;
+		*count = 4 * nside;
+		*z = (2 * nside - ring) * 2.0 / (3.0 * nside);
+		*offset = ((ring - nside) & 1) ? 0 : 0.5;
+	} else {
+		int south = 4 * nside - ring;
+		*start = 12 * nside * nside - 2 * south * (south + 1);
+		*count = 4 * south;
+		*z = -(1.0 - south * south / (3.0 * nside * nside));
+		*offset = 0.5;
+	}
+}
+
+static double angle_between(const double a[3], const double b[3]) {
+	double c[3] = { a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0] };
+	return atan2(sqrt(c[0] * c[0] + c[1] * c[1] + c[2] * c[2]), a[0] * b[0] + a[1] * b[1] + a[2] * b[2]);
+}
+
+static double max_pixrad(int nside) {
+	// max distance of pixel corner from its centre (HEALPix healpix_base::max_pixrad)
+	double va[3], vb[3];
+	double t1 = 1.0 - 1.0 / nside;
+	t1 *= t1;
+	double za = 2.0 / 3.0, zb = 1.0 - t1 / 3.0;
+	va[0] = sqrt(1 - za * za) * cos(M_PI / (4 * nside));
+	va[1] = sqrt(1 - za * za) * sin(M_PI / (4 * nside));
+	va[2] = za;
+	vb[0] = sqrt(1 - zb * zb);
+	vb[1] = 0;
+	vb[2] = zb;
+	return angle_between(va, vb);
+}
+
+static int compare_items(const void *a, const void *b) {
+	const sort_item *ia = a, *ib = b;
+	if (ia->mag != ib->mag)
+		return ia->mag < ib->mag ? -1 : 1;
+	return ia->entry - ib->entry;
+}
+
+bool indigo_sky_index_build(indigo_sky_index *index, int nside, int count, const double (*vectors)[3], const float *mags) {
+	int npix = 12 * nside * nside;
+	memset(index, 0, sizeof(indigo_sky_index));
+	index->nside = nside;
+	index->count = count;
+	index->max_pixrad = max_pixrad(nside);
+	index->start = calloc(npix + 1, sizeof(int));
+	index->entries = malloc((count + 1) * sizeof(int));
+	index->vectors = malloc((count + 1) * sizeof(double[3]));
+	index->mags = malloc((count + 1) * sizeof(float));
+	int *pixels = malloc((count + 1) * sizeof(int));
+	sort_item *items = malloc((count + 1) * sizeof(sort_item));
+	int *fill = malloc(npix * sizeof(int));
+	if (index->start == NULL || index->entries == NULL || index->vectors == NULL || index->mags == NULL || pixels == NULL || items == NULL || fill == NULL) {
+		free(pixels);
+		free(items);
+		free(fill);
+		indigo_sky_index_release(index);
+		return false;
+	}
+	memcpy(index->vectors, vectors, count * sizeof(double[3]));
+	memcpy(index->mags, mags, count * sizeof(float));
+	for (int i = 0; i < count; i++) {
+		pixels[i] = ang2pix(nside, vectors[i][2], atan2(vectors[i][1], vectors[i][0]));
+		index->start[pixels[i] + 1]++;
+		items[i].mag = mags[i];
+		items[i].entry = i;
+	}
+	for (int p = 0; p < npix; p++)
+		index->start[p + 1] += index->start[p];
+	// filling pixels in magnitude order keeps entries of each pixel sorted
+	qsort(items, count, sizeof(sort_item), compare_items);
+	memcpy(fill, index->start, npix * sizeof(int));
+	for (int i = 0; i < count; i++)
+		index->entries[fill[pixels[items[i].entry]]++] = items[i].entry;
+	free(fill);
+	free(items);
+	free(pixels);
+	return true;
+}
+
+void indigo_sky_index_release(indigo_sky_index *index) {
+	free(index->start);
+	free(index->entries);
+	free(index->vectors);
+	free(index->mags);
+	memset(index, 0, sizeof(indigo_sky_index));
+}
+
+int indigo_sky_index_search(const indigo_sky_index *index, const double center[3], double radius, double max_mag, int **result, int *size) {
+	if (index->start == NULL)
+		return 0;
+	int nside = index->nside;
+	double ra0 = atan2(center[1], center[0]), theta0 = acos(fmax(-1, fmin(1, center[2])));
+	double margin = radius + index->max_pixrad;
+	double cos_margin = cos(margin), cos_radius = cos(radius);
+	int found = 0;
+	for (int ring = 1; ring <= 4 * nside - 1; ring++) {
+		int start, count;
+		double z, offset;
+		ring_info(nside, ring, &start, &count, &z, &offset);
+		double theta = acos(z);
+		if (fabs(theta - theta0) > margin)
+			continue;
+		// pixel centres on this ring within margin of cone centre
+		double sin_prod = sin(theta) * sin(theta0);
+		double dphi = M_PI;
+		if (sin_prod > 1e-12) {
+			double x = (cos_margin - z * cos(theta0)) / sin_prod;
+			if (x <= -1)
+				dphi = M_PI;
+			else if (x >= 1)
+				dphi = 0;
+			else
+				dphi = acos(x);
+		}
+		int first = 0, last = count - 1;
+		if (dphi < M_PI) {
+			double step = 2 * M_PI / count;
+			first = (int)floor((ra0 - dphi) / step - offset);
+			last = (int)ceil((ra0 + dphi) / step - offset);
+			if (last - first + 1 > count) {
+				first = 0;
+				last = count - 1;
+			}
+		}
+		for (int j = first; j <= last; j++) {
+			int pixel = start + ((j % count) + count) % count;
+			for (int k = index->start[pixel]; k < index->start[pixel + 1]; k++) {
+				int entry = index->entries[k];
+				if (index->mags[entry] > max_mag)
+					break;
+				const double *v = index->vectors[entry];
+				if (v[0] * center[0] + v[1] * center[1] + v[2] * center[2] >= cos_radius) {
+					if (found == *size) {
+						*size = *size ? 2 * *size : 256;
+						*result = realloc(*result, *size * sizeof(int));
+					}
+					(*result)[found++] = entry;
+				}
+			}
+		}
+	}
+	return found;
+}
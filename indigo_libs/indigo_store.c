@@ -0,0 +1,550 @@
+// Copyright (c) 2020 CloudMakers, s. r. o.
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// version history
+// 2.0 by Peter Polakovic <peter.polakovic@cloudmakers.eu>
+
+/** INDIGO record store
+ \file indigo_store.c
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <limits.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <assert.h>
+#include <libgen.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#if !defined(INDIGO_WINDOWS)
+#include <sys/mman.h>
+#endif
+
+#include <indigo/indigo_bus.h>
+#include <indigo/indigo_store.h>
+
+// file starts with magic, version and header checksum, it is followed by records aligned to 4 bytes
+// record header is followed by key and value, checksum covers header (except checksum itself), key and value
+
+#define STORE_MAGIC						"INDIGOST"
+#define STORE_HEADER_SIZE			16
+#define RECORD_MAGIC					0x52444e49	// "INDR"
+#define RECORD_PUT						1
+#define RECORD_REMOVE					2
+#define RECORD_MAX_LENGTH			(64 * 1024 * 1024)
+#define RECORD_KEY_SIZE				(INDIGO_NAME_SIZE * 2)
+#define COMPACT_MIN_LENGTH		4096
+
+typedef struct {
+	uint32_t magic;
+	uint16_t type;
+	uint16_t reserved;
+	uint32_t key_length;
+	uint32_t value_length;
+	uint32_t checksum;
+} record_header;
+
+typedef struct {
+	char *key;
+	void *value;
+	int length;
+} store_entry;
+
+struct indigo_store {
+	char path[PATH_MAX];
+	int handle;
+	long length;
+	long live_length;
+	int count;
+	int size;
+	store_entry *entries;
+	int *hash;
+	int hash_size;
+};
+
+//  Records appended to handle returned by indigo_store_begin() are collected in memory until indigo_store_commit()
+
+typedef struct store_batch {
+	int handle;
+	char path[PATH_MAX];
+	uint8_t *buffer;
+	long length;
+	long size;
+	struct store_batch *next;
+} store_batch;
+
+static store_batch *batches = NULL;
+static pthread_mutex_t batches_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static uint32_t crc_table[256];
+static pthread_once_t crc_once = PTHREAD_ONCE_INIT;
+
+static void crc_init(void) {
+	for (uint32_t i = 0; i < 256; i++) {
+		uint32_t c = i;
+		for (int j = 0; j < 8; j++)
+			c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+		crc_table[i] = c;
+	}
+}
+
+static uint32_t crc_update(uint32_t crc, const void *data, long length) {
+	const uint8_t *bytes = data;
+	crc = ~crc;
+	for (long i = 0; i < length; i++)
+		crc = crc_table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+	return ~crc;
+}
+
+static long record_length(long key_length, long value_length) {
+	return (sizeof(record_header) + key_length + value_length + 3) & ~3L;
+}
+
+static uint32_t record_checksum(record_header *header, const void *key, const void *value) {
+	pthread_once(&crc_once, crc_init);
+	uint32_t crc = crc_update(0, header, offsetof(record_header, checksum));
+	crc = crc_update(crc, key, header->key_length);
+	return crc_update(crc, value, header->value_length);
+}
+
+static void store_header(uint8_t *buffer) {
+	pthread_once(&crc_once, crc_init);
+	uint32_t version = INDIGO_STORE_VERSION;
+	memcpy(buffer, STORE_MAGIC, 8);
+	memcpy(buffer + 8, &version, 4);
+	uint32_t crc = crc_update(0, buffer, 12);
+	memcpy(buffer + 12, &crc, 4);
+}
+
+static bool write_fully(int handle, const void *buffer, long length) {
+	const uint8_t *bytes = buffer;
+	while (length > 0) {
+		long written = write(handle, bytes, length);
+		if (written < 0) {
+			if (errno == EINTR)
+				continue;
+			return false;
+		}
+		bytes += written;
+		length -= written;
+	}
+	return true;
+}
+
+static long build_record(uint8_t **buffer, int type, const char *key, const void *value, int length) {
+	record_header header = { RECORD_MAGIC, type, 0, (uint32_t)strlen(key), (uint32_t)length, 0 };
+	header.checksum = record_checksum(&header, key, value);
+	long size = record_length(header.key_length, header.value_length);
+	*buffer = calloc(1, size);
+	assert(*buffer != NULL);
+	memcpy(*buffer, &header, sizeof(header));
+	memcpy(*buffer + sizeof(header), key, header.key_length);
+	if (length > 0)
+		memcpy(*buffer + sizeof(header) + header.key_length, value, length);
+	return size;
+}
+
+//  Records refused by parse_records() would hide all records appended after them
+
+static bool valid_record(const char *key, int length) {
+	size_t key_length = strlen(key);
+	if (key_length > 0 && key_length < RECORD_KEY_SIZE && length >= 0 && length <= RECORD_MAX_LENGTH)
+		return true;
+	INDIGO_ERROR(indigo_error("Can't store record '%.*s' (key length %ld, value length %d)", INDIGO_NAME_SIZE, key, (long)key_length, length));
+	return false;
+}
+
+//  Record is written by single write and flushed, failed write is truncated so that following records are not hidden behind torn one
+
+static bool append_record(int handle, int type, const char *key, const void *value, int length) {
+	if (!valid_record(key, length))
+		return false;
+	struct stat st;
+	if (fstat(handle, &st) < 0)
+		return false;
+	uint8_t *buffer;
+	long size = build_record(&buffer, type, key, value, length);
+	bool result = write_fully(handle, buffer, size) && fsync(handle) == 0;
+	free(buffer);
+	if (!result) {
+		INDIGO_ERROR(indigo_error("Can't append record '%s' (%s)", key, strerror(errno)));
+		if (ftruncate(handle, st.st_size) < 0)
+			INDIGO_ERROR(indigo_error("Can't truncate store (%s)", strerror(errno)));
+	}
+	return result;
+}
+
+//  Entries keep order of first put, they are indexed by open addressing hash table of entry indices with at least twice as many slots
+
+static uint32_t key_hash(const char *key) {
+	uint32_t hash = 2166136261u;
+	while (*key)
+		hash = (hash ^ (uint8_t)*key++) * 16777619u;
+	return hash;
+}
+
+static void hash_entry(indigo_store *store, int index) {
+	uint32_t mask = store->hash_size - 1;
+	uint32_t slot = key_hash(store->entries[index].key) & mask;
+	while (store->hash[slot] >= 0)
+		slot = (slot + 1) & mask;
+	store->hash[slot] = index;
+}
+
+static void rebuild_hash(indigo_store *store) {
+	if (store->hash_size < 2 * store->size) {
+		store->hash_size = 2 * store->size;
+		store->hash = realloc(store->hash, store->hash_size * sizeof(int));
+		assert(store->hash != NULL);
+	}
+	memset(store->hash, 0xFF, store->hash_size * sizeof(int));
+	for (int i = 0; i < store->count; i++)
+		hash_entry(store, i);
+}
+
+static int find_entry(indigo_store *store, const char *key) {
+	if (store->hash_size == 0)
+		return -1;
+	uint32_t mask = store->hash_size - 1;
+	for (uint32_t slot = key_hash(key) & mask; store->hash[slot] >= 0; slot = (slot + 1) & mask)
+		if (!strcmp(store->entries[store->hash[slot]].key, key))
+			return store->hash[slot];
+	return -1;
+}
+
+static void remove_entry(indigo_store *store, int index) {
+	store_entry *entry = store->entries + index;
+	store->live_length -= record_length(strlen(entry->key), entry->length);
+	free(entry->key);
+	free(entry->value);
+	memmove(entry, entry + 1, (store->count - index - 1) * sizeof(store_entry));
+	store->count--;
+	rebuild_hash(store);
+}
+
+static void set_entry(indigo_store *store, const char *key, const void *value, int length) {
+	int index = find_entry(store, key);
+	store_entry *entry;
+	if (index >= 0) {
+		entry = store->entries + index;
+		store->live_length -= record_length(strlen(key), entry->length);
+		free(entry->value);
+	} else {
+		if (store->count == store->size) {
+			store->size = store->size ? 2 * store->size : 16;
+			store->entries = realloc(store->entries, store->size * sizeof(store_entry));
+			assert(store->entries != NULL);
+		}
+		index = store->count++;
+		entry = store->entries + index;
+		entry->key = strdup(key);
+		assert(entry->key != NULL);
+		if (store->hash_size < 2 * store->size)
+			rebuild_hash(store);
+		else
+			hash_entry(store, index);
+	}
+	entry->value = malloc(length + 1);
+	assert(entry->value != NULL);
+	memcpy(entry->value, value, length);
+	((char *)entry->value)[length] = 0;
+	entry->length = length;
+	store->live_length += record_length(strlen(key), length);
+}
+
+//  Returns length of valid prefix
+
+static long parse_records(indigo_store *store, const uint8_t *data, long size) {
+	long offset = STORE_HEADER_SIZE;
+	char key[RECORD_KEY_SIZE];
+	while (offset + (long)sizeof(record_header) <= size) {
+		record_header header;
+		memcpy(&header, data + offset, sizeof(header));
+		if (header.magic != RECORD_MAGIC || header.key_length == 0 || header.key_length >= sizeof(key) || header.value_length > RECORD_MAX_LENGTH)
+			break;
+		long length = record_length(header.key_length, header.value_length);
+		if (offset + length > size)
+			break;
+		const uint8_t *key_data = data + offset + sizeof(header);
+		const uint8_t *value_data = key_data + header.key_length;
+		if (record_checksum(&header, key_data, value_data) != header.checksum)
+			break;
+		memcpy(key, key_data, header.key_length);
+		key[header.key_length] = 0;
+		if (header.type == RECORD_PUT) {
+			set_entry(store, key, value_data, header.value_length);
+		} else if (header.type == RECORD_REMOVE) {
+			int index = find_entry(store, key);
+			if (index >= 0)
+				remove_entry(store, index);
+		}
+		offset += length;
+	}
+	return offset;
+}
+
+static bool load_records(indigo_store *store, long size) {
+	uint8_t header[STORE_HEADER_SIZE];
+	store_header(header);
+#if defined(INDIGO_WINDOWS)
+	uint8_t *data = malloc(size);
+	assert(data != NULL);
+	if (lseek(store->handle, 0, SEEK_SET) < 0 || read(store->handle, data, size) != size) {
+		free(data);
+		return false;
+	}
+#else
+	uint8_t *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, store->handle, 0);
+	if (data == MAP_FAILED)
+		return false;
+#endif
+	bool valid = memcmp(data, header, STORE_HEADER_SIZE) == 0;
+	if (valid)
+		store->length = parse_records(store, data, size);
+#if defined(INDIGO_WINDOWS)
+	free(data);
+#else
+	munmap(data, size);
+#endif
+	return valid;
+}
+
+static bool sync_directory(const char *path) {
+	char buffer[PATH_MAX];
+	strncpy(buffer, path, sizeof(buffer) - 1);
+	buffer[sizeof(buffer) - 1] = 0;
+	int handle = open(dirname(buffer), O_RDONLY);
+	if (handle < 0)
+		return false;
+	bool result = fsync(handle) == 0;
+	close(handle);
+	return result;
+}
+
+indigo_store *indigo_store_open(const char *path, bool create) {
+	int handle = open(path, O_RDWR | O_APPEND | (create ? O_CREAT : 0), 0644);
+	if (handle < 0) {
+		if (create || errno != ENOENT)
+			INDIGO_DEBUG(indigo_debug("Can't open %s (%s)", path, strerror(errno)));
+		return NULL;
+	}
+	indigo_store *store = calloc(1, sizeof(indigo_store));
+	assert(store != NULL);
+	strncpy(store->path, path, sizeof(store->path) - 1);
+	store->handle = handle;
+	store->length = store->live_length = STORE_HEADER_SIZE;
+	struct stat st;
+	if (fstat(handle, &st) < 0) {
+		indigo_store_close(store);
+		return NULL;
+	}
+	if (st.st_size < STORE_HEADER_SIZE) {
+		//  New file or file torn before header was written
+		uint8_t header[STORE_HEADER_SIZE];
+		store_header(header);
+		if (ftruncate(handle, 0) < 0 || !write_fully(handle, header, STORE_HEADER_SIZE) || fsync(handle) < 0) {
+			INDIGO_ERROR(indigo_error("Can't initialize %s (%s)", path, strerror(errno)));
+			indigo_store_close(store);
+			return NULL;
+		}
+		sync_directory(path);
+	} else if (!load_records(store, st.st_size)) {
+		INDIGO_ERROR(indigo_error("%s is not valid store version %d", path, INDIGO_STORE_VERSION));
+		indigo_store_close(store);
+		return NULL;
+	} else if (store->length < st.st_size) {
+		INDIGO_ERROR(indigo_error("%s: dropping %ld bytes of incomplete or corrupted records", path, st.st_size - store->length));
+		if (ftruncate(handle, store->length) < 0 || fsync(handle) < 0)
+			INDIGO_ERROR(indigo_error("Can't truncate %s (%s)", path, strerror(errno)));
+	}
+	if (store->length > COMPACT_MIN_LENGTH && store->length > 2 * store->live_length)
+		indigo_store_compact(store);
+	return store;
+}
+
+int indigo_store_count(indigo_store *store) {
+	return store->count;
+}
+
+const char *indigo_store_key(indigo_store *store, int index) {
+	if (index < 0 || index >= store->count)
+		return NULL;
+	return store->entries[index].key;
+}
+
+const void *indigo_store_value(indigo_store *store, int index, int *length) {
+	if (index < 0 || index >= store->count)
+		return NULL;
+	if (length)
+		*length = store->entries[index].length;
+	return store->entries[index].value;
+}
+
+const void *indigo_store_get(indigo_store *store, const char *key, int *length) {
+	return indigo_store_value(store, find_entry(store, key), length);
+}
+
+bool indigo_store_put(indigo_store *store, const char *key, const void *value, int length) {
+	if (!append_record(store->handle, RECORD_PUT, key, value, length))
+		return false;
+	store->length += record_length(strlen(key), length);
+	set_entry(store, key, value, length);
+	return true;
+}
+
+bool indigo_store_remove(indigo_store *store, const char *key) {
+	int index = find_entry(store, key);
+	if (index < 0)
+		return true;
+	if (!append_record(store->handle, RECORD_REMOVE, key, NULL, 0))
+		return false;
+	store->length += record_length(strlen(key), 0);
+	remove_entry(store, index);
+	return true;
+}
+
+bool indigo_store_compact(indigo_store *store) {
+	char path[PATH_MAX + 8];
+	snprintf(path, sizeof(path), "%s.tmp", store->path);
+	int handle = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (handle < 0) {
+		INDIGO_ERROR(indigo_error("Can't create %s (%s)", path, strerror(errno)));
+		return false;
+	}
+	uint8_t header[STORE_HEADER_SIZE];
+	store_header(header);
+	bool result = write_fully(handle, header, STORE_HEADER_SIZE);
+	for (int i = 0; result && i < store->count; i++) {
+		uint8_t *buffer;
+		long size = build_record(&buffer, RECORD_PUT, store->entries[i].key, store->entries[i].value, store->entries[i].length);
+		result = write_fully(handle, buffer, size);
+		free(buffer);
+	}
+	result = result && fsync(handle) == 0;
+	close(handle);
+	if (result && rename(path, store->path) == 0) {
+		sync_directory(store->path);
+		handle = open(store->path, O_RDWR | O_APPEND);
+		if (handle >= 0) {
+			INDIGO_DEBUG(indigo_debug("%s compacted from %ld to %ld bytes", store->path, store->length, store->live_length));
+			close(store->handle);
+			store->handle = handle;
+			store->length = store->live_length;
+			return true;
+		}
+	}
+	INDIGO_ERROR(indigo_error("Can't compact %s (%s)", store->path, strerror(errno)));
+	unlink(path);
+	return false;
+}
+
+int indigo_store_begin(const char *path) {
+	store_batch *batch = calloc(1, sizeof(store_batch));
+	assert(batch != NULL);
+	strncpy(batch->path, path, sizeof(batch->path) - 1);
+	char tmp_path[PATH_MAX + 8];
+	snprintf(tmp_path, sizeof(tmp_path), "%s.save", path);
+	batch->handle = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (batch->handle < 0) {
+		INDIGO_ERROR(indigo_error("Can't create %s (%s)", tmp_path, strerror(errno)));
+		free(batch);
+		return -1;
+	}
+	batch->size = COMPACT_MIN_LENGTH;
+	batch->buffer = malloc(batch->size);
+	assert(batch->buffer != NULL);
+	store_header(batch->buffer);
+	batch->length = STORE_HEADER_SIZE;
+	pthread_mutex_lock(&batches_mutex);
+	batch->next = batches;
+	batches = batch;
+	pthread_mutex_unlock(&batches_mutex);
+	return batch->handle;
+}
+
+static store_batch *find_batch(int handle, bool unlink_batch) {
+	pthread_mutex_lock(&batches_mutex);
+	store_batch **pnt = &batches;
+	while (*pnt != NULL && (*pnt)->handle != handle)
+		pnt = &(*pnt)->next;
+	store_batch *batch = *pnt;
+	if (batch != NULL && unlink_batch)
+		*pnt = batch->next;
+	pthread_mutex_unlock(&batches_mutex);
+	return batch;
+}
+
+bool indigo_store_append(int handle, const char *key, const void *value, int length) {
+	if (!valid_record(key, length))
+		return false;
+	store_batch *batch = find_batch(handle, false);
+	if (batch == NULL)
+		return false;
+	uint8_t *buffer;
+	long size = build_record(&buffer, RECORD_PUT, key, value, length);
+	if (batch->length + size > batch->size) {
+		while (batch->length + size > batch->size)
+			batch->size *= 2;
+		batch->buffer = realloc(batch->buffer, batch->size);
+		assert(batch->buffer != NULL);
+	}
+	memcpy(batch->buffer + batch->length, buffer, size);
+	batch->length += size;
+	free(buffer);
+	return true;
+}
+
+bool indigo_store_commit(int handle) {
+	store_batch *batch = find_batch(handle, true);
+	if (batch == NULL)
+		return false;
+	char tmp_path[PATH_MAX + 8];
+	snprintf(tmp_path, sizeof(tmp_path), "%s.save", batch->path);
+	bool result = write_fully(batch->handle, batch->buffer, batch->length) && fsync(batch->handle) == 0;
+	close(batch->handle);
+	if (result && rename(tmp_path, batch->path) == 0) {
+		sync_directory(batch->path);
+	} else {
+		INDIGO_ERROR(indigo_error("Can't save %s (%s)", batch->path, strerror(errno)));
+		unlink(tmp_path);
+		result = false;
+	}
+	free(batch->buffer);
+	free(batch);
+	return result;
+}
+
+void indigo_store_close(indigo_store *store) {
+	if (store == NULL)
+		return;
+	for (int i = 0; i < store->count; i++) {
+		free(store->entries[i].key);
+		free(store->entries[i].value);
+	}
+	free(store->entries);
+	free(store->hash);
+	if (store->handle >= 0)
+		close(store->handle);
+	free(store);
+}
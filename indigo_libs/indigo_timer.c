@@ -32,6 +32,7 @@
 #include <indigo/indigo_timer.h>
 
 #include <indigo/indigo_driver.h>
+#include <indigo/indigo_metrics.h>
 
 
 //#ifdef __MACH__ /* Mac OSX prior Sierra is missing clock_gettime() */
@@ -63,6 +64,7 @@ static void *timer_func(indigo_timer *timer) {
 	while (true) {
 		while (timer->scheduled) {
 			INDIGO_TRACE(indigo_trace("timer #%d (of %d) used for %gs", timer->timer_id, timer_count, timer->delay));
+			double late = 0;
 			if (timer->delay > 0) {
 				struct timespec end;
 				utc_time(&end);
@@ -76,6 +78,11 @@ static void *timer_func(indigo_timer *timer) {
 					if (rc == ETIMEDOUT)
 						break;
 				}
+				if (indigo_use_metrics) {
+					struct timespec now;
+					utc_time(&now);
+					late = (now.tv_sec - end.tv_sec) + (double)(now.tv_nsec - end.tv_nsec) / NANO;
+				}
 			}
 
 			timer->scheduled = false;
@@ -83,7 +90,14 @@ static void *timer_func(indigo_timer *timer) {
 				pthread_mutex_lock(&timer->callback_mutex);
 				timer->callback_running = true;
 				INDIGO_TRACE(indigo_trace("timer callback: %p started", timer->callback));
+				if (late > 0)
+					indigo_metric_observe(INDIGO_METRIC_TIMER_LATENESS, late);
+				indigo_metric_add(INDIGO_METRIC_TIMER_RUNNING, 1);
+				double start = indigo_metric_time();
 				timer->callback(timer->device);
+				indigo_metric_observe_since(INDIGO_METRIC_TIMER_DURATION, start);
+				indigo_metric_add(INDIGO_METRIC_TIMER_RUNNING, -1);
+				indigo_metric_add(INDIGO_METRIC_TIMER_CALLBACKS, 1);
 				timer->callback_running = false;
 				if (!timer->scheduled && timer->reference)
 					*timer->reference = NULL;
@@ -132,7 +146,6 @@ bool indigo_set_timer(indigo_device *device, double delay, indigo_timer_callback
 	if (free_timer != NULL) {
 		t = free_timer;
 		free_timer = free_timer->next;
-		t->wake = true;
 		t->callback_running = false;
 		t->canceled = false;
 		t->scheduled = true;
@@ -144,7 +157,11 @@ bool indigo_set_timer(indigo_device *device, double delay, indigo_timer_callback
 			t->next = NULL;
 		}
 		t->callback = callback;
+		// reference is set before timer thread is woken up, callback with zero delay may reschedule itself
+		if ((t->reference = timer))
+			*timer = t;
 		pthread_mutex_lock(&t->mutex);
+		t->wake = true;
 		pthread_cond_signal(&t->cond);
 		pthread_mutex_unlock(&t->mutex);
 	} else {
@@ -166,15 +183,12 @@ bool indigo_set_timer(indigo_device *device, double delay, indigo_timer_callback
 		}
 		t->delay = delay;
 		t->callback = callback;
+		if ((t->reference = timer))
+			*timer = t;
 		pthread_create(&t->thread, NULL, (void * (*)(void*))timer_func, t);
+		indigo_metric_add(INDIGO_METRIC_TIMER_THREADS, 1);
 	}
 	pthread_mutex_unlock(&free_timer_mutex);
-	if (timer) {
-		t->reference = timer;
-		*timer = t;
-	} else {
-		t->reference = NULL;
-	}
 	return true;
 }
 
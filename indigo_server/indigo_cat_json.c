@@ -0,0 +1,119 @@
+// Copyright (c) 2020 CloudMakers, s. r. o.
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// version history
+// 2.0 by Peter Polakovic <peter.polakovic@cloudmakers.eu>
+
+/** Build time generator of J2000 star, DSO and constellation line JSON documents
+ \file indigo_cat_json.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <indigo/indigo_cat_data.h>
+
+static FILE *open_document(const char *folder, const char *name) {
+	char path[1024];
+	snprintf(path, sizeof(path), "%s/%s", folder, name);
+	FILE *file = fopen(path, "w");
+	if (file == NULL)
+		perror(path);
+	return file;
+}
+
+static bool write_stars(const char *folder) {
+	FILE *file = open_document(folder, "stars.json");
+	if (file == NULL)
+		return false;
+	char buffer[1024];
+	char *sep = "";
+	fputs(INDIGO_CAT_FEATURES_HEADER, file);
+	for (int i = 0; indigo_star_data[i].hip; i++) {
+		indigo_star_entry *star = indigo_star_data + i;
+		if (star->mag > INDIGO_CAT_STARS_MAX_MAG)
+			continue;
+		indigo_cat_star_feature(buffer, star, star->ra, star->dec);
+		fprintf(file, "%s%s", sep, buffer);
+		sep = ",";
+	}
+	fputs(INDIGO_CAT_FEATURES_FOOTER, file);
+	return fclose(file) == 0;
+}
+
+static bool write_dsos(const char *folder) {
+	FILE *file = open_document(folder, "dsos.json");
+	if (file == NULL)
+		return false;
+	char buffer[1024];
+	char *sep = "";
+	fputs(INDIGO_CAT_FEATURES_HEADER, file);
+	for (int i = 0; indigo_dso_data[i].id; i++) {
+		indigo_dso_entry *dso = indigo_dso_data + i;
+		if (dso->mag > INDIGO_CAT_DSOS_MAX_MAG)
+			continue;
+		indigo_cat_dso_feature(buffer, dso, dso->ra, dso->dec);
+		fprintf(file, "%s%s", sep, buffer);
+		sep = ",";
+	}
+	fputs(INDIGO_CAT_FEATURES_FOOTER, file);
+	return fclose(file) == 0;
+}
+
+static indigo_star_entry *find_star(int hip) {
+	for (int i = 0; indigo_star_data[i].hip; i++)
+		if (indigo_star_data[i].hip == hip)
+			return indigo_star_data + i;
+	return NULL;
+}
+
+static bool write_constellation_lines(const char *folder) {
+	FILE *file = open_document(folder, "constellations.lines.json");
+	if (file == NULL)
+		return false;
+	char buffer[1024];
+	char *line_sep = "";
+	fputs(INDIGO_CAT_LINES_HEADER, file);
+	for (int *hip = indigo_constellation_lines; *hip; hip++) {
+		char *sep = "";
+		fprintf(file, "%s[", line_sep);
+		for (; *hip; hip++) {
+			indigo_star_entry *star = find_star(*hip);
+			if (star) {
+				indigo_cat_line_vertex(buffer, star->ra, star->dec);
+				fprintf(file, "%s%s", sep, buffer);
+				sep = ",";
+			}
+		}
+		fputs("]", file);
+		line_sep = ",";
+	}
+	fputs(INDIGO_CAT_LINES_FOOTER, file);
+	return fclose(file) == 0;
+}
+
+int main(int argc, const char * argv[]) {
+	if (argc != 2) {
+		fprintf(stderr, "Usage: %s <output folder>\n", argv[0]);
+		return 1;
+	}
+	if (write_stars(argv[1]) && write_dsos(argv[1]) && write_constellation_lines(argv[1]))
+		return 0;
+	return 1;
+}
@@ -0,0 +1,541 @@
+// Copyright (c) 2020 CloudMakers, s. r. o.
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// version history
+// 2.0 by Peter Polakovic <peter.polakovic@cloudmakers.eu>
+
+/** INDIGO catalogue web resources
+ \file indigo_cat_resources.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <zlib.h>
+
+#include <indigo/indigo_bus.h>
+#include <indigo/indigo_server_tcp.h>
+#include <indigo/indigo_novas.h>
+#include <indigo/indigo_ephemeris.h>
+#include <indigo/indigo_driver.h>
+#include <indigo/indigo_io.h>
+
+#include "indigo_cat_resources.h"
+
+#define DEG2RAD						(M_PI / 180.0)
+#define MAS2RAD						(DEG2RAD / 3600000.0)
+#define EPOCH_VALIDITY		(24 * 3600)
+#define MAX_WORKERS				4
+#define QUERY_MAX_COUNT		10000
+
+// J2000 documents generated at build time by indigo_cat_json
+
+static unsigned char stars_json[] = {
+#include "resource/data/stars.json.data"
+};
+
+static unsigned char dsos_json[] = {
+#include "resource/data/dsos.json.data"
+};
+
+static unsigned char constellations_lines_json[] = {
+#include "resource/data/constellations.lines.json.data"
+};
+
+typedef struct {
+	double matrix[3][3];
+	double years;
+} epoch_correction;
+
+// corrected document is shared by the catalogue and HTTP responses still sending it, the last one frees it
+
+typedef struct {
+	int references;
+	unsigned size;
+	unsigned char data[];
+} document_data;
+
+typedef struct {
+	const char *path;
+	unsigned char *precomputed;
+	unsigned precomputed_size;
+	document_data *corrected;
+} catalog_document;
+
+enum { STARS_DOCUMENT, DSOS_DOCUMENT, LINES_DOCUMENT, DOCUMENT_COUNT };
+
+static catalog_document documents[DOCUMENT_COUNT] = {
+	{ "/data/stars.json", stars_json, sizeof(stars_json) },
+	{ "/data/dsos.json", dsos_json, sizeof(dsos_json) },
+	{ "/data/constellations.lines.json", constellations_lines_json, sizeof(constellations_lines_json) }
+};
+
+static pthread_mutex_t documents_mutex = PTHREAD_MUTEX_INITIALIZER;
+static time_t documents_epoch = 0;
+static bool update_in_progress = false;
+static bool documents_released = false;
+
+// IAU 1976 precession from J2000 to mean equator of date, nutation and aberration (< 1') are ignored for charts
+
+static void init_epoch_correction(epoch_correction *correction, time_t now) {
+	double t = (now / 86400.0 + 2440587.5 - JD2000) / 36525.0;
+	double zeta = (2306.2181 * t + 0.30188 * t * t + 0.017998 * t * t * t) / 3600 * DEG2RAD;
+	double z = (2306.2181 * t + 1.09468 * t * t + 0.018203 * t * t * t) / 3600 * DEG2RAD;
+	double theta = (2004.3109 * t - 0.42665 * t * t - 0.041833 * t * t * t) / 3600 * DEG2RAD;
+	double cos_zeta = cos(zeta), sin_zeta = sin(zeta), cos_z = cos(z), sin_z = sin(z), cos_theta = cos(theta), sin_theta = sin(theta);
+	correction->matrix[0][0] = cos_zeta * cos_theta * cos_z - sin_zeta * sin_z;
+	correction->matrix[0][1] = -sin_zeta * cos_theta * cos_z - cos_zeta * sin_z;
+	correction->matrix[0][2] = -sin_theta * cos_z;
+	correction->matrix[1][0] = cos_zeta * cos_theta * sin_z + sin_zeta * cos_z;
+	correction->matrix[1][1] = -sin_zeta * cos_theta * sin_z + cos_zeta * cos_z;
+	correction->matrix[1][2] = -sin_theta * sin_z;
+	correction->matrix[2][0] = cos_zeta * sin_theta;
+	correction->matrix[2][1] = -sin_zeta * sin_theta;
+	correction->matrix[2][2] = cos_theta;
+	correction->years = t * 100;
+}
+
+static void correct_position(epoch_correction *correction, double promora, double promodec, double *ra, double *dec) {
+	double ra_rad = *ra * 15 * DEG2RAD, dec_rad = *dec * DEG2RAD;
+	double cos_dec = cos(dec_rad);
+	if (cos_dec > 1e-9)
+		ra_rad += promora * MAS2RAD * correction->years / cos_dec;
+	dec_rad += promodec * MAS2RAD * correction->years;
+	cos_dec = cos(dec_rad);
+	double v[3] = { cos_dec * cos(ra_rad), cos_dec * sin(ra_rad), sin(dec_rad) }, w[3];
+	for (int i = 0; i < 3; i++)
+		w[i] = correction->matrix[i][0] * v[0] + correction->matrix[i][1] * v[1] + correction->matrix[i][2] * v[2];
+	double result_ra = atan2(w[1], w[0]) / DEG2RAD / 15;
+	if (result_ra < 0)
+		result_ra += 24;
+	*ra = result_ra;
+	*dec = asin(w[2]) / DEG2RAD;
+}
+
+// retain/release must be called with documents_mutex locked
+
+static document_data *retain_document(document_data *document) {
+	if (document)
+		document->references++;
+	return document;
+}
+
+static void release_document(document_data *document) {
+	if (document && --document->references == 0)
+		free(document);
+}
+
+static document_data *compress_document(const char *name, char *buffer, unsigned size) {
+	z_stream defstream;
+	defstream.zalloc = Z_NULL;
+	defstream.zfree = Z_NULL;
+	defstream.opaque = Z_NULL;
+	defstream.avail_in = size;
+	defstream.next_in = (Bytef *)buffer;
+	unsigned data_size = (unsigned)compressBound(size) + 1024;
+	document_data *document = malloc(sizeof(document_data) + data_size);
+	defstream.avail_out = data_size;
+	defstream.next_out = (Bytef *)document->data;
+	gz_header header = { 0 };
+	header.name = (Bytef *)name;
+	header.comment = Z_NULL;
+	header.extra = Z_NULL;
+	deflateInit2(&defstream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 9, Z_DEFAULT_STRATEGY);
+	deflateSetHeader(&defstream, &header);
+	deflate(&defstream, Z_FINISH);
+	deflateEnd(&defstream);
+	document->size = (unsigned)((unsigned char *)defstream.next_out - document->data);
+	document->references = 1;
+	return realloc(document, sizeof(document_data) + document->size);
+}
+
+// stars are formatted in parallel chunks and concatenated
+
+typedef struct {
+	epoch_correction *correction;
+	int from, to;
+	char *buffer;
+	unsigned size;
+	pthread_t thread;
+} star_chunk;
+
+static void *format_stars(star_chunk *chunk) {
+	int buffer_size = 256 * 1024;
+	chunk->buffer = malloc(buffer_size);
+	chunk->size = 0;
+	for (int i = chunk->from; i < chunk->to; i++) {
+		indigo_star_entry *star = indigo_star_data + i;
+		if (star->mag > INDIGO_CAT_STARS_MAX_MAG)
+			continue;
+		double ra = star->ra, dec = star->dec;
+		correct_position(chunk->correction, star->promora, star->promodec, &ra, &dec);
+		if (buffer_size - chunk->size < 1024)
+			chunk->buffer = realloc(chunk->buffer, buffer_size *= 2);
+		chunk->buffer[chunk->size++] = ',';
+		chunk->size += indigo_cat_star_feature(chunk->buffer + chunk->size, star, ra, dec);
+	}
+	return NULL;
+}
+
+static char *stars_document(epoch_correction *correction, unsigned *size) {
+	int count = 0;
+	while (indigo_star_data[count].hip)
+		count++;
+	int workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	if (workers < 1)
+		workers = 1;
+	else if (workers > MAX_WORKERS)
+		workers = MAX_WORKERS;
+	star_chunk chunks[MAX_WORKERS];
+	for (int i = 0; i < workers; i++) {
+		chunks[i].correction = correction;
+		chunks[i].from = count * i / workers;
+		chunks[i].to = count * (i + 1) / workers;
+		if (i == 0 || pthread_create(&chunks[i].thread, NULL, (void *(*)(void *))format_stars, chunks + i) != 0) {
+			chunks[i].thread = 0;
+			if (i > 0)
+				format_stars(chunks + i);
+		}
+	}
+	format_stars(chunks);
+	unsigned total = (unsigned)strlen(INDIGO_CAT_FEATURES_HEADER) + (unsigned)strlen(INDIGO_CAT_FEATURES_FOOTER) + 1;
+	for (int i = 0; i < workers; i++) {
+		if (i > 0 && chunks[i].thread)
+			pthread_join(chunks[i].thread, NULL);
+		total += chunks[i].size;
+	}
+	char *buffer = malloc(total);
+	strcpy(buffer, INDIGO_CAT_FEATURES_HEADER);
+	*size = (unsigned)strlen(buffer);
+	bool first = true;
+	for (int i = 0; i < workers; i++) {
+		if (chunks[i].size) {
+			// skip leading separator of the first feature
+			int skip = first ? 1 : 0;
+			memcpy(buffer + *size, chunks[i].buffer + skip, chunks[i].size - skip);
+			*size += chunks[i].size - skip;
+			first = false;
+		}
+		free(chunks[i].buffer);
+	}
+	strcpy(buffer + *size, INDIGO_CAT_FEATURES_FOOTER);
+	*size += (unsigned)strlen(INDIGO_CAT_FEATURES_FOOTER);
+	return buffer;
+}
+
+static char *dsos_document(epoch_correction *correction, unsigned *size) {
+	int buffer_size = 256 * 1024;
+	char *buffer = malloc(buffer_size);
+	strcpy(buffer, INDIGO_CAT_FEATURES_HEADER);
+	*size = (unsigned)strlen(buffer);
+	char *sep = "";
+	for (int i = 0; indigo_dso_data[i].id; i++) {
+		indigo_dso_entry *dso = indigo_dso_data + i;
+		if (dso->mag > INDIGO_CAT_DSOS_MAX_MAG)
+			continue;
+		double ra = dso->ra, dec = dso->dec;
+		correct_position(correction, 0, 0, &ra, &dec);
+		if (buffer_size - *size < 1024)
+			buffer = realloc(buffer, buffer_size *= 2);
+		*size += sprintf(buffer + *size, "%s", sep);
+		*size += indigo_cat_dso_feature(buffer + *size, dso, ra, dec);
+		sep = ",";
+	}
+	*size += sprintf(buffer + *size, INDIGO_CAT_FEATURES_FOOTER);
+	return buffer;
+}
+
+static char *lines_document(epoch_correction *correction, unsigned *size) {
+	int buffer_size = 256 * 1024;
+	char *buffer = malloc(buffer_size);
+	strcpy(buffer, INDIGO_CAT_LINES_HEADER);
+	*size = (unsigned)strlen(buffer);
+	char *line_sep = "";
+	for (int *hip = indigo_constellation_lines; *hip; hip++) {
+		char *sep = "";
+		*size += sprintf(buffer + *size, "%s[", line_sep);
+		for (; *hip; hip++) {
+			indigo_star_entry *star = indigo_cat_star_by_hip(*hip);
+			if (star) {
+				double ra = star->ra, dec = star->dec;
+				correct_position(correction, star->promora, star->promodec, &ra, &dec);
+				if (buffer_size - *size < 1024)
+					buffer = realloc(buffer, buffer_size *= 2);
+				*size += sprintf(buffer + *size, "%s", sep);
+				*size += indigo_cat_line_vertex(buffer + *size, ra, dec);
+				sep = ",";
+			}
+		}
+		*size += sprintf(buffer + *size, "]");
+		line_sep = ",";
+	}
+	*size += sprintf(buffer + *size, INDIGO_CAT_LINES_FOOTER);
+	return buffer;
+}
+
+static void *update_documents(void *data) {
+	time_t now = time(NULL);
+	epoch_correction correction;
+	init_epoch_correction(&correction, now);
+	char *(*generators[DOCUMENT_COUNT])(epoch_correction *, unsigned *) = { stars_document, dsos_document, lines_document };
+	for (int i = 0; i < DOCUMENT_COUNT; i++) {
+		unsigned size;
+		char *buffer = generators[i](&correction, &size);
+		document_data *compressed = compress_document(strrchr(documents[i].path, '/') + 1, buffer, size);
+		free(buffer);
+		pthread_mutex_lock(&documents_mutex);
+		if (documents_released) {
+			release_document(compressed);
+		} else {
+			release_document(documents[i].corrected);
+			documents[i].corrected = compressed;
+		}
+		pthread_mutex_unlock(&documents_mutex);
+	}
+	pthread_mutex_lock(&documents_mutex);
+	documents_epoch = now;
+	update_in_progress = false;
+	pthread_mutex_unlock(&documents_mutex);
+	INDIGO_DEBUG(indigo_debug("Catalogue documents updated to epoch of date"));
+	return NULL;
+}
+
+static bool document_handler(int socket, const char *path, const char *params) {
+	catalog_document *document = NULL;
+	for (int i = 0; i < DOCUMENT_COUNT; i++) {
+		if (!strcmp(documents[i].path, path)) {
+			document = documents + i;
+			break;
+		}
+	}
+	if (document == NULL)
+		return false;
+	pthread_mutex_lock(&documents_mutex);
+	if (!update_in_progress && !documents_released && time(NULL) - documents_epoch > EPOCH_VALIDITY) {
+		// J2000 documents are served until the corrected ones are ready
+		update_in_progress = true;
+		if (!indigo_async(update_documents, NULL))
+			update_in_progress = false;
+	}
+	document_data *corrected = retain_document(document->corrected);
+	pthread_mutex_unlock(&documents_mutex);
+	unsigned char *data = corrected ? corrected->data : document->precomputed;
+	unsigned size = corrected ? corrected->size : document->precomputed_size;
+	bool result = indigo_printf(socket, "HTTP/1.1 200 OK\r\n");
+	result = result && indigo_printf(socket, "Server: INDIGO/%d.%d-%s\r\n", (INDIGO_VERSION_CURRENT >> 8) & 0xFF, INDIGO_VERSION_CURRENT & 0xFF, INDIGO_BUILD);
+	result = result && indigo_printf(socket, "Content-Type: application/json; charset=utf-8\r\n");
+	result = result && indigo_printf(socket, "Content-Length: %u\r\n", size);
+	result = result && indigo_printf(socket, "Content-Encoding: gzip\r\n");
+	result = result && indigo_printf(socket, "\r\n");
+	result = result && indigo_write(socket, (const char *)data, size);
+	pthread_mutex_lock(&documents_mutex);
+	release_document(corrected);
+	pthread_mutex_unlock(&documents_mutex);
+	return result;
+}
+
+void indigo_add_catalog_resources(void) {
+	pthread_mutex_lock(&documents_mutex);
+	documents_released = false;
+	pthread_mutex_unlock(&documents_mutex);
+	for (int i = 0; i < DOCUMENT_COUNT; i++)
+		indigo_server_add_handler(documents[i].path, document_handler);
+}
+
+void indigo_release_catalog_resources(void) {
+	pthread_mutex_lock(&documents_mutex);
+	for (int i = 0; i < DOCUMENT_COUNT; i++) {
+		indigo_server_remove_resource(documents[i].path);
+		// responses in flight keep their own reference
+		release_document(documents[i].corrected);
+		documents[i].corrected = NULL;
+	}
+	documents_released = true;
+	documents_epoch = 0;
+	pthread_mutex_unlock(&documents_mutex);
+}
+
+// GET /catalog/stars?ra=<deg>&dec=<deg>&radius=<deg>&mag=<max mag>&limit=<max count>
+// GET /catalog/dsos?ra=<deg>&dec=<deg>&radius=<deg>&mag=<max mag>&limit=<max count>
+
+static double query_param(const char *params, const char *name, double default_value) {
+	int length = (int)strlen(name);
+	const char *param = params;
+	while (param && *param) {
+		if (!strncmp(param, name, length) && param[length] == '=')
+			return atof(param + length + 1);
+		param = strchr(param, '&');
+		if (param)
+			param++;
+	}
+	return default_value;
+}
+
+static bool send_query_result(int socket, char *buffer, unsigned size) {
+	bool result = indigo_printf(socket, "HTTP/1.1 200 OK\r\n");
+	result = result && indigo_printf(socket, "Server: INDIGO/%d.%d-%s\r\n", (INDIGO_VERSION_CURRENT >> 8) & 0xFF, INDIGO_VERSION_CURRENT & 0xFF, INDIGO_BUILD);
+	result = result && indigo_printf(socket, "Content-Type: application/json; charset=utf-8\r\n");
+	result = result && indigo_printf(socket, "Content-Length: %u\r\n", size);
+	result = result && indigo_printf(socket, "\r\n");
+	result = result && indigo_write(socket, buffer, size);
+	free(buffer);
+	return result;
+}
+
+static bool query_handler(int socket, const char *path, const char *params) {
+	bool stars = !strcmp(path, "/catalog/stars");
+	double ra = query_param(params, "ra", 0) / 15;
+	double dec = query_param(params, "dec", 0);
+	double radius = query_param(params, "radius", 180);
+	double max_mag = query_param(params, "mag", stars ? INDIGO_CAT_STARS_MAX_MAG : INDIGO_CAT_DSOS_MAX_MAG);
+	int limit = (int)query_param(params, "limit", QUERY_MAX_COUNT);
+	if (limit <= 0 || limit > QUERY_MAX_COUNT)
+		limit = QUERY_MAX_COUNT;
+	if (ra < 0)
+		ra += 24;
+	epoch_correction correction;
+	init_epoch_correction(&correction, time(NULL));
+	void **entries = malloc(limit * sizeof(void *));
+	int count;
+	if (stars)
+		count = indigo_cat_stars_in_cone(ra, dec, radius, max_mag, (indigo_star_entry **)entries, limit);
+	else
+		count = indigo_cat_dsos_in_cone(ra, dec, radius, max_mag, (indigo_dso_entry **)entries, limit);
+	int buffer_size = 256 * 1024;
+	char *buffer = malloc(buffer_size);
+	strcpy(buffer, INDIGO_CAT_FEATURES_HEADER);
+	unsigned size = (unsigned)strlen(buffer);
+	char *sep = "";
+	for (int i = 0; i < count; i++) {
+		if (buffer_size - size < 1024)
+			buffer = realloc(buffer, buffer_size *= 2);
+		size += sprintf(buffer + size, "%s", sep);
+		if (stars) {
+			indigo_star_entry *star = entries[i];
+			double star_ra = star->ra, star_dec = star->dec;
+			correct_position(&correction, star->promora, star->promodec, &star_ra, &star_dec);
+			size += indigo_cat_star_feature(buffer + size, star, star_ra, star_dec);
+		} else {
+			indigo_dso_entry *dso = entries[i];
+			double dso_ra = dso->ra, dso_dec = dso->dec;
+			correct_position(&correction, 0, 0, &dso_ra, &dso_dec);
+			size += indigo_cat_dso_feature(buffer + size, dso, dso_ra, dso_dec);
+		}
+		sep = ",";
+	}
+	size += sprintf(buffer + size, INDIGO_CAT_FEATURES_FOOTER);
+	free(entries);
+	return send_query_result(socket, buffer, size);
+}
+
+// GET /ephemeris?lat=<deg>&lon=<deg>&elev=<m>&time=<unix time>
+
+static struct {
+	int id;
+	const char *name;
+} ephemeris_bodies[] = {
+	{ INDIGO_EPHEMERIS_SUN, "Sun" },
+	{ INDIGO_EPHEMERIS_MOON, "Moon" },
+	{ INDIGO_EPHEMERIS_MERCURY, "Mercury" },
+	{ INDIGO_EPHEMERIS_VENUS, "Venus" },
+	{ INDIGO_EPHEMERIS_MARS, "Mars" },
+	{ INDIGO_EPHEMERIS_JUPITER, "Jupiter" },
+	{ INDIGO_EPHEMERIS_SATURN, "Saturn" },
+	{ INDIGO_EPHEMERIS_URANUS, "Uranus" },
+	{ INDIGO_EPHEMERIS_NEPTUNE, "Neptune" },
+	{ INDIGO_EPHEMERIS_PLUTO, "Pluto" }
+};
+
+#define EPHEMERIS_BODY_COUNT	(sizeof(ephemeris_bodies) / sizeof(ephemeris_bodies[0]))
+
+static int ephemeris_time(char *buffer, const char *name, time_t time) {
+	if (time == 0)
+		return sprintf(buffer, "\"%s\":null", name);
+	char iso[32];
+	indigo_timetoisogm(time, iso, sizeof(iso));
+	return sprintf(buffer, "\"%s\":\"%sZ\"", name, iso);
+}
+
+static bool ephemeris_handler(int socket, const char *path, const char *params) {
+	double latitude = query_param(params, "lat", 0);
+	double longitude = query_param(params, "lon", 0);
+	double elevation = query_param(params, "elev", 0);
+	time_t utc = (time_t)query_param(params, "time", time(NULL));
+	int ids[EPHEMERIS_BODY_COUNT];
+	double ra[EPHEMERIS_BODY_COUNT], dec[EPHEMERIS_BODY_COUNT], distance[EPHEMERIS_BODY_COUNT], alt[EPHEMERIS_BODY_COUNT], az[EPHEMERIS_BODY_COUNT];
+	for (int i = 0; i < EPHEMERIS_BODY_COUNT; i++) {
+		ids[i] = ephemeris_bodies[i].id;
+		ra[i] = dec[i] = distance[i] = NAN;
+	}
+	indigo_novas_context context;
+	indigo_novas_context_init(&context, 0);
+	// bodies not covered by ephemeris are left NAN and skipped
+	indigo_novas_topo_planet(&context, &utc, latitude, longitude, elevation, EPHEMERIS_BODY_COUNT, ids, ra, dec, distance);
+	indigo_novas_eq2hor(&context, &utc, latitude, longitude, elevation, EPHEMERIS_BODY_COUNT, ra, dec, alt, az);
+	char *buffer = malloc(16 * 1024);
+	unsigned size = sprintf(buffer, "{");
+	size += ephemeris_time(buffer + size, "utc", utc);
+	size += sprintf(buffer + size, ",\"bodies\":[");
+	char *sep = "";
+	for (int i = 0; i < EPHEMERIS_BODY_COUNT; i++) {
+		if (isnan(ra[i]))
+			continue;
+		time_t rise, transit, set;
+		double altitude = ids[i] == INDIGO_EPHEMERIS_SUN || ids[i] == INDIGO_EPHEMERIS_MOON ? INDIGO_EPHEMERIS_SUN_RISE_SET_ALTITUDE : INDIGO_EPHEMERIS_RISE_SET_ALTITUDE;
+		if (!indigo_ephemeris_events(utc, latitude, longitude, elevation, ids[i], altitude, &rise, &transit, &set))
+			rise = transit = set = 0;
+		size += sprintf(buffer + size, "%s{\"name\":\"%s\",\"ra\":%.6f,\"dec\":%.5f,\"alt\":%.4f,\"az\":%.4f,\"distance\":%.9f,", sep, ephemeris_bodies[i].name, ra[i], dec[i], alt[i], az[i], distance[i]);
+		size += ephemeris_time(buffer + size, "rise", rise);
+		size += sprintf(buffer + size, ",");
+		size += ephemeris_time(buffer + size, "transit", transit);
+		size += sprintf(buffer + size, ",");
+		size += ephemeris_time(buffer + size, "set", set);
+		size += sprintf(buffer + size, "}");
+		sep = ",";
+	}
+	size += sprintf(buffer + size, "],\"twilight\":{");
+	static struct {
+		const char *name;
+		double altitude;
+	} twilights[] = {
+		{ "civil", INDIGO_EPHEMERIS_CIVIL_TWILIGHT },
+		{ "nautical", INDIGO_EPHEMERIS_NAUTICAL_TWILIGHT },
+		{ "astronomical", INDIGO_EPHEMERIS_ASTRONOMICAL_TWILIGHT }
+	};
+	for (int i = 0; i < 3; i++) {
+		time_t dawn = 0, dusk = 0;
+		indigo_ephemeris_events(utc, latitude, longitude, elevation, INDIGO_EPHEMERIS_SUN, twilights[i].altitude, &dawn, NULL, &dusk);
+		size += sprintf(buffer + size, "%s\"%s\":{", i ? "," : "", twilights[i].name);
+		size += ephemeris_time(buffer + size, "dusk", dusk);
+		size += sprintf(buffer + size, ",");
+		size += ephemeris_time(buffer + size, "dawn", dawn);
+		size += sprintf(buffer + size, "}");
+	}
+	size += sprintf(buffer + size, "}}");
+	return send_query_result(socket, buffer, size);
+}
+
+void indigo_add_catalog_query_handlers(void) {
+	indigo_server_add_handler("/catalog/stars", query_handler);
+	indigo_server_add_handler("/catalog/dsos", query_handler);
+	indigo_server_add_handler("/ephemeris", ephemeris_handler);
+}
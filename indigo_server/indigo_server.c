@@ -49,7 +49,7 @@
 #include <indigo/indigo_xml.h>
 #include <indigo/indigo_token.h>
 
-#include "indigo_cat_data.h"
+#include "indigo_cat_resources.h"
 
 #include "ccd_simulator/indigo_ccd_simulator.h"
 #include "mount_simulator/indigo_mount_simulator.h"
@@ -105,6 +105,7 @@
 #include "focuser_asi/indigo_focuser_asi.h"
 #include "agent_alignment/indigo_agent_alignment.h"
 #include "agent_mount/indigo_agent_mount.h"
+#include "agent_scheduler/indigo_agent_scheduler.h"
 #include "ao_sx/indigo_ao_sx.h"
 #include "ccd_uvc/indigo_ccd_uvc.h"
 #include "agent_guider/indigo_agent_guider.h"
@@ -169,6 +170,7 @@ driver_entry_point static_drivers[] = {
 	indigo_agent_imager,
 	indigo_agent_lx200_server,
 	indigo_agent_mount,
+	indigo_agent_scheduler,
 	indigo_agent_snoop,
 	indigo_ao_sx,
 	indigo_aux_arteskyflat,
@@ -310,9 +312,6 @@ static pthread_mutex_t install_property_mutex = PTHREAD_MUTEX_INITIALIZER;
 static DNSServiceRef sd_http;
 static DNSServiceRef sd_indigo;
 
-static void *star_data = NULL;
-static void *dso_data = NULL;
-static void *constellation_data = NULL;
 
 #ifdef INDIGO_MACOS
 static bool runLoop = true;
@@ -744,9 +743,10 @@ static indigo_result change_property(indigo_device *device, indigo_client *clien
 		SERVER_DRIVERS_PROPERTY->state = INDIGO_OK_STATE;
 		indigo_update_property(device, SERVER_DRIVERS_PROPERTY, NULL);
 		int handle = 0;
-		if (!command_line_drivers)
+		if (!command_line_drivers) {
 			indigo_save_property(device, &handle, SERVER_DRIVERS_PROPERTY);
-		close(handle);
+			indigo_commit_saved_properties(device, &handle);
+		}
 		return INDIGO_OK;
 	} else if (indigo_property_match(SERVER_LOAD_PROPERTY, property)) {
 		// -------------------------------------------------------------------------------- LOAD
@@ -1073,6 +1073,8 @@ static void server_main() {
 
 	use_ctrl_panel |= use_web_apps;
 
+	indigo_cat_index_build(indigo_star_data, indigo_dso_data);
+
 	if (use_ctrl_panel) {
 		// INDIGO Server Manager
 		static unsigned char mng_html[] = {
@@ -1183,9 +1185,8 @@ static void server_main() {
 			#include "resource/data/planets.json.data"
 		};
 		indigo_server_add_resource("/data/planets.json", planets_json, sizeof(planets_json), "application/json; charset=utf-8");
-		star_data = indigo_add_star_json_resource(6);
-		dso_data = indigo_add_dso_json_resource(10);
-		constellation_data = indigo_add_constellations_lines_json_resource();
+		indigo_add_catalog_resources();
+		indigo_add_catalog_query_handlers();
 		// INDIGO Guider
 		static unsigned char guider_html[] = {
 			#include "resource/guider.html.data"
@@ -1238,12 +1239,7 @@ static void server_main() {
 	indigo_detach_device(&server_device);
 	indigo_stop();
 	indigo_server_remove_resources();
-	if (star_data)
-		free(star_data);
-	if (dso_data)
-		free(dso_data);
-	if (constellation_data)
-		free(constellation_data);
+	indigo_release_catalog_resources();
 	for (int i = 0; i < INDIGO_MAX_DRIVERS; i++) {
 		if (indigo_available_drivers[i].driver) {
 			indigo_remove_driver(&indigo_available_drivers[i]);
@@ -1299,6 +1295,8 @@ int main(int argc, const char * argv[]) {
 			do_fork = false;
 		} else if (!strcmp(argv[i], "-l") || !strcmp(argv[i], "--use-syslog")) {
 			indigo_use_syslog = true;
+		} else if (!strcmp(argv[i], "-t") || !strcmp(argv[i], "--log-thread-ids")) {
+			indigo_log_thread_ids = true;
 		} else if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help")) {
 			printf("INDIGO server v.%d.%d-%s built on %s %s.\n", (INDIGO_VERSION_CURRENT >> 8) & 0xFF, INDIGO_VERSION_CURRENT & 0xFF, INDIGO_BUILD, __DATE__, __TIME__);
 			printf("usage: %s [-h | --help]\n", argv[0]);
@@ -1306,6 +1304,7 @@ int main(int argc, const char * argv[]) {
 			printf("options:\n"
 			       "       --  | --do-not-fork\n"
 			       "       -l  | --use-syslog\n"
+			       "       -t  | --log-thread-ids\n"
 			       "       -p  | --port port                     (default: 7624)\n"
 			       "       -b  | --bonjour name                  (default: hostname)\n"
 			       "       -T  | --master-token token            (master token for devce access default: 0 = none)\n"
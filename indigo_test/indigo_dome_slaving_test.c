@@ -0,0 +1,136 @@
+// Copyright (c) 2026 CloudMakers, s. r. o.
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** INDIGO dome slaving test - counts dome moves over simulated 8 hour track with slit edge prediction and with threshold polling
+ \file indigo_dome_slaving_test.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <indigo/indigo_bus.h>
+#include <indigo/indigo_driver.h>
+#include <indigo/indigo_dome_driver.h>
+#include <indigo/indigo_dome_azimuth.h>
+#include <indigo/indigo_novas.h>
+
+// 2.5m dome with 1m slit, German equatorial mount with OTA 0.3m off RA axis
+
+#define SESSION_START			"2040-01-15T18:00:00"
+#define SITE_LATITUDE			48.1
+#define SITE_LONGITUDE		17.1
+#define DOME_RADIUS				1.25
+#define SLIT_WIDTH				1.0
+#define OTA_OFFSET				0.3
+#define VERTICAL_OFFSET		0.2
+
+#define TRACK_LENGTH			(8 * 3600)
+#define TRACK_STEP				5
+#define POLL_INTERVAL			15
+
+#define DEVICE_NAME				"Dome slaving test"
+
+static int failures = 0;
+
+#define CHECK(condition, ...) if (!(condition)) { failures++; printf("FAILED: "); printf(__VA_ARGS__); printf("\n"); } else { printf("ok: "); printf(__VA_ARGS__); printf("\n"); }
+
+static indigo_result dome_attach(indigo_device *device) {
+	return indigo_dome_attach(device, DEVICE_NAME, INDIGO_VERSION_CURRENT);
+}
+
+static indigo_result dome_detach(indigo_device *device) {
+	return indigo_dome_detach(device);
+}
+
+static indigo_device dome = INDIGO_DEVICE_INITIALIZER(DEVICE_NAME, dome_attach, indigo_dome_enumerate_properties, indigo_dome_change_property, NULL, dome_detach);
+
+static double telescope_azimuth(double ha, double dec) {
+	return indigo_dome_solve_azimuth(map24(ha), dec, SITE_LATITUDE, DOME_RADIUS, VERTICAL_OFFSET, OTA_OFFSET, 0, 0);
+}
+
+static double azimuth_difference(double az1, double az2) {
+	return fmod(az1 - az2 + 540, 360) - 180;
+}
+
+static void set_utc(indigo_device *device, time_t utc) {
+	indigo_timetoisogm(utc, DOME_UTC_ITEM->text.value, INDIGO_VALUE_SIZE);
+}
+
+// target rising in the east is followed until it is far in the west, meridian is crossed in the middle of the track
+
+static void track(double dec, int *predicted_moves, int *polled_moves, double *min_margin) {
+	indigo_device *device = &dome;
+	double threshold = DOME_SLAVING_THRESHOLD_ITEM->number.value;
+	double half_width = asin(SLIT_WIDTH / 2 / DOME_RADIUS) * 180 / M_PI;
+	time_t start = indigo_isogmtotime(SESSION_START);
+	double ra = map24(indigo_lst(&start, SITE_LONGITUDE) + 4);
+	double predicted_az, polled_az, az;
+	*predicted_moves = *polled_moves = 0;
+	*min_margin = half_width;
+	DOME_CONTEXT->slaving_deadline = 0;
+	for (int t = 0; t <= TRACK_LENGTH; t += TRACK_STEP) {
+		time_t utc = start + t;
+		double ha = map24(indigo_lst(&utc, SITE_LONGITUDE) - ra);
+		double telescope_az = telescope_azimuth(ha, dec);
+		if (t == 0)
+			predicted_az = polled_az = round(telescope_az * 100) / 100;
+		// moves with slit edge prediction, indigo_fix_dome_azimuth() is called on every coordinates update
+		set_utc(device, utc);
+		if (indigo_fix_dome_azimuth(device, ra, dec, predicted_az, &az)) {
+			predicted_az = az;
+			(*predicted_moves)++;
+		}
+		*min_margin = fmin(*min_margin, half_width - fabs(azimuth_difference(telescope_az, predicted_az)));
+		// moves of previous implementation, mount coordinates were polled every 15s and dome moved over threshold
+		if (t % POLL_INTERVAL == 0) {
+			if (fabs(azimuth_difference(polled_az, telescope_az)) >= threshold) {
+				polled_az = telescope_az;
+				(*polled_moves)++;
+			}
+		}
+	}
+}
+
+int main(int argc, const char * argv[]) {
+	indigo_set_log_level(INDIGO_LOG_ERROR);
+	indigo_start();
+	indigo_device *device = &dome;
+	indigo_attach_device(device);
+	DOME_RADIUS_ITEM->number.value = DOME_RADIUS;
+	DOME_SHUTTER_WIDTH_ITEM->number.value = SLIT_WIDTH;
+	DOME_MOUNT_PIVOT_OTA_OFFSET_ITEM->number.value = OTA_OFFSET;
+	DOME_MOUNT_PIVOT_VERTICAL_OFFSET_ITEM->number.value = VERTICAL_OFFSET;
+	DOME_GEOGRAPHIC_COORDINATES_LATITUDE_ITEM->number.value = SITE_LATITUDE;
+	DOME_GEOGRAPHIC_COORDINATES_LONGITUDE_ITEM->number.value = SITE_LONGITUDE;
+	// simulated clock is read from dome UTC
+	DOME_UTC_TIME_PROPERTY->hidden = false;
+	static const double declinations[] = { 0, 30, 60 };
+	for (int i = 0; i < 3; i++) {
+		int predicted_moves, polled_moves;
+		double min_margin;
+		track(declinations[i], &predicted_moves, &polled_moves, &min_margin);
+		CHECK(predicted_moves * 5 < polled_moves, "dec %+.0f° dome moves reduced from %d to %d", declinations[i], polled_moves, predicted_moves);
+		CHECK(min_margin > 0, "dec %+.0f° telescope within slit (closest to edge %.2f°)", declinations[i], min_margin);
+	}
+	indigo_detach_device(device);
+	indigo_stop();
+	printf("%s\n", failures ? "FAILED" : "PASSED");
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,156 @@
+// Copyright (c) 2026 CloudMakers, s. r. o.
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** INDIGO ephemeris test - Sun, Earth and Moon states against DE421 and USNO reference values, low precision fallback
+ \file indigo_ephemeris_test.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <eph_manager.h>
+
+#include <indigo/indigo_bus.h>
+#include <indigo/indigo_ephemeris.h>
+
+// planet_ephemeris() body numbers
+
+#define JPL_EARTH				2
+#define JPL_MOON				9
+#define JPL_SUN					10
+#define JPL_SSB					11
+
+// same DE421 data read by NOVAS reader, differences are rounding only
+
+#define MAX_POSITION_ERROR		1e-11
+#define MAX_VELOCITY_ERROR		1e-12
+
+// USNO reference values are computed with DE405, geocentric distance of the Moon differs from DE421 by metres
+
+#define MAX_DISTANCE_ERROR		1e-9
+#define MAX_DIRECTION_ERROR		0.1
+
+// low precision Sun and Moon formulae (Astronomical Almanac), Sun is placed to barycentre
+
+#define LOW_PRECISION_DISTANCE_ERROR		2e-5
+#define LOW_PRECISION_DIRECTION_ERROR		0.5
+#define LOW_PRECISION_POSITION_ERROR		0.02
+
+static int failures = 0;
+
+#define CHECK(condition, ...) if (!(condition)) { failures++; printf("FAILED: "); printf(__VA_ARGS__); printf("\n"); } else { printf("ok: "); printf(__VA_ARGS__); printf("\n"); }
+
+static const double epochs[] = { 2450203.5, 2451545.0, 2454580.942629, 2459000.5 };
+
+#define EPOCH_COUNT		(int)(sizeof(epochs) / sizeof(epochs[0]))
+
+// apparent geocentric place and true distance of the Moon from NOVAS checkout-mp-usno.txt and example-usno.txt (TT)
+
+static const struct {
+	double jd_tt, ra, dec, distance;
+} moon[] = {
+	{ 2450203.5, 11.739849403, -0.31860323, 0.0026040596 },
+	{ 2450417.5, 8.297113704, 15.04816197, 0.0026966683 },
+	{ 2450300.5, 1.774353433, 9.26638500, 0.0025464322 },
+	{ 2454580.942629, 17.1390774264, -27.5374448869, 0.002710296515 }
+};
+
+#define MOON_COUNT		(int)(sizeof(moon) / sizeof(moon[0]))
+
+static double difference(const double *a, const double *b) {
+	return sqrt((a[0] - b[0]) * (a[0] - b[0]) + (a[1] - b[1]) * (a[1] - b[1]) + (a[2] - b[2]) * (a[2] - b[2]));
+}
+
+static double length(const double *a) {
+	return sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+}
+
+static void check_moon(double max_distance_error, double max_direction_error) {
+	double max_distance = 0, max_direction = 0;
+	for (int i = 0; i < MOON_COUNT; i++) {
+		double earth[3], moon_position[3], geocentric[3];
+		indigo_ephemeris_state(INDIGO_EPHEMERIS_EARTH, moon[i].jd_tt, earth, NULL);
+		indigo_ephemeris_state(INDIGO_EPHEMERIS_MOON, moon[i].jd_tt, moon_position, NULL);
+		for (int j = 0; j < 3; j++)
+			geocentric[j] = moon_position[j] - earth[j];
+		double distance = length(geocentric);
+		max_distance = fmax(max_distance, fabs(distance - moon[i].distance));
+		// geometric direction in ICRS is compared to apparent place of date, so only gross errors are detected
+		double ra = atan2(geocentric[1], geocentric[0]), dec = asin(geocentric[2] / distance);
+		double ref_ra = moon[i].ra * M_PI / 12, ref_dec = moon[i].dec * M_PI / 180;
+		double c = sin(dec) * sin(ref_dec) + cos(dec) * cos(ref_dec) * cos(ra - ref_ra);
+		max_direction = fmax(max_direction, acos(fmin(1, c)) * 180 / M_PI);
+	}
+	CHECK(max_distance < max_distance_error, "geocentric distance of the Moon (max error %.3f km)", max_distance * 149597870.7);
+	CHECK(max_direction < max_direction_error, "geocentric direction of the Moon (max error %.4f°)", max_direction);
+}
+
+int main(int argc, const char * argv[]) {
+	indigo_set_log_level(INDIGO_LOG_ERROR);
+	double pos[3], vel[3], earth[EPOCH_COUNT][3];
+	bool jpl = indigo_ephemeris_state(INDIGO_EPHEMERIS_MERCURY, epochs[0], pos, NULL);
+	if (jpl) {
+		double jd_begin, jd_end;
+		short de_number;
+		CHECK(ephem_open("JPLEPH", &jd_begin, &jd_end, &de_number) == 0 && de_number == 421, "embedded ephemeris is DE421");
+		double max_position = 0, max_velocity = 0;
+		static const int bodies[] = { INDIGO_EPHEMERIS_SUN, INDIGO_EPHEMERIS_EARTH, INDIGO_EPHEMERIS_MOON };
+		static const short jpl_bodies[] = { JPL_SUN, JPL_EARTH, JPL_MOON };
+		for (int i = 0; i < EPOCH_COUNT; i++) {
+			for (int j = 0; j < 3; j++) {
+				double tjd[2] = { epochs[i], 0 }, jpl_pos[3], jpl_vel[3];
+				planet_ephemeris(tjd, jpl_bodies[j], JPL_SSB, jpl_pos, jpl_vel);
+				indigo_ephemeris_state(bodies[j], epochs[i], pos, vel);
+				max_position = fmax(max_position, difference(pos, jpl_pos));
+				max_velocity = fmax(max_velocity, difference(vel, jpl_vel));
+				if (bodies[j] == INDIGO_EPHEMERIS_EARTH)
+					memcpy(earth[i], pos, sizeof(pos));
+			}
+		}
+		ephem_close();
+		CHECK(max_position < MAX_POSITION_ERROR, "Sun, Earth and Moon position equal to DE421 (max difference %.1e AU)", max_position);
+		CHECK(max_velocity < MAX_VELOCITY_ERROR, "Sun, Earth and Moon velocity equal to DE421 (max difference %.1e AU/day)", max_velocity);
+		check_moon(MAX_DISTANCE_ERROR, MAX_DIRECTION_ERROR);
+	} else {
+		printf("skipped: JPL ephemeris is not embedded, DE421 comparison\n");
+	}
+
+	// file without ephemeris data drops JPL data and low precision formulae are used
+	CHECK(!indigo_ephemeris_open("/dev/null"), "file without ephemeris data refused");
+	CHECK(!indigo_ephemeris_state(INDIGO_EPHEMERIS_MERCURY, epochs[0], pos, NULL), "planets are not available without ephemeris data");
+	CHECK(indigo_ephemeris_state(INDIGO_EPHEMERIS_SUN, epochs[0], pos, NULL) && length(pos) == 0, "low precision Sun is placed to barycentre");
+	bool earth_ok = true;
+	double max_earth = 0;
+	for (int i = 0; i < EPOCH_COUNT; i++) {
+		earth_ok = earth_ok && indigo_ephemeris_state(INDIGO_EPHEMERIS_EARTH, epochs[i], pos, vel);
+		earth_ok = earth_ok && length(pos) > 0.983 && length(pos) < 1.017 && fabs(length(vel) - 0.0172) < 0.0005;
+		if (jpl)
+			max_earth = fmax(max_earth, difference(pos, earth[i]));
+	}
+	CHECK(earth_ok, "low precision Earth on its orbit");
+	if (jpl)
+		CHECK(max_earth < LOW_PRECISION_POSITION_ERROR, "low precision Earth close to DE421 (max difference %.4f AU)", max_earth);
+	check_moon(LOW_PRECISION_DISTANCE_ERROR, LOW_PRECISION_DIRECTION_ERROR);
+
+	CHECK(indigo_ephemeris_open(NULL) == jpl, "embedded ephemeris restored");
+	CHECK(indigo_ephemeris_state(INDIGO_EPHEMERIS_MERCURY, epochs[0], pos, NULL) == jpl, "planets available again with embedded ephemeris");
+	printf("%s\n", failures ? "FAILED" : "PASSED");
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,215 @@
+// Copyright (c) 2026 CloudMakers, s. r. o.
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** INDIGO ephemeris tracking test - follows recorded target track with mount simulator
+ \file indigo_ephemeris_tracking_test.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include <indigo/indigo_bus.h>
+#include <indigo/indigo_client.h>
+#include <indigo/indigo_driver.h>
+#include <indigo/indigo_novas.h>
+
+#include "mount_simulator/indigo_mount_simulator.h"
+
+// near earth asteroid like track, about 5"/s in RA and 2"/s in Dec with slight acceleration, recorded every 30s
+
+#define TRACK_RA_RATE			5.0
+#define TRACK_RA_ACCELERATION	0.01
+#define TRACK_DEC_RATE			2.0
+#define TRACK_STEP				30
+#define TRACK_ROWS				20
+
+#define SETTLE_TIME				30
+#define SAMPLE_TIME				20
+#define MAX_RESIDUAL			5.0
+
+static int failures = 0;
+
+#define CHECK(condition, ...) if (!(condition)) { failures++; printf("FAILED: "); printf(__VA_ARGS__); printf("\n"); } else { printf("ok: "); printf(__VA_ARGS__); printf("\n"); }
+
+static struct {
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	bool connected, unparked, tracking, slewed;
+	double latitude, longitude;
+	indigo_property_state target_state;
+	double residual;
+	int ticks;
+} mount = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER };
+
+static void store_property(indigo_property *property) {
+	if (strcmp(property->device, MOUNT_SIMULATOR_NAME))
+		return;
+	pthread_mutex_lock(&mount.mutex);
+	for (int i = 0; i < property->count; i++) {
+		indigo_item *item = property->items + i;
+		if (!strcmp(property->name, CONNECTION_PROPERTY_NAME)) {
+			if (!strcmp(item->name, CONNECTION_CONNECTED_ITEM_NAME))
+				mount.connected = item->sw.value && property->state == INDIGO_OK_STATE;
+		} else if (!strcmp(property->name, MOUNT_PARK_PROPERTY_NAME)) {
+			if (!strcmp(item->name, MOUNT_PARK_UNPARKED_ITEM_NAME))
+				mount.unparked = item->sw.value && property->state == INDIGO_OK_STATE;
+		} else if (!strcmp(property->name, MOUNT_EQUATORIAL_COORDINATES_PROPERTY_NAME)) {
+			mount.slewed = property->state == INDIGO_OK_STATE;
+		} else if (!strcmp(property->name, MOUNT_TRACKING_PROPERTY_NAME)) {
+			if (!strcmp(item->name, MOUNT_TRACKING_ON_ITEM_NAME))
+				mount.tracking = item->sw.value;
+		} else if (!strcmp(property->name, GEOGRAPHIC_COORDINATES_PROPERTY_NAME)) {
+			if (!strcmp(item->name, GEOGRAPHIC_COORDINATES_LATITUDE_ITEM_NAME))
+				mount.latitude = item->number.value;
+			else if (!strcmp(item->name, GEOGRAPHIC_COORDINATES_LONGITUDE_ITEM_NAME))
+				mount.longitude = item->number.value;
+		} else if (!strcmp(property->name, MOUNT_EPHEMERIS_TARGET_PROPERTY_NAME)) {
+			if (!strcmp(item->name, MOUNT_EPHEMERIS_TARGET_RESIDUAL_ITEM_NAME)) {
+				mount.target_state = property->state;
+				mount.residual = item->number.value;
+				mount.ticks++;
+			}
+		}
+	}
+	pthread_cond_broadcast(&mount.cond);
+	pthread_mutex_unlock(&mount.mutex);
+}
+
+static indigo_result client_define_property(indigo_client *client, indigo_device *device, indigo_property *property, const char *message) {
+	store_property(property);
+	return INDIGO_OK;
+}
+
+static indigo_result client_update_property(indigo_client *client, indigo_device *device, indigo_property *property, const char *message) {
+	store_property(property);
+	return INDIGO_OK;
+}
+
+static bool wait_for(bool *flag, int timeout) {
+	struct timespec deadline;
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	deadline.tv_sec += timeout;
+	pthread_mutex_lock(&mount.mutex);
+	while (!*flag)
+		if (pthread_cond_timedwait(&mount.cond, &mount.mutex, &deadline) != 0)
+			break;
+	bool result = *flag;
+	pthread_mutex_unlock(&mount.mutex);
+	return result;
+}
+
+static void track_position(double t, double ra0, double dec0, double *ra, double *dec) {
+	*ra = fmod(ra0 + (TRACK_RA_RATE * t + TRACK_RA_ACCELERATION * t * t) / 54000 + 24, 24);
+	*dec = dec0 + TRACK_DEC_RATE * t / 3600;
+}
+
+static bool write_track(const char *path, time_t start, double ra0, double dec0) {
+	FILE *file = fopen(path, "w");
+	if (file == NULL)
+		return false;
+	fprintf(file, "# recorded track, UTC RA Dec\n");
+	for (int i = 0; i < TRACK_ROWS; i++) {
+		char utc[64];
+		double ra, dec, t = (i - 2) * TRACK_STEP;
+		indigo_timetoisogm(start + (time_t)t, utc, sizeof(utc));
+		track_position(t, ra0, dec0, &ra, &dec);
+		fprintf(file, "%s %.8f %.8f\n", utc, ra, dec);
+	}
+	fclose(file);
+	return true;
+}
+
+static indigo_client client = {
+	"Ephemeris tracking test client", false, NULL, INDIGO_OK, INDIGO_VERSION_CURRENT, NULL,
+	NULL,
+	client_define_property,
+	client_update_property,
+	NULL,
+	NULL,
+	NULL
+};
+
+int main(int argc, const char * argv[]) {
+	indigo_set_log_level(INDIGO_LOG_ERROR);
+	indigo_start();
+	indigo_mount_simulator(INDIGO_DRIVER_INIT, NULL);
+	indigo_attach_client(&client);
+	char device_name[] = MOUNT_SIMULATOR_NAME;
+	indigo_device_connect(&client, device_name);
+	CHECK(wait_for(&mount.connected, 10), "mount simulator connected");
+	indigo_change_switch_property_1(&client, device_name, MOUNT_PARK_PROPERTY_NAME, MOUNT_PARK_UNPARKED_ITEM_NAME, true);
+	CHECK(wait_for(&mount.unparked, 10), "mount unparked");
+	indigo_change_switch_property_1(&client, device_name, MOUNT_TRACKING_PROPERTY_NAME, MOUNT_TRACKING_ON_ITEM_NAME, true);
+	CHECK(wait_for(&mount.tracking, 10), "tracking on");
+
+	// target starts one hour east of meridian at declination of zenith, so it stays well inside of limits, mount is
+	// moved close to it first, so initial slew of tracking engine is short
+	time_t start = time(NULL);
+	double ra0 = fmod(indigo_lst(&start, mount.longitude) + 1 + 24, 24);
+	double dec0 = fmax(-60, fmin(60, mount.latitude));
+	double ra, dec;
+	track_position(time(NULL) - start + SETTLE_TIME / 2, ra0, dec0, &ra, &dec);
+	static const char *items[] = { MOUNT_EQUATORIAL_COORDINATES_RA_ITEM_NAME, MOUNT_EQUATORIAL_COORDINATES_DEC_ITEM_NAME };
+	double values[] = { ra, dec };
+	indigo_change_number_property(&client, device_name, MOUNT_EQUATORIAL_COORDINATES_PROPERTY_NAME, 2, items, values);
+	CHECK(wait_for(&mount.slewed, 60), "mount moved to start of track");
+
+	char path[] = "/tmp/indigo_ephemeris_tracking_test_XXXXXX";
+	int fd = mkstemp(path);
+	if (fd >= 0)
+		close(fd);
+	CHECK(fd >= 0 && write_track(path, start, ra0, dec0), "recorded track written to %s", path);
+	indigo_change_text_property_1(&client, device_name, MOUNT_TRACKING_EPHEMERIS_PROPERTY_NAME, MOUNT_TRACKING_EPHEMERIS_TABLE_ITEM_NAME, "%s", path);
+
+	indigo_usleep(SETTLE_TIME * ONE_SECOND_DELAY);
+	pthread_mutex_lock(&mount.mutex);
+	int ticks = mount.ticks;
+	pthread_mutex_unlock(&mount.mutex);
+	double max_residual = 0, sum = 0;
+	int samples = 0;
+	bool busy = true;
+	for (int i = 0; i < SAMPLE_TIME; i++) {
+		indigo_usleep(ONE_SECOND_DELAY);
+		pthread_mutex_lock(&mount.mutex);
+		max_residual = fmax(max_residual, mount.residual);
+		sum += mount.residual;
+		busy = busy && mount.target_state == INDIGO_BUSY_STATE;
+		samples++;
+		pthread_mutex_unlock(&mount.mutex);
+	}
+	pthread_mutex_lock(&mount.mutex);
+	ticks = mount.ticks - ticks;
+	pthread_mutex_unlock(&mount.mutex);
+	CHECK(ticks >= SAMPLE_TIME / 2, "tracking engine ticking (%d updates in %ds)", ticks, SAMPLE_TIME);
+	CHECK(busy, "target followed without interruption");
+	CHECK(max_residual < MAX_RESIDUAL, "residual bound (max %.2f\", mean %.2f\", limit %.0f\")", max_residual, sum / samples, MAX_RESIDUAL);
+
+	indigo_change_text_property_1(&client, device_name, MOUNT_TRACKING_EPHEMERIS_PROPERTY_NAME, MOUNT_TRACKING_EPHEMERIS_TABLE_ITEM_NAME, "%s", "");
+	indigo_device_disconnect(&client, device_name);
+	indigo_usleep(200000);
+	indigo_detach_client(&client);
+	indigo_mount_simulator(INDIGO_DRIVER_SHUTDOWN, NULL);
+	indigo_stop();
+	unlink(path);
+	printf("%s\n", failures ? "FAILED" : "PASSED");
+	return failures ? 1 : 0;
+}
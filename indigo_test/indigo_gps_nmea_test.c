@@ -0,0 +1,192 @@
+// Copyright (c) 2026 CloudMakers, s. r. o.
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** INDIGO NMEA GPS driver test - replays NMEA log through pseudo terminal
+ \file indigo_gps_nmea_test.c
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <pthread.h>
+
+#include <indigo/indigo_bus.h>
+#include <indigo/indigo_client.h>
+
+#include "gps_nmea/indigo_gps_nmea.h"
+
+#define GPS_DEVICE_NAME	"Generic NMEA 0183 GPS"
+
+static int failures = 0;
+
+#define CHECK(condition, ...) if (!(condition)) { failures++; printf("FAILED: "); printf(__VA_ARGS__); printf("\n"); } else { printf("ok: "); printf(__VA_ARGS__); printf("\n"); }
+
+static const char *log_sentences[] = {
+	"GNRMC,123519.00,A,4807.038,N,01131.000,E,0.0,0.0,190326,,,A",
+	"GNGGA,123519.00,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,",
+	"GPGSV,3,1,11,03,03,111,00,04,15,270,00,06,01,010,00,13,06,292,00",
+	"GLGSV,2,1,07,65,12,045,30,66,40,110,35,72,08,330,00,81,22,200,28",
+	"PUBX,00,123519.00,4807.038,N,01131.000,E,545.4,G3,2.1,2.0,0.0,0.0,0.0,,1.0,1.0,1.0,8,0,0",
+	"GNRMC,123519.00,A,0000.000,N,00000.000,E,0.0,0.0,190326,,,A*00",
+	NULL
+};
+
+static struct {
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	double latitude, longitude, elevation;
+	char utc[INDIGO_VALUE_SIZE];
+	int in_view;
+} gps = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER };
+
+static volatile bool replaying = true;
+
+static void *replay(void *data) {
+	int fd = *(int *)data;
+	char sentence[128];
+	while (replaying) {
+		for (int i = 0; log_sentences[i]; i++) {
+			const char *body = log_sentences[i];
+			if (strchr(body, '*')) {
+				snprintf(sentence, sizeof(sentence), "$%s\r\n", body);
+			} else {
+				int checksum = 0;
+				for (const char *c = body; *c; c++)
+					checksum ^= *c;
+				snprintf(sentence, sizeof(sentence), "$%s*%02X\r\n", body, checksum);
+			}
+			if (write(fd, sentence, strlen(sentence)) < 0)
+				break;
+		}
+		indigo_usleep(100000);
+	}
+	return NULL;
+}
+
+static void store_property(indigo_property *property) {
+	if (strcmp(property->device, GPS_DEVICE_NAME) || property->state != INDIGO_OK_STATE)
+		return;
+	pthread_mutex_lock(&gps.mutex);
+	for (int i = 0; i < property->count; i++) {
+		indigo_item *item = property->items + i;
+		if (!strcmp(property->name, GEOGRAPHIC_COORDINATES_PROPERTY_NAME)) {
+			if (!strcmp(item->name, GEOGRAPHIC_COORDINATES_LATITUDE_ITEM_NAME))
+				gps.latitude = item->number.value;
+			else if (!strcmp(item->name, GEOGRAPHIC_COORDINATES_LONGITUDE_ITEM_NAME))
+				gps.longitude = item->number.value;
+			else if (!strcmp(item->name, GEOGRAPHIC_COORDINATES_ELEVATION_ITEM_NAME))
+				gps.elevation = item->number.value;
+		} else if (!strcmp(property->name, UTC_TIME_PROPERTY_NAME)) {
+			if (!strcmp(item->name, UTC_TIME_ITEM_NAME))
+				snprintf(gps.utc, sizeof(gps.utc), "%s", item->text.value);
+		} else if (!strcmp(property->name, GPS_ADVANCED_STATUS_PROPERTY_MANE)) {
+			if (!strcmp(item->name, GPS_ADVANCED_STATUS_SVS_IN_VIEW_ITEM_NAME))
+				gps.in_view = (int)item->number.value;
+		}
+	}
+	pthread_cond_signal(&gps.cond);
+	pthread_mutex_unlock(&gps.mutex);
+}
+
+static indigo_result client_define_property(indigo_client *client, indigo_device *device, indigo_property *property, const char *message) {
+	store_property(property);
+	return INDIGO_OK;
+}
+
+static indigo_result client_update_property(indigo_client *client, indigo_device *device, indigo_property *property, const char *message) {
+	store_property(property);
+	return INDIGO_OK;
+}
+
+static bool replayed(void) {
+	return gps.elevation == 545 && gps.in_view == 18 && !strcmp(gps.utc, "2026-03-19T12:35:19");
+}
+
+static bool wait_for_replay(void) {
+	struct timespec deadline;
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	deadline.tv_sec += 10;
+	pthread_mutex_lock(&gps.mutex);
+	while (!replayed())
+		if (pthread_cond_timedwait(&gps.cond, &gps.mutex, &deadline) != 0)
+			break;
+	bool result = replayed();
+	pthread_mutex_unlock(&gps.mutex);
+	return result;
+}
+
+static indigo_client client = {
+	"GPS test client", false, NULL, INDIGO_OK, INDIGO_VERSION_CURRENT, NULL,
+	NULL,
+	client_define_property,
+	client_update_property,
+	NULL,
+	NULL,
+	NULL
+};
+
+int main(int argc, const char * argv[]) {
+	indigo_set_log_level(INDIGO_LOG_ERROR);
+	int master = posix_openpt(O_RDWR | O_NOCTTY);
+	if (master < 0 || grantpt(master) < 0 || unlockpt(master) < 0) {
+		printf("FAILED: can't open pseudo terminal\n");
+		return 1;
+	}
+	char port[128];
+	snprintf(port, sizeof(port), "%s", ptsname(master));
+	// keep slave side open and raw, so replay is buffered until driver connects
+	int slave = open(port, O_RDWR | O_NOCTTY);
+	struct termios options;
+	tcgetattr(slave, &options);
+	cfmakeraw(&options);
+	tcsetattr(slave, TCSANOW, &options);
+	fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+	pthread_t thread;
+	pthread_create(&thread, NULL, replay, &master);
+
+	indigo_start();
+	indigo_gps_nmea(INDIGO_DRIVER_INIT, NULL);
+	indigo_attach_client(&client);
+	char device_name[] = GPS_DEVICE_NAME;
+	indigo_change_text_property_1(&client, device_name, DEVICE_PORT_PROPERTY_NAME, DEVICE_PORT_ITEM_NAME, "%s", port);
+	indigo_change_switch_property_1(&client, device_name, GPS_ADVANCED_PROPERTY_NAME, GPS_ADVANCED_ENABLED_ITEM_NAME, true);
+	indigo_device_connect(&client, device_name);
+
+	CHECK(wait_for_replay(), "replay of NMEA log on %s", port);
+	CHECK(gps.latitude == 48.1173 && gps.longitude == 11.5167, "coordinates from RMC/GGA (%g %g)", gps.latitude, gps.longitude);
+	CHECK(gps.elevation == 545, "elevation from GGA (%g)", gps.elevation);
+	CHECK(!strcmp(gps.utc, "2026-03-19T12:35:19"), "UTC from RMC ('%s')", gps.utc);
+	CHECK(gps.in_view == 18, "satellites in view summed over talkers (%d)", gps.in_view);
+
+	indigo_device_disconnect(&client, device_name);
+	indigo_usleep(200000);
+	replaying = false;
+	pthread_join(thread, NULL);
+	indigo_detach_client(&client);
+	indigo_gps_nmea(INDIGO_DRIVER_SHUTDOWN, NULL);
+	indigo_stop();
+	close(slave);
+	close(master);
+	printf("%s\n", failures ? "FAILED" : "PASSED");
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,208 @@
+// Copyright (c) 2026 CloudMakers, s. r. o.
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** INDIGO device handler queue test - checks ordering, exclusivity and cancellation
+ \file indigo_handler_queue_test.c
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <indigo/indigo_bus.h>
+#include <indigo/indigo_driver.h>
+
+#define HANDLER_COUNT		200
+
+static int failures = 0;
+
+#define CHECK(condition, ...) if (!(condition)) { failures++; printf("FAILED: "); printf(__VA_ARGS__); printf("\n"); } else { printf("ok: "); printf(__VA_ARGS__); printf("\n"); }
+
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+
+static struct {
+	int sequence[HANDLER_COUNT];
+	int count;
+	int running, max_running;
+	bool blocked;
+	bool self_cancelled;
+} state;
+
+static void wait_while(bool *flag) {
+	pthread_mutex_lock(&mutex);
+	while (*flag)
+		pthread_cond_wait(&cond, &mutex);
+	pthread_mutex_unlock(&mutex);
+}
+
+static bool wait_for_count(int count) {
+	struct timespec deadline;
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	deadline.tv_sec += 5;
+	pthread_mutex_lock(&mutex);
+	while (state.count < count)
+		if (pthread_cond_timedwait(&cond, &mutex, &deadline) != 0)
+			break;
+	bool result = state.count >= count;
+	pthread_mutex_unlock(&mutex);
+	return result;
+}
+
+// handlers record their tag in order of execution, short sleep gives other workers a chance to overlap
+
+static void record(int tag) {
+	pthread_mutex_lock(&mutex);
+	if (++state.running > state.max_running)
+		state.max_running = state.running;
+	pthread_mutex_unlock(&mutex);
+	indigo_usleep(100);
+	pthread_mutex_lock(&mutex);
+	if (state.count < HANDLER_COUNT)
+		state.sequence[state.count] = tag;
+	state.running--;
+	state.count++;
+	pthread_cond_broadcast(&cond);
+	pthread_mutex_unlock(&mutex);
+}
+
+static void record_handler(indigo_device *device) {
+	record(0);
+}
+
+static void record_handler_1(indigo_device *device) {
+	record(1);
+}
+
+static void record_handler_2(indigo_device *device) {
+	record(2);
+}
+
+static indigo_timer_callback record_handlers[] = { record_handler, record_handler_1, record_handler_2 };
+
+static void blocking_handler(indigo_device *device) {
+	pthread_mutex_lock(&mutex);
+	state.count++;
+	pthread_cond_broadcast(&cond);
+	pthread_mutex_unlock(&mutex);
+	wait_while(&state.blocked);
+}
+
+static void slow_handler(indigo_device *device) {
+	indigo_usleep(200000);
+	pthread_mutex_lock(&mutex);
+	state.count++;
+	pthread_cond_broadcast(&cond);
+	pthread_mutex_unlock(&mutex);
+}
+
+static void self_cancelling_handler(indigo_device *device) {
+	wait_while(&state.blocked);
+	// must not wait for itself
+	indigo_cancel_pending_handlers_sync(device);
+	pthread_mutex_lock(&mutex);
+	state.self_cancelled = true;
+	state.count++;
+	pthread_cond_broadcast(&cond);
+	pthread_mutex_unlock(&mutex);
+}
+
+static indigo_result test_attach(indigo_device *device) {
+	return indigo_device_attach(device, "indigo_handler_queue_test", 0x0001, INDIGO_INTERFACE_AUX);
+}
+
+static indigo_result test_detach(indigo_device *device) {
+	return indigo_device_detach(device);
+}
+
+static indigo_device device = INDIGO_DEVICE_INITIALIZER(
+	"Handler queue test",
+	test_attach,
+	NULL,
+	NULL,
+	NULL,
+	test_detach
+);
+
+static void reset(void) {
+	pthread_mutex_lock(&mutex);
+	memset(&state, 0, sizeof(state));
+	pthread_mutex_unlock(&mutex);
+}
+
+int main(int argc, const char * argv[]) {
+	indigo_set_log_level(INDIGO_LOG_ERROR);
+	indigo_start();
+	indigo_attach_device(&device);
+
+	reset();
+	for (int i = 0; i < HANDLER_COUNT; i++)
+		indigo_execute_handler(&device, record_handlers[(i * 7) % 3]);
+	CHECK(wait_for_count(HANDLER_COUNT), "all %d handlers executed", HANDLER_COUNT);
+	bool ordered = true;
+	for (int i = 0; i < HANDLER_COUNT; i++)
+		ordered = ordered && state.sequence[i] == (i * 7) % 3;
+	CHECK(ordered, "handlers executed in order of submission");
+	CHECK(state.max_running == 1, "handlers for one device never overlap (max %d running)", state.max_running);
+
+	reset();
+	state.blocked = true;
+	indigo_execute_handler(&device, blocking_handler);
+	CHECK(wait_for_count(1), "blocking handler started");
+	for (int i = 0; i < 10; i++)
+		indigo_execute_handler(&device, record_handler);
+	indigo_cancel_pending_handlers(&device);
+	CHECK(state.count == 1, "cancel returned while handler is still running");
+	pthread_mutex_lock(&mutex);
+	state.blocked = false;
+	pthread_cond_broadcast(&cond);
+	pthread_mutex_unlock(&mutex);
+	indigo_cancel_pending_handlers_sync(&device);
+	indigo_usleep(100000);
+	CHECK(state.count == 1, "queued handlers dropped (%d executed)", state.count);
+
+	reset();
+	indigo_execute_handler(&device, slow_handler);
+	indigo_execute_handler(&device, record_handler);
+	indigo_usleep(50000);
+	indigo_cancel_pending_handlers_sync(&device);
+	CHECK(state.count == 1, "sync cancel waited for running handler");
+	indigo_usleep(100000);
+	CHECK(state.count == 1, "handler queued behind running one dropped");
+
+	reset();
+	state.blocked = true;
+	indigo_execute_handler(&device, self_cancelling_handler);
+	indigo_execute_handler(&device, record_handler);
+	pthread_mutex_lock(&mutex);
+	state.blocked = false;
+	pthread_cond_broadcast(&cond);
+	pthread_mutex_unlock(&mutex);
+	CHECK(wait_for_count(1) && state.self_cancelled, "sync cancel from handler itself doesn't deadlock");
+	indigo_usleep(100000);
+	CHECK(state.count == 1, "handler queued behind self cancelling one dropped");
+
+	reset();
+	indigo_execute_handler(&device, record_handler);
+	CHECK(wait_for_count(1), "queue usable after cancellation");
+
+	indigo_detach_device(&device);
+	indigo_stop();
+	printf("%s\n", failures ? "FAILED" : "PASSED");
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,192 @@
+// Copyright (c) 2026 CloudMakers, s. r. o.
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** INDIGO mount limits test - GOTO below horizon and tracking over meridian limit with mount simulator
+ \file indigo_mount_limits_test.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+#include <indigo/indigo_bus.h>
+#include <indigo/indigo_client.h>
+#include <indigo/indigo_novas.h>
+
+#include "mount_simulator/indigo_mount_simulator.h"
+
+// mount crosses meridian limit set this many seconds of hour angle ahead of it
+
+#define CROSSING_TIME		5
+
+static int failures = 0;
+
+#define CHECK(condition, ...) if (!(condition)) { failures++; printf("FAILED: "); printf(__VA_ARGS__); printf("\n"); } else { printf("ok: "); printf(__VA_ARGS__); printf("\n"); }
+
+static struct {
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	bool connected, unparked, tracking, not_tracking, slewed, refused, violated, within;
+	double latitude, longitude, ra, dec;
+	int tracking_stops;
+} mount = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER };
+
+static void store_property(indigo_property *property, const char *message) {
+	if (strcmp(property->device, MOUNT_SIMULATOR_NAME))
+		return;
+	pthread_mutex_lock(&mount.mutex);
+	if (!strcmp(property->name, MOUNT_EQUATORIAL_COORDINATES_PROPERTY_NAME)) {
+		mount.slewed = property->state == INDIGO_OK_STATE;
+		if (property->state == INDIGO_ALERT_STATE && message && strstr(message, "limits"))
+			mount.refused = true;
+	} else if (!strcmp(property->name, MOUNT_LIMITS_PROPERTY_NAME)) {
+		mount.violated = property->state == INDIGO_ALERT_STATE;
+		mount.within = property->state == INDIGO_OK_STATE;
+	}
+	for (int i = 0; i < property->count; i++) {
+		indigo_item *item = property->items + i;
+		if (!strcmp(property->name, CONNECTION_PROPERTY_NAME)) {
+			if (!strcmp(item->name, CONNECTION_CONNECTED_ITEM_NAME))
+				mount.connected = item->sw.value && property->state == INDIGO_OK_STATE;
+		} else if (!strcmp(property->name, MOUNT_PARK_PROPERTY_NAME)) {
+			if (!strcmp(item->name, MOUNT_PARK_UNPARKED_ITEM_NAME))
+				mount.unparked = item->sw.value && property->state == INDIGO_OK_STATE;
+		} else if (!strcmp(property->name, MOUNT_TRACKING_PROPERTY_NAME)) {
+			if (!strcmp(item->name, MOUNT_TRACKING_ON_ITEM_NAME)) {
+				if (mount.tracking && !item->sw.value)
+					mount.tracking_stops++;
+				mount.tracking = item->sw.value;
+				mount.not_tracking = !item->sw.value;
+			}
+		} else if (!strcmp(property->name, GEOGRAPHIC_COORDINATES_PROPERTY_NAME)) {
+			if (!strcmp(item->name, GEOGRAPHIC_COORDINATES_LATITUDE_ITEM_NAME))
+				mount.latitude = item->number.value;
+			else if (!strcmp(item->name, GEOGRAPHIC_COORDINATES_LONGITUDE_ITEM_NAME))
+				mount.longitude = item->number.value;
+		} else if (!strcmp(property->name, MOUNT_EQUATORIAL_COORDINATES_PROPERTY_NAME)) {
+			if (!strcmp(item->name, MOUNT_EQUATORIAL_COORDINATES_RA_ITEM_NAME))
+				mount.ra = item->number.value;
+			else if (!strcmp(item->name, MOUNT_EQUATORIAL_COORDINATES_DEC_ITEM_NAME))
+				mount.dec = item->number.value;
+		}
+	}
+	pthread_cond_broadcast(&mount.cond);
+	pthread_mutex_unlock(&mount.mutex);
+}
+
+static indigo_result client_define_property(indigo_client *client, indigo_device *device, indigo_property *property, const char *message) {
+	store_property(property, message);
+	return INDIGO_OK;
+}
+
+static indigo_result client_update_property(indigo_client *client, indigo_device *device, indigo_property *property, const char *message) {
+	store_property(property, message);
+	return INDIGO_OK;
+}
+
+static bool wait_for(bool *flag, int timeout) {
+	struct timespec deadline;
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	deadline.tv_sec += timeout;
+	pthread_mutex_lock(&mount.mutex);
+	while (!*flag)
+		if (pthread_cond_timedwait(&mount.cond, &mount.mutex, &deadline) != 0)
+			break;
+	bool result = *flag;
+	pthread_mutex_unlock(&mount.mutex);
+	return result;
+}
+
+static indigo_client client = {
+	"Mount limits test client", false, NULL, INDIGO_OK, INDIGO_VERSION_CURRENT, NULL,
+	NULL,
+	client_define_property,
+	client_update_property,
+	NULL,
+	NULL,
+	NULL
+};
+
+static char device_name[] = MOUNT_SIMULATOR_NAME;
+
+static void set_limits(double min_alt, double meridian_east, double meridian_west) {
+	static const char *items[] = { MOUNT_LIMITS_MIN_ALT_ITEM_NAME, MOUNT_LIMITS_HYSTERESIS_ITEM_NAME, MOUNT_LIMITS_MERIDIAN_EAST_ITEM_NAME, MOUNT_LIMITS_MERIDIAN_WEST_ITEM_NAME };
+	double values[] = { min_alt, 1, meridian_east, meridian_west };
+	indigo_change_number_property(&client, device_name, MOUNT_LIMITS_PROPERTY_NAME, 4, items, values);
+}
+
+static void slew(double ra, double dec) {
+	static const char *items[] = { MOUNT_EQUATORIAL_COORDINATES_RA_ITEM_NAME, MOUNT_EQUATORIAL_COORDINATES_DEC_ITEM_NAME };
+	double values[] = { ra, dec };
+	indigo_change_number_property(&client, device_name, MOUNT_EQUATORIAL_COORDINATES_PROPERTY_NAME, 2, items, values);
+}
+
+int main(int argc, const char * argv[]) {
+	indigo_set_log_level(INDIGO_LOG_ERROR);
+	indigo_start();
+	indigo_mount_simulator(INDIGO_DRIVER_INIT, NULL);
+	indigo_attach_client(&client);
+	indigo_device_connect(&client, device_name);
+	CHECK(wait_for(&mount.connected, 10), "mount simulator connected");
+	indigo_change_switch_property_1(&client, device_name, MOUNT_PARK_PROPERTY_NAME, MOUNT_PARK_UNPARKED_ITEM_NAME, true);
+	CHECK(wait_for(&mount.unparked, 10), "mount unparked");
+	// park position may be close to horizon, lowest altitude limit keeps it inside
+	set_limits(-10, 12, 12);
+	indigo_change_switch_property_1(&client, device_name, MOUNT_TRACKING_PROPERTY_NAME, MOUNT_TRACKING_ON_ITEM_NAME, true);
+	CHECK(wait_for(&mount.tracking, 10), "tracking on");
+
+	// target at lower culmination on celestial equator is below horizon for any site except poles
+	double lst = indigo_lst(NULL, mount.longitude);
+	double ra = mount.ra, dec = mount.dec;
+	slew(fmod(lst + 12, 24), 0);
+	CHECK(wait_for(&mount.refused, 5), "GOTO below horizon refused");
+	indigo_usleep(2 * ONE_SECOND_DELAY);
+	pthread_mutex_lock(&mount.mutex);
+	double moved = fabs(mount.ra - ra) * 15 + fabs(mount.dec - dec);
+	pthread_mutex_unlock(&mount.mutex);
+	CHECK(moved < 0.1, "mount stays where it was (moved by %.3f°)", moved);
+
+	// GOTO one hour west of meridian, then move west limit just ahead of mount
+	slew(fmod(indigo_lst(NULL, mount.longitude) - 1 + 24, 24), fmax(-60, fmin(60, mount.latitude)));
+	CHECK(wait_for(&mount.slewed, 60), "GOTO within limits accepted");
+	pthread_mutex_lock(&mount.mutex);
+	double ha = fmod(indigo_lst(NULL, mount.longitude) - mount.ra + 36, 24) - 12;
+	pthread_mutex_unlock(&mount.mutex);
+	set_limits(-10, 12, ha + CROSSING_TIME / 3600.0);
+	CHECK(wait_for(&mount.within, 5), "mount within limits (hour angle %.4f h)", ha);
+	CHECK(wait_for(&mount.not_tracking, CROSSING_TIME + 10), "tracking stopped at meridian limit");
+	CHECK(mount.violated, "limits violation reported");
+
+	// while violation lasts, tracking is stopped only once
+	indigo_change_switch_property_1(&client, device_name, MOUNT_TRACKING_PROPERTY_NAME, MOUNT_TRACKING_ON_ITEM_NAME, true);
+	CHECK(wait_for(&mount.tracking, 5), "tracking resumed by client");
+	indigo_usleep(3 * ONE_SECOND_DELAY);
+	CHECK(mount.tracking && mount.tracking_stops == 1, "tracking not stopped again during the same violation (%d stops)", mount.tracking_stops);
+
+	set_limits(-10, 12, 12);
+	CHECK(wait_for(&mount.within, 5), "violation cleared with relaxed limits");
+	indigo_device_disconnect(&client, device_name);
+	indigo_usleep(200000);
+	indigo_detach_client(&client);
+	indigo_mount_simulator(INDIGO_DRIVER_SHUTDOWN, NULL);
+	indigo_stop();
+	printf("%s\n", failures ? "FAILED" : "PASSED");
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,134 @@
+// Copyright (c) 2026 CloudMakers, s. r. o.
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** INDIGO plate solver test - solves rendered frames of bundled catalogue stars
+ \file indigo_platesolver_test.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <indigo/indigo_bus.h>
+#include <indigo/indigo_cat_data.h>
+#include <indigo/indigo_guider_utils.h>
+#include <indigo/indigo_platesolver.h>
+
+#define WIDTH				1280
+#define HEIGHT			960
+#define MAX_STARS		100
+#define MAX_MAG			7.5
+
+static int failures = 0;
+
+#define CHECK(condition, ...) if (!(condition)) { failures++; printf("FAILED: "); printf(__VA_ARGS__); printf("\n"); } else { printf("ok: "); printf(__VA_ARGS__); printf("\n"); }
+
+static unsigned short frame[WIDTH * HEIGHT];
+
+static void make_wcs(indigo_platesolver_wcs *wcs, double ra, double dec, double scale, double angle, bool flipped) {
+	double s = scale / 3600, a = angle * M_PI / 180;
+	memset(wcs, 0, sizeof(*wcs));
+	wcs->crpix1 = WIDTH / 2.0 + 1;
+	wcs->crpix2 = HEIGHT / 2.0 + 1;
+	wcs->crval1 = ra * 15;
+	wcs->crval2 = dec;
+	wcs->cd1_1 = (flipped ? s : -s) * cos(a);
+	wcs->cd1_2 = s * sin(a);
+	wcs->cd2_1 = (flipped ? -s : s) * sin(a);
+	wcs->cd2_2 = s * cos(a);
+}
+
+// gaussian stars over noisy background, similar to CCD simulator output
+
+static int render(const indigo_platesolver_wcs *wcs) {
+	unsigned seed = 1;
+	for (int i = 0; i < WIDTH * HEIGHT; i++) {
+		seed = seed * 1103515245 + 12345;
+		frame[i] = 1000 + (seed >> 16) % 60;
+	}
+	int count = 0;
+	for (int i = 0; indigo_star_data[i].hip; i++) {
+		indigo_star_entry *star = indigo_star_data + i;
+		double x, y;
+		if (star->mag > MAX_MAG || !indigo_platesolver_radec_to_pixel(wcs, star->ra, star->dec, &x, &y))
+			continue;
+		if (x < 0 || y < 0 || x >= WIDTH || y >= HEIGHT)
+			continue;
+		double amplitude = fmin(60000, 40000 * pow(10, -0.4 * (star->mag - 3)) + 3000);
+		for (int j = (int)y - 6; j <= (int)y + 6; j++) {
+			for (int k = (int)x - 6; k <= (int)x + 6; k++) {
+				if (j < 0 || k < 0 || j >= HEIGHT || k >= WIDTH)
+					continue;
+				double value = frame[j * WIDTH + k] + amplitude * exp(-((k - x) * (k - x) + (j - y) * (j - y)) / (2 * 1.5 * 1.5));
+				frame[j * WIDTH + k] = value > 65535 ? 65535 : (unsigned short)value;
+			}
+		}
+		count++;
+	}
+	return count;
+}
+
+// maximal distance between rendered position and position projected by solved WCS
+
+static double max_error(const indigo_platesolver_wcs *truth, const indigo_platesolver_wcs *solved) {
+	double result = 0;
+	for (int i = 0; indigo_star_data[i].hip; i++) {
+		indigo_star_entry *star = indigo_star_data + i;
+		double x0, y0, x1, y1;
+		if (star->mag > MAX_MAG || !indigo_platesolver_radec_to_pixel(truth, star->ra, star->dec, &x0, &y0))
+			continue;
+		if (x0 < 0 || y0 < 0 || x0 >= WIDTH || y0 >= HEIGHT)
+			continue;
+		if (!indigo_platesolver_radec_to_pixel(solved, star->ra, star->dec, &x1, &y1))
+			return INFINITY;
+		result = fmax(result, hypot(x1 - x0, y1 - y0));
+	}
+	return result;
+}
+
+static void solve(const char *name, double ra, double dec, double scale, double angle, bool flipped, const indigo_platesolver_hint *hint) {
+	indigo_platesolver_wcs truth, wcs;
+	make_wcs(&truth, ra, dec, scale, angle, flipped);
+	int rendered = render(&truth);
+	indigo_star_detection stars[MAX_STARS];
+	int count = 0;
+	indigo_find_stars(INDIGO_RAW_MONO16, frame, WIDTH, HEIGHT, MAX_STARS, stars, &count);
+	bool solved = indigo_platesolver_solve(stars, count, WIDTH, HEIGHT, hint, &wcs);
+	CHECK(solved, "%s solved (%d stars rendered, %d detected, %d matched)", name, rendered, count, solved ? wcs.matched : 0);
+	if (!solved)
+		return;
+	double distance = acos(fmin(1, sin(dec * M_PI / 180) * sin(wcs.dec * M_PI / 180) + cos(dec * M_PI / 180) * cos(wcs.dec * M_PI / 180) * cos((ra - wcs.ra) * M_PI / 12))) * 180 / M_PI;
+	CHECK(distance < 0.01, "%s centre %.4f %.4f (%.1f\" off)", name, wcs.ra, wcs.dec, distance * 3600);
+	CHECK(fabs(wcs.scale - scale) < 0.005 * scale, "%s scale %.3f\"/px", name, wcs.scale);
+	CHECK(wcs.flipped == (truth.cd1_1 * truth.cd2_2 - truth.cd1_2 * truth.cd2_1 < 0), "%s parity", name);
+	double error = max_error(&truth, &wcs);
+	CHECK(error < 1.5, "%s catalogue stars within %.2f px", name, error);
+}
+
+int main(int argc, const char * argv[]) {
+	indigo_set_log_level(INDIGO_LOG_ERROR);
+	CHECK(indigo_platesolver_build_index() && indigo_platesolver_catalogue_size() > 0, "bundled catalogue indexed (%d stars)", indigo_platesolver_catalogue_size());
+	solve("Orion", 5.5, -1, 30, 20, false, NULL);
+	solve("Orion mirrored", 5.5, -1, 30, 20, true, NULL);
+	solve("Cassiopeia", 0.9, 60, 45, -110, false, NULL);
+	indigo_platesolver_hint hint = { 18.6, 38.8, 5, 20, 40 };
+	solve("Vega with hint", 18.6, 38.8, 30, 75, false, &hint);
+	printf("%s\n", failures ? "FAILED" : "PASSED");
+	return failures ? 1 : 0;
+}
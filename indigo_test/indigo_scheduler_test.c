@@ -0,0 +1,353 @@
+// Copyright (c) 2026 CloudMakers, s. r. o.
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** INDIGO scheduler test - runs a night with simulated clock against stub imager and mount agents
+ \file indigo_scheduler_test.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+#include <indigo/indigo_bus.h>
+#include <indigo/indigo_client.h>
+#include <indigo/indigo_driver.h>
+#include <indigo/indigo_novas.h>
+
+#include "agent_scheduler/indigo_agent_scheduler.h"
+
+// session is simulated far from today, so apparent place at wall clock differs from the one at session clock by
+// about a minute of RA for targets used below
+
+#define SESSION_START			"2040-01-15T15:00:00"
+#define SITE_LATITUDE			48.1
+#define SITE_LONGITUDE		17.1
+
+#define IMAGER_AGENT_NAME	"Imager Agent"
+#define MOUNT_AGENT_NAME	"Mount Agent"
+
+#define MAX_BATCHES				32
+
+static int failures = 0;
+
+#define CHECK(condition, ...) if (!(condition)) { failures++; printf("FAILED: "); printf(__VA_ARGS__); printf("\n"); } else { printf("ok: "); printf(__VA_ARGS__); printf("\n"); }
+
+static struct {
+	const char *name;
+	double ra, dec;
+	int count;
+} targets[] = {
+	{ "A", 18, 70, 10 },
+	{ "B", 6, 70, 10 },
+	{ "C", 12, 70, 4 }
+};
+
+#define TARGET_COUNT	(int)(sizeof(targets) / sizeof(targets[0]))
+
+static const char *target_definitions[TARGET_COUNT] = {
+	"name=A;ra=18;dec=70;priority=1;alt=20;moon=0;exposure=300;count=10",
+	"name=B;ra=6;dec=70;priority=2;alt=20;moon=0;exposure=300;count=10",
+	"name=C;ra=12;dec=70;priority=3;alt=20;moon=0;after=2040-01-15T21:00:00;exposure=600;count=4"
+};
+
+// -------------------------------------------------------------------------------- stub agents
+
+static struct {
+	pthread_mutex_t mutex;
+	double ra, dec;
+	struct {
+		double ra, dec;
+		int count;
+	} batches[MAX_BATCHES];
+	int batch_count;
+} session = { PTHREAD_MUTEX_INITIALIZER };
+
+static indigo_property *imager_process_property, *imager_batch_property;
+static indigo_property *mount_coordinates_property, *mount_park_property, *mount_on_set_property, *mount_geographic_property, *mount_process_property;
+
+static indigo_result imager_enumerate_properties(indigo_device *device, indigo_client *client, indigo_property *property);
+static indigo_result mount_enumerate_properties(indigo_device *device, indigo_client *client, indigo_property *property);
+
+static indigo_result imager_attach(indigo_device *device) {
+	if (indigo_device_attach(device, "indigo_scheduler_test", 0x0001, INDIGO_INTERFACE_AGENT) != INDIGO_OK)
+		return INDIGO_FAILED;
+	imager_process_property = indigo_init_switch_property(NULL, device->name, AGENT_START_PROCESS_PROPERTY_NAME, "Agent", "Start process", INDIGO_IDLE_STATE, INDIGO_RW_PERM, INDIGO_AT_MOST_ONE_RULE, 2);
+	indigo_init_switch_item(imager_process_property->items + 0, AGENT_IMAGER_START_EXPOSURE_ITEM_NAME, "Start batch", false);
+	indigo_init_switch_item(imager_process_property->items + 1, AGENT_IMAGER_START_FOCUSING_ITEM_NAME, "Start focusing", false);
+	imager_batch_property = indigo_init_number_property(NULL, device->name, AGENT_IMAGER_BATCH_PROPERTY_NAME, "Agent", "Batch settings", INDIGO_OK_STATE, INDIGO_RW_PERM, 3);
+	indigo_init_number_item(imager_batch_property->items + 0, AGENT_IMAGER_BATCH_COUNT_ITEM_NAME, "Frame count", -1, 0xFFFF, 1, 1);
+	indigo_init_number_item(imager_batch_property->items + 1, AGENT_IMAGER_BATCH_EXPOSURE_ITEM_NAME, "Exposure time", 0, 0xFFFF, 1, 1);
+	indigo_init_number_item(imager_batch_property->items + 2, AGENT_IMAGER_BATCH_DELAY_ITEM_NAME, "Delay after each exposure", 0, 0xFFFF, 1, 0);
+	return imager_enumerate_properties(device, NULL, NULL);
+}
+
+static indigo_result imager_enumerate_properties(indigo_device *device, indigo_client *client, indigo_property *property) {
+	if (indigo_property_match(imager_process_property, property))
+		indigo_define_property(device, imager_process_property, NULL);
+	if (indigo_property_match(imager_batch_property, property))
+		indigo_define_property(device, imager_batch_property, NULL);
+	return indigo_device_enumerate_properties(device, client, property);
+}
+
+static indigo_result imager_change_property(indigo_device *device, indigo_client *client, indigo_property *property) {
+	if (indigo_property_match(imager_batch_property, property)) {
+		indigo_property_copy_values(imager_batch_property, property, false);
+		indigo_update_property(device, imager_batch_property, NULL);
+		return INDIGO_OK;
+	} else if (indigo_property_match(imager_process_property, property)) {
+		indigo_property_copy_values(imager_process_property, property, false);
+		if (imager_process_property->items[0].sw.value) {
+			// batch is finished immediately, scheduler advances its clock by nominal duration of the frames
+			pthread_mutex_lock(&session.mutex);
+			if (session.batch_count < MAX_BATCHES) {
+				session.batches[session.batch_count].ra = session.ra;
+				session.batches[session.batch_count].dec = session.dec;
+				session.batches[session.batch_count].count = (int)imager_batch_property->items[0].number.value;
+				session.batch_count++;
+			}
+			pthread_mutex_unlock(&session.mutex);
+		}
+		imager_process_property->items[0].sw.value = imager_process_property->items[1].sw.value = false;
+		imager_process_property->state = INDIGO_OK_STATE;
+		indigo_update_property(device, imager_process_property, NULL);
+		return INDIGO_OK;
+	}
+	return indigo_device_change_property(device, client, property);
+}
+
+static indigo_result imager_detach(indigo_device *device) {
+	indigo_release_property(imager_process_property);
+	indigo_release_property(imager_batch_property);
+	return indigo_device_detach(device);
+}
+
+static indigo_result mount_attach(indigo_device *device) {
+	if (indigo_device_attach(device, "indigo_scheduler_test", 0x0001, INDIGO_INTERFACE_AGENT) != INDIGO_OK)
+		return INDIGO_FAILED;
+	mount_coordinates_property = indigo_init_number_property(NULL, device->name, MOUNT_EQUATORIAL_COORDINATES_PROPERTY_NAME, "Mount", "Equatorial coordinates", INDIGO_OK_STATE, INDIGO_RW_PERM, 2);
+	indigo_init_number_item(mount_coordinates_property->items + 0, MOUNT_EQUATORIAL_COORDINATES_RA_ITEM_NAME, "Right ascension", 0, 24, 0, 0);
+	indigo_init_number_item(mount_coordinates_property->items + 1, MOUNT_EQUATORIAL_COORDINATES_DEC_ITEM_NAME, "Declination", -90, 90, 0, 90);
+	mount_park_property = indigo_init_switch_property(NULL, device->name, MOUNT_PARK_PROPERTY_NAME, "Mount", "Park", INDIGO_OK_STATE, INDIGO_RW_PERM, INDIGO_ONE_OF_MANY_RULE, 2);
+	indigo_init_switch_item(mount_park_property->items + 0, MOUNT_PARK_PARKED_ITEM_NAME, "Mount parked", true);
+	indigo_init_switch_item(mount_park_property->items + 1, MOUNT_PARK_UNPARKED_ITEM_NAME, "Mount unparked", false);
+	mount_on_set_property = indigo_init_switch_property(NULL, device->name, MOUNT_ON_COORDINATES_SET_PROPERTY_NAME, "Mount", "On coordinates set", INDIGO_OK_STATE, INDIGO_RW_PERM, INDIGO_ONE_OF_MANY_RULE, 2);
+	indigo_init_switch_item(mount_on_set_property->items + 0, MOUNT_ON_COORDINATES_SET_TRACK_ITEM_NAME, "Slew to target and track", true);
+	indigo_init_switch_item(mount_on_set_property->items + 1, MOUNT_ON_COORDINATES_SET_SYNC_ITEM_NAME, "Sync to target", false);
+	mount_geographic_property = indigo_init_number_property(NULL, device->name, GEOGRAPHIC_COORDINATES_PROPERTY_NAME, "Site", "Location", INDIGO_OK_STATE, INDIGO_RW_PERM, 3);
+	indigo_init_number_item(mount_geographic_property->items + 0, GEOGRAPHIC_COORDINATES_LATITUDE_ITEM_NAME, "Latitude", -90, 90, 0, SITE_LATITUDE);
+	indigo_init_number_item(mount_geographic_property->items + 1, GEOGRAPHIC_COORDINATES_LONGITUDE_ITEM_NAME, "Longitude", -180, 360, 0, SITE_LONGITUDE);
+	indigo_init_number_item(mount_geographic_property->items + 2, GEOGRAPHIC_COORDINATES_ELEVATION_ITEM_NAME, "Elevation", -400, 8000, 0, 200);
+	mount_process_property = indigo_init_switch_property(NULL, device->name, AGENT_START_PROCESS_PROPERTY_NAME, "Agent", "Start process", INDIGO_IDLE_STATE, INDIGO_RW_PERM, INDIGO_AT_MOST_ONE_RULE, 1);
+	indigo_init_switch_item(mount_process_property->items + 0, AGENT_MOUNT_START_CENTERING_ITEM_NAME, "Start centering", false);
+	return mount_enumerate_properties(device, NULL, NULL);
+}
+
+static indigo_result mount_enumerate_properties(indigo_device *device, indigo_client *client, indigo_property *property) {
+	if (indigo_property_match(mount_coordinates_property, property))
+		indigo_define_property(device, mount_coordinates_property, NULL);
+	if (indigo_property_match(mount_park_property, property))
+		indigo_define_property(device, mount_park_property, NULL);
+	if (indigo_property_match(mount_on_set_property, property))
+		indigo_define_property(device, mount_on_set_property, NULL);
+	if (indigo_property_match(mount_geographic_property, property))
+		indigo_define_property(device, mount_geographic_property, NULL);
+	if (indigo_property_match(mount_process_property, property))
+		indigo_define_property(device, mount_process_property, NULL);
+	return indigo_device_enumerate_properties(device, client, property);
+}
+
+static indigo_result mount_change_property(indigo_device *device, indigo_client *client, indigo_property *property) {
+	indigo_property *properties[] = { mount_coordinates_property, mount_park_property, mount_on_set_property, mount_geographic_property, mount_process_property };
+	for (int i = 0; i < (int)(sizeof(properties) / sizeof(properties[0])); i++) {
+		if (indigo_property_match(properties[i], property)) {
+			// every request is finished immediately
+			indigo_property_copy_values(properties[i], property, false);
+			if (properties[i] == mount_coordinates_property) {
+				pthread_mutex_lock(&session.mutex);
+				session.ra = mount_coordinates_property->items[0].number.value;
+				session.dec = mount_coordinates_property->items[1].number.value;
+				pthread_mutex_unlock(&session.mutex);
+			} else if (properties[i] == mount_process_property) {
+				mount_process_property->items[0].sw.value = false;
+			}
+			properties[i]->state = INDIGO_OK_STATE;
+			indigo_update_property(device, properties[i], NULL);
+			return INDIGO_OK;
+		}
+	}
+	return indigo_device_change_property(device, client, property);
+}
+
+static indigo_result mount_detach(indigo_device *device) {
+	indigo_release_property(mount_coordinates_property);
+	indigo_release_property(mount_park_property);
+	indigo_release_property(mount_on_set_property);
+	indigo_release_property(mount_geographic_property);
+	indigo_release_property(mount_process_property);
+	return indigo_device_detach(device);
+}
+
+static indigo_device imager_agent = INDIGO_DEVICE_INITIALIZER(IMAGER_AGENT_NAME, imager_attach, imager_enumerate_properties, imager_change_property, NULL, imager_detach);
+static indigo_device mount_agent = INDIGO_DEVICE_INITIALIZER(MOUNT_AGENT_NAME, mount_attach, mount_enumerate_properties, mount_change_property, NULL, mount_detach);
+
+// -------------------------------------------------------------------------------- test client
+
+static struct {
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	bool agents_listed, started, finished;
+	indigo_property_state state;
+} scheduler = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER };
+
+static void store_property(indigo_property *property) {
+	if (strcmp(property->device, SCHEDULER_AGENT_NAME))
+		return;
+	pthread_mutex_lock(&scheduler.mutex);
+	if (!strcmp(property->name, FILTER_RELATED_AGENT_LIST_PROPERTY_NAME)) {
+		scheduler.agents_listed = indigo_get_item(property, IMAGER_AGENT_NAME) && indigo_get_item(property, MOUNT_AGENT_NAME);
+	} else if (!strcmp(property->name, AGENT_START_PROCESS_PROPERTY_NAME)) {
+		if (property->state == INDIGO_BUSY_STATE)
+			scheduler.started = true;
+		else if (scheduler.started)
+			scheduler.finished = true;
+		scheduler.state = property->state;
+	}
+	pthread_cond_broadcast(&scheduler.cond);
+	pthread_mutex_unlock(&scheduler.mutex);
+}
+
+static indigo_result client_define_property(indigo_client *client, indigo_device *device, indigo_property *property, const char *message) {
+	store_property(property);
+	return INDIGO_OK;
+}
+
+static indigo_result client_update_property(indigo_client *client, indigo_device *device, indigo_property *property, const char *message) {
+	store_property(property);
+	return INDIGO_OK;
+}
+
+static bool wait_for(bool *flag, int timeout) {
+	struct timespec deadline;
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	deadline.tv_sec += timeout;
+	pthread_mutex_lock(&scheduler.mutex);
+	while (!*flag)
+		if (pthread_cond_timedwait(&scheduler.cond, &scheduler.mutex, &deadline) != 0)
+			break;
+	bool result = *flag;
+	pthread_mutex_unlock(&scheduler.mutex);
+	return result;
+}
+
+static indigo_client client = {
+	"Scheduler test client", false, NULL, INDIGO_OK, INDIGO_VERSION_CURRENT, NULL,
+	NULL,
+	client_define_property,
+	client_update_property,
+	NULL,
+	NULL,
+	NULL
+};
+
+static int target_of_batch(int batch) {
+	int best = -1;
+	double best_distance = 0;
+	for (int i = 0; i < TARGET_COUNT; i++) {
+		double distance = fabs(fmod(session.batches[batch].ra - targets[i].ra + 36, 24) - 12) * 15 + fabs(session.batches[batch].dec - targets[i].dec);
+		if (best == -1 || distance < best_distance) {
+			best = i;
+			best_distance = distance;
+		}
+	}
+	return best;
+}
+
+int main(int argc, const char * argv[]) {
+	char device_name[] = SCHEDULER_AGENT_NAME;
+	indigo_set_log_level(INDIGO_LOG_ERROR);
+	indigo_start();
+	indigo_attach_client(&client);
+	indigo_agent_scheduler(INDIGO_DRIVER_INIT, NULL);
+	indigo_attach_device(&imager_agent);
+	indigo_attach_device(&mount_agent);
+	CHECK(wait_for(&scheduler.agents_listed, 5), "stub agents listed by scheduler");
+
+	static const char *agent_names[] = { IMAGER_AGENT_NAME, MOUNT_AGENT_NAME };
+	bool agent_values[] = { true, true };
+	indigo_change_switch_property(&client, device_name, FILTER_RELATED_AGENT_LIST_PROPERTY_NAME, 2, agent_names, agent_values);
+	static const char *settings_names[] = { AGENT_SCHEDULER_SETTINGS_MIN_ALTITUDE_ITEM_NAME, AGENT_SCHEDULER_SETTINGS_MOON_DISTANCE_ITEM_NAME, AGENT_SCHEDULER_SETTINGS_SUN_ALTITUDE_ITEM_NAME, AGENT_SCHEDULER_SETTINGS_RETRIES_ITEM_NAME, AGENT_SCHEDULER_SETTINGS_SPEED_ITEM_NAME };
+	double settings_values[] = { 30, 0, -12, 0, 100000 };
+	indigo_change_number_property(&client, device_name, AGENT_SCHEDULER_SETTINGS_PROPERTY_NAME, 5, settings_names, settings_values);
+	indigo_change_switch_property_1(&client, device_name, AGENT_SCHEDULER_CLOCK_PROPERTY_NAME, AGENT_SCHEDULER_CLOCK_SIMULATED_ITEM_NAME, true);
+	indigo_change_text_property_1(&client, device_name, AGENT_SCHEDULER_SIMULATION_PROPERTY_NAME, AGENT_SCHEDULER_SIMULATION_START_ITEM_NAME, "%s", SESSION_START);
+	// unused target slots are cleared, so nothing is left over from saved configuration
+	char target_names[16][8];
+	const char *target_name_pointers[16], *target_values[16];
+	for (int i = 0; i < 16; i++) {
+		sprintf(target_names[i], "%02d", i + 1);
+		target_name_pointers[i] = target_names[i];
+		target_values[i] = i < TARGET_COUNT ? target_definitions[i] : "";
+	}
+	indigo_change_text_property(&client, device_name, AGENT_SCHEDULER_TARGETS_PROPERTY_NAME, 16, target_name_pointers, target_values);
+	indigo_usleep(ONE_SECOND_DELAY);
+
+	indigo_change_switch_property_1(&client, device_name, AGENT_START_PROCESS_PROPERTY_NAME, AGENT_SCHEDULER_START_SCHEDULE_ITEM_NAME, true);
+	CHECK(wait_for(&scheduler.started, 5), "session started");
+	CHECK(wait_for(&scheduler.finished, 120), "session finished");
+	CHECK(scheduler.state == INDIGO_OK_STATE, "session succeeded");
+
+	// higher priority first, target with "after" constraint waits for its window
+	static const int expected_order[] = { 1, 0, 2 };
+	int frames[TARGET_COUNT] = { 0 }, order[MAX_BATCHES], order_count = 0;
+	pthread_mutex_lock(&session.mutex);
+	for (int i = 0; i < session.batch_count; i++) {
+		int target = target_of_batch(i);
+		frames[target] += session.batches[i].count;
+		if (order_count == 0 || order[order_count - 1] != target)
+			order[order_count++] = target;
+	}
+	pthread_mutex_unlock(&session.mutex);
+	bool order_ok = order_count == TARGET_COUNT;
+	for (int i = 0; order_ok && i < TARGET_COUNT; i++)
+		order_ok = order[i] == expected_order[i];
+	CHECK(order_ok, "targets observed in order B, A, C (%d batches)", session.batch_count);
+	for (int i = 0; i < TARGET_COUNT; i++)
+		CHECK(frames[i] == targets[i].count, "%d/%d frames of %s", frames[i], targets[i].count, targets[i].name);
+
+	// slew went to apparent place at session clock
+	if (session.batch_count > 0) {
+		time_t start = indigo_isogmtotime(SESSION_START);
+		int target = target_of_batch(0);
+		double ra = targets[target].ra, dec = targets[target].dec;
+		indigo_novas_context context;
+		indigo_novas_context_init(&context, 300);
+		indigo_novas_app_star(&context, &start, 1, NULL, NULL, NULL, NULL, &ra, &dec);
+		double error = fabs(session.batches[0].ra - ra) * 54000;
+		CHECK(error < 10, "slew to apparent place at session clock (%.1f\" off)", error);
+	}
+
+	indigo_detach_device(&mount_agent);
+	indigo_detach_device(&imager_agent);
+	indigo_agent_scheduler(INDIGO_DRIVER_SHUTDOWN, NULL);
+	indigo_detach_client(&client);
+	indigo_stop();
+	printf("%s\n", failures ? "FAILED" : "PASSED");
+	return failures ? 1 : 0;
+}
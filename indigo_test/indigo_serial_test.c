@@ -0,0 +1,135 @@
+// Copyright (c) 2026 CloudMakers, s. r. o.
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** INDIGO serial transport test - drives transport against scripted loopback
+ \file indigo_serial_test.c
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <indigo/indigo_bus.h>
+#include <indigo/indigo_io.h>
+
+static int failures = 0;
+
+#define CHECK(condition, ...) if (!(condition)) { failures++; printf("FAILED: "); printf(__VA_ARGS__); printf("\n"); } else { printf("ok: "); printf(__VA_ARGS__); printf("\n"); }
+
+static const indigo_serial_script script[] = {
+	{ ":GP#", "1234#" },
+	{ ":GT#", "0040#" },
+	{ ":GI#", "00#" },
+	{ ":FG#", NULL },
+	{ ":SILENT#", NULL },
+	{ NULL, NULL }
+};
+
+typedef struct {
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	int count;
+	char responses[3][32];
+	int nested;
+} collector;
+
+static void collect_callback(indigo_serial_transport *transport, void *data, const char *response, int length) {
+	collector *c = data;
+	pthread_mutex_lock(&c->mutex);
+	if (c->count < 3)
+		snprintf(c->responses[c->count], sizeof(c->responses[0]), "%.*s", response ? length : 4, response ? response : "FAIL");
+	c->count++;
+	pthread_cond_signal(&c->cond);
+	pthread_mutex_unlock(&c->mutex);
+}
+
+static void nested_callback(indigo_serial_transport *transport, void *data, const char *response, int length) {
+	collector *c = data;
+	char buffer[32];
+	int result = indigo_serial_command(transport, ":GP#", "#", 0, 1, buffer, sizeof(buffer));
+	pthread_mutex_lock(&c->mutex);
+	c->nested = result;
+	c->count++;
+	pthread_cond_signal(&c->cond);
+	pthread_mutex_unlock(&c->mutex);
+}
+
+static bool wait_for(collector *c, int count) {
+	struct timespec deadline;
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	deadline.tv_sec += 5;
+	pthread_mutex_lock(&c->mutex);
+	while (c->count < count)
+		if (pthread_cond_timedwait(&c->cond, &c->mutex, &deadline) != 0)
+			break;
+	bool result = c->count >= count;
+	pthread_mutex_unlock(&c->mutex);
+	return result;
+}
+
+int main(int argc, const char * argv[]) {
+	indigo_set_log_level(INDIGO_LOG_ERROR);
+	char device_name[128];
+	indigo_serial_loopback *loopback = indigo_serial_loopback_open(script, device_name, sizeof(device_name));
+	if (loopback == NULL) {
+		printf("FAILED: can't open loopback\n");
+		return 1;
+	}
+	int handle = indigo_open_serial(device_name);
+	if (handle < 0) {
+		printf("FAILED: can't open %s\n", device_name);
+		indigo_serial_loopback_close(loopback);
+		return 1;
+	}
+	indigo_serial_transport *transport = indigo_serial_open(handle, 3);
+	CHECK(transport != NULL, "transport opened on %s", device_name);
+	if (transport == NULL) {
+		indigo_serial_loopback_close(loopback);
+		return 1;
+	}
+
+	char response[32];
+	int length = indigo_serial_command(transport, ":GP#", "#", 0, 1, response, sizeof(response));
+	CHECK(length == 4 && !strcmp(response, "1234"), "synchronous command (%d '%s')", length, length < 0 ? "" : response);
+
+	collector c = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER };
+	indigo_serial_submit(transport, ":GP#", -1, "#", 0, 1, collect_callback, &c);
+	indigo_serial_submit(transport, ":GT#", -1, "#", 0, 1, collect_callback, &c);
+	indigo_serial_submit(transport, ":GI#", -1, NULL, 3, 1, collect_callback, &c);
+	CHECK(wait_for(&c, 3), "pipelined commands completed");
+	CHECK(!strcmp(c.responses[0], "1234") && !strcmp(c.responses[1], "0040") && !strcmp(c.responses[2], "00#"), "pipelined responses in order ('%s' '%s' '%s')", c.responses[0], c.responses[1], c.responses[2]);
+
+	c.count = 0;
+	indigo_serial_submit(transport, ":FG#", -1, NULL, 0, 1, collect_callback, &c);
+	CHECK(wait_for(&c, 1) && !strcmp(c.responses[0], ""), "command without response completed on write");
+
+	length = indigo_serial_command(transport, ":SILENT#", "#", 0, 0.2, response, sizeof(response));
+	CHECK(length == -1, "unanswered command timed out");
+	length = indigo_serial_command(transport, ":GT#", "#", 0, 1, response, sizeof(response));
+	CHECK(length == 4 && !strcmp(response, "0040"), "command after timeout matched its own response (%d '%s')", length, length < 0 ? "" : response);
+
+	c.count = 0;
+	c.nested = 0;
+	indigo_serial_submit(transport, ":GI#", -1, NULL, 3, 1, nested_callback, &c);
+	CHECK(wait_for(&c, 1) && c.nested == -1, "synchronous command from callback rejected");
+
+	indigo_serial_close(transport);
+	indigo_serial_loopback_close(loopback);
+	printf("%s\n", failures ? "FAILED" : "PASSED");
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,108 @@
+// Copyright (c) 2026 CloudMakers, s. r. o.
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** INDIGO SGP4 test - TEME states against verification TLEs of Vallado et al. (AIAA 2006-6753)
+ \file indigo_sgp4_test.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <indigo/indigo_bus.h>
+#include <indigo/indigo_sgp4.h>
+
+// reference values are printed with 8 (position, km) and 9 (velocity, km/s) decimals
+
+#define MAX_POSITION_ERROR		1e-6
+#define MAX_VELOCITY_ERROR		1e-8
+
+static int failures = 0;
+
+#define CHECK(condition, ...) if (!(condition)) { failures++; printf("FAILED: "); printf(__VA_ARGS__); printf("\n"); } else { printf("ok: "); printf(__VA_ARGS__); printf("\n"); }
+
+// SGP4-VER.TLE and tcppver.out (WGS72)
+
+static const char *tle_00005 =
+	"1 00005U 58002B   00179.78495062  .00000023  00000-0  28098-4 0  4753\n"
+	"2 00005  34.2682 348.7242 1859667 331.7664  19.3264 10.82419157413667\n";
+
+static const char *tle_06251 =
+	"1 06251U 62025E   06176.82412014  .00008885  00000-0  12808-3 0  3985\n"
+	"2 06251  58.0579  54.0425 0030035 139.1568 221.1854 15.56387291  6774\n";
+
+typedef struct {
+	double minutes;
+	double pos[3];
+	double vel[3];
+} reference_state;
+
+static const reference_state states_00005[] = {
+	{ 0, { 7022.46529266, -1400.08296755, 0.03995155 }, { 1.893841015, 6.405893759, 4.534807250 } },
+	{ 360, { -7154.03120202, -3783.17682504, -3536.19412294 }, { 4.741887409, -4.151817765, -2.093935425 } },
+	{ 720, { -7134.59340119, 6531.68641334, 3260.27186483 }, { -4.113793027, -2.911922039, -2.557327851 } },
+	{ 1080, { 5568.53901181, 4492.06992591, 3863.87641983 }, { -4.209106476, 5.159719888, 2.744852980 } },
+	{ 1440, { -938.55923943, -6268.18748831, -4294.02924751 }, { 7.536105209, -0.427127707, 0.989878080 } },
+	{ 4320, { -9060.47373569, 4658.70952502, 813.68673153 }, { -2.232832783, -4.110453490, -3.157345433 } }
+};
+
+static const reference_state states_06251[] = {
+	{ 0, { 3988.31022699, 5498.96657235, 0.90055879 }, { -3.290032738, 2.357652820, 6.496623475 } },
+	{ 120, { -3935.69800083, 409.10980837, 5471.33577327 }, { -3.374784183, -6.635211043, -1.942056221 } },
+	{ 240, { -1675.12766915, -5683.30432352, -3286.21510937 }, { 5.282496925, 1.508674259, -5.354872978 } },
+	{ 360, { 4993.62642836, 2890.54969900, -3600.40145627 }, { 0.347333429, 5.707031557, 5.070699638 } },
+	{ 480, { -1115.07959514, 4015.11691491, 5326.99727718 }, { -5.524279443, -4.765738774, 2.402255961 } }
+};
+
+static double difference(const double *a, const double *b) {
+	return sqrt((a[0] - b[0]) * (a[0] - b[0]) + (a[1] - b[1]) * (a[1] - b[1]) + (a[2] - b[2]) * (a[2] - b[2]));
+}
+
+static void check_satellite(const char *text, const reference_state *states, int count) {
+	indigo_tle tle;
+	memset(&tle, 0, sizeof(tle));
+	if (!indigo_tle_parse(text, &tle)) {
+		failures++;
+		printf("FAILED: can't parse TLE\n%s", text);
+		return;
+	}
+	bool propagated = true;
+	double max_position = 0, max_velocity = 0;
+	for (int i = 0; i < count; i++) {
+		double pos[3], vel[3];
+		if (!indigo_sgp4_propagate(&tle, states[i].minutes, pos, vel)) {
+			propagated = false;
+			continue;
+		}
+		max_position = fmax(max_position, difference(pos, states[i].pos));
+		max_velocity = fmax(max_velocity, difference(vel, states[i].vel));
+	}
+	CHECK(propagated, "%05d propagated to %g minutes since epoch", tle.number, states[count - 1].minutes);
+	CHECK(max_position < MAX_POSITION_ERROR, "%05d TEME position (max error %.1e km)", tle.number, max_position);
+	CHECK(max_velocity < MAX_VELOCITY_ERROR, "%05d TEME velocity (max error %.1e km/s)", tle.number, max_velocity);
+}
+
+int main(int argc, const char * argv[]) {
+	indigo_set_log_level(INDIGO_LOG_ERROR);
+	// 00005 is eccentric near earth orbit, 06251 is near earth orbit with normal drag
+	check_satellite(tle_00005, states_00005, sizeof(states_00005) / sizeof(reference_state));
+	check_satellite(tle_06251, states_06251, sizeof(states_06251) / sizeof(reference_state));
+	printf("%s\n", failures ? "FAILED" : "PASSED");
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,240 @@
+// Copyright (c) 2026 CloudMakers, s. r. o.
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** INDIGO record store test - torn and corrupted records, compaction, batch save and .config import
+ \file indigo_store_test.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include <indigo/indigo_bus.h>
+#include <indigo/indigo_driver.h>
+#include <indigo/indigo_io.h>
+#include <indigo/indigo_store.h>
+
+// offset of checksum in record header (magic, type, reserved, key length, value length)
+
+#define RECORD_CHECKSUM_OFFSET	16
+
+#define DEVICE_NAME							"Store test"
+
+static int failures = 0;
+
+#define CHECK(condition, ...) if (!(condition)) { failures++; printf("FAILED: "); printf(__VA_ARGS__); printf("\n"); } else { printf("ok: "); printf(__VA_ARGS__); printf("\n"); }
+
+static char directory[] = "/tmp/indigo_store_test_XXXXXX";
+
+static long file_size(const char *path) {
+	struct stat st;
+	return stat(path, &st) == 0 ? st.st_size : -1;
+}
+
+static bool exists(const char *path) {
+	return access(path, F_OK) == 0;
+}
+
+static bool has_value(indigo_store *store, const char *key, const char *expected) {
+	int length;
+	const char *value = indigo_store_get(store, key, &length);
+	return value != NULL && length == (int)strlen(expected) && !strcmp(value, expected);
+}
+
+static bool put(indigo_store *store, const char *key, const char *value) {
+	return indigo_store_put(store, key, value, (int)strlen(value));
+}
+
+static void test_truncated_record(void) {
+	char path[256];
+	snprintf(path, sizeof(path), "%s/truncated.store", directory);
+	indigo_store *store = indigo_store_open(path, true);
+	put(store, "first", "value 1");
+	put(store, "second", "value 2");
+	long valid = file_size(path);
+	put(store, "third", "value 3");
+	indigo_store_close(store);
+	// write interrupted in the middle of last record
+	CHECK(truncate(path, file_size(path) - 5) == 0, "last record truncated");
+	store = indigo_store_open(path, false);
+	CHECK(store != NULL, "store with torn tail opened");
+	CHECK(indigo_store_count(store) == 2 && has_value(store, "first", "value 1") && has_value(store, "second", "value 2"), "records before torn one kept");
+	CHECK(indigo_store_get(store, "third", NULL) == NULL, "torn record dropped");
+	CHECK(file_size(path) == valid, "torn tail removed from file");
+	put(store, "fourth", "value 4");
+	indigo_store_close(store);
+	store = indigo_store_open(path, false);
+	CHECK(indigo_store_count(store) == 3 && has_value(store, "fourth", "value 4"), "record appended after repair is readable");
+	indigo_store_close(store);
+}
+
+static void test_corrupted_checksum(void) {
+	char path[256];
+	snprintf(path, sizeof(path), "%s/corrupted.store", directory);
+	indigo_store *store = indigo_store_open(path, true);
+	put(store, "first", "value 1");
+	long offset = file_size(path);
+	put(store, "second", "value 2");
+	put(store, "third", "value 3");
+	indigo_store_close(store);
+	// flip one byte of checksum of the second record
+	int handle = open(path, O_RDWR);
+	unsigned char byte = 0;
+	bool flipped = handle >= 0 && pread(handle, &byte, 1, offset + RECORD_CHECKSUM_OFFSET) == 1;
+	byte ^= 0xFF;
+	flipped = flipped && pwrite(handle, &byte, 1, offset + RECORD_CHECKSUM_OFFSET) == 1;
+	if (handle >= 0)
+		close(handle);
+	CHECK(flipped, "checksum byte of second record flipped");
+	store = indigo_store_open(path, false);
+	CHECK(store != NULL, "store with corrupted record opened");
+	CHECK(indigo_store_count(store) == 1 && has_value(store, "first", "value 1"), "records before corrupted one kept");
+	CHECK(indigo_store_get(store, "second", NULL) == NULL && indigo_store_get(store, "third", NULL) == NULL, "corrupted record and records after it dropped");
+	CHECK(file_size(path) == offset, "file truncated to valid prefix");
+	indigo_store_close(store);
+}
+
+static void test_compaction(void) {
+	char path[256], tmp_path[256];
+	snprintf(path, sizeof(path), "%s/compacted.store", directory);
+	snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+	indigo_store *store = indigo_store_open(path, true);
+	char value[64];
+	for (int i = 0; i < 100; i++) {
+		snprintf(value, sizeof(value), "value %d", i);
+		put(store, "a", value);
+		put(store, "b", value);
+	}
+	put(store, "c", "removed");
+	indigo_store_remove(store, "c");
+	long before = file_size(path);
+	CHECK(indigo_store_compact(store), "store compacted");
+	long after = file_size(path);
+	CHECK(after < before / 10, "file shrunk from %ld to %ld bytes", before, after);
+	CHECK(!exists(tmp_path), "temporary file renamed over store");
+	put(store, "d", "after compaction");
+	indigo_store_close(store);
+	store = indigo_store_open(path, false);
+	CHECK(indigo_store_count(store) == 3, "live records survive reopen (%d)", indigo_store_count(store));
+	CHECK(!strcmp(indigo_store_key(store, 0), "a") && !strcmp(indigo_store_key(store, 1), "b") && !strcmp(indigo_store_key(store, 2), "d"), "record order kept");
+	CHECK(has_value(store, "a", "value 99") && has_value(store, "b", "value 99") && has_value(store, "d", "after compaction"), "last values kept");
+	CHECK(indigo_store_get(store, "c", NULL) == NULL, "removed record stays removed");
+	indigo_store_close(store);
+}
+
+static void test_batch(void) {
+	char path[256], save_path[256];
+	snprintf(path, sizeof(path), "%s/batch.store", directory);
+	snprintf(save_path, sizeof(save_path), "%s.save", path);
+	indigo_store *store = indigo_store_open(path, true);
+	put(store, "old", "value");
+	indigo_store_close(store);
+	int handle = indigo_store_begin(path);
+	CHECK(handle >= 0, "batch started");
+	indigo_store_append(handle, "new 1", "value 1", 7);
+	indigo_store_append(handle, "new 2", "value 2", 7);
+	// nothing is visible until commit
+	store = indigo_store_open(path, false);
+	CHECK(indigo_store_count(store) == 1 && has_value(store, "old", "value"), "store unchanged before commit");
+	indigo_store_close(store);
+	CHECK(exists(save_path), "batch is written to temporary file");
+	CHECK(indigo_store_commit(handle), "batch committed");
+	CHECK(!exists(save_path), "temporary file renamed over store");
+	store = indigo_store_open(path, false);
+	CHECK(indigo_store_count(store) == 2 && has_value(store, "new 1", "value 1") && has_value(store, "new 2", "value 2") && indigo_store_get(store, "old", NULL) == NULL, "store replaced by batch");
+	indigo_store_close(store);
+}
+
+// -------------------------------------------------------------------------------- .config import
+
+static char loaded_value[INDIGO_VALUE_SIZE];
+static double loaded_number;
+static int loaded_count;
+
+static indigo_result device_change_property(indigo_device *device, indigo_client *client, indigo_property *property) {
+	if (!strcmp(property->name, "TEST_TEXT") && property->count == 1) {
+		strcpy(loaded_value, property->items[0].text.value);
+		loaded_count++;
+	} else if (!strcmp(property->name, "TEST_NUMBER") && property->count == 1) {
+		loaded_number = property->items[0].number.value;
+		loaded_count++;
+	}
+	return INDIGO_OK;
+}
+
+static indigo_device device = INDIGO_DEVICE_INITIALIZER(DEVICE_NAME, NULL, NULL, device_change_property, NULL, NULL);
+
+static bool write_config(const char *text, const char *number) {
+	int handle = indigo_open_config_file(DEVICE_NAME, 0, O_WRONLY | O_CREAT | O_TRUNC, ".config");
+	if (handle < 0)
+		return false;
+	indigo_printf(handle, "<newTextVector device='%s' name='TEST_TEXT'>\n<oneText name='VALUE'>%s</oneText>\n</newTextVector>\n", DEVICE_NAME, text);
+	indigo_printf(handle, "<newNumberVector device='%s' name='TEST_NUMBER'>\n<oneNumber name='VALUE'>%s</oneNumber>\n</newNumberVector>\n", DEVICE_NAME, number);
+	close(handle);
+	return true;
+}
+
+static bool config_exists(const char *suffix) {
+	int handle = indigo_open_config_file(DEVICE_NAME, 0, O_RDONLY, suffix);
+	if (handle < 0)
+		return false;
+	close(handle);
+	return true;
+}
+
+static void test_config_import(void) {
+	CHECK(write_config("a &amp; b", "12.5"), ".config of previous version written");
+	indigo_attach_device(&device);
+	loaded_count = 0;
+	CHECK(indigo_load_properties(&device, false) == INDIGO_OK, "properties loaded");
+	CHECK(loaded_count == 2 && !strcmp(loaded_value, "a & b") && loaded_number == 12.5, "imported values replayed (\"%s\", %g)", loaded_value, loaded_number);
+	CHECK(config_exists(".config.store") && !config_exists(".config.import"), "import renamed to .config.store");
+	CHECK(config_exists(".config"), ".config left in place");
+	// import is done only once, later .config changes are ignored
+	write_config("changed", "0");
+	loaded_count = 0;
+	indigo_load_properties(&device, false);
+	CHECK(loaded_count == 2 && !strcmp(loaded_value, "a & b") && loaded_number == 12.5, "second load reads store, not .config");
+	indigo_detach_device(&device);
+}
+
+int main(int argc, const char * argv[]) {
+	indigo_set_log_level(INDIGO_LOG_ERROR);
+	if (mkdtemp(directory) == NULL) {
+		printf("FAILED: can't create %s\n", directory);
+		return 1;
+	}
+	// config files are created in $HOME/.indigo
+	setenv("HOME", directory, 1);
+	indigo_start();
+	test_truncated_record();
+	test_corrupted_checksum();
+	test_compaction();
+	test_batch();
+	test_config_import();
+	indigo_stop();
+	char command[256];
+	snprintf(command, sizeof(command), "rm -rf %s", directory);
+	if (system(command) != 0)
+		printf("can't remove %s\n", directory);
+	printf("%s\n", failures ? "FAILED" : "PASSED");
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,487 @@
+// Copyright (c) 2020 CloudMakers, s. r. o.
+// All rights reserved.
+//
+// You can use this software under the terms of 'INDIGO Astronomy
+// open-source license' (see LICENSE.md).
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHORS 'AS IS' AND ANY EXPRESS
+// OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// version history
+// 2.0 by Peter Polakovic <peter.polakovic@cloudmakers.eu>
+
+/** INDIGO micro and macro benchmarks
+ \file indigo_bench.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <math.h>
+#include <time.h>
+#include <sys/utsname.h>
+
+#include <indigo/indigo_bus.h>
+#include <indigo/indigo_config.h>
+#include <indigo/indigo_ccd_driver.h>
+#include <indigo/indigo_xml.h>
+#include <indigo/indigo_json.h>
+#include <indigo/indigo_driver_xml.h>
+#include <indigo/indigo_driver_json.h>
+#include <indigo/indigo_base64.h>
+#include <indigo/indigo_io.h>
+#include <indigo/indigo_guider_utils.h>
+
+#define BENCH_DEVICE_NAME		"Bench CCD"
+#define BENCH_PROPERTY_NAME	"BENCH_NUMBER"
+#define BENCH_WIDTH					1600
+#define BENCH_HEIGHT				1200
+#define BENCH_STARS					200
+#define BENCH_MESSAGES			1000
+#define BENCH_BASE64_SIZE		(4 * 1024 * 1024)
+#define MAX_RESULTS					64
+
+typedef struct {
+	const char *name;
+	const char *group;
+	int batch;											// operations per iteration
+	long (*run)(long iterations);		// returns number of bytes processed or 0
+} bench_entry;
+
+typedef struct {
+	const char *name;
+	const char *group;
+	long operations;
+	double ns_per_op_min, ns_per_op_median;
+	double mb_per_sec;
+} bench_result;
+
+static indigo_property *bench_property = NULL;
+static indigo_device *bench_device = NULL;
+static indigo_client *bench_client = NULL;
+static indigo_client *xml_adapter = NULL;
+static indigo_client *json_adapter = NULL;
+static int xml_messages = -1;
+static int json_messages = -1;
+static unsigned short *bench_image = NULL;
+static unsigned char *base64_raw = NULL;
+static unsigned char *base64_text = NULL;
+static long base64_text_size = 0;
+static long client_events = 0;
+
+static const char *bench_item_names[] = { "A", "B", "C", "D" };
+
+// -------------------------------------------------------------------------------- test device and client
+
+static indigo_result bench_device_attach(indigo_device *device) {
+	if (indigo_ccd_attach(device, "indigo_bench", 0x0001) == INDIGO_OK) {
+		bench_property = indigo_init_number_property(NULL, device->name, BENCH_PROPERTY_NAME, MAIN_GROUP, "Benchmark", INDIGO_OK_STATE, INDIGO_RW_PERM, 4);
+		for (int i = 0; i < 4; i++)
+			indigo_init_number_item(bench_property->items + i, bench_item_names[i], bench_item_names[i], -1000, 1000, 0, i);
+		CCD_INFO_WIDTH_ITEM->number.value = CCD_FRAME_WIDTH_ITEM->number.value = BENCH_WIDTH;
+		CCD_INFO_HEIGHT_ITEM->number.value = CCD_FRAME_HEIGHT_ITEM->number.value = BENCH_HEIGHT;
+		CCD_FRAME_BITS_PER_PIXEL_ITEM->number.value = 16;
+		return INDIGO_OK;
+	}
+	return INDIGO_FAILED;
+}
+
+static indigo_result bench_device_enumerate_properties(indigo_device *device, indigo_client *client, indigo_property *property) {
+	return indigo_ccd_enumerate_properties(device, client, property);
+}
+
+static indigo_result bench_device_change_property(indigo_device *device, indigo_client *client, indigo_property *property) {
+	if (indigo_property_match(bench_property, property)) {
+		indigo_property_copy_values(bench_property, property, false);
+		bench_property->state = INDIGO_OK_STATE;
+		indigo_update_property(device, bench_property, NULL);
+		return INDIGO_OK;
+	}
+	return indigo_ccd_change_property(device, client, property);
+}
+
+static indigo_result bench_device_detach(indigo_device *device) {
+	indigo_release_property(bench_property);
+	return indigo_ccd_detach(device);
+}
+
+static indigo_result bench_client_property(indigo_client *client, indigo_device *device, indigo_property *property, const char *message) {
+	client_events++;
+	return INDIGO_OK;
+}
+
+// -------------------------------------------------------------------------------- bus
+
+static long bench_bus_define_delete(long iterations) {
+	for (long i = 0; i < iterations; i++) {
+		indigo_define_property(bench_device, bench_property, NULL);
+		indigo_delete_property(bench_device, bench_property, NULL);
+	}
+	return 0;
+}
+
+static long bench_bus_update(long iterations) {
+	for (long i = 0; i < iterations; i++) {
+		bench_property->items[0].number.value = i;
+		indigo_update_property(bench_device, bench_property, NULL);
+	}
+	return 0;
+}
+
+static long bench_bus_change(long iterations) {
+	double values[4] = { 0, 1, 2, 3 };
+	for (long i = 0; i < iterations; i++) {
+		values[0] = i % 1000;
+		indigo_change_number_property(bench_client, BENCH_DEVICE_NAME, BENCH_PROPERTY_NAME, 4, bench_item_names, values);
+	}
+	return 0;
+}
+
+// -------------------------------------------------------------------------------- XML & JSON protocol
+
+static int message_file(const char *format) {
+	char name[] = "/tmp/indigo_bench_XXXXXX";
+	int handle = mkstemp(name);
+	if (handle < 0)
+		return -1;
+	unlink(name);
+	for (int i = 0; i < BENCH_MESSAGES; i++) {
+		if (!indigo_printf(handle, format, BENCH_DEVICE_NAME, BENCH_PROPERTY_NAME, (double)(i % 1000), (double)i / 1000.0, -(double)i / 1000.0, 3.0)) {
+			close(handle);
+			return -1;
+		}
+	}
+	return handle;
+}
+
+static long parse_messages(int messages, indigo_client *client, void (*parse)(indigo_device *device, indigo_client *client), long iterations) {
+	// parser closes input handle on EOF, so it is fed with a duplicate of the message file in each iteration
+	long size = lseek(messages, 0, SEEK_END);
+	long processed = 0;
+	for (long i = 0; i < iterations; i++) {
+		lseek(messages, 0, SEEK_SET);
+		((indigo_adapter_context *)client->client_context)->input = dup(messages);
+		parse(NULL, client);
+		processed += size;
+	}
+	return processed;
+}
+
+static long bench_xml_update(long iterations) {
+	for (long i = 0; i < iterations; i++) {
+		bench_property->items[0].number.value = i;
+		xml_adapter->update_property(xml_adapter, bench_device, bench_property, NULL);
+	}
+	return 0;
+}
+
+static long bench_xml_define(long iterations) {
+	for (long i = 0; i < iterations; i++)
+		xml_adapter->define_property(xml_adapter, bench_device, bench_property, NULL);
+	return 0;
+}
+
+static long bench_xml_parse(long iterations) {
+	return parse_messages(xml_messages, xml_adapter, indigo_xml_parse, iterations);
+}
+
+static long bench_json_update(long iterations) {
+	for (long i = 0; i < iterations; i++) {
+		bench_property->items[0].number.value = i;
+		json_adapter->update_property(json_adapter, bench_device, bench_property, NULL);
+	}
+	return 0;
+}
+
+static long bench_json_define(long iterations) {
+	for (long i = 0; i < iterations; i++)
+		json_adapter->define_property(json_adapter, bench_device, bench_property, NULL);
+	return 0;
+}
+
+static long bench_json_parse(long iterations) {
+	return parse_messages(json_messages, json_adapter, indigo_json_parse, iterations);
+}
+
+// -------------------------------------------------------------------------------- base64
+
+static long bench_base64_encode(long iterations) {
+	for (long i = 0; i < iterations; i++)
+		base64_text_size = base64_encode(base64_text, base64_raw, BENCH_BASE64_SIZE);
+	return iterations * BENCH_BASE64_SIZE;
+}
+
+static long bench_base64_decode(long iterations) {
+	for (long i = 0; i < iterations; i++)
+		base64_decode_fast(base64_raw, base64_text, base64_text_size);
+	return iterations * BENCH_BASE64_SIZE;
+}
+
+// -------------------------------------------------------------------------------- image pipeline
+
+static void generate_image(unsigned short *image) {
+	// deterministic star field on noisy background
+	unsigned seed = 1;
+	for (int i = 0; i < BENCH_WIDTH * BENCH_HEIGHT; i++) {
+		seed = seed * 1103515245 + 12345;
+		image[i] = 1000 + ((seed >> 16) & 0xFF);
+	}
+	for (int s = 0; s < BENCH_STARS; s++) {
+		seed = seed * 1103515245 + 12345;
+		int cx = 10 + (seed >> 8) % (BENCH_WIDTH - 20);
+		seed = seed * 1103515245 + 12345;
+		int cy = 10 + (seed >> 8) % (BENCH_HEIGHT - 20);
+		double a = 2000 + (s * 997) % 50000;
+		for (int y = -5; y <= 5; y++) {
+			for (int x = -5; x <= 5; x++) {
+				int value = image[(cy + y) * BENCH_WIDTH + cx + x] + a * exp(-(x * x + y * y) / 4.0);
+				image[(cy + y) * BENCH_WIDTH + cx + x] = value > 65535 ? 65535 : value;
+			}
+		}
+	}
+}
+
+static long bench_raw_to_jpeg(long iterations) {
+	void *data_out;
+	unsigned long size_out;
+	for (long i = 0; i < iterations; i++) {
+		indigo_raw_to_jpeg(bench_device, (char *)bench_image - FITS_HEADER_SIZE, BENCH_WIDTH, BENCH_HEIGHT, 16, true, true, &data_out, &size_out);
+		free(data_out);
+	}
+	return iterations * BENCH_WIDTH * BENCH_HEIGHT * 2;
+}
+
+static long bench_process_image(long iterations) {
+	// image is processed in place, so the source is restored before each frame
+	char *buffer = indigo_alloc_blob_buffer(FITS_HEADER_SIZE + BENCH_WIDTH * BENCH_HEIGHT * 2);
+	for (long i = 0; i < iterations; i++) {
+		memcpy(buffer + FITS_HEADER_SIZE, bench_image, BENCH_WIDTH * BENCH_HEIGHT * 2);
+		indigo_process_image(bench_device, buffer, BENCH_WIDTH, BENCH_HEIGHT, 16, true, true, NULL, false);
+	}
+	free(buffer);
+	return iterations * BENCH_WIDTH * BENCH_HEIGHT * 2;
+}
+
+static long bench_find_stars(long iterations) {
+	indigo_star_detection stars[BENCH_STARS];
+	int found;
+	for (long i = 0; i < iterations; i++)
+		indigo_find_stars(INDIGO_RAW_MONO16, bench_image, BENCH_WIDTH, BENCH_HEIGHT, BENCH_STARS, stars, &found);
+	return iterations * BENCH_WIDTH * BENCH_HEIGHT * 2;
+}
+
+// -------------------------------------------------------------------------------- runner
+
+static bench_entry benchmarks[] = {
+	{ "bus.define_delete", "bus", 1, bench_bus_define_delete },
+	{ "bus.update", "bus", 1, bench_bus_update },
+	{ "bus.change", "bus", 1, bench_bus_change },
+	{ "xml.define", "protocol", 1, bench_xml_define },
+	{ "xml.update", "protocol", 1, bench_xml_update },
+	{ "xml.parse_change", "protocol", BENCH_MESSAGES, bench_xml_parse },
+	{ "json.define", "protocol", 1, bench_json_define },
+	{ "json.update", "protocol", 1, bench_json_update },
+	{ "json.parse_change", "protocol", BENCH_MESSAGES, bench_json_parse },
+	{ "base64.encode", "protocol", 1, bench_base64_encode },
+	{ "base64.decode", "protocol", 1, bench_base64_decode },
+	{ "image.raw_to_jpeg", "image", 1, bench_raw_to_jpeg },
+	{ "image.process_image", "image", 1, bench_process_image },
+	{ "image.find_stars", "image", 1, bench_find_stars },
+	{ NULL }
+};
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int compare_doubles(const void *a, const void *b) {
+	double da = *(const double *)a, db = *(const double *)b;
+	return da < db ? -1 : da > db;
+}
+
+static void run_benchmark(bench_entry *entry, double min_time, int repeat, bench_result *result) {
+	// calibrate iteration count so a single run takes at least min_time, then take min and median of repeated runs
+	long iterations = 1;
+	double elapsed;
+	while (true) {
+		double start = now();
+		entry->run(iterations);
+		elapsed = now() - start;
+		if (elapsed >= min_time || iterations >= (1L << 40))
+			break;
+		long next = elapsed > 0 ? (long)(iterations * 1.2 * min_time / elapsed) : iterations * 100;
+		iterations = next > iterations * 100 ? iterations * 100 : next > iterations ? next : iterations * 2;
+	}
+	double samples[repeat];
+	long bytes = 0;
+	for (int i = 0; i < repeat; i++) {
+		double start = now();
+		bytes = entry->run(iterations);
+		samples[i] = (now() - start) * 1e9 / (iterations * entry->batch);
+	}
+	qsort(samples, repeat, sizeof(double), compare_doubles);
+	result->name = entry->name;
+	result->group = entry->group;
+	result->operations = iterations * entry->batch;
+	result->ns_per_op_min = samples[0];
+	result->ns_per_op_median = samples[repeat / 2];
+	result->mb_per_sec = bytes ? (bytes / (double)result->operations) / samples[0] * 1e9 / (1024 * 1024) : 0;
+}
+
+static bool setup(void) {
+	static indigo_device device_template = INDIGO_DEVICE_INITIALIZER(
+		BENCH_DEVICE_NAME,
+		bench_device_attach,
+		bench_device_enumerate_properties,
+		bench_device_change_property,
+		NULL,
+		bench_device_detach
+	);
+	static indigo_client client_template = {
+		"Bench client", false, NULL, INDIGO_OK, INDIGO_VERSION_CURRENT, NULL,
+		NULL,
+		bench_client_property,
+		bench_client_property,
+		bench_client_property,
+		NULL,
+		NULL
+	};
+	indigo_start();
+	bench_device = malloc(sizeof(indigo_device));
+	memcpy(bench_device, &device_template, sizeof(indigo_device));
+	bench_client = &client_template;
+	if (indigo_attach_device(bench_device) != INDIGO_OK || indigo_attach_client(bench_client) != INDIGO_OK)
+		return false;
+	int null_handle = open("/dev/null", O_WRONLY);
+	xml_adapter = indigo_xml_device_adapter(-1, null_handle);
+	xml_adapter->version = INDIGO_VERSION_CURRENT;
+	json_adapter = indigo_json_device_adapter(-1, null_handle, false);
+	json_adapter->version = INDIGO_VERSION_CURRENT;
+	xml_messages = message_file("<newNumberVector device='%s' name='%s'><oneNumber name='A'>%g</oneNumber><oneNumber name='B'>%g</oneNumber><oneNumber name='C'>%g</oneNumber><oneNumber name='D'>%g</oneNumber></newNumberVector>\n");
+	json_messages = message_file("{ \"newNumberVector\": { \"device\": \"%s\", \"name\": \"%s\", \"items\": [ { \"name\": \"A\", \"value\": %g }, { \"name\": \"B\", \"value\": %g }, { \"name\": \"C\", \"value\": %g }, { \"name\": \"D\", \"value\": %g } ] } }\n");
+	if (null_handle < 0 || xml_messages < 0 || json_messages < 0)
+		return false;
+	base64_raw = malloc(BENCH_BASE64_SIZE + 3);
+	base64_text = malloc((BENCH_BASE64_SIZE + 2) / 3 * 4 + 4);
+	for (int i = 0; i < BENCH_BASE64_SIZE; i++)
+		base64_raw[i] = (unsigned char)(i * 31 + (i >> 8));
+	base64_text_size = base64_encode(base64_text, base64_raw, BENCH_BASE64_SIZE);
+	char *buffer = indigo_alloc_blob_buffer(FITS_HEADER_SIZE + BENCH_WIDTH * BENCH_HEIGHT * 2);
+	bench_image = (unsigned short *)(buffer + FITS_HEADER_SIZE);
+	generate_image(bench_image);
+	return true;
+}
+
+static void print_results(FILE *file, bench_result *results, int count, double min_time, int repeat) {
+	struct utsname host;
+	uname(&host);
+	time_t timestamp = time(NULL);
+	char date[32];
+	strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&timestamp));
+	fprintf(file, "{\n  \"indigo\": \"%d.%d-%s\",\n  \"timestamp\": \"%s\",\n  \"host\": { \"system\": \"%s\", \"release\": \"%s\", \"machine\": \"%s\", \"cpus\": %ld },\n", (INDIGO_VERSION_CURRENT >> 8) & 0xFF, INDIGO_VERSION_CURRENT & 0xFF, INDIGO_BUILD, date, host.sysname, host.release, host.machine, sysconf(_SC_NPROCESSORS_ONLN));
+	fprintf(file, "  \"min_time\": %g,\n  \"repeat\": %d,\n  \"results\": [\n", min_time, repeat);
+	for (int i = 0; i < count; i++) {
+		bench_result *result = results + i;
+		fprintf(file, "    { \"name\": \"%s\", \"group\": \"%s\", \"operations\": %ld, \"ns_per_op_min\": %.1f, \"ns_per_op_median\": %.1f, \"ops_per_sec\": %.1f, \"mb_per_sec\": %.1f }%s\n", result->name, result->group, result->operations, result->ns_per_op_min, result->ns_per_op_median, 1e9 / result->ns_per_op_min, result->mb_per_sec, i + 1 < count ? "," : "");
+	}
+	fprintf(file, "  ]\n}\n");
+}
+
+static void print_help(const char *name) {
+	printf("INDIGO benchmark suite v.%d.%d-%s\n", (INDIGO_VERSION_CURRENT >> 8) & 0xFF, INDIGO_VERSION_CURRENT & 0xFF, INDIGO_BUILD);
+	printf("usage: %s [options] [filter ...]\n", name);
+	printf("options:\n");
+	printf("       -l  | --list             list benchmarks\n");
+	printf("       -t  | --time seconds     minimal duration of a single run (default 0.5)\n");
+	printf("       -r  | --repeat count     number of measured runs (default 5)\n");
+	printf("       -o  | --output file      write JSON results to file ('-' for stdout)\n");
+	printf("       -h  | --help\n");
+	printf("filter selects benchmarks by name or group prefix, e.g. 'bus' or 'image.find_stars'\n");
+}
+
+static bool selected(bench_entry *entry, int count, const char **filters) {
+	if (count == 0)
+		return true;
+	for (int i = 0; i < count; i++) {
+		if (!strncmp(entry->name, filters[i], strlen(filters[i])) || !strcmp(entry->group, filters[i]))
+			return true;
+	}
+	return false;
+}
+
+int main(int argc, const char * argv[]) {
+	indigo_main_argc = argc;
+	indigo_main_argv = argv;
+	double min_time = 0.5;
+	int repeat = 5;
+	const char *output = NULL;
+	const char *filters[MAX_RESULTS];
+	int filter_count = 0;
+	for (int i = 1; i < argc; i++) {
+		if ((!strcmp(argv[i], "-t") || !strcmp(argv[i], "--time")) && i + 1 < argc) {
+			min_time = atof(argv[++i]);
+		} else if ((!strcmp(argv[i], "-r") || !strcmp(argv[i], "--repeat")) && i + 1 < argc) {
+			repeat = atoi(argv[++i]);
+			if (repeat < 1)
+				repeat = 1;
+		} else if ((!strcmp(argv[i], "-o") || !strcmp(argv[i], "--output")) && i + 1 < argc) {
+			output = argv[++i];
+		} else if (!strcmp(argv[i], "-l") || !strcmp(argv[i], "--list")) {
+			for (bench_entry *entry = benchmarks; entry->name; entry++)
+				printf("%-24s %s\n", entry->name, entry->group);
+			return 0;
+		} else if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help")) {
+			print_help(argv[0]);
+			return 0;
+		} else if (*argv[i] == '-') {
+			print_help(argv[0]);
+			return 1;
+		} else if (filter_count < MAX_RESULTS) {
+			filters[filter_count++] = argv[i];
+		}
+	}
+	indigo_set_log_level(INDIGO_LOG_ERROR);
+	if (!setup()) {
+		fprintf(stderr, "Failed to set up benchmarks\n");
+		return 1;
+	}
+	bench_result results[MAX_RESULTS];
+	int count = 0;
+	for (bench_entry *entry = benchmarks; entry->name; entry++) {
+		if (!selected(entry, filter_count, filters))
+			continue;
+		bench_result *result = results + count++;
+		run_benchmark(entry, min_time, repeat, result);
+		fprintf(stderr, "%-24s %12ld operations %14.1f ns/op %12.1f ops/s", result->name, result->operations, result->ns_per_op_min, 1e9 / result->ns_per_op_min);
+		if (result->mb_per_sec)
+			fprintf(stderr, " %10.1f MB/s", result->mb_per_sec);
+		fprintf(stderr, "\n");
+	}
+	if (output) {
+		FILE *file = strcmp(output, "-") ? fopen(output, "w") : stdout;
+		if (file == NULL) {
+			perror(output);
+			return 1;
+		}
+		print_results(file, results, count, min_time, repeat);
+		if (file != stdout)
+			fclose(file);
+	}
+	indigo_detach_client(bench_client);
+	indigo_detach_device(bench_device);
+	indigo_stop();
+	return 0;
+}